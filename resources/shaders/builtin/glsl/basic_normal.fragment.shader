@@ -1,17 +1,9 @@
 #version 150
+#include "viewdata.inc"
+#include "lightdata.inc"
 
 uniform sampler2D TEXTURE0;
 uniform sampler2D NORMALMAP;
-uniform vec4 EYE_POSITION;
-uniform vec4 LIGHT_POSITION;
-uniform vec4 LIGHT_DIRECTION;
-uniform vec4 LIGHT_COLOR;
-uniform float LIGHT_INTENSITY;
-uniform float LIGHT_ATTENUATION;
-uniform int LIGHT_TYPE;
-uniform float LIGHT_RANGE;
-uniform int LIGHT_PARALLEL_ATTENUATION;
-uniform int LIGHT_ORTHO_ATTENUATION;
 uniform float SPECULAR_FACTOR;
 
 vec4 texColor;
@@ -1,11 +1,8 @@
 #version 150
 #include "common.inc"
-
-uniform mat4 MODEL_MATRIX;
-uniform mat4 MODEL_MATRIX_INVERSE_TRANSPOSE;
-uniform mat4 MODELVIEW_MATRIX;
-uniform mat4 PROJECTION_MATRIX;
-uniform mat4 MODELVIEWPROJECTION_MATRIX;
+#include "viewdata.inc"
+#include "lightdata.inc"
+#include "objectdata.inc"
 
 in vec4 POSITION;
 in vec3 COLOR;
@@ -14,12 +11,6 @@ in vec4 NORMAL;
 in vec4 TANGENT;
 in vec4 FACENORMAL;
 
-uniform float LIGHT_ATTENUATION;
-uniform vec4 LIGHT_DIRECTION;
-uniform int LIGHT_TYPE;
-uniform int CLIP_PLANE_COUNT;
-uniform vec4 CLIP_PLANE0;
-
 uniform float USCALE;
 uniform float VSCALE;
 
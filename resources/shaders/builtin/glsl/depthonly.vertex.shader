@@ -1,12 +1,9 @@
 #version 150
+#include "viewdata.inc"
+#include "objectdata.inc"
 
 in vec4 POSITION;
 
-uniform mat4 MODELVIEWPROJECTION_MATRIX;
-uniform mat4 MODEL_MATRIX;
-uniform int CLIP_PLANE_COUNT;
-uniform vec4 CLIP_PLANE0;
- 
 void main()
 {
     gl_Position = MODELVIEWPROJECTION_MATRIX * POSITION;
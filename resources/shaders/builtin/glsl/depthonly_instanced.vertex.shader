@@ -0,0 +1,19 @@
+#version 150
+#include "instancing.inc"
+#include "viewdata.inc"
+
+in vec4 POSITION;
+
+void main()
+{
+    vec4 row0, row1, row2;
+    getInstanceTransform(row0, row1, row2);
+    vec4 worldPosition = instancePosition(row0, row1, row2, POSITION);
+
+    gl_Position = PROJECTION_MATRIX * VIEW_MATRIX * worldPosition;
+    
+    if(CLIP_PLANE_COUNT > 0)
+    {
+    	gl_ClipDistance[0] = dot(worldPosition, CLIP_PLANE0);
+    }
+}
@@ -0,0 +1,8 @@
+#version 150
+
+out vec4 out_color;
+
+void main()
+{	
+     out_color = vec4(0,0,0,1);
+}
@@ -0,0 +1,20 @@
+#version 150
+#include "skinning.inc"
+#include "viewdata.inc"
+#include "objectdata.inc"
+
+in vec4 POSITION;
+
+void main()
+{
+    vec4 row0, row1, row2;
+    getSkinningTransform(row0, row1, row2);
+    vec4 position = skinPosition(row0, row1, row2, POSITION);
+
+    gl_Position = MODELVIEWPROJECTION_MATRIX * position;
+    
+    if(CLIP_PLANE_COUNT > 0)
+    {
+    	gl_ClipDistance[0] = dot(MODEL_MATRIX * position, CLIP_PLANE0);
+    }
+}
@@ -1,9 +1,6 @@
 #version 150
-
-uniform mat4 MODELVIEWPROJECTION_MATRIX;
-uniform mat4 MODEL_MATRIX;
-uniform int CLIP_PLANE_COUNT;
-uniform vec4 CLIP_PLANE0;
+#include "viewdata.inc"
+#include "objectdata.inc"
 
 in vec4 POSITION;
 
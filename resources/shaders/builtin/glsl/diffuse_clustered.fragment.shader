@@ -0,0 +1,20 @@
+#version 150
+
+in vec4 vColor;
+in vec3 vNormal;
+in vec4 vPosition;
+in vec4 vClipPosition;
+
+out vec4 out_color;
+
+#include "lighting_diffuse.inc"
+#include "clusterdata.inc"
+
+void main()
+{
+	vec3 normal = normalize(vNormal);
+	int cluster = getClusterIndex(vClipPosition);
+
+	vec4 diffuse = calcClusterDiffuse(cluster, normal, vPosition);
+	out_color = vec4((diffuse * vColor).rgb, vColor.a);
+}
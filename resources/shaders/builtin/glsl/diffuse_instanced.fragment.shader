@@ -0,0 +1,27 @@
+#version 150
+#include "lightdata.inc"
+
+vec4 outputF;
+
+in vec4 vColor;
+in vec3 vNormal;
+in vec4 vPosition;
+in vec3 vLightDir;
+
+out vec4 out_color;
+
+#include "lighting_diffuse.inc"
+
+void main()
+{
+	float DiffuseTerm = 0.0;
+	vec4 diffuseColor = vec4(0, 0, 0, 0);
+	vec3 normal = normalize(vNormal);
+
+	DiffuseTerm = calcDiffuseTermForLight(LIGHT_TYPE, normal, vPosition, LIGHT_POSITION, vLightDir, LIGHT_INTENSITY, LIGHT_ATTENUATION, LIGHT_RANGE, LIGHT_PARALLEL_ATTENUATION, LIGHT_ORTHO_ATTENUATION);
+
+	diffuseColor = LIGHT_COLOR * vColor;
+	outputF = DiffuseTerm * diffuseColor;
+	out_color = outputF;
+}
+
@@ -0,0 +1,35 @@
+#version 150
+#include "common.inc"
+#include "instancing.inc"
+#include "viewdata.inc"
+#include "lightdata.inc"
+
+in vec4 POSITION;
+in vec4 COLOR;
+in vec4 NORMAL;
+
+out vec4 vColor;
+out vec3 vNormal;
+out vec4 vPosition;
+out vec3 vLightDir;
+
+void main()
+{
+	vec4 row0, row1, row2;
+	getInstanceTransform(row0, row1, row2);
+	vec4 worldPosition = instancePosition(row0, row1, row2, POSITION);
+
+	if(LIGHT_TYPE == LIGHT_TYPE_DIRECTIONAL || LIGHT_TYPE == LIGHT_TYPE_PLANAR)
+	{
+		vLightDir = normalize(LIGHT_DIRECTION.xyz);
+	}
+	vColor = COLOR;
+	vNormal = instanceNormal(row0, row1, row2, NORMAL.xyz);
+	vPosition = worldPosition;
+	gl_Position = PROJECTION_MATRIX * VIEW_MATRIX * worldPosition;
+
+	if(CLIP_PLANE_COUNT > 0)
+	{
+		gl_ClipDistance[0] = dot(worldPosition, CLIP_PLANE0);
+	}
+}
@@ -0,0 +1,23 @@
+#version 150
+
+uniform sampler2D TEXTURE0;
+
+in vec3 vNormal;
+in vec4 vPosition;
+in vec2 vUVTexture0;
+in vec4 vClipPosition;
+
+out vec4 out_color;
+
+#include "lighting_diffuse.inc"
+#include "clusterdata.inc"
+
+void main()
+{
+	vec4 texColor = texture(TEXTURE0, vUVTexture0);
+	vec3 normal = normalize(vNormal);
+	int cluster = getClusterIndex(vClipPosition);
+
+	vec4 diffuse = calcClusterDiffuse(cluster, normal, vPosition);
+	out_color = vec4((diffuse * texColor).rgb, texColor.a);
+}
@@ -0,0 +1,27 @@
+#version 150
+#include "common.inc"
+#include "viewdata.inc"
+#include "objectdata.inc"
+
+in vec4 POSITION;
+in vec2 UVTEXTURE0;
+in vec4 NORMAL;
+
+out vec2 vUVTexture0;
+out vec3 vNormal;
+out vec4 vPosition;
+out vec4 vClipPosition;
+
+void main()
+{
+	vUVTexture0 = UVTEXTURE0;
+	vNormal = mat3(MODEL_MATRIX_INVERSE_TRANSPOSE) * NORMAL.xyz;
+	vPosition = MODEL_MATRIX * POSITION;
+	vClipPosition = MODELVIEWPROJECTION_MATRIX * POSITION;
+	gl_Position = vClipPosition;
+
+	if(CLIP_PLANE_COUNT > 0)
+	{
+		gl_ClipDistance[0] = dot(MODEL_MATRIX * POSITION, CLIP_PLANE0);
+	}
+}
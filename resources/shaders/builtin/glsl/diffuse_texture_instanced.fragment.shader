@@ -0,0 +1,32 @@
+#version 150
+#include "lightdata.inc"
+
+uniform sampler2D TEXTURE0;
+
+vec4 texColor;
+vec4 outputF;
+
+in vec3 vNormal;
+in vec4 vPosition;
+in vec3 vLightDir;
+in vec2 vUVTexture0;
+
+out vec4 out_color;
+
+#include "lighting_diffuse.inc"
+
+void main()
+{
+
+	texColor = texture(TEXTURE0, vUVTexture0);
+	float DiffuseTerm = 0.0;
+	vec4 diffuseColor = vec4(0, 0, 0, 0);
+	vec3 normal = normalize(vNormal);
+
+	DiffuseTerm = calcDiffuseTermForLight(LIGHT_TYPE, normal, vPosition, LIGHT_POSITION, vLightDir, LIGHT_INTENSITY, LIGHT_ATTENUATION, LIGHT_RANGE, LIGHT_PARALLEL_ATTENUATION, LIGHT_ORTHO_ATTENUATION);
+
+	diffuseColor = LIGHT_COLOR * texColor;
+	outputF = (DiffuseTerm * diffuseColor);
+	out_color = outputF;
+}
+
@@ -1,15 +1,7 @@
 #version 150
+#include "lightdata.inc"
 
 uniform sampler2D TEXTURE0;
-uniform vec4 LIGHT_POSITION;
-uniform vec4 LIGHT_DIRECTION;
-uniform vec4 LIGHT_COLOR;
-uniform float LIGHT_INTENSITY;
-uniform float LIGHT_ATTENUATION;
-uniform int LIGHT_TYPE;
-uniform float LIGHT_RANGE;
-uniform int LIGHT_PARALLEL_ATTENUATION;
-uniform int LIGHT_ORTHO_ATTENUATION;
 uniform vec2 UV_SCALE;
 
 vec4 texColor;
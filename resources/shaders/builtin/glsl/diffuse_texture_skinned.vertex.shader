@@ -0,0 +1,37 @@
+#version 150
+#include "common.inc"
+#include "skinning.inc"
+#include "viewdata.inc"
+#include "lightdata.inc"
+#include "objectdata.inc"
+
+in vec4 POSITION;
+in vec2 UVTEXTURE0;
+in vec4 NORMAL;
+
+out vec2 vUVTexture0;
+out vec3 vNormal;
+out vec4 vPosition;
+out vec3 vLightDir;
+
+void main()
+{
+	vec4 row0, row1, row2;
+	getSkinningTransform(row0, row1, row2);
+	vec4 position = skinPosition(row0, row1, row2, POSITION);
+	vec4 normal = skinVector(row0, row1, row2, NORMAL);
+
+	if(LIGHT_TYPE == LIGHT_TYPE_DIRECTIONAL || LIGHT_TYPE == LIGHT_TYPE_PLANAR)
+	{
+		vLightDir = normalize(LIGHT_DIRECTION.xyz);
+	}
+	vUVTexture0 = UVTEXTURE0;
+	vNormal = mat3(MODEL_MATRIX_INVERSE_TRANSPOSE) * normal.xyz;
+	vPosition = MODEL_MATRIX * position;
+	gl_Position = MODELVIEWPROJECTION_MATRIX * position;
+
+	if(CLIP_PLANE_COUNT > 0)
+	{
+		gl_ClipDistance[0] = dot(MODEL_MATRIX * position, CLIP_PLANE0);
+	}
+}
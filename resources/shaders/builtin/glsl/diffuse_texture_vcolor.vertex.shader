@@ -1,15 +1,9 @@
 #version 150
 #include "common.inc"
+#include "viewdata.inc"
+#include "lightdata.inc"
+#include "objectdata.inc"
 
-uniform mat4 MODEL_MATRIX;
-uniform mat4 MODELVIEW_MATRIX;
-uniform mat4 PROJECTION_MATRIX;
-uniform mat4 MODELVIEWPROJECTION_MATRIX;
-uniform mat4 MODEL_MATRIX_INVERSE_TRANSPOSE;
-uniform vec4 LIGHT_DIRECTION;
-uniform int LIGHT_TYPE;
-uniform int CLIP_PLANE_COUNT;
-uniform vec4 CLIP_PLANE0;
 in vec4 POSITION;
 in vec4 COLOR;
 in vec2 UVTEXTURE0;
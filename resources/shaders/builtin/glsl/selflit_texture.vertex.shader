@@ -1,9 +1,7 @@
 #version 150
+#include "viewdata.inc"
+#include "objectdata.inc"
 
-uniform mat4 MODELVIEWPROJECTION_MATRIX;
-uniform mat4 MODEL_MATRIX;
-uniform int CLIP_PLANE_COUNT;
-uniform vec4 CLIP_PLANE0;
 in vec4 POSITION;
 in vec2 UVTEXTURE0;
 in vec2 UVTEXTURE1;
@@ -1,9 +1,7 @@
 #version 150
+#include "viewdata.inc"
+#include "objectdata.inc"
 
-uniform mat4 MODELVIEWPROJECTION_MATRIX;
-uniform mat4 MODELVIEW_MATRIX;
-uniform mat4 VIEW_MATRIX;
-uniform mat4 PROJECTION_MATRIX;
 in vec4 POSITION;
 
 out vec4 TexCoord0;
@@ -1,12 +1,7 @@
 #version 150
+#include "viewdata.inc"
+#include "objectdata.inc"
 
-uniform mat4 MODEL_MATRIX;
-uniform mat4 VIEW_MATRIX;
-uniform mat4 MODEL_MATRIX_INVERSE_TRANSPOSE;
-uniform mat4 MODELVIEW_MATRIX;
-uniform mat4 MODELVIEWPROJECTION_MATRIX;
-uniform int CLIP_PLANE_COUNT;
-uniform vec4 CLIP_PLANE0;
 in vec4 POSITION;
 in vec4 FACENORMAL;
 in vec4 NORMAL;
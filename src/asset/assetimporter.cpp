@@ -2,6 +2,8 @@
 #include "assetimporter.h"
 #include "shadersourceloaderGL.h"
 #include "modelimporter.h"
+#include "graphics/animation/animation.h"
+#include "graphics/animation/compressedanimation.h"
 #include "global/global.h"
 #include "global/assert.h"
 #include "debug/gtedebug.h"
@@ -33,7 +35,14 @@ namespace GTE {
 
     AnimationSharedPtr AssetImporter::LoadAnimation(const std::string& filePath, Bool addLoopPadding) const {
         ModelImporter importer;
-        return importer.LoadAnimation(filePath, addLoopPadding, GetBoolProperty(AssetImporterBoolProperty::PreserveFBXPivots));
+        AnimationSharedPtr animation = importer.LoadAnimation(filePath, addLoopPadding, GetBoolProperty(AssetImporterBoolProperty::PreserveFBXPivots));
+
+        if (animation.IsValid() && GetBoolProperty(AssetImporterBoolProperty::CompressAnimations)) {
+            Bool compressSuccess = animation->Compress(AnimationCompressionSettings());
+            NONFATAL_ASSERT(compressSuccess, "AssetImporter::LoadAnimation -> Unable to compress animation.", false);
+        }
+
+        return animation;
     }
 
     void AssetImporter::LoadBuiltInShaderSource(const std::string name, ShaderSource& shaderSource) {
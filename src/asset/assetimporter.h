@@ -13,7 +13,8 @@ namespace GTE {
 
     enum class AssetImporterBoolProperty {
         PreserveFBXPivots = 0,
-        _Count = 1,
+        CompressAnimations = 1,
+        _Count = 2,
     };
 
     class AssetImporter {
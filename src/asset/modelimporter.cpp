@@ -219,7 +219,7 @@ namespace GTE {
                 // if the transformation matrix for this scene object has an inverted scale, we need to process the
                 // vertex bone map in reverse order. we pass the [reverseVertexOrder] flag to SetupVertexBoneMapForRenderer()
                 Bool reverseVertexOrder = HasOddReflections(mat);
-                SetupVertexBoneMapForRenderer(scene, skeletonClone, skinnedRenderer, reverseVertexOrder);
+                SetupVertexBoneMapForRenderer(scene, skeletonClone, skinnedRenderer, createdSceneObjects[s]->GetMesh3D(), reverseVertexOrder);
             }
         }
         return root;
@@ -340,6 +340,15 @@ namespace GTE {
 
                 // add the mesh to the newly created scene object
                 mesh3D->SetSubMesh(subMesh3D, n);
+
+                if (subMesh3D->IsVertexCacheOptimized()) {
+                    const VertexCacheStatistics& original = subMesh3D->GetOriginalVertexCacheStatistics();
+                    const VertexCacheStatistics& optimized = subMesh3D->GetOptimizedVertexCacheStatistics();
+                    std::string msg = std::string("ModelImporter::RecursiveProcessModelScene -> Vertex cache optimization for mesh '") + mesh->mName.C_Str() +
+                        std::string("': ACMR ") + std::to_string(original.ACMR) + std::string(" -> ") + std::to_string(optimized.ACMR) +
+                        std::string(", ATVR ") + std::to_string(original.ATVR) + std::string(" -> ") + std::to_string(optimized.ATVR);
+                    Debug::PrintMessage(msg);
+                }
             }
 
             Mesh3DFilterSharedPtr filter = engineObjectManager->CreateMesh3DFilter();
@@ -380,17 +389,8 @@ namespace GTE {
             if (nodeMapping >= 0) {
                 SkeletonNode * node = skeleton->GetNodeFromList(nodeMapping);
                 if (node != nullptr) {
-                    node->InitialTransform = mat;
-
-                    Vector3 scale;
-                    Vector3 translation;
-                    Quaternion rotation;
-
                     // set the initial transformation properties
-                    mat.Decompose(translation, rotation, scale);
-                    node->InitialTranslation = translation;
-                    node->InitialRotation = rotation;
-                    node->InitialScale = scale;
+                    node->SetInitialTransform(mat);
 
                     // if this skeleton node has a SceneObject target, then set it to [sceneObject]
                     SceneObjectSkeletonNode *soskNode = dynamic_cast<SceneObjectSkeletonNode*>(node);
@@ -465,6 +465,31 @@ namespace GTE {
             return SubMesh3DSharedPtr::Null();
         }
 
+        // bone attachments of each Assimp vertex (the number of each bone in the Assimp mesh's list of bones, followed by
+        // the weights), in the same order as SetupVertexBoneMapMappingsFromAIMesh() assigns them to the vertex bone map
+        const UInt32 boneKeySize = Constants::MaxBonesPerVertex * 2;
+        std::vector<Real> vertexBoneKeys;
+        std::vector<Real> boneAttachmentKeys;
+        if (mesh.HasBones()) {
+            vertexBoneKeys.assign(mesh.mNumVertices * boneKeySize, 0);
+            std::vector<UInt32> vertexBoneCounts(mesh.mNumVertices, 0);
+            for (UInt32 b = 0; b < mesh.mNumBones; b++) {
+                const aiBone * bone = mesh.mBones[b];
+                if (bone == nullptr)continue;
+
+                for (UInt32 w = 0; w < bone->mNumWeights; w++) {
+                    UInt32 vertexID = bone->mWeights[w].mVertexId;
+                    if (vertexID >= mesh.mNumVertices || vertexBoneCounts[vertexID] >= Constants::MaxBonesPerVertex)continue;
+
+                    Real * key = vertexBoneKeys.data() + vertexID * boneKeySize;
+                    key[vertexBoneCounts[vertexID]] = (Real)(b + 1);
+                    key[Constants::MaxBonesPerVertex + vertexBoneCounts[vertexID]] = bone->mWeights[w].mWeight;
+                    vertexBoneCounts[vertexID]++;
+                }
+            }
+            boneAttachmentKeys.resize(vertexCount * boneKeySize);
+        }
+
         Int32 vertexIndex = 0;
 
         // loop through each face in the mesh and copy relevant vertex attributes
@@ -511,11 +536,21 @@ namespace GTE {
                     else uvs->GetElement(vertexIndex)->Set(mesh.mTextureCoords[diffuseTextureUVIndex][vIndex].x, mesh.mTextureCoords[diffuseTextureUVIndex][vIndex].y);
                 }
 
+                // copy the bone attachments, so vertices attached to different bones are not merged
+                if (vertexBoneKeys.size() > 0) {
+                    memcpy(boneAttachmentKeys.data() + vertexIndex * boneKeySize, vertexBoneKeys.data() + vIndex * boneKeySize, boneKeySize * sizeof(Real));
+                }
+
                 vertexIndex++;
             }
         }
         if (invert)mesh3D->SetInvertNormals(true);
         mesh3D->SetNormalsSmoothingThreshold(80);
+        if (boneAttachmentKeys.size() > 0)mesh3D->SetBoneAttachmentKeys(boneAttachmentKeys, boneKeySize);
+        // render the mesh from its unique vertices, in an order that suits the post-transform vertex cache. the
+        // vertex bone map of a skinned mesh is created later and follows the new triangle order (see SetupVertexBoneMapForRenderer())
+        mesh3D->SetBuildIndices(true);
+        mesh3D->SetOptimizeVertexCache(true);
         return mesh3D;
     }
 
@@ -807,10 +842,29 @@ namespace GTE {
         }
     }
 
-    void ModelImporter::SetupVertexBoneMapForRenderer(const aiScene& scene, SkeletonSharedPtr skeleton, SkinnedMesh3DRendererSharedPtr target, Bool reverseVertexOrder) const {
+    /**
+     * Create a vertex bone map for each Assimp mesh in [scene] that has bones and add it to [target]. The triangles of the
+     * sub-meshes of [mesh] may have been reordered for the post-transform vertex cache when they were converted, so each
+     * vertex bone map follows the triangle order of the sub-mesh that is mapped to it.
+     */
+    void ModelImporter::SetupVertexBoneMapForRenderer(const aiScene& scene, SkeletonSharedPtr skeleton, SkinnedMesh3DRendererSharedPtr target, Mesh3DRef mesh, Bool reverseVertexOrder) const {
+        std::vector<UInt32> originalTriangleOrder;
+
         for (UInt32 m = 0; m < scene.mNumMeshes; m++) {
             aiMesh * cMesh = scene.mMeshes[m];
             if (cMesh != nullptr && cMesh->mNumBones > 0) {
+                // find the sub-mesh that was converted from [cMesh]
+                const std::vector<UInt32> * triangleOrder = &originalTriangleOrder;
+                if (mesh.IsValid()) {
+                    for (UInt32 n = 0; n < mesh->GetSubMeshCount(); n++) {
+                        SubMesh3DRef subMesh = mesh->GetSubMesh(n);
+                        if (subMesh.IsValid() && target->GetVertexBoneMapIndex(n) == (Int32)m) {
+                            triangleOrder = &subMesh->GetVertexCacheTriangleOrder();
+                            break;
+                        }
+                    }
+                }
+
                 VertexBoneMap indexBoneMap(cMesh->mNumVertices, cMesh->mNumVertices);
 
                 Bool mapInitSuccess = indexBoneMap.Init();
@@ -820,7 +874,7 @@ namespace GTE {
 
                 SetupVertexBoneMapMappingsFromAIMesh(skeleton, *cMesh, indexBoneMap);
 
-                VertexBoneMap * fullBoneMap = ExpandIndexBoneMapping(indexBoneMap, *cMesh, reverseVertexOrder);
+                VertexBoneMap * fullBoneMap = ExpandIndexBoneMapping(indexBoneMap, *cMesh, *triangleOrder, reverseVertexOrder);
                 if (fullBoneMap == nullptr) {
                     Debug::PrintError("ModelImporter::SetupVertexBoneMapForRenderer -> Could not create full vertex bone map.");
                 }
@@ -869,7 +923,14 @@ namespace GTE {
         return target;
     }
 
-    VertexBoneMap * ModelImporter::ExpandIndexBoneMapping(VertexBoneMap& indexBoneMap, const aiMesh& mesh, Bool reverseVertexOrder) const {
+    /**
+     * Create a vertex bone map with an entry for each corner of each face of [mesh] from [indexBoneMap], which has an
+     * entry for each Assimp vertex. If [triangleOrder] is not empty, it holds the Assimp face for each triangle of the
+     * converted sub-mesh (see SubMesh3D::GetVertexCacheTriangleOrder()), otherwise the faces keep their original order.
+     */
+    VertexBoneMap * ModelImporter::ExpandIndexBoneMapping(VertexBoneMap& indexBoneMap, const aiMesh& mesh, const std::vector<UInt32>& triangleOrder, Bool reverseVertexOrder) const {
+        NONFATAL_ASSERT_RTRN(triangleOrder.size() == 0 || triangleOrder.size() == mesh.mNumFaces, "ModelImporter::ExpandIndexBoneMapping -> Triangle order does not match the mesh.", nullptr, true);
+
         VertexBoneMap * fullBoneMap = new(std::nothrow) VertexBoneMap(mesh.mNumFaces * 3, mesh.mNumVertices);
         if (fullBoneMap == nullptr) {
             Debug::PrintError("ModelImporter::ExpandIndexBoneMapping -> Could not allocate vertex bone map.");
@@ -883,7 +944,8 @@ namespace GTE {
         }
 
         unsigned fullIndex = 0;
-        for (UInt32 f = 0; f < mesh.mNumFaces; f++) {
+        for (UInt32 t = 0; t < mesh.mNumFaces; t++) {
+            UInt32 f = triangleOrder.size() > 0 ? triangleOrder[t] : t;
             aiFace& face = mesh.mFaces[f];
 
             Int32 start, end, inc;
@@ -115,10 +115,10 @@ namespace GTE {
                                                   UInt32 meshIndex, MaterialImportDescriptor& materialImportDesc) const;
         static void GetImportDetails(const aiMaterial* mtl, MaterialImportDescriptor& materialImportDesc, const aiScene& scene);
         SubMesh3DSharedPtr ConvertAssimpMesh(UInt32 meshIndex, const aiScene& scene, MaterialImportDescriptor& materialImportDescriptor, Bool invert) const;
-        void SetupVertexBoneMapForRenderer(const aiScene& scene, SkeletonSharedPtr skeleton, SkinnedMesh3DRendererSharedPtr target, Bool reverseVertexOrder) const;
+        void SetupVertexBoneMapForRenderer(const aiScene& scene, SkeletonSharedPtr skeleton, SkinnedMesh3DRendererSharedPtr target, Mesh3DRef mesh, Bool reverseVertexOrder) const;
 
         SkeletonSharedPtr LoadSkeleton(const aiScene& scene) const;
-        VertexBoneMap * ExpandIndexBoneMapping(VertexBoneMap& indexBoneMap, const aiMesh& mesh, Bool reverseVertexOrder) const;
+        VertexBoneMap * ExpandIndexBoneMapping(VertexBoneMap& indexBoneMap, const aiMesh& mesh, const std::vector<UInt32>& triangleOrder, Bool reverseVertexOrder) const;
         void AddMeshBoneMappingsToSkeleton(SkeletonSharedPtr skeleton, const aiMesh& mesh, UInt32& currentBoneIndex) const;
         void SetupVertexBoneMapMappingsFromAIMesh(SkeletonSharedConstPtr skeleton, const aiMesh& mesh, VertexBoneMap& vertexIndexBoneMap) const;
         unsigned CountBones(const aiScene& scene) const;
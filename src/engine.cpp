@@ -12,6 +12,7 @@
 #include "global/global.h"
 #include "global/assert.h"
 #include "util/time.h"
+#include "util/workerpool.h"
 #include "debug/gtedebug.h"
 
 namespace GTE {
@@ -30,6 +31,7 @@ namespace GTE {
         inputManager = nullptr;
         errorManager = nullptr;
         eventManager = nullptr;
+        workerPool = nullptr;
         callbacks = nullptr;
 
         initialized = false;
@@ -48,6 +50,7 @@ namespace GTE {
         SAFE_DELETE(graphicsSystem);
         SAFE_DELETE(errorManager);
         SAFE_DELETE(eventManager);
+        SAFE_DELETE(workerPool);
     }
 
     EngineCallbacks::~EngineCallbacks() {
@@ -83,6 +86,14 @@ namespace GTE {
         errorManager = new(std::nothrow) ErrorManager();
         ASSERT(errorManager != nullptr, "Engine::Init -> Unable to create error manager.");
 
+        // use one worker thread for each additional hardware thread
+        workerPool = new(std::nothrow) WorkerPool();
+        ASSERT(workerPool != nullptr, "Engine::Init -> Unable to create worker pool.");
+
+        UInt32 hardwareThreads = std::thread::hardware_concurrency();
+        Bool workerPoolInitSuccess = workerPool->Init(hardwareThreads > 1 ? hardwareThreads - 1 : 0);
+        ASSERT(workerPoolInitSuccess == true, "Engine::Init -> Unable to initialize worker pool.");
+
         engineObjectManager = new(std::nothrow) EngineObjectManager();
         ASSERT(engineObjectManager != nullptr, "Engine::Init -> Unable to create engine object manager.");
 
@@ -280,5 +291,12 @@ namespace GTE {
     SceneManager * Engine::GetSceneManager() {
         return sceneManager;
     }
+
+    /*
+    * Access the WorkerPool component.
+    */
+    WorkerPool * Engine::GetWorkerPool() {
+        return workerPool;
+    }
 }
 
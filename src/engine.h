@@ -29,6 +29,7 @@ namespace GTE {
     class GraphicsAttributes;
     class RenderManager;
     class EventManager;
+    class WorkerPool;
 
     class EngineCallbacks {
     public:
@@ -72,6 +73,9 @@ namespace GTE {
         // Manages dispatching of engine and object events
         EventManager * eventManager;
 
+        // Worker threads for splitting data-parallel work across CPU cores
+        WorkerPool * workerPool;
+
         // Registered call-backs for engine life-cycle events
         EngineCallbacks * callbacks;
 
@@ -105,6 +109,7 @@ namespace GTE {
         ErrorManager * GetErrorManager();
         EventManager * GetEventManager();
         SceneManager * GetSceneManager();
+        WorkerPool * GetWorkerPool();
     };
 }
 
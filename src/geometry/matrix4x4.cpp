@@ -23,11 +23,13 @@
 #include "quaternion.h"
 #include "point/point3.h"
 #include "vector/vector3.h"
+#include "base/basevectorarray.h"
 #include "debug/gtedebug.h"
 #include "global/global.h"
 #include "global/assert.h"
 #include "global/constants.h"
 #include "gtemath/gtemath.h"
+#include "gtemath/gtesimd.h"
 
 #define I(_i, _j) ((_j)+ DIM_SIZE*(_i))
 #define PI 3.14159265
@@ -328,7 +330,7 @@ namespace GTE {
      * Transform [vector] by this matrix
      */
     void Matrix4x4::Transform(Vector3& vector) const {
-        Real temp[DIM_SIZE];
+        Real temp[DIM_SIZE] = { 0 };
         MultiplyMV(this->data, vector.GetDataPtr(), temp);
         memcpy(vector.GetDataPtr(), temp, sizeof(Real) * DIM_SIZE);
     }
@@ -337,7 +339,7 @@ namespace GTE {
      * Transform [point] by this matrix
      */
     void Matrix4x4::Transform(Point3& point) const {
-        Real temp[DIM_SIZE];
+        Real temp[DIM_SIZE] = { 0 };
         MultiplyMV(this->data, point.GetDataPtr(), temp);
         memcpy(point.GetDataPtr(), temp, sizeof(Real) * DIM_SIZE);
     }
@@ -353,6 +355,38 @@ namespace GTE {
         memcpy(vector4f, temp, sizeof(Real) * DIM_SIZE);
     }
 
+    /*
+     * Transform each vector in [vectors] by this matrix and store the results in [out], which
+     * must contain at least as many elements as [vectors].
+     */
+    void Matrix4x4::Transform(const Vector3Array& vectors, Vector3Array& out) const {
+        NONFATAL_ASSERT(out.GetCount() >= vectors.GetCount(), "Matrix4x4::Transform(Vector3Array) -> 'out' is too small.", true);
+        MultiplyMVBatch(this->data, vectors.GetConstDataPtr(), out.GetDataPtr(), vectors.GetCount());
+    }
+
+    /*
+     * Transform each vector in [vectors] by this matrix
+     */
+    void Matrix4x4::Transform(Vector3Array& vectors) const {
+        MultiplyMVBatch(this->data, vectors.GetConstDataPtr(), vectors.GetDataPtr(), vectors.GetCount());
+    }
+
+    /*
+     * Transform each point in [points] by this matrix and store the results in [out], which
+     * must contain at least as many elements as [points].
+     */
+    void Matrix4x4::Transform(const Point3Array& points, Point3Array& out) const {
+        NONFATAL_ASSERT(out.GetCount() >= points.GetCount(), "Matrix4x4::Transform(Point3Array) -> 'out' is too small.", true);
+        MultiplyMVBatch(this->data, points.GetConstDataPtr(), out.GetDataPtr(), points.GetCount());
+    }
+
+    /*
+     * Transform each point in [points] by this matrix
+     */
+    void Matrix4x4::Transform(Point3Array& points) const {
+        MultiplyMVBatch(this->data, points.GetConstDataPtr(), points.GetDataPtr(), points.GetCount());
+    }
+
     /*
      * Add [matrix] to this matrix
      */
@@ -403,7 +437,88 @@ namespace GTE {
         NONFATAL_ASSERT(rhsVec != nullptr, "Matrix4x4::MultiplyMV -> 'rhsVec' is null.", true);
         NONFATAL_ASSERT(out != nullptr, "Matrix4x4::MultiplyMV -> 'out' is null.", true);
 
+#if defined(_GTE_SIMD_SSE)
+        __m128 result = _mm_mul_ps(_mm_loadu_ps(lhsMat), _mm_set1_ps(rhsVec[0]));
+        result = _mm_add_ps(result, _mm_mul_ps(_mm_loadu_ps(lhsMat + 4), _mm_set1_ps(rhsVec[1])));
+        result = _mm_add_ps(result, _mm_mul_ps(_mm_loadu_ps(lhsMat + 8), _mm_set1_ps(rhsVec[2])));
+        result = _mm_add_ps(result, _mm_mul_ps(_mm_loadu_ps(lhsMat + 12), _mm_set1_ps(rhsVec[3])));
+        _mm_storeu_ps(out, result);
+#elif defined(_GTE_SIMD_NEON)
+        float32x4_t result = vmulq_n_f32(vld1q_f32(lhsMat), rhsVec[0]);
+        result = vaddq_f32(result, vmulq_n_f32(vld1q_f32(lhsMat + 4), rhsVec[1]));
+        result = vaddq_f32(result, vmulq_n_f32(vld1q_f32(lhsMat + 8), rhsVec[2]));
+        result = vaddq_f32(result, vmulq_n_f32(vld1q_f32(lhsMat + 12), rhsVec[3]));
+        vst1q_f32(out, result);
+#else
         Mx4transform(rhsVec[0], rhsVec[1], rhsVec[2], rhsVec[3], lhsMat, out);
+#endif
+    }
+
+    /*
+     * Transform [count] consecutive 4-component vectors pointed to by [rhsVecs], by the matrix pointed
+     * to by [lhsMat], and store the results in [out]. [out] may point to the same memory as [rhsVecs].
+     */
+    void Matrix4x4::MultiplyMVBatch(const Real * lhsMat, const Real * rhsVecs, Real * out, UInt32 count) {
+        NONFATAL_ASSERT(lhsMat != nullptr, "Matrix4x4::MultiplyMVBatch -> 'lhsMat' is null.", true);
+        NONFATAL_ASSERT(rhsVecs != nullptr, "Matrix4x4::MultiplyMVBatch -> 'rhsVecs' is null.", true);
+        NONFATAL_ASSERT(out != nullptr, "Matrix4x4::MultiplyMVBatch -> 'out' is null.", true);
+
+        UInt32 i = 0;
+
+#if defined(_GTE_SIMD_AVX)
+        // the columns of the matrix are duplicated into both 128-bit lanes so that two vectors
+        // can be transformed at once
+        __m256 c0 = _mm256_broadcast_ps((const __m128*)(lhsMat));
+        __m256 c1 = _mm256_broadcast_ps((const __m128*)(lhsMat + 4));
+        __m256 c2 = _mm256_broadcast_ps((const __m128*)(lhsMat + 8));
+        __m256 c3 = _mm256_broadcast_ps((const __m128*)(lhsMat + 12));
+
+        for (; i + 1 < count; i += 2) {
+            __m256 v = _mm256_loadu_ps(rhsVecs + i * DIM_SIZE);
+            __m256 result = _mm256_mul_ps(c0, _mm256_permute_ps(v, 0x00));
+            result = _mm256_add_ps(result, _mm256_mul_ps(c1, _mm256_permute_ps(v, 0x55)));
+            result = _mm256_add_ps(result, _mm256_mul_ps(c2, _mm256_permute_ps(v, 0xAA)));
+            result = _mm256_add_ps(result, _mm256_mul_ps(c3, _mm256_permute_ps(v, 0xFF)));
+            _mm256_storeu_ps(out + i * DIM_SIZE, result);
+        }
+#endif
+
+#if defined(_GTE_SIMD_SSE)
+        __m128 c0s = _mm_loadu_ps(lhsMat);
+        __m128 c1s = _mm_loadu_ps(lhsMat + 4);
+        __m128 c2s = _mm_loadu_ps(lhsMat + 8);
+        __m128 c3s = _mm_loadu_ps(lhsMat + 12);
+
+        for (; i < count; i++) {
+            __m128 v = _mm_loadu_ps(rhsVecs + i * DIM_SIZE);
+            __m128 result = _mm_mul_ps(c0s, _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0)));
+            result = _mm_add_ps(result, _mm_mul_ps(c1s, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1))));
+            result = _mm_add_ps(result, _mm_mul_ps(c2s, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2))));
+            result = _mm_add_ps(result, _mm_mul_ps(c3s, _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3))));
+            _mm_storeu_ps(out + i * DIM_SIZE, result);
+        }
+#elif defined(_GTE_SIMD_NEON)
+        float32x4_t c0 = vld1q_f32(lhsMat);
+        float32x4_t c1 = vld1q_f32(lhsMat + 4);
+        float32x4_t c2 = vld1q_f32(lhsMat + 8);
+        float32x4_t c3 = vld1q_f32(lhsMat + 12);
+
+        for (; i < count; i++) {
+            float32x4_t v = vld1q_f32(rhsVecs + i * DIM_SIZE);
+            float32x4_t result = vmulq_n_f32(c0, vgetq_lane_f32(v, 0));
+            result = vaddq_f32(result, vmulq_n_f32(c1, vgetq_lane_f32(v, 1)));
+            result = vaddq_f32(result, vmulq_n_f32(c2, vgetq_lane_f32(v, 2)));
+            result = vaddq_f32(result, vmulq_n_f32(c3, vgetq_lane_f32(v, 3)));
+            vst1q_f32(out + i * DIM_SIZE, result);
+        }
+#else
+        for (; i < count; i++) {
+            const Real * v = rhsVecs + i * DIM_SIZE;
+            Real temp[DIM_SIZE];
+            Mx4transform(v[0], v[1], v[2], v[3], lhsMat, temp);
+            memcpy(out + i * DIM_SIZE, temp, sizeof(Real) * DIM_SIZE);
+        }
+#endif
     }
 
     /*
@@ -435,6 +550,36 @@ namespace GTE {
     *********************************************************/
 
     void Matrix4x4::MultiplyMM(const Real * lhs, const Real *rhs, Real * out) {
+#if defined(_GTE_SIMD_SSE)
+        // each column of [out] is a linear combination of the columns of [lhs]
+        __m128 c0 = _mm_loadu_ps(lhs);
+        __m128 c1 = _mm_loadu_ps(lhs + 4);
+        __m128 c2 = _mm_loadu_ps(lhs + 8);
+        __m128 c3 = _mm_loadu_ps(lhs + 12);
+
+        for (Int32 i = 0; i < DIM_SIZE; i++) {
+            const Real * rhsColumn = rhs + i * DIM_SIZE;
+            __m128 result = _mm_mul_ps(c0, _mm_set1_ps(rhsColumn[0]));
+            result = _mm_add_ps(result, _mm_mul_ps(c1, _mm_set1_ps(rhsColumn[1])));
+            result = _mm_add_ps(result, _mm_mul_ps(c2, _mm_set1_ps(rhsColumn[2])));
+            result = _mm_add_ps(result, _mm_mul_ps(c3, _mm_set1_ps(rhsColumn[3])));
+            _mm_storeu_ps(out + i * DIM_SIZE, result);
+        }
+#elif defined(_GTE_SIMD_NEON)
+        float32x4_t c0 = vld1q_f32(lhs);
+        float32x4_t c1 = vld1q_f32(lhs + 4);
+        float32x4_t c2 = vld1q_f32(lhs + 8);
+        float32x4_t c3 = vld1q_f32(lhs + 12);
+
+        for (Int32 i = 0; i < DIM_SIZE; i++) {
+            const Real * rhsColumn = rhs + i * DIM_SIZE;
+            float32x4_t result = vmulq_n_f32(c0, rhsColumn[0]);
+            result = vaddq_f32(result, vmulq_n_f32(c1, rhsColumn[1]));
+            result = vaddq_f32(result, vmulq_n_f32(c2, rhsColumn[2]));
+            result = vaddq_f32(result, vmulq_n_f32(c3, rhsColumn[3]));
+            vst1q_f32(out + i * DIM_SIZE, result);
+        }
+#else
         for (Int32 i = 0; i < DIM_SIZE; i++) {
             const Real rhs_i0 = rhs[I(i, 0)];
             Real ri0 = lhs[I(0, 0)] * rhs_i0;
@@ -453,6 +598,7 @@ namespace GTE {
             out[I(i, 2)] = ri2;
             out[I(i, 3)] = ri3;
         }
+#endif
     }
 
     /*
@@ -518,6 +664,79 @@ namespace GTE {
         NONFATAL_ASSERT_RTRN(source != nullptr, "Matrix4x4::Invert -> 'source' is null.", false, true);
         NONFATAL_ASSERT_RTRN(dest != nullptr, "Matrix4x4::Invert -> 'dest' is null.", false, true);
 
+#if defined(_GTE_SIMD_SSE)
+        // Invert using 2x2 block matrices. The columns of [source] are treated as the rows of a row-major
+        // matrix; since inverse(transpose(M)) = transpose(inverse(M)), the result can be stored the same way.
+        //
+        //   M = | A  B |    inverse(M) = 1/|M| * | X  Y |
+        //       | C  D |                         | Z  W |
+        //
+        // Each 2x2 block is stored in a single register as (m00, m01, m10, m11). '#' denotes the adjugate.
+        __m128 col0 = _mm_loadu_ps(source);
+        __m128 col1 = _mm_loadu_ps(source + 4);
+        __m128 col2 = _mm_loadu_ps(source + 8);
+        __m128 col3 = _mm_loadu_ps(source + 12);
+
+        __m128 blockA = _mm_movelh_ps(col0, col1);
+        __m128 blockB = _mm_movehl_ps(col1, col0);
+        __m128 blockC = _mm_movelh_ps(col2, col3);
+        __m128 blockD = _mm_movehl_ps(col3, col2);
+
+        // determinants of the blocks: (|A|, |B|, |C|, |D|)
+        __m128 blockDets = _mm_sub_ps(
+            _mm_mul_ps(_mm_shuffle_ps(col0, col2, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(col1, col3, _MM_SHUFFLE(3, 1, 3, 1))),
+            _mm_mul_ps(_mm_shuffle_ps(col0, col2, _MM_SHUFFLE(3, 1, 3, 1)), _mm_shuffle_ps(col1, col3, _MM_SHUFFLE(2, 0, 2, 0))));
+        __m128 detA = _mm_shuffle_ps(blockDets, blockDets, _MM_SHUFFLE(0, 0, 0, 0));
+        __m128 detB = _mm_shuffle_ps(blockDets, blockDets, _MM_SHUFFLE(1, 1, 1, 1));
+        __m128 detC = _mm_shuffle_ps(blockDets, blockDets, _MM_SHUFFLE(2, 2, 2, 2));
+        __m128 detD = _mm_shuffle_ps(blockDets, blockDets, _MM_SHUFFLE(3, 3, 3, 3));
+
+        // 2x2 products: Mul(a, b) = a * b, AdjMul(a, b) = a# * b, MulAdj(a, b) = a * b#
+        auto mat2Mul = [](__m128 a, __m128 b) -> __m128 {
+            return _mm_add_ps(_mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 3, 0))),
+                _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 2, 1, 2))));
+        };
+        auto mat2AdjMul = [](__m128 a, __m128 b) -> __m128 {
+            return _mm_sub_ps(_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 3, 3)), b),
+                _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 1, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 0, 3, 2))));
+        };
+        auto mat2MulAdj = [](__m128 a, __m128 b) -> __m128 {
+            return _mm_sub_ps(_mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 3, 0, 3))),
+                _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 2, 1, 2))));
+        };
+
+        __m128 adjDC = mat2AdjMul(blockD, blockC);
+        __m128 adjAB = mat2AdjMul(blockA, blockB);
+
+        // X# = |D|A - B(D#C), W# = |A|D - C(A#B), Y# = |B|C - D(A#B)#, Z# = |C|B - A(D#C)#
+        __m128 adjX = _mm_sub_ps(_mm_mul_ps(detD, blockA), mat2Mul(blockB, adjDC));
+        __m128 adjW = _mm_sub_ps(_mm_mul_ps(detA, blockD), mat2Mul(blockC, adjAB));
+        __m128 adjY = _mm_sub_ps(_mm_mul_ps(detB, blockC), mat2MulAdj(blockD, adjAB));
+        __m128 adjZ = _mm_sub_ps(_mm_mul_ps(detC, blockB), mat2MulAdj(blockA, adjDC));
+
+        // |M| = |A||D| + |B||C| - trace((A#B)(D#C))
+        __m128 trace = _mm_mul_ps(adjAB, _mm_shuffle_ps(adjDC, adjDC, _MM_SHUFFLE(3, 1, 2, 0)));
+        trace = _mm_add_ps(trace, _mm_movehl_ps(trace, trace));
+        trace = _mm_add_ss(trace, _mm_shuffle_ps(trace, trace, _MM_SHUFFLE(1, 1, 1, 1)));
+        __m128 detM = _mm_sub_ss(_mm_add_ss(_mm_mul_ss(detA, detD), _mm_mul_ss(detB, detC)), trace);
+
+        if (_mm_cvtss_f32(detM) == 0.0f) {
+            return false;
+        }
+
+        // (1/|M|, -1/|M|, -1/|M|, 1/|M|) applies the sign pattern of the adjugate
+        __m128 invDetM = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), _mm_shuffle_ps(detM, detM, _MM_SHUFFLE(0, 0, 0, 0)));
+        adjX = _mm_mul_ps(adjX, invDetM);
+        adjY = _mm_mul_ps(adjY, invDetM);
+        adjZ = _mm_mul_ps(adjZ, invDetM);
+        adjW = _mm_mul_ps(adjW, invDetM);
+
+        // complete the adjugates and re-assemble the blocks into columns
+        _mm_storeu_ps(dest, _mm_shuffle_ps(adjX, adjY, _MM_SHUFFLE(1, 3, 1, 3)));
+        _mm_storeu_ps(dest + 4, _mm_shuffle_ps(adjX, adjY, _MM_SHUFFLE(0, 2, 0, 2)));
+        _mm_storeu_ps(dest + 8, _mm_shuffle_ps(adjZ, adjW, _MM_SHUFFLE(1, 3, 1, 3)));
+        _mm_storeu_ps(dest + 12, _mm_shuffle_ps(adjZ, adjW, _MM_SHUFFLE(0, 2, 0, 2)));
+#else
         // array of transpose source matrix
         Real src[DATA_SIZE];
 
@@ -606,6 +825,7 @@ namespace GTE {
         det = 1 / det;
         for (Int32 j = 0; j < DATA_SIZE; j++)
             dest[j] = dst[j] * det;
+#endif
 
         // if the matrix was affine before inversion, make it affine again
         // to avoid accumulating preicision errors
@@ -32,6 +32,7 @@ namespace GTE {
     class Point3;
     class Vector3;
     class Quaternion;
+    template <class T> class BaseVectorArray;
 
     class Matrix4x4 {
         static const Int32 DATA_SIZE = 16;
@@ -80,12 +81,17 @@ namespace GTE {
         void Transform(const Point3& point, Point3& out) const;
         void Transform(Point3& point) const;
         void Transform(Real * vector4f) const;
+        void Transform(const BaseVectorArray<Vector3>& vectors, BaseVectorArray<Vector3>& out) const;
+        void Transform(BaseVectorArray<Vector3>& vectors) const;
+        void Transform(const BaseVectorArray<Point3>& points, BaseVectorArray<Point3>& out) const;
+        void Transform(BaseVectorArray<Point3>& points) const;
         void Add(const Matrix4x4& matrix);
         void Multiply(const Matrix4x4& matrix);
         void PreMultiply(const Matrix4x4& matrix);
         void Multiply(const Matrix4x4& matrix, Matrix4x4& out) const;
         static void Multiply(const Matrix4x4& lhs, const Matrix4x4& rhs, Matrix4x4& out);
         static void MultiplyMV(const Real * lhsMat, const Real * rhsVec, Real * out);
+        static void MultiplyMVBatch(const Real * lhsMat, const Real * rhsVecs, Real * out, UInt32 count);
         static void MultiplyMM(const Real * lhs, const Real *rhs, Real * out);
 
         void Translate(const Vector3& vector);
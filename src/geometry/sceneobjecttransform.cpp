@@ -1,5 +1,7 @@
 #include "sceneobjecttransform.h"
 #include "scene/sceneobject.h"
+#include "scene/scenemanager.h"
+#include "scene/scenetransformpool.h"
 #include "debug/gtedebug.h"
 #include "global/constants.h"
 #include "global/global.h"
@@ -14,6 +16,8 @@ namespace GTE {
 */
     SceneObjectTransform::SceneObjectTransform() : Transform() {
         sceneObject = nullptr;
+        worldMatrixDirty = true;
+        worldMatrixInverseDirty = true;
     }
 
     /*
@@ -21,6 +25,8 @@ namespace GTE {
      */
     SceneObjectTransform::SceneObjectTransform(SceneObject * sceneObject) : Transform() {
         this->sceneObject = sceneObject;
+        worldMatrixDirty = true;
+        worldMatrixInverseDirty = true;
     }
 
     /*
@@ -42,12 +48,84 @@ namespace GTE {
      */
     void SceneObjectTransform::SetLocalComponents(const Vector3& translation, const Quaternion& rotation, const Vector3& scale) {
         matrix.BuildFromComponents(translation, rotation, scale);
+        OnMatrixUpdated();
     }
 
     /*
-     * Walk up the scene object tree, beginning with the parent of this transform's
-     * scene object, and concatenate each ancestor's transform to form the transform
-     * that is inherited by connected scene object.
+     * The local transformation of [sceneObject] has changed, so its world matrix, and
+     * those of all its descendants, are no longer valid. If [sceneObject] is stored in the
+     * scene manager's transform pool, the pool's copy of the local matrix is updated as well.
+     */
+    void SceneObjectTransform::OnMatrixUpdated() {
+        InvalidateWorldMatrix();
+
+        if (sceneObject != nullptr && sceneObject->GetTransformPoolHandle() != SceneTransformPool::InvalidHandle) {
+            Engine::Instance()->GetSceneManager()->GetTransformPool().SetLocalMatrix(sceneObject->GetTransformPoolHandle(), matrix);
+        }
+    }
+
+    /*
+     * Flag the cached world matrix of this transform and those of the transforms of all descendants
+     * of [sceneObject] as needing to be recalculated. A dirty world matrix always implies that the world
+     * matrices of all descendants are dirty as well, so there is no need to descend any further when
+     * an already-dirty transform is encountered.
+     */
+    void SceneObjectTransform::InvalidateWorldMatrix() {
+        if (worldMatrixDirty)return;
+
+        worldMatrixDirty = true;
+        worldMatrixInverseDirty = true;
+
+        if (sceneObject != nullptr) {
+            for (UInt32 i = 0; i < sceneObject->GetChildrenCount(); i++) {
+                SceneObjectRef child = sceneObject->GetChildAt(i);
+                if (child.IsValid()) {
+                    child->GetTransform().InvalidateWorldMatrix();
+                }
+            }
+        }
+    }
+
+    /*
+     * Get the full local-to-world matrix for [sceneObject], which is the concatenation of the transforms of
+     * all its ancestors (up to the first ancestor that does not inherit its parent's transform) and its own
+     * transform. The matrix is only recalculated if it has been invalidated since it was last calculated.
+     */
+    const Matrix4x4& SceneObjectTransform::GetWorldMatrix() const {
+        if (worldMatrixDirty) {
+            if (sceneObject != nullptr && sceneObject->InheritsTransform() && sceneObject->GetParent().IsValid()) {
+                Matrix4x4::Multiply(sceneObject->GetParent()->GetConstTransform().GetWorldMatrix(), matrix, worldMatrix);
+            }
+            else {
+                worldMatrix.SetTo(matrix);
+            }
+
+            worldMatrixDirty = false;
+            worldMatrixInverseDirty = true;
+        }
+
+        return worldMatrix;
+    }
+
+    /*
+     * Get the inverse of the matrix returned by GetWorldMatrix(). The inverse is only recalculated
+     * if the world matrix has changed since it was last calculated.
+     */
+    const Matrix4x4& SceneObjectTransform::GetWorldMatrixInverse() const {
+        const Matrix4x4& world = GetWorldMatrix();
+
+        if (worldMatrixInverseDirty) {
+            worldMatrixInverse.SetTo(world);
+            worldMatrixInverse.Invert();
+            worldMatrixInverseDirty = false;
+        }
+
+        return worldMatrixInverse;
+    }
+
+    /*
+     * Get the transform that is inherited by the connected scene object, which is the
+     * concatenation of each ancestor's transform.
      */
     void SceneObjectTransform::GetInheritedTransform(Transform& transform, Bool invert) const {
         GetWorldTransform(transform, sceneObject, false, invert);
@@ -73,28 +151,28 @@ namespace GTE {
     }
 
     /*
-     * Walk up the scene object tree, beginning with the parent of [sceneObject], and
-     * concatenate each ancestor's transform to form the transform that is inherited by
-     * [sceneObject].
+     * Get the concatenation of the transforms of each ancestor of [sceneObject], which is the transform
+     * inherited by [sceneObject]. If [includeSelf] is true, the transform of [sceneObject] is included as well.
+     * The cached world matrices of the scene objects involved are used, so no matrix multiplication
+     * occurs unless part of the hierarchy has changed.
      */
     void SceneObjectTransform::GetWorldTransform(Transform& transform, const SceneObject * sceneObject, Bool includeSelf, Bool invert) {
         NONFATAL_ASSERT(sceneObject != nullptr, "SceneObjectTransform::GetWorldTransform() -> 'sceneObject' is null.", true);
 
-        Transform full;
-        if (includeSelf)full.SetTo(sceneObject->GetConstTransform());
-        SceneObjectSharedPtr parent = sceneObject->GetParent();
-        Bool inheritsTransform = sceneObject->InheritsTransform();
-        while (parent.IsValid() && inheritsTransform) {
-            // Since we are processing the ancestors in reverse order (going up the tree)
-            // we pre-multiply, to have the end effect of post-multiplication in
-            // the normal order
-            full.PreTransformBy(parent->GetTransform());
-            inheritsTransform = parent->InheritsTransform();
-            parent = parent->GetParent();
+        if (includeSelf) {
+            const SceneObjectTransform& selfTransform = sceneObject->GetConstTransform();
+            transform.SetTo(invert ? selfTransform.GetWorldMatrixInverse() : selfTransform.GetWorldMatrix());
+            return;
+        }
+
+        SceneObjectRef parent = sceneObject->GetParent();
+        if (parent.IsValid() && sceneObject->InheritsTransform()) {
+            const SceneObjectTransform& parentTransform = parent->GetConstTransform();
+            transform.SetTo(invert ? parentTransform.GetWorldMatrixInverse() : parentTransform.GetWorldMatrix());
+        }
+        else {
+            transform.SetIdentity();
         }
-        // optionally invert
-        if (invert == true)full.Invert();
-        transform.SetTo(full);
     }
 
     /*
@@ -137,13 +215,9 @@ namespace GTE {
      *  and produces (FI * nWorld * F) in [localTransformation].
      */
     void SceneObjectTransform::GetLocalTransformationFromWorldTransformation(const Transform& worldTransformation, Transform& localTransformation) {
-        Transform fullInverse;
-        GetInheritedTransform(localTransformation, false);
-        localTransformation.TransformBy(this);
-        fullInverse.SetTo(localTransformation);
-        fullInverse.Invert();
+        localTransformation.SetTo(GetWorldMatrix());
         localTransformation.PreTransformBy(worldTransformation);
-        localTransformation.PreTransformBy(fullInverse);
+        localTransformation.PreTransformBy(GetWorldMatrixInverse());
     }
 
     /*
@@ -285,20 +359,14 @@ namespace GTE {
      * Shortcut to transform [vector]  by [matrix]. This transformation occurs in world space.
      */
     void SceneObjectTransform::TransformVector(Vector3& vector) const {
-        Transform full;
-        GetInheritedTransform(full, false);
-        full.TransformBy(this);
-        full.TransformVector(vector);
+        GetWorldMatrix().Transform(vector);
     }
 
     /*
      * Shortcut to transform [point]  by [matrix]. This transformation occurs in world space.
      */
     void SceneObjectTransform::TransformPoint(Point3& point) const {
-        Transform full;
-        GetInheritedTransform(full, false);
-        full.TransformBy(this);
-        full.TransformPoint(point);
+        GetWorldMatrix().Transform(point);
     }
 
     /*
@@ -307,9 +375,6 @@ namespace GTE {
     void SceneObjectTransform::TransformVector4f(Real * vector) const {
         NONFATAL_ASSERT(vector != nullptr, "SceneObjectTransform::TransformVector4f -> 'vector' is null.", true);
 
-        Transform full;
-        GetInheritedTransform(full, false);
-        full.TransformBy(this);
-        full.TransformVector4f(vector);
+        GetWorldMatrix().Transform(vector);
     }
 }
@@ -6,6 +6,11 @@
  * A SceneObjectTransform is an extension of Transform. A SceneObjectTransform is
  * different in that it is connected to a SceneObject, and whenever a world-space
  * transformation occurs, the transforms of each ancestor of said SceneObject are factored in.
+ *
+ * The full local-to-world matrix (and its inverse) is cached and only recalculated when it
+ * has been invalidated. Modifying a transform invalidates the cached matrices of its scene
+ * object and of all that scene object's descendants, so unchanged parts of the scene
+ * hierarchy never have their world matrices recalculated.
  */
 
 #ifndef _GTE_SCENEOBJECT_TRANSFORM_H_
@@ -25,6 +30,18 @@ namespace GTE {
 
         SceneObject * sceneObject;
 
+        // cached local-to-world matrix for [sceneObject]
+        mutable Matrix4x4 worldMatrix;
+        // cached inverse of [worldMatrix]
+        mutable Matrix4x4 worldMatrixInverse;
+        // does [worldMatrix] need to be recalculated?
+        mutable Bool worldMatrixDirty;
+        // does [worldMatrixInverse] need to be recalculated?
+        mutable Bool worldMatrixInverseDirty;
+
+        void OnMatrixUpdated() override;
+        void InvalidateWorldMatrix();
+
         void GetInheritedTransform(Transform& transform, Bool invert) const;
         void SetSceneObject(SceneObject* sceneObject);
         void GetLocalTransformationFromWorldTransformation(const Transform& worldTransformation, Transform& localTransformation);
@@ -39,6 +56,9 @@ namespace GTE {
         static void GetWorldTransform(Transform& transform, const SceneObject * sceneObject, Bool includeSelf, Bool invert);
         static void GetWorldTransform(Transform& transform, const SceneObject& sceneObject, Bool includeSelf, Bool invert);
 
+        const Matrix4x4& GetWorldMatrix() const;
+        const Matrix4x4& GetWorldMatrixInverse() const;
+
         void GetLocalComponents(Vector3& translation, Quaternion& rotation, Vector3& scale) const;
         void SetLocalComponents(const Vector3& translation, const Quaternion& rotation, const Vector3& scale);
 
@@ -69,6 +69,7 @@ namespace GTE {
      */
     void Transform::SetTo(const Matrix4x4& matrix) {
         this->matrix.SetTo(matrix);
+        OnMatrixUpdated();
     }
 
     /*
@@ -76,6 +77,7 @@ namespace GTE {
      */
     void Transform::SetTo(const Transform& transform) {
         transform.CopyMatrix(matrix);
+        OnMatrixUpdated();
     }
 
     /*
@@ -84,10 +86,12 @@ namespace GTE {
     void Transform::SetTo(const Real * matrixData) {
         NONFATAL_ASSERT(matrixData != nullptr, "Transform::SetTo -> 'matrixData' is null.", true);
         matrix.SetTo(matrixData);
+        OnMatrixUpdated();
     }
 
     void Transform::SetIdentity() {
         matrix.SetIdentity();
+        OnMatrixUpdated();
     }
 
     /*
@@ -95,6 +99,7 @@ namespace GTE {
      */
     void Transform::TransformBy(const Matrix4x4& matrix) {
         this->matrix.Multiply(matrix);
+        OnMatrixUpdated();
     }
 
     /*
@@ -102,6 +107,7 @@ namespace GTE {
      */
     void Transform::PreTransformBy(const Matrix4x4& matrix) {
         this->matrix.PreMultiply(matrix);
+        OnMatrixUpdated();
     }
 
     /*
@@ -109,6 +115,7 @@ namespace GTE {
      */
     void Transform::TransformBy(const Transform& transform) {
         matrix.Multiply(transform.matrix);
+        OnMatrixUpdated();
     }
 
     /*
@@ -116,6 +123,7 @@ namespace GTE {
      */
     void Transform::PreTransformBy(const Transform& transform) {
         matrix.PreMultiply(transform.matrix);
+        OnMatrixUpdated();
     }
 
     /*
@@ -123,12 +131,15 @@ namespace GTE {
      */
     void Transform::Invert() {
         matrix.Invert();
+        OnMatrixUpdated();
     }
 
     /*
-    * Get a reference to this transform's matrix.
+    * Get a reference to this transform's matrix. Since the caller may modify the matrix
+    * through the returned reference, it is treated as an update.
     */
     Matrix4x4& Transform::GetMatrix() {
+        OnMatrixUpdated();
         return this->matrix;
     }
 
@@ -140,6 +151,14 @@ namespace GTE {
     }
 
 
+    /*
+     * Called whenever this transform's matrix has been modified. Derived classes can override
+     * this to invalidate any data that is derived from the matrix.
+     */
+    void Transform::OnMatrixUpdated() {
+
+    }
+
     /*
      * Apply translation transformation to this transform's matrix. The parameter [local]
      * determines if the transformation is relative to world space or the transform's
@@ -150,6 +169,7 @@ namespace GTE {
             matrix.PreTranslate(x, y, z);
         }
         else matrix.Translate(x, y, z);
+        OnMatrixUpdated();
     }
 
     /*
@@ -162,6 +182,7 @@ namespace GTE {
             matrix.PreTranslate(vector);
         }
         else matrix.Translate(vector);
+        OnMatrixUpdated();
     }
 
     /*
@@ -194,6 +215,7 @@ namespace GTE {
             matrix.PreRotate(ax, ay, az, angle);
             matrix.PreTranslate(px, py, pz);
         }
+        OnMatrixUpdated();
     }
 
     /*
@@ -212,6 +234,7 @@ namespace GTE {
             matrix.PreScale(x, y, z);
         }
         else matrix.Scale(x, y, z);
+        OnMatrixUpdated();
     }
 
     /*
@@ -231,6 +254,7 @@ namespace GTE {
             matrix.PreRotate(x, y, z, a);
         }
         else matrix.Rotate(x, y, z, a);
+        OnMatrixUpdated();
     }
 
     /*
@@ -22,6 +22,8 @@ namespace GTE {
         // the 4x4 matrix that is encapsulated by this transform
         Matrix4x4 matrix;
 
+        virtual void OnMatrixUpdated();
+
     public:
 
         Transform();
@@ -25,9 +25,16 @@ namespace GTE {
         static const UInt32 MaxBonesPerVertex = 4;
         static const UInt32 MaxClipPlanes = 1;
 
-        static const UInt32 MaxSceneLights = 16;
+        static const UInt32 MaxSceneLights = 128;
         static const UInt32 MaxShaderLights = 8;
 
+        // dimensions of the froxel grid used for clustered lighting; these must match clusterdata.inc
+        static const UInt32 ClusterTileCountX = 16;
+        static const UInt32 ClusterTileCountY = 8;
+        static const UInt32 ClusterSliceCount = 24;
+        static const UInt32 MaxClusteredLights = 256;
+        static const UInt32 MaxClusterLightIndices = 16384;
+
         static const Real RealToDoubleRatio;
     };
 }
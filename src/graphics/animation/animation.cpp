@@ -1,6 +1,7 @@
 #include "engine.h"
 #include "animation.h"
 #include "skeleton.h"
+#include "compressedanimation.h"
 #include "global/global.h"
 #include "global/assert.h"
 #include "debug/gtedebug.h"
@@ -21,6 +22,7 @@ namespace GTE {
         if (ticksPerSecond <= 0)ticksPerSecond = 1;
 
         keyFrames = nullptr;
+        compressedKeyFrames = nullptr;
         this->durationTicks = durationTicks;
         this->ticksPerSecond = ticksPerSecond;
         this->startOffsetTicks = startOffsetTicks;
@@ -44,9 +46,11 @@ namespace GTE {
     }
 
     /*
-     * This method destroys [channelNames] and [keyFrames] and invalidates their pointers
+     * This method destroys [channelNames], [keyFrames] and [compressedKeyFrames] and invalidates their pointers
      */
     void Animation::Destroy() {
+        SAFE_DELETE(compressedKeyFrames);
+
         if (keyFrames != nullptr) {
             delete[] keyFrames;
             keyFrames = nullptr;
@@ -89,6 +93,51 @@ namespace GTE {
         if (this->startOffsetTicks < 0) this->startOffsetTicks = 0;
     }
 
+    /*
+     * Replace the key frames of this animation with a compressed copy (see CompressedAnimation), using the key frame
+     * reduction tolerances in [settings]. The key frames in each KeyFrameSet are released, but each KeyFrameSet's
+     * [Used] flag is preserved. AnimationPlayer samples the compressed key frames directly.
+     */
+    Bool Animation::Compress(const AnimationCompressionSettings& settings) {
+        NONFATAL_ASSERT_RTRN(compressedKeyFrames == nullptr, "Animation::Compress -> Animation has already been compressed.", false, true);
+        NONFATAL_ASSERT_RTRN(keyFrames != nullptr, "Animation::Compress -> Animation has not been initialized.", false, true);
+
+        CompressedAnimation * compressed = new(std::nothrow) CompressedAnimation();
+        ASSERT(compressed != nullptr, "Animation::Compress -> Could not allocate compressed animation.");
+
+        Bool initSuccess = compressed->Init(keyFrames, channelCount, settings);
+        if (!initSuccess) {
+            Debug::PrintError("Animation::Compress -> Unable to compress key frames.");
+            delete compressed;
+            return false;
+        }
+
+        compressedKeyFrames = compressed;
+
+        // release the uncompressed key frames
+        for (UInt32 i = 0; i < channelCount; i++) {
+            std::vector<TranslationKeyFrame>().swap(keyFrames[i].TranslationKeyFrames);
+            std::vector<ScaleKeyFrame>().swap(keyFrames[i].ScaleKeyFrames);
+            std::vector<RotationKeyFrame>().swap(keyFrames[i].RotationKeyFrames);
+        }
+
+        return true;
+    }
+
+    /*
+     * Have the key frames of this animation been compressed?
+     */
+    Bool Animation::IsCompressed() const {
+        return compressedKeyFrames != nullptr;
+    }
+
+    /*
+     * Get the compressed key frames of this animation, or nullptr if it has not been compressed.
+     */
+    const CompressedAnimation * Animation::GetCompressedKeyFrames() const {
+        return compressedKeyFrames;
+    }
+
     /*
      * Return the number of KeyFrameSet objects in [keyFrames].
      */
@@ -25,6 +25,10 @@
 #include <vector>
 
 namespace GTE {
+    //forward declarations
+    class CompressedAnimation;
+    class AnimationCompressionSettings;
+
     class Animation : public EngineObject {
         // Since this ultimately derives from EngineObject, we make this class
         // a friend of EngineObjectManager, and the constructor & destructor
@@ -40,6 +44,10 @@ namespace GTE {
         // 1:1 correspondence with [keyFrames]
         std::string * channelNames;
 
+        // compressed copy of the key frames in [keyFrames], or nullptr if this animation has not been compressed.
+        // once an animation has been compressed, the key frames in [keyFrames] are released.
+        CompressedAnimation * compressedKeyFrames;
+
         // store the number of KeyFrameSet objects that have been allocated, which
         // is also the length of [channelNames]
         UInt32 channelCount;
@@ -64,6 +72,9 @@ namespace GTE {
     public:
 
         void ClipEnds(Real startOffsetTicks, Real earlyEndTicks);
+        Bool Compress(const AnimationCompressionSettings& settings);
+        Bool IsCompressed() const;
+        const CompressedAnimation * GetCompressedKeyFrames() const;
         UInt32 GetChannelCount() const;
         KeyFrameSet * GetKeyFrameSet(UInt32 nodeIndex);
         const std::string * GetChannelName(UInt32 index) const;
@@ -100,7 +100,7 @@ namespace GTE {
                     const std::string * channelName = SourceAnimation->GetChannelName(c);
                     if (channelName == nullptr)continue;
 
-                    if (node->Name == *channelName) {
+                    if (node->GetName() == *channelName) {
                         foundIndex = c;
                     }
                 }
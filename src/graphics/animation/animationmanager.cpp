@@ -6,8 +6,13 @@
 #include "object/engineobject.h"
 #include "object/engineobjectmanager.h"
 #include "geometry/vector/vector3.h"
+#include "geometry/point/point3.h"
+#include "geometry/transform.h"
+#include "geometry/sceneobjecttransform.h"
 #include "geometry/quaternion.h"
 #include "graphics/render/skinnedmesh3Drenderer.h"
+#include "graphics/view/camera.h"
+#include "scene/sceneobject.h"
 #include "graphics/animation/animation.h"
 #include "graphics/animation/animationinstance.h"
 #include "graphics/animation/animationplayer.h"
@@ -17,6 +22,7 @@
 #include "global/assert.h"
 #include "global/constants.h"
 #include "util/time.h"
+#include "util/workerpool.h"
 #include "debug/gtedebug.h"
 
 #include <string>
@@ -27,7 +33,9 @@ namespace GTE {
     * Default constructor
     */
     AnimationManager::AnimationManager() {
-
+        skipOffScreenPlayers = false;
+        offScreenBoundsPadding = .5f;
+        frameNumber = 0;
     }
 
     /*
@@ -59,7 +67,7 @@ namespace GTE {
             for (UInt32 n = 0; n < skeletonNodeCount; n++) {
                 Skeleton * skeletonPtr = const_cast<Skeleton *>(skeleton.GetConstPtr());
                 SkeletonNode * node = skeletonPtr->GetNodeFromList(n);
-                if (node->Name == *channelName) {
+                if (node->GetName() == *channelName) {
                     foundNodeForChannel = true;
                     break;
                 }
@@ -90,15 +98,191 @@ namespace GTE {
 
     /*
      * Loop through each active AnimationPlayer and drive its playback.
+     *
+     * This happens in two phases. First every player is evaluated: its blending operations and
+     * animations are advanced and the new pose of its skeleton is calculated into a buffer owned by
+     * the player. Players are independent of each other during this phase, so it is distributed
+     * across the engine's worker threads. Then the evaluated poses are applied to the scene graph
+     * serially on the calling thread, since the scene graph is not safe for concurrent modification.
+     *
+     * Before evaluation, the level of detail of each player is chosen by UpdateLevelOfDetail().
      */
     void AnimationManager::Update() {
+        frameNumber++;
+
+        Point3 cameraPosition;
+        Bool haveCamera = lodLevels.size() > 0 && GetCameraPosition(cameraPosition);
+
+        updatePlayers.clear();
         for (std::unordered_map<UInt32, AnimationPlayerSharedPtr>::iterator iter = activePlayers.begin(); iter != activePlayers.end(); ++iter) {
             AnimationPlayerRef player = iter->second;
 
             if (player.IsValid()) {
-                player->Update();
+                UpdateLevelOfDetail(player.GetPtr(), haveCamera, cameraPosition);
+                updatePlayers.push_back(player.GetPtr());
+            }
+        }
+
+        UInt32 playerCount = (UInt32)updatePlayers.size();
+        WorkerPool * workerPool = Engine::Instance()->GetWorkerPool();
+
+        if (workerPool != nullptr) {
+            // evaluating a single player is a relatively large unit of work, so each chunk is one player
+            workerPool->ParallelFor(playerCount, 1, [this](UInt32 start, UInt32 end) {
+                for (UInt32 i = start; i < end; i++) {
+                    updatePlayers[i]->Evaluate();
+                }
+            });
+        }
+        else {
+            for (UInt32 i = 0; i < playerCount; i++) {
+                updatePlayers[i]->Evaluate();
             }
         }
+
+        for (UInt32 i = 0; i < playerCount; i++) {
+            updatePlayers[i]->CommitPose();
+        }
+    }
+
+    /*
+     * Get the world-space position of the LOD camera. Returns false if no LOD camera has been set.
+     *
+     * The current camera of the render manager is deliberately not used: it is whichever camera rendered
+     * last in the previous frame, which may be an off-screen camera (e.g. one rendering a reflection).
+     */
+    Bool AnimationManager::GetCameraPosition(Point3& position) const {
+        if (!lodCamera.IsValid())return false;
+
+        SceneObjectRef cameraObject = lodCamera->GetSceneObject();
+        if (!cameraObject.IsValid())return false;
+
+        Transform cameraTransform;
+        SceneObjectTransform::GetWorldTransform(cameraTransform, cameraObject, true, false);
+
+        position.Set(0, 0, 0);
+        cameraTransform.GetConstMatrix().Transform(position);
+        return true;
+    }
+
+    /*
+     * Choose the level of detail with which [player] is updated in the current frame.
+     *
+     * A player with an LOD override always uses the overriding level and is never skipped. Otherwise, if
+     * [skipOffScreenPlayers] is set and the player's skeleton was not visible in the previous frame, the
+     * player's animations are advanced without being sampled. Otherwise the level is chosen by the distance
+     * of the player's skeleton from [cameraPosition].
+     */
+    void AnimationManager::UpdateLevelOfDetail(AnimationPlayer * player, Bool haveCamera, const Point3& cameraPosition) const {
+        player->samplingSuspended = false;
+        player->lod = AnimationLODLevel();
+
+        if (player->lodOverride >= 0) {
+            if ((UInt32)player->lodOverride < lodLevels.size())player->lod = lodLevels[player->lodOverride];
+            return;
+        }
+
+        if (skipOffScreenPlayers && player->lastVisibleFrame + 1 < frameNumber) {
+            player->samplingSuspended = true;
+            return;
+        }
+
+        if (!haveCamera)return;
+
+        Point3 playerPosition;
+        if (!player->GetTargetPosition(playerPosition))return;
+
+        Vector3 toPlayer;
+        Point3::Subtract(playerPosition, cameraPosition, toPlayer);
+        Real distance = toPlayer.Magnitude();
+
+        for (UInt32 i = 0; i < lodLevels.size(); i++) {
+            if (distance < lodLevels[i].MinDistance)break;
+            player->lod = lodLevels[i];
+        }
+    }
+
+    /*
+     * Add a level of detail that is used for players that are at least [level.MinDistance] away
+     * from the camera.
+     */
+    void AnimationManager::AddLODLevel(const AnimationLODLevel& level) {
+        std::vector<AnimationLODLevel>::iterator insertPosition = lodLevels.begin();
+        while (insertPosition != lodLevels.end() && insertPosition->MinDistance <= level.MinDistance) {
+            ++insertPosition;
+        }
+        lodLevels.insert(insertPosition, level);
+    }
+
+    /*
+     * Remove all levels of detail, so that every player is updated every frame in full detail.
+     */
+    void AnimationManager::ClearLODLevels() {
+        lodLevels.clear();
+    }
+
+    UInt32 AnimationManager::GetLODLevelCount() const {
+        return (UInt32)lodLevels.size();
+    }
+
+    /*
+     * Set the camera from which the distance of each player is measured to choose its level of detail,
+     * which would typically be the main camera of the scene. Until a camera is set, every player that does
+     * not have an LOD override is updated in full detail.
+     */
+    void AnimationManager::SetLODCamera(CameraRef camera) {
+        lodCamera = camera;
+    }
+
+    CameraRef AnimationManager::GetLODCamera() {
+        return lodCamera;
+    }
+
+    /*
+     * Specify whether players whose skeletons are not visible should skip sampling their animations. Their
+     * animations keep progressing, and the pose catches up as soon as the skeleton becomes visible again.
+     */
+    void AnimationManager::SetSkipOffScreenPlayers(Bool skip) {
+        skipOffScreenPlayers = skip;
+    }
+
+    Bool AnimationManager::GetSkipOffScreenPlayers() const {
+        return skipOffScreenPlayers;
+    }
+
+    /*
+     * Set the amount by which the render manager grows the bounds of meshes skinned by suspended players,
+     * relative to the extents of those bounds. See IsSamplingSuspended().
+     */
+    void AnimationManager::SetOffScreenBoundsPadding(Real padding) {
+        offScreenBoundsPadding = padding;
+    }
+
+    Real AnimationManager::GetOffScreenBoundsPadding() const {
+        return offScreenBoundsPadding;
+    }
+
+    /*
+     * Called by the render manager to indicate that the skeleton with object ID [skeletonID] was
+     * visible in the current frame.
+     */
+    void AnimationManager::MarkSkeletonVisible(ObjectID skeletonID) {
+        std::unordered_map<ObjectID, AnimationPlayerSharedPtr>::iterator result = activePlayers.find(skeletonID);
+        if (result != activePlayers.end() && result->second.IsValid()) {
+            result->second->lastVisibleFrame = frameNumber;
+        }
+    }
+
+    /*
+     * Is sampling suspended for the player of the skeleton with object ID [skeletonID] in the current frame?
+     *
+     * The pose of a suspended player is frozen, so the bounds of the meshes it skins no longer follow its
+     * animations. The render manager uses this to make those bounds conservative; otherwise a character that
+     * animates into view would be culled against its stale pose and stay suspended.
+     */
+    Bool AnimationManager::IsSamplingSuspended(ObjectID skeletonID) const {
+        std::unordered_map<ObjectID, AnimationPlayerSharedPtr>::const_iterator result = activePlayers.find(skeletonID);
+        return result != activePlayers.end() && result->second.IsValid() && result->second->samplingSuspended;
     }
 
     /*
@@ -115,6 +299,9 @@ namespace GTE {
             AnimationPlayerRef player = objectManager->CreateAnimationPlayer(target);
             NONFATAL_ASSERT_RTRN(player.IsValid(), "AnimationManager::RetrieveOrCreateAnimationPlayer -> Unable to create player.", NullAnimationPlayerRef, false);
 
+            // newly created players are treated as visible until the render manager says otherwise
+            player->lastVisibleFrame = frameNumber;
+
             // put the newly created AnimationPlayer in the list of active players.s
             activePlayers[target->GetObjectID()] = player;
             return player;
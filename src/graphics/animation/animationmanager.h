@@ -7,6 +7,12 @@
 * This class manages and drives all instances of AnimationPlayer, and
 * therefore, all playing animations.
 *
+* It also chooses the level of detail with which each player is updated.
+* If LOD levels have been added, each player uses the level with the largest
+* minimum distance that does not exceed the player's distance from the
+* LOD camera (set with SetLODCamera()). Players can also be excluded from
+* updates entirely while their skeleton is off-screen.
+*
 ***********************************************/
 
 #ifndef _GTE_ANIMATION_MANAGER_H_
@@ -14,10 +20,15 @@
 
 #include "engine.h"
 #include "object/engineobject.h"
+#include "animationplayer.h"
 
 #include <unordered_map>
+#include <vector>
 
 namespace GTE {
+    //forward declarations
+    class Point3;
+
     class AnimationManager {
         // necessary to trigger lifecycle events and manage
         // allocation
@@ -28,6 +39,21 @@ namespace GTE {
 
         // map object IDs of Skeleton objects to their assign animation player
         std::unordered_map<ObjectID, AnimationPlayerSharedPtr> activePlayers;
+        // players that are updated during the current call to Update()
+        std::vector<AnimationPlayer *> updatePlayers;
+        // available levels of detail, sorted by MinDistance
+        std::vector<AnimationLODLevel> lodLevels;
+        // skip sampling for players whose skeletons were not visible in the previous frame?
+        Bool skipOffScreenPlayers;
+        // amount by which the bounds of meshes skinned by suspended players are grown, relative to their extents
+        Real offScreenBoundsPadding;
+        // camera from which the distance of each player is measured to choose its level of detail
+        CameraSharedPtr lodCamera;
+        // number of calls to Update() so far
+        UInt64 frameNumber;
+
+        Bool GetCameraPosition(Point3& position) const;
+        void UpdateLevelOfDetail(AnimationPlayer * player, Bool haveCamera, const Point3& cameraPosition) const;
 
     public:
 
@@ -38,6 +64,18 @@ namespace GTE {
 
         AnimationPlayerSharedPtr RetrieveOrCreateAnimationPlayer(SkeletonRef target);
         AnimationPlayerSharedPtr RetrieveOrCreateAnimationPlayer(SkinnedMesh3DRendererConstRef renderer);
+
+        void AddLODLevel(const AnimationLODLevel& level);
+        void ClearLODLevels();
+        UInt32 GetLODLevelCount() const;
+        void SetLODCamera(CameraRef camera);
+        CameraRef GetLODCamera();
+        void SetSkipOffScreenPlayers(Bool skip);
+        Bool GetSkipOffScreenPlayers() const;
+        void SetOffScreenBoundsPadding(Real padding);
+        Real GetOffScreenBoundsPadding() const;
+        void MarkSkeletonVisible(ObjectID skeletonID);
+        Bool IsSamplingSuspended(ObjectID skeletonID) const;
     };
 }
 
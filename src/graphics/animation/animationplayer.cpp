@@ -4,6 +4,7 @@
 #include "object/engineobject.h"
 #include "object/engineobjectmanager.h"
 #include "geometry/vector/vector3.h"
+#include "geometry/point/point3.h"
 #include "geometry/quaternion.h"
 #include "geometry/matrix4x4.h"
 #include "geometry/transform.h"
@@ -11,15 +12,19 @@
 #include "graphics/animation/skeleton.h"
 #include "graphics/animation/animationinstance.h"
 #include "graphics/animation/animation.h"
+#include "graphics/animation/compressedanimation.h"
 #include "graphics/animation/animationmanager.h"
 #include "graphics/animation/crossfadeblendop.h"
 #include "graphics/animation/blendop.h"
 #include "global/global.h"
 #include "global/assert.h"
 #include "global/constants.h"
+#include "gtemath/gtesimd.h"
 #include "debug/gtedebug.h"
 #include "util/time.h"
 
+#include <algorithm>
+
 namespace GTE {
     /*
     * Single constructor, which initializes member variables.
@@ -29,59 +34,80 @@ namespace GTE {
         this->target = target;
         animationCount = 0;
         playingAnimationsCount = 0;
+        evaluatedPoseChanged = false;
+        lodOverride = -1;
+        samplingSuspended = false;
+        framesSinceSample = 0;
+        canInterpolate = false;
+        lastVisibleFrame = 0;
+        weightThreshold = DefaultWeightThreshold;
+
+        // create the base layer, which is always present
+        AddLayer(AnimationBlendMode::Override, 1);
     }
 
     /*
      * Destructor
      */
     AnimationPlayer::~AnimationPlayer() {
-
+        for (UInt32 l = 0; l < layers.size(); l++) {
+            ClearBlendOpQueue(l);
+        }
     }
 
     /*
-     * Add a blending operation to the queue of active blending operations.
+     * Add a blending operation to the queue of active blending operations of [layer].
      */
-    void AnimationPlayer::QueueBlendOperation(BlendOp * op) {
+    void AnimationPlayer::QueueBlendOperation(UInt32 layer, BlendOp * op) {
         NONFATAL_ASSERT(op, "AnimationPlayer::QueueBlendOperation -> 'op' is null.", true);
-        activeBlendOperations.push(op);
+        NONFATAL_ASSERT(layer < layers.size(), "AnimationPlayer::QueueBlendOperation -> 'layer' is out of range.", true);
+        layers[layer].BlendOperations.push(op);
     }
 
     /*
-     * Get the currently active blend operation, if there is one. If there isn't one,
+     * Get the currently active blend operation of [layer], if there is one. If there isn't one,
      * return null;
      */
-    BlendOp * AnimationPlayer::GetCurrentBlendOp() {
-        if (activeBlendOperations.size() > 0)return activeBlendOperations.front();
+    BlendOp * AnimationPlayer::GetCurrentBlendOp(UInt32 layer) {
+        NONFATAL_ASSERT_RTRN(layer < layers.size(), "AnimationPlayer::GetCurrentBlendOp -> 'layer' is out of range.", nullptr, true);
+        if (layers[layer].BlendOperations.size() > 0)return layers[layer].BlendOperations.front();
         return nullptr;
     }
 
     /*
-     * Remove all blending operations from the blending operations queue [activeBlendOperations]
+     * Remove all blending operations from the blending operations queue of [layer].
      */
-    void AnimationPlayer::ClearBlendOpQueue() {
+    void AnimationPlayer::ClearBlendOpQueue(UInt32 layer) {
+        NONFATAL_ASSERT(layer < layers.size(), "AnimationPlayer::ClearBlendOpQueue -> 'layer' is out of range.", true);
+        std::queue<BlendOp*>& blendOperations = layers[layer].BlendOperations;
+
         UInt32 clearCount = 0;
-        while (activeBlendOperations.size() > 0) {
-            BlendOp * op = activeBlendOperations.front();
+        while (blendOperations.size() > 0) {
+            BlendOp * op = blendOperations.front();
             if (clearCount == 0)op->OnStoppedEarly();
-            activeBlendOperations.pop();
+            blendOperations.pop();
             delete op;
             clearCount++;
         }
     }
 
     /*
-     * Update & drive the blending operation that is at the head of the queue of
-     * active blending operations.
+     * For each layer, update & drive the blending operation that is at the head of the layer's
+     * queue of active blending operations.
      */
     void AnimationPlayer::UpdateBlendingOperations() {
-        // check if there are any active blending operations
-        if (activeBlendOperations.size() > 0) {
+        for (UInt32 l = 0; l < layers.size(); l++) {
+            Layer& layer = layers[l];
+
+            // check if there are any active blending operations
+            if (layer.BlendOperations.size() == 0)continue;
+
             // retrieve (but don't remove) blending operation at head of queue
-            BlendOp * op = activeBlendOperations.front();
+            BlendOp * op = layer.BlendOperations.front();
             if (op == nullptr) {
                 Debug::PrintWarning("AnimationPlayer::UpdateBlending -> Null operation found in queue.");
-                activeBlendOperations.pop();
-                return;
+                layer.BlendOperations.pop();
+                continue;
             }
 
             // trigger OnStart callback for blending operation, if appropriate
@@ -91,17 +117,31 @@ namespace GTE {
             }
 
             // update blending operation
-            op->Update(animationWeights);
+            op->Update(layer.AnimationWeights);
 
             // trigger OnComplete callback and deallocate blending operation, if appropriate
             if (op->HasCompleted()) {
                 op->OnComplete();
-                activeBlendOperations.pop();
+                layer.BlendOperations.pop();
                 delete op;
             }
         }
     }
 
+    /*
+     * Get the blending weight of the registered animation at [animationIndex] within its layer.
+     */
+    Real AnimationPlayer::GetAnimationWeight(UInt32 animationIndex) const {
+        return layers[animationLayers[animationIndex]].AnimationWeights[animationIndex];
+    }
+
+    /*
+     * Set the blending weight of the registered animation at [animationIndex] within its layer.
+     */
+    void AnimationPlayer::SetAnimationWeight(UInt32 animationIndex, Real weight) {
+        layers[animationLayers[animationIndex]].AnimationWeights[animationIndex] = weight;
+    }
+
     /*
      * Add up weights of active animations, and calculate unused weight [leftOverWeight]
      */
@@ -110,8 +150,8 @@ namespace GTE {
         for (UInt32 i = 0; i < registeredAnimations.size(); i++) {
             AnimationInstanceRef instance = registeredAnimations[i];
 
-            if (instance.IsValid() && instance->Playing) {
-                leftOverWeight -= animationWeights[i];
+            if (instance.IsValid() && instance->Playing && animationLayers[i] == 0) {
+                leftOverWeight -= GetAnimationWeight(i);
             }
         }
         if (leftOverWeight < 0)leftOverWeight = 0;
@@ -121,162 +161,375 @@ namespace GTE {
      * Trigger all update sub-operations.
      */
     void AnimationPlayer::Update() {
+        Evaluate();
+        CommitPose();
+    }
+
+    /*
+     * Advance blending operations and animation progress, and calculate the new pose of the target
+     * skeleton into [evaluatedPose]. This method does not modify anything outside of this player (the
+     * scene graph is only updated by CommitPose()), so different players can be evaluated concurrently.
+     *
+     * The active animations are only sampled every [lod.UpdateInterval] frames, and the frames in between
+     * interpolate from the previous sample to the most recent one. If [samplingSuspended] is set, the
+     * animations are advanced but not sampled at all, and the next sample after sampling resumes is used
+     * as-is, so the pose catches up immediately.
+     */
+    void AnimationPlayer::Evaluate() {
         // update current blending operation
         UpdateBlendingOperations();
         // validate animation weights
         CheckWeights();
-        // update the positions of all nodes in the target skeleton based on
-        // active animations
-        ApplyActiveAnimations();
+
+        evaluatedPoseChanged = false;
+        if (!samplingSuspended) {
+            UInt32 updateInterval = lod.UpdateInterval > 0 ? lod.UpdateInterval : 1;
+
+            framesSinceSample++;
+            if (!canInterpolate || framesSinceSample >= updateInterval) {
+                // calculate the positions of all nodes in the target skeleton based on
+                // active animations
+                ApplyActiveAnimations();
+                framesSinceSample = 0;
+            }
+
+            Real t = canInterpolate ? (Real)(framesSinceSample + 1) / (Real)updateInterval : 1;
+            BuildPose(t);
+            canInterpolate = true;
+            evaluatedPoseChanged = true;
+        }
+        else {
+            canInterpolate = false;
+        }
+
         // drive the progress of active animations
         UpdateAnimationsProgress();
     }
 
     /*
-     * Update the positions of all nodes of the target Skeleton object based on the progress of all
-     * active animations.
+     * Apply the pose calculated by the last call to Evaluate() to the targets of the nodes
+     * in the target skeleton. Must be called from the main thread.
+     */
+    void AnimationPlayer::CommitPose() {
+        if (!evaluatedPoseChanged)return;
+
+        UInt32 nodeCount = target->GetNodeCount();
+        if (evaluatedPose.size() < nodeCount || sampledPose.size() < nodeCount)return;
+
+        for (UInt32 node = 0; node < nodeCount; node++) {
+            if (!sampledPose[node].Valid)continue;
+
+            SkeletonNode * targetNode = target->GetNodeFromList(node);
+            if (targetNode->HasTarget()) {
+                // get the local transform of the target of this node and apply the
+                // evaluated matrix, which contains the interpolated scale, rotation, and translation
+                Transform * localTransform = targetNode->GetLocalTransform();
+                if (localTransform != nullptr)localTransform->SetTo(evaluatedPose[node]);
+            }
+        }
+    }
+
+    /*
+     * Sample the positions of all nodes of the target Skeleton object based on the progress of all
+     * active animations, and store them in [sampledPose]. The previous sample is saved in [previousSampledPose].
      *
-     * This method loops through each node in the target skeleton [target], and for each node it calculates
-     * the interpolated translation, rotation, and scale for that node for each active animation. It combines
-     * those transformations based on the weight of each active animation stored in member [weights] and
-     * applies the final transformation to the node.
+     * Only animations that are playing and whose weight is at least [weightThreshold] are sampled, so the cost
+     * depends on the number of active animations rather than the number of registered ones. Each of those
+     * animations is sampled into the contiguous buffer [clipPose] and accumulated into [layerPose] by
+     * AccumulatePose(). Once all of a layer's animations are accumulated, the result is combined with
+     * the layers below it by ApplyLayerPose().
+     *
+     * Nodes that are deeper in the hierarchy than [lod.MaxNodeDepth] keep their previously sampled transformation.
      */
     void AnimationPlayer::ApplyActiveAnimations() {
+        UInt32 nodeCount = target->GetNodeCount();
+        if (sampledPose.size() != nodeCount) {
+            sampledPose.resize(nodeCount);
+            previousSampledPose.resize(nodeCount);
+            evaluatedPose.resize(nodeCount);
+            clipPose.resize(nodeCount * PoseStride);
+            layerPose.resize(nodeCount * PoseStride);
+            layerPoseWeights.resize(nodeCount);
+            nodesToSample.resize(nodeCount);
+            target->GetNodeHierarchy(nodeParents, nodeDepths);
+        }
+
+        previousSampledPose = sampledPose;
+
+        for (UInt32 node = 0; node < nodeCount; node++) {
+            // reduced level of detail: don't re-sample nodes that are too deep in the hierarchy
+            nodesToSample[node] = !sampledPose[node].Valid || nodeDepths[node] <= lod.MaxNodeDepth;
+            if (nodesToSample[node])sampledPose[node].Valid = false;
+        }
+
+        for (UInt32 l = 0; l < layers.size(); l++) {
+            const Layer& layer = layers[l];
+            if (l > 0 && layer.Weight <= 0)continue;
+
+            // find the animations in this layer that contribute to the pose
+            activeAnimations.clear();
+            for (UInt32 i = 0; i < registeredAnimations.size(); i++) {
+                AnimationInstanceRef instance = registeredAnimations[i];
+                Real weight = layer.AnimationWeights[i];
+                if (animationLayers[i] == l && instance.IsValid() && instance->Playing && weight > 0 && weight >= weightThreshold) {
+                    activeAnimations.push_back(i);
+                }
+            }
+            if (activeAnimations.size() == 0)continue;
+
+            std::fill(layerPose.begin(), layerPose.end(), (Real)0);
+            std::fill(layerPoseWeights.begin(), layerPoseWeights.end(), (Real)0);
+
+            for (UInt32 a = 0; a < activeAnimations.size(); a++) {
+                UInt32 animationIndex = activeAnimations[a];
+                SampleAnimation(registeredAnimations[animationIndex], &clipPose[0]);
+                AccumulatePose(&clipPose[0], layer.AnimationWeights[animationIndex], &layerPose[0], &layerPoseWeights[0]);
+            }
+
+            ApplyLayerPose(l);
+        }
+    }
+
+    /*
+     * Sample the translation, rotation, and scale of each node in [target] that is flagged in [nodesToSample]
+     * from [instance] and store them in [pose] (in the layout described by PoseStride). Nodes for which
+     * [instance] has no channel get the node's initial transformation.
+     */
+    void AnimationPlayer::SampleAnimation(AnimationInstanceRef instance, Real * pose) {
         Vector3 translation;
         Vector3 scale;
         Quaternion rotation;
 
-        // storage for aggregate translation, rotation, and scale
-        Vector3 agTranslation;
-        Vector3 agScale;
-        Quaternion agRotation;
+        for (UInt32 node = 0; node < nodesToSample.size(); node++) {
+            if (!nodesToSample[node])continue;
 
-        Quaternion temp;
+            Int32 mappedChannel = instance->GetChannelMappingForTargetNode(node);
+            if (mappedChannel >= 0) {
+                CalculateInterpolatedValues(instance, node, mappedChannel, translation, rotation, scale);
+            }
+            else {
+                SkeletonNode * targetNode = target->GetNodeFromList(node);
+                translation = targetNode->GetInitialTranslation();
+                rotation = targetNode->GetInitialRotation();
+                scale = targetNode->GetInitialScale();
+            }
 
-        // temp use Matrices
-        Matrix4x4 rotMatrix;
-        Matrix4x4 matrix;
+            Real * nodePose = pose + node * PoseStride;
+            nodePose[0] = translation.x;
+            nodePose[1] = translation.y;
+            nodePose[2] = translation.z;
+            nodePose[3] = 0;
+            nodePose[4] = rotation.x();
+            nodePose[5] = rotation.y();
+            nodePose[6] = rotation.z();
+            nodePose[7] = rotation.w();
+            nodePose[8] = scale.x;
+            nodePose[9] = scale.y;
+            nodePose[10] = scale.z;
+            nodePose[11] = 0;
+        }
+    }
 
-        // keep track of the number of playing animations seen as we loop through all registered animations
-        UInt32 playingAnimationsSeen = 0;
+    /*
+     * Add [pose] scaled by [weight] to [accumulatedPose], and add [weight] to [accumulatedWeights] for each node
+     * that is flagged in [nodesToSample]. Rotations are flipped as necessary so that they lie in the same hemisphere
+     * as the accumulated rotation; the accumulated rotation must be normalized afterwards.
+     */
+    void AnimationPlayer::AccumulatePose(const Real * pose, Real weight, Real * accumulatedPose, Real * accumulatedWeights) const {
+        for (UInt32 node = 0; node < nodesToSample.size(); node++) {
+            if (!nodesToSample[node])continue;
+
+            const Real * src = pose + node * PoseStride;
+            Real * dest = accumulatedPose + node * PoseStride;
+
+            Real dot = src[4] * dest[4] + src[5] * dest[5] + src[6] * dest[6] + src[7] * dest[7];
+            Real rotationWeight = dot < 0 ? -weight : weight;
+
+#if defined(_GTE_SIMD_SSE)
+            __m128 w = _mm_set1_ps(weight);
+            __m128 rw = _mm_set1_ps(rotationWeight);
+            _mm_storeu_ps(dest, _mm_add_ps(_mm_loadu_ps(dest), _mm_mul_ps(_mm_loadu_ps(src), w)));
+            _mm_storeu_ps(dest + 4, _mm_add_ps(_mm_loadu_ps(dest + 4), _mm_mul_ps(_mm_loadu_ps(src + 4), rw)));
+            _mm_storeu_ps(dest + 8, _mm_add_ps(_mm_loadu_ps(dest + 8), _mm_mul_ps(_mm_loadu_ps(src + 8), w)));
+#elif defined(_GTE_SIMD_NEON)
+            vst1q_f32(dest, vmlaq_n_f32(vld1q_f32(dest), vld1q_f32(src), weight));
+            vst1q_f32(dest + 4, vmlaq_n_f32(vld1q_f32(dest + 4), vld1q_f32(src + 4), rotationWeight));
+            vst1q_f32(dest + 8, vmlaq_n_f32(vld1q_f32(dest + 8), vld1q_f32(src + 8), weight));
+#else
+            for (UInt32 i = 0; i < 4; i++) {
+                dest[i] += src[i] * weight;
+                dest[i + 4] += src[i + 4] * rotationWeight;
+                dest[i + 8] += src[i + 8] * weight;
+            }
+#endif
 
-        // loop through each node in the target Skeleton object, and calculate the position based on
-        // weighted average of positions returned from each active animation
-        for (UInt32 node = 0; node < target->GetNodeCount(); node++) {
-            agScale.Set(0, 0, 0);
-            agTranslation.Set(0, 0, 0);
-            agRotation = Quaternion::Identity;
+            accumulatedWeights[node] += weight;
+        }
+    }
 
-            playingAnimationsSeen = 0;
-            Real agWeight = 0;
+    /*
+     * Combine the accumulated pose of [layerIndex] (stored in [layerPose] and [layerPoseWeights]) with the
+     * pose of the layers below it, which is stored in [sampledPose].
+     *
+     * The base layer (index 0) simply provides the weighted sum of its animations; if the sum of their weights is
+     * less than one, BuildPose() makes up the difference with the initial transformation of each node. Every other
+     * layer is first normalized by its total weight, and then either replaces the pose below it (Override) or is
+     * applied on top of it as a difference from the initial (bind) transformation of each node (Additive), in
+     * both cases scaled by the layer's weight and node mask.
+     */
+    void AnimationPlayer::ApplyLayerPose(UInt32 layerIndex) {
+        const Layer& layer = layers[layerIndex];
 
-            // get the Skeleton node corresponding to the current node index
-            SkeletonNode * targetNode = target->GetNodeFromList(node);
+        Vector3 translation;
+        Vector3 scale;
+        Quaternion rotation;
 
-            // loop through all registered animations
-            for (Int32 i = (Int32)registeredAnimations.size() - 1; i >= 0; i--) {
-                AnimationInstanceSharedPtr instance = registeredAnimations[i];
+        for (UInt32 node = 0; node < nodesToSample.size(); node++) {
+            Real layerWeight = layerPoseWeights[node];
+            if (!nodesToSample[node] || layerWeight <= 0)continue;
 
-                // include this animation only if it is playing
-                if (instance.IsValid() && instance->Playing) {
-                    // if this node does not have an animation channel for it in the current animation, then ignore
-                    Int32 mappedChannel = instance->GetChannelMappingForTargetNode(node);
+            const Real * pose = &layerPose[node * PoseStride];
+            rotation.Set(pose[4], pose[5], pose[6], pose[7]);
+            rotation.normalize();
 
-                    // retrieve this animation's weight
-                    Real weight = animationWeights[i];
+            NodePose& nodePose = sampledPose[node];
 
-                    // if this animation's weight is 0, then ignore it
-                    if (weight <= 0)continue;
+            if (layerIndex == 0) {
+                nodePose.Translation.Set(pose[0], pose[1], pose[2]);
+                nodePose.Rotation = rotation;
+                nodePose.Scale.Set(pose[8], pose[9], pose[10]);
+                nodePose.Weight = layerWeight;
+                nodePose.Valid = true;
+                continue;
+            }
 
-                    // calculate aggregate (sum of weights up until this point)
-                    agWeight += weight;
+            Real influence = layer.Weight * (layerWeight < 1 ? layerWeight : 1);
+            if (layer.NodeMask.size() > node)influence *= layer.NodeMask[node];
+            if (influence <= 0)continue;
+            if (influence > 1)influence = 1;
 
-                    // calculate the translation, rotation, and scale for this animation at the current node
-                    if (mappedChannel >= 0) {
-                        CalculateInterpolatedValues(instance, mappedChannel, translation, rotation, scale);
-                    }
-                    // if there is no channel in the current animation for this node, use the
-                    // default transformation values for this node
-                    else {
-                        translation = targetNode->InitialTranslation;
-                        rotation = targetNode->InitialRotation;
-                        scale = targetNode->InitialScale;
-                    }
+            Real invLayerWeight = (Real)1.0 / layerWeight;
+            translation.Set(pose[0] * invLayerWeight, pose[1] * invLayerWeight, pose[2] * invLayerWeight);
+            scale.Set(pose[8] * invLayerWeight, pose[9] * invLayerWeight, pose[10] * invLayerWeight);
 
-                    // if the number of active animations is 1, indicated by playingAnimationsCount == 1, and its
-                    // weight is 1, then we simply use the results from CalculateInterpolatedValues() and apply those
-                    // to the current node
-                    if (playingAnimationsCount == 1 && weight == 1) {
-                        agTranslation = translation;
-                        agScale = scale;
-                        agRotation = rotation;
-                    }
-                    else // we have to apply weights across 1 or more animations
-                    {
-                        // apply weight to each transformation
-                        translation.Scale(weight);
-                        scale.Scale(weight);
-                        rotation.Set(rotation.x() * weight, rotation.y() * weight, rotation.z() * weight, rotation.w() * weight);
-
-                        // if this is the first active animation encountered, set the aggregate translation, rotation and scale
-                        if (playingAnimationsSeen == 0) {
-                            agTranslation = translation;
-                            agScale = scale;
-                            agRotation = rotation;
-                        }
-                        // this is not the first active animation encountered, so we additively combine the translation
-                        // and scale into their aggregate counterparts. we use spherical interpolation to combine the
-                        // rotation for this animation into the aggregate rotation.
-                        else {
-                            Vector3::Add(translation, agTranslation, agTranslation);
-                            Vector3::Add(scale, agScale, agScale);
-
-                            if (agWeight != 0)temp = Quaternion::slerp(agRotation, rotation, weight / agWeight);
-                            else temp = rotation;
-                            agRotation = temp;
-                        }
-                    }
+            SkeletonNode * targetNode = target->GetNodeFromList(node);
 
-                    playingAnimationsSeen++;
-                }
+            // if none of the layers below this one affected this node, start from its initial transformation
+            if (!nodePose.Valid) {
+                nodePose.Translation = targetNode->GetInitialTranslation();
+                nodePose.Rotation = targetNode->GetInitialRotation();
+                nodePose.Scale = targetNode->GetInitialScale();
+                nodePose.Weight = 1;
+                nodePose.Valid = true;
             }
 
-            // only apply transformations if they were actually calculated
-            if (playingAnimationsSeen > 0) {
-                matrix.SetIdentity();
-                // apply interpolated scale
-                matrix.Scale(agScale.x, agScale.y, agScale.z);
-                // apply interpolated rotation
-                agRotation.normalize();
-                rotMatrix = agRotation.rotationMatrix();
-                matrix.PreMultiply(rotMatrix);
-                // apply interpolated translation
-                matrix.PreTranslate(agTranslation.x, agTranslation.y, agTranslation.z);
-
-                // if the agWeight for some reason is less than one, compensate by using
-                // the initial transformation values for the node
-                if (agWeight < .99) {
-                    Matrix4x4 temp = targetNode->InitialTransform;
-                    temp.MultiplyByScalar(((Real)1.0 - agWeight));
-                    matrix.Add(temp);
-                }
+            if (layer.Mode == AnimationBlendMode::Override) {
+                Vector3::Lerp(nodePose.Translation, translation, nodePose.Translation, influence);
+                Vector3::Lerp(nodePose.Scale, scale, nodePose.Scale, influence);
+                nodePose.Rotation = Quaternion::slerp(nodePose.Rotation, rotation, influence);
+            }
+            else {
+                const Vector3& initialTranslation = targetNode->GetInitialTranslation();
+                const Vector3& initialScale = targetNode->GetInitialScale();
+
+                nodePose.Translation.Set(nodePose.Translation.x + (translation.x - initialTranslation.x) * influence,
+                                         nodePose.Translation.y + (translation.y - initialTranslation.y) * influence,
+                                         nodePose.Translation.z + (translation.z - initialTranslation.z) * influence);
+
+                Real scaleX = initialScale.x != 0 ? scale.x / initialScale.x : 1;
+                Real scaleY = initialScale.y != 0 ? scale.y / initialScale.y : 1;
+                Real scaleZ = initialScale.z != 0 ? scale.z / initialScale.z : 1;
+                nodePose.Scale.Set(nodePose.Scale.x * (1 + (scaleX - 1) * influence),
+                                   nodePose.Scale.y * (1 + (scaleY - 1) * influence),
+                                   nodePose.Scale.z * (1 + (scaleZ - 1) * influence));
+
+                Quaternion deltaRotation = targetNode->GetInitialRotation().conjugate() * rotation;
+                deltaRotation = Quaternion::slerp(Quaternion::Identity, deltaRotation, influence);
+                nodePose.Rotation = nodePose.Rotation * deltaRotation;
+                nodePose.Rotation.normalize();
+            }
+        }
+    }
 
-                if (targetNode->HasTarget()) {
-                    // get the local transform of the target of this node and apply
-                    // [matrix], which contains the interpolated scale, rotation, and translation
-                    Transform * localTransform = targetNode->GetLocalTransform();
-                    if (localTransform != nullptr)localTransform->SetTo(matrix);
-                }
+    /*
+     * Calculate the local transformation of each node in [target] from the sampled poses, and store them
+     * in [evaluatedPose]. The translation, rotation, and scale of each node are interpolated from
+     * [previousSampledPose] to [sampledPose] by [t].
+     */
+    void AnimationPlayer::BuildPose(Real t) {
+        Vector3 translation;
+        Vector3 scale;
+        Quaternion rotation;
+
+        // temp use Matrices
+        Matrix4x4 rotMatrix;
+
+        for (UInt32 node = 0; node < sampledPose.size(); node++) {
+            const NodePose& currentPose = sampledPose[node];
+            if (!currentPose.Valid)continue;
+
+            const NodePose& previousPose = previousSampledPose[node];
+            Real weight;
+            if (t < 1 && previousPose.Valid) {
+                Vector3::Lerp(previousPose.Translation, currentPose.Translation, translation, t);
+                Vector3::Lerp(previousPose.Scale, currentPose.Scale, scale, t);
+                rotation = Quaternion::slerp(previousPose.Rotation, currentPose.Rotation, t);
+                weight = previousPose.Weight + (currentPose.Weight - previousPose.Weight) * t;
+            }
+            else {
+                translation = currentPose.Translation;
+                scale = currentPose.Scale;
+                rotation = currentPose.Rotation;
+                weight = currentPose.Weight;
             }
+
+            Matrix4x4& matrix = evaluatedPose[node];
+            matrix.SetIdentity();
+            // apply interpolated scale
+            matrix.Scale(scale.x, scale.y, scale.z);
+            // apply interpolated rotation
+            rotMatrix = rotation.rotationMatrix();
+            matrix.PreMultiply(rotMatrix);
+            // apply interpolated translation
+            matrix.PreTranslate(translation.x, translation.y, translation.z);
+
+            // if the aggregate weight for some reason is less than one, compensate by using
+            // the initial transformation values for the node
+            if (weight < .99) {
+                Matrix4x4 temp = target->GetNodeFromList(node)->GetInitialTransform();
+                temp.MultiplyByScalar(((Real)1.0 - weight));
+                matrix.Add(temp);
+            }
+        }
+    }
+
+    /*
+     * Get the world-space position of the first node in [target] that has a target, which is
+     * used as the position of the whole skeleton. Returns false if there is no such node.
+     */
+    Bool AnimationPlayer::GetTargetPosition(Point3& position) {
+        for (UInt32 node = 0; node < target->GetNodeCount(); node++) {
+            SkeletonNode * targetNode = target->GetNodeFromList(node);
+            if (targetNode == nullptr || !targetNode->HasTarget())continue;
+
+            const Transform * fullTransform = targetNode->GetFullTransform();
+            if (fullTransform == nullptr)continue;
+
+            position.Set(0, 0, 0);
+            fullTransform->GetConstMatrix().Transform(position);
+            return true;
         }
+
+        return false;
     }
 
     /*
      * Use the current progress of [instance] to find the two closest key frames in the KeyFrameSet specified by [channel].
      * Then interpolate between those two key frames based on where the progress of [instance] lies between them, and store the
-     * interpolated translation, rotation, and scale values in [translation], [rotation], and [scale].
+     * interpolated translation, rotation, and scale values in [translation], [rotation], and [scale]. The key frame search for
+     * each component starts from the key frame found for [node] on the previous call (stored in the instance's FrameState for [node]).
      */
-    void AnimationPlayer::CalculateInterpolatedValues(AnimationInstanceConstRef instance, UInt32 channel, Vector3& translation, Quaternion& rotation, Vector3& scale) const {
+    void AnimationPlayer::CalculateInterpolatedValues(AnimationInstanceConstRef instance, UInt32 node, UInt32 channel, Vector3& translation, Quaternion& rotation, Vector3& scale) const {
         Animation * animationPtr = const_cast<Animation *>(instance->SourceAnimation.GetConstPtr());
         KeyFrameSet * frameSet = animationPtr->GetKeyFrameSet(channel);
         NONFATAL_ASSERT(frameSet != nullptr, "AnimationPlayer::CalculateInterpolatedValues -> 'frameSet' is null.", false);
@@ -285,9 +538,17 @@ namespace GTE {
         if (frameSet != nullptr && frameSet->Used) {
             // for each of translation, scale, and rotation, find the two respective key frames between which
             // instance->Progress lies, and interpolate between them based on instance->Progress.
-            CalculateInterpolatedTranslation(instance, *frameSet, translation);
-            CalculateInterpolatedScale(instance, *frameSet, scale);
-            CalculateInterpolatedRotation(instance, *frameSet, rotation);
+            NONFATAL_ASSERT(node < instance->StateCount, "AnimationPlayer::CalculateInterpolatedValues -> 'node' is out of range.", true);
+            AnimationInstance::FrameState * frameState = instance->FrameStates + node;
+
+            const CompressedAnimation * compressedKeyFrames = animationPtr->GetCompressedKeyFrames();
+            KeyFrameTrack translationTrack(*frameSet, compressedKeyFrames, channel, TransformationCompnent::Translation);
+            KeyFrameTrack scaleTrack(*frameSet, compressedKeyFrames, channel, TransformationCompnent::Scale);
+            KeyFrameTrack rotationTrack(*frameSet, compressedKeyFrames, channel, TransformationCompnent::Rotation);
+
+            CalculateInterpolatedTranslation(instance, translationTrack, frameState->TranslationKeyIndex, translation);
+            CalculateInterpolatedScale(instance, scaleTrack, frameState->ScaleKeyIndex, scale);
+            CalculateInterpolatedRotation(instance, rotationTrack, frameState->RotationKeyIndex, rotation);
         }
     }
 
@@ -336,204 +597,243 @@ namespace GTE {
     }
 
     /*
-     * Use the value of instance->Progress to find the two closest translation key frames in [keyFrameSet]. Then interpolate between the translation
+     * Use the value of instance->Progress to find the two closest translation key frames in [track]. Then interpolate between the translation
      * values in those two key frames based on where instance->Progress lies between them, and store the result in [vector].
      */
-    void AnimationPlayer::CalculateInterpolatedTranslation(AnimationInstanceConstRef instance, const KeyFrameSet& keyFrameSet, Vector3& vector) const {
+    void AnimationPlayer::CalculateInterpolatedTranslation(AnimationInstanceConstRef instance, const KeyFrameTrack& track, UInt32& keyIndex, Vector3& vector) const {
         NONFATAL_ASSERT(instance.IsValid(), "AnimationPlayer::CalculateInterpolatedTranslation -> 'instance' is invalid.", true);
-
-        UInt32 frameCount = (UInt32)keyFrameSet.TranslationKeyFrames.size();
-        NONFATAL_ASSERT(frameCount > 0, "AnimationPlayer::CalculateInterpolatedTranslation -> Key frame count is zero.", true);
+        NONFATAL_ASSERT(track.FrameCount > 0, "AnimationPlayer::CalculateInterpolatedTranslation -> Key frame count is zero.", true);
 
         UInt32 previousIndex, nextIndex;
         Real interFrameProgress;
-        Bool foundFrames = CalculateInterpolation(instance, keyFrameSet, previousIndex, nextIndex, interFrameProgress, TransformationCompnent::Translation);
+        Bool foundFrames = CalculateInterpolation(instance, track, keyIndex, previousIndex, nextIndex, interFrameProgress);
 
         // did we successfully find 2 frames between which to interpolate?
         if (foundFrames) {
-            const TranslationKeyFrame& nextFrame = keyFrameSet.TranslationKeyFrames[nextIndex];
-            const TranslationKeyFrame& previousFrame = keyFrameSet.TranslationKeyFrames[previousIndex];
+            Vector3 nextTranslation;
+            Vector3 previousTranslation;
+            track.GetVector(nextIndex, nextTranslation);
+            track.GetVector(previousIndex, previousTranslation);
 
-            vector.x = ((nextFrame.Translation.x - previousFrame.Translation.x) * interFrameProgress) + previousFrame.Translation.x;
-            vector.y = ((nextFrame.Translation.y - previousFrame.Translation.y) * interFrameProgress) + previousFrame.Translation.y;
-            vector.z = ((nextFrame.Translation.z - previousFrame.Translation.z) * interFrameProgress) + previousFrame.Translation.z;
+            vector.x = ((nextTranslation.x - previousTranslation.x) * interFrameProgress) + previousTranslation.x;
+            vector.y = ((nextTranslation.y - previousTranslation.y) * interFrameProgress) + previousTranslation.y;
+            vector.z = ((nextTranslation.z - previousTranslation.z) * interFrameProgress) + previousTranslation.z;
 
         }
         else //we did not find 2 frames, so set translation equal to the first frame
         {
-            const TranslationKeyFrame& firstFrame = keyFrameSet.TranslationKeyFrames[0];
-            vector.Set(firstFrame.Translation.x, firstFrame.Translation.y, firstFrame.Translation.y);
+            track.GetVector(0, vector);
         }
     }
 
     /*
-     * Use the value of instance->Progress to find the two closest scale key frames in [keyFrameSet]. Then interpolate between the scale
+     * Use the value of instance->Progress to find the two closest scale key frames in [track]. Then interpolate between the scale
      * values in those two key frames based on where instance->Progress lies between them, and store the result in [vector].
      */
-    void AnimationPlayer::CalculateInterpolatedScale(AnimationInstanceConstRef instance, const KeyFrameSet& keyFrameSet, Vector3& vector) const {
+    void AnimationPlayer::CalculateInterpolatedScale(AnimationInstanceConstRef instance, const KeyFrameTrack& track, UInt32& keyIndex, Vector3& vector) const {
         NONFATAL_ASSERT(instance.IsValid(), "AnimationPlayer::CalculateInterpolatedScale -> 'instance' is invalid.", true);
-
-        UInt32 frameCount = (UInt32)keyFrameSet.ScaleKeyFrames.size();
-        NONFATAL_ASSERT(frameCount > 0, "AnimationPlayer::CalculateInterpolatedScale -> Key frame count is zero.", true);
+        NONFATAL_ASSERT(track.FrameCount > 0, "AnimationPlayer::CalculateInterpolatedScale -> Key frame count is zero.", true);
 
         UInt32 previousIndex, nextIndex;
         Real interFrameProgress;
-        Bool foundFrames = CalculateInterpolation(instance, keyFrameSet, previousIndex, nextIndex, interFrameProgress, TransformationCompnent::Scale);
+        Bool foundFrames = CalculateInterpolation(instance, track, keyIndex, previousIndex, nextIndex, interFrameProgress);
 
         // did we successfully find 2 frames between which to interpolate?
         if (foundFrames) {
-            const ScaleKeyFrame& nextFrame = keyFrameSet.ScaleKeyFrames[nextIndex];
-            const ScaleKeyFrame& previousFrame = keyFrameSet.ScaleKeyFrames[previousIndex];
+            Vector3 nextScale;
+            Vector3 previousScale;
+            track.GetVector(nextIndex, nextScale);
+            track.GetVector(previousIndex, previousScale);
 
             // perform interpolation
-            vector.x = ((nextFrame.Scale.x - previousFrame.Scale.x) * interFrameProgress) + previousFrame.Scale.x;
-            vector.y = ((nextFrame.Scale.y - previousFrame.Scale.y) * interFrameProgress) + previousFrame.Scale.y;
-            vector.z = ((nextFrame.Scale.z - previousFrame.Scale.z) * interFrameProgress) + previousFrame.Scale.z;
+            vector.x = ((nextScale.x - previousScale.x) * interFrameProgress) + previousScale.x;
+            vector.y = ((nextScale.y - previousScale.y) * interFrameProgress) + previousScale.y;
+            vector.z = ((nextScale.z - previousScale.z) * interFrameProgress) + previousScale.z;
         }
         else //we did not find 2 frames, so set scale equal to the first frame
         {
-            const ScaleKeyFrame& firstFrame = keyFrameSet.ScaleKeyFrames[0];
-            vector.Set(firstFrame.Scale.x, firstFrame.Scale.y, firstFrame.Scale.y);
+            track.GetVector(0, vector);
         }
     }
 
     /*
-     * Use the value of instance->Progress to find the two closest rotation key frames in [keyFrameSet]. Then interpolate between the rotation
+     * Use the value of instance->Progress to find the two closest rotation key frames in [track]. Then interpolate between the rotation
      * values in those two key frames based on where instance->Progress lies between them, and store the result in [rotation].
      */
-    void AnimationPlayer::CalculateInterpolatedRotation(AnimationInstanceConstRef instance, const KeyFrameSet& keyFrameSet, Quaternion& rotation) const {
+    void AnimationPlayer::CalculateInterpolatedRotation(AnimationInstanceConstRef instance, const KeyFrameTrack& track, UInt32& keyIndex, Quaternion& rotation) const {
         NONFATAL_ASSERT(instance.IsValid(), "AnimationPlayer::CalculateInterpolatedRotation -> 'instance' is invalid.", true);
-
-        UInt32 frameCount = (UInt32)keyFrameSet.RotationKeyFrames.size();
-        NONFATAL_ASSERT(frameCount > 0, "AnimationPlayer::CalculateInterpolatedRotation -> Key frame count is zero.", true);
+        NONFATAL_ASSERT(track.FrameCount > 0, "AnimationPlayer::CalculateInterpolatedRotation -> Key frame count is zero.", true);
 
         UInt32 previousIndex, nextIndex;
         Real interFrameProgress;
-        Bool foundFrames = CalculateInterpolation(instance, keyFrameSet, previousIndex, nextIndex, interFrameProgress, TransformationCompnent::Rotation);
+        Bool foundFrames = CalculateInterpolation(instance, track, keyIndex, previousIndex, nextIndex, interFrameProgress);
 
         // did we successfully find 2 frames between which to interpolate?
         if (foundFrames) {
-            const RotationKeyFrame& nextFrame = keyFrameSet.RotationKeyFrames[nextIndex];
-            const RotationKeyFrame& previousFrame = keyFrameSet.RotationKeyFrames[previousIndex];
-
             // perform spherical interpolation between the two Quaternions
-            Quaternion a(previousFrame.Rotation.x(), previousFrame.Rotation.y(), previousFrame.Rotation.z(), previousFrame.Rotation.w());
-            Quaternion b(nextFrame.Rotation.x(), nextFrame.Rotation.y(), nextFrame.Rotation.z(), nextFrame.Rotation.w());
+            Quaternion a;
+            Quaternion b;
+            track.GetRotation(previousIndex, a);
+            track.GetRotation(nextIndex, b);
             Quaternion quatOut = Quaternion::slerp(a, b, interFrameProgress);
             rotation.Set(quatOut.x(), quatOut.y(), quatOut.z(), quatOut.w());
         }
         else //we did not find 2 frames, so set rotation equal to the first frame
         {
-            const RotationKeyFrame& firstFrame = keyFrameSet.RotationKeyFrames[0];
-            rotation.Set(firstFrame.Rotation.x(), firstFrame.Rotation.y(), firstFrame.Rotation.z(), firstFrame.Rotation.w());
+            track.GetRotation(0, rotation);
         }
     }
 
     /*
-     * This method uses the value of instance->Progress to find the two closest key frames in [keyFrameSet], of the type specified by [component]
-     * and then stores the indices of those key frames in [previousIndex] and [nextIndex]. Then it uses instance->Progress to determine how far from [lastIndex]
-     * to [nextIndex] the animation currently is, and stores that value in [interFrameProgress] (range: 0 to 1).
+     * This method uses the value of instance->Progress to find the two closest key frames in [track] and then stores the indices of those key
+     * frames in [previousIndex] and [nextIndex]. Then it uses instance->Progress to determine how far from [lastIndex] to [nextIndex] the
+     * animation currently is, and stores that value in [interFrameProgress] (range: 0 to 1).
+     *
+     * [keyIndex] is a cursor that holds the index of the key frame found on the previous call for the same node and component. It is
+     * used as the starting point of the search, and updated with the index of the key frame that is found.
      */
-    Bool AnimationPlayer::CalculateInterpolation(AnimationInstanceConstRef instance, const KeyFrameSet& keyFrameSet, UInt32& previousIndex, UInt32& nextIndex, Real& interFrameProgress, TransformationCompnent component) const {
+    Bool AnimationPlayer::CalculateInterpolation(AnimationInstanceConstRef instance, const KeyFrameTrack& track, UInt32& keyIndex, UInt32& previousIndex, UInt32& nextIndex, Real& interFrameProgress) const {
         NONFATAL_ASSERT_RTRN(instance.IsValid(), "AnimationPlayer::CalculateInterpolation -> 'instance' is invalid.", false, true);
 
-        UInt32 frameCount = 0;
+        UInt32 frameCount = track.FrameCount;
         Real progress = instance->Progress;
         Real duration = instance->Duration;
 
-        // get the correct frame count, which depends on [component]
-        if (component == TransformationCompnent::Translation)frameCount = (UInt32)keyFrameSet.TranslationKeyFrames.size();
-        else if (component == TransformationCompnent::Rotation)frameCount = (UInt32)keyFrameSet.RotationKeyFrames.size();
-        else if (component == TransformationCompnent::Scale)frameCount = (UInt32)keyFrameSet.ScaleKeyFrames.size();
-        else return false;
-
-        // loop through each key frame
-        for (UInt32 f = 0; f < frameCount; f++) {
-            KeyFrame * previousFrame = nullptr;
-            KeyFrame * nextFrame = nullptr;
-
-            // get the correct time stamp for this frame, which depends on [component]
-            Real keyRealTime = GetKeyFrameTime(component, f, keyFrameSet);
-
-            // if the RealTime value for this key frame is greater than [progress], then the previous key frame and the current key frame
-            // are the frames we want
-            if (keyRealTime > progress || f == frameCount - 1) {
-                previousIndex = 0;
-                if (f > 0)previousIndex = f - 1;
-                nextIndex = f;
-
-                // flag that indicates we need to interpolate from the last frame to the first frame
-                Bool overShoot = false;
-
-                // if f==frameCount-1 and keyRealTime <= progress, then we have reached the last frame and progress has moved
-                // beyond it. this means we need to interpolate between the last frame and the first frame (for smoothed animation looping).
-                if (f == frameCount - 1 && keyRealTime <= progress) {
-                    previousIndex = f;
-                    nextIndex = 0;
-
-                    // if the start offset for this animation is > 0, then we can't assume the
-                    // next frame will be at index 0. in this case we must loop through each
-                    // frame to find which one has a timestamp greater than StartOffset.
-                    if (instance->StartOffset > 0) {
-                        for (UInt32 ff = 0; ff < frameCount; ff++) {
-                            // get the correct time stamp for for frame [ff], which depends on [component]
-                            Real nextKeyRealTime = GetKeyFrameTime(component, ff, keyFrameSet);
-                            if (nextKeyRealTime > instance->StartOffset || ff == frameCount - 1) {
-                                nextIndex = ff;
-                            }
-                        }
+        if (frameCount == 0)return false;
+
+        // find the first key frame with a time stamp greater than [progress] (or the last key frame if there is none)
+        UInt32 f = FindKeyFrameIndex(track, progress, keyIndex);
+        keyIndex = f;
+
+        Real keyRealTime = track.GetKeyFrameTime(f);
+
+        // the previous key frame and the current key frame are the frames we want
+        previousIndex = 0;
+        if (f > 0)previousIndex = f - 1;
+        nextIndex = f;
+
+        // flag that indicates we need to interpolate from the last frame to the first frame
+        Bool overShoot = false;
+
+        // if f==frameCount-1 and keyRealTime <= progress, then we have reached the last frame and progress has moved
+        // beyond it. this means we need to interpolate between the last frame and the first frame (for smoothed animation looping).
+        if (f == frameCount - 1 && keyRealTime <= progress) {
+            previousIndex = f;
+            nextIndex = 0;
+
+            // if the start offset for this animation is > 0, then we can't assume the
+            // next frame will be at index 0. in this case we must loop through each
+            // frame to find which one has a timestamp greater than StartOffset.
+            if (instance->StartOffset > 0) {
+                for (UInt32 ff = 0; ff < frameCount; ff++) {
+                    Real nextKeyRealTime = track.GetKeyFrameTime(ff);
+                    if (nextKeyRealTime > instance->StartOffset || ff == frameCount - 1) {
+                        nextIndex = ff;
                     }
-                    overShoot = true;
                 }
+            }
+            overShoot = true;
+        }
 
-                // get pointers to the previous frame and the next frame
-                if (component == TransformationCompnent::Translation) {
-                    const TranslationKeyFrame& nextTranslationFrame = keyFrameSet.TranslationKeyFrames[nextIndex];
-                    const TranslationKeyFrame& lastTranslationFrame = keyFrameSet.TranslationKeyFrames[previousIndex];
-                    nextFrame = const_cast<TranslationKeyFrame *>(&nextTranslationFrame);
-                    previousFrame = const_cast<TranslationKeyFrame *>(&lastTranslationFrame);
-                }
-                else if (component == TransformationCompnent::Rotation) {
-                    const RotationKeyFrame& nextRotationFrame = keyFrameSet.RotationKeyFrames[nextIndex];
-                    const RotationKeyFrame& lastRotationFrame = keyFrameSet.RotationKeyFrames[previousIndex];
-                    nextFrame = const_cast<RotationKeyFrame *>(&nextRotationFrame);
-                    previousFrame = const_cast<RotationKeyFrame *>(&lastRotationFrame);
-                }
-                else if (component == TransformationCompnent::Scale) {
-                    const ScaleKeyFrame& nextScaleFrame = keyFrameSet.ScaleKeyFrames[nextIndex];
-                    const ScaleKeyFrame& lastScaleFrame = keyFrameSet.ScaleKeyFrames[previousIndex];
-                    nextFrame = const_cast<ScaleKeyFrame *>(&nextScaleFrame);
-                    previousFrame = const_cast<ScaleKeyFrame *>(&lastScaleFrame);
-                }
+        Real previousFrameTime = track.GetKeyFrameTime(previousIndex);
+        Real nextFrameTime = track.GetKeyFrameTime(nextIndex);
 
-                // calculate local progress between [previous] and [nextFrame]
-                Real interFrameTimeDelta = nextFrame->RealTime - previousFrame->RealTime;
-                if (overShoot)  interFrameTimeDelta = duration - previousFrame->RealTime;
+        // calculate local progress between [previous] and [nextFrame]
+        Real interFrameTimeDelta = nextFrameTime - previousFrameTime;
+        if (overShoot)  interFrameTimeDelta = duration - previousFrameTime;
 
-                Real interFrameElapsed = progress - previousFrame->RealTime;
-                interFrameProgress = 1;
-                if (interFrameTimeDelta > 0)interFrameProgress = interFrameElapsed / interFrameTimeDelta;
+        Real interFrameElapsed = progress - previousFrameTime;
+        interFrameProgress = 1;
+        if (interFrameTimeDelta > 0)interFrameProgress = interFrameElapsed / interFrameTimeDelta;
 
-                return true;
+        return true;
+    }
+
+    /*
+     * Find the index of the first key frame in [track] with a time stamp greater than [progress], or the index of the last key
+     * frame if there is no such key frame. Key frames are sorted by time stamp.
+     *
+     * Since playback progresses by a small amount each frame, the result is usually either [cursor] (the result of the previous
+     * search) or one of the key frames immediately following it, so those are checked first. A binary search is used
+     * otherwise (e.g. after a seek, or when playback wraps around to the beginning of the animation).
+     */
+    UInt32 AnimationPlayer::FindKeyFrameIndex(const KeyFrameTrack& track, Real progress, UInt32 cursor) const {
+        UInt32 frameCount = track.FrameCount;
+        UInt32 lastFrame = frameCount - 1;
+
+        // check the cursor and the next couple of key frames
+        if (cursor < frameCount && (cursor == 0 || track.GetKeyFrameTime(cursor - 1) <= progress)) {
+            UInt32 maxIndex = cursor + 2 < lastFrame ? cursor + 2 : lastFrame;
+            for (UInt32 f = cursor; f <= maxIndex; f++) {
+                if (track.GetKeyFrameTime(f) > progress || f == lastFrame)return f;
             }
         }
 
-        return false;
+        // binary search for the first key frame with a time stamp greater than [progress]
+        UInt32 low = 0;
+        UInt32 high = lastFrame;
+        while (low < high) {
+            UInt32 mid = low + (high - low) / 2;
+            if (track.GetKeyFrameTime(mid) > progress)high = mid;
+            else low = mid + 1;
+        }
+
+        return low;
+    }
+
+    /*
+     * Create a view of the key frames for the transformation component [component] of [channel]. If [compressedKeyFrames] is not null the
+     * key frames are read from it, otherwise they are read from [keyFrameSet].
+     */
+    AnimationPlayer::KeyFrameTrack::KeyFrameTrack(const KeyFrameSet& keyFrameSet, const CompressedAnimation * compressedKeyFrames, UInt32 channel, TransformationCompnent component) {
+        this->KeyFrames = &keyFrameSet;
+        this->CompressedKeyFrames = compressedKeyFrames;
+        this->Channel = channel;
+        this->Component = component;
+
+        if (compressedKeyFrames != nullptr)FrameCount = compressedKeyFrames->GetKeyFrameCount(channel, component);
+        else if (component == TransformationCompnent::Translation)FrameCount = (UInt32)keyFrameSet.TranslationKeyFrames.size();
+        else if (component == TransformationCompnent::Rotation)FrameCount = (UInt32)keyFrameSet.RotationKeyFrames.size();
+        else FrameCount = (UInt32)keyFrameSet.ScaleKeyFrames.size();
+    }
+
+    /*
+     * Get the time (in seconds) of the key frame at [frameIndex].
+     */
+    Real AnimationPlayer::KeyFrameTrack::GetKeyFrameTime(UInt32 frameIndex) const {
+        if (CompressedKeyFrames != nullptr)return CompressedKeyFrames->GetKeyFrameTime(Channel, Component, frameIndex);
+
+        if (Component == TransformationCompnent::Translation)return KeyFrames->TranslationKeyFrames[frameIndex].RealTime;
+        else if (Component == TransformationCompnent::Rotation)return KeyFrames->RotationKeyFrames[frameIndex].RealTime;
+        else return KeyFrames->ScaleKeyFrames[frameIndex].RealTime;
     }
 
     /*
-     * Get the key frame time for the frame at [frameIndex] for the desired transformation component [transformationComponent].
+     * Get the translation or scale (depending on [Component]) of the key frame at [frameIndex].
      */
-    Real AnimationPlayer::GetKeyFrameTime(TransformationCompnent transformationComponent, Int32 frameIndex, const KeyFrameSet& keyFrameSet) const {
-        Real keyFrameTime = 0;
-        if (transformationComponent == TransformationCompnent::Translation)
-            keyFrameTime = keyFrameSet.TranslationKeyFrames[frameIndex].RealTime;
-        else if (transformationComponent == TransformationCompnent::Rotation)
-            keyFrameTime = keyFrameSet.RotationKeyFrames[frameIndex].RealTime;
-        else if (transformationComponent == TransformationCompnent::Scale)
-            keyFrameTime = keyFrameSet.ScaleKeyFrames[frameIndex].RealTime;
+    void AnimationPlayer::KeyFrameTrack::GetVector(UInt32 frameIndex, Vector3& vector) const {
+        if (CompressedKeyFrames != nullptr) {
+            CompressedKeyFrames->GetVector(Channel, Component, frameIndex, vector);
+        }
+        else if (Component == TransformationCompnent::Translation) {
+            vector = KeyFrames->TranslationKeyFrames[frameIndex].Translation;
+        }
+        else {
+            vector = KeyFrames->ScaleKeyFrames[frameIndex].Scale;
+        }
+    }
 
-        return keyFrameTime;
+    /*
+     * Get the rotation of the key frame at [frameIndex].
+     */
+    void AnimationPlayer::KeyFrameTrack::GetRotation(UInt32 frameIndex, Quaternion& rotation) const {
+        if (CompressedKeyFrames != nullptr) {
+            CompressedKeyFrames->GetRotation(Channel, frameIndex, rotation);
+        }
+        else {
+            const Quaternion& source = KeyFrames->RotationKeyFrames[frameIndex].Rotation;
+            rotation.Set(source.x(), source.y(), source.z(), source.w());
+        }
     }
 
     /*
@@ -561,7 +861,10 @@ namespace GTE {
             NONFATAL_ASSERT(initSuccess, "AnimationPlayer::CreateAnimationInstance -> Unable to initialize animation instance.", false);
 
             registeredAnimations.push_back(instance);
-            animationWeights.push_back(0);
+            animationLayers.push_back(0);
+            for (UInt32 l = 0; l < layers.size(); l++) {
+                layers[l].AnimationWeights.push_back(0);
+            }
             crossFadeTargets.push_back(false);
 
             animationIndexMap[animation->GetObjectID()] = animationCount;
@@ -602,29 +905,40 @@ namespace GTE {
     }
 
     /*
-     * Start or resume playback of registered animation at [animationIndex].
+     * Start or resume playback of registered animation at [animationIndex]. All other animations
+     * in the same layer are stopped.
      */
     void AnimationPlayer::Play(UInt32 animationIndex) {
         NONFATAL_ASSERT(animationIndex < animationCount, "AnimationPlayer::Play -> 'animationIndex' is invalid.", true);
 
-
-        Real tempLeftOver = 1;
+        UInt32 layer = animationLayers[animationIndex];
         for (UInt32 i = 0; i < registeredAnimations.size(); i++) {
+            if (animationLayers[i] != layer)continue;
+
             AnimationInstanceRef instance = registeredAnimations[i];
 
             if (i != animationIndex) {
                 instance->Stop();
-                animationWeights[i] = 0;
+                SetAnimationWeight(i, 0);
             }
             else {
-                animationWeights[i] = 1;
+                SetAnimationWeight(i, 1);
                 instance->Play();
             }
+        }
+
+        CountPlayingAnimations();
+    }
 
-            tempLeftOver -= animationWeights[1];
+    /*
+     * Update [playingAnimationsCount] with the number of registered animations that are playing.
+     */
+    void AnimationPlayer::CountPlayingAnimations() {
+        playingAnimationsCount = 0;
+        for (UInt32 i = 0; i < registeredAnimations.size(); i++) {
+            AnimationInstanceRef instance = registeredAnimations[i];
+            if (instance.IsValid() && instance->Playing)playingAnimationsCount++;
         }
-        if (tempLeftOver < 0)tempLeftOver = 0;
-        playingAnimationsCount = 1;
     }
 
     /*
@@ -652,7 +966,7 @@ namespace GTE {
         if (instance->Playing)playingAnimationsCount--;
         instance->Stop();
 
-        animationWeights[animationIndex] = 0;
+        SetAnimationWeight(animationIndex, 0);
     }
 
     /*
@@ -734,10 +1048,13 @@ namespace GTE {
             // if a crossfade operation is currently active with the same target, then do nothing
             if (crossFadeTargets[targetIndex] == 1)return;
 
+            // the cross fade only affects the animations in the target's layer
+            UInt32 layer = animationLayers[targetIndex];
+
             CrossFadeBlendOp * blendOp = new(std::nothrow) CrossFadeBlendOp(duration, targetIndex);
             ASSERT(blendOp != nullptr, "AnimationPlayer::CrossFade -> Unable to allocate new CrossFadeBlendOp object.");
 
-            Bool initSuccess = blendOp->Init(animationWeights);
+            Bool initSuccess = blendOp->Init(layers[layer].AnimationWeights);
             if (!initSuccess) {
                 Debug::PrintError("AnimationPlayer::CrossFade -> Unable to init new CrossFadeBlendOp object.");
                 delete blendOp;
@@ -745,14 +1062,14 @@ namespace GTE {
             }
 
             crossFadeTargets[targetIndex] = 1;
-            blendOp->SetOnStartCallback([targetIndex, this](CrossFadeBlendOp * op) {
+            blendOp->SetOnStartCallback([targetIndex, layer, this](CrossFadeBlendOp * op) {
                 AnimationInstanceRef targetInstance = registeredAnimations[targetIndex];
                 if (!targetInstance.IsValid()) {
                     Debug::PrintError("AnimationPlayer::CrossFade::SetOnStartCallback -> Invalid target animation.");
                     return;
                 }
 
-                Bool initSuccess = op->Init(animationWeights);
+                Bool initSuccess = op->Init(layers[layer].AnimationWeights);
                 if (!initSuccess) {
                     Debug::PrintError("AnimationPlayer::CrossFade::SetOnStartCallback -> Unable to init CrossFadeBlendOp object.");
                     return;
@@ -769,8 +1086,10 @@ namespace GTE {
                 crossFadeTargets[targetIndex] = 0;
             });
 
-            blendOp->SetOnCompleteCallback([targetIndex, this](CrossFadeBlendOp * op) {
+            blendOp->SetOnCompleteCallback([targetIndex, layer, this](CrossFadeBlendOp * op) {
                 for (UInt32 i = 0; i < registeredAnimations.size(); i++) {
+                    if (animationLayers[i] != layer)continue;
+
                     if (i != targetIndex) {
                         AnimationInstanceSharedPtr instance = registeredAnimations[i];
                         if (!instance.IsValid()) {
@@ -779,22 +1098,22 @@ namespace GTE {
                         }
 
                         Stop(i);
-                        animationWeights[i] = 0;
+                        SetAnimationWeight(i, 0);
                     }
                     else {
-                        animationWeights[i] = 1;
+                        SetAnimationWeight(i, 1);
                     }
                 }
 
                 crossFadeTargets[targetIndex] = 0;
-                playingAnimationsCount = 1;
+                CountPlayingAnimations();
             });
 
             // If [queued] == false, then we want to start the cross-fade immediately. This
             // means we need to clear the
-            if (!queued)ClearBlendOpQueue();
+            if (!queued)ClearBlendOpQueue(layer);
 
-            QueueBlendOperation(blendOp);
+            QueueBlendOperation(layer, blendOp);
         }
     }
 
@@ -810,4 +1129,127 @@ namespace GTE {
             instance->PlayBackMode = playbackMode;
         }
     }
+
+    /*
+     * Always update this player using the AnimationManager LOD level at index [lodLevel], regardless
+     * of its distance from the camera and whether or not it is visible. Passing -1 restores automatic
+     * selection of the LOD level.
+     */
+    void AnimationPlayer::SetLODOverride(Int32 lodLevel) {
+        lodOverride = lodLevel < 0 ? -1 : lodLevel;
+    }
+
+    /*
+     * Get the index of the LOD level this player is forced to use, or -1 if the level is chosen automatically.
+     */
+    Int32 AnimationPlayer::GetLODOverride() const {
+        return lodOverride;
+    }
+
+    /*
+     * Add a new layer on top of the existing layers. Animations in the layer are combined with the result
+     * of the layers below it according to [mode], and with an influence of [weight]. Returns the index of
+     * the new layer.
+     */
+    UInt32 AnimationPlayer::AddLayer(AnimationBlendMode mode, Real weight) {
+        Layer layer;
+        layer.Mode = mode;
+        layer.Weight = weight;
+        layer.AnimationWeights.resize(registeredAnimations.size(), 0);
+        layers.push_back(layer);
+
+        return (UInt32)layers.size() - 1;
+    }
+
+    UInt32 AnimationPlayer::GetLayerCount() const {
+        return (UInt32)layers.size();
+    }
+
+    /*
+     * Set the influence of [layer] on the layers below it. Has no effect on the base layer.
+     */
+    void AnimationPlayer::SetLayerWeight(UInt32 layer, Real weight) {
+        NONFATAL_ASSERT(layer < layers.size(), "AnimationPlayer::SetLayerWeight -> 'layer' is out of range.", true);
+        layers[layer].Weight = weight;
+    }
+
+    /*
+     * Set how [layer] is combined with the layers below it. Has no effect on the base layer.
+     */
+    void AnimationPlayer::SetLayerBlendMode(UInt32 layer, AnimationBlendMode mode) {
+        NONFATAL_ASSERT(layer < layers.size(), "AnimationPlayer::SetLayerBlendMode -> 'layer' is out of range.", true);
+        layers[layer].Mode = mode;
+    }
+
+    /*
+     * Set the influence of [layer] on the skeleton node named [nodeName] to [weight] (and on all of its
+     * descendants if [includeDescendants] is true). A layer without a node mask affects all nodes; the first call
+     * to this method for a layer creates a mask in which all other nodes are unaffected.
+     */
+    void AnimationPlayer::SetLayerNodeMask(UInt32 layer, const std::string& nodeName, Real weight, Bool includeDescendants) {
+        NONFATAL_ASSERT(layer < layers.size(), "AnimationPlayer::SetLayerNodeMask -> 'layer' is out of range.", true);
+
+        Int32 maskRoot = target->GetNodeMapping(nodeName);
+        NONFATAL_ASSERT(maskRoot >= 0, "AnimationPlayer::SetLayerNodeMask -> Could not find node.", true);
+
+        UInt32 nodeCount = target->GetNodeCount();
+        std::vector<Real>& nodeMask = layers[layer].NodeMask;
+        if (nodeMask.size() != nodeCount)nodeMask.assign(nodeCount, 0);
+
+        if (!includeDescendants) {
+            nodeMask[maskRoot] = weight;
+            return;
+        }
+
+        std::vector<Int32> parents;
+        std::vector<UInt32> depths;
+        target->GetNodeHierarchy(parents, depths);
+
+        for (UInt32 node = 0; node < nodeCount; node++) {
+            // walk up the hierarchy from [node] to see if [maskRoot] is one of its ancestors
+            Int32 current = (Int32)node;
+            while (current >= 0 && current != maskRoot) {
+                current = parents[current];
+            }
+            if (current == maskRoot)nodeMask[node] = weight;
+        }
+    }
+
+    /*
+     * Remove the node mask from [layer], so that it affects all nodes.
+     */
+    void AnimationPlayer::ClearLayerNodeMask(UInt32 layer) {
+        NONFATAL_ASSERT(layer < layers.size(), "AnimationPlayer::ClearLayerNodeMask -> 'layer' is out of range.", true);
+        layers[layer].NodeMask.clear();
+    }
+
+    /*
+     * Move [animation] to [layer]. Play(), Stop() and CrossFade() only affect the animations in the
+     * same layer as their target animation. All animations start out in the base layer (layer 0).
+     */
+    void AnimationPlayer::SetAnimationLayer(AnimationConstRef animation, UInt32 layer) {
+        NONFATAL_ASSERT(animation.IsValid(), "AnimationPlayer::SetAnimationLayer -> 'animation' is invalid.", true);
+        NONFATAL_ASSERT(layer < layers.size(), "AnimationPlayer::SetAnimationLayer -> 'layer' is out of range.", true);
+
+        if (animationIndexMap.find(animation->GetObjectID()) != animationIndexMap.end()) {
+            UInt32 targetIndex = animationIndexMap[animation->GetObjectID()];
+            NONFATAL_ASSERT(targetIndex < animationCount, "AnimationPlayer::SetAnimationLayer -> invalid animation index found in index map.", true);
+
+            Real weight = GetAnimationWeight(targetIndex);
+            SetAnimationWeight(targetIndex, 0);
+            animationLayers[targetIndex] = layer;
+            SetAnimationWeight(targetIndex, weight);
+        }
+    }
+
+    /*
+     * Animations with a blending weight below [threshold] are not sampled.
+     */
+    void AnimationPlayer::SetWeightThreshold(Real threshold) {
+        weightThreshold = threshold;
+    }
+
+    Real AnimationPlayer::GetWeightThreshold() const {
+        return weightThreshold;
+    }
 }
@@ -6,6 +6,11 @@
 *
 * This class manages playback of all animations for a single Skeleton target.
 *
+* Animations are organized in layers. The animations within a layer are blended
+* by weight (driven by cross fades), and each layer is then combined with the
+* layers below it, either replacing or adding to their pose, optionally only for
+* a subset of the skeleton's nodes.
+*
 ***********************************************/
 
 #ifndef _GTE_ANIMATION_PLAYER_H_
@@ -20,6 +25,7 @@
 #include "object/engineobject.h"
 #include "geometry/vector/vector3.h"
 #include "geometry/quaternion.h"
+#include "geometry/matrix4x4.h"
 #include "keyframeset.h"
 
 namespace GTE {
@@ -27,6 +33,8 @@ namespace GTE {
     class Transform;
     class SkeletonNode;
     class BlendOp;
+    class CompressedAnimation;
+    class Point3;
 
     enum class TransformationCompnent {
         Translation = 0,
@@ -40,10 +48,119 @@ namespace GTE {
         PingPong = 2
     };
 
+    enum class AnimationBlendMode {
+        // the layer's pose replaces the pose of the layers below it
+        Override = 0,
+        // the layer's pose, relative to the initial pose of the skeleton, is added to the pose of the layers below it
+        Additive = 1
+    };
+
+    /*
+     * Describes how often, and in how much detail, the animations of an AnimationPlayer are sampled.
+     */
+    class AnimationLODLevel {
+    public:
+
+        static const UInt32 UnlimitedNodeDepth = 0xFFFFFFFF;
+
+        // minimum distance from the camera at which this level is used
+        Real MinDistance;
+        // number of frames between successive samplings of the player's animations; the frames in between
+        // interpolate between the two most recent samples
+        UInt32 UpdateInterval;
+        // nodes deeper than this in the skeleton hierarchy are not re-sampled and keep their last pose
+        UInt32 MaxNodeDepth;
+
+        AnimationLODLevel() {
+            MinDistance = 0;
+            UpdateInterval = 1;
+            MaxNodeDepth = UnlimitedNodeDepth;
+        }
+
+        AnimationLODLevel(Real minDistance, UInt32 updateInterval, UInt32 maxNodeDepth) {
+            MinDistance = minDistance;
+            UpdateInterval = updateInterval;
+            MaxNodeDepth = maxNodeDepth;
+        }
+    };
+
     class AnimationPlayer {
         friend class EngineObjectManager;
         friend class AnimationManager;
 
+        /*
+         * Aggregate transformation of a single skeleton node, sampled from all active animations.
+         */
+        class NodePose {
+        public:
+
+            Vector3 Translation;
+            Quaternion Rotation;
+            Vector3 Scale;
+            // sum of the weights of the animations that contributed to this pose
+            Real Weight;
+            // was a transformation actually calculated for the node?
+            Bool Valid;
+
+            NodePose() {
+                Weight = 0;
+                Valid = false;
+            }
+        };
+
+        /*
+         * A set of animations that are blended with each other, the result of which is then combined with the
+         * result of the layers below it. The first layer is the base layer, and it is always present.
+         */
+        class Layer {
+        public:
+
+            // how this layer is combined with the layers below it
+            AnimationBlendMode Mode;
+            // influence of this layer on the layers below it
+            Real Weight;
+            // influence of this layer on each node of the target skeleton; if empty, all nodes are fully affected
+            std::vector<Real> NodeMask;
+            // blending weight of each registered animation within this layer (always 0 for animations in other layers)
+            std::vector<Real> AnimationWeights;
+            // active blending operations, which drive [AnimationWeights]
+            std::queue<BlendOp*> BlendOperations;
+
+            Layer() {
+                Mode = AnimationBlendMode::Override;
+                Weight = 1;
+            }
+        };
+
+        // number of values stored per node in the pose buffers: translation (x, y, z, unused),
+        // rotation (x, y, z, w), and scale (x, y, z, unused)
+        static const UInt32 PoseStride = 12;
+        // animations with a weight lower than this are not sampled by default
+        static constexpr Real DefaultWeightThreshold = .001f;
+
+        /*
+         * Read-only view of the key frames of a single transformation component of a single animation channel,
+         * which are stored either in a KeyFrameSet or in a CompressedAnimation.
+         */
+        class KeyFrameTrack {
+        public:
+
+            // uncompressed key frames of the channel
+            const KeyFrameSet * KeyFrames;
+            // compressed key frames of the animation, or nullptr if the animation is not compressed
+            const CompressedAnimation * CompressedKeyFrames;
+            UInt32 Channel;
+            TransformationCompnent Component;
+            // number of key frames in the track
+            UInt32 FrameCount;
+
+            KeyFrameTrack(const KeyFrameSet& keyFrameSet, const CompressedAnimation * compressedKeyFrames, UInt32 channel, TransformationCompnent component);
+
+            Real GetKeyFrameTime(UInt32 frameIndex) const;
+            void GetVector(UInt32 frameIndex, Vector3& vector) const;
+            void GetRotation(UInt32 frameIndex, Quaternion& rotation) const;
+        };
+
         // number of animations being handled by this player
         UInt32 animationCount;
         // mapping from object ID's of Animation objects to respective indices in member arrays/vectors
@@ -52,34 +169,80 @@ namespace GTE {
         SkeletonSharedPtr target;
         // mapping from the object ID's of Animation objects to corresponding AnimationInstance objects
         std::vector<AnimationInstanceSharedPtr> registeredAnimations;
-        // weights used for animation blending
-        std::vector<Real> animationWeights;
-        // active animation blending operations
-        std::queue<BlendOp*> activeBlendOperations;
-        // flags that indicate if the animation at a specified index is the target of a cross fade operation in activeBlendOperations
+        // animation layers, in the order in which they are applied
+        std::vector<Layer> layers;
+        // index in [layers] of the layer to which each registered animation belongs
+        std::vector<UInt32> animationLayers;
+        // animations with a weight lower than this are not sampled
+        Real weightThreshold;
+        // flags that indicate if the animation at a specified index is the target of a cross fade operation in its layer
         std::vector<Bool> crossFadeTargets;
         // number of animations currently playing
         Int32 playingAnimationsCount;
+        // local transformation of each node in [target] calculated by the last call to Evaluate()
+        std::vector<Matrix4x4> evaluatedPose;
+        // has [evaluatedPose] been updated since it was last applied to [target]?
+        Bool evaluatedPoseChanged;
+        // most recently sampled pose of each node in [target]
+        std::vector<NodePose> sampledPose;
+        // the sampled pose that preceded [sampledPose]
+        std::vector<NodePose> previousSampledPose;
+        // depth of each node of [target] in the skeleton hierarchy
+        std::vector<UInt32> nodeDepths;
+        // index of the parent of each node of [target], or -1 for the root node
+        std::vector<Int32> nodeParents;
+        // flags that indicate which nodes are sampled by the current call to ApplyActiveAnimations()
+        std::vector<Bool> nodesToSample;
+        // indices of the registered animations of the layer currently being sampled that contribute to the pose
+        std::vector<UInt32> activeAnimations;
+        // pose of a single animation, in the layout described by [PoseStride]
+        std::vector<Real> clipPose;
+        // weighted sum of the poses of the animations in the layer currently being sampled
+        std::vector<Real> layerPose;
+        // sum of the weights accumulated into [layerPose] for each node
+        std::vector<Real> layerPoseWeights;
+        // level of detail with which this player is currently updated (chosen by AnimationManager)
+        AnimationLODLevel lod;
+        // index of the AnimationManager LOD level to always use for this player, or -1 to choose it by distance
+        Int32 lodOverride;
+        // if true, the animations of this player are advanced but not sampled (e.g. when [target] is off-screen)
+        Bool samplingSuspended;
+        // number of frames since the animations of this player were last sampled
+        UInt32 framesSinceSample;
+        // can the next evaluated pose be interpolated from [previousSampledPose]?
+        Bool canInterpolate;
+        // value of the AnimationManager frame counter the last time [target] was found to be visible
+        UInt64 lastVisibleFrame;
 
         AnimationPlayer(SkeletonRef target);
         ~AnimationPlayer();
 
-        void QueueBlendOperation(BlendOp * op);
-        BlendOp * GetCurrentBlendOp();
-        void ClearBlendOpQueue();
+        void QueueBlendOperation(UInt32 layer, BlendOp * op);
+        BlendOp * GetCurrentBlendOp(UInt32 layer);
+        void ClearBlendOpQueue(UInt32 layer);
+        Real GetAnimationWeight(UInt32 animationIndex) const;
+        void SetAnimationWeight(UInt32 animationIndex, Real weight);
+        void CountPlayingAnimations();
 
         void Update();
+        void Evaluate();
+        void CommitPose();
         void UpdateBlendingOperations();
         void CheckWeights();
         void ApplyActiveAnimations();
+        void SampleAnimation(AnimationInstanceRef instance, Real * pose);
+        void AccumulatePose(const Real * pose, Real weight, Real * accumulatedPose, Real * accumulatedWeights) const;
+        void ApplyLayerPose(UInt32 layerIndex);
+        void BuildPose(Real t);
+        Bool GetTargetPosition(Point3& position);
         void UpdateAnimationsProgress();
         void UpdateAnimationInstanceProgress(AnimationInstanceRef instance) const;
-        void CalculateInterpolatedValues(AnimationInstanceConstRef instance, UInt32 channel, Vector3& translation, Quaternion& rotation, Vector3& scale) const;
-        void CalculateInterpolatedTranslation(AnimationInstanceConstRef instance, const KeyFrameSet& keyFrameSet, Vector3& vector) const;
-        void CalculateInterpolatedScale(AnimationInstanceConstRef instance, const KeyFrameSet& keyFrameSet, Vector3& vector) const;
-        void CalculateInterpolatedRotation(AnimationInstanceConstRef instance, const KeyFrameSet& keyFrameSet, Quaternion& rotation) const;
-        Bool CalculateInterpolation(AnimationInstanceConstRef instance, const KeyFrameSet& keyFrameSet, UInt32& lastIndex, UInt32& nextIndex, Real& interFrameProgress, TransformationCompnent component) const;
-        Real GetKeyFrameTime(TransformationCompnent transformationComponent, Int32 frameIndex, const KeyFrameSet& keyFrameSet) const;
+        void CalculateInterpolatedValues(AnimationInstanceConstRef instance, UInt32 node, UInt32 channel, Vector3& translation, Quaternion& rotation, Vector3& scale) const;
+        void CalculateInterpolatedTranslation(AnimationInstanceConstRef instance, const KeyFrameTrack& track, UInt32& keyIndex, Vector3& vector) const;
+        void CalculateInterpolatedScale(AnimationInstanceConstRef instance, const KeyFrameTrack& track, UInt32& keyIndex, Vector3& vector) const;
+        void CalculateInterpolatedRotation(AnimationInstanceConstRef instance, const KeyFrameTrack& track, UInt32& keyIndex, Quaternion& rotation) const;
+        Bool CalculateInterpolation(AnimationInstanceConstRef instance, const KeyFrameTrack& track, UInt32& keyIndex, UInt32& lastIndex, UInt32& nextIndex, Real& interFrameProgress) const;
+        UInt32 FindKeyFrameIndex(const KeyFrameTrack& track, Real progress, UInt32 cursor) const;
 
         void SetSpeed(UInt32 animationIndex, Real speedFactor);
         void Play(UInt32 animationIndex);
@@ -98,6 +261,18 @@ namespace GTE {
         void CrossFade(AnimationConstRef target, Real duration);
         void CrossFade(AnimationConstRef target, Real duration, Bool queued);
         void SetPlaybackMode(AnimationConstRef target, PlaybackMode playbackMode);
+        void SetLODOverride(Int32 lodLevel);
+        Int32 GetLODOverride() const;
+
+        UInt32 AddLayer(AnimationBlendMode mode, Real weight);
+        UInt32 GetLayerCount() const;
+        void SetLayerWeight(UInt32 layer, Real weight);
+        void SetLayerBlendMode(UInt32 layer, AnimationBlendMode mode);
+        void SetLayerNodeMask(UInt32 layer, const std::string& nodeName, Real weight, Bool includeDescendants);
+        void ClearLayerNodeMask(UInt32 layer);
+        void SetAnimationLayer(AnimationConstRef animation, UInt32 layer);
+        void SetWeightThreshold(Real threshold);
+        Real GetWeightThreshold() const;
     };
 }
 
@@ -36,7 +36,6 @@ namespace GTE {
         UInt32 ID;
         // this matrix converts the bone (and attached vertices) to bone space
         Matrix4x4 OffsetMatrix;
-        Matrix4x4 TempFullMatrix;
         // when this bone is part of a Skeleton object, [Node] points to this bone's
         // corresponding SkeletonNode object in that Skeleton object.
         SkeletonNode * Node;
@@ -0,0 +1,367 @@
+#include <memory.h>
+#include <math.h>
+
+#include "compressedanimation.h"
+#include "keyframeset.h"
+#include "geometry/vector/vector3.h"
+#include "geometry/quaternion.h"
+#include "gtemath/gtemath.h"
+#include "global/global.h"
+#include "global/assert.h"
+#include "debug/gtedebug.h"
+
+namespace GTE {
+    /*
+    * Default constructor.
+    */
+    CompressedAnimation::CompressedAnimation() {
+        channelCount = 0;
+    }
+
+    /*
+     * Destructor.
+     */
+    CompressedAnimation::~CompressedAnimation() {
+
+    }
+
+    /*
+     * Build the compressed representation of the [channelCount] key frame sets in [keyFrameSets]. The tolerances used
+     * to remove redundant key frames are specified by [settings].
+     */
+    Bool CompressedAnimation::Init(const KeyFrameSet * keyFrameSets, UInt32 channelCount, const AnimationCompressionSettings& settings) {
+        NONFATAL_ASSERT_RTRN(keyFrameSets != nullptr, "CompressedAnimation::Init -> 'keyFrameSets' is null.", false, true);
+
+        this->channelCount = channelCount;
+
+        tracks.clear();
+        tracks.resize(channelCount * TracksPerChannel);
+        keyFrameData.clear();
+
+        std::vector<Real> times;
+        std::vector<Real> values;
+        std::vector<UInt32> keptKeyFrames;
+
+        for (UInt32 c = 0; c < channelCount; c++) {
+            const KeyFrameSet& keyFrameSet = keyFrameSets[c];
+            if (!keyFrameSet.Used)continue;
+
+            // gather the times & values of each track (four values per key frame, regardless of the component)
+            for (UInt32 t = 0; t < TracksPerChannel; t++) {
+                TransformationCompnent component = (TransformationCompnent)t;
+                Real tolerance = 0;
+
+                times.clear();
+                values.clear();
+
+                if (component == TransformationCompnent::Translation) {
+                    for (UInt32 k = 0; k < keyFrameSet.TranslationKeyFrames.size(); k++) {
+                        const TranslationKeyFrame& keyFrame = keyFrameSet.TranslationKeyFrames[k];
+                        times.push_back(keyFrame.RealTime);
+                        values.push_back(keyFrame.Translation.x);
+                        values.push_back(keyFrame.Translation.y);
+                        values.push_back(keyFrame.Translation.z);
+                        values.push_back(0);
+                    }
+                    tolerance = settings.TranslationTolerance;
+                }
+                else if (component == TransformationCompnent::Rotation) {
+                    for (UInt32 k = 0; k < keyFrameSet.RotationKeyFrames.size(); k++) {
+                        const RotationKeyFrame& keyFrame = keyFrameSet.RotationKeyFrames[k];
+                        times.push_back(keyFrame.RealTime);
+                        values.push_back(keyFrame.Rotation.x());
+                        values.push_back(keyFrame.Rotation.y());
+                        values.push_back(keyFrame.Rotation.z());
+                        values.push_back(keyFrame.Rotation.w());
+                    }
+                    tolerance = settings.RotationTolerance;
+                }
+                else {
+                    for (UInt32 k = 0; k < keyFrameSet.ScaleKeyFrames.size(); k++) {
+                        const ScaleKeyFrame& keyFrame = keyFrameSet.ScaleKeyFrames[k];
+                        times.push_back(keyFrame.RealTime);
+                        values.push_back(keyFrame.Scale.x);
+                        values.push_back(keyFrame.Scale.y);
+                        values.push_back(keyFrame.Scale.z);
+                        values.push_back(0);
+                    }
+                    tolerance = settings.ScaleTolerance;
+                }
+
+                ReduceKeyFrames(times, values, component, tolerance, keptKeyFrames);
+                AddTrack(tracks[c * TracksPerChannel + t], times, values, keptKeyFrames, component);
+            }
+        }
+
+        keyFrameData.shrink_to_fit();
+
+        return true;
+    }
+
+    /*
+     * Get the track for the transformation component [component] of the channel [channel].
+     */
+    const CompressedAnimation::Track& CompressedAnimation::GetTrack(UInt32 channel, TransformationCompnent component) const {
+        return tracks[channel * TracksPerChannel + (UInt32)component];
+    }
+
+    /*
+     * Determine which of the key frames described by [times] and [values] (four values per key frame) must be kept, so that
+     * every key frame that is removed can be reproduced by interpolating between the kept key frames with an error no greater than
+     * [tolerance]. The indices of the kept key frames are stored in [keptKeyFrames] in ascending order.
+     *
+     * The first and last key frames are always kept (they are used when interpolating across the loop point), unless all key frames
+     * are within [tolerance] of the first one, in which case only the first key frame is kept.
+     */
+    void CompressedAnimation::ReduceKeyFrames(const std::vector<Real>& times, const std::vector<Real>& values, TransformationCompnent component,
+                                              Real tolerance, std::vector<UInt32>& keptKeyFrames) const {
+        keptKeyFrames.clear();
+
+        UInt32 keyFrameCount = (UInt32)times.size();
+        if (keyFrameCount == 0)return;
+
+        keptKeyFrames.push_back(0);
+
+        Bool constant = true;
+        for (UInt32 k = 1; k < keyFrameCount && constant; k++) {
+            if (CalculateError(&values[0], &values[k * 4], component) > tolerance)constant = false;
+        }
+        if (constant)return;
+
+        Real interpolated[4];
+        UInt32 anchor = 0;
+
+        // extend the segment that starts at [anchor] one key frame at a time, until it can no longer reproduce
+        // all of the key frames it spans. the key frame before that point is kept and becomes the new [anchor].
+        for (UInt32 k = 2; k < keyFrameCount; k++) {
+            Bool representable = k - anchor <= MaxReducedSpan;
+            Real span = times[k] - times[anchor];
+
+            for (UInt32 j = anchor + 1; j < k && representable; j++) {
+                Real t = span > 0 ? (times[j] - times[anchor]) / span : 0;
+                Interpolate(&values[anchor * 4], &values[k * 4], t, component, interpolated);
+                if (CalculateError(interpolated, &values[j * 4], component) > tolerance)representable = false;
+            }
+
+            if (!representable) {
+                keptKeyFrames.push_back(k - 1);
+                anchor = k - 1;
+            }
+        }
+
+        keptKeyFrames.push_back(keyFrameCount - 1);
+    }
+
+    /*
+     * Quantize the key frames in [times] & [values] specified by [keptKeyFrames], append them to [keyFrameData], and
+     * fill in the corresponding [track].
+     */
+    void CompressedAnimation::AddTrack(Track& track, const std::vector<Real>& times, const std::vector<Real>& values, const std::vector<UInt32>& keptKeyFrames, TransformationCompnent component) {
+        track.KeyFrameCount = (UInt32)keptKeyFrames.size();
+        track.DataOffset = (UInt32)keyFrameData.size();
+
+        if (track.KeyFrameCount == 0)return;
+
+        // find the range of each component of the vector values
+        if (component != TransformationCompnent::Rotation) {
+            for (UInt32 c = 0; c < 3; c++) {
+                Real minValue = values[keptKeyFrames[0] * 4 + c];
+                Real maxValue = minValue;
+                for (UInt32 k = 1; k < track.KeyFrameCount; k++) {
+                    Real value = values[keptKeyFrames[k] * 4 + c];
+                    minValue = GTEMath::Min(minValue, value);
+                    maxValue = GTEMath::Max(maxValue, value);
+                }
+                track.RangeMin[c] = minValue;
+                track.RangeExtent[c] = maxValue - minValue;
+            }
+        }
+
+        keyFrameData.resize(track.DataOffset + track.KeyFrameCount * KeyFrameSize);
+        UInt16 * out = &keyFrameData[track.DataOffset];
+
+        for (UInt32 k = 0; k < track.KeyFrameCount; k++, out += KeyFrameSize) {
+            UInt32 source = keptKeyFrames[k];
+
+            float time = (float)times[source];
+            memcpy(out, &time, sizeof(float));
+
+            UInt16 * valueOut = out + KeyFrameValueOffset;
+            if (component == TransformationCompnent::Rotation) {
+                EncodeRotation(&values[source * 4], valueOut);
+            }
+            else {
+                for (UInt32 c = 0; c < 3; c++) {
+                    Real extent = track.RangeExtent[c];
+                    valueOut[c] = extent > 0 ? QuantizeUnit((values[source * 4 + c] - track.RangeMin[c]) / extent, 65535) : 0;
+                }
+            }
+        }
+    }
+
+    /*
+     * Calculate the difference between the values [a] and [b] of the transformation component [component]. For rotations
+     * this is the angle between the two rotations, otherwise it is the distance between the two vectors.
+     */
+    Real CompressedAnimation::CalculateError(const Real * a, const Real * b, TransformationCompnent component) {
+        if (component == TransformationCompnent::Rotation) {
+            // q and -q are the same rotation
+            Real sign = (a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3]) < 0 ? (Real)-1.0 : (Real)1.0;
+
+            // 2 * acos(dot) loses almost all precision for small angles, so the angle is calculated
+            // from the lengths of the difference and the sum of the two quaternions instead
+            Real differenceSquared = 0;
+            Real sumSquared = 0;
+            for (UInt32 i = 0; i < 4; i++) {
+                Real difference = a[i] - b[i] * sign;
+                Real sum = a[i] + b[i] * sign;
+                differenceSquared += difference * difference;
+                sumSquared += sum * sum;
+            }
+
+            return 4 * (Real)atan2(GTEMath::SquareRoot(differenceSquared), GTEMath::SquareRoot(sumSquared));
+        }
+
+        Real dx = a[0] - b[0];
+        Real dy = a[1] - b[1];
+        Real dz = a[2] - b[2];
+        return GTEMath::SquareRoot(dx * dx + dy * dy + dz * dz);
+    }
+
+    /*
+     * Interpolate between the values [a] and [b] of the transformation component [component] in the same way AnimationPlayer
+     * does, and store the result in [out].
+     */
+    void CompressedAnimation::Interpolate(const Real * a, const Real * b, Real t, TransformationCompnent component, Real * out) {
+        if (component == TransformationCompnent::Rotation) {
+            Quaternion result = Quaternion::slerp(Quaternion(a), Quaternion(b), t);
+            out[0] = result.x();
+            out[1] = result.y();
+            out[2] = result.z();
+            out[3] = result.w();
+        }
+        else {
+            for (UInt32 i = 0; i < 3; i++) {
+                out[i] = (b[i] - a[i]) * t + a[i];
+            }
+            out[3] = 0;
+        }
+    }
+
+    /*
+     * Map [value] from the range 0 - 1 to the integer range 0 - [maxValue].
+     */
+    UInt16 CompressedAnimation::QuantizeUnit(Real value, UInt32 maxValue) {
+        if (value < 0)value = 0;
+        if (value > 1)value = 1;
+        return (UInt16)(value * (Real)maxValue + .5f);
+    }
+
+    /*
+     * Encode the rotation [rotation] (x, y, z, w) into three 16-bit values using the "smallest three" method. The index of the
+     * component with the largest magnitude is stored in 2 bits, and the other three components (which lie in the
+     * range -1/sqrt(2) to 1/sqrt(2) for a unit quaternion) are stored in 15 bits each.
+     */
+    void CompressedAnimation::EncodeRotation(const Real * rotation, UInt16 * out) {
+        Real q[4] = { rotation[0], rotation[1], rotation[2], rotation[3] };
+
+        Real length = GTEMath::SquareRoot(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+        if (length > 0) {
+            for (UInt32 i = 0; i < 4; i++)q[i] /= length;
+        }
+        else {
+            q[0] = q[1] = q[2] = 0;
+            q[3] = 1;
+        }
+
+        UInt32 largest = 0;
+        for (UInt32 i = 1; i < 4; i++) {
+            if (GTEMath::Abs(q[i]) > GTEMath::Abs(q[largest]))largest = i;
+        }
+
+        // q and -q are the same rotation, so negate if necessary to make the dropped component positive
+        Real sign = q[largest] < 0 ? (Real)-1.0 : (Real)1.0;
+        Real sqrtTwo = GTEMath::SquareRoot(2);
+
+        UInt64 bits = largest;
+        for (UInt32 i = 0; i < 4; i++) {
+            if (i == largest)continue;
+            Real unit = (q[i] * sign * sqrtTwo + 1) * .5f;
+            bits = (bits << 15) | QuantizeUnit(unit, 32767);
+        }
+
+        out[0] = (UInt16)(bits >> 32);
+        out[1] = (UInt16)(bits >> 16);
+        out[2] = (UInt16)bits;
+    }
+
+    /*
+     * Decode a rotation that was encoded by EncodeRotation() and store it in [out] (x, y, z, w).
+     */
+    void CompressedAnimation::DecodeRotation(const UInt16 * data, Real * out) {
+        UInt64 bits = ((UInt64)data[0] << 32) | ((UInt64)data[1] << 16) | (UInt64)data[2];
+        UInt32 largest = (UInt32)(bits >> 45) & 3;
+        Real invSqrtTwo = (Real)0.70710678118;
+
+        Real sumSquares = 0;
+        for (Int32 i = 3; i >= 0; i--) {
+            if ((UInt32)i == largest)continue;
+            Real unit = (Real)(bits & 0x7FFF) / (Real)32767.0;
+            bits >>= 15;
+
+            Real value = (unit * 2 - 1) * invSqrtTwo;
+            out[i] = value;
+            sumSquares += value * value;
+        }
+
+        out[largest] = GTEMath::SquareRoot(GTEMath::Max((Real)0.0, 1 - sumSquares));
+    }
+
+    /*
+     * Get the number of key frames for the transformation component [component] of the channel [channel].
+     */
+    UInt32 CompressedAnimation::GetKeyFrameCount(UInt32 channel, TransformationCompnent component) const {
+        NONFATAL_ASSERT_RTRN(channel < channelCount, "CompressedAnimation::GetKeyFrameCount -> 'channel' is out of range.", 0, true);
+        return GetTrack(channel, component).KeyFrameCount;
+    }
+
+    /*
+     * Get the time (in seconds) of key frame [frameIndex] of the transformation component [component] of the channel [channel].
+     */
+    Real CompressedAnimation::GetKeyFrameTime(UInt32 channel, TransformationCompnent component, UInt32 frameIndex) const {
+        const Track& track = GetTrack(channel, component);
+        float time;
+        memcpy(&time, &keyFrameData[track.DataOffset + frameIndex * KeyFrameSize], sizeof(float));
+        return (Real)time;
+    }
+
+    /*
+     * Get the translation or scale (specified by [component]) of key frame [frameIndex] of the channel [channel], and
+     * store it in [vector].
+     */
+    void CompressedAnimation::GetVector(UInt32 channel, TransformationCompnent component, UInt32 frameIndex, Vector3& vector) const {
+        const Track& track = GetTrack(channel, component);
+        const UInt16 * data = &keyFrameData[track.DataOffset + frameIndex * KeyFrameSize + KeyFrameValueOffset];
+
+        vector.Set(track.RangeMin[0] + (Real)data[0] / (Real)65535.0 * track.RangeExtent[0],
+                   track.RangeMin[1] + (Real)data[1] / (Real)65535.0 * track.RangeExtent[1],
+                   track.RangeMin[2] + (Real)data[2] / (Real)65535.0 * track.RangeExtent[2]);
+    }
+
+    /*
+     * Get the rotation of key frame [frameIndex] of the channel [channel], and store it in [rotation].
+     */
+    void CompressedAnimation::GetRotation(UInt32 channel, UInt32 frameIndex, Quaternion& rotation) const {
+        const Track& track = GetTrack(channel, TransformationCompnent::Rotation);
+        Real decoded[4];
+        DecodeRotation(&keyFrameData[track.DataOffset + frameIndex * KeyFrameSize + KeyFrameValueOffset], decoded);
+        rotation.Set(decoded[0], decoded[1], decoded[2], decoded[3]);
+    }
+
+    /*
+     * Get the amount of memory used by the compressed key frames and the track descriptions.
+     */
+    UInt32 CompressedAnimation::GetSizeInBytes() const {
+        return (UInt32)(tracks.size() * sizeof(Track) + keyFrameData.size() * sizeof(UInt16));
+    }
+}
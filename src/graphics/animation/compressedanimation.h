@@ -0,0 +1,123 @@
+/*********************************************
+*
+* class: CompressedAnimation
+*
+* author: Mark Kellogg
+*
+* A compact, read-only representation of the key frames of every channel
+* in an Animation.
+*
+* Compression happens in two steps. First, key frames that can be reproduced
+* (within a tolerance) by interpolating between their neighbors are removed.
+* Then the values of the remaining key frames are quantized: translations and
+* scales are stored as 16-bit values relative to the range of their track, and
+* rotations using the "smallest three" encoding (the largest component of the
+* unit quaternion is dropped and reconstructed, the other three are stored with
+* 15 bits each). Key times are kept at full precision, since quantizing them
+* relative to the duration of a long clip introduces far more error than
+* quantizing the values.
+*
+* Every key frame takes exactly five 16-bit values (a 32-bit time followed by three
+* value components), and the key frames of all channels are stored in a single
+* contiguous block.
+*
+***********************************************/
+
+#ifndef _GTE_COMPRESSED_ANIMATION_H_
+#define _GTE_COMPRESSED_ANIMATION_H_
+
+#include <vector>
+
+#include "engine.h"
+#include "animationplayer.h"
+#include "global/global.h"
+
+namespace GTE {
+    //forward declarations
+    class KeyFrameSet;
+    class Vector3;
+    class Quaternion;
+
+    class AnimationCompressionSettings {
+    public:
+
+        // maximum distance between an original translation key frame and the reduced translation curve
+        Real TranslationTolerance;
+        // maximum angle (in radians) between an original rotation key frame and the reduced rotation curve
+        Real RotationTolerance;
+        // maximum difference between an original scale key frame and the reduced scale curve
+        Real ScaleTolerance;
+
+        AnimationCompressionSettings() {
+            TranslationTolerance = .0005f;
+            RotationTolerance = .0005f;
+            ScaleTolerance = .0005f;
+        }
+    };
+
+    class CompressedAnimation {
+        // number of 16-bit values stored for each key frame
+        static const UInt32 KeyFrameSize = 5;
+        // index of the first value component within a key frame (the time comes first)
+        static const UInt32 KeyFrameValueOffset = 2;
+        // number of tracks (one for each transformation component) per channel
+        static const UInt32 TracksPerChannel = 3;
+        // maximum number of consecutive key frames that can be replaced by a single interpolated segment
+        static const UInt32 MaxReducedSpan = 256;
+
+        class Track {
+        public:
+
+            // number of key frames in this track
+            UInt32 KeyFrameCount;
+            // index in [keyFrameData] of the first value of this track's first key frame
+            UInt32 DataOffset;
+            // minimum value of each component of the track's values (translation & scale only)
+            Real RangeMin[3];
+            // range of each component of the track's values (translation & scale only)
+            Real RangeExtent[3];
+
+            Track() {
+                KeyFrameCount = 0;
+                DataOffset = 0;
+                for (UInt32 i = 0; i < 3; i++) {
+                    RangeMin[i] = 0;
+                    RangeExtent[i] = 0;
+                }
+            }
+        };
+
+        // number of channels in the animation
+        UInt32 channelCount;
+        // one track for each transformation component of each channel
+        std::vector<Track> tracks;
+        // all of the quantized key frames of every track
+        std::vector<UInt16> keyFrameData;
+
+        const Track& GetTrack(UInt32 channel, TransformationCompnent component) const;
+        void ReduceKeyFrames(const std::vector<Real>& times, const std::vector<Real>& values, TransformationCompnent component,
+                             Real tolerance, std::vector<UInt32>& keptKeyFrames) const;
+        void AddTrack(Track& track, const std::vector<Real>& times, const std::vector<Real>& values, const std::vector<UInt32>& keptKeyFrames, TransformationCompnent component);
+
+        static Real CalculateError(const Real * a, const Real * b, TransformationCompnent component);
+        static void Interpolate(const Real * a, const Real * b, Real t, TransformationCompnent component, Real * out);
+        static UInt16 QuantizeUnit(Real value, UInt32 maxValue);
+        static void EncodeRotation(const Real * rotation, UInt16 * out);
+        static void DecodeRotation(const UInt16 * data, Real * out);
+
+    public:
+
+        CompressedAnimation();
+        ~CompressedAnimation();
+
+        Bool Init(const KeyFrameSet * keyFrameSets, UInt32 channelCount, const AnimationCompressionSettings& settings);
+
+        UInt32 GetKeyFrameCount(UInt32 channel, TransformationCompnent component) const;
+        Real GetKeyFrameTime(UInt32 channel, TransformationCompnent component, UInt32 frameIndex) const;
+        void GetVector(UInt32 channel, TransformationCompnent component, UInt32 frameIndex, Vector3& vector) const;
+        void GetRotation(UInt32 channel, UInt32 frameIndex, Quaternion& rotation) const;
+        UInt32 GetSizeInBytes() const;
+    };
+}
+
+#endif
@@ -12,6 +12,13 @@ namespace GTE {
         this->Target = target;
     }
 
+    /*
+     * Copy constructor, used by FullClone(). The new node shares the definition of [source].
+     */
+    SceneObjectSkeletonNode::SceneObjectSkeletonNode(const SceneObjectSkeletonNode& source) : SkeletonNode(source) {
+        this->Target = source.Target;
+    }
+
     /*
      * Destructor.
      */
@@ -49,17 +56,13 @@ namespace GTE {
     }
 
     /*
-     * Create a full (deep) clone of this node.
+     * Create a clone of this node. The clone has its own target, but shares this node's
+     * definition (name, bone index and initial transformation).
      */
     SkeletonNode * SceneObjectSkeletonNode::FullClone() const {
-        SkeletonNode * newNode = new(std::nothrow) SceneObjectSkeletonNode(Target, BoneIndex, Name);
+        SkeletonNode * newNode = new(std::nothrow) SceneObjectSkeletonNode(*this);
         ASSERT(newNode != nullptr, "SceneObjectSkeletonNode::FullClone -> Could not allocate new node.");
 
-        newNode->InitialTransform = this->InitialTransform;
-        newNode->InitialTranslation = this->InitialTranslation;
-        newNode->InitialScale = this->InitialScale;
-        newNode->InitialRotation = this->InitialRotation;
-
         return newNode;
     }
 }
@@ -22,6 +22,8 @@ namespace GTE {
     class Transform;
 
     class SceneObjectSkeletonNode : public SkeletonNode {
+        SceneObjectSkeletonNode(const SceneObjectSkeletonNode& source);
+
     public:
 
         // target SceneObject
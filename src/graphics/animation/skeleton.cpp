@@ -1,4 +1,5 @@
 #include "skeleton.h"
+#include "skeletondefinition.h"
 #include "skeletonnode.h"
 #include "bone.h"
 #include "vertexbonemap.h"
@@ -13,7 +14,6 @@ namespace GTE {
     */
     Skeleton::Skeleton(UInt32 boneCount) {
         this->boneCount = boneCount;
-        bones = nullptr;
     }
     /*
      * Destructor.
@@ -23,16 +23,21 @@ namespace GTE {
     }
 
     /*
-     * Destroy the skeleton. Delete all VertexBoneMap objects, all Bone objects, and
-     * all SkeletonNode objects.
+     * Destroy the skeleton. Release this skeleton's reference to its SkeletonDefinition (which is deleted
+     * along with its Bone objects once no other skeleton references it), and delete all SkeletonNode objects.
      */
     void Skeleton::Destroy() {
-        // delete all Bone objects
-        if (bones != nullptr) {
-            delete[] bones;
-            bones = nullptr;
+        definition.reset();
+
+        // instances don't have a node hierarchy of their own, only the list of nodes cloned in CreateInstance()
+        if (skeleton.GetRoot() == nullptr) {
+            for (UInt32 n = 0; n < nodeList.size(); n++) {
+                if (nodeList[n] != nullptr)delete nodeList[n];
+            }
+            nodeList.clear();
+            boneNodes.clear();
+            return;
         }
-        boneNameMap.clear();
 
         // delete all SkeletonNode objects by traversing the node hierarchy and
         // using a visitor to invoke the callback below, which performsm the delete.
@@ -46,6 +51,20 @@ namespace GTE {
 
         skeleton.Traverse();
     }
+
+    /*
+     * Make sure [definition] is not shared with any other skeleton, so that it can be modified. If it is
+     * shared, this skeleton gets its own copy.
+     */
+    void Skeleton::MakeDefinitionUnique() {
+        ASSERT(definition, "Skeleton::MakeDefinitionUnique -> Skeleton has not been initialized.");
+        if (definition.use_count() == 1)return;
+
+        SkeletonDefinition * definitionCopy = definition->Clone();
+        ASSERT(definitionCopy != nullptr, "Skeleton::MakeDefinitionUnique -> Could not copy skeleton definition.");
+
+        definition = std::shared_ptr<SkeletonDefinition>(definitionCopy);
+    }
     /*
      * Get the number of bones in this skeleton.
      */
@@ -68,10 +87,11 @@ namespace GTE {
         // destroy existing data (if there is any)
         Destroy();
 
-        bones = new(std::nothrow) Bone[boneCount];
-        ASSERT(bones != nullptr, "Skeleton::Init -> Could not allocate bone array.");
+        SkeletonDefinition * newDefinition = new(std::nothrow) SkeletonDefinition(boneCount);
+        ASSERT(newDefinition != nullptr, "Skeleton::Init -> Could not allocate skeleton definition.");
 
-        return true;
+        definition = std::shared_ptr<SkeletonDefinition>(newDefinition);
+        return definition->Init();
     }
 
     /*
@@ -80,6 +100,9 @@ namespace GTE {
      * it and does not have a target. It has no transformation associated with it.
      */
     Tree<SkeletonNode*>::TreeNode *  Skeleton::CreateRoot(SkeletonNode * node) {
+        MakeDefinitionUnique();
+        definition->hierarchyBuilt = false;
+
         if (skeleton.GetRoot() == nullptr) {
             skeleton.AddRoot(node);
         }
@@ -91,6 +114,10 @@ namespace GTE {
      */
     Tree<SkeletonNode*>::TreeNode *  Skeleton::AddChild(Tree<SkeletonNode*>::TreeNode * parent, SkeletonNode * node) {
         NONFATAL_ASSERT_RTRN(parent != nullptr, "Skeleton::AddChild -> 'parent' is null.", nullptr, true);
+
+        MakeDefinitionUnique();
+        definition->hierarchyBuilt = false;
+
         Tree<SkeletonNode*>::TreeNode * childNode = parent->AddChild(node);
 
         return childNode;
@@ -100,7 +127,8 @@ namespace GTE {
      * Set the mapping from a bone name to its index in [boneNameMap]
      */
     void Skeleton::MapBone(const std::string& name, UInt32 boneIndex) {
-        boneNameMap[name] = boneIndex;
+        MakeDefinitionUnique();
+        definition->boneNameMap[name] = boneIndex;
     }
 
     /*
@@ -108,8 +136,8 @@ namespace GTE {
      * is found, -1 is returned.
      */
     Int32 Skeleton::GetBoneMapping(const std::string& name) const {
-        std::unordered_map<std::string, UInt32>::const_iterator result = boneNameMap.find(name);
-        if (result != boneNameMap.end()) {
+        std::unordered_map<std::string, UInt32>::const_iterator result = definition->boneNameMap.find(name);
+        if (result != definition->boneNameMap.end()) {
             return (*result).second;
         }
 
@@ -117,19 +145,43 @@ namespace GTE {
     }
 
     /*
-     * Get the Bone object stored at [index] in [bones].
+     * Get the Bone object at [boneIndex] for modification. Since the bones are part of the (possibly shared)
+     * skeleton definition, this gives the skeleton its own copy of the definition if necessary. Use the const
+     * version of this method for read-only access.
      */
     Bone* Skeleton::GetBone(UInt32 boneIndex) {
         NONFATAL_ASSERT_RTRN(boneIndex < boneCount, "Skeleton::GetBone -> 'boneIndex' is out of range.", nullptr, true);
 
-        return bones + boneIndex;
+        MakeDefinitionUnique();
+        return definition->bones + boneIndex;
+    }
+
+    /*
+     * Get the Bone object at [boneIndex].
+     */
+    const Bone* Skeleton::GetBone(UInt32 boneIndex) const {
+        NONFATAL_ASSERT_RTRN(boneIndex < boneCount, "Skeleton::GetBone -> 'boneIndex' is out of range.", nullptr, true);
+
+        return definition->bones + boneIndex;
+    }
+
+    /*
+     * Get the SkeletonNode object in this skeleton that corresponds to the bone at [boneIndex]. For instances
+     * created by CreateInstance() this is the instance's own node; otherwise it is the node stored in the bone.
+     */
+    SkeletonNode * Skeleton::GetBoneNode(UInt32 boneIndex) {
+        NONFATAL_ASSERT_RTRN(boneIndex < boneCount, "Skeleton::GetBoneNode -> 'boneIndex' is out of range.", nullptr, true);
+
+        if (boneIndex < boneNodes.size())return boneNodes[boneIndex];
+        return definition->bones[boneIndex].Node;
     }
 
     /*
      * Set the mapping from a node name to its index in [nodeNameMap]
      */
     void Skeleton::MapNode(std::string& name, UInt32 nodeIndex) {
-        nodeNameMap[name] = nodeIndex;
+        MakeDefinitionUnique();
+        definition->nodeNameMap[name] = nodeIndex;
     }
 
     /*
@@ -137,8 +189,8 @@ namespace GTE {
      * is found, -1 is returned.
      */
     Int32 Skeleton::GetNodeMapping(const std::string& name) const {
-        std::unordered_map<std::string, UInt32>::const_iterator result = nodeNameMap.find(name);
-        if (result != nodeNameMap.end()) {
+        std::unordered_map<std::string, UInt32>::const_iterator result = definition->nodeNameMap.find(name);
+        if (result != definition->nodeNameMap.end()) {
             return (*result).second;
         }
 
@@ -161,9 +213,64 @@ namespace GTE {
      * Add SkeletonNode object to [nodeList].
      */
     void Skeleton::AddNodeToList(SkeletonNode * node) {
+        MakeDefinitionUnique();
+        definition->hierarchyBuilt = false;
+
         nodeList.push_back(node);
     }
 
+    /*
+     * For each node in [nodeList], store the index (in [nodeList]) of its parent in the skeleton hierarchy
+     * in the corresponding element of [parents], and its depth in the hierarchy in the corresponding
+     * element of [depths]. The root node has a depth of 0 and a parent of -1. Nodes that are not part
+     * of the hierarchy are treated the same as the root node.
+     */
+    void Skeleton::GetNodeHierarchy(std::vector<Int32>& parents, std::vector<UInt32>& depths) const {
+        if (definition->hierarchyBuilt) {
+            parents = definition->nodeParents;
+            depths = definition->nodeDepths;
+            return;
+        }
+
+        BuildNodeHierarchy(parents, depths);
+    }
+
+    /*
+     * Calculate the information returned by GetNodeHierarchy() from the node hierarchy [skeleton].
+     */
+    void Skeleton::BuildNodeHierarchy(std::vector<Int32>& parents, std::vector<UInt32>& depths) const {
+        parents.assign(nodeList.size(), -1);
+        depths.assign(nodeList.size(), 0);
+
+        Tree<SkeletonNode*>::TreeNode * root = const_cast<Tree<SkeletonNode*>&>(skeleton).GetRoot();
+        if (root == nullptr)return;
+
+        // pending tree nodes, along with the index of their parent and their depth
+        std::vector<std::pair<Tree<SkeletonNode*>::TreeNode *, std::pair<Int32, UInt32>>> pending;
+        pending.push_back(std::make_pair(root, std::make_pair(-1, (UInt32)0)));
+
+        while (pending.size() > 0) {
+            Tree<SkeletonNode*>::TreeNode * treeNode = pending.back().first;
+            Int32 parentIndex = pending.back().second.first;
+            UInt32 depth = pending.back().second.second;
+            pending.pop_back();
+
+            Int32 nodeIndex = -1;
+            if (treeNode->Data != nullptr) {
+                nodeIndex = GetNodeMapping(treeNode->Data->GetName());
+                if (nodeIndex >= 0 && (UInt32)nodeIndex < depths.size()) {
+                    parents[nodeIndex] = parentIndex;
+                    depths[nodeIndex] = depth;
+                }
+                else nodeIndex = -1;
+            }
+
+            for (UInt32 i = 0; i < treeNode->GetChildCount(); i++) {
+                pending.push_back(std::make_pair(treeNode->GetChild(i), std::make_pair(nodeIndex >= 0 ? nodeIndex : parentIndex, depth + 1)));
+            }
+        }
+    }
+
     /*
      * Replace the bones in this skeleton with matching bones from [skeleton].
      */
@@ -177,12 +284,16 @@ namespace GTE {
      */
     void Skeleton::OverrideBonesFrom(const Skeleton * skeleton, Bool takeOffset, Bool takeNode) {
         for (UInt32 n = 0; n < skeleton->GetBoneCount(); n++) {
-            Bone * newBone = const_cast<Skeleton *>(skeleton)->GetBone(n);
+            const Bone * newBone = skeleton->GetBone(n);
             for (UInt32 c = 0; c < GetBoneCount(); c++) {
                 Bone * currentBone = GetBone(c);
                 if (currentBone != nullptr && newBone != nullptr && newBone->Name == currentBone->Name) {
                     if (takeOffset)currentBone->OffsetMatrix = newBone->OffsetMatrix;
-                    if (takeNode)currentBone->Node = newBone->Node;
+                    if (takeNode) {
+                        SkeletonNode * newNode = const_cast<Skeleton *>(skeleton)->GetBoneNode(n);
+                        currentBone->Node = newNode;
+                        if (c < boneNodes.size())boneNodes[c] = newNode;
+                    }
                     break;
                 }
             }
@@ -190,146 +301,45 @@ namespace GTE {
     }
 
     /*
-     * Create a full (deep) clone of this Skeleton object.
+     * Create a new instance of this skeleton. The instance shares this skeleton's SkeletonDefinition (bones,
+     * name mappings, and hierarchy), so the only per-instance data is a clone of each SkeletonNode in
+     * [nodeList] (since each instance's nodes can have different targets) and the mapping from bones to
+     * those nodes. The clones in turn share the SkeletonNodeDefinition (name and initial transformation)
+     * of the node they were cloned from.
      */
-    Skeleton * Skeleton::FullClone() {
-        // allocate new Skeleton object
-        Skeleton * newSkeleton = new(std::nothrow) Skeleton(boneCount);
-        ASSERT(newSkeleton != nullptr, "Skeleton::FullClone -> could not allocate skeleton.");
-
-        // initialize new skeleton
-        Bool initSuccess = newSkeleton->Init();
-        if (!initSuccess) {
-            delete newSkeleton;
-            return nullptr;
-        }
+    Skeleton * Skeleton::CreateInstance() {
+        NONFATAL_ASSERT_RTRN(definition, "Skeleton::CreateInstance -> Skeleton has not been initialized.", nullptr, true);
 
-        // copy over all the bones from this skeleton
-        for (UInt32 i = 0; i < boneCount; i++) {
-            newSkeleton->GetBone(i)->SetTo(GetBone(i));
+        // the hierarchy information is shared by all instances, so calculate it once up front
+        if (!definition->hierarchyBuilt) {
+            BuildNodeHierarchy(definition->nodeParents, definition->nodeDepths);
+            definition->hierarchyBuilt = true;
         }
 
-        // copy over the bone name map
-        newSkeleton->boneNameMap = boneNameMap;
+        Skeleton * instance = new(std::nothrow) Skeleton(boneCount);
+        ASSERT(instance != nullptr, "Skeleton::CreateInstance -> Could not allocate skeleton.");
 
-        // get the TreeNode object that contains the root node of the existing skeleton
-        Tree<SkeletonNode *>::TreeNode * rootTreeNode = skeleton.GetRoot();
+        instance->definition = definition;
+        instance->nodeList.resize(nodeList.size(), nullptr);
+        instance->boneNodes.resize(boneCount, nullptr);
 
-        if (rootTreeNode != nullptr) {
-            SkeletonNode * rootClone = nullptr;
-
-            // create a clone of the root SkeletonNode
-            if (rootTreeNode->Data != nullptr) {
-                rootClone = rootTreeNode->Data->FullClone();
-                if (rootClone == nullptr) {
-                    Debug::PrintError("Skeleton::FullClone -> Could not clone root node.");
-                    delete newSkeleton;
-                    return nullptr;
-                }
-            }
+        for (UInt32 n = 0; n < nodeList.size(); n++) {
+            if (nodeList[n] == nullptr)continue;
 
-            // create new root TreeNode and set its Data to the new root SkeletonNode
-            Tree<SkeletonNode *>::TreeNode * newRoot = newSkeleton->CreateRoot(rootClone);
-            if (newRoot == nullptr) {
-                Debug::PrintError("Skeleton::FullClone -> Could not create root node.");
-                delete newSkeleton;
+            SkeletonNode * nodeClone = nodeList[n]->FullClone();
+            if (nodeClone == nullptr) {
+                Debug::PrintError("Skeleton::CreateInstance -> Could not clone skeleton node.");
+                delete instance;
                 return nullptr;
             }
 
-            // map from TreeNode objects in the existing skeleton to their counterparts in the new skeleton
-            std::unordered_map<Tree<SkeletonNode *>::TreeNode *, Tree<SkeletonNode *>::TreeNode *> newNodeMap;
-            newNodeMap[rootTreeNode] = newRoot;
-
-            Bool allocateTreeSuccess = true;
-
-            // Create a TreeNode visitor callback that will be used to visit each node in the existing skeleton in order to:
-            // (1) create a copy of that TreeNode
-            // (2) map the existing TreeNode to the corresponding TreeNode in the new skeleton.
-            // After the existing skeleton tree is traversed using this visitor callback, the tree is not fully cloned. At that
-            // point we will only have copies of the TreeNode objects in the skeleton tree, and not the SkeletonNode objects
-            // that TreeNode::Data should point to. Additionally none of those TreeNode copies will have their children or parents
-            // set yet, so there will be no hierarchy information available.
-            skeleton.SetTraversalCallback([&allocateTreeSuccess, &newNodeMap](Tree<SkeletonNode *>::TreeNode * node) -> Bool {
-                Tree<SkeletonNode *>::TreeNode * newNode = new(std::nothrow) Tree<SkeletonNode *>::TreeNode();
-                if (newNode == nullptr) {
-                    Debug::PrintError("Skeleton::FullClone -> Could not allocate new node.");
-                    allocateTreeSuccess = false;
-                    return false;
-                }
-                newNodeMap[node] = newNode;
-
-                return true;
-            });
-            skeleton.Traverse();
-
-            // make sure Tree copied successfully
-            if (!allocateTreeSuccess) {
-                Debug::PrintError("Skeleton::FullClone -> Could not allocate new nodes for skeleton clone.");
-                delete newSkeleton;
-                return nullptr;
-            }
-
-            // copy over the node name map
-            newSkeleton->nodeNameMap = nodeNameMap;
-
-            // pre-allocate nodeList space
-            newSkeleton->nodeList.resize(nodeList.size());
-
-            Bool cloneTreeSuccess = true;
-            Skeleton * thisSkeleton = this;
-
-            // Create a second TreeNode visitor callback for the existing skeleton. The purpose of this callback is to:
-            // (1) create a clone of the Data field of each TreeNode that is visited, which is the SkeletonNode object, and attach to
-            //     the corresponding cloned node in the new skeleton.
-            // (2) attach the cloned TreeNode in the new skeleton to its appropriate parent TreeNode in the new skeleton.
-            skeleton.SetTraversalCallback([&cloneTreeSuccess, &newNodeMap, newSkeleton, thisSkeleton](Tree<SkeletonNode *>::TreeNode * node) -> Bool {
-                SkeletonNode * clonedSkeletonNode = nullptr;
-                if (node != nullptr && node->Data != nullptr) {
-                    // clone the SkeletonNode
-                    clonedSkeletonNode = node->Data->FullClone();
-                    if (clonedSkeletonNode == nullptr) {
-                        Debug::PrintError("Skeleton::FullClone -> Could not clone node in skeletal tree.");
-                        cloneTreeSuccess = false;
-                        return false;
-                    }
-                }
-
-                // find the corresponding TreeNode in the new skeleton and attach the cloned SkeletonNode
-                Tree<SkeletonNode *>::TreeNode * clonedTreeNode = newNodeMap[node];
-                clonedTreeNode->Data = clonedSkeletonNode;
-
-                // enter the cloned SkeletonNode in the [nodeList] of the new Skeleton object.
-                Int32 targetListIndex = thisSkeleton->GetNodeMapping(clonedSkeletonNode->Name);
-                if (targetListIndex >= 0)newSkeleton->nodeList[targetListIndex] = clonedSkeletonNode;
-
-                // the cloned TreeNode will still have a pointer to its original parent in the existing skeleton
-                Tree<SkeletonNode *>::TreeNode * existingParent = clonedTreeNode->GetParent();
-
-                // find counterpart of existing parent in the new skeleton, and add the cloned TreeNode as a child
-                if (existingParent != nullptr) {
-                    Tree<SkeletonNode *>::TreeNode * clonedParentNode = newNodeMap[existingParent];
-                    clonedParentNode->AddChild(clonedTreeNode);
-                }
-
-                // find the Bone object in the new skeleton that corresponds to the cloned SkeletonNode,
-                // and set its SkeletonNode pointer [Node] to the clone SkeletonNode object.
-                Int32 boneIndex = node->Data->BoneIndex;
-                if (boneIndex >= 0) {
-                    newSkeleton->GetBone(boneIndex)->Node = clonedSkeletonNode;
-                }
-
-                return true;
-            });
-            skeleton.Traverse();
-
-            // check for successful clone
-            if (!cloneTreeSuccess) {
-                Debug::PrintError("Skeleton::FullClone -> Could not clone skeletal tree.");
-                delete newSkeleton;
-                return nullptr;
+            instance->nodeList[n] = nodeClone;
+            Int32 boneIndex = nodeClone->GetBoneIndex();
+            if (boneIndex >= 0 && (UInt32)boneIndex < boneCount) {
+                instance->boneNodes[boneIndex] = nodeClone;
             }
         }
 
-        return newSkeleton;
+        return instance;
     }
 }
@@ -14,6 +14,12 @@
 * from model space into bone space, and is used when performing vertex skinning. All bones have
 * a single corresponding node in the skeleton, but a node does not have to have a bone.
 *
+* The bones and everything else that is the same for every copy of a skeleton live in
+* a SkeletonDefinition, which is shared by a skeleton and all instances created from it
+* via CreateInstance(). Each instance only owns its SkeletonNode objects, which hold (or
+* point to) that instance's pose; their names and initial transformations are shared as
+* well (see SkeletonNodeDefinition).
+*
 ***********************************************/
 
 #ifndef _GTE_SKELETON_H_
@@ -21,7 +27,7 @@
 
 #include <vector>
 #include <string>
-#include <unordered_map>
+#include <memory>
 
 #include "engine.h"
 #include "object/engineobject.h"
@@ -31,6 +37,7 @@
 namespace GTE {
     //forward declarations
     class Bone;
+    class SkeletonDefinition;
     class VertexBoneMap;
     class Transform;
 
@@ -39,16 +46,13 @@ namespace GTE {
 
         // number of bones in this skeleton
         UInt32 boneCount;
-        // indexed list of all the bones in this skeleton
-        Bone * bones;
-        // map from bone name to index in [bones] for the matching Bone object
-        std::unordered_map<std::string, UInt32> boneNameMap;
-
-        // map from node name to index in [nodeList] for the mtching SkeletonNode object
-        std::unordered_map<std::string, UInt32> nodeNameMap;
+        // bones, name mappings and hierarchy shape, shared with all instances of this skeleton
+        std::shared_ptr<SkeletonDefinition> definition;
 
         // indexed list of all the nodes in this skeleton
         std::vector<SkeletonNode *> nodeList;
+        // this instance's node for each bone (only used by skeletons created via CreateInstance())
+        std::vector<SkeletonNode *> boneNodes;
 
         // contains transformation hierarchy structure
         Tree<SkeletonNode*> skeleton;
@@ -57,7 +61,9 @@ namespace GTE {
         ~Skeleton();
 
         void Destroy();
-        Skeleton * FullClone();
+        void MakeDefinitionUnique();
+        void BuildNodeHierarchy(std::vector<Int32>& parents, std::vector<UInt32>& depths) const;
+        Skeleton * CreateInstance();
 
     public:
 
@@ -71,11 +77,14 @@ namespace GTE {
         void MapBone(const std::string& name, UInt32 boneIndex);
         Int32 GetBoneMapping(const std::string& name) const;
         Bone* GetBone(UInt32 boneIndex);
+        const Bone* GetBone(UInt32 boneIndex) const;
+        SkeletonNode * GetBoneNode(UInt32 boneIndex);
 
         void MapNode(std::string& name, UInt32 nodeIndex);
         Int32 GetNodeMapping(const std::string& name) const;
         SkeletonNode * GetNodeFromList(UInt32 nodeIndex);
         void AddNodeToList(SkeletonNode * node);
+        void GetNodeHierarchy(std::vector<Int32>& parents, std::vector<UInt32>& depths) const;
 
         void OverrideBonesFrom(SkeletonConstRef skeleton, Bool takeOffset, Bool takeNode);
         void OverrideBonesFrom(const Skeleton * skeleton, Bool takeOffset, Bool takeNode);
@@ -0,0 +1,78 @@
+#include "skeletondefinition.h"
+#include "bone.h"
+#include "global/global.h"
+#include "global/assert.h"
+#include "debug/gtedebug.h"
+
+namespace GTE {
+    /*
+    * Only constructor.
+    */
+    SkeletonDefinition::SkeletonDefinition(UInt32 boneCount) {
+        this->boneCount = boneCount;
+        bones = nullptr;
+        hierarchyBuilt = false;
+    }
+
+    /*
+     * Destructor.
+     */
+    SkeletonDefinition::~SkeletonDefinition() {
+        Destroy();
+    }
+
+    /*
+     * Allocate the bone array. Returns true if initialization succeeds, false otherwise.
+     */
+    Bool SkeletonDefinition::Init() {
+        Destroy();
+
+        bones = new(std::nothrow) Bone[boneCount];
+        ASSERT(bones != nullptr, "SkeletonDefinition::Init -> Could not allocate bone array.");
+
+        return true;
+    }
+
+    /*
+     * Delete all Bone objects and clear the name mappings and hierarchy information.
+     */
+    void SkeletonDefinition::Destroy() {
+        if (bones != nullptr) {
+            delete[] bones;
+            bones = nullptr;
+        }
+
+        boneNameMap.clear();
+        nodeNameMap.clear();
+        nodeParents.clear();
+        nodeDepths.clear();
+        hierarchyBuilt = false;
+    }
+
+    /*
+     * Create a copy of this definition.
+     */
+    SkeletonDefinition * SkeletonDefinition::Clone() const {
+        SkeletonDefinition * clone = new(std::nothrow) SkeletonDefinition(boneCount);
+        ASSERT(clone != nullptr, "SkeletonDefinition::Clone -> Could not allocate skeleton definition.");
+
+        Bool initSuccess = clone->Init();
+        if (!initSuccess) {
+            Debug::PrintError("SkeletonDefinition::Clone -> Could not initialize skeleton definition.");
+            delete clone;
+            return nullptr;
+        }
+
+        for (UInt32 i = 0; i < boneCount; i++) {
+            clone->bones[i].SetTo(bones + i);
+        }
+
+        clone->boneNameMap = boneNameMap;
+        clone->nodeNameMap = nodeNameMap;
+        clone->nodeParents = nodeParents;
+        clone->nodeDepths = nodeDepths;
+        clone->hierarchyBuilt = hierarchyBuilt;
+
+        return clone;
+    }
+}
@@ -0,0 +1,64 @@
+/*********************************************
+*
+* class: SkeletonDefinition
+*
+* author: Mark Kellogg
+*
+* The parts of a Skeleton that do not change from one instance of a
+* skinned model to the next: the bones (names, IDs and offset matrices),
+* the mappings from bone and node names to their indices, and the shape
+* of the node hierarchy.
+*
+* A SkeletonDefinition is shared by a Skeleton and all of the instances
+* created from it via Skeleton::CreateInstance(), and it must not be
+* modified while it is shared. Skeleton takes care of this by copying
+* the definition before modifying it if it is shared.
+*
+***********************************************/
+
+#ifndef _GTE_SKELETON_DEFINITION_H_
+#define _GTE_SKELETON_DEFINITION_H_
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+
+#include "engine.h"
+#include "global/global.h"
+
+namespace GTE {
+    //forward declarations
+    class Bone;
+
+    class SkeletonDefinition {
+        friend class Skeleton;
+
+        // number of bones in the skeleton
+        UInt32 boneCount;
+        // indexed list of all the bones in the skeleton
+        Bone * bones;
+        // map from bone name to index in [bones] for the matching Bone object
+        std::unordered_map<std::string, UInt32> boneNameMap;
+        // map from node name to the index of the matching SkeletonNode object in the node list of a skeleton
+        std::unordered_map<std::string, UInt32> nodeNameMap;
+
+        // index of the parent of each node in the node list, or -1 for nodes without a parent
+        std::vector<Int32> nodeParents;
+        // depth of each node in the node hierarchy
+        std::vector<UInt32> nodeDepths;
+        // have [nodeParents] and [nodeDepths] been calculated?
+        Bool hierarchyBuilt;
+
+        SkeletonDefinition(UInt32 boneCount);
+
+        Bool Init();
+        void Destroy();
+        SkeletonDefinition * Clone() const;
+
+    public:
+
+        ~SkeletonDefinition();
+    };
+}
+
+#endif
@@ -10,16 +10,97 @@ namespace GTE {
     /*
     * Only constructor.
     */
-    SkeletonNode::SkeletonNode(Int32 boneIndex, const std::string& name) {
+    SkeletonNodeDefinition::SkeletonNodeDefinition(Int32 boneIndex, const std::string& name) {
         this->BoneIndex = boneIndex;
         this->Name = name;
     }
 
+    /*
+    * Constructor for a node with a new definition.
+    */
+    SkeletonNode::SkeletonNode(Int32 boneIndex, const std::string& name) {
+        SkeletonNodeDefinition * newDefinition = new(std::nothrow) SkeletonNodeDefinition(boneIndex, name);
+        ASSERT(newDefinition != nullptr, "SkeletonNode::SkeletonNode -> Could not allocate node definition.");
+
+        definition = std::shared_ptr<SkeletonNodeDefinition>(newDefinition);
+    }
+
+    /*
+     * Copy constructor, used by FullClone(). The new node shares the definition of [source].
+     */
+    SkeletonNode::SkeletonNode(const SkeletonNode& source) {
+        definition = source.definition;
+    }
+
     /*
      * Destructor.
      */
     SkeletonNode::~SkeletonNode() {
 
     }
-}
 
+    /*
+     * Make sure [definition] is not shared with any other node, so that it can be modified.
+     */
+    void SkeletonNode::MakeDefinitionUnique() {
+        if (definition.use_count() == 1)return;
+
+        SkeletonNodeDefinition * definitionCopy = new(std::nothrow) SkeletonNodeDefinition(*definition);
+        ASSERT(definitionCopy != nullptr, "SkeletonNode::MakeDefinitionUnique -> Could not copy node definition.");
+
+        definition = std::shared_ptr<SkeletonNodeDefinition>(definitionCopy);
+    }
+
+    /*
+     * Get the index of the bone that corresponds to this node, or -1 if there is none.
+     */
+    Int32 SkeletonNode::GetBoneIndex() const {
+        return definition->BoneIndex;
+    }
+
+    /*
+     * Get the name of this node.
+     */
+    const std::string& SkeletonNode::GetName() const {
+        return definition->Name;
+    }
+
+    /*
+     * Get the initial (bind pose) local transformation of this node.
+     */
+    const Matrix4x4& SkeletonNode::GetInitialTransform() const {
+        return definition->InitialTransform;
+    }
+
+    /*
+     * Get the translation component of the initial local transformation of this node.
+     */
+    const Vector3& SkeletonNode::GetInitialTranslation() const {
+        return definition->InitialTranslation;
+    }
+
+    /*
+     * Get the scale component of the initial local transformation of this node.
+     */
+    const Vector3& SkeletonNode::GetInitialScale() const {
+        return definition->InitialScale;
+    }
+
+    /*
+     * Get the rotation component of the initial local transformation of this node.
+     */
+    const Quaternion& SkeletonNode::GetInitialRotation() const {
+        return definition->InitialRotation;
+    }
+
+    /*
+     * Set the initial (bind pose) local transformation of this node to [transform], and store its
+     * translation, rotation and scale components separately.
+     */
+    void SkeletonNode::SetInitialTransform(const Matrix4x4& transform) {
+        MakeDefinitionUnique();
+
+        definition->InitialTransform = transform;
+        definition->InitialTransform.Decompose(definition->InitialTranslation, definition->InitialRotation, definition->InitialScale);
+    }
+}
@@ -11,6 +11,13 @@
 * available the Transform objects of their target: GetFullTransform() and
 * GetLocalTransform().
 *
+* The parts of a node that are the same for every instance of a skeleton
+* (its name, the index of its bone and its initial transformation) live in
+* a SkeletonNodeDefinition, which is shared by a node and all of its clones.
+* A clone therefore only adds the state that is specific to one instance,
+* such as the target of the node. Like SkeletonDefinition, the definition
+* is copied before it is modified if it is shared.
+*
 ***********************************************/
 
 #ifndef _GTE_SKELETON_NODE_H_
@@ -18,6 +25,7 @@
 
 #include <vector>
 #include <string>
+#include <memory>
 
 #include "engine.h"
 #include "geometry/matrix4x4.h"
@@ -28,13 +36,13 @@ namespace GTE {
     //forward declarations
     class Bone;
 
-    class SkeletonNode {
+    class SkeletonNodeDefinition {
     public:
 
         // the index of the corresponding bone (if there is one) in the container Skeleton object's
         // bone array.
         Int32 BoneIndex;
-        // the name of this node
+        // the name of the node
         std::string Name;
         // save the original transformations
         Matrix4x4 InitialTransform;
@@ -42,9 +50,32 @@ namespace GTE {
         Vector3 InitialScale;
         Quaternion InitialRotation;
 
+        SkeletonNodeDefinition(Int32 boneIndex, const std::string& name);
+    };
+
+    class SkeletonNode {
+        // name, bone index and initial transformation, shared with all clones of this node
+        std::shared_ptr<SkeletonNodeDefinition> definition;
+
+        void MakeDefinitionUnique();
+
+    protected:
+
+        SkeletonNode(const SkeletonNode& source);
+
+    public:
+
         SkeletonNode(Int32 boneIndex, const std::string& name);
         virtual ~SkeletonNode();
 
+        Int32 GetBoneIndex() const;
+        const std::string& GetName() const;
+        const Matrix4x4& GetInitialTransform() const;
+        const Vector3& GetInitialTranslation() const;
+        const Vector3& GetInitialScale() const;
+        const Quaternion& GetInitialRotation() const;
+        void SetInitialTransform(const Matrix4x4& transform);
+
         virtual const Transform * GetFullTransform() const = 0;
         virtual Transform * GetLocalTransform() = 0;
         virtual Bool HasTarget() const = 0;
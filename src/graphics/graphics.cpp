@@ -96,7 +96,8 @@ namespace GTE {
      * the scene, such as swapping buffers in a double buffering situation.
      */
     void Graphics::PostRender() {
-
+        lastFrameStateChanges = currentFrameStateChanges;
+        currentFrameStateChanges.Reset();
     }
 
     /*
@@ -106,6 +107,14 @@ namespace GTE {
         return currentFPS;
     }
 
+    /*
+     * Get the number of material changes, shader program changes, texture binds and draw calls
+     * made while rendering the last frame.
+     */
+    const GraphicsStateChangeCounts& Graphics::GetLastFrameStateChanges() const {
+        return lastFrameStateChanges;
+    }
+
     /*
      * Get the currently active graphics properties.
      */
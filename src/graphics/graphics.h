@@ -32,6 +32,8 @@
 #include "renderstate.h"
 #include "base/bitmask.h"
 #include "render/rendertarget.h"
+#include "render/vertexattrbuffer.h"
+#include "render/uniformbuffer.h"
 #include "render/material.h"
 #include "global/global.h"
 
@@ -50,6 +52,9 @@ namespace GTE {
     class Transform;
     class ScreenDescriptor;
     class VertexAttrBuffer;
+    class IndexBuffer;
+    class VertexArray;
+    class UniformBuffer;
     class TextureAttributes;
     class RawImage;
     class AttributeTransformer;
@@ -60,6 +65,34 @@ namespace GTE {
         InvalidRenderTarget = 1
     };
 
+    // counts of the graphics state changes and draw calls made during a single frame
+    class GraphicsStateChangeCounts {
+    public:
+
+        // number of times a different material was activated
+        UInt32 MaterialChanges;
+        // number of times the active shader program was changed
+        UInt32 ProgramChanges;
+        // number of times a texture was bound to a texture unit for a material
+        UInt32 TextureBinds;
+        // number of times a different vertex array was bound
+        UInt32 VertexArrayBinds;
+        // number of draw calls
+        UInt32 DrawCalls;
+
+        GraphicsStateChangeCounts() {
+            Reset();
+        }
+
+        void Reset() {
+            MaterialChanges = 0;
+            ProgramChanges = 0;
+            TextureBinds = 0;
+            VertexArrayBinds = 0;
+            DrawCalls = 0;
+        }
+    };
+
     class Graphics {
         // necessary to trigger life-cycle events
         friend class Engine;
@@ -85,6 +118,10 @@ namespace GTE {
         Int32 framesInFPSSpan;
         // last calculated FPS value
         Real currentFPS;
+        // state changes made so far during the current frame
+        GraphicsStateChangeCounts currentFrameStateChanges;
+        // state changes made during the last completed frame
+        GraphicsStateChangeCounts lastFrameStateChanges;
 
         Graphics();
         virtual ~Graphics();
@@ -106,8 +143,14 @@ namespace GTE {
 
         virtual Shader * CreateShader(const ShaderSource& shaderSource) = 0;
         virtual void DestroyShader(Shader * shader) = 0;
-        virtual VertexAttrBuffer * CreateVertexAttributeBuffer() = 0;
+        virtual VertexAttrBuffer * CreateVertexAttributeBuffer(VertexAttrBufferUsage usage) = 0;
         virtual void DestroyVertexAttributeBuffer(VertexAttrBuffer * buffer) = 0;
+        virtual IndexBuffer * CreateIndexBuffer() = 0;
+        virtual void DestroyIndexBuffer(IndexBuffer * buffer) = 0;
+        virtual VertexArray * CreateVertexArray() = 0;
+        virtual void DestroyVertexArray(VertexArray * vertexArray) = 0;
+        virtual UniformBuffer * CreateUniformBuffer(UniformBufferUsage usage) = 0;
+        virtual void DestroyUniformBuffer(UniformBuffer * buffer) = 0;
         virtual Texture * CreateTexture(const std::string& sourcePath, const TextureAttributes& attributes) = 0;
         virtual Texture * CreateTexture(RawImage * imageData, const TextureAttributes& attributes) = 0;
         virtual Texture * CreateTexture(UInt32 width, UInt32 height, Byte * pixelData, const TextureAttributes& attributes) = 0;
@@ -133,12 +176,19 @@ namespace GTE {
         virtual void EnterRenderMode(RenderMode renderMode) = 0;
 
         virtual void RenderTriangles(const std::vector<VertexAttrBufferBinding>& boundAttributeBuffers, UInt32 vertexCount, Bool validate) = 0;
+        virtual void RenderTriangles(const std::vector<VertexAttrBufferBinding>& boundAttributeBuffers, const IndexBuffer * indexBuffer,
+                                     UInt32 vertexCount, UInt32 indexCount, Bool validate) = 0;
+        virtual void RenderTrianglesInstanced(const std::vector<VertexAttrBufferBinding>& boundAttributeBuffers, VertexArray * vertexArray,
+                                              UInt32 vertexCount, UInt32 instanceCount, Bool validate) = 0;
+        virtual void RenderTrianglesInstanced(const std::vector<VertexAttrBufferBinding>& boundAttributeBuffers, VertexArray * vertexArray,
+                                              const IndexBuffer * indexBuffer, UInt32 vertexCount, UInt32 indexCount, UInt32 instanceCount, Bool validate) = 0;
 
     public:
 
 
 
         Real GetCurrentFPS() const;
+        const GraphicsStateChangeCounts& GetLastFrameStateChanges() const;
 
         virtual void ClearRenderBuffers(IntMask bufferMask) const = 0;
 
@@ -11,6 +11,12 @@
 #include "texture/textureattr.h"
 #include "render/vertexattrbuffer.h"
 #include "render/vertexattrbufferGL.h"
+#include "render/indexbuffer.h"
+#include "render/indexbufferGL.h"
+#include "render/vertexarray.h"
+#include "render/vertexarrayGL.h"
+#include "render/uniformbuffer.h"
+#include "render/uniformbufferGL.h"
 #include "render/submesh3Drenderer.h"
 #include "render/rendertarget.h"
 #include "render/renderbuffer.h"
@@ -55,6 +61,11 @@ namespace GTE {
         stencilBufferBits = -1;
 
         activeClipPlanes = 0;
+        for (UInt32 i = 0; i < MaxTextureUnits; i++) {
+            textureUnitBindings[i] = 0;
+        }
+        defaultVertexArrayID = 0;
+        currentVertexArrayID = 0;
 
         openGLMinorVersion = 0;
         openGLVersion = 0;
@@ -173,11 +184,10 @@ namespace GTE {
         ASSERT(defaultRenderTarget.IsValid(), "GraphicsGL::Init -> Unable to create default render target.");
         ActivateRenderTarget(defaultRenderTarget);
 
-        // For now all VBOs are contained under a single default VAO.
-        // TODO: Fix this and use VAOs properly!
-        GLuint vertex_array;
-        glGenVertexArrays(1, &vertex_array);
-        glBindVertexArray(vertex_array);
+        // attribute buffers that are not part of a VertexArray (e.g. shadow volumes) are specified
+        // on every draw call using a single default VAO
+        glGenVertexArrays(1, &defaultVertexArrayID);
+        BindDefaultVertexArray();
 
         initialized = true;
         return true;
@@ -398,10 +408,10 @@ namespace GTE {
     }
 
     /*
-     * Create an OpenGL-specific vertex attribute buffer.
+     * Create an OpenGL-specific vertex attribute buffer whose data is updated as described by [usage].
      */
-    VertexAttrBuffer * GraphicsGL::CreateVertexAttributeBuffer() {
-        return new(std::nothrow) VertexAttrBufferGL();
+    VertexAttrBuffer * GraphicsGL::CreateVertexAttributeBuffer(VertexAttrBufferUsage usage) {
+        return new(std::nothrow) VertexAttrBufferGL(usage);
     }
 
     /*
@@ -412,6 +422,51 @@ namespace GTE {
         delete buffer;
     }
 
+    /*
+     * Create an OpenGL-specific index buffer.
+     */
+    IndexBuffer * GraphicsGL::CreateIndexBuffer() {
+        return new(std::nothrow) IndexBufferGL();
+    }
+
+    /*
+     * Destroy the instance of IndexBuffer pointed to by [buffer].
+     */
+    void GraphicsGL::DestroyIndexBuffer(IndexBuffer * buffer) {
+        NONFATAL_ASSERT(buffer != nullptr, "GraphicsGL::DestroyIndexBuffer -> 'buffer' is null", true);
+        delete buffer;
+    }
+
+    /*
+     * Create an OpenGL-specific vertex array.
+     */
+    VertexArray * GraphicsGL::CreateVertexArray() {
+        return new(std::nothrow) VertexArrayGL();
+    }
+
+    /*
+     * Destroy the instance of VertexArray pointed to by [vertexArray].
+     */
+    void GraphicsGL::DestroyVertexArray(VertexArray * vertexArray) {
+        NONFATAL_ASSERT(vertexArray != nullptr, "GraphicsGL::DestroyVertexArray -> 'vertexArray' is null", true);
+        delete vertexArray;
+    }
+
+    /*
+     * Create an OpenGL-specific uniform buffer whose data is updated as described by [usage].
+     */
+    UniformBuffer * GraphicsGL::CreateUniformBuffer(UniformBufferUsage usage) {
+        return new(std::nothrow) UniformBufferGL(usage);
+    }
+
+    /*
+     * Destroy the instance of UniformBuffer pointed to by [buffer].
+     */
+    void GraphicsGL::DestroyUniformBuffer(UniformBuffer * buffer) {
+        NONFATAL_ASSERT(buffer != nullptr, "GraphicsGL::DestroyUniformBuffer -> 'buffer' is null", true);
+        delete buffer;
+    }
+
     /*
      * Create a 2D OpenGL texture and encapsulate it in a Texture object.
      *
@@ -431,6 +486,7 @@ namespace GTE {
 
         // make the new texture active
         glBindTexture(GL_TEXTURE_2D, tex);
+        ResetTextureUnitBinding(0);
 
         // set the wrap mode
         if (attributes.WrapMode == TextureWrap::Mirror) {
@@ -580,6 +636,7 @@ namespace GTE {
         ASSERT(tex > 0, "GraphicsGL::CreateCubeTexture -> unable to generate texture");
 
         glBindTexture(GL_TEXTURE_CUBE_MAP, tex);
+        ResetTextureUnitBinding(0);
 
         // assign the image data to each side of the cube texture
         glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_Z, 0, GL_RGBA, fw, fh, 0, GL_RGBA, GL_UNSIGNED_BYTE, frontPixels);
@@ -709,6 +766,12 @@ namespace GTE {
         if (glIsTexture(textureID)) {
             glDeleteTextures(1, &textureID);
         }
+
+        // OpenGL may re-use the ID of the deleted texture
+        for (UInt32 i = 0; i < MaxTextureUnits; i++) {
+            if (textureUnitBindings[i] == textureID)ResetTextureUnitBinding(i);
+        }
+
         delete texGL;
     }
 
@@ -839,6 +902,7 @@ namespace GTE {
 
             activeMaterial = material;
             material->ResetVerificationState();
+            currentFrameStateChanges.MaterialChanges++;
 
             ShaderSharedPtr shader = material->GetShader();
             NONFATAL_ASSERT(shader.IsValid(), "GraphicsGL::ActivateMaterial -> 'shader' is null.", true);
@@ -850,6 +914,7 @@ namespace GTE {
             if (oldActiveProgramID != shaderGL->GetProgramID()) {
                 // OpenGL call to activate the shader for [material]
                 glUseProgram(shaderGL->GetProgramID());
+                currentFrameStateChanges.ProgramChanges++;
             }
         }
 
@@ -1307,6 +1372,7 @@ namespace GTE {
         ASSERT(texGL != nullptr, "GraphicsGL::SetTextureData -> Texture is not a valid OpenGL texture.");
 
         const TextureAttributes attributes = texture->GetAttributes();
+        ResetTextureUnitBinding(0);
         if (attributes.IsCube) {
             glBindTexture(GL_TEXTURE_CUBE_MAP, texGL->GetTextureID());
             RawImage * imageData = texture->GetImageData((UInt32)side);
@@ -1335,6 +1401,7 @@ namespace GTE {
         const TextureAttributes attributes = texture->GetAttributes();
         if (openGLVersion >= 3 && (attributes.FilterMode == TextureFilter::TriLinear || attributes.FilterMode == TextureFilter::BiLinear)) {
             if (!attributes.IsCube) {
+                ResetTextureUnitBinding(0);
                 glBindTexture(GL_TEXTURE_2D, texGL->GetTextureID());
                 glGenerateMipmap(GL_TEXTURE_2D);
                 glBindTexture(GL_TEXTURE_2D, 0);
@@ -1371,22 +1438,237 @@ namespace GTE {
      * [validate] - Specifies whether or not to validate the shader variables that have been set prior to rendering.
      */
     void GraphicsGL::RenderTriangles(const std::vector<VertexAttrBufferBinding>& boundAttributeBuffers, UInt32 vertexCount, Bool validate) {
+        RenderTrianglesInstanced(boundAttributeBuffers, nullptr, vertexCount, 1, validate);
+    }
+
+    /*
+     * Render indexed triangles: every three consecutive entries in [indexBuffer] reference the
+     * vertices of one triangle.
+     *
+     * [boundAttributeBuffers] - Array of VertexAttrBufferBinding instances, which hold one entry per unique vertex.
+     * [indexBuffer] - Indices of the vertices that make up each triangle.
+     * [vertexCount] - Number of unique vertices in the attribute buffers.
+     * [indexCount] - Number of indices to render (three per triangle).
+     * [validate] - Specifies whether or not to validate the shader variables that have been set prior to rendering.
+     */
+    void GraphicsGL::RenderTriangles(const std::vector<VertexAttrBufferBinding>& boundAttributeBuffers, const IndexBuffer * indexBuffer,
+                                     UInt32 vertexCount, UInt32 indexCount, Bool validate) {
+        RenderTrianglesInstanced(boundAttributeBuffers, nullptr, indexBuffer, vertexCount, indexCount, 1, validate);
+    }
+
+    /*
+     * Render [instanceCount] copies of the same group of vertices with a single draw call. The shader is
+     * responsible for placing each copy, based on gl_InstanceID. An [instanceCount] of 1 results in
+     * a regular, non-instanced draw call.
+     *
+     * [boundAttributeBuffers] - Array of VertexAttrBufferBinding instances, which hold arrays of
+                                attributes (normals, positions, UV coordinates, etc.) in a format suitable for sending to the GPU.
+     * [vertexArray] - Vertex array that caches the layout of [boundAttributeBuffers] for each shader program, or null
+                       to specify the layout for this draw call only.
+     * [vertexCount] - Number of vertices being sent to the GPU.
+     * [instanceCount] - Number of copies of the vertices to render.
+     * [validate] - Specifies whether or not to validate the shader variables that have been set prior to rendering.
+     */
+    void GraphicsGL::RenderTrianglesInstanced(const std::vector<VertexAttrBufferBinding>& boundAttributeBuffers, VertexArray * vertexArray,
+                                              UInt32 vertexCount, UInt32 instanceCount, Bool validate) {
+        MaterialRef currentMaterial = GetActiveMaterial();
+        NONFATAL_ASSERT(currentMaterial.IsValid(), "GraphicsGL::RenderTrianglesInstanced -> 'currentMaterial' is null.", true);
+
+        SetupVertexArray(currentMaterial, boundAttributeBuffers, vertexArray, nullptr);
+
+        // validate the shader variables (attributes and uniforms) that have been set
+        if (validate && !currentMaterial->VerifySetVars(vertexCount))return;
+
+        currentFrameStateChanges.DrawCalls++;
+
+        // render the mesh
+        if (instanceCount > 1) {
+            glDrawArraysInstanced(GL_TRIANGLES, 0, vertexCount, instanceCount);
+        }
+        else {
+            glDrawArrays(GL_TRIANGLES, 0, vertexCount);
+        }
+    }
+
+    /*
+     * Render [instanceCount] copies of a group of indexed triangles with a single draw call.
+     *
+     * [boundAttributeBuffers] - Array of VertexAttrBufferBinding instances, which hold one entry per unique vertex.
+     * [vertexArray] - Vertex array that caches the layout of [boundAttributeBuffers] and [indexBuffer] for each shader
+                       program, or null to specify the layout for this draw call only.
+     * [indexBuffer] - Indices of the vertices that make up each triangle.
+     * [vertexCount] - Number of unique vertices in the attribute buffers.
+     * [indexCount] - Number of indices to render (three per triangle).
+     * [instanceCount] - Number of copies of the triangles to render.
+     * [validate] - Specifies whether or not to validate the shader variables that have been set prior to rendering.
+     */
+    void GraphicsGL::RenderTrianglesInstanced(const std::vector<VertexAttrBufferBinding>& boundAttributeBuffers, VertexArray * vertexArray,
+                                              const IndexBuffer * indexBuffer, UInt32 vertexCount, UInt32 indexCount, UInt32 instanceCount, Bool validate) {
+        NONFATAL_ASSERT(indexBuffer != nullptr, "GraphicsGL::RenderTrianglesInstanced -> 'indexBuffer' is null.", true);
+
         MaterialRef currentMaterial = GetActiveMaterial();
-        NONFATAL_ASSERT(currentMaterial.IsValid(), "GraphicsGL::RenderTriangles -> 'currentMaterial' is null.", true);
+        NONFATAL_ASSERT(currentMaterial.IsValid(), "GraphicsGL::RenderTrianglesInstanced -> 'currentMaterial' is null.", true);
+
+        const IndexBufferGL * indexBufferGL = dynamic_cast<const IndexBufferGL*>(indexBuffer);
+        NONFATAL_ASSERT(indexBufferGL != nullptr, "GraphicsGL::RenderTrianglesInstanced -> 'indexBuffer' is not an IndexBufferGL.", true);
+
+        // a cached VAO already has the element array buffer bound to it
+        Bool bindElementBuffer = !SetupVertexArray(currentMaterial, boundAttributeBuffers, vertexArray, indexBufferGL) && indexBufferGL->IsGPUBuffer();
 
+        // validate the shader variables (attributes and uniforms) that have been set
+        if (validate && !currentMaterial->VerifySetVars(vertexCount))return;
+
+        // when the indices live on the GPU, glDrawElements() takes an offset into the bound buffer instead of a pointer
+        const void * indices = (void*)0;
+        if (bindElementBuffer) glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBufferGL->GetGPUBufferID());
+        else if (!indexBufferGL->IsGPUBuffer()) indices = indexBufferGL->GetConstDataPtr();
+
+        currentFrameStateChanges.DrawCalls++;
+
+        // render the mesh
+        if (instanceCount > 1) {
+            glDrawElementsInstanced(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, indices, instanceCount);
+        }
+        else {
+            glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, indices);
+        }
+
+        if (bindElementBuffer) glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    }
+
+    /*
+     * Bind [texture] to texture unit [unit]. The texture bound to each unit is tracked, so binding the texture
+     * that is already bound to [unit] (e.g. for consecutive draws that share a material) does nothing. The
+     * active texture unit is restored to GL_TEXTURE0 afterwards.
+     */
+    void GraphicsGL::BindTexture(UInt32 unit, const TextureGL * texture) {
+        NONFATAL_ASSERT(texture != nullptr, "GraphicsGL::BindTexture -> 'texture' is null.", true);
+        NONFATAL_ASSERT(unit < MaxTextureUnits, "GraphicsGL::BindTexture -> 'unit' is out of range.", true);
+
+        GLuint textureID = texture->GetTextureID();
+        if (textureUnitBindings[unit] == textureID)return;
+
+        glActiveTexture(GL_TEXTURE0 + unit);
+        if (texture->GetAttributes().IsCube)glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
+        else glBindTexture(GL_TEXTURE_2D, textureID);
+        glActiveTexture(GL_TEXTURE0);
+
+        textureUnitBindings[unit] = textureID;
+        currentFrameStateChanges.TextureBinds++;
+    }
+
+    /*
+     * Forget which texture is bound to texture unit [unit], so that the next call to BindTexture() for
+     * that unit will bind its texture. Must be called whenever a texture is bound outside of BindTexture().
+     */
+    void GraphicsGL::ResetTextureUnitBinding(UInt32 unit) const {
+        if (unit < MaxTextureUnits)textureUnitBindings[unit] = 0;
+    }
+
+    /*
+     * Send each attribute buffer in [boundAttributeBuffers] to the shader of [material].
+     */
+    void GraphicsGL::SendAttributeBuffers(MaterialRef material, const std::vector<VertexAttrBufferBinding>& boundAttributeBuffers) {
         VertexAttrBufferBinding binding;
         for (UInt32 b = 0; b < boundAttributeBuffers.size(); b++) {
             binding = boundAttributeBuffers[b];
             if (binding.RegisteredAttributeID != AttributeDirectory::VarID_Invalid) {
-                currentMaterial->SendAttributeBufferToShader(binding.RegisteredAttributeID, binding.Buffer);
+                if (binding.ComponentCount > 0)material->SendAttributeBufferToShader(binding.RegisteredAttributeID, binding.Buffer, binding.ComponentCount, binding.Offset);
+                else material->SendAttributeBufferToShader(binding.RegisteredAttributeID, binding.Buffer);
             }
         }
+    }
 
-        // validate the shader variables (attributes and uniforms) that have been set
-        if (validate && !currentMaterial->VerifySetVars(vertexCount))return;
+    /*
+     * Prepare the attribute buffers in [boundAttributeBuffers] for a draw call with [material].
+     *
+     * If [vertexArray] is supplied, the VAO it holds for the shader program of [material] is bound. That VAO is only
+     * (re-)specified from [boundAttributeBuffers] and [indexBuffer] if it is new or if the source of any of its attributes
+     * has moved since it was last specified (which happens with each update of a streaming buffer), so drawing the same
+     * buffers with the same program again (e.g. once for each light) takes a single bind. Returns true in that case.
+     *
+     * Otherwise the default VAO is bound and the attribute buffers are sent to the shader, and false is returned.
+     */
+    Bool GraphicsGL::SetupVertexArray(MaterialRef material, const std::vector<VertexAttrBufferBinding>& boundAttributeBuffers,
+                                      VertexArray * vertexArray, const IndexBufferGL * indexBuffer) {
+        VertexArrayGL * vertexArrayGL = dynamic_cast<VertexArrayGL*>(vertexArray);
+        ShaderRef shader = material->GetShader();
+        ShaderGL * shaderGL = shader.IsValid() ? dynamic_cast<ShaderGL*>(shader.GetPtr()) : nullptr;
+
+        if (vertexArrayGL == nullptr || shaderGL == nullptr) {
+            BindDefaultVertexArray();
+            SendAttributeBuffers(material, boundAttributeBuffers);
+            return false;
+        }
 
-        // render the mesh
-        glDrawArrays(GL_TRIANGLES, 0, vertexCount);
+        VertexArrayGL::ProgramVertexArray& programVertexArray = vertexArrayGL->GetProgramVertexArray(shaderGL->GetProgramID());
+        BindVertexArray(programVertexArray.VertexArrayID);
+
+        std::vector<VertexArrayGL::AttributeSource>& sources = programVertexArray.AttributeSources;
+        Bool sourcesChanged = sources.size() != boundAttributeBuffers.size();
+        if (sourcesChanged)sources.resize(boundAttributeBuffers.size());
+
+        for (UInt32 b = 0; b < boundAttributeBuffers.size(); b++) {
+            const VertexAttrBufferGL * bufferGL = dynamic_cast<const VertexAttrBufferGL*>(boundAttributeBuffers[b].Buffer);
+            if (bufferGL == nullptr)continue;
+
+            VertexArrayGL::AttributeSource source;
+            if (bufferGL->IsGPUBuffer())source = VertexArrayGL::AttributeSource(bufferGL->GetGPUBufferID(), (const void *)(uintptr_t)bufferGL->GetGPUBufferOffset());
+            else source = VertexArrayGL::AttributeSource(0, bufferGL->GetConstDataPtr());
+
+            if (!(sources[b] == source)) {
+                sources[b] = source;
+                sourcesChanged = true;
+            }
+        }
+
+        if (sourcesChanged) {
+            SendAttributeBuffers(material, boundAttributeBuffers);
+        }
+        else {
+            // the attribute pointers are part of the VAO, but the material still needs to know they are set
+            for (UInt32 b = 0; b < boundAttributeBuffers.size(); b++) {
+                const VertexAttrBufferBinding& binding = boundAttributeBuffers[b];
+                if (binding.RegisteredAttributeID != AttributeDirectory::VarID_Invalid) {
+                    material->SetAttributeBufferSent(binding.RegisteredAttributeID, binding.Buffer);
+                }
+            }
+        }
+
+        GLuint elementBufferID = indexBuffer != nullptr && indexBuffer->IsGPUBuffer() ? indexBuffer->GetGPUBufferID() : 0;
+        if (programVertexArray.ElementBufferID != elementBufferID) {
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elementBufferID);
+            programVertexArray.ElementBufferID = elementBufferID;
+        }
+
+        return true;
+    }
+
+    /*
+     * Bind the VAO with OpenGL id [vertexArrayID], unless it is already bound.
+     */
+    void GraphicsGL::BindVertexArray(GLuint vertexArrayID) {
+        if (currentVertexArrayID == vertexArrayID)return;
+
+        glBindVertexArray(vertexArrayID);
+        currentVertexArrayID = vertexArrayID;
+        currentFrameStateChanges.VertexArrayBinds++;
+    }
+
+    /*
+     * Bind the VAO used for attribute buffers that are not part of a VertexArray. This must also happen before
+     * changing the element array buffer binding outside of a draw call, since that binding is part of the VAO.
+     */
+    void GraphicsGL::BindDefaultVertexArray() {
+        BindVertexArray(defaultVertexArrayID);
+    }
+
+    /*
+     * Must be called when the VAO with OpenGL id [vertexArrayID] is deleted. If it is the bound VAO, OpenGL
+     * reverts the binding to zero, and the next call to BindVertexArray() must not be skipped (the id can be reused).
+     */
+    void GraphicsGL::ResetVertexArrayBinding(GLuint vertexArrayID) {
+        if (currentVertexArrayID == vertexArrayID)currentVertexArrayID = 0;
     }
 }
 
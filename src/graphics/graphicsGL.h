@@ -36,15 +36,28 @@ namespace GTE {
     class Material;
     class Camera;
     class VertexAttrBuffer;
+    class IndexBuffer;
+    class IndexBufferGL;
+    class VertexArray;
+    class UniformBuffer;
     class TextureAttributes;
     class AttributeTransformer;
     class RenderTarget;
     class RenderTargetGL;
+    class TextureGL;
     class RawImage;
 
     class GraphicsGL : public Graphics {
         // necessary to trigger lifecycle events and manage allocation
         friend class Engine;
+        // necessary so that ShaderGL can bind textures through the texture unit cache
+        friend class ShaderGL;
+        // necessary so that vertex array objects & index buffers can keep the vertex array binding up to date
+        friend class VertexArrayGL;
+        friend class IndexBufferGL;
+
+        // number of texture units to which materials can bind textures
+        static const UInt32 MaxTextureUnits = 4;
 
         GLFWwindow* window;
 
@@ -70,6 +83,12 @@ namespace GTE {
         RenderState::FaceCulling faceCullingMode;
         // number of currently active clip planes
         UInt32 activeClipPlanes;
+        // OpenGL ID of the texture last bound to each texture unit by BindTexture(), or 0 if it is not known
+        mutable GLuint textureUnitBindings[MaxTextureUnits];
+        // OpenGL ID of the VAO used for attribute buffers that are not part of a VertexArray
+        GLuint defaultVertexArrayID;
+        // OpenGL ID of the currently bound VAO
+        GLuint currentVertexArrayID;
         // RenderTarget objects that encapsulates the OpenGL default framebuffer
         RenderTargetSharedPtr defaultRenderTarget;
         // currently bound render target;
@@ -108,11 +127,25 @@ namespace GTE {
         GLenum GetGLPixelType(TextureFormat format) const;
 
         void GetCurrentBufferBits();
+        void BindTexture(UInt32 unit, const TextureGL * texture);
+        void ResetTextureUnitBinding(UInt32 unit) const;
+        void SendAttributeBuffers(MaterialRef material, const std::vector<VertexAttrBufferBinding>& boundAttributeBuffers);
+        Bool SetupVertexArray(MaterialRef material, const std::vector<VertexAttrBufferBinding>& boundAttributeBuffers,
+                              VertexArray * vertexArray, const IndexBufferGL * indexBuffer);
+        void BindVertexArray(GLuint vertexArrayID);
+        void BindDefaultVertexArray();
+        void ResetVertexArrayBinding(GLuint vertexArrayID);
 
         Shader * CreateShader(const ShaderSource& shaderSource) override;
         void DestroyShader(Shader * shader) override;
-        VertexAttrBuffer * CreateVertexAttributeBuffer() override;
+        VertexAttrBuffer * CreateVertexAttributeBuffer(VertexAttrBufferUsage usage) override;
         void DestroyVertexAttributeBuffer(VertexAttrBuffer * buffer) override;
+        IndexBuffer * CreateIndexBuffer() override;
+        void DestroyIndexBuffer(IndexBuffer * buffer) override;
+        VertexArray * CreateVertexArray() override;
+        void DestroyVertexArray(VertexArray * vertexArray) override;
+        UniformBuffer * CreateUniformBuffer(UniformBufferUsage usage) override;
+        void DestroyUniformBuffer(UniformBuffer * buffer) override;
         Texture * CreateTexture(const std::string& sourcePath, const TextureAttributes&  attributes) override;
         Texture * CreateTexture(RawImage * imageData, const TextureAttributes&  attributes) override;
         Texture * CreateTexture(UInt32 width, UInt32 height, Byte * pixelData, const TextureAttributes&  attributes) override;
@@ -140,6 +173,12 @@ namespace GTE {
         void EnterRenderMode(RenderMode renderMode) override;
 
         void RenderTriangles(const std::vector<VertexAttrBufferBinding>& boundAttributeBuffers, UInt32 vertexCount, Bool validate) override;
+        void RenderTriangles(const std::vector<VertexAttrBufferBinding>& boundAttributeBuffers, const IndexBuffer * indexBuffer,
+                             UInt32 vertexCount, UInt32 indexCount, Bool validate) override;
+        void RenderTrianglesInstanced(const std::vector<VertexAttrBufferBinding>& boundAttributeBuffers, VertexArray * vertexArray,
+                                      UInt32 vertexCount, UInt32 instanceCount, Bool validate) override;
+        void RenderTrianglesInstanced(const std::vector<VertexAttrBufferBinding>& boundAttributeBuffers, VertexArray * vertexArray,
+                                      const IndexBuffer * indexBuffer, UInt32 vertexCount, UInt32 indexCount, UInt32 instanceCount, Bool validate) override;
 
     public:
 
@@ -1,3 +1,6 @@
+#include <unordered_map>
+#include <memory.h>
+
 #include "scene/sceneobjectcomponent.h"
 #include "scene/sceneobject.h"
 #include "submesh3D.h"
@@ -45,6 +48,10 @@ namespace GTE {
         calculateNormals = true;
         calculateTangents = true;
         calculateBoundingBox = true;
+        buildIndices = false;
+        optimizeVertexCache = false;
+        vertexCacheOptimized = false;
+        boneAttachmentKeySize = 0;
 
         customFloatAttributeBufferCount = 0;
 
@@ -411,6 +418,175 @@ namespace GTE {
         }
     }
 
+    /*
+     * Are the vertices at [a] and [b] identical in every attribute in [attributeData]? Each entry
+     * in [attributeSizes] is the number of Real values per vertex of the matching attribute.
+     */
+    Bool SubMesh3D::AreVerticesEqual(UInt32 a, UInt32 b, const std::vector<const Real*>& attributeData, const std::vector<UInt32>& attributeSizes) const {
+        for (UInt32 i = 0; i < attributeData.size(); i++) {
+            UInt32 size = attributeSizes[i];
+            if (memcmp(attributeData[i] + a * size, attributeData[i] + b * size, size * sizeof(Real)) != 0)return false;
+        }
+        return true;
+    }
+
+    /*
+     * Build [indices] and [uniqueVertexSources] by grouping together all vertices whose attributes are
+     * identical. This must run after normals and tangents are calculated, since smoothing is what
+     * makes the corners of adjacent triangles share the same normal.
+     *
+     * Face normals are not part of the comparison, otherwise corners could only be shared between triangles
+     * that lie in the same plane. The face normal of a unique vertex is therefore that of just one of the
+     * triangles that use it, and SubMesh3DRenderer does not use the index list for materials that read face normals.
+     *
+     * The bone attachments of a skinned mesh live in the vertex bone map of its renderer rather than in this
+     * sub-mesh, so they are compared through [boneAttachmentKeys] (see SetBoneAttachmentKeys()). Index building
+     * must not be enabled for skinned sub-meshes that do not supply them.
+     */
+    void SubMesh3D::BuildIndices() {
+        DestroyIndices();
+
+        std::vector<const Real*> attributeData;
+        std::vector<UInt32> attributeSizes;
+
+        if (StandardAttributes::HasAttribute(standardAttributes, StandardAttribute::Position)) {
+            attributeData.push_back(positions.GetConstDataPtr());
+            attributeSizes.push_back((UInt32)BaseVectorTraits<Point3>::VectorSize);
+        }
+        if (StandardAttributes::HasAttribute(standardAttributes, StandardAttribute::Normal)) {
+            attributeData.push_back(vertexNormals.GetConstDataPtr());
+            attributeSizes.push_back((UInt32)BaseVectorTraits<Vector3>::VectorSize);
+        }
+        if (StandardAttributes::HasAttribute(standardAttributes, StandardAttribute::Tangent)) {
+            attributeData.push_back(vertexTangents.GetConstDataPtr());
+            attributeSizes.push_back((UInt32)BaseVectorTraits<Vector3>::VectorSize);
+        }
+        if (StandardAttributes::HasAttribute(standardAttributes, StandardAttribute::VertexColor)) {
+            attributeData.push_back(colors.GetConstDataPtr());
+            attributeSizes.push_back((UInt32)BaseVectorTraits<Color4>::VectorSize);
+        }
+        if (StandardAttributes::HasAttribute(standardAttributes, StandardAttribute::UVTexture0)) {
+            attributeData.push_back(uvs0.GetConstDataPtr());
+            attributeSizes.push_back((UInt32)BaseVectorTraits<UV2>::VectorSize);
+        }
+        if (StandardAttributes::HasAttribute(standardAttributes, StandardAttribute::UVTexture1)) {
+            attributeData.push_back(uvs1.GetConstDataPtr());
+            attributeSizes.push_back((UInt32)BaseVectorTraits<UV2>::VectorSize);
+        }
+        for (UInt32 i = 0; i < customFloatAttributeBuffers.size(); i++) {
+            CustomFloatAttributeBuffer * buffer = customFloatAttributeBuffers[i];
+            attributeData.push_back(buffer->GetDataPtr());
+            attributeSizes.push_back(buffer->GetComponentCount());
+        }
+        if (boneAttachmentKeySize > 0 && boneAttachmentKeys.size() == totalVertexCount * boneAttachmentKeySize) {
+            attributeData.push_back(boneAttachmentKeys.data());
+            attributeSizes.push_back(boneAttachmentKeySize);
+        }
+
+        // maps the hash of a vertex's attributes to the unique vertices with that hash
+        std::unordered_map<UInt64, std::vector<UInt32>> uniqueVerticesByHash;
+        indices.resize(totalVertexCount);
+
+        for (UInt32 v = 0; v < totalVertexCount; v++) {
+            // FNV-1a hash of the raw attribute data of vertex [v]
+            UInt64 hash = 14695981039346656037ULL;
+            for (UInt32 i = 0; i < attributeData.size(); i++) {
+                const Byte * bytes = reinterpret_cast<const Byte*>(attributeData[i] + v * attributeSizes[i]);
+                for (UInt32 b = 0; b < attributeSizes[i] * sizeof(Real); b++) {
+                    hash = (hash ^ bytes[b]) * 1099511628211ULL;
+                }
+            }
+
+            std::vector<UInt32>& candidates = uniqueVerticesByHash[hash];
+            Int32 match = -1;
+            for (UInt32 c = 0; c < candidates.size(); c++) {
+                if (AreVerticesEqual(uniqueVertexSources[candidates[c]], v, attributeData, attributeSizes)) {
+                    match = (Int32)candidates[c];
+                    break;
+                }
+            }
+
+            if (match < 0) {
+                match = (Int32)uniqueVertexSources.size();
+                uniqueVertexSources.push_back(v);
+                candidates.push_back((UInt32)match);
+            }
+
+            indices[v] = (UInt32)match;
+        }
+    }
+
+    /*
+     * Reorder the triangles of this sub-mesh for the post-transform vertex cache and rebuild the index list,
+     * which numbers the unique vertices in the order they are first referenced by the reordered triangles.
+     * The index list must be up to date when this is called.
+     */
+    Bool SubMesh3D::OptimizeVertexCache() {
+        // a partially rendered mesh relies on the order of its triangles
+        if (renderVertexCount != totalVertexCount || !HasIndices())return false;
+
+        originalVertexCacheStatistics = VertexCacheOptimizer::CalculateStatistics(indices, GetUniqueVertexCount());
+
+        std::vector<UInt32> triangleOrder;
+        if (!VertexCacheOptimizer::OptimizeTriangleOrder(indices, GetUniqueVertexCount(), triangleOrder))return false;
+
+        std::vector<Real> scratch;
+        if (StandardAttributes::HasAttribute(standardAttributes, StandardAttribute::Position)) {
+            ReorderTriangles(positions.GetDataPtr(), BaseVectorTraits<Point3>::VectorSize, triangleOrder, scratch);
+        }
+        if (StandardAttributes::HasAttribute(standardAttributes, StandardAttribute::Normal)) {
+            ReorderTriangles(vertexNormals.GetDataPtr(), BaseVectorTraits<Vector3>::VectorSize, triangleOrder, scratch);
+            ReorderTriangles(faceNormals.GetDataPtr(), BaseVectorTraits<Vector3>::VectorSize, triangleOrder, scratch);
+        }
+        if (StandardAttributes::HasAttribute(standardAttributes, StandardAttribute::Tangent)) {
+            ReorderTriangles(vertexTangents.GetDataPtr(), BaseVectorTraits<Vector3>::VectorSize, triangleOrder, scratch);
+        }
+        if (StandardAttributes::HasAttribute(standardAttributes, StandardAttribute::VertexColor)) {
+            ReorderTriangles(colors.GetDataPtr(), BaseVectorTraits<Color4>::VectorSize, triangleOrder, scratch);
+        }
+        if (StandardAttributes::HasAttribute(standardAttributes, StandardAttribute::UVTexture0)) {
+            ReorderTriangles(uvs0.GetDataPtr(), BaseVectorTraits<UV2>::VectorSize, triangleOrder, scratch);
+        }
+        if (StandardAttributes::HasAttribute(standardAttributes, StandardAttribute::UVTexture1)) {
+            ReorderTriangles(uvs1.GetDataPtr(), BaseVectorTraits<UV2>::VectorSize, triangleOrder, scratch);
+        }
+        for (UInt32 i = 0; i < customFloatAttributeBuffers.size(); i++) {
+            CustomFloatAttributeBuffer * buffer = customFloatAttributeBuffers[i];
+            if (buffer->GetSize() == totalVertexCount)ReorderTriangles(buffer->GetDataPtr(), buffer->GetComponentCount(), triangleOrder, scratch);
+        }
+        if (boneAttachmentKeySize > 0 && boneAttachmentKeys.size() == totalVertexCount * boneAttachmentKeySize) {
+            ReorderTriangles(boneAttachmentKeys.data(), boneAttachmentKeySize, triangleOrder, scratch);
+        }
+        vertexCacheTriangleOrder = triangleOrder;
+
+        BuildIndices();
+        optimizedVertexCacheStatistics = VertexCacheOptimizer::CalculateStatistics(indices, GetUniqueVertexCount());
+        vertexCacheOptimized = true;
+
+        return true;
+    }
+
+    /*
+     * Rearrange the per-vertex values in [data] so that the triangles appear in the order given by [triangleOrder].
+     * [valuesPerVertex] is the number of Real values stored for each vertex and [scratch] is temporary storage.
+     */
+    void SubMesh3D::ReorderTriangles(Real * data, UInt32 valuesPerVertex, const std::vector<UInt32>& triangleOrder, std::vector<Real>& scratch) {
+        UInt32 triangleSize = valuesPerVertex * 3;
+        scratch.assign(data, data + triangleOrder.size() * triangleSize);
+
+        for (UInt32 t = 0; t < triangleOrder.size(); t++) {
+            memcpy(data + t * triangleSize, scratch.data() + triangleOrder[t] * triangleSize, triangleSize * sizeof(Real));
+        }
+    }
+
+    /*
+     * Clear the index list of unique vertices.
+     */
+    void SubMesh3D::DestroyIndices() {
+        indices.clear();
+        uniqueVertexSources.clear();
+    }
+
     /*
      * Calculate the bounding box for this sub-mesh.
      */
@@ -452,6 +628,7 @@ namespace GTE {
     void SubMesh3D::Destroy() {
         DestroyVertexCrossMap();
         DestroyCustomAttributeBuffers();
+        DestroyIndices();
     }
 
     /*
@@ -545,6 +722,97 @@ namespace GTE {
         calculateBoundingBox = calculate;
     }
 
+    /*
+     * Tell this mesh whether or not to build an index list of its unique vertices
+     * the next time Update() is called.
+     */
+    void SubMesh3D::SetBuildIndices(Bool build) {
+        buildIndices = build;
+        if (!build)DestroyIndices();
+    }
+
+    /*
+     * Does this mesh have an index list of unique vertices?
+     */
+    Bool SubMesh3D::HasIndices() const {
+        return buildIndices && indices.size() == totalVertexCount && totalVertexCount > 0;
+    }
+
+    /*
+     * Get the number of unique vertices in this mesh. Only meaningful if HasIndices() is true.
+     */
+    UInt32 SubMesh3D::GetUniqueVertexCount() const {
+        return (UInt32)uniqueVertexSources.size();
+    }
+
+    /*
+     * Get the index list that maps each vertex in the attribute arrays to its unique vertex.
+     */
+    const std::vector<UInt32>& SubMesh3D::GetIndices() const {
+        return indices;
+    }
+
+    /*
+     * Get the index in the attribute arrays of the vertex whose data represents each unique vertex.
+     */
+    const std::vector<UInt32>& SubMesh3D::GetUniqueVertexSources() const {
+        return uniqueVertexSources;
+    }
+
+    /*
+     * Tell this mesh whether or not to reorder its triangles for the post-transform vertex cache the first time
+     * Update() builds its index list. This requires index building to be enabled (see SetBuildIndices()). Anything
+     * else that depends on the original triangle order, such as a vertex bone map, must be rearranged to match
+     * (see GetVertexCacheTriangleOrder()).
+     */
+    void SubMesh3D::SetOptimizeVertexCache(Bool optimize) {
+        optimizeVertexCache = optimize;
+    }
+
+    /*
+     * Have the triangles of this mesh been reordered for the post-transform vertex cache?
+     */
+    Bool SubMesh3D::IsVertexCacheOptimized() const {
+        return vertexCacheOptimized;
+    }
+
+    /*
+     * Get the efficiency of the index list before its triangles were reordered. Only meaningful
+     * if IsVertexCacheOptimized() is true.
+     */
+    const VertexCacheStatistics& SubMesh3D::GetOriginalVertexCacheStatistics() const {
+        return originalVertexCacheStatistics;
+    }
+
+    /*
+     * Get the efficiency of the index list after its triangles were reordered. Only meaningful
+     * if IsVertexCacheOptimized() is true.
+     */
+    const VertexCacheStatistics& SubMesh3D::GetOptimizedVertexCacheStatistics() const {
+        return optimizedVertexCacheStatistics;
+    }
+
+    /*
+     * Get the original index of each triangle of this mesh, in the order the triangles were placed in by
+     * the post-transform vertex cache optimization. Empty if IsVertexCacheOptimized() is false.
+     */
+    const std::vector<UInt32>& SubMesh3D::GetVertexCacheTriangleOrder() const {
+        return vertexCacheTriangleOrder;
+    }
+
+    /*
+     * Set the bone attachments of each vertex: [keys] holds [valuesPerVertex] values (e.g. bone indices followed by
+     * their weights) for every vertex in the attribute arrays. They are not rendered from this sub-mesh, but the index
+     * list only merges vertices whose attachments are identical, so that skinned sub-meshes can be indexed as well.
+     * Must be called after Init() and before the index list is built.
+     */
+    void SubMesh3D::SetBoneAttachmentKeys(const std::vector<Real>& keys, UInt32 valuesPerVertex) {
+        NONFATAL_ASSERT(keys.size() == totalVertexCount * valuesPerVertex, "SubMesh3D::SetBoneAttachmentKeys -> 'keys' does not hold 'valuesPerVertex' values for each vertex.", true);
+
+        boneAttachmentKeys = keys;
+        boneAttachmentKeySize = valuesPerVertex;
+    }
+
     /*
      * Does this mesh have face data?
      */
@@ -603,6 +871,13 @@ namespace GTE {
         if (calculateBoundingBox)CalculateBoundingBox();
         if (calculateNormals)CalculateNormals((Real)normalsSmoothingThreshold);
         if (calculateTangents)CalculateTangents((Real)normalsSmoothingThreshold);
+        if (buildIndices) {
+            BuildIndices();
+            if (optimizeVertexCache && !vertexCacheOptimized && OptimizeVertexCache()) {
+                // the triangles have moved, so the vertex groups have to be rebuilt before the faces
+                if (vertexCrossMap != nullptr && !BuildVertexCrossMap())return;
+            }
+        }
         if (buildFaces)BuildFaces();
 
         UpdateUpdateCount();
@@ -610,7 +885,8 @@ namespace GTE {
 
     /*
      * Only signal this mesh as updated, do not recalculate normals or faces. Useful
-     * when only changing vertex positions;
+     * when only changing vertex positions; the existing index list (if any) is kept, so the
+     * changes must not make previously identical vertices differ.
      */
     void SubMesh3D::QuickUpdate() {
         UpdateUpdateCount();
@@ -659,6 +935,10 @@ namespace GTE {
     Bool SubMesh3D::Init(UInt32 totalVertexCount) {
         this->totalVertexCount = totalVertexCount;
         this->renderVertexCount = totalVertexCount;
+        vertexCacheOptimized = false;
+        vertexCacheTriangleOrder.clear();
+        boneAttachmentKeys.clear();
+        boneAttachmentKeySize = 0;
 
         Bool initSuccess = true;
         Int32 errorMask = 0;
@@ -6,6 +6,18 @@
  * SubMesh3D encapsulates a single mesh object and holds all of its attributes
  * (vertex positions, vertex normals, UV coordinates, etc...). It is designed
  * to be attached to a single Mesh3D object via [containerMesh].
+ *
+ * The attribute arrays always hold one entry for each corner of each triangle. If index
+ * building is enabled, Update() additionally finds the corners whose attributes (and bone
+ * attachments, see SetBoneAttachmentKeys()) are all identical and produces an index list that maps
+ * each corner to a single unique vertex, so that renderers can upload and transform every unique
+ * vertex only once. Face normals are not compared, since they differ between almost all corners of
+ * a curved surface; renderers whose materials read them draw the sub-mesh without the index list.
+ *
+ * Optionally (see SetOptimizeVertexCache()), the first time an index list is built the triangles
+ * are reordered for the post-transform vertex cache (see VertexCacheOptimizer), and the unique
+ * vertices are then numbered in the order in which they are first referenced, so vertex fetches
+ * are mostly sequential as well.
  */
 
 #ifndef _GTE_SUBMESH3D_H_
@@ -23,6 +35,7 @@
 #include "geometry/vector/vector3.h"
 #include "geometry/matrix4x4.h"
 #include "submesh3Dfaces.h"
+#include "vertexcacheoptimizer.h"
 #include "global/global.h"
 
 namespace GTE {
@@ -97,6 +110,27 @@ namespace GTE {
         Bool calculateTangents;
         // should bounding box be calculated
         Bool calculateBoundingBox;
+        // should an index list of unique vertices be built?
+        Bool buildIndices;
+
+        // for each vertex in the attribute arrays, the index of the unique vertex it maps to
+        std::vector<UInt32> indices;
+        // for each unique vertex, the index in the attribute arrays of the first vertex that maps to it
+        std::vector<UInt32> uniqueVertexSources;
+        // should the triangles be reordered for the post-transform vertex cache the first time the index list is built?
+        Bool optimizeVertexCache;
+        // have the triangles been reordered since this sub-mesh was initialized?
+        Bool vertexCacheOptimized;
+        // efficiency of the index list before the triangles were reordered
+        VertexCacheStatistics originalVertexCacheStatistics;
+        // efficiency of the index list after the triangles were reordered
+        VertexCacheStatistics optimizedVertexCacheStatistics;
+        // for each triangle, the index it had before the triangles were reordered for the post-transform vertex cache
+        std::vector<UInt32> vertexCacheTriangleOrder;
+        // bone indices and weights of each vertex, which are compared (but not rendered) when building the index list
+        std::vector<Real> boneAttachmentKeys;
+        // number of values in [boneAttachmentKeys] for each vertex
+        UInt32 boneAttachmentKeySize;
 
         SubMesh3D();
         SubMesh3D(StandardAttributeSet attributes);
@@ -115,6 +149,11 @@ namespace GTE {
         void FindAdjacentFaceIndex(UInt32 faceIndex, int& edgeA, int& edgeB, int& edgeC) const;
         Int32 FindCommonFace(UInt32 excludeFace, UInt32 vaIndex, UInt32 vbIndex) const;
         void BuildFaces();
+        void BuildIndices();
+        void DestroyIndices();
+        Bool OptimizeVertexCache();
+        void ReorderTriangles(Real * data, UInt32 valuesPerVertex, const std::vector<UInt32>& triangleOrder, std::vector<Real>& scratch);
+        Bool AreVerticesEqual(UInt32 a, UInt32 b, const std::vector<const Real*>& attributeData, const std::vector<UInt32>& attributeSizes) const;
 
         void CalculateBoundingBox();
 
@@ -135,6 +174,17 @@ namespace GTE {
         void SetBuildFaces(Bool build);
         void SetCalculateBoundingBox(Bool calculate);
         Bool HasFaces() const;
+        void SetBuildIndices(Bool build);
+        Bool HasIndices() const;
+        UInt32 GetUniqueVertexCount() const;
+        const std::vector<UInt32>& GetIndices() const;
+        const std::vector<UInt32>& GetUniqueVertexSources() const;
+        void SetOptimizeVertexCache(Bool optimize);
+        Bool IsVertexCacheOptimized() const;
+        const VertexCacheStatistics& GetOriginalVertexCacheStatistics() const;
+        const VertexCacheStatistics& GetOptimizedVertexCacheStatistics() const;
+        const std::vector<UInt32>& GetVertexCacheTriangleOrder() const;
+        void SetBoneAttachmentKeys(const std::vector<Real>& keys, UInt32 valuesPerVertex);
 
         SubMesh3DFaces& GetFaces();
 
@@ -0,0 +1,202 @@
+#include <math.h>
+
+#include "vertexcacheoptimizer.h"
+#include "global/global.h"
+#include "global/assert.h"
+#include "debug/gtedebug.h"
+
+namespace GTE {
+    /*
+     * Calculate the score of a vertex that is at [cachePosition] in the simulated LRU cache (-1 if it is
+     * not in the cache) and is used by [remainingTriangles] triangles that have not yet been added.
+     */
+    Real VertexCacheOptimizer::ScoreVertex(Int32 cachePosition, UInt32 remainingTriangles) {
+        const Real CacheDecayPower = 1.5f;
+        const Real LastTriangleScore = 0.75f;
+        const Real ValenceBoostScale = 2.0f;
+        const Real ValenceBoostPower = 0.5f;
+
+        // the vertex is not used by any remaining triangles
+        if (remainingTriangles == 0)return -1.0f;
+
+        Real score = 0;
+        if (cachePosition >= 0) {
+            // the vertices of the most recently added triangle get a fixed score, so that the next triangle
+            // does not simply re-use two of them (which produces long thin strips)
+            if (cachePosition < 3)score = LastTriangleScore;
+            else {
+                Real scaler = 1.0f / (Real)(ScoringCacheSize - 3);
+                score = 1.0f - (Real)(cachePosition - 3) * scaler;
+                score = powf(score, CacheDecayPower);
+            }
+        }
+
+        // boost vertices that are used by few remaining triangles
+        score += ValenceBoostScale * powf((Real)remainingTriangles, -ValenceBoostPower);
+        return score;
+    }
+
+    /*
+     * Determine the order in which the triangles of the index list [indices], which references [vertexCount]
+     * unique vertices, should be drawn. On return, [triangleOrder] holds the index (in [indices]) of the triangle
+     * to draw first, then the index of the triangle to draw second, and so on.
+     */
+    Bool VertexCacheOptimizer::OptimizeTriangleOrder(const std::vector<UInt32>& indices, UInt32 vertexCount, std::vector<UInt32>& triangleOrder) {
+        UInt32 triangleCount = (UInt32)indices.size() / 3;
+        triangleOrder.clear();
+        if (triangleCount == 0)return true;
+
+        for (UInt32 i = 0; i < triangleCount * 3; i++) {
+            NONFATAL_ASSERT_RTRN(indices[i] < vertexCount, "VertexCacheOptimizer::OptimizeTriangleOrder -> Index is out of range.", false, true);
+        }
+
+        // build the list of triangles that use each vertex
+        std::vector<UInt32> vertexTriangleCounts(vertexCount, 0);
+        for (UInt32 i = 0; i < triangleCount * 3; i++) {
+            vertexTriangleCounts[indices[i]]++;
+        }
+
+        std::vector<UInt32> vertexTriangleOffsets(vertexCount + 1, 0);
+        for (UInt32 v = 0; v < vertexCount; v++) {
+            vertexTriangleOffsets[v + 1] = vertexTriangleOffsets[v] + vertexTriangleCounts[v];
+        }
+
+        std::vector<UInt32> vertexTriangles(triangleCount * 3);
+        std::vector<UInt32> vertexTriangleFill(vertexTriangleOffsets.begin(), vertexTriangleOffsets.end() - 1);
+        for (UInt32 t = 0; t < triangleCount; t++) {
+            for (UInt32 c = 0; c < 3; c++) {
+                UInt32 v = indices[t * 3 + c];
+                vertexTriangles[vertexTriangleFill[v]++] = t;
+            }
+        }
+
+        // [vertexTriangleCounts] from here on holds the number of triangles that use each vertex and have not yet been added
+        std::vector<Int32> vertexCachePositions(vertexCount, -1);
+        std::vector<Real> vertexScores(vertexCount);
+        for (UInt32 v = 0; v < vertexCount; v++) {
+            vertexScores[v] = ScoreVertex(-1, vertexTriangleCounts[v]);
+        }
+
+        std::vector<Bool> triangleAdded(triangleCount, false);
+        std::vector<Real> triangleScores(triangleCount);
+        for (UInt32 t = 0; t < triangleCount; t++) {
+            triangleScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+        }
+
+        // the simulated LRU cache, with room for the three vertices of the triangle being added
+        std::vector<UInt32> cache;
+        std::vector<UInt32> newCache;
+        cache.reserve(ScoringCacheSize + 3);
+        newCache.reserve(ScoringCacheSize + 3);
+
+        triangleOrder.reserve(triangleCount);
+        // first triangle that might not yet have been added, used to find the next triangle when none in the cache are left
+        UInt32 searchStart = 0;
+        Int32 bestTriangle = -1;
+
+        while (triangleOrder.size() < triangleCount) {
+            // no candidate from the cache, so find the best scoring triangle that has not been added
+            if (bestTriangle < 0) {
+                Real bestScore = -1.0f;
+                while (searchStart < triangleCount && triangleAdded[searchStart])searchStart++;
+                for (UInt32 t = searchStart; t < triangleCount; t++) {
+                    if (!triangleAdded[t] && triangleScores[t] > bestScore) {
+                        bestScore = triangleScores[t];
+                        bestTriangle = (Int32)t;
+                    }
+                }
+            }
+
+            UInt32 triangle = (UInt32)bestTriangle;
+            triangleAdded[triangle] = true;
+            triangleOrder.push_back(triangle);
+
+            // the vertices of the added triangle move to the front of the cache, followed by the previous contents
+            newCache.clear();
+            for (UInt32 c = 0; c < 3; c++) {
+                UInt32 v = indices[triangle * 3 + c];
+                newCache.push_back(v);
+
+                // remove the added triangle from the vertex's list of remaining triangles
+                UInt32 start = vertexTriangleOffsets[v];
+                UInt32 end = start + vertexTriangleCounts[v];
+                for (UInt32 i = start; i < end; i++) {
+                    if (vertexTriangles[i] == triangle) {
+                        vertexTriangles[i] = vertexTriangles[end - 1];
+                        break;
+                    }
+                }
+                vertexTriangleCounts[v]--;
+            }
+
+            for (UInt32 i = 0; i < cache.size(); i++) {
+                UInt32 v = cache[i];
+                if (v != newCache[0] && v != newCache[1] && v != newCache[2])newCache.push_back(v);
+            }
+
+            // vertices that fall out of the cache are no longer in it
+            for (UInt32 i = ScoringCacheSize; i < newCache.size(); i++) {
+                vertexCachePositions[newCache[i]] = -1;
+                vertexScores[newCache[i]] = ScoreVertex(-1, vertexTriangleCounts[newCache[i]]);
+            }
+            if (newCache.size() > ScoringCacheSize)newCache.resize(ScoringCacheSize);
+            cache.swap(newCache);
+
+            // update the scores of the vertices in the cache
+            for (UInt32 i = 0; i < cache.size(); i++) {
+                UInt32 v = cache[i];
+                vertexCachePositions[v] = (Int32)i;
+                vertexScores[v] = ScoreVertex((Int32)i, vertexTriangleCounts[v]);
+            }
+
+            // update the scores of the remaining triangles that use the cached vertices, and pick the best of them
+            bestTriangle = -1;
+            Real bestScore = -1.0f;
+            for (UInt32 i = 0; i < cache.size(); i++) {
+                UInt32 v = cache[i];
+                UInt32 start = vertexTriangleOffsets[v];
+                UInt32 end = start + vertexTriangleCounts[v];
+                for (UInt32 j = start; j < end; j++) {
+                    UInt32 t = vertexTriangles[j];
+                    Real score = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+                    triangleScores[t] = score;
+                    if (score > bestScore) {
+                        bestScore = score;
+                        bestTriangle = (Int32)t;
+                    }
+                }
+            }
+        }
+
+        return true;
+    }
+
+    /*
+     * Calculate ACMR & ATVR for the index list [indices], which references [vertexCount] unique vertices,
+     * by simulating a FIFO post-transform vertex cache.
+     */
+    VertexCacheStatistics VertexCacheOptimizer::CalculateStatistics(const std::vector<UInt32>& indices, UInt32 vertexCount) {
+        VertexCacheStatistics statistics;
+        UInt32 triangleCount = (UInt32)indices.size() / 3;
+        if (triangleCount == 0 || vertexCount == 0)return statistics;
+
+        // the time stamp (in cache misses) at which each vertex was last added to the cache
+        std::vector<UInt32> cacheTimeStamps(vertexCount, 0);
+        UInt32 misses = 0;
+
+        for (UInt32 i = 0; i < triangleCount * 3; i++) {
+            UInt32 v = indices[i];
+            if (v >= vertexCount)continue;
+
+            // a vertex is in the cache if fewer than [MeasuringCacheSize] other vertices were added since it was
+            if (cacheTimeStamps[v] == 0 || misses - cacheTimeStamps[v] >= MeasuringCacheSize) {
+                misses++;
+                cacheTimeStamps[v] = misses;
+            }
+        }
+
+        statistics.ACMR = (Real)misses / (Real)triangleCount;
+        statistics.ATVR = (Real)misses / (Real)vertexCount;
+        return statistics;
+    }
+}
@@ -0,0 +1,59 @@
+/*
+ * class: VertexCacheOptimizer
+ *
+ * author: Mark Kellogg
+ *
+ * Reorders the triangles of an indexed mesh so that consecutive triangles reuse vertices
+ * that are still in the GPU's post-transform vertex cache, using Tom Forsyth's "Linear-Speed
+ * Vertex Cache Optimisation" algorithm. Each vertex is scored based on its position in a
+ * simulated LRU cache and on the number of triangles that still use it (so that lone
+ * vertices are cleaned up early), and the triangle with the highest total vertex score
+ * is always added next.
+ *
+ * The efficiency of an index list is measured by simulating a FIFO cache:
+ *
+ *   ACMR (average cache miss ratio) - vertex shader invocations per triangle; lower is
+ *   better, the best possible value for a large regular mesh is around 0.5.
+ *
+ *   ATVR (average transform to vertex ratio) - vertex shader invocations per unique vertex;
+ *   1.0 means every vertex is transformed exactly once.
+ */
+
+#ifndef _GTE_VERTEX_CACHE_OPTIMIZER_H_
+#define _GTE_VERTEX_CACHE_OPTIMIZER_H_
+
+#include <vector>
+
+#include "engine.h"
+
+namespace GTE {
+    class VertexCacheStatistics {
+    public:
+
+        // average number of cache misses per triangle
+        Real ACMR;
+        // average number of cache misses per unique vertex
+        Real ATVR;
+
+        VertexCacheStatistics() {
+            ACMR = 0;
+            ATVR = 0;
+        }
+    };
+
+    class VertexCacheOptimizer {
+        // size of the simulated LRU cache used to score vertices
+        static const UInt32 ScoringCacheSize = 32;
+        // size of the simulated FIFO cache used to measure ACMR & ATVR
+        static const UInt32 MeasuringCacheSize = 16;
+
+        static Real ScoreVertex(Int32 cachePosition, UInt32 remainingTriangles);
+
+    public:
+
+        static Bool OptimizeTriangleOrder(const std::vector<UInt32>& indices, UInt32 vertexCount, std::vector<UInt32>& triangleOrder);
+        static VertexCacheStatistics CalculateStatistics(const std::vector<UInt32>& indices, UInt32 vertexCount);
+    };
+}
+
+#endif
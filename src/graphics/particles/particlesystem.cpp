@@ -83,6 +83,11 @@ namespace GTE {
         attributeRotationID = AttributeDirectory::VarID_Invalid;
         attributeIndexID = AttributeDirectory::VarID_Invalid;
 
+        uniformViewAxisXID = UniformDirectory::RegisterVarID("VIEW_AXIS_X");
+        uniformViewAxisYID = UniformDirectory::RegisterVarID("VIEW_AXIS_Y");
+        uniformViewAxisZID = UniformDirectory::RegisterVarID("VIEW_AXIS_Z");
+        uniformParticleTextureID = UniformDirectory::RegisterVarID("PARTICLE_TEXTURE");
+
         atlasInitializer = DefaultUInt32Initializer.Clone();
         colorInitializer = DefaultColor4Initializer.Clone();
         alphaInitializer = DefaultRealInitializer.Clone();
@@ -264,10 +269,10 @@ namespace GTE {
 
         for (UInt32 i = 0; i < particleMaterial->GetMaterialCount(); i++) {
             MaterialRef mat = particleMaterial->GetMaterial(i);
-            mat->SetUniform3f(vectorX.x, vectorX.y, vectorX.z, "VIEW_AXIS_X");
-            mat->SetUniform3f(vectorY.x, vectorY.y, vectorY.z, "VIEW_AXIS_Y");
-            mat->SetUniform3f(vectorZ.x, vectorZ.y, vectorZ.z, "VIEW_AXIS_Z");
-            mat->SetTexture(atlas->GetTexture(), "PARTICLE_TEXTURE");
+            mat->SetUniform3f(vectorX.x, vectorX.y, vectorX.z, uniformViewAxisXID);
+            mat->SetUniform3f(vectorY.x, vectorY.y, vectorY.z, uniformViewAxisYID);
+            mat->SetUniform3f(vectorZ.x, vectorZ.y, vectorZ.z, uniformViewAxisZID);
+            mat->SetTexture(atlas->GetTexture(), uniformParticleTextureID);
         }
 
         SubMesh3DRef targetMesh = mesh->GetSubMesh(0);
@@ -275,12 +280,17 @@ namespace GTE {
 
         Real maxX, maxY, maxZ, minX, minY, minZ;
         maxX = maxY = maxZ = minX = minY = minZ = 0;
+        // largest particle dimension, used to pad the bounding box since particle quads
+        // are expanded around their positions in the shader
+        Real maxSize = 0;
 
         for (UInt32 p = 0; p < liveParticleCount; p++) {
             Particle* particle = liveParticleArray[p];
             Point3& position = particle->Position;
             Real rotation = particle->Rotation;
 
+            maxSize = GTEMath::Max(maxSize, GTEMath::Max(particle->Size.x, particle->Size.y));
+
             if (position.x > maxX || p == 0)maxX = position.x;
             if (position.x < minX || p == 0)minX = position.x;
             if (position.y > maxY || p == 0)maxY = position.y;
@@ -360,9 +370,9 @@ namespace GTE {
         center.z = depth / 2.0f + minZ;
 
         Vector3 boundingBox;
-        boundingBox.x = width / 2.0f;
-        boundingBox.y = height / 2.0f;
-        boundingBox.z = depth / 2.0f;
+        boundingBox.x = width / 2.0f + maxSize;
+        boundingBox.y = height / 2.0f + maxSize;
+        boundingBox.z = depth / 2.0f + maxSize;
 
         targetMesh->SetBoundingBox(boundingBox);
         targetMesh->SetCenter(center);
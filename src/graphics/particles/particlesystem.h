@@ -75,6 +75,12 @@ namespace GTE {
         AttributeID attributeRotationID;
         AttributeID attributeIndexID;
 
+        // uniforms that are updated every frame in UpdateShaderWithParticleData()
+        UniformID uniformViewAxisXID;
+        UniformID uniformViewAxisYID;
+        UniformID uniformViewAxisZID;
+        UniformID uniformParticleTextureID;
+
         Bool zSort;
         Bool simulateInLocalSpace;
         Bool releaseAtOnce;
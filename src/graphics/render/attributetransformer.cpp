@@ -14,6 +14,42 @@ namespace GTE {
 
     }
 
+    /*
+     * Was the transformation performed by the last call to TransformAttributes() left to the vertex shader?
+     */
+    Bool AttributeTransformer::UsesShaderTransform() const {
+        return false;
+    }
+
+    /*
+     * Get the set of static per-vertex attributes the vertex shader needs to perform the transformation.
+     */
+    StandardAttributeSet AttributeTransformer::GetShaderTransformAttributes() const {
+        return StandardAttributes::CreateAttributeSet();
+    }
+
+    /*
+     * Fill [data] with the values of [attribute] (four components per vertex) for [vertexCount] vertices.
+     */
+    Bool AttributeTransformer::GetShaderTransformAttributeData(StandardAttribute attribute, Real * data, UInt32 vertexCount) {
+        return false;
+    }
+
+    /*
+     * Send the uniforms the vertex shader needs to perform the transformation to the shader of [material].
+     */
+    void AttributeTransformer::SendShaderTransformUniforms(MaterialRef material) {
+
+    }
+
+    /*
+     * Get the bounding box (center and half-extents) of the positions produced by the transformation that the
+     * last call to TransformAttributes() left to the vertex shader. Returns false if no such bounding box is available.
+     */
+    Bool AttributeTransformer::GetShaderTransformBounds(Point3& center, Vector3& extents) const {
+        return false;
+    }
+
     void AttributeTransformer::SetActiveAttributes(StandardAttributeSet attributes) {
         activeAttributes = attributes;
     }
@@ -4,6 +4,13 @@
  * Author: Mark Kellogg
  *
  * Base class for performing modifications to mesh attribute structures.
+ *
+ * A transformer may instead leave the transformation to the vertex shader (e.g. GPU vertex skinning),
+ * in which case UsesShaderTransform() returns true after TransformAttributes() has been called and the
+ * output attribute arrays are not updated. The transformer then supplies the static per-vertex attributes
+ * and the uniforms the shader needs to perform the transformation. Since the transformed positions are then
+ * never seen on the CPU, such a transformer should also supply a bounding box for them through
+ * GetShaderTransformBounds().
  */
 
 
@@ -41,6 +48,12 @@ namespace GTE {
                                          const Point3& centerIn, Point3& centerOut,
                                          Bool transformPositions, Bool transformNormals, Bool transformTangents) = 0;
 
+        virtual Bool UsesShaderTransform() const;
+        virtual StandardAttributeSet GetShaderTransformAttributes() const;
+        virtual Bool GetShaderTransformAttributeData(StandardAttribute attribute, Real * data, UInt32 vertexCount);
+        virtual void SendShaderTransformUniforms(MaterialRef material);
+        virtual Bool GetShaderTransformBounds(Point3& center, Vector3& extents) const;
+
         void SetActiveAttributes(StandardAttributeSet attributes);
         StandardAttributeSet GetActiveAttributes() const;
 
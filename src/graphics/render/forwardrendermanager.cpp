@@ -14,6 +14,9 @@
 #include "graphics/render/submesh3Drenderer.h"
 #include "graphics/render/mesh3Drenderer.h"
 #include "graphics/render/skinnedmesh3Drenderer.h"
+#include "graphics/render/uniformbuffer.h"
+#include "graphics/animation/animationmanager.h"
+#include "graphics/animation/skeleton.h"
 #include "graphics/object/mesh3D.h"
 #include "graphics/object/mesh3Dfilter.h"
 #include "graphics/object/submesh3D.h"
@@ -30,6 +33,10 @@
 #include "global/assert.h"
 #include "global/constants.h"
 #include "debug/gtedebug.h"
+#include "util/workerpool.h"
+
+#include <algorithm>
+#include <string.h>
 
 namespace GTE {
     /*
@@ -41,6 +48,24 @@ namespace GTE {
         cameraCount = 0;
         renderableSceneObjectCount = 0;
         forwardBlending = FowardBlendingMethod::Additive;
+        renderQueueSortingEnabled = true;
+        instancingEnabled = true;
+        instanceBatchCount = 0;
+
+        for (UInt32 i = 0; i < (UInt32)StandardUniformBlock::_Last; i++) {
+            uniformBuffers[i] = nullptr;
+        }
+        memset(&viewUniformBlockData, 0, sizeof(ViewUniformBlockData));
+        memset(&lightUniformBlockData, 0, sizeof(LightUniformBlockData));
+        memset(&objectUniformBlockData, 0, sizeof(ObjectUniformBlockData));
+        memset(&clusterLightUniformBlockData, 0, sizeof(ClusterLightUniformBlockData));
+        memset(&clusterGridUniformBlockData, 0, sizeof(ClusterGridUniformBlockData));
+        memset(&clusterLightIndexUniformBlockData, 0, sizeof(ClusterLightIndexUniformBlockData));
+
+        lightClustersBuilt = false;
+        for (UInt32 i = 0; i < Constants::MaxClusteredLights; i++) {
+            clusteredLightRadii[i] = 0;
+        }
     }
 
     /*
@@ -48,6 +73,7 @@ namespace GTE {
      */
     ForwardRenderManager::~ForwardRenderManager() {
         DestroyCachedShadowVolumes();
+        DestroyUniformBuffers();
     }
 
     /*
@@ -78,6 +104,18 @@ namespace GTE {
         ASSERT(depthOnlyMaterial.IsValid(), "ForwardRenderManager::Init -> Unable to create depth only material.");
         depthOnlyMaterial->SetUseLighting(false);
 
+        // construct depth-only material for meshes that are skinned in the vertex shader
+        assetImporter.LoadBuiltInShaderSource("depthonly_skinned", shaderSource);
+        depthOnlySkinnedMaterial = objectManager->CreateMaterial("DepthOnlySkinnedMaterial", shaderSource);
+        ASSERT(depthOnlySkinnedMaterial.IsValid(), "ForwardRenderManager::Init -> Unable to create skinned depth only material.");
+        depthOnlySkinnedMaterial->SetUseLighting(false);
+
+        // construct depth-only material for batches of instances
+        assetImporter.LoadBuiltInShaderSource("depthonly_instanced", shaderSource);
+        depthOnlyInstancedMaterial = objectManager->CreateMaterial("DepthOnlyInstancedMaterial", shaderSource);
+        ASSERT(depthOnlyInstancedMaterial.IsValid(), "ForwardRenderManager::Init -> Unable to create instanced depth only material.");
+        depthOnlyInstancedMaterial->SetUseLighting(false);
+
         // construct depth-value material
         assetImporter.LoadBuiltInShaderSource("depthvalue", shaderSource);
         depthValueMaterial = objectManager->CreateMaterial("DepthValueMaterial", shaderSource);
@@ -108,9 +146,58 @@ namespace GTE {
         Bool multiLightInit = multiLightDescriptor.Init(Constants::MaxShaderLights);
         ASSERT(multiLightInit, "ForwardRenderManager::Init -> Unable to initialize multi-light descriptor.");
 
+        if (!InitUniformBuffers())return false;
+
+        Bool clusterGridInit = lightClusterGrid.Init(Constants::ClusterTileCountX, Constants::ClusterTileCountY, Constants::ClusterSliceCount, Constants::MaxClusterLightIndices);
+        ASSERT(clusterGridInit, "ForwardRenderManager::Init -> Unable to initialize light cluster grid.");
+
+        return true;
+    }
+
+    /*
+     * Create the uniform buffers for the standard uniform blocks and attach each one to the
+     * binding point of its block. The ObjectData block is rewritten for every draw call, so its buffer
+     * streams each update into the next block of a ring instead of replacing the storage that earlier
+     * draw calls may still be reading.
+     */
+    Bool ForwardRenderManager::InitUniformBuffers() {
+        Graphics * graphics = Engine::Instance()->GetGraphicsSystem();
+
+        static const UInt32 blockSizes[] = { sizeof(ViewUniformBlockData), sizeof(LightUniformBlockData), sizeof(ObjectUniformBlockData),
+                                             sizeof(ClusterLightUniformBlockData), sizeof(ClusterGridUniformBlockData), sizeof(ClusterLightIndexUniformBlockData) };
+        for (UInt32 i = 0; i < (UInt32)StandardUniformBlock::_Last; i++) {
+            UniformBufferUsage usage = i == (UInt32)StandardUniformBlock::Object ? UniformBufferUsage::Stream : UniformBufferUsage::Dynamic;
+            uniformBuffers[i] = graphics->CreateUniformBuffer(usage);
+            ASSERT(uniformBuffers[i] != nullptr, "ForwardRenderManager::InitUniformBuffers -> Unable to create uniform buffer.");
+
+            Bool initSuccess = uniformBuffers[i]->Init(blockSizes[i], i);
+            NONFATAL_ASSERT_RTRN(initSuccess, "ForwardRenderManager::InitUniformBuffers -> Unable to initialize uniform buffer.", false, true);
+        }
+
+        // upload the (zeroed) CPU-side copies, so that the buffer contents always match them
+        uniformBuffers[(UInt32)StandardUniformBlock::View]->SetData(&viewUniformBlockData);
+        uniformBuffers[(UInt32)StandardUniformBlock::Light]->SetData(&lightUniformBlockData);
+        uniformBuffers[(UInt32)StandardUniformBlock::Object]->SetData(&objectUniformBlockData);
+        uniformBuffers[(UInt32)StandardUniformBlock::ClusterLights]->SetData(&clusterLightUniformBlockData);
+        uniformBuffers[(UInt32)StandardUniformBlock::ClusterGrid]->SetData(&clusterGridUniformBlockData);
+        uniformBuffers[(UInt32)StandardUniformBlock::ClusterLightIndices]->SetData(&clusterLightIndexUniformBlockData);
+
         return true;
     }
 
+    /*
+     * Destroy the uniform buffers created by InitUniformBuffers().
+     */
+    void ForwardRenderManager::DestroyUniformBuffers() {
+        Graphics * graphics = Engine::Instance()->GetGraphicsSystem();
+        for (UInt32 i = 0; i < (UInt32)StandardUniformBlock::_Last; i++) {
+            if (uniformBuffers[i] != nullptr && graphics != nullptr) {
+                graphics->DestroyUniformBuffer(uniformBuffers[i]);
+            }
+            uniformBuffers[i] = nullptr;
+        }
+    }
+
     /*
      * Initialize the components needed to render a full screen quad.
      */
@@ -230,6 +317,46 @@ namespace GTE {
         DestroyCachedShadowVolumes();
     }
 
+    /*
+     * Get the number of render queue entries that were skipped during the last frame because
+     * their bounds were completely outside the view frustum of [camera].
+     */
+    UInt32 ForwardRenderManager::GetFrustumCulledEntryCount(CameraRef camera) const {
+        NONFATAL_ASSERT_RTRN(camera.IsValid(), "ForwardRenderManager::GetFrustumCulledEntryCount -> Camera is not valid.", 0, true);
+
+        auto itr = frustumCulledEntryCounts.find(camera->GetObjectID());
+        if (itr != frustumCulledEntryCounts.end()) {
+            return itr->second;
+        }
+
+        return 0;
+    }
+
+    /*
+     * Enable or disable sorting the entries of each render queue by render state (opaque queues) or
+     * by depth (transparent queues) before rendering each view. When disabled, entries are rendered
+     * in the order in which they were added to their queues.
+     */
+    void ForwardRenderManager::SetRenderQueueSortingEnabled(Bool enabled) {
+        renderQueueSortingEnabled = enabled;
+    }
+
+    Bool ForwardRenderManager::IsRenderQueueSortingEnabled() const {
+        return renderQueueSortingEnabled;
+    }
+
+    /*
+     * Enable or disable drawing render queue entries that share a mesh & material with instanced
+     * draw calls. When disabled, every entry is drawn individually.
+     */
+    void ForwardRenderManager::SetInstancingEnabled(Bool enabled) {
+        instancingEnabled = enabled;
+    }
+
+    Bool ForwardRenderManager::IsInstancingEnabled() const {
+        return instancingEnabled;
+    }
+
     /*
      * Render a quad-mesh that covers the entire screen and whose normal is orthogonal to the camera's
      * direction vector. The vertices of the quad will be passed to the shader it the range:
@@ -299,6 +426,7 @@ namespace GTE {
         cameraCount = 0;
         renderableSceneObjectCount = 0;
         renderQueueManager.ClearAllRenderQueues();
+        frustumCulledEntryCounts.clear();
 
         SceneObjectRef sceneRoot = Engine::Instance()->GetEngineObjectManager()->GetSceneRoot();
         ASSERT(sceneRoot.IsValid(), "ForwardRenderManager::Update -> 'sceneRoot' is null.");
@@ -307,6 +435,10 @@ namespace GTE {
         PreProcessScene(sceneRoot.GetRef(), 0);
         // perform any pre-transformations and calculations (e.g. vertex skinning)
         PreRenderScene();
+        // update the spatial hierarchy with the final bounds of each mesh
+        UpdateSceneBVH();
+        // find the meshes that are in range of each light
+        BuildLightEntryLists();
         // calculate shadow volumes
         BuildSceneShadowVolumes();
     }
@@ -400,7 +532,7 @@ namespace GTE {
 
                                     SceneObjectProcessingDescriptor& processingDesc = child->GetProcessingDescriptor();
                                     Transform * aggregateTransform = &processingDesc.AggregateTransform;
-                                    targetRenderQueue->Add(child, mesh->GetSubMesh(i).GetPtr(), meshRenderer->GetSubRenderer(i).GetPtr(), &const_cast<MaterialSharedPtr&>(mat), meshFilter.GetPtr(), aggregateTransform);
+                                    targetRenderQueue->Add(child, mesh->GetSubMesh(i).GetPtr(), meshRenderer->GetSubRenderer(i).GetPtr(), &const_cast<MaterialSharedPtr&>(mat), m, meshFilter.GetPtr(), aggregateTransform);
                                 }
                             }
                         }
@@ -417,20 +549,17 @@ namespace GTE {
      * Iterate through all (active) Renderer components in the scene all call their
      * respective PreRender() methods. This is typically where vertex skinning will
      * happen.
+     *
+     * The attribute transformations (e.g. vertex skinning) of all sub-renderers are independent of each other, so they
+     * are distributed across the engine's worker threads. The results are then uploaded serially on the calling thread.
      */
     void ForwardRenderManager::PreRenderScene() {
-        Transform model;
-        Transform modelInverse;
+        attributeTransformRenderers.clear();
 
         // loop through each mesh-containing SceneObject in [sceneMeshObjects]
         for (UInt32 s = 0; s < renderableSceneObjectCount; s++) {
             SceneObject* child = renderableSceneObjects[s];
 
-            SceneObjectProcessingDescriptor& processingDesc = child->GetProcessingDescriptor();
-            model.SetTo(processingDesc.AggregateTransform);
-            modelInverse.SetTo(model);
-            modelInverse.Invert();
-
             RendererRef baseRenderer = child->GetRenderer();
             Mesh3DRenderer * meshRenderer = dynamic_cast<SkinnedMesh3DRenderer*>(baseRenderer.GetPtr());
             if (meshRenderer == nullptr) {
@@ -441,12 +570,223 @@ namespace GTE {
                 // for each sub-renderer, call the PreRender() method
                 for (UInt32 r = 0; r < meshRenderer->GetSubRendererCount(); r++) {
                     SubMesh3DRendererRef subRenderer = meshRenderer->GetSubRenderer(r);
-                    if (subRenderer.IsValid()) {
-                        subRenderer->PreRender(model.GetConstMatrix(), modelInverse.GetConstMatrix());
+                    if (subRenderer.IsValid() && subRenderer->DoesAttributeTransform()) {
+                        attributeTransformRenderers.push_back(AttributeTransformEntry(subRenderer.GetPtr(), child));
                     }
                 }
             }
         }
+
+        auto transformAttributes = [this](UInt32 start, UInt32 end) {
+            for (UInt32 i = start; i < end; i++) {
+                AttributeTransformEntry& entry = attributeTransformRenderers[i];
+                SceneObjectProcessingDescriptor& processingDesc = entry.Container->GetProcessingDescriptor();
+                entry.Renderer->TransformAttributes(processingDesc.AggregateTransform.GetConstMatrix(), processingDesc.AggregateTransformInverse.GetConstMatrix());
+            }
+        };
+
+        UInt32 transformCount = (UInt32)attributeTransformRenderers.size();
+        WorkerPool * workerPool = Engine::Instance()->GetWorkerPool();
+        if (workerPool != nullptr)workerPool->ParallelFor(transformCount, 1, transformAttributes);
+        else transformAttributes(0, transformCount);
+
+        for (UInt32 i = 0; i < transformCount; i++) {
+            attributeTransformRenderers[i].Renderer->UpdateTransformedAttributeData();
+        }
+    }
+
+    /*
+     * If [renderer] renders a skinned mesh whose animation player has sampling suspended, calculate local-space bounds
+     * for it that remain valid while the player's animations advance without being sampled: the union of the bounds of
+     * the last evaluated pose and the bind-pose bounds of the mesh, grown by the animation manager's off-screen bounds
+     * padding. Otherwise the pose-based bounds would keep a character that animates into view culled, and therefore
+     * suspended. On input [center] holds the center of the bounds of the last evaluated pose; on return [center] and
+     * [extents] hold the conservative bounds. Returns false (leaving [center] unchanged) if the bounds of [renderer]
+     * do not need to be changed.
+     */
+    Bool ForwardRenderManager::GetSuspendedSkinnedBounds(SubMesh3DRenderer * renderer, AnimationManager * animationManager, Point3& center, Vector3& extents) {
+        if (!renderer->DoesAttributeTransform())return false;
+
+        SkinnedMesh3DRenderer * skinnedRenderer = dynamic_cast<SkinnedMesh3DRenderer*>(renderer->containerRenderer);
+        if (skinnedRenderer == nullptr)return false;
+
+        SkeletonRef skeleton = skinnedRenderer->GetSkeleton();
+        if (!skeleton.IsValid() || !animationManager->IsSamplingSuspended(skeleton->GetObjectID()))return false;
+
+        SubMesh3DRef mesh = skinnedRenderer->GetSubMesh(renderer->targetSubMeshIndex);
+        if (!mesh.IsValid())return false;
+
+        const Vector3 * poseExtents = renderer->GetFinalBoundingBox();
+        const Point3& bindCenter = mesh->GetCenter();
+        const Vector3& bindExtents = mesh->GetBoundingBox();
+
+        Real padding = 1 + animationManager->GetOffScreenBoundsPadding();
+        Real * centerData = center.GetDataPtr();
+        Real * extentsData = extents.GetDataPtr();
+        for (UInt32 i = 0; i < 3; i++) {
+            Real poseExtent = poseExtents->GetConstDataPtr()[i];
+            Real bindExtent = bindExtents.GetConstDataPtr()[i];
+            Real minimum = GTEMath::Min(centerData[i] - poseExtent, bindCenter.GetConstDataPtr()[i] - bindExtent);
+            Real maximum = GTEMath::Max(centerData[i] + poseExtent, bindCenter.GetConstDataPtr()[i] + bindExtent);
+
+            centerData[i] = (minimum + maximum) * 0.5f;
+            extentsData[i] = (maximum - minimum) * 0.5f * padding;
+        }
+
+        return true;
+    }
+
+    /*
+     * Calculate the world-space bounds of the mesh in each render queue entry and store them in [sceneBVH]. This
+     * must happen after PreRenderScene() so that the bounds of meshes with transformed vertex positions (e.g. skinned meshes)
+     * are current. Each entry is also assigned its position in the overall render order.
+     *
+     * If the animation manager skips players whose skeletons are off-screen, the pose of a suspended player is
+     * frozen, so the bounds of the meshes it skins are made conservative by GetSuspendedSkinnedBounds().
+     */
+    void ForwardRenderManager::UpdateSceneBVH() {
+        UInt32 sequenceIndex = 0;
+
+        AnimationManager * animationManager = Engine::Instance()->GetAnimationManager();
+        Bool checkSuspendedPlayers = animationManager != nullptr && animationManager->GetSkipOffScreenPlayers();
+
+        sceneBVH.BeginUpdate();
+        for (RenderQueueManager::ConstIterator itr = renderQueueManager.Begin(); itr != renderQueueManager.End(); ++itr) {
+            RenderQueueEntry* entry = *itr;
+            entry->SequenceIndex = sequenceIndex;
+            sequenceIndex++;
+
+            SubMesh3DRenderer * renderer = entry->Renderer;
+            SceneObject * sceneObject = entry->Container;
+            if (renderer == nullptr || sceneObject == nullptr)continue;
+
+            const Matrix4x4& worldMatrix = sceneObject->GetProcessingDescriptor().AggregateTransform.GetConstMatrix();
+            const Real * m = worldMatrix.GetConstDataPtr();
+
+            Point3 center = *renderer->GetFinalBoundingBoxCenter();
+            const Vector3 * localExtents = renderer->GetFinalBoundingBox();
+
+            Vector3 suspendedExtents;
+            if (checkSuspendedPlayers && GetSuspendedSkinnedBounds(renderer, animationManager, center, suspendedExtents)) {
+                localExtents = &suspendedExtents;
+            }
+
+            worldMatrix.Transform(center);
+
+            // the extents of the world-space axis-aligned box that encloses the transformed box
+            Real extents[3];
+            extents[0] = GTEMath::Abs(m[0]) * localExtents->x + GTEMath::Abs(m[4]) * localExtents->y + GTEMath::Abs(m[8]) * localExtents->z;
+            extents[1] = GTEMath::Abs(m[1]) * localExtents->x + GTEMath::Abs(m[5]) * localExtents->y + GTEMath::Abs(m[9]) * localExtents->z;
+            extents[2] = GTEMath::Abs(m[2]) * localExtents->x + GTEMath::Abs(m[6]) * localExtents->y + GTEMath::Abs(m[10]) * localExtents->z;
+
+            // key on the material slot rather than the material itself, since a multi-material can contain the same
+            // material more than once and each of those entries needs its own leaf
+            ObjectPairKey key(renderer->GetObjectID(), entry->MaterialIndex);
+            sceneBVH.UpdateLeaf(key, entry, center.GetConstDataPtr(), extents);
+        }
+        sceneBVH.EndUpdate();
+    }
+
+    /*
+     * For each light in [sceneLights] that has a limited range, query [sceneBVH] for the render queue entries whose
+     * bounds intersect the region the light can reach: the sphere formed by the range of a point light, or for a
+     * planar light the slab around its plane (bounded by intensity / attenuation) intersected with the cylinder
+     * formed by its radial range. The resulting lists are sorted in render order and are used by all lighting
+     * passes in place of testing every mesh against every light.
+     *
+     * Spot lights are deliberately excluded: they are not supported by the built-in lighting functions and have
+     * never been culled by range (see ShouldCullByBoundingBox()), since a custom spot light shader is free to
+     * interpret the light's range differently. They keep affecting every entry, as do directional and ambient lights.
+     */
+    void ForwardRenderManager::BuildLightEntryLists() {
+        lightEntryListIndices.clear();
+
+        for (UInt32 l = 0; l < lightCount; l++) {
+            std::vector<RenderQueueEntry*>& entries = lightEntries[l];
+            entries.clear();
+
+            SceneObject* lightObject = sceneLights[l];
+            if (lightObject == nullptr)continue;
+
+            LightRef lightRef = lightObject->GetLight();
+            if (!lightRef.IsValid())continue;
+            if (lightRef->GetType() != LightType::Point && lightRef->GetType() != LightType::Planar)continue;
+
+            Point3 lightWorldPosition;
+            lightObject->GetProcessingDescriptor().AggregateTransform.TransformPoint(lightWorldPosition);
+            const Real * lightPos = lightWorldPosition.GetConstDataPtr();
+
+            Real range = lightRef->GetRange();
+            Real rangeSquared = range * range;
+
+            auto addEntry = [&entries](RenderQueueEntry* const& entry) {
+                entries.push_back(entry);
+            };
+
+            if (lightRef->GetType() == LightType::Point) {
+                sceneBVH.Query([lightPos, rangeSquared](const SceneBVH::Bounds& bounds) {
+                    // find the squared distance from the light to the closest point in [bounds]
+                    Real distanceSquared = 0.0f;
+                    for (UInt32 i = 0; i < 3; i++) {
+                        if (lightPos[i] < bounds.Min[i]) distanceSquared += (bounds.Min[i] - lightPos[i]) * (bounds.Min[i] - lightPos[i]);
+                        else if (lightPos[i] > bounds.Max[i]) distanceSquared += (lightPos[i] - bounds.Max[i]) * (lightPos[i] - bounds.Max[i]);
+                    }
+                    return distanceSquared <= rangeSquared;
+                }, addEntry);
+            }
+            else {
+                // same light-space interpretation as ShouldCullByBoundingBox(): the direction is the plane's
+                // normal, the distance from the plane is limited by intensity / attenuation and the distance
+                // from the light's position within the plane by the light's range
+                Vector3 normal = lightRef->GetDirection();
+                normal.Normalize();
+                Real attenuation = lightRef->GetAttenuation();
+                Real planarRange = attenuation > 0.0f ? lightRef->GetIntensity() / attenuation : -1.0f;
+                Real nx = normal.x, ny = normal.y, nz = normal.z;
+
+                sceneBVH.Query([lightPos, nx, ny, nz, planarRange, range](const SceneBVH::Bounds& bounds) {
+                    Real toCenter[3], extents[3];
+                    for (UInt32 i = 0; i < 3; i++) {
+                        toCenter[i] = (bounds.Min[i] + bounds.Max[i]) * 0.5f - lightPos[i];
+                        extents[i] = (bounds.Max[i] - bounds.Min[i]) * 0.5f;
+                    }
+
+                    // distance of the box's center from the light's plane, and the box's half-size along the normal
+                    Real parallel = toCenter[0] * nx + toCenter[1] * ny + toCenter[2] * nz;
+                    if (planarRange >= 0.0f) {
+                        Real projectedExtent = GTEMath::Abs(nx) * extents[0] + GTEMath::Abs(ny) * extents[1] + GTEMath::Abs(nz) * extents[2];
+                        if (GTEMath::Abs(parallel) > planarRange + projectedExtent)return false;
+                    }
+
+                    // distance of the box's center from the light's position within the plane, compared against
+                    // the radial range grown by the radius of the box's bounding sphere
+                    Real lengthSquared = toCenter[0] * toCenter[0] + toCenter[1] * toCenter[1] + toCenter[2] * toCenter[2];
+                    Real radialSquared = lengthSquared - parallel * parallel;
+                    Real boxRadius = GTEMath::SquareRoot(extents[0] * extents[0] + extents[1] * extents[1] + extents[2] * extents[2]);
+                    Real reach = range + boxRadius;
+                    return radialSquared <= reach * reach;
+                }, addEntry);
+            }
+
+            std::sort(entries.begin(), entries.end(), [](const RenderQueueEntry* a, const RenderQueueEntry* b) {
+                return a->SequenceIndex < b->SequenceIndex;
+            });
+
+            lightEntryListIndices[lightRef->GetObjectID()] = l;
+        }
+    }
+
+    /*
+     * Get the list of render queue entries that are in range of [light], as found by BuildLightEntryLists(). Returns
+     * nullptr if [light] does not have such a list, which means it can potentially affect any entry.
+     */
+    const std::vector<RenderQueueEntry*>* ForwardRenderManager::GetEntriesAffectedByLight(const Light& light) const {
+        auto itr = lightEntryListIndices.find(light.GetObjectID());
+        if (itr != lightEntryListIndices.end()) {
+            return &lightEntries[itr->second];
+        }
+
+        return nullptr;
     }
 
     /*
@@ -495,6 +835,15 @@ namespace GTE {
         descriptor.LightingEnabled = camera.IsLightingEnabled();
         descriptor.DepthPassEnabled = camera.IsDepthPassEnabled();
 
+        // build the view frustum in world space (before scene objects are transformed by [UniformWorldSceneObjectTransform])
+        // so that it can be tested directly against the bounds stored in [sceneBVH]
+        descriptor.FrustumCullingEnabled = camera.IsFrustumCullingEnabled();
+        Transform viewProjection;
+        viewProjection.SetTo(descriptor.UniformWorldSceneObjectTransform);
+        viewProjection.PreTransformBy(descriptor.ViewTransformInverse);
+        viewProjection.PreTransformBy(descriptor.ProjectionTransform);
+        descriptor.ViewFrustum.Build(viewProjection.GetConstMatrix());
+
         descriptor.SSAOEnabled = camera.IsSSAOEnabled();
         descriptor.SSAOMode = camera.GetSSAORenderMode();
 
@@ -540,6 +889,7 @@ namespace GTE {
         PushRenderTarget(cameraRenderTarget);
 
         SetCurrentCamera(cameraRef);
+        frustumCulledEntryCounts[camera.GetObjectID()] = 0;
 
         ViewDescriptor viewDescriptor;
         // get a reference to the engine's graphics system
@@ -571,11 +921,13 @@ namespace GTE {
                 altViewTransform.SetTo(cameraTransform);
                 altViewTransform.Rotate(orientations[i][0], orientations[i][1], orientations[i][2], orientations[i][3], true);
                 GetViewDescriptorForCamera(camera, nullptr, viewDescriptor);
+                frustumCulledEntryCounts[camera.GetObjectID()] += CullRenderQueueEntriesByFrustum(viewDescriptor);
                 RenderSceneForCurrentRenderTarget(viewDescriptor);
             }
         }
         else {
             GetViewDescriptorForCamera(camera, nullptr, viewDescriptor);
+            frustumCulledEntryCounts[camera.GetObjectID()] += CullRenderQueueEntriesByFrustum(viewDescriptor);
             RenderSceneForCurrentRenderTarget(viewDescriptor);
         }
 
@@ -605,6 +957,196 @@ namespace GTE {
         }
     }
 
+    /*
+     * Assign each render queue entry a sort key for the view described by [viewDescriptor] and sort the
+     * render queues by those keys, so that every pass in RenderSceneForLight() and RenderSceneSinglePass()
+     * visits the entries in the sorted order. Since that order can differ from one view to the next, the
+     * entries are re-numbered and the per-light entry lists (which are kept in render order) are re-sorted.
+     */
+    void ForwardRenderManager::SortRenderQueues(const ViewDescriptor& viewDescriptor) {
+        if (!renderQueueSortingEnabled)return;
+
+        sortKeyProgramValues.clear();
+        sortKeyTextureSetValues.clear();
+        sortKeyMaterialValues.clear();
+
+        for (RenderQueueManager::ConstIterator itr = renderQueueManager.Begin(); itr != renderQueueManager.End(); ++itr) {
+            RenderQueueEntry* entry = *itr;
+            entry->SortKey = BuildSortKey(*entry, viewDescriptor);
+        }
+
+        renderQueueManager.SortAllRenderQueues();
+
+        UInt32 sequenceIndex = 0;
+        for (RenderQueueManager::ConstIterator itr = renderQueueManager.Begin(); itr != renderQueueManager.End(); ++itr) {
+            RenderQueueEntry* entry = *itr;
+            entry->SequenceIndex = sequenceIndex;
+            sequenceIndex++;
+        }
+
+        for (UInt32 l = 0; l < lightCount; l++) {
+            std::vector<RenderQueueEntry*>& entries = lightEntries[l];
+            std::sort(entries.begin(), entries.end(), [](const RenderQueueEntry* a, const RenderQueueEntry* b) {
+                return a->SequenceIndex < b->SequenceIndex;
+            });
+        }
+    }
+
+    /*
+     * Build the 64-bit sort key for [entry]. From the most significant bits to the least, the key for an entry
+     * in an opaque queue is made up of:
+     *
+     *   queue ID | shader program | texture set | material | depth
+     *
+     * so that entries that share a shader program are drawn together, then (within those) entries that share
+     * textures, then entries that share a material, and finally front-to-back to make the most of early depth
+     * rejection. The texture set comes before the material because a material owns its textures, so several
+     * materials can share the same set but not the other way around.
+     *
+     * For entries in transparent queues (render queue >= RenderQueueType::Transparent) correct blending matters
+     * more than state changes, so the key is:
+     *
+     *   queue ID | inverted depth | shader program | texture set | material
+     *
+     * which draws them back-to-front.
+     *
+     * The shader program, texture set and material fields hold compact values that are assigned in order of first
+     * appearance during the current sort, rather than the (potentially much larger) object IDs. The depth field holds
+     * the upper bits of the IEEE-754 representation of the view-space depth of the center of the entry's bounding box,
+     * which preserves the order of non-negative values.
+     */
+    UInt64 ForwardRenderManager::BuildSortKey(const RenderQueueEntry& entry, const ViewDescriptor& viewDescriptor) {
+        static const UInt32 materialShift = SortKeyDepthBits;
+        static const UInt32 textureSetShift = materialShift + SortKeyMaterialBits;
+        static const UInt32 programShift = textureSetShift + SortKeyTextureSetBits;
+        static const UInt32 queueShift = programShift + SortKeyProgramBits;
+
+        MaterialRef material = *entry.RenderMaterial;
+        NONFATAL_ASSERT_RTRN(material.IsValid(), "ForwardRenderManager::BuildSortKey -> Render queue entry has invalid material.", 0, true);
+
+        UInt64 queue = GTEMath::Min(material->GetRenderQueue(), (UInt32)((1 << SortKeyQueueBits) - 1));
+
+        ShaderRef shader = material->GetShader();
+        UInt64 program = shader.IsValid() ? GetSortKeyValue(sortKeyProgramValues, shader->GetObjectID()) : 0;
+        program &= (1 << SortKeyProgramBits) - 1;
+
+        UInt64 textureSetKey = material->GetTextureSetKey();
+        std::unordered_map<UInt64, UInt32>::iterator textureSetItr = sortKeyTextureSetValues.find(textureSetKey);
+        UInt64 textureSet;
+        if (textureSetItr == sortKeyTextureSetValues.end()) {
+            textureSet = (UInt32)sortKeyTextureSetValues.size();
+            sortKeyTextureSetValues[textureSetKey] = (UInt32)textureSet;
+        }
+        else textureSet = textureSetItr->second;
+        textureSet &= (1 << SortKeyTextureSetBits) - 1;
+
+        UInt64 materialValue = GetSortKeyValue(sortKeyMaterialValues, material->GetObjectID());
+        materialValue &= (1 << SortKeyMaterialBits) - 1;
+
+        // find the view-space depth of the center of the entry's bounding box
+        UInt64 depth = 0;
+        if (entry.Renderer != nullptr && entry.Container != nullptr) {
+            Transform modelView;
+            modelView.SetTo(entry.Container->GetProcessingDescriptor().AggregateTransform);
+            modelView.PreTransformBy(viewDescriptor.UniformWorldSceneObjectTransform);
+            modelView.PreTransformBy(viewDescriptor.ViewTransformInverse);
+
+            Point3 center = *entry.Renderer->GetFinalBoundingBoxCenter();
+            modelView.TransformPoint(center);
+
+            // the camera looks down the negative z-axis in view space
+            Real viewDepth = -center.z;
+            float depthValue = viewDepth > 0 ? (float)viewDepth : 0.0f;
+            UInt32 depthBits;
+            memcpy(&depthBits, &depthValue, sizeof(UInt32));
+            depth = depthBits >> (32 - SortKeyDepthBits);
+        }
+
+        if (material->GetRenderQueue() >= (UInt32)RenderQueueType::Transparent) {
+            UInt64 invertedDepth = ((1 << SortKeyDepthBits) - 1) - depth;
+            return (queue << queueShift) |
+                   (invertedDepth << (queueShift - SortKeyDepthBits)) |
+                   (program << (SortKeyMaterialBits + SortKeyTextureSetBits)) |
+                   (textureSet << SortKeyMaterialBits) |
+                   materialValue;
+        }
+
+        return (queue << queueShift) | (program << programShift) | (textureSet << textureSetShift) | (materialValue << materialShift) | depth;
+    }
+
+    /*
+     * Get the compact sort key value for [id] in [values], assigning it the next available value
+     * if it has not been encountered yet.
+     */
+    UInt32 ForwardRenderManager::GetSortKeyValue(std::unordered_map<ObjectID, UInt32>& values, ObjectID id) {
+        std::unordered_map<ObjectID, UInt32>::iterator itr = values.find(id);
+        if (itr != values.end())return itr->second;
+
+        UInt32 value = (UInt32)values.size();
+        values[id] = value;
+        return value;
+    }
+
+    /*
+    * Test the bounds of the mesh in each render queue entry against the frustum of the view described by
+    * [viewDescriptor] and flag the entries that lie completely outside of it. Flagged entries are skipped by
+    * all rendering passes for that view, except for the shadow volume pass since meshes that are out of view
+    * can still cast shadows on visible geometry. Returns the number of entries that were culled.
+    *
+    * Every entry starts out flagged, and only the entries found by querying [sceneBVH] with the frustum
+    * are un-flagged, so entries in parts of the scene that lie outside the frustum are never tested individually.
+    */
+    UInt32 ForwardRenderManager::CullRenderQueueEntriesByFrustum(const ViewDescriptor& viewDescriptor) {
+        UInt32 culledCount = 0;
+
+        for (RenderQueueManager::ConstIterator itr = renderQueueManager.Begin(); itr != renderQueueManager.End(); ++itr) {
+            RenderQueueEntry* entry = *itr;
+            entry->FrustumCulled = viewDescriptor.FrustumCullingEnabled;
+            if (entry->FrustumCulled)culledCount++;
+        }
+
+        if (!viewDescriptor.FrustumCullingEnabled) {
+            MarkVisibleSkeletons();
+            return 0;
+        }
+
+        const Frustum& frustum = viewDescriptor.ViewFrustum;
+        sceneBVH.Query([&frustum](const SceneBVH::Bounds& bounds) {
+            Point3 center(bounds.GetCenter(0), bounds.GetCenter(1), bounds.GetCenter(2));
+            Vector3 extents(bounds.Max[0] - center.x, bounds.Max[1] - center.y, bounds.Max[2] - center.z);
+            return frustum.IntersectsBox(center, extents);
+        }, [&culledCount](RenderQueueEntry* const& entry) {
+            if (entry->FrustumCulled) {
+                entry->FrustumCulled = false;
+                culledCount--;
+            }
+        });
+
+        MarkVisibleSkeletons();
+
+        return culledCount;
+    }
+
+    /*
+     * Let the animation manager know which skeletons are used by skinned meshes that were not culled
+     * from the current view, so that it can skip sampling the animations of those that are off-screen.
+     */
+    void ForwardRenderManager::MarkVisibleSkeletons() {
+        AnimationManager * animationManager = Engine::Instance()->GetAnimationManager();
+        if (animationManager == nullptr || !animationManager->GetSkipOffScreenPlayers())return;
+
+        for (RenderQueueManager::ConstIterator itr = renderQueueManager.Begin(); itr != renderQueueManager.End(); ++itr) {
+            RenderQueueEntry* entry = *itr;
+            if (entry->FrustumCulled || entry->Renderer == nullptr || !entry->Renderer->DoesAttributeTransform())continue;
+
+            SkinnedMesh3DRenderer * skinnedRenderer = dynamic_cast<SkinnedMesh3DRenderer*>(entry->Renderer->containerRenderer);
+            if (skinnedRenderer == nullptr)continue;
+
+            SkeletonRef skeleton = skinnedRenderer->GetSkeleton();
+            if (skeleton.IsValid())animationManager->MarkSkeletonVisible(skeleton->GetObjectID());
+        }
+    }
+
     /*
      * Render all the meshes in the scene using forward rendering. The camera's inverted transform, which is
      * stored in [viewDescriptor] as "ViewTransformInverse", is used as the view transform. The reason the inverse
@@ -626,6 +1168,15 @@ namespace GTE {
         // clear 'rendered' status for each scene object
         ClearRenderedStatus();
 
+        // order the entries of each render queue for this view
+        SortRenderQueues(viewDescriptor);
+
+        // fill the uniform block shared by all shaders for this view
+        UpdateViewUniformBlock(viewDescriptor);
+
+        // the light clusters are built the first time a clustered lighting shader is used in this view
+        lightClustersBuilt = false;
+
         // clear the appropriate render buffers
         ClearRenderBuffers(viewDescriptor.ClearBufferMask);
 
@@ -894,8 +1445,14 @@ namespace GTE {
         singleLightDescriptor.Enabled[0] = true;
         singleLightDescriptor.UseLighting = true;
 
+        // fill the uniform block shared by all shaders for this light
+        UpdateLightUniformBlock(singleLightDescriptor);
+
         RenderMode currentRenderMode = RenderMode::None;
 
+        // if [light] has a list of entries that are in range, only those entries need to be considered
+        const std::vector<RenderQueueEntry*>* lightEntryList = GetEntriesAffectedByLight(light);
+
         enum RenderPass {
             ShadowVolumeRender = 0,
             StandardRender = 1,
@@ -921,8 +1478,7 @@ namespace GTE {
                 minQueue = maxQueue = queueID;
             }
 
-            for (RenderQueueManager::ConstIterator itr = renderQueueManager.Begin(minQueue, maxQueue); itr != renderQueueManager.End(); ++itr) {
-                RenderQueueEntry* entry = *itr;
+            auto renderEntryForLight = [&](RenderQueueEntry* entry) {
                 NONFATAL_ASSERT(entry != nullptr, "ForwardRenderManager::RenderSceneForLight -> Null render queue entry encountered.", true);
 
                 MaterialRef entryMaterial = *entry->RenderMaterial;
@@ -942,14 +1498,14 @@ namespace GTE {
                     // the current camera, whose culling mask is in [viewDescriptor].
                     if (!ShouldCullByLayer(viewDescriptor.CullingMask, *sceneObject) &&
                         !ShouldCullFromLightByLayer(light, *sceneObject) &&
-                        !ShouldCullFromLightByPosition(light, lightWorldPosition, *entry->Mesh, sceneObjectWorldTransform)) {
+                        (lightEntryList != nullptr || !ShouldCullFromLightByPosition(light, lightWorldPosition, *entry->Mesh, sceneObjectWorldTransform))) {
                         if (pass == ShadowVolumeRender) // shadow volume pass
                         {
                             if (filter->GetCastShadows()) {
                                 RenderShadowVolumeForMesh(*entry, light, lightWorldPosition, lightDirection, viewDescriptor);
                             }
                         }
-                        else if (pass == StandardRender) // normal rendering pass
+                        else if (pass == StandardRender && !entry->FrustumCulled) // normal rendering pass
                         {
                             // check if this light can cast shadows and the mesh can receive shadows, if not do standard (shadow-less) rendering
                             if (light.GetShadowsEnabled() && light.GetType() != LightType::Ambient && filter->GetReceiveShadows()) {
@@ -969,18 +1525,38 @@ namespace GTE {
                                 processingDesc.WillRenderCalled = true;
                             }
 
-                            RenderMesh(*entry, singleLightDescriptor, viewDescriptor, NullMaterialRef, true, FowardBlendingFilter::OnlyIfRendered);
+                            if (!QueueInstancedMesh(*entry, currentRenderMode, singleLightDescriptor, viewDescriptor, NullMaterialRef, true, FowardBlendingFilter::OnlyIfRendered)) {
+                                RenderMesh(*entry, singleLightDescriptor, viewDescriptor, NullMaterialRef, true, FowardBlendingFilter::OnlyIfRendered);
+                            }
                         }
                     }
                 }
+            };
+
+            if (lightEntryList != nullptr) {
+                // [lightEntryList] is in render order, so entries only need to be filtered by render queue
+                for (RenderQueueEntry* entry : *lightEntryList) {
+                    UInt32 entryQueue = (*entry->RenderMaterial)->GetRenderQueue();
+                    if (entryQueue < minQueue || entryQueue > maxQueue)continue;
+                    renderEntryForLight(entry);
+                }
             }
+            else {
+                for (RenderQueueManager::ConstIterator itr = renderQueueManager.Begin(minQueue, maxQueue); itr != renderQueueManager.End(); ++itr) {
+                    renderEntryForLight(*itr);
+                }
+            }
+
+            // draw the entries that were batched during the standard pass
+            RenderInstanceBatches(singleLightDescriptor, viewDescriptor, NullMaterialRef, true, FowardBlendingFilter::OnlyIfRendered);
         }
     }
 
     /*
     * Forward-Render the scene for all lights from the perspective specified in [viewDescriptor]. This is a
     * special-case function that will render a mesh for all lights in a single pass. The shader attached to
-    * the material that will be used to render the mesh must support multiple light uniforms (in array form).
+    * the material that will be used to render the mesh must support multiple light uniforms (in array form),
+    * or be a clustered lighting shader (see BuildLightClusters()), which has no limit on the number of lights.
     *
     * Shadows are not supported by this function, so all meshes rendered in this manner will not cast nor
     * receive shadows.
@@ -1006,12 +1582,15 @@ namespace GTE {
 
             Bool rendered = renderedSubRenderers[subRenderer->GetObjectID()];
 
-            if (entryMaterial->UseLighting() && entryMaterial->GetSinglePassMode() == singlePassMode && !rendered) {
+            if (entryMaterial->UseLighting() && entryMaterial->GetSinglePassMode() == singlePassMode && !rendered && !entry->FrustumCulled) {
                 SceneObject* sceneObject = entry->Container;
                 NONFATAL_ASSERT(sceneObject != nullptr, "ForwardRenderManager::RenderSceneForLight -> Null scene object encountered.", true);
 
-                // set up lighting descriptor for multiple lights
-                BuildMultiLightDescriptor();
+                // set up lighting descriptor for multiple lights; clustered lighting shaders
+                // get their lights from the light cluster grid instead
+                Bool clustered = entryMaterial->UsesUniformBlock(StandardUniformBlock::ClusterLights);
+                if (clustered)multiLightDescriptor.UseLighting = true;
+                else BuildMultiLightDescriptor();
 
                 // copy the full world transform of the scene object, including those of all ancestors
                 SceneObjectProcessingDescriptor& processingDesc = sceneObject->GetProcessingDescriptor();
@@ -1020,10 +1599,10 @@ namespace GTE {
                 sceneObjectWorldTransform.PreTransformBy(viewDescriptor.UniformWorldSceneObjectTransform);
 
                 if (!ShouldCullByLayer(viewDescriptor.CullingMask, *sceneObject)) {
-                    for (UInt32 l = 0; l < multiLightDescriptor.LightCount; l++) {
+                    for (UInt32 l = 0; !clustered && l < multiLightDescriptor.LightCount; l++) {
                         Light& light = *multiLightDescriptor.LightObjects[l];
                         Bool shouldCull = ShouldCullFromLightByLayer(light, *sceneObject) ||
-                            ShouldCullFromLightByPosition(light, multiLightDescriptor.Positions[l], *entry->Mesh, sceneObjectWorldTransform);
+                            ShouldCullFromLightByPosition(light, multiLightDescriptor.Positions[l], *entry, sceneObjectWorldTransform);
                         if (shouldCull)multiLightDescriptor.Enabled[l] = 0;
                     }
 
@@ -1137,6 +1716,9 @@ namespace GTE {
             SubMesh3DRenderer * subRenderer = entry->Renderer;
             NONFATAL_ASSERT(subRenderer != nullptr, "ForwardRenderManager::RenderSceneWithoutLight -> Null sub renderer encountered.", true);
 
+            // skip meshes that are not in view
+            if (entry->FrustumCulled)continue;
+
             Bool rendered = renderedSubRenderers[subRenderer->GetObjectID()];
             if (rendered && !renderMoreThanOnce)continue;
 
@@ -1164,8 +1746,12 @@ namespace GTE {
                 processingDescriptor.WillRenderCalled = true;
             }
 
-            RenderMesh(*entry, singleLightDescriptor, viewDescriptor, material, flagRendered, blendingFilter);
+            if (!QueueInstancedMesh(*entry, RenderMode::Standard, singleLightDescriptor, viewDescriptor, material, flagRendered, blendingFilter)) {
+                RenderMesh(*entry, singleLightDescriptor, viewDescriptor, material, flagRendered, blendingFilter);
+            }
         }
+
+        RenderInstanceBatches(singleLightDescriptor, viewDescriptor, material, flagRendered, blendingFilter);
     }
 
     /*
@@ -1194,7 +1780,9 @@ namespace GTE {
 
         // if we have an override material, we use that for every mesh
         Bool doMaterialOvverride = materialOverride.IsValid() ? true : false;
-        MaterialRef currentMaterial = doMaterialOvverride ? materialOverride : *entry.RenderMaterial;
+        // meshes that are skinned in the vertex shader need a depth-only shader that does the same
+        Bool useSkinnedDepthOnly = doMaterialOvverride && materialOverride == depthOnlyMaterial && renderer->UsesShaderTransform();
+        MaterialRef currentMaterial = useSkinnedDepthOnly ? depthOnlySkinnedMaterial : (doMaterialOvverride ? materialOverride : *entry.RenderMaterial);
 
         NONFATAL_ASSERT(currentMaterial != nullptr, "ForwardRenderManager::RenderMesh -> Null material encountered.", true);
 
@@ -1218,13 +1806,17 @@ namespace GTE {
 
         // send light data to the active shader (if it needs it)
         if (lightingDescriptor.UseLighting) {
-            if (currentMaterial->GetSinglePassMode() != SinglePassMode::None) {
+            if (currentMaterial->UsesUniformBlock(StandardUniformBlock::ClusterLights)) {
+                // clustered lighting shaders read every light in the view from the light cluster uniform buffers
+                BuildLightClusters(viewDescriptor);
+            }
+            else if (currentMaterial->GetSinglePassMode() != SinglePassMode::None) {
                 currentMaterial->SendLightsToShader(lightingDescriptor.PositionDatas, lightingDescriptor.DirectionDatas, lightingDescriptor.Types,
                                                     lightingDescriptor.ColorDatas, lightingDescriptor.Intensities, lightingDescriptor.Ranges,
                                                     lightingDescriptor.Attenuations, lightingDescriptor.ParallelAngleAttenuations,
                                                     lightingDescriptor.OrthoAngleAttenuations, lightingDescriptor.Enabled, lightingDescriptor.LightCount);
             }
-            else {
+            else if (!currentMaterial->UsesUniformBlock(StandardUniformBlock::Light)) {
                 currentMaterial->SendLightToShader(*lightingDescriptor.LightObjects[0], lightingDescriptor.Positions[0], &lightingDescriptor.Directions[0]);
             }
         }
@@ -1232,37 +1824,231 @@ namespace GTE {
         // pass relevant transforms to shader
         SendTransformUniformsToShader(model, modelView, viewDescriptor.ViewTransformInverse, viewDescriptor.ProjectionTransform, modelViewProjection);
 
+        // pass any uniforms required by an attribute transformation that takes place in the vertex shader
+        renderer->SendShaderTransformUniforms(currentMaterial);
+
+        // instanced shaders read the model transform from INSTANCE_TRANSFORMS, so a single draw is one instance
+        if (currentMaterial->SupportsInstancing()) {
+            StoreInstanceTransform(model, instanceTransforms);
+            currentMaterial->SendInstanceTransformsToShader(instanceTransforms, 1);
+        }
+
         // send view attributes to the active shader
         SendViewAttributesToShader(viewDescriptor);
 
-        // apply additive or subtractive blending ONLY if the material has not specified its own blending mode
-        if (currentMaterial->GetBlendingMode() == RenderState::BlendingMode::None) {
-            // determine if this mesh has been rendered using [renderer] before
-            Bool rendered = renderedSubRenderers[renderer->GetObjectID()];
-
-            // if this sub mesh has already been rendered by this camera, then we want to use
-            // additive blending to combine it with the output from other lights. Otherwise
-            // turn off blending and render.
-            if ((rendered && blendingFilter == FowardBlendingFilter::OnlyIfRendered) || (blendingFilter == FowardBlendingFilter::Always)) {
-                if (GetForwardBlending() == FowardBlendingMethod::Subtractive) {
-                    Engine::Instance()->GetGraphicsSystem()->SetBlendingEnabled(true);
-                    Engine::Instance()->GetGraphicsSystem()->SetBlendingFunction(RenderState::BlendingMethod::Zero, RenderState::BlendingMethod::SrcAlpha);
+        // determine if this mesh has been rendered using [renderer] before
+        Bool rendered = renderedSubRenderers[renderer->GetObjectID()];
+        ApplyForwardBlending(currentMaterial, rendered, blendingFilter);
+
+        // render the current mesh
+        renderer->Render();
+
+        // flag the current mesh & renderer combo as being rendered (at least once)
+        if (flagRendered) renderedSubRenderers[renderer->GetObjectID()] = true;
+    }
+
+    /*
+     * Forward-Render the meshes attached to the [instanceCount] entries in [entries] with a single instanced
+     * draw call. All of the entries must share the same mesh, material and rendered status (see QueueInstancedMesh()),
+     * so the vertex buffers of the first entry's sub-renderer are used for every instance.
+     *
+     * The remaining parameters are the same as those of RenderMesh().
+     */
+    void ForwardRenderManager::RenderMeshInstances(RenderQueueEntry * const * entries, UInt32 instanceCount, const LightingDescriptor& lightingDescriptor,
+                                                   const ViewDescriptor& viewDescriptor, MaterialRef materialOverride, Bool flagRendered, FowardBlendingFilter blendingFilter) {
+        NONFATAL_ASSERT(entries != nullptr, "ForwardRenderManager::RenderMeshInstances -> 'entries' is null.", true);
+        NONFATAL_ASSERT(instanceCount <= MaxInstancesPerBatch, "ForwardRenderManager::RenderMeshInstances -> Too many instances.", true);
+
+        SubMesh3DRenderer* renderer = entries[0]->Renderer;
+        NONFATAL_ASSERT(renderer != nullptr, "ForwardRenderManager::RenderMeshInstances -> Null sub renderer encountered.", true);
+
+        // the depth-only override is the only override that can be instanced
+        MaterialRef currentMaterial = materialOverride.IsValid() ? depthOnlyInstancedMaterial : *entries[0]->RenderMaterial;
+        NONFATAL_ASSERT(currentMaterial != nullptr, "ForwardRenderManager::RenderMeshInstances -> Null material encountered.", true);
+
+        // gather the world transform of each instance
+        Transform model;
+        for (UInt32 i = 0; i < instanceCount; i++) {
+            SceneObject* sceneObject = entries[i]->Container;
+            NONFATAL_ASSERT(sceneObject != nullptr, "ForwardRenderManager::RenderMeshInstances -> Scene object is not valid.", true);
+
+            SceneObjectProcessingDescriptor& processingDesc = sceneObject->GetProcessingDescriptor();
+            model.SetTo(processingDesc.AggregateTransform);
+            model.PreTransformBy(viewDescriptor.UniformWorldSceneObjectTransform);
+            StoreInstanceTransform(model, instanceTransforms + i * InstanceTransformSize);
+        }
+
+        ActivateMaterial(currentMaterial, viewDescriptor.ReverseCulling);
+        SendActiveMaterialUniformsToShader();
+
+        // batches are only built for per-light (or unlit) passes, so there is at most a single light
+        if (lightingDescriptor.UseLighting && !currentMaterial->UsesUniformBlock(StandardUniformBlock::Light)) {
+            currentMaterial->SendLightToShader(*lightingDescriptor.LightObjects[0], lightingDescriptor.Positions[0], &lightingDescriptor.Directions[0]);
+        }
+
+        currentMaterial->SendInstanceTransformsToShader(instanceTransforms, instanceCount);
+        if (!currentMaterial->UsesUniformBlock(StandardUniformBlock::View)) {
+            currentMaterial->SendViewMatrixToShader(viewDescriptor.ViewTransformInverse.GetConstMatrix());
+            currentMaterial->SendProjectionMatrixToShader(viewDescriptor.ProjectionTransform.GetConstMatrix());
+        }
+        SendViewAttributesToShader(viewDescriptor);
+
+        Bool rendered = renderedSubRenderers[renderer->GetObjectID()];
+        ApplyForwardBlending(currentMaterial, rendered, blendingFilter);
+
+        renderer->RenderInstances(instanceCount);
+
+        if (flagRendered) {
+            for (UInt32 i = 0; i < instanceCount; i++) {
+                renderedSubRenderers[entries[i]->Renderer->GetObjectID()] = true;
+            }
+        }
+    }
+
+    /*
+     * Apply additive or subtractive blending ONLY if [material] has not specified its own blending mode.
+     *
+     * [rendered] - Has the mesh about to be rendered been rendered before (by this camera)?
+     * [blendingFilter] - Determines how forward-rendering blending will be applied.
+     */
+    void ForwardRenderManager::ApplyForwardBlending(MaterialRef material, Bool rendered, FowardBlendingFilter blendingFilter) {
+        if (material->GetBlendingMode() != RenderState::BlendingMode::None) return;
+
+        // if this sub mesh has already been rendered by this camera, then we want to use
+        // additive blending to combine it with the output from other lights. Otherwise
+        // turn off blending and render.
+        if ((rendered && blendingFilter == FowardBlendingFilter::OnlyIfRendered) || (blendingFilter == FowardBlendingFilter::Always)) {
+            if (GetForwardBlending() == FowardBlendingMethod::Subtractive) {
+                Engine::Instance()->GetGraphicsSystem()->SetBlendingEnabled(true);
+                Engine::Instance()->GetGraphicsSystem()->SetBlendingFunction(RenderState::BlendingMethod::Zero, RenderState::BlendingMethod::SrcAlpha);
+            }
+            else {
+                Engine::Instance()->GetGraphicsSystem()->SetBlendingEnabled(true);
+                Engine::Instance()->GetGraphicsSystem()->SetBlendingFunction(RenderState::BlendingMethod::One, RenderState::BlendingMethod::One);
+            }
+        }
+        else {
+            Engine::Instance()->GetGraphicsSystem()->SetBlendingEnabled(false);
+        }
+    }
+
+    /*
+     * Can the mesh attached to [entry] be drawn as one instance of an instanced draw call?
+     *
+     * Every instance is drawn from the vertex buffers of a single sub-renderer, so sub-renderers that transform
+     * their mesh's attributes (e.g. skinning) are excluded. Entries in transparent queues must be drawn in order, and
+     * the material that will be used must read the model transform from INSTANCE_TRANSFORMS. The only override
+     * material with an instanced counterpart is [depthOnlyMaterial].
+     */
+    Bool ForwardRenderManager::CanRenderInstanced(const RenderQueueEntry& entry, MaterialRef materialOverride) const {
+        if (!instancingEnabled) return false;
+
+        SubMesh3DRenderer* renderer = entry.Renderer;
+        if (renderer == nullptr || entry.Mesh == nullptr || renderer->DoesAttributeTransform()) return false;
+
+        MaterialRef entryMaterial = *entry.RenderMaterial;
+        if (entryMaterial->GetRenderQueue() >= (UInt32)RenderQueueType::Transparent) return false;
+
+        if (materialOverride.IsValid()) return materialOverride == depthOnlyMaterial;
+        return entryMaterial->SupportsInstancing() && entryMaterial->GetSinglePassMode() == SinglePassMode::None;
+    }
+
+    /*
+     * Add [entry] to the instance batch for its mesh, material, [renderMode] and rendered status. The batch is drawn
+     * by the next call to RenderInstanceBatches(). Return false if [entry] cannot be instanced, in which case the
+     * caller must render it immediately with RenderMesh().
+     *
+     * If the sub-renderer of [entry] already has an entry waiting in a batch (e.g. a sub-mesh with multiple materials),
+     * then the blending of [entry] depends on that entry having been rendered first, so the waiting batches are drawn
+     * before continuing.
+     */
+    Bool ForwardRenderManager::QueueInstancedMesh(RenderQueueEntry& entry, RenderMode renderMode, const LightingDescriptor& lightingDescriptor, const ViewDescriptor& viewDescriptor,
+                                                  MaterialRef materialOverride, Bool flagRendered, FowardBlendingFilter blendingFilter) {
+        SubMesh3DRenderer* renderer = entry.Renderer;
+        NONFATAL_ASSERT_RTRN(renderer != nullptr, "ForwardRenderManager::QueueInstancedMesh -> Null sub renderer encountered.", false, true);
+
+        if (batchedSubRenderers.find(renderer->GetObjectID()) != batchedSubRenderers.end()) {
+            RenderInstanceBatches(lightingDescriptor, viewDescriptor, materialOverride, flagRendered, blendingFilter);
+            Engine::Instance()->GetGraphicsSystem()->EnterRenderMode(renderMode);
+        }
+
+        if (!CanRenderInstanced(entry, materialOverride)) return false;
+
+        MaterialRef batchMaterial = materialOverride.IsValid() ? depthOnlyInstancedMaterial : *entry.RenderMaterial;
+        if (!ValidateRenderPassForRenderer(*renderer, batchMaterial)) return true;
+
+        Bool rendered = renderedSubRenderers[renderer->GetObjectID()];
+        InstanceBatchKey key(entry.Mesh, batchMaterial->GetObjectID(), renderMode, rendered);
+
+        UInt32 batchIndex = 0;
+        auto itr = instanceBatchIndices.find(key);
+        if (itr != instanceBatchIndices.end()) {
+            batchIndex = itr->second;
+        }
+        else {
+            if (instanceBatchCount >= instanceBatches.size()) instanceBatches.push_back(InstanceBatch());
+            batchIndex = instanceBatchCount;
+            instanceBatchCount++;
+
+            instanceBatches[batchIndex].Mode = renderMode;
+            instanceBatches[batchIndex].Entries.clear();
+            instanceBatchIndices[key] = batchIndex;
+        }
+
+        instanceBatches[batchIndex].Entries.push_back(&entry);
+        batchedSubRenderers[renderer->GetObjectID()] = true;
+
+        return true;
+    }
+
+    /*
+     * Draw every instance batch built by QueueInstancedMesh() since the last call, in the order the batches were started,
+     * and reset the batches. Batches of a single entry are drawn with a regular draw call, and batches with more than
+     * [MaxInstancesPerBatch] entries are split across multiple instanced draw calls.
+     *
+     * The parameters must be the same as those passed to QueueInstancedMesh() for the entries in the batches.
+     */
+    void ForwardRenderManager::RenderInstanceBatches(const LightingDescriptor& lightingDescriptor, const ViewDescriptor& viewDescriptor,
+                                                     MaterialRef materialOverride, Bool flagRendered, FowardBlendingFilter blendingFilter) {
+        RenderMode currentRenderMode = RenderMode::None;
+
+        for (UInt32 b = 0; b < instanceBatchCount; b++) {
+            InstanceBatch& batch = instanceBatches[b];
+
+            if (batch.Mode != currentRenderMode) {
+                currentRenderMode = batch.Mode;
+                Engine::Instance()->GetGraphicsSystem()->EnterRenderMode(currentRenderMode);
+            }
+
+            UInt32 entryCount = (UInt32)batch.Entries.size();
+            for (UInt32 start = 0; start < entryCount; start += MaxInstancesPerBatch) {
+                UInt32 instanceCount = GTEMath::Min(MaxInstancesPerBatch, entryCount - start);
+                if (instanceCount == 1) {
+                    RenderMesh(*batch.Entries[start], lightingDescriptor, viewDescriptor, materialOverride, flagRendered, blendingFilter);
                 }
                 else {
-                    Engine::Instance()->GetGraphicsSystem()->SetBlendingEnabled(true);
-                    Engine::Instance()->GetGraphicsSystem()->SetBlendingFunction(RenderState::BlendingMethod::One, RenderState::BlendingMethod::One);
+                    RenderMeshInstances(&batch.Entries[start], instanceCount, lightingDescriptor, viewDescriptor, materialOverride, flagRendered, blendingFilter);
                 }
             }
-            else {
-                Engine::Instance()->GetGraphicsSystem()->SetBlendingEnabled(false);
-            }
+
+            batch.Entries.clear();
         }
 
-        // render the current mesh
-        renderer->Render();
+        instanceBatchCount = 0;
+        instanceBatchIndices.clear();
+        batchedSubRenderers.clear();
+    }
 
-        // flag the current mesh & renderer combo as being rendered (at least once)
-        if (flagRendered) renderedSubRenderers[renderer->GetObjectID()] = true;
+    /*
+     * Store the upper three rows of the matrix of [model] in [dest], in the layout expected by INSTANCE_TRANSFORMS.
+     */
+    void ForwardRenderManager::StoreInstanceTransform(const Transform& model, Real * dest) {
+        const Real * m = model.GetConstMatrix().GetConstDataPtr();
+        for (UInt32 r = 0; r < 3; r++) {
+            for (UInt32 c = 0; c < 4; c++) {
+                dest[r * 4 + c] = m[r + c * 4];
+            }
+        }
     }
 
     Bool ForwardRenderManager::ValidateRenderPassForRenderer(SubMesh3DRenderer& renderer, MaterialRef material) {
@@ -1404,8 +2190,10 @@ namespace GTE {
         Vector3 lightDirection = light.GetDirection();
         lightWorldTransform.TransformVector(lightDirection);
 
-        for (RenderQueueManager::ConstIterator itr = renderQueueManager.Begin(); itr != renderQueueManager.End(); ++itr) {
-            RenderQueueEntry* entry = *itr;
+        // if [light] has a list of entries that are in range, only those entries need to be considered
+        const std::vector<RenderQueueEntry*>* lightEntryList = GetEntriesAffectedByLight(light);
+
+        auto buildForEntry = [&](RenderQueueEntry* entry) {
             NONFATAL_ASSERT(entry != nullptr, "ForwardRenderManager::BuildShadowVolumesForLight -> Null render queue entry encountered.", true);
 
             SceneObject* sceneObject = entry->Container;
@@ -1418,10 +2206,21 @@ namespace GTE {
 
                 // make sure the current mesh should not be culled from [light].
                 if (!ShouldCullFromLightByLayer(light, *sceneObject) &&
-                    !ShouldCullFromLightByPosition(light, lightWorldPosition, *entry->Mesh, sceneObjectWorldTransform)) {
+                    (lightEntryList != nullptr || !ShouldCullFromLightByPosition(light, lightWorldPosition, *entry->Mesh, sceneObjectWorldTransform))) {
                     BuildShadowVolumesForMesh(*entry, light, lightWorldPosition, lightDirection);
                 }
             }
+        };
+
+        if (lightEntryList != nullptr) {
+            for (RenderQueueEntry* entry : *lightEntryList) {
+                buildForEntry(entry);
+            }
+        }
+        else {
+            for (RenderQueueManager::ConstIterator itr = renderQueueManager.Begin(); itr != renderQueueManager.End(); ++itr) {
+                buildForEntry(*itr);
+            }
         }
     }
 
@@ -1670,6 +2469,22 @@ namespace GTE {
         return false;
     }
 
+    /*
+     * Check if the mesh in [entry] should be rendered with [light]. If [light] has a list of entries that are in range (found by
+     * querying [sceneBVH]) that list is searched for [entry], otherwise the bounds of the mesh are tested against [light] directly.
+     */
+    Bool ForwardRenderManager::ShouldCullFromLightByPosition(const Light& light, const Point3& lightWorldPosition, const RenderQueueEntry& entry, const Transform& meshWorldTransform) const {
+        const std::vector<RenderQueueEntry*>* lightEntryList = GetEntriesAffectedByLight(light);
+        if (lightEntryList != nullptr) {
+            // the list is sorted in render order
+            return !std::binary_search(lightEntryList->begin(), lightEntryList->end(), &entry, [](const RenderQueueEntry* a, const RenderQueueEntry* b) {
+                return a->SequenceIndex < b->SequenceIndex;
+            });
+        }
+
+        return ShouldCullFromLightByPosition(light, lightWorldPosition, *entry.Mesh, meshWorldTransform);
+    }
+
     /*
     * Check if [sceneObject] should be rendered with [light], based on the culling mask of the light and the layer to
     * which [sceneObject] belongs.
@@ -1798,6 +2613,10 @@ namespace GTE {
     /*
      * Send relevant scene transforms the active shader.
      * The binding information stored in the active material holds the shader variable locations for these matrices.
+     *
+     * If the active shader declares the ObjectData and/or ViewData uniform blocks, the matrices in those blocks
+     * are not sent individually; the per-object matrices are written to the ObjectData uniform buffer instead and
+     * the view & projection matrices are already in the ViewData uniform buffer.
      */
     void ForwardRenderManager::SendTransformUniformsToShader(const Transform& model, const Transform& modelView, const Transform& view, const Transform& projection, const Transform& modelViewProjection) {
         MaterialRef activeMaterial = Engine::Instance()->GetGraphicsSystem()->GetActiveMaterial();
@@ -1810,12 +2629,20 @@ namespace GTE {
         modelInverseTranspose.Transpose();
         modelInverseTranspose.Invert();
 
-        activeMaterial->SendModelMatrixInverseTransposeToShader(modelInverseTranspose);
-        activeMaterial->SendModelMatrixToShader(model.GetConstMatrix());
-        activeMaterial->SendModelViewMatrixToShader(modelView.GetConstMatrix());
-        activeMaterial->SendViewMatrixToShader(view.GetConstMatrix());
-        activeMaterial->SendProjectionMatrixToShader(projection.GetConstMatrix());
-        activeMaterial->SendMVPMatrixToShader(modelViewProjection.GetConstMatrix());
+        if (activeMaterial->UsesUniformBlock(StandardUniformBlock::Object)) {
+            UpdateObjectUniformBlock(model.GetConstMatrix(), modelInverseTranspose, modelView.GetConstMatrix(), modelViewProjection.GetConstMatrix());
+        }
+        else {
+            activeMaterial->SendModelMatrixInverseTransposeToShader(modelInverseTranspose);
+            activeMaterial->SendModelMatrixToShader(model.GetConstMatrix());
+            activeMaterial->SendModelViewMatrixToShader(modelView.GetConstMatrix());
+            activeMaterial->SendMVPMatrixToShader(modelViewProjection.GetConstMatrix());
+        }
+
+        if (!activeMaterial->UsesUniformBlock(StandardUniformBlock::View)) {
+            activeMaterial->SendViewMatrixToShader(view.GetConstMatrix());
+            activeMaterial->SendProjectionMatrixToShader(projection.GetConstMatrix());
+        }
     }
 
     /*
@@ -1842,22 +2669,263 @@ namespace GTE {
         ShaderRef shader = activeMaterial->GetShader();
         ASSERT(shader.IsValid(), "ForwardRenderManager::SendViewAttributesToShader -> Active material contains null shader.");
 
+        // the clip plane & view position are already in the ViewData uniform buffer if the shader declares that block
+        Bool sendViewUniforms = !activeMaterial->UsesUniformBlock(StandardUniformBlock::View);
+
         // for now we only support up to one clip plane
         //TODO: Add support for > 1 clip plane
         if (viewDescriptor.ClipPlaneCount > 0) {
             Engine::Instance()->GetGraphicsSystem()->DeactiveAllClipPlanes();
             Engine::Instance()->GetGraphicsSystem()->AddClipPlane();
 
-            activeMaterial->SendClipPlaneToShader(0, viewDescriptor.ClipPlane0Normal.x, viewDescriptor.ClipPlane0Normal.y, viewDescriptor.ClipPlane0Normal.z, viewDescriptor.ClipPlane0Offset);
-            activeMaterial->SendClipPlaneCountToShader(1);
+            if (sendViewUniforms) {
+                activeMaterial->SendClipPlaneToShader(0, viewDescriptor.ClipPlane0Normal.x, viewDescriptor.ClipPlane0Normal.y, viewDescriptor.ClipPlane0Normal.z, viewDescriptor.ClipPlane0Offset);
+                activeMaterial->SendClipPlaneCountToShader(1);
+            }
         }
         else {
             Engine::Instance()->GetGraphicsSystem()->DeactiveAllClipPlanes();
-            activeMaterial->SendClipPlaneToShader(0, 0, 0, 0, 0);
-            activeMaterial->SendClipPlaneCountToShader(0);
+            if (sendViewUniforms) {
+                activeMaterial->SendClipPlaneToShader(0, 0, 0, 0, 0);
+                activeMaterial->SendClipPlaneCountToShader(0);
+            }
         }
 
-        activeMaterial->SendEyePositionToShader(&viewDescriptor.ViewPosition);
+        if (sendViewUniforms)activeMaterial->SendEyePositionToShader(&viewDescriptor.ViewPosition);
+    }
+
+    /*
+     * Replace the contents of the uniform buffer for [block] with the [size] bytes in [data]. [currentData] holds
+     * the contents last written to the buffer; if they already match [data] the buffer is left alone.
+     */
+    void ForwardRenderManager::UpdateUniformBuffer(StandardUniformBlock block, void * currentData, const void * data, UInt32 size) {
+        UniformBuffer * buffer = uniformBuffers[(UInt32)block];
+        NONFATAL_ASSERT(buffer != nullptr, "ForwardRenderManager::UpdateUniformBuffer -> Uniform buffer has not been created.", true);
+
+        if (memcmp(currentData, data, size) == 0)return;
+
+        memcpy(currentData, data, size);
+        buffer->SetData(currentData);
+    }
+
+    /*
+     * Fill the ViewData uniform block with the view & projection matrices, view position and clip plane
+     * in [viewDescriptor]. This is done once for each view, rather than for each material that is rendered.
+     */
+    void ForwardRenderManager::UpdateViewUniformBlock(const ViewDescriptor& viewDescriptor) {
+        ViewUniformBlockData data;
+        memset(&data, 0, sizeof(ViewUniformBlockData));
+
+        memcpy(data.ViewMatrix, viewDescriptor.ViewTransformInverse.GetConstMatrix().GetConstDataPtr(), sizeof(data.ViewMatrix));
+        memcpy(data.ProjectionMatrix, viewDescriptor.ProjectionTransform.GetConstMatrix().GetConstDataPtr(), sizeof(data.ProjectionMatrix));
+
+        data.EyePosition[0] = viewDescriptor.ViewPosition.x;
+        data.EyePosition[1] = viewDescriptor.ViewPosition.y;
+        data.EyePosition[2] = viewDescriptor.ViewPosition.z;
+        data.EyePosition[3] = 1;
+
+        // for now we only support up to one clip plane (see SendViewAttributesToShader())
+        if (viewDescriptor.ClipPlaneCount > 0) {
+            data.ClipPlane0[0] = viewDescriptor.ClipPlane0Normal.x;
+            data.ClipPlane0[1] = viewDescriptor.ClipPlane0Normal.y;
+            data.ClipPlane0[2] = viewDescriptor.ClipPlane0Normal.z;
+            data.ClipPlane0[3] = viewDescriptor.ClipPlane0Offset;
+            data.ClipPlaneCount = 1;
+        }
+
+        UpdateUniformBuffer(StandardUniformBlock::View, &viewUniformBlockData, &data, sizeof(ViewUniformBlockData));
+    }
+
+    /*
+     * Fill the LightData uniform block with the parameters of the first light in [lightingDescriptor]. This
+     * is done once for each per-light rendering pass, rather than for each material that is rendered.
+     */
+    void ForwardRenderManager::UpdateLightUniformBlock(const LightingDescriptor& lightingDescriptor) {
+        const Light * light = lightingDescriptor.LightObjects[0];
+        NONFATAL_ASSERT(light != nullptr, "ForwardRenderManager::UpdateLightUniformBlock -> Lighting descriptor has null light.", true);
+
+        const Point3& position = lightingDescriptor.Positions[0];
+        const Vector3& direction = lightingDescriptor.Directions[0];
+        const Color4& color = light->GetColor();
+
+        LightUniformBlockData data;
+        memset(&data, 0, sizeof(LightUniformBlockData));
+
+        data.Position[0] = position.x;
+        data.Position[1] = position.y;
+        data.Position[2] = position.z;
+        data.Position[3] = 1;
+
+        data.Direction[0] = direction.x;
+        data.Direction[1] = direction.y;
+        data.Direction[2] = direction.z;
+        data.Direction[3] = 0;
+
+        data.Color[0] = color.r;
+        data.Color[1] = color.g;
+        data.Color[2] = color.b;
+        data.Color[3] = color.a;
+
+        data.Intensity = light->GetIntensity();
+        data.Attenuation = light->GetAttenuation();
+        data.Range = light->GetRange();
+        data.Type = (Int32)light->GetType();
+        data.ParallelAngleAttenuation = (Int32)light->GetParallelAngleAttenuationType();
+        data.OrthoAngleAttenuation = (Int32)light->GetOrthoAngleAttenuationType();
+
+        UpdateUniformBuffer(StandardUniformBlock::Light, &lightUniformBlockData, &data, sizeof(LightUniformBlockData));
+    }
+
+    /*
+     * Fill the ObjectData uniform block with the transformations of the mesh that is about to be rendered.
+     */
+    void ForwardRenderManager::UpdateObjectUniformBlock(const Matrix4x4& model, const Matrix4x4& modelInverseTranspose, const Matrix4x4& modelView, const Matrix4x4& modelViewProjection) {
+        ObjectUniformBlockData data;
+
+        memcpy(data.ModelMatrix, model.GetConstDataPtr(), sizeof(data.ModelMatrix));
+        memcpy(data.ModelMatrixInverseTranspose, modelInverseTranspose.GetConstDataPtr(), sizeof(data.ModelMatrixInverseTranspose));
+        memcpy(data.ModelViewMatrix, modelView.GetConstDataPtr(), sizeof(data.ModelViewMatrix));
+        memcpy(data.ModelViewProjectionMatrix, modelViewProjection.GetConstDataPtr(), sizeof(data.ModelViewProjectionMatrix));
+
+        UpdateUniformBuffer(StandardUniformBlock::Object, &objectUniformBlockData, &data, sizeof(ObjectUniformBlockData));
+    }
+
+    /*
+     * Bin the lights of the scene into the froxel grid of the view described by [viewDescriptor] and upload
+     * the result to the ClusterLightData, ClusterGridData and ClusterLightIndexData uniform buffers (see
+     * clusterdata.inc), so that a clustered lighting shader can evaluate every light that reaches a mesh in a
+     * single pass. The work is done at most once per view; later calls for the same view return immediately.
+     *
+     * Point lights are binned using the distance at which they are fully attenuated. Ambient, directional and
+     * planar lights (and point lights without attenuation) reach every cluster, so they are stored at the start
+     * of the light arrays and are evaluated for every fragment instead. The binning assumes a perspective
+     * projection; for any other projection every light is treated that way.
+     *
+     * Spot lights are not supported by the built-in lighting functions, so they are skipped. Light culling masks
+     * are not applied, since the lights of a cluster are shared by every mesh that is rendered in it.
+     */
+    void ForwardRenderManager::BuildLightClusters(const ViewDescriptor& viewDescriptor) {
+        if (lightClustersBuilt)return;
+        lightClustersBuilt = true;
+
+        // a perspective projection matrix copies -z (the view depth) to w
+        const Real * projection = viewDescriptor.ProjectionTransform.GetConstMatrix().GetConstDataPtr();
+        Bool binLights = projection[11] < 0 && projection[15] == 0;
+
+        UInt32 globalLightCount = 0;
+        UInt32 binnedLightCount = 0;
+        Real maxBinnedDepth = 0;
+
+        // store the lights that reach every cluster first, then bin the rest
+        for (UInt32 pass = 0; pass < 2; pass++) {
+            for (UInt32 l = 0; l < ambientLightCount + lightCount; l++) {
+                SceneObject * lightObject = l < ambientLightCount ? sceneAmbientLights[l] : sceneLights[l - ambientLightCount];
+                if (lightObject == nullptr)continue;
+
+                LightRef lightRef = lightObject->GetLight();
+                if (!lightRef.IsValid())continue;
+                const Light& light = lightRef.GetRef();
+
+                if (light.GetType() == LightType::Spot)continue;
+
+                Bool binned = binLights && light.GetType() == LightType::Point && light.GetAttenuation() > 0;
+                if (binned != (pass == 1))continue;
+                if (globalLightCount + binnedLightCount >= Constants::MaxClusteredLights)break;
+
+                // the lights must be in the same space as the meshes, which are pre-transformed by [UniformWorldSceneObjectTransform]
+                SceneObjectProcessingDescriptor& processingDesc = lightObject->GetProcessingDescriptor();
+                Transform lightTransform = processingDesc.AggregateTransform;
+                lightTransform.PreTransformBy(viewDescriptor.UniformWorldSceneObjectTransform);
+
+                Point3 position;
+                Vector3 direction = light.GetDirection();
+                lightTransform.TransformPoint(position);
+                lightTransform.TransformVector(direction);
+
+                if (binned) {
+                    StoreClusteredLight(globalLightCount + binnedLightCount, light, position, direction);
+
+                    Point3& viewPosition = clusteredLightViewPositions[binnedLightCount];
+                    viewPosition = position;
+                    viewDescriptor.ViewTransformInverse.TransformPoint(viewPosition);
+
+                    // the built-in lighting functions fade a point light out linearly over 1 / attenuation
+                    clusteredLightRadii[binnedLightCount] = 1.0f / light.GetAttenuation();
+                    maxBinnedDepth = GTEMath::Max(maxBinnedDepth, -viewPosition.z + clusteredLightRadii[binnedLightCount]);
+                    binnedLightCount++;
+                }
+                else {
+                    StoreClusteredLight(globalLightCount, light, position, direction);
+                    globalLightCount++;
+                }
+            }
+        }
+
+        if (binLights) {
+            Real nearDepth = projection[14] / (projection[10] - 1.0f);
+            // the far plane is at infinity if projection[10] is -1; the grid then only has to reach the furthest light
+            Real farDepth = projection[10] != -1.0f ? projection[14] / (projection[10] + 1.0f) : 0;
+            if (farDepth <= nearDepth)farDepth = GTEMath::Max(maxBinnedDepth, nearDepth * 2.0f);
+
+            lightClusterGrid.SetProjection(projection[0], projection[5], -projection[8], -projection[9], nearDepth, farDepth);
+        }
+        lightClusterGrid.Build(clusteredLightViewPositions, clusteredLightRadii, binnedLightCount);
+
+        clusterGridUniformBlockData.GridParameters[0] = lightClusterGrid.GetSliceScale();
+        clusterGridUniformBlockData.GridParameters[1] = lightClusterGrid.GetSliceBias();
+        clusterGridUniformBlockData.GlobalLightCount = (Int32)globalLightCount;
+
+        UInt32 clusterCount = lightClusterGrid.GetClusterCount();
+        for (UInt32 c = 0; c < clusterCount; c++) {
+            UInt32 offset = lightClusterGrid.GetClusterLightOffset(c);
+            UInt32 count = lightClusterGrid.GetClusterLightCount(c);
+            clusterGridUniformBlockData.LightLists[c] = offset | (count << 16);
+        }
+
+        // the binned lights follow the global lights in the light arrays, and each index is stored in a single byte
+        const UInt32 * lightIndices = lightClusterGrid.GetLightIndices();
+        UInt32 lightIndexCount = lightClusterGrid.GetLightIndexCount();
+        UInt32 * packedIndices = clusterLightIndexUniformBlockData.LightIndices;
+        memset(packedIndices, 0, ((lightIndexCount + 3) / 4) * sizeof(UInt32));
+        for (UInt32 i = 0; i < lightIndexCount; i++) {
+            packedIndices[i / 4] |= (globalLightCount + lightIndices[i]) << ((i % 4) * 8);
+        }
+
+        uniformBuffers[(UInt32)StandardUniformBlock::ClusterLights]->SetData(&clusterLightUniformBlockData);
+        uniformBuffers[(UInt32)StandardUniformBlock::ClusterGrid]->SetData(&clusterGridUniformBlockData);
+        uniformBuffers[(UInt32)StandardUniformBlock::ClusterLightIndices]->SetData(&clusterLightIndexUniformBlockData);
+    }
+
+    /*
+     * Store the parameters of [light], located at world space [position] and pointing in world
+     * space [direction], in slot [index] of the ClusterLightData uniform block.
+     */
+    void ForwardRenderManager::StoreClusteredLight(UInt32 index, const Light& light, const Point3& position, const Vector3& direction) {
+        Real * lightPosition = clusterLightUniformBlockData.Positions + index * 4;
+        Real * lightDirection = clusterLightUniformBlockData.Directions + index * 4;
+        Real * lightColor = clusterLightUniformBlockData.Colors + index * 4;
+        Real * lightParameters = clusterLightUniformBlockData.Parameters + index * 4;
+        const Color4& color = light.GetColor();
+
+        lightPosition[0] = position.x;
+        lightPosition[1] = position.y;
+        lightPosition[2] = position.z;
+        lightPosition[3] = light.GetRange();
+
+        lightDirection[0] = direction.x;
+        lightDirection[1] = direction.y;
+        lightDirection[2] = direction.z;
+        lightDirection[3] = light.GetAttenuation();
+
+        lightColor[0] = color.r;
+        lightColor[1] = color.g;
+        lightColor[2] = color.b;
+        lightColor[3] = color.a;
+
+        lightParameters[0] = light.GetIntensity();
+        lightParameters[1] = (Real)light.GetType();
+        lightParameters[2] = (Real)light.GetParallelAngleAttenuationType();
+        lightParameters[3] = (Real)light.GetOrthoAngleAttenuationType();
     }
 
     /*
@@ -20,13 +20,18 @@
 #include "renderqueuemanager.h"
 #include "lightingdescriptor.h"
 #include "viewdescriptor.h"
+#include "lightclustergrid.h"
 #include "object/engineobject.h"
 #include "object/objectpairkey.h"
 #include "util/datastack.h"
+#include "util/boundingvolumehierarchy.h"
 #include "graphics/view/camera.h"
 #include "graphics/light/light.h"
 #include "geometry/transform.h"
 #include "geometry/point/point3.h"
+#include "graphics/graphicsattr.h"
+#include "graphics/stduniforms.h"
+#include "global/constants.h"
 #include "assert.h"
 
 #include <vector>
@@ -43,7 +48,9 @@ namespace GTE {
     class Material;
     class SceneObjectComponent;
     class SubMesh3D;
+    class SubMesh3DRenderer;
     class Transform;
+    class UniformBuffer;
 
     enum class FowardBlendingMethod {
         Additive = 0,
@@ -62,6 +69,147 @@ namespace GTE {
 
         static const UInt32 MAX_CAMERAS = 8;
         static const UInt32 MAX_RENDER_QUEUES = 128;
+        // maximum number of instances in a single instanced draw call, limited by the size of
+        // INSTANCE_TRANSFORMS in the built-in instanced shaders (three 4-component rows per instance)
+        static const UInt32 MaxInstancesPerBatch = 64;
+        // number of values in each instance transformation (a 3x4 affine matrix)
+        static const UInt32 InstanceTransformSize = 12;
+        // number of bits in each field of a render queue entry's sort key (see BuildSortKey())
+        static const UInt32 SortKeyQueueBits = 14;
+        static const UInt32 SortKeyProgramBits = 10;
+        static const UInt32 SortKeyTextureSetBits = 12;
+        static const UInt32 SortKeyMaterialBits = 12;
+        static const UInt32 SortKeyDepthBits = 16;
+
+        // a sub-renderer whose attributes (e.g. vertex positions) are transformed on the CPU during PreRenderScene()
+        class AttributeTransformEntry {
+        public:
+
+            SubMesh3DRenderer * Renderer;
+            SceneObject * Container;
+
+            AttributeTransformEntry(SubMesh3DRenderer * renderer, SceneObject * container) {
+                Renderer = renderer;
+                Container = container;
+            }
+        };
+
+        // identifies render queue entries that can be drawn together with an instanced draw call
+        class InstanceBatchKey {
+        public:
+
+            const SubMesh3D * Mesh;
+            ObjectID MaterialID;
+            RenderMode Mode;
+            // have the sub-renderers of the entries been rendered before (which determines blending)?
+            Bool Rendered;
+
+            InstanceBatchKey(const SubMesh3D * mesh, ObjectID materialID, RenderMode mode, Bool rendered) {
+                Mesh = mesh;
+                MaterialID = materialID;
+                Mode = mode;
+                Rendered = rendered;
+            }
+
+            typedef struct {
+                size_t operator()(const InstanceBatchKey& k) const {
+                    return std::hash<const void*>()(k.Mesh) ^ ((size_t)k.MaterialID << 3) ^ ((size_t)k.Mode << 1) ^ (size_t)k.Rendered;
+                }
+            } InstanceBatchKeyHasher;
+
+            typedef struct {
+                Bool operator() (const InstanceBatchKey& a, const InstanceBatchKey& b) const {
+                    return a.Mesh == b.Mesh && a.MaterialID == b.MaterialID && a.Mode == b.Mode && a.Rendered == b.Rendered;
+                }
+            } InstanceBatchKeyEq;
+        };
+
+        // render queue entries collected during a rendering pass that share a mesh, material & render mode
+        class InstanceBatch {
+        public:
+
+            RenderMode Mode;
+            std::vector<RenderQueueEntry*> Entries;
+
+            InstanceBatch() {
+                Mode = RenderMode::Standard;
+            }
+        };
+
+        // CPU-side copy of the std140 uniform block ViewData (see viewdata.inc)
+        class ViewUniformBlockData {
+        public:
+
+            Real ViewMatrix[16];
+            Real ProjectionMatrix[16];
+            Real EyePosition[4];
+            Real ClipPlane0[4];
+            Int32 ClipPlaneCount;
+            // pad the block to a multiple of 16 bytes, as required by std140
+            Int32 Padding[3];
+        };
+
+        // CPU-side copy of the std140 uniform block LightData (see lightdata.inc)
+        class LightUniformBlockData {
+        public:
+
+            Real Position[4];
+            Real Direction[4];
+            Real Color[4];
+            Real Intensity;
+            Real Attenuation;
+            Real Range;
+            Int32 Type;
+            Int32 ParallelAngleAttenuation;
+            Int32 OrthoAngleAttenuation;
+            // pad the block to a multiple of 16 bytes, as required by std140
+            Int32 Padding[2];
+        };
+
+        // CPU-side copy of the std140 uniform block ObjectData (see objectdata.inc)
+        class ObjectUniformBlockData {
+        public:
+
+            Real ModelMatrix[16];
+            Real ModelMatrixInverseTranspose[16];
+            Real ModelViewMatrix[16];
+            Real ModelViewProjectionMatrix[16];
+        };
+
+        // CPU-side copy of the std140 uniform block ClusterLightData (see clusterdata.inc)
+        class ClusterLightUniformBlockData {
+        public:
+
+            // xyz = world position, w = range
+            Real Positions[Constants::MaxClusteredLights * 4];
+            // xyz = world direction, w = attenuation
+            Real Directions[Constants::MaxClusteredLights * 4];
+            Real Colors[Constants::MaxClusteredLights * 4];
+            // intensity, type, parallel angle attenuation type, ortho angle attenuation type
+            Real Parameters[Constants::MaxClusteredLights * 4];
+        };
+
+        // CPU-side copy of the std140 uniform block ClusterGridData (see clusterdata.inc)
+        class ClusterGridUniformBlockData {
+        public:
+
+            // depth slice scale, depth slice bias, unused, unused
+            Real GridParameters[4];
+            // number of lights at the start of the light arrays that are not binned
+            Int32 GlobalLightCount;
+            // align LightLists to 16 bytes, as required by std140
+            Int32 Padding[3];
+            // the light list of each cluster: offset in the low 16 bits, light count in the high 16 bits
+            UInt32 LightLists[Constants::ClusterTileCountX * Constants::ClusterTileCountY * Constants::ClusterSliceCount];
+        };
+
+        // CPU-side copy of the std140 uniform block ClusterLightIndexData (see clusterdata.inc)
+        class ClusterLightIndexUniformBlockData {
+        public:
+
+            // light indices, packed four to a value (one byte each)
+            UInt32 LightIndices[Constants::MaxClusterLightIndices / 4];
+        };
 
         // describes parameters of a single light
         LightingDescriptor singleLightDescriptor;
@@ -79,6 +227,10 @@ namespace GTE {
         MaterialSharedPtr shadowVolumeMaterial;
         // material for rendering only to the depth buffer
         MaterialSharedPtr depthOnlyMaterial;
+        // material for rendering only to the depth buffer, for meshes that are skinned in the vertex shader
+        MaterialSharedPtr depthOnlySkinnedMaterial;
+        // material for rendering only to the depth buffer, for batches of instances
+        MaterialSharedPtr depthOnlyInstancedMaterial;
         // material for rendering depth values to color buffer
         MaterialSharedPtr depthValueMaterial;
         // material for rendering SSAO-style outlines
@@ -112,20 +264,82 @@ namespace GTE {
         // keep track of sub renderers that have rendered at least once.
         // TODO: optimize usage of this hashing structure
         std::unordered_map<UInt32, Bool> renderedSubRenderers;
+        // number of render queue entries that were culled by the view frustum of each camera, keyed by the camera's object ID
+        std::unordered_map<ObjectID, UInt32> frustumCulledEntryCounts;
+        typedef BoundingVolumeHierarchy<ObjectPairKey, RenderQueueEntry*, ObjectPairKey::ObjectPairKeyHasher, ObjectPairKey::ObjectPairKeyEq> SceneBVH;
+
+        // hierarchy of the world-space bounds of the mesh in each render queue entry, keyed by sub-renderer & material IDs
+        SceneBVH sceneBVH;
+        // render queue entries within range of each light in [sceneLights], in render order. only lights with a
+        // limited range have a list, all other lights potentially affect every entry
+        std::vector<RenderQueueEntry*> lightEntries[Constants::MaxSceneLights];
+        // map the object ID of a light to its list in [lightEntries]
+        std::unordered_map<ObjectID, UInt32> lightEntryListIndices;
+        // sub-renderers found by PreRenderScene() that use an attribute transformer
+        std::vector<AttributeTransformEntry> attributeTransformRenderers;
         // cache shadow volumes that don't need to be constantly rebuilt
         std::unordered_map<ObjectPairKey, Point3Array*, ObjectPairKey::ObjectPairKeyHasher, ObjectPairKey::ObjectPairKeyEq> shadowVolumeCache;
 
         std::stack<RenderTargetSharedPtr> renderTargetStack;
 
+        // sort the entries of each render queue by render state and depth before rendering each view?
+        Bool renderQueueSortingEnabled;
+        // compact sort key values for the shader programs, texture sets & materials of the render queue
+        // entries, assigned in order of first appearance by BuildSortKey()
+        std::unordered_map<ObjectID, UInt32> sortKeyProgramValues;
+        std::unordered_map<UInt64, UInt32> sortKeyTextureSetValues;
+        std::unordered_map<ObjectID, UInt32> sortKeyMaterialValues;
+
+        // draw repeated mesh & material pairs with instanced draw calls?
+        Bool instancingEnabled;
+        // instance batches collected during the current rendering pass, in the order they were started. only
+        // the first [instanceBatchCount] are in use; the rest are kept to avoid re-allocating their entry lists.
+        std::vector<InstanceBatch> instanceBatches;
+        UInt32 instanceBatchCount;
+        // map the key of each batch in use to its index in [instanceBatches]
+        std::unordered_map<InstanceBatchKey, UInt32, InstanceBatchKey::InstanceBatchKeyHasher, InstanceBatchKey::InstanceBatchKeyEq> instanceBatchIndices;
+        // sub-renderers with an entry in one of the batches in use
+        std::unordered_map<UInt32, Bool> batchedSubRenderers;
+        // model transformations of the instances in the current instanced draw call
+        Real instanceTransforms[MaxInstancesPerBatch * InstanceTransformSize];
+
+        // one uniform buffer for each standard uniform block, attached to the binding point of the same index
+        UniformBuffer * uniformBuffers[(UInt32)StandardUniformBlock::_Last];
+        // contents of the uniform buffers in [uniformBuffers], kept to skip updates that would not change them
+        ViewUniformBlockData viewUniformBlockData;
+        LightUniformBlockData lightUniformBlockData;
+        ObjectUniformBlockData objectUniformBlockData;
+        ClusterLightUniformBlockData clusterLightUniformBlockData;
+        ClusterGridUniformBlockData clusterGridUniformBlockData;
+        ClusterLightIndexUniformBlockData clusterLightIndexUniformBlockData;
+
+        // bins the lights of the current view for clustered lighting shaders
+        LightClusterGrid lightClusterGrid;
+        // have the light clusters been built (and uploaded) for the current view?
+        Bool lightClustersBuilt;
+        // view space positions & radii of the lights binned by [lightClusterGrid]
+        Point3 clusteredLightViewPositions[Constants::MaxClusteredLights];
+        Real clusteredLightRadii[Constants::MaxClusteredLights];
+
         void PreRender() override;
         void PreProcessScene(SceneObject& parent, UInt32 recursionDepth);
         void PreRenderScene();
+        void UpdateSceneBVH();
+        Bool GetSuspendedSkinnedBounds(SubMesh3DRenderer * renderer, AnimationManager * animationManager, Point3& center, Vector3& extents);
+        void BuildLightEntryLists();
+        const std::vector<RenderQueueEntry*>* GetEntriesAffectedByLight(const Light& light) const;
 
         void RenderSceneForCamera(UInt32 cameraIndex);
         void RenderSceneForCamera(CameraRef camera);
 
         void GetViewDescriptorForCamera(const Camera& camera, const Transform* altViewTransform, ViewDescriptor& descriptor);
         void ClearRenderedStatus();
+        UInt32 CullRenderQueueEntriesByFrustum(const ViewDescriptor& viewDescriptor);
+        void MarkVisibleSkeletons();
+
+        void SortRenderQueues(const ViewDescriptor& viewDescriptor);
+        UInt64 BuildSortKey(const RenderQueueEntry& entry, const ViewDescriptor& viewDescriptor);
+        static UInt32 GetSortKeyValue(std::unordered_map<ObjectID, UInt32>& values, ObjectID id);
 
         void RenderSceneForCurrentRenderTarget(const ViewDescriptor& viewDescriptor);
         void RenderSkyboxForCamera(const ViewDescriptor& viewDescriptor);
@@ -143,6 +357,16 @@ namespace GTE {
 
         void RenderMesh(RenderQueueEntry& entry, const LightingDescriptor& lightingDescriptor, const ViewDescriptor& viewDescriptor,
                         MaterialRef materialOverride, Bool flagRendered, FowardBlendingFilter blendingFilter);
+        void RenderMeshInstances(RenderQueueEntry * const * entries, UInt32 instanceCount, const LightingDescriptor& lightingDescriptor,
+                                 const ViewDescriptor& viewDescriptor, MaterialRef materialOverride, Bool flagRendered, FowardBlendingFilter blendingFilter);
+        void ApplyForwardBlending(MaterialRef material, Bool rendered, FowardBlendingFilter blendingFilter);
+
+        Bool CanRenderInstanced(const RenderQueueEntry& entry, MaterialRef materialOverride) const;
+        Bool QueueInstancedMesh(RenderQueueEntry& entry, RenderMode renderMode, const LightingDescriptor& lightingDescriptor, const ViewDescriptor& viewDescriptor,
+                                MaterialRef materialOverride, Bool flagRendered, FowardBlendingFilter blendingFilter);
+        void RenderInstanceBatches(const LightingDescriptor& lightingDescriptor, const ViewDescriptor& viewDescriptor,
+                                   MaterialRef materialOverride, Bool flagRendered, FowardBlendingFilter blendingFilter);
+        static void StoreInstanceTransform(const Transform& model, Real * dest);
 
         void RenderShadowVolumeForMesh(RenderQueueEntry& entry, const Light& light, const Point3& lightPosition, const Vector3& lightDirection,
                                        const ViewDescriptor& viewDescriptor);
@@ -165,6 +389,15 @@ namespace GTE {
 
         void ClearRenderBuffers(IntMask clearMask) const;
 
+        Bool InitUniformBuffers();
+        void DestroyUniformBuffers();
+        void UpdateUniformBuffer(StandardUniformBlock block, void * currentData, const void * data, UInt32 size);
+        void UpdateViewUniformBlock(const ViewDescriptor& viewDescriptor);
+        void UpdateLightUniformBlock(const LightingDescriptor& lightingDescriptor);
+        void UpdateObjectUniformBlock(const Matrix4x4& model, const Matrix4x4& modelInverseTranspose, const Matrix4x4& modelView, const Matrix4x4& modelViewProjection);
+        void BuildLightClusters(const ViewDescriptor& viewDescriptor);
+        void StoreClusteredLight(UInt32 index, const Light& light, const Point3& position, const Vector3& direction);
+
         void ActivateMaterial(MaterialRef material, Bool reverseFaceCulling);
         void SendTransformUniformsToShader(const Transform& model, const Transform& modelView, const Transform& view, const Transform& projection, const Transform& modelViewProjection);
         void SendModelViewProjectionToShader(const Transform& modelViewProjection);
@@ -173,6 +406,7 @@ namespace GTE {
 
         Bool ShouldCullByLayer(IntMask cullingMask, const SceneObject& sceneObject) const;
         Bool ShouldCullFromLightByPosition(const Light& light, const Point3& lightWorldPosition, const SubMesh3D& mesh, const Transform& meshWorldTransformInverse) const;
+        Bool ShouldCullFromLightByPosition(const Light& light, const Point3& lightWorldPosition, const RenderQueueEntry& entry, const Transform& meshWorldTransform) const;
         Bool ShouldCullFromLightByLayer(const Light& light, const SceneObject& sceneObject) const;
         Bool ShouldCullByBoundingBox(const Light& light, const Point3& lightPosition, const Transform& meshWorldTransform, const SubMesh3D& mesh) const;
         Bool ShouldCullByTile(const Light& light, const Point3& lightPosition, const Transform& meshWorldTransform, const SubMesh3D& mesh) const;
@@ -193,6 +427,12 @@ namespace GTE {
         void ClearCaches() override;
 
         void RenderFullScreenQuad(RenderTargetRef renderTarget, MaterialRef material, Bool clearBuffers) override;
+
+        UInt32 GetFrustumCulledEntryCount(CameraRef camera) const;
+        void SetRenderQueueSortingEnabled(Bool enabled);
+        Bool IsRenderQueueSortingEnabled() const;
+        void SetInstancingEnabled(Bool enabled);
+        Bool IsInstancingEnabled() const;
     };
 }
 
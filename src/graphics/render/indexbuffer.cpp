@@ -0,0 +1,24 @@
+#include "indexbuffer.h"
+
+namespace GTE {
+    /*
+     * Single constructor.
+     */
+    IndexBuffer::IndexBuffer() : indexCount(0) {
+
+    }
+
+    /*
+     * Clean-up.
+     */
+    IndexBuffer::~IndexBuffer() {
+
+    }
+
+    /*
+     * Get the number of indices in this buffer.
+     */
+    UInt32 IndexBuffer::GetIndexCount() const {
+        return indexCount;
+    }
+}
@@ -0,0 +1,39 @@
+/*
+ * class: IndexBuffer
+ *
+ * author: Mark Kellogg
+ *
+ * Base class for index buffers, which hold the indices (into a set of vertex attribute
+ * buffers) of the vertices that make up each triangle of a mesh. Drawing with an index
+ * buffer allows each unique vertex to be stored and transformed only once, no matter how
+ * many triangles share it.
+ *
+ * As with VertexAttrBuffer, the platform specific implementation of IndexBuffer is
+ * in a deriving class.
+ *
+ */
+
+#ifndef _GTE_INDEX_BUFFER_H_
+#define _GTE_INDEX_BUFFER_H_
+
+#include "engine.h"
+
+namespace GTE {
+    class IndexBuffer {
+    protected:
+
+        // total number of indices in the buffer
+        UInt32 indexCount;
+
+    public:
+
+        IndexBuffer();
+        virtual ~IndexBuffer();
+
+        virtual Bool Init(UInt32 indexCount, Bool dataOnGPU, const UInt32 * srcData) = 0;
+        virtual void SetData(const UInt32 * srcData) = 0;
+        UInt32 GetIndexCount() const;
+    };
+}
+
+#endif
@@ -0,0 +1,105 @@
+#include "graphics/gl_include.h"
+#include "indexbufferGL.h"
+#include "graphics/graphicsGL.h"
+#include "global/global.h"
+#include "global/assert.h"
+#include "debug/gtedebug.h"
+
+#include <memory.h>
+
+namespace GTE {
+    /*
+     * Single constructor.
+     */
+    IndexBufferGL::IndexBufferGL() : IndexBuffer(), data(nullptr), dataOnGPU(false), gpuBufferID(0) {
+
+    }
+
+    /*
+     * Clean-up.
+     */
+    IndexBufferGL::~IndexBufferGL() {
+        Destroy();
+    }
+
+    /*
+     * Initialize the buffer.
+     *
+     * [indexCount] - The total number of indices in this buffer.
+     * [dataOnGPU] - Make this an element array buffer object.
+     * [srcData] - Data to be copied into the buffer after initialization.
+     */
+    Bool IndexBufferGL::Init(UInt32 indexCount, Bool dataOnGPU, const UInt32 * srcData) {
+        // if this buffer has already be initialized we need to destroy it and start fresh
+        Destroy();
+
+        this->indexCount = indexCount;
+
+        data = new(std::nothrow) UInt32[indexCount];
+        ASSERT(data != nullptr, "IndexBufferGL::Init -> Could not allocate IndexBufferGL data.");
+        memset(data, 0, indexCount * sizeof(UInt32));
+
+        if (dataOnGPU) {
+            glGenBuffers(1, &gpuBufferID);
+            this->dataOnGPU = gpuBufferID > 0;
+        }
+
+        if (srcData != nullptr)SetData(srcData);
+
+        return true;
+    }
+
+    /*
+     * Copy the indices stored in [srcData] into the buffer. Index data rarely changes,
+     * so the buffer storage is specified as static.
+     */
+    void IndexBufferGL::SetData(const UInt32 * srcData) {
+        UInt32 fullDataSize = indexCount * sizeof(UInt32);
+
+        if (dataOnGPU) {
+            // the element array buffer binding is part of the bound VAO, so make sure that is the default one
+            GraphicsGL * graphicsGL = dynamic_cast<GraphicsGL*>(Engine::Instance()->GetGraphicsSystem());
+            if (graphicsGL != nullptr)graphicsGL->BindDefaultVertexArray();
+
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gpuBufferID);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, fullDataSize, srcData, GL_STATIC_DRAW);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        }
+        else memcpy(data, srcData, fullDataSize);
+    }
+
+    /*
+     * Deallocate & destroy the buffer.
+     */
+    void IndexBufferGL::Destroy() {
+        if (dataOnGPU && gpuBufferID) {
+            glDeleteBuffers(1, &gpuBufferID);
+            dataOnGPU = false;
+            gpuBufferID = 0;
+        }
+
+        SAFE_DELETE_ARRAY(data);
+    }
+
+    /*
+     * Get a const pointer to the raw buffer data. This is only a CPU-side pointer;
+     * if the buffer is an element array buffer object, its contents are only on the GPU.
+     */
+    const UInt32 * IndexBufferGL::GetConstDataPtr() const {
+        return data;
+    }
+
+    /*
+     * Is the buffer an element array buffer object?
+     */
+    Bool IndexBufferGL::IsGPUBuffer() const {
+        return dataOnGPU;
+    }
+
+    /*
+     *  Get the OpenGL id of the element array buffer object.
+     */
+    GLuint IndexBufferGL::GetGPUBufferID() const {
+        return gpuBufferID;
+    }
+}
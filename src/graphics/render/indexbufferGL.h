@@ -0,0 +1,46 @@
+/*
+ * class: IndexBufferGL
+ *
+ * author: Mark Kellogg
+ *
+ * OpenGL-specific implementation of IndexBuffer.
+ *
+ */
+
+#ifndef _GTE_INDEX_BUFFER_GL_H_
+#define _GTE_INDEX_BUFFER_GL_H_
+
+#include "engine.h"
+#include "graphics/gl_include.h"
+#include "indexbuffer.h"
+
+namespace GTE {
+    class IndexBufferGL : public GTE::IndexBuffer {
+        // necessary during rendering
+        friend class GraphicsGL;
+
+        // raw pointer to the buffer data
+        UInt32 * data;
+        // is this an element array buffer object?
+        Bool dataOnGPU;
+        // OpenGL id for the buffer
+        GLuint gpuBufferID;
+
+    protected:
+
+        IndexBufferGL();
+        virtual ~IndexBufferGL();
+
+        void Destroy();
+
+    public:
+
+        Bool Init(UInt32 indexCount, Bool dataOnGPU, const UInt32 * srcData);
+        void SetData(const UInt32 * srcData);
+        const UInt32 * GetConstDataPtr() const;
+        Bool IsGPUBuffer() const;
+        GLuint GetGPUBufferID() const;
+    };
+}
+
+#endif
@@ -0,0 +1,308 @@
+#include <math.h>
+
+#include "lightclustergrid.h"
+#include "global/global.h"
+#include "global/assert.h"
+#include "gtemath/gtemath.h"
+#include "geometry/point/point3.h"
+
+namespace GTE {
+    LightClusterGrid::LightClusterGrid() {
+        tileCountX = 0;
+        tileCountY = 0;
+        sliceCount = 0;
+        clusterCount = 0;
+        maxLightIndices = 0;
+
+        scaleX = 1;
+        scaleY = 1;
+        offsetX = 0;
+        offsetY = 0;
+        nearDepth = 1;
+        farDepth = 2;
+        sliceScale = 0;
+        sliceBias = 0;
+
+        clusterLightOffsets = nullptr;
+        clusterLightCounts = nullptr;
+        lightIndices = nullptr;
+        lightIndexCount = 0;
+        pairClusters = nullptr;
+        pairLights = nullptr;
+        overflowed = false;
+    }
+
+    LightClusterGrid::~LightClusterGrid() {
+        Destroy();
+    }
+
+    void LightClusterGrid::Destroy() {
+        SAFE_DELETE_ARRAY(clusterLightOffsets);
+        SAFE_DELETE_ARRAY(clusterLightCounts);
+        SAFE_DELETE_ARRAY(lightIndices);
+        SAFE_DELETE_ARRAY(pairClusters);
+        SAFE_DELETE_ARRAY(pairLights);
+        lightIndexCount = 0;
+    }
+
+    /*
+     * Allocate a grid of [tileCountX] x [tileCountY] x [sliceCount] clusters whose light lists can hold
+     * a combined total of [maxLightIndices] entries.
+     */
+    Bool LightClusterGrid::Init(UInt32 tileCountX, UInt32 tileCountY, UInt32 sliceCount, UInt32 maxLightIndices) {
+        NONFATAL_ASSERT_RTRN(tileCountX > 0 && tileCountY > 0 && sliceCount > 0, "LightClusterGrid::Init -> Invalid grid dimensions.", false, true);
+        NONFATAL_ASSERT_RTRN(maxLightIndices > 0, "LightClusterGrid::Init -> Invalid light index count.", false, true);
+
+        Destroy();
+
+        this->tileCountX = tileCountX;
+        this->tileCountY = tileCountY;
+        this->sliceCount = sliceCount;
+        this->maxLightIndices = maxLightIndices;
+        clusterCount = tileCountX * tileCountY * sliceCount;
+
+        clusterLightOffsets = new(std::nothrow) UInt32[clusterCount];
+        ASSERT(clusterLightOffsets != nullptr, "LightClusterGrid::Init -> Unable to allocate cluster light offsets.");
+
+        clusterLightCounts = new(std::nothrow) UInt32[clusterCount];
+        ASSERT(clusterLightCounts != nullptr, "LightClusterGrid::Init -> Unable to allocate cluster light counts.");
+
+        lightIndices = new(std::nothrow) UInt32[maxLightIndices];
+        ASSERT(lightIndices != nullptr, "LightClusterGrid::Init -> Unable to allocate light indices.");
+
+        pairClusters = new(std::nothrow) UInt32[maxLightIndices];
+        ASSERT(pairClusters != nullptr, "LightClusterGrid::Init -> Unable to allocate cluster pairs.");
+
+        pairLights = new(std::nothrow) UInt32[maxLightIndices];
+        ASSERT(pairLights != nullptr, "LightClusterGrid::Init -> Unable to allocate light pairs.");
+
+        for (UInt32 i = 0; i < clusterCount; i++) {
+            clusterLightOffsets[i] = 0;
+            clusterLightCounts[i] = 0;
+        }
+
+        SetProjection(scaleX, scaleY, offsetX, offsetY, nearDepth, farDepth);
+
+        return true;
+    }
+
+    /*
+     * Describe the perspective projection of the view. A point at view space position (x, y, -depth)
+     * lands at normalized device coordinates (scaleX * x / depth + offsetX, scaleY * y / depth + offsetY).
+     * For a standard OpenGL projection matrix P (column-major), scaleX = P[0], scaleY = P[5], offsetX = -P[8]
+     * and offsetY = -P[9].
+     *
+     * Depth slices are placed between [nearDepth] and [farDepth].
+     */
+    void LightClusterGrid::SetProjection(Real scaleX, Real scaleY, Real offsetX, Real offsetY, Real nearDepth, Real farDepth) {
+        NONFATAL_ASSERT(nearDepth > 0 && farDepth > nearDepth, "LightClusterGrid::SetProjection -> Invalid depth range.", true);
+
+        this->scaleX = scaleX;
+        this->scaleY = scaleY;
+        this->offsetX = offsetX;
+        this->offsetY = offsetY;
+        this->nearDepth = nearDepth;
+        this->farDepth = farDepth;
+
+        sliceScale = (Real)sliceCount / logf(farDepth / nearDepth);
+        sliceBias = -logf(nearDepth) * sliceScale;
+    }
+
+    /*
+     * Bin [lightCount] lights into the grid. Light i is a sphere centered at [viewSpacePositions][i] with
+     * radius [radii][i]; its index in the light lists of the clusters it touches is i.
+     *
+     * If the lights touch more clusters than there are entries in the light index list, the (cluster, light)
+     * pairs of the last lights to be binned are dropped, and HasOverflowed() will return true.
+     */
+    void LightClusterGrid::Build(const Point3 * viewSpacePositions, const Real * radii, UInt32 lightCount) {
+        NONFATAL_ASSERT(clusterLightOffsets != nullptr, "LightClusterGrid::Build -> Grid has not been initialized.", true);
+
+        UInt32 pairCount = 0;
+        overflowed = false;
+
+        for (UInt32 l = 0; l < lightCount; l++) {
+            const Point3& center = viewSpacePositions[l];
+            Real radius = radii[l];
+            Real depth = -center.z;
+
+            if (radius <= 0)continue;
+            if (depth + radius <= nearDepth || depth - radius >= farDepth)continue;
+
+            Real minDepth = GTEMath::Max(depth - radius, nearDepth);
+            Real maxDepth = GTEMath::Min(depth + radius, farDepth);
+
+            UInt32 minSlice = GetSliceForDepth(minDepth);
+            UInt32 maxSlice = GetSliceForDepth(maxDepth);
+
+            for (UInt32 s = minSlice; s <= maxSlice; s++) {
+                // the part of the light's depth range that lies in this slice
+                Real sliceMinDepth = GTEMath::Max(GetSliceNearDepth(s), minDepth);
+                Real sliceMaxDepth = GTEMath::Min(GetSliceNearDepth(s + 1), maxDepth);
+
+                UInt32 minTileX, maxTileX, minTileY, maxTileY;
+                if (!GetTileRange(center.x - radius, center.x + radius, sliceMinDepth, sliceMaxDepth, scaleX, offsetX, tileCountX, minTileX, maxTileX))continue;
+                if (!GetTileRange(center.y - radius, center.y + radius, sliceMinDepth, sliceMaxDepth, scaleY, offsetY, tileCountY, minTileY, maxTileY))continue;
+
+                for (UInt32 y = minTileY; y <= maxTileY; y++) {
+                    for (UInt32 x = minTileX; x <= maxTileX; x++) {
+                        if (!SphereIntersectsCluster(center, radius, x, y, s))continue;
+
+                        if (pairCount >= maxLightIndices) {
+                            overflowed = true;
+                            continue;
+                        }
+
+                        pairClusters[pairCount] = GetClusterIndex(x, y, s);
+                        pairLights[pairCount] = l;
+                        pairCount++;
+                    }
+                }
+            }
+        }
+
+        // counting sort of the (cluster, light) pairs by cluster; the sort is stable, so the lights
+        // of each cluster stay in the order in which they were binned
+        for (UInt32 i = 0; i < clusterCount; i++) {
+            clusterLightCounts[i] = 0;
+        }
+
+        for (UInt32 i = 0; i < pairCount; i++) {
+            clusterLightCounts[pairClusters[i]]++;
+        }
+
+        UInt32 offset = 0;
+        for (UInt32 i = 0; i < clusterCount; i++) {
+            clusterLightOffsets[i] = offset;
+            offset += clusterLightCounts[i];
+            clusterLightCounts[i] = 0;
+        }
+
+        for (UInt32 i = 0; i < pairCount; i++) {
+            UInt32 cluster = pairClusters[i];
+            lightIndices[clusterLightOffsets[cluster] + clusterLightCounts[cluster]] = pairLights[i];
+            clusterLightCounts[cluster]++;
+        }
+
+        lightIndexCount = pairCount;
+    }
+
+    /*
+     * Find the range of tiles along one axis that is covered by the view space interval [minCoord, maxCoord]
+     * between the view depths [minDepth] and [maxDepth]. Returns false if the interval lies outside the view.
+     */
+    Bool LightClusterGrid::GetTileRange(Real minCoord, Real maxCoord, Real minDepth, Real maxDepth, Real scale, Real offset,
+                                        UInt32 tileCount, UInt32& minTile, UInt32& maxTile) const {
+        // coord / depth is smallest at the far end of the interval for positive values, and at the near end for negative values
+        Real minNDC = scale * (minCoord >= 0 ? minCoord / maxDepth : minCoord / minDepth) + offset;
+        Real maxNDC = scale * (maxCoord >= 0 ? maxCoord / minDepth : maxCoord / maxDepth) + offset;
+
+        if (maxNDC < -1.0f || minNDC > 1.0f)return false;
+
+        Int32 first = (Int32)floorf((minNDC * 0.5f + 0.5f) * (Real)tileCount);
+        Int32 last = (Int32)floorf((maxNDC * 0.5f + 0.5f) * (Real)tileCount);
+
+        minTile = (UInt32)GTEMath::Max(first, 0);
+        maxTile = (UInt32)GTEMath::Min(last, (Int32)tileCount - 1);
+
+        return true;
+    }
+
+    /*
+     * Get the view space coordinate of tile edge [edge] (0 to [tileCount]) along one axis at view depth [depth].
+     */
+    Real LightClusterGrid::GetTileEdgeViewCoord(UInt32 edge, UInt32 tileCount, Real scale, Real offset, Real depth) const {
+        Real ndc = ((Real)edge / (Real)tileCount) * 2.0f - 1.0f;
+        return (ndc - offset) * depth / scale;
+    }
+
+    /*
+     * Test the sphere at [center] with radius [radius] against the view space bounding box of a single cluster.
+     */
+    Bool LightClusterGrid::SphereIntersectsCluster(const Point3& center, Real radius, UInt32 tileX, UInt32 tileY, UInt32 slice) const {
+        Real sliceNear = GetSliceNearDepth(slice);
+        Real sliceFar = GetSliceNearDepth(slice + 1);
+
+        Real minX = GTEMath::Min(GetTileEdgeViewCoord(tileX, tileCountX, scaleX, offsetX, sliceNear), GetTileEdgeViewCoord(tileX, tileCountX, scaleX, offsetX, sliceFar));
+        Real maxX = GTEMath::Max(GetTileEdgeViewCoord(tileX + 1, tileCountX, scaleX, offsetX, sliceNear), GetTileEdgeViewCoord(tileX + 1, tileCountX, scaleX, offsetX, sliceFar));
+        Real minY = GTEMath::Min(GetTileEdgeViewCoord(tileY, tileCountY, scaleY, offsetY, sliceNear), GetTileEdgeViewCoord(tileY, tileCountY, scaleY, offsetY, sliceFar));
+        Real maxY = GTEMath::Max(GetTileEdgeViewCoord(tileY + 1, tileCountY, scaleY, offsetY, sliceNear), GetTileEdgeViewCoord(tileY + 1, tileCountY, scaleY, offsetY, sliceFar));
+        Real minZ = -sliceFar;
+        Real maxZ = -sliceNear;
+
+        Real dx = center.x < minX ? minX - center.x : (center.x > maxX ? center.x - maxX : 0);
+        Real dy = center.y < minY ? minY - center.y : (center.y > maxY ? center.y - maxY : 0);
+        Real dz = center.z < minZ ? minZ - center.z : (center.z > maxZ ? center.z - maxZ : 0);
+
+        return dx * dx + dy * dy + dz * dz <= radius * radius;
+    }
+
+    UInt32 LightClusterGrid::GetTileCountX() const {
+        return tileCountX;
+    }
+
+    UInt32 LightClusterGrid::GetTileCountY() const {
+        return tileCountY;
+    }
+
+    UInt32 LightClusterGrid::GetSliceCount() const {
+        return sliceCount;
+    }
+
+    UInt32 LightClusterGrid::GetClusterCount() const {
+        return clusterCount;
+    }
+
+    UInt32 LightClusterGrid::GetClusterIndex(UInt32 tileX, UInt32 tileY, UInt32 slice) const {
+        return (slice * tileCountY + tileY) * tileCountX + tileX;
+    }
+
+    /*
+     * Get the depth slice that contains view depth [depth]. Depths outside the range of the grid are
+     * clamped to the first or last slice.
+     */
+    UInt32 LightClusterGrid::GetSliceForDepth(Real depth) const {
+        if (depth <= nearDepth)return 0;
+
+        Int32 slice = (Int32)floorf(logf(depth) * sliceScale + sliceBias);
+        return (UInt32)GTEMath::Max(GTEMath::Min(slice, (Int32)sliceCount - 1), 0);
+    }
+
+    /*
+     * Get the view depth at which [slice] begins. Passing the slice count returns the far depth of the grid.
+     */
+    Real LightClusterGrid::GetSliceNearDepth(UInt32 slice) const {
+        if (slice >= sliceCount)return farDepth;
+        return nearDepth * powf(farDepth / nearDepth, (Real)slice / (Real)sliceCount);
+    }
+
+    Real LightClusterGrid::GetSliceScale() const {
+        return sliceScale;
+    }
+
+    Real LightClusterGrid::GetSliceBias() const {
+        return sliceBias;
+    }
+
+    UInt32 LightClusterGrid::GetClusterLightOffset(UInt32 cluster) const {
+        NONFATAL_ASSERT_RTRN(cluster < clusterCount, "LightClusterGrid::GetClusterLightOffset -> Cluster index is out of range.", 0, true);
+        return clusterLightOffsets[cluster];
+    }
+
+    UInt32 LightClusterGrid::GetClusterLightCount(UInt32 cluster) const {
+        NONFATAL_ASSERT_RTRN(cluster < clusterCount, "LightClusterGrid::GetClusterLightCount -> Cluster index is out of range.", 0, true);
+        return clusterLightCounts[cluster];
+    }
+
+    const UInt32 * LightClusterGrid::GetLightIndices() const {
+        return lightIndices;
+    }
+
+    UInt32 LightClusterGrid::GetLightIndexCount() const {
+        return lightIndexCount;
+    }
+
+    Bool LightClusterGrid::HasOverflowed() const {
+        return overflowed;
+    }
+}
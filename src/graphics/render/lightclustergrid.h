@@ -0,0 +1,100 @@
+/*
+ * class: LightClusterGrid
+ *
+ * author: Mark Kellogg
+ *
+ * Bins lights into the cells (clusters, or "froxels") of a 3D grid that subdivides the view frustum
+ * of a perspective camera, so that a shader can find the lights that can reach a fragment by looking
+ * up the cluster that contains it instead of evaluating every light in the scene.
+ *
+ * The grid has [tileCountX] x [tileCountY] screen-space tiles, evenly spaced in normalized device
+ * coordinates, and [sliceCount] depth slices that are spaced exponentially between the near and far
+ * depths of the view (so that clusters are roughly cube shaped). A fragment at view depth d is in slice:
+ *
+ *   floor(log(d) * sliceScale + sliceBias)
+ *
+ * Each light is a sphere given in view space (looking down -Z). It is added to every cluster whose
+ * bounding box it intersects, and the result is a single list of light indices, in which the lights
+ * of each cluster occupy a contiguous range (in the order in which they were passed to Build()).
+ *
+ * This class does not touch the graphics system, so that the binning can be verified on its own.
+ */
+
+#ifndef _GTE_LIGHT_CLUSTER_GRID_H_
+#define _GTE_LIGHT_CLUSTER_GRID_H_
+
+#include "engine.h"
+
+namespace GTE {
+    //forward declarations
+    class Point3;
+
+    class LightClusterGrid {
+        // number of screen-space tiles along each axis
+        UInt32 tileCountX;
+        UInt32 tileCountY;
+        // number of depth slices
+        UInt32 sliceCount;
+        // tileCountX * tileCountY * sliceCount
+        UInt32 clusterCount;
+        // maximum number of entries in [lightIndices]
+        UInt32 maxLightIndices;
+
+        // projection: ndc.x = scaleX * x / depth + offsetX (same for y)
+        Real scaleX;
+        Real scaleY;
+        Real offsetX;
+        Real offsetY;
+        Real nearDepth;
+        Real farDepth;
+        // parameters that map a view depth to a depth slice (see above)
+        Real sliceScale;
+        Real sliceBias;
+
+        // offset in [lightIndices] of the first light of each cluster
+        UInt32 * clusterLightOffsets;
+        // number of lights in each cluster
+        UInt32 * clusterLightCounts;
+        // the lights of each cluster, sorted by cluster
+        UInt32 * lightIndices;
+        // number of valid entries in [lightIndices]
+        UInt32 lightIndexCount;
+        // scratch space for Build(): the cluster and light of each (cluster, light) pair, in binning order
+        UInt32 * pairClusters;
+        UInt32 * pairLights;
+        // set if Build() found more (cluster, light) pairs than fit in [lightIndices]
+        Bool overflowed;
+
+        void Destroy();
+        Bool GetTileRange(Real minCoord, Real maxCoord, Real minDepth, Real maxDepth, Real scale, Real offset, UInt32 tileCount, UInt32& minTile, UInt32& maxTile) const;
+        Real GetTileEdgeViewCoord(UInt32 edge, UInt32 tileCount, Real scale, Real offset, Real depth) const;
+        Bool SphereIntersectsCluster(const Point3& center, Real radius, UInt32 tileX, UInt32 tileY, UInt32 slice) const;
+
+    public:
+
+        LightClusterGrid();
+        ~LightClusterGrid();
+
+        Bool Init(UInt32 tileCountX, UInt32 tileCountY, UInt32 sliceCount, UInt32 maxLightIndices);
+        void SetProjection(Real scaleX, Real scaleY, Real offsetX, Real offsetY, Real nearDepth, Real farDepth);
+        void Build(const Point3 * viewSpacePositions, const Real * radii, UInt32 lightCount);
+
+        UInt32 GetTileCountX() const;
+        UInt32 GetTileCountY() const;
+        UInt32 GetSliceCount() const;
+        UInt32 GetClusterCount() const;
+        UInt32 GetClusterIndex(UInt32 tileX, UInt32 tileY, UInt32 slice) const;
+        UInt32 GetSliceForDepth(Real depth) const;
+        Real GetSliceNearDepth(UInt32 slice) const;
+        Real GetSliceScale() const;
+        Real GetSliceBias() const;
+
+        UInt32 GetClusterLightOffset(UInt32 cluster) const;
+        UInt32 GetClusterLightCount(UInt32 cluster) const;
+        const UInt32 * GetLightIndices() const;
+        UInt32 GetLightIndexCount() const;
+        Bool HasOverflowed() const;
+    };
+}
+
+#endif
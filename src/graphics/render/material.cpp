@@ -100,6 +100,11 @@ namespace GTE {
 
         this->shader = shader;
 
+        // clustered lighting shaders read every light in a single pass
+        if (shader->UsesUniformBlock(StandardUniformBlock::ClusterLights)) {
+            singlePassMode = SinglePassMode::Standard;
+        }
+
         InitializeUniformDescriptors();
         InitializeAttributeDescriptors();
 
@@ -137,6 +142,8 @@ namespace GTE {
     */
     void Material::DestroyUniformDescriptors() {
         localUniformDescriptors.clear();
+        uniformDescriptorIndicesByID.clear();
+        uniformDescriptorIndicesByVarID.clear();
     }
 
     /*
@@ -310,15 +317,10 @@ namespace GTE {
     Int32 Material::GetLocalUniformDescriptorIndexByUniformID(UniformID uniform) const {
         NONFATAL_ASSERT_RTRN(shader.IsValid(), "Material::GetLocalUniformDescriptorIndexByUniformID -> Shader is invalid.", -1, true);
 
-        Int32 foundIndex = -1;
-        for (UInt32 i = 0; i < localUniformDescriptors.size(); i++) {
-            const UniformDescriptor& desc = localUniformDescriptors[i];
-            if (uniform == desc.RegisteredUniformID) {
-                foundIndex = (Int32)i;
-            }
-        }
+        auto result = uniformDescriptorIndicesByID.find(uniform);
+        if (result == uniformDescriptorIndicesByID.end())return -1;
 
-        return foundIndex;
+        return (Int32)(*result).second;
     }
 
     /*
@@ -328,15 +330,10 @@ namespace GTE {
     Int32 Material::GetLocalUniformDescriptorIndexByShaderVarID(UInt32 shaderVarID) const {
         NONFATAL_ASSERT_RTRN(shader.IsValid(), "Material::GetLocalUniformDescriptorIndexByShaderVarID -> Shader is invalid.", -1, true);
 
-        Int32 foundIndex = -1;
-        for (UInt32 i = 0; i < localUniformDescriptors.size(); i++) {
-            const UniformDescriptor& desc = localUniformDescriptors[i];
-            if (shaderVarID == desc.ShaderVarID) {
-                foundIndex = (Int32)i;
-            }
-        }
+        auto result = uniformDescriptorIndicesByVarID.find(shaderVarID);
+        if (result == uniformDescriptorIndicesByVarID.end())return -1;
 
-        return foundIndex;
+        return (Int32)(*result).second;
     }
 
     /*
@@ -369,7 +366,9 @@ namespace GTE {
 
         if ((UInt32)index < localUniformDescriptors.size()) {
             UniformDescriptor& desc = localUniformDescriptors[index];
+            uniformDescriptorIndicesByVarID.erase(desc.ShaderVarID);
             desc.ShaderVarID = varID;
+            uniformDescriptorIndicesByVarID[desc.ShaderVarID] = (UInt32)index;
         }
     }
 
@@ -448,10 +447,16 @@ namespace GTE {
         }
 
         standardUniforms = StandardUniforms::CreateUniformSet();
+        uniformDescriptorIndicesByID.clear();
+        uniformDescriptorIndicesByVarID.clear();
         for (UInt32 i = 0; i < localUniformDescriptors.size(); i++) {
             UniformDescriptor& desc = localUniformDescriptors[i];
             desc.RegisteredUniformID = UniformDirectory::RegisterVarID(desc.Name);
 
+            // index the descriptor so that uniforms don't have to be found by searching [localUniformDescriptors]
+            uniformDescriptorIndicesByID[desc.RegisteredUniformID] = i;
+            uniformDescriptorIndicesByVarID[desc.ShaderVarID] = i;
+
             StandardUniform uniform = UniformDirectory::GetStandardVar(desc.RegisteredUniformID);
             if (uniform != StandardUniform::_None) {
                 StandardUniforms::AddUniform(&standardUniforms, uniform);
@@ -473,6 +478,13 @@ namespace GTE {
         return standardAttributes;
     }
 
+    /*
+     * Does this material's shader have a variable bound to [attribute]?
+     */
+    Bool Material::UsesAttribute(AttributeID attribute) const {
+        return GetAttributeBinding(attribute) >= 0;
+    }
+
     /*
      * Send an array of vertex attributes held in [buffer] to this material's shader. This method
      * maps the standard attribute specified by [attr] to the corresponding shader var ID/location
@@ -489,6 +501,34 @@ namespace GTE {
         }
     }
 
+    /*
+     * Send the attribute [attribute], which is one of several attributes interleaved in [buffer], to this material's shader.
+     * [componentCount] is the number of components of the attribute, and [offset] is its offset (in Real values) within each vertex.
+     */
+    void Material::SendAttributeBufferToShader(AttributeID attribute, VertexAttrBuffer *buffer, UInt32 componentCount, UInt32 offset) {
+        NONFATAL_ASSERT(buffer != nullptr, "Material::SendAttributeBufferToShader -> 'buffer' is null.", true);
+
+        Int32 varID = GetAttributeBinding(attribute);
+        if (varID >= 0) {
+            shader->SendBufferToShader(varID, buffer, componentCount, offset);
+            SetAttributeSetValue(varID, buffer->GetRenderVertexCount());
+        }
+    }
+
+    /*
+     * Record that the attribute [attribute] of this material's shader reads from [buffer] without sending
+     * it to the shader. This is used when the attribute pointer is already part of the bound vertex array object,
+     * so that VerifySetVars() still sees the attribute as set.
+     */
+    void Material::SetAttributeBufferSent(AttributeID attribute, const VertexAttrBuffer *buffer) {
+        NONFATAL_ASSERT(buffer != nullptr, "Material::SetAttributeBufferSent -> 'buffer' is null.", true);
+
+        Int32 varID = GetAttributeBinding(attribute);
+        if (varID >= 0) {
+            SetAttributeSetValue(varID, buffer->GetRenderVertexCount());
+        }
+    }
+
     /*
      * Get a bit mask that indicates which standard uniforms are used by this material's shader
      */
@@ -550,6 +590,26 @@ namespace GTE {
         }
     }
 
+    /*
+     * Get a handle to the uniform with the name specified by [varName]. Setting a uniform's value through
+     * a handle avoids looking up the uniform by name or ID each time, so code that updates a uniform every
+     * frame should get its handle once and keep it. A handle is only valid for the material that issued it.
+     * The returned handle is invalid (see UniformHandle::IsValid()) if this material's shader has no such uniform.
+     */
+    UniformHandle Material::GetUniformHandle(const std::string& varName) const {
+        UniformID uniform = UniformDirectory::RegisterVarID(varName);
+        return GetUniformHandle(uniform);
+    }
+
+    /*
+     * Get a handle to the uniform specified by [uniform].
+     */
+    UniformHandle Material::GetUniformHandle(UniformID uniform) const {
+        UniformHandle handle;
+        handle.index = GetLocalUniformDescriptorIndexByUniformID(uniform);
+        return handle;
+    }
+
     /*
      * Find a uniform with the name specified by [varName] and set its
      * value to the sampler data held by [texture]
@@ -564,23 +624,48 @@ namespace GTE {
     * value to the sampler data held by [texture].
     */
     void Material::SetTexture(TextureRef texture, UniformID uniform) {
+        SetTexture(texture, GetUniformHandle(uniform));
+    }
+
+    /*
+    * Set the value of the uniform referred to by [handle] to the sampler data held by [texture].
+    */
+    void Material::SetTexture(TextureRef texture, UniformHandle handle) {
         NONFATAL_ASSERT(shader.IsValid(), "Material::SetTexture -> Shader is null.", true);
         NONFATAL_ASSERT(texture.IsValid(), "Material::SetTexture -> 'texture' is null.", true);
-
-        Int32 index = GetLocalUniformDescriptorIndexByUniformID(uniform);
-        NONFATAL_ASSERT(index >= 0, "Material::SetTexture -> Invalid uniform.", true);
+        NONFATAL_ASSERT(handle.index >= 0 && (UInt32)handle.index < localUniformDescriptors.size(), "Material::SetTexture -> Invalid uniform.", true);
 
         TextureAttributes textureAttributes = texture->GetAttributes();
 
-        UniformDescriptor& desc = localUniformDescriptors[index];
+        UniformDescriptor& desc = localUniformDescriptors[handle.index];
         if (textureAttributes.IsCube)desc.Type = UniformType::SamplerCube;
         else desc.Type = UniformType::Sampler2D;
         desc.SamplerData = texture;
-        desc.SamplerUnitIndex = ReserveSamplerUnitForUniform(uniform);
+        desc.SamplerUnitIndex = ReserveSamplerUnitForUniform(desc.RegisteredUniformID);
         desc.IsDelayedSet = true;
 
     }
 
+    /*
+     * Get a value that identifies the set of textures assigned to this material's samplers, and the sampler unit
+     * to which each is bound. Materials with the same set of textures produce the same value, so it can be used to
+     * group draw calls that don't require any texture binds between them.
+     */
+    UInt64 Material::GetTextureSetKey() const {
+        // FNV-1a hash of the (sampler unit, texture ID) pairs
+        UInt64 key = 14695981039346656037ULL;
+        for (UInt32 i = 0; i < localUniformDescriptors.size(); i++) {
+            const UniformDescriptor& desc = localUniformDescriptors[i];
+            if (!desc.IsDelayedSet || (desc.Type != UniformType::Sampler2D && desc.Type != UniformType::SamplerCube))continue;
+            if (!desc.SamplerData.IsValid())continue;
+
+            key = (key ^ desc.SamplerUnitIndex) * 1099511628211ULL;
+            key = (key ^ desc.SamplerData->GetObjectID()) * 1099511628211ULL;
+        }
+
+        return key;
+    }
+
     /*
      * Find a uniform with the name specified by [varName] and set its
      * value to the 4x4 matrix [val].
@@ -595,12 +680,17 @@ namespace GTE {
     * value to the 4x4 matrix [val].
     */
     void Material::SetMatrix4x4(const Matrix4x4& mat, UniformID uniform) {
-        NONFATAL_ASSERT(shader.IsValid(), "Material::SetMatrix4x4 -> Shader is null.", true);
+        SetMatrix4x4(mat, GetUniformHandle(uniform));
+    }
 
-        Int32 index = GetLocalUniformDescriptorIndexByUniformID(uniform);
-        NONFATAL_ASSERT(index >= 0, "Material::SetMatrix4x4 -> Invalid uniform.", true);
+    /*
+    * Set the value of the uniform referred to by [handle] to the 4x4 matrix [val].
+    */
+    void Material::SetMatrix4x4(const Matrix4x4& mat, UniformHandle handle) {
+        NONFATAL_ASSERT(shader.IsValid(), "Material::SetMatrix4x4 -> Shader is null.", true);
+        NONFATAL_ASSERT(handle.index >= 0 && (UInt32)handle.index < localUniformDescriptors.size(), "Material::SetMatrix4x4 -> Invalid uniform.", true);
 
-        UniformDescriptor& desc = localUniformDescriptors[index];
+        UniformDescriptor& desc = localUniformDescriptors[handle.index];
         desc.Type = UniformType::Matrix4x4;
         desc.MatrixData = mat;
         desc.IsDelayedSet = true;
@@ -620,12 +710,17 @@ namespace GTE {
     * value to the floating point value [val]
     */
     void Material::SetUniform1f(Real val, UniformID uniform) {
-        NONFATAL_ASSERT(shader.IsValid(), "Material::SetUniform1f -> 'shader' is null.", true);
+        SetUniform1f(val, GetUniformHandle(uniform));
+    }
 
-        Int32 index = GetLocalUniformDescriptorIndexByUniformID(uniform);
-        NONFATAL_ASSERT(index >= 0, "Material::SetUniform1f -> Invalid uniform.", true);
+    /*
+    * Set the value of the uniform referred to by [handle] to the floating point value [val].
+    */
+    void Material::SetUniform1f(Real val, UniformHandle handle) {
+        NONFATAL_ASSERT(shader.IsValid(), "Material::SetUniform1f -> 'shader' is null.", true);
+        NONFATAL_ASSERT(handle.index >= 0 && (UInt32)handle.index < localUniformDescriptors.size(), "Material::SetUniform1f -> Invalid uniform.", true);
 
-        UniformDescriptor & desc = localUniformDescriptors[index];
+        UniformDescriptor & desc = localUniformDescriptors[handle.index];
         desc.Type = UniformType::Float;
         desc.BasicFloatData[0] = val;
         desc.IsDelayedSet = true;
@@ -645,12 +740,17 @@ namespace GTE {
     * value to the vector made up of v1 & v2.
     */
     void Material::SetUniform2f(Real v1, Real v2, UniformID uniform) {
-        NONFATAL_ASSERT(shader.IsValid(), "Material::SetUniform2f -> 'shader' is null.", true);
+        SetUniform2f(v1, v2, GetUniformHandle(uniform));
+    }
 
-        Int32 index = GetLocalUniformDescriptorIndexByUniformID(uniform);
-        NONFATAL_ASSERT(index >= 0, "Material::SetUniform2f -> Invalid uniform.", true);
+    /*
+    * Set the value of the uniform referred to by [handle] to the vector made up of v1 & v2.
+    */
+    void Material::SetUniform2f(Real v1, Real v2, UniformHandle handle) {
+        NONFATAL_ASSERT(shader.IsValid(), "Material::SetUniform2f -> 'shader' is null.", true);
+        NONFATAL_ASSERT(handle.index >= 0 && (UInt32)handle.index < localUniformDescriptors.size(), "Material::SetUniform2f -> Invalid uniform.", true);
 
-        UniformDescriptor& desc = localUniformDescriptors[index];
+        UniformDescriptor& desc = localUniformDescriptors[handle.index];
         desc.Type = UniformType::Float2;
         desc.BasicFloatData[0] = v1;
         desc.BasicFloatData[1] = v2;
@@ -671,12 +771,17 @@ namespace GTE {
     * value to the vector made up of v1 & v2 & v.
     */
     void Material::SetUniform3f(Real v1, Real v2, Real v3, UniformID uniform) {
-        NONFATAL_ASSERT(shader.IsValid(), "Material::SetUniform3f -> 'shader' is null.", true);
+        SetUniform3f(v1, v2, v3, GetUniformHandle(uniform));
+    }
 
-        Int32 index = GetLocalUniformDescriptorIndexByUniformID(uniform);
-        NONFATAL_ASSERT(index >= 0, "Material::SetUniform3f -> Invalid uniform.", true);
+    /*
+    * Set the value of the uniform referred to by [handle] to the vector made up of v1 & v2 & v3.
+    */
+    void Material::SetUniform3f(Real v1, Real v2, Real v3, UniformHandle handle) {
+        NONFATAL_ASSERT(shader.IsValid(), "Material::SetUniform3f -> 'shader' is null.", true);
+        NONFATAL_ASSERT(handle.index >= 0 && (UInt32)handle.index < localUniformDescriptors.size(), "Material::SetUniform3f -> Invalid uniform.", true);
 
-        UniformDescriptor& desc = localUniformDescriptors[index];
+        UniformDescriptor& desc = localUniformDescriptors[handle.index];
         desc.Type = UniformType::Float3;
         desc.BasicFloatData[0] = v1;
         desc.BasicFloatData[1] = v2;
@@ -698,12 +803,17 @@ namespace GTE {
     * value to the vector made up of v1 & v2 & v3 &v4.
     */
     void Material::SetUniform4f(Real v1, Real v2, Real v3, Real v4, UniformID uniform) {
-        NONFATAL_ASSERT(shader.IsValid(), "Material::SetUniform4f -> 'shader' is null.", true);
+        SetUniform4f(v1, v2, v3, v4, GetUniformHandle(uniform));
+    }
 
-        Int32 index = GetLocalUniformDescriptorIndexByUniformID(uniform);
-        NONFATAL_ASSERT(index >= 0, "Material::SetUniform4f -> Invalid uniform.", true);
+    /*
+    * Set the value of the uniform referred to by [handle] to the vector made up of v1 & v2 & v3 &v4.
+    */
+    void Material::SetUniform4f(Real v1, Real v2, Real v3, Real v4, UniformHandle handle) {
+        NONFATAL_ASSERT(shader.IsValid(), "Material::SetUniform4f -> 'shader' is null.", true);
+        NONFATAL_ASSERT(handle.index >= 0 && (UInt32)handle.index < localUniformDescriptors.size(), "Material::SetUniform4f -> Invalid uniform.", true);
 
-        UniformDescriptor& desc = localUniformDescriptors[index];
+        UniformDescriptor& desc = localUniformDescriptors[handle.index];
         desc.Type = UniformType::Float4;
         desc.BasicFloatData[0] = v1;
         desc.BasicFloatData[1] = v2;
@@ -726,18 +836,14 @@ namespace GTE {
     * value to the color [color].
     */
     void Material::SetColor(const Color4& color, UniformID uniform) {
-        NONFATAL_ASSERT(shader.IsValid(), "Material::SetColor -> 'shader' is null.", true);
-
-        Int32 index = GetLocalUniformDescriptorIndexByUniformID(uniform);
-        NONFATAL_ASSERT(index >= 0, "Material::SetUniform4f -> Invalid uniform.", true);
+        SetColor(color, GetUniformHandle(uniform));
+    }
 
-        UniformDescriptor& desc = localUniformDescriptors[index];
-        desc.Type = UniformType::Float4;
-        desc.BasicFloatData[0] = color.r;
-        desc.BasicFloatData[1] = color.g;
-        desc.BasicFloatData[2] = color.b;
-        desc.BasicFloatData[3] = color.a;
-        desc.IsDelayedSet = true;
+    /*
+    * Set the value of the uniform referred to by [handle] to the color [color].
+    */
+    void Material::SetColor(const Color4& color, UniformHandle handle) {
+        SetUniform4f(color.r, color.g, color.b, color.a, handle);
     }
 
     /*
@@ -851,6 +957,65 @@ namespace GTE {
         }
     }
 
+    /*
+     * Send the bone transformations in [palette] to this material's shader via the standard uniform
+     * SkinningPalette. Each of the [boneCount] transformations is a 3x4 affine matrix stored as three
+     * rows of four values, so the palette is sent as an array of (3 * [boneCount]) 4-component vectors.
+     */
+    void Material::SendSkinningPaletteToShader(const Real * palette, UInt32 boneCount) {
+        NONFATAL_ASSERT(shader.IsValid(), "Material::SendSkinningPaletteToShader -> 'shader' is null.", true);
+        NONFATAL_ASSERT(palette != nullptr, "Material::SendSkinningPaletteToShader -> 'palette' is null.", true);
+
+        Int32 varID = GetUniformBinding(UniformDirectory::GetStandardVarID(StandardUniform::SkinningPalette));
+        if (varID >= 0) {
+            shader->SendUniformToShader4FV(varID, palette, boneCount * 3);
+            SetUniformSetValue(varID, GetRequiredUniformSize(UniformType::Float4));
+        }
+    }
+
+    /*
+     * Does this material's shader perform vertex skinning, i.e. does it have the standard uniform SkinningPalette
+     * and the standard attributes BoneIndices and BoneWeights?
+     */
+    Bool Material::SupportsGPUSkinning() const {
+        return StandardUniforms::HasUniform(standardUniforms, StandardUniform::SkinningPalette) &&
+            StandardAttributes::HasAttribute(standardAttributes, StandardAttribute::BoneIndices) &&
+            StandardAttributes::HasAttribute(standardAttributes, StandardAttribute::BoneWeights);
+    }
+
+    /*
+     * Send the model transformations in [transforms] to this material's shader via the standard uniform
+     * InstanceTransforms. Like the skinning palette, each of the [instanceCount] transformations is a 3x4
+     * affine matrix stored as three rows of four values.
+     */
+    void Material::SendInstanceTransformsToShader(const Real * transforms, UInt32 instanceCount) {
+        NONFATAL_ASSERT(shader.IsValid(), "Material::SendInstanceTransformsToShader -> 'shader' is null.", true);
+        NONFATAL_ASSERT(transforms != nullptr, "Material::SendInstanceTransformsToShader -> 'transforms' is null.", true);
+
+        Int32 varID = GetUniformBinding(UniformDirectory::GetStandardVarID(StandardUniform::InstanceTransforms));
+        if (varID >= 0) {
+            shader->SendUniformToShader4FV(varID, transforms, instanceCount * 3);
+            SetUniformSetValue(varID, GetRequiredUniformSize(UniformType::Float4));
+        }
+    }
+
+    /*
+     * Can this material's shader render multiple instances of a mesh in a single draw call, i.e. does
+     * it have the standard uniform InstanceTransforms?
+     */
+    Bool Material::SupportsInstancing() const {
+        return StandardUniforms::HasUniform(standardUniforms, StandardUniform::InstanceTransforms);
+    }
+
+    /*
+     * Does this material's shader declare the standard uniform block [block]? If so, the members of
+     * that block are read from the uniform buffer at the block's binding point and do not need to be sent.
+     */
+    Bool Material::UsesUniformBlock(StandardUniformBlock block) const {
+        NONFATAL_ASSERT_RTRN(shader.IsValid(), "Material::UsesUniformBlock -> 'shader' is null.", false, true);
+        return shader->UsesUniformBlock(block);
+    }
+
     void Material::SendLightToShader(const Real * positions, const Real * directions, const Int32 * lightTypes,
                                      const Real* colors, const Real * intensities, const Real * ranges, const Real * attenuations,
                                      const Int32 * parallelAngleAttenuations, const Int32 * orthoAngleAttenuations, const Int32* enabled) {
@@ -35,6 +35,7 @@
 
 #include <vector>
 #include <map>
+#include <unordered_map>
 #include <string>
 
 namespace GTE {
@@ -52,15 +53,47 @@ namespace GTE {
 
         VertexAttrBuffer * Buffer;
         AttributeID RegisteredAttributeID;
+        // for an attribute in an interleaved buffer: the number of components of the attribute, 0 otherwise
+        UInt32 ComponentCount;
+        // for an attribute in an interleaved buffer: the offset (in Real values) of the attribute within each vertex
+        UInt32 Offset;
 
         VertexAttrBufferBinding() {
             Buffer = nullptr;
             RegisteredAttributeID = AttributeDirectory::VarID_Invalid;
+            ComponentCount = 0;
+            Offset = 0;
         }
 
         VertexAttrBufferBinding(VertexAttrBuffer * buffer, AttributeID id) {
             this->Buffer = buffer;
             this->RegisteredAttributeID = id;
+            this->ComponentCount = 0;
+            this->Offset = 0;
+        }
+
+        VertexAttrBufferBinding(VertexAttrBuffer * buffer, AttributeID id, UInt32 componentCount, UInt32 offset) {
+            this->Buffer = buffer;
+            this->RegisteredAttributeID = id;
+            this->ComponentCount = componentCount;
+            this->Offset = offset;
+        }
+    };
+
+    class UniformHandle {
+        friend class Material;
+
+        // index of the uniform in the material's list of uniform descriptors, or -1 if the handle is invalid
+        Int32 index;
+
+    public:
+
+        UniformHandle() {
+            index = -1;
+        }
+
+        Bool IsValid() const {
+            return index >= 0;
         }
     };
 
@@ -100,6 +133,10 @@ namespace GTE {
         // a vector of UniformDescriptor objects that describe uniforms exposed by this
         // material's shader
         std::vector<UniformDescriptor> localUniformDescriptors;
+        // map the registered ID of each uniform to its index in [localUniformDescriptors]
+        std::unordered_map<UniformID, UInt32> uniformDescriptorIndicesByID;
+        // map the shader var ID/location of each uniform to its index in [localUniformDescriptors]
+        std::unordered_map<UInt32, UInt32> uniformDescriptorIndicesByVarID;
 
         // a vector of AttributeDescriptor objects that describe attributes exposed by this
         // material's shader
@@ -176,9 +213,13 @@ namespace GTE {
         void ResetVerificationState();
 
         ShaderRef GetShader();
+        UInt64 GetTextureSetKey() const;
 
         StandardAttributeSet GetStandardAttributes() const;
+        Bool UsesAttribute(AttributeID attribute) const;
         void SendAttributeBufferToShader(AttributeID, VertexAttrBuffer *buffer);
+        void SendAttributeBufferToShader(AttributeID, VertexAttrBuffer *buffer, UInt32 componentCount, UInt32 offset);
+        void SetAttributeBufferSent(AttributeID, const VertexAttrBuffer *buffer);
 
         StandardUniformSet GetStandardUniforms() const;
         void SendClipPlaneCountToShader(UInt32 count);
@@ -189,6 +230,11 @@ namespace GTE {
         void SendViewMatrixToShader(const Matrix4x4& mat);
         void SendProjectionMatrixToShader(const Matrix4x4& mat);
         void SendMVPMatrixToShader(const Matrix4x4& mat);
+        void SendSkinningPaletteToShader(const Real * palette, UInt32 boneCount);
+        Bool SupportsGPUSkinning() const;
+        void SendInstanceTransformsToShader(const Real * transforms, UInt32 instanceCount);
+        Bool SupportsInstancing() const;
+        Bool UsesUniformBlock(StandardUniformBlock block) const;
         void SendLightToShader(const Real * positions, const Real * directions, const Int32 * lightTypes,
                                const Real* colors, const Real * intensities, const Real * ranges, const Real * attenuations,
                                const Int32 * parallelAngleAttenuations, const Int32 * orthoAngleAttenuations, const Int32* enabled);
@@ -200,20 +246,30 @@ namespace GTE {
 
         void SendAllStoredUniformValuesToShader();
 
+        UniformHandle GetUniformHandle(const std::string& varName) const;
+        UniformHandle GetUniformHandle(UniformID uniformID) const;
+
         void SetTexture(TextureRef texture, const std::string& varName);
         void SetTexture(TextureRef texture, UniformID uniformID);
+        void SetTexture(TextureRef texture, UniformHandle handle);
         void SetMatrix4x4(const Matrix4x4& mat, const std::string& varName);
         void SetMatrix4x4(const Matrix4x4& mat, UniformID uniformID);
+        void SetMatrix4x4(const Matrix4x4& mat, UniformHandle handle);
         void SetUniform1f(Real val, const std::string& varName);
         void SetUniform1f(Real val, UniformID uniformID);
+        void SetUniform1f(Real val, UniformHandle handle);
         void SetUniform2f(Real v1, Real v2, const std::string& varName);
         void SetUniform2f(Real v1, Real v2, UniformID uniformID);
+        void SetUniform2f(Real v1, Real v2, UniformHandle handle);
         void SetUniform3f(Real v1, Real v2, Real v3, const std::string& varName);
         void SetUniform3f(Real v1, Real v2, Real v3, UniformID uniformID);
+        void SetUniform3f(Real v1, Real v2, Real v3, UniformHandle handle);
         void SetUniform4f(Real v1, Real v2, Real v3, Real v4, const std::string& varName);
         void SetUniform4f(Real v1, Real v2, Real v3, Real v4, UniformID uniformID);
+        void SetUniform4f(Real v1, Real v2, Real v3, Real v4, UniformHandle handle);
         void SetColor(const Color4& color, const std::string& varName);
         void SetColor(const Color4& color, UniformID uniformID);
+        void SetColor(const Color4& color, UniformHandle handle);
 
         Bool VerifySetVars(UInt32 vertexCount);
 
@@ -1,3 +1,5 @@
+#include <string.h>
+
 #include "renderqueue.h"
 #include "base/bitmask.h"
 #include "global/global.h"
@@ -10,6 +12,8 @@ namespace GTE {
         this->id = id;
         this->increaseCount = increaseCount;
         renderObjects = nullptr;
+        order = nullptr;
+        sortScratch = nullptr;
         totalCount = 0;
         realCount = 0;
 
@@ -18,6 +22,8 @@ namespace GTE {
 
     RenderQueue::~RenderQueue() {
         SAFE_DELETE_ARRAY(renderObjects);
+        SAFE_DELETE_ARRAY(order);
+        SAFE_DELETE_ARRAY(sortScratch);
     }
 
     UInt32 RenderQueue::GetID() {
@@ -32,21 +38,33 @@ namespace GTE {
         RenderQueueEntry * temp = new (std::nothrow) RenderQueueEntry[totalCount + count];
         ASSERT(temp != nullptr, "RenderQueue::IncreaseCount -> Unable to allocate render queue entries.");
 
+        UInt32 * tempOrder = new (std::nothrow) UInt32[totalCount + count];
+        ASSERT(tempOrder != nullptr, "RenderQueue::IncreaseCount -> Unable to allocate render order.");
+
+        UInt32 * tempScratch = new (std::nothrow) UInt32[totalCount + count];
+        ASSERT(tempScratch != nullptr, "RenderQueue::IncreaseCount -> Unable to allocate sort scratch space.");
+
         if (renderObjects == nullptr) {
             renderObjects = temp;
         }
         else {
             for (UInt32 i = 0; i < realCount; i++) {
                 temp[i] = renderObjects[i];
+                tempOrder[i] = order[i];
             }
             delete[] renderObjects;
             renderObjects = temp;
         }
 
+        SAFE_DELETE_ARRAY(order);
+        SAFE_DELETE_ARRAY(sortScratch);
+        order = tempOrder;
+        sortScratch = tempScratch;
+
         totalCount += count;
     }
 
-    void RenderQueue::Add(SceneObject* container, SubMesh3D* mesh, SubMesh3DRenderer* renderer, MaterialSharedPtr* renderMaterial, Mesh3DFilter* meshFilter, Transform* aggregateTransform) {
+    void RenderQueue::Add(SceneObject* container, SubMesh3D* mesh, SubMesh3DRenderer* renderer, MaterialSharedPtr* renderMaterial, UInt32 materialIndex, Mesh3DFilter* meshFilter, Transform* aggregateTransform) {
         if (realCount >= totalCount) {
             IncreaseCount(64);
         }
@@ -56,17 +74,74 @@ namespace GTE {
         entry.Mesh = mesh;
         entry.Renderer = renderer;
         entry.RenderMaterial = renderMaterial;
+        entry.MaterialIndex = materialIndex;
         entry.MeshFilter = meshFilter;
+        entry.FrustumCulled = false;
+        entry.SequenceIndex = 0;
+        entry.SortKey = 0;
+        order[realCount] = realCount;
         realCount++;
     }
 
     RenderQueueEntry* RenderQueue::GetObject(UInt32 index) {
         NONFATAL_ASSERT_RTRN(index < realCount, "RenderQueue::GetObject -> 'index' is out of range.", nullptr, true);
-        return renderObjects + index;
+        return renderObjects + order[index];
     }
 
     UInt32 RenderQueue::GetObjectCount() {
         return realCount;
     }
+
+    /*
+     * Sort the entries in this queue in ascending order of their SortKey values, which changes the order
+     * in which GetObject() returns them. The entries themselves are not moved.
+     *
+     * This is a stable LSD radix sort that processes [RadixBits] bits of the key per pass. The histograms
+     * for all passes are built up front, so passes over digits that are the same for every key (which is
+     * common, e.g. for the bits that hold the queue ID) can be skipped.
+     */
+    void RenderQueue::Sort() {
+        if (realCount < 2)return;
+
+        UInt32 offsets[RadixPasses][RadixSize];
+        memset(offsets, 0, sizeof(offsets));
+
+        for (UInt32 i = 0; i < realCount; i++) {
+            UInt64 key = renderObjects[i].SortKey;
+            for (UInt32 p = 0; p < RadixPasses; p++) {
+                offsets[p][(key >> (p * RadixBits)) & (RadixSize - 1)]++;
+            }
+        }
+
+        UInt32 * source = order;
+        UInt32 * dest = sortScratch;
+        for (UInt32 p = 0; p < RadixPasses; p++) {
+            UInt32 * digitOffsets = offsets[p];
+            UInt32 shift = p * RadixBits;
+
+            // every key has the same value for this digit
+            if (digitOffsets[(renderObjects[source[0]].SortKey >> shift) & (RadixSize - 1)] == realCount)continue;
+
+            // convert the digit counts into the position of the first entry with each digit value
+            UInt32 offset = 0;
+            for (UInt32 d = 0; d < RadixSize; d++) {
+                UInt32 count = digitOffsets[d];
+                digitOffsets[d] = offset;
+                offset += count;
+            }
+
+            for (UInt32 i = 0; i < realCount; i++) {
+                UInt32 index = source[i];
+                dest[digitOffsets[(renderObjects[index].SortKey >> shift) & (RadixSize - 1)]++] = index;
+            }
+
+            UInt32 * temp = source;
+            source = dest;
+            dest = temp;
+        }
+
+        order = source;
+        sortScratch = dest;
+    }
 }
 
@@ -29,28 +29,55 @@ namespace GTE {
             Mesh = nullptr;
             Renderer = nullptr;
             RenderMaterial = nullptr;
+            MaterialIndex = 0;
             MeshFilter = nullptr;
+            FrustumCulled = false;
+            SequenceIndex = 0;
+            SortKey = 0;
         }
 
-        RenderQueueEntry(SceneObject* container, SubMesh3D* mesh, SubMesh3DRenderer* renderer, MaterialSharedPtr* renderMaterial, Mesh3DFilter* meshFilter, Transform* aggregateTransform) {
+        RenderQueueEntry(SceneObject* container, SubMesh3D* mesh, SubMesh3DRenderer* renderer, MaterialSharedPtr* renderMaterial, UInt32 materialIndex, Mesh3DFilter* meshFilter, Transform* aggregateTransform) {
             Container = container;
             Mesh = mesh;
             Renderer = renderer;
             RenderMaterial = renderMaterial;
+            MaterialIndex = materialIndex;
             MeshFilter = meshFilter;
+            FrustumCulled = false;
+            SequenceIndex = 0;
+            SortKey = 0;
         }
 
         SceneObject* Container;
         SubMesh3D* Mesh;
         SubMesh3DRenderer* Renderer;
         MaterialSharedPtr* RenderMaterial;
+        // index of [RenderMaterial] in the multi-material of [Renderer]; a multi-material may list the same material more than once
+        UInt32 MaterialIndex;
         Mesh3DFilter* MeshFilter;
+        // set when the bounds of [Mesh] lie completely outside the frustum of the current view
+        Bool FrustumCulled;
+        // position of this entry in the overall render order of the current frame
+        UInt32 SequenceIndex;
+        // packed key that determines the position of this entry in its queue after RenderQueue::Sort()
+        UInt64 SortKey;
     };
 
     class RenderQueue {
     protected:
 
+        // number of bits in each digit of a sort key processed by a single radix sort pass
+        static const UInt32 RadixBits = 8;
+        // number of buckets in each radix sort pass
+        static const UInt32 RadixSize = 1 << RadixBits;
+        // number of radix sort passes required to sort a 64-bit key
+        static const UInt32 RadixPasses = 64 / RadixBits;
+
         RenderQueueEntry * renderObjects;
+        // indices into [renderObjects] in render order; entries are never moved, since other structures point to them
+        UInt32 * order;
+        // scratch space for Sort()
+        UInt32 * sortScratch;
         UInt32 id;
         UInt32 realCount;
         UInt32 totalCount;
@@ -65,9 +92,10 @@ namespace GTE {
 
         UInt32 GetID();
         void Clear();
-        void Add(SceneObject* container, SubMesh3D* mesh, SubMesh3DRenderer* renderer, MaterialSharedPtr* renderMaterial, Mesh3DFilter* meshFilter, Transform* aggregateTransform);
+        void Add(SceneObject* container, SubMesh3D* mesh, SubMesh3DRenderer* renderer, MaterialSharedPtr* renderMaterial, UInt32 materialIndex, Mesh3DFilter* meshFilter, Transform* aggregateTransform);
         RenderQueueEntry* GetObject(UInt32 index);
         UInt32 GetObjectCount();
+        void Sort();
     };
 }
 #endif
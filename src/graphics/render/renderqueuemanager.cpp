@@ -28,6 +28,18 @@ namespace GTE {
         }
     }
 
+    /*
+    * Sort the entries of each render queue by their sort keys.
+    */
+    void RenderQueueManager::SortAllRenderQueues() {
+        for (UInt32 i = 0; i < renderQueueCount; i++) {
+            RenderQueue* queue = renderQueues[i];
+            NONFATAL_ASSERT(queue != nullptr, "RenderQueueManager::SortAllRenderQueues -> Null render queue encountered.", true);
+
+            queue->Sort();
+        }
+    }
+
     /*
     * Get the queue ID of the render queue at [index].
     */
@@ -139,6 +139,7 @@ namespace GTE {
         RenderQueue* GetRenderQueueForID(UInt32 id);
         RenderQueue* GetRenderQueueAtIndex(UInt32 index);
         void ClearAllRenderQueues();
+        void SortAllRenderQueues();
         void DestroyRenderQueues();
 
         UInt32 GetRenderQueueCount() const;
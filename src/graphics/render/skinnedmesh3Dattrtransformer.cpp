@@ -6,14 +6,19 @@
 #include "graphics/animation/skeleton.h"
 #include "graphics/animation/sceneobjectskeletonnode.h"
 #include "graphics/animation/bone.h"
+#include "material.h"
 #include "base/basevectorarray.h"
 #include "geometry/transform.h"
+#include "geometry/quaternion.h"
 #include "geometry/sceneobjecttransform.h"
 #include "geometry/point/point3.h"
 #include "geometry/vector/vector3.h"
 #include "scene/sceneobject.h"
 #include "global/assert.h"
 #include "util/time.h"
+#include "util/workerpool.h"
+#include "gtemath/gtemath.h"
+#include "gtemath/gtesimd.h"
 
 namespace GTE {
     /*
@@ -25,13 +30,18 @@ namespace GTE {
         currentCacheSize = -1;
 
         boneTransformed = nullptr;
+        boneMatrices = nullptr;
+        boneDualQuaternions = nullptr;
+        boneScales = nullptr;
         savedTransforms = nullptr;
+        packedBoneStreamDirty = true;
+        boneBoundsDirty = true;
         identicalNormalFlags = nullptr;
         identicalTangentFlags = nullptr;
-
-        cacheFlags = nullptr;
+        gpuSkinningActive = false;
 
         renderer = nullptr;
+        subMeshIndex = -1;
     }
 
     /*
@@ -43,13 +53,18 @@ namespace GTE {
         currentCacheSize = -1;
 
         boneTransformed = nullptr;
+        boneMatrices = nullptr;
+        boneDualQuaternions = nullptr;
+        boneScales = nullptr;
         savedTransforms = nullptr;
+        packedBoneStreamDirty = true;
+        boneBoundsDirty = true;
         identicalNormalFlags = nullptr;
         identicalTangentFlags = nullptr;
-
-        cacheFlags = nullptr;
+        gpuSkinningActive = false;
 
         renderer = nullptr;
+        subMeshIndex = -1;
     }
 
     /*
@@ -71,14 +86,19 @@ namespace GTE {
     }
 
     /*
-     * Destroy the array of bone transformation flags in [boneTransformed].
+     * Destroy the array of bone transformation flags in [boneTransformed] and the bone
+     * transformations in [boneMatrices], [boneDualQuaternions] and [boneScales].
      */
     void SkinnedMesh3DAttributeTransformer::DestroyTransformedBoneFlagsArray() {
         SAFE_DELETE_ARRAY(boneTransformed);
+        SAFE_DELETE_ARRAY(boneMatrices);
+        SAFE_DELETE_ARRAY(boneDualQuaternions);
+        SAFE_DELETE_ARRAY(boneScales);
     }
 
     /*
-     * Create the bone transformation flags array [boneTransformed].
+     * Create the bone transformation flags array [boneTransformed] and the bone transformations arrays [boneMatrices],
+     * [boneDualQuaternions] and [boneScales].
      */
     Bool SkinnedMesh3DAttributeTransformer::CreateTransformedBoneFlagsArray() {
         if (renderer != nullptr && renderer->GetSkeleton().IsValid()) {
@@ -86,6 +106,26 @@ namespace GTE {
             boneCount = skeleton->GetBoneCount();
             boneTransformed = new(std::nothrow) UChar[boneCount];
             ASSERT(boneTransformed != nullptr, "SkinnedMesh3DAttributeTransformer::CreateTransformedBoneFlagsArray -> Unable to allocate flags array.");
+            boneMatrices = new(std::nothrow) Real[(boneCount + 2) * AffineMatrixSize];
+            ASSERT(boneMatrices != nullptr, "SkinnedMesh3DAttributeTransformer::CreateTransformedBoneFlagsArray -> Unable to allocate bone transformations array.");
+
+            // the all-zero matrix for unused bone slots, followed by the identity matrix for vertices without bones
+            Matrix4x4 identity;
+            memset(boneMatrices + boneCount * AffineMatrixSize, 0, sizeof(Real) * AffineMatrixSize);
+            StoreAffineMatrix(identity, boneMatrices + (boneCount + 1) * AffineMatrixSize);
+
+            boneDualQuaternions = new(std::nothrow) Real[(boneCount + 2) * DualQuaternionSize];
+            ASSERT(boneDualQuaternions != nullptr, "SkinnedMesh3DAttributeTransformer::CreateTransformedBoneFlagsArray -> Unable to allocate bone dual quaternions array.");
+            boneScales = new(std::nothrow) Real[boneCount + 2];
+            ASSERT(boneScales != nullptr, "SkinnedMesh3DAttributeTransformer::CreateTransformedBoneFlagsArray -> Unable to allocate bone scales array.");
+
+            // the same two extra entries for dual quaternion skinning
+            memset(boneDualQuaternions + boneCount * DualQuaternionSize, 0, sizeof(Real) * DualQuaternionSize * 2);
+            boneDualQuaternions[(boneCount + 1) * DualQuaternionSize + 3] = 1.0f;
+            boneScales[boneCount] = 0.0f;
+            boneScales[boneCount + 1] = 1.0f;
+
+            packedBoneStreamDirty = true;
             return true;
         }
 
@@ -166,7 +206,7 @@ namespace GTE {
             return true;
         }
         else if (target == CacheType::Transform) {
-            savedTransforms = new(std::nothrow) Matrix4x4[count];
+            savedTransforms = new(std::nothrow) Real[count * AffineMatrixSize];
             ASSERT(savedTransforms != nullptr, "SkinnedMesh3DAttributeTransformer::CreateCache -> Could not saved transform array.");
 
             return true;
@@ -176,25 +216,341 @@ namespace GTE {
     }
 
     /*
-     * Clear the flag array specified by [target].
+     * Find the first vertex that is an instance of each unique vertex. Only the first instance of a unique vertex
+     * is fully skinned, all other instances re-use its results. The results are stored in [uniqueVertexFirstInstances]
+     * and [firstInstances].
      */
-    void SkinnedMesh3DAttributeTransformer::ClearCacheFlags() {
-        SetAllTransformCacheFlags(0);
+    void SkinnedMesh3DAttributeTransformer::FindFirstInstances() {
+        ASSERT(renderer != nullptr, "SkinnedMesh3DAttributeTransformer::FindFirstInstances -> Renderer is null.");
+
+        // retrieve this instance's vertex bone map
+        VertexBoneMap * vertexBoneMap = renderer->GetVertexBoneMap(vertexBoneMapIndex);
+        ASSERT(vertexBoneMap != nullptr, "SkinnedMesh3DAttributeTransformer::FindFirstInstances -> No valid vertex bone map found for sub mesh.");
+
+        UInt32 uniqueVertexCount = vertexBoneMap->GetUniqueVertexCount();
+        UInt32 vertexCount = vertexBoneMap->GetVertexCount();
+
+        uniqueVertexFirstInstances.assign(uniqueVertexCount, vertexCount);
+        firstInstances.clear();
+
+        for (UInt32 i = 0; i < vertexCount; i++) {
+            VertexBoneMap::VertexMappingDescriptor *desc = vertexBoneMap->GetDescriptor(i);
+            if (uniqueVertexFirstInstances[desc->UniqueVertexIndex] == vertexCount) {
+                uniqueVertexFirstInstances[desc->UniqueVertexIndex] = i;
+                firstInstances.push_back(i);
+            }
+        }
     }
 
     /*
-     * Set all the flags in the array specified by [target] to be [value].
+     * Pack the bone attachments of each vertex in [firstInstances] into [packedBoneIndices] and [packedBoneWeights]. Every
+     * vertex gets exactly four entries: unused slots reference the all-zero matrix in [boneMatrices] with a weight of zero,
+     * and vertices that are not attached to any bones reference the identity matrix with a weight of one.
      */
-    void SkinnedMesh3DAttributeTransformer::SetAllTransformCacheFlags(UChar value) {
-        ASSERT(renderer != nullptr, "SkinnedMesh3DAttributeTransformer::SetAllTransformCacheFlags -> Renderer is null.");
+    void SkinnedMesh3DAttributeTransformer::BuildPackedBoneStream() {
+        ASSERT(renderer != nullptr, "SkinnedMesh3DAttributeTransformer::BuildPackedBoneStream -> Renderer is null.");
 
         // retrieve this instance's vertex bone map
         VertexBoneMap * vertexBoneMap = renderer->GetVertexBoneMap(vertexBoneMapIndex);
-        ASSERT(vertexBoneMap != nullptr, "SkinnedMesh3DAttributeTransformer::SetAllTransformCacheFlags -> No valid vertex bone map found for sub mesh.");
+        ASSERT(vertexBoneMap != nullptr, "SkinnedMesh3DAttributeTransformer::BuildPackedBoneStream -> No valid vertex bone map found for sub mesh.");
 
-        UInt32 count = vertexBoneMap->GetUniqueVertexCount();
+        UInt32 zeroBoneIndex = (UInt32)boneCount;
+        UInt32 identityBoneIndex = (UInt32)boneCount + 1;
+
+        packedBoneIndices.resize(firstInstances.size() * 4);
+        packedBoneWeights.resize(firstInstances.size() * 4);
+
+        for (UInt32 f = 0; f < firstInstances.size(); f++) {
+            VertexBoneMap::VertexMappingDescriptor *desc = vertexBoneMap->GetDescriptor(firstInstances[f]);
+            UInt32 * indices = &packedBoneIndices[f * 4];
+            Real * weights = &packedBoneWeights[f * 4];
+
+            for (UInt32 b = 0; b < 4; b++) {
+                if (b < desc->BoneCount && desc->BoneIndex[b] < (UInt32)boneCount) {
+                    indices[b] = desc->BoneIndex[b];
+                    weights[b] = desc->Weight[b];
+                }
+                else {
+                    indices[b] = zeroBoneIndex;
+                    weights[b] = 0.0f;
+                }
+            }
+
+            if (desc->BoneCount == 0) {
+                indices[0] = identityBoneIndex;
+                weights[0] = 1.0f;
+            }
+        }
+
+        packedBoneStreamDirty = false;
+        boneBoundsDirty = true;
+    }
+
+    /*
+     * Calculate the bind-pose bounding box of the vertices attached to each entry in [boneMatrices] (with a non-zero weight),
+     * using the (untransformed) vertex positions in [positions]. The bone attachments are taken from [packedBoneIndices]
+     * and [packedBoneWeights], so the results are stored in [boneBounds] for the skeleton's bones as well as for the
+     * identity matrix that is used by vertices without bones.
+     */
+    void SkinnedMesh3DAttributeTransformer::BuildBoneBounds(const Point3Array& positions) {
+        UInt32 entryCount = (UInt32)boneCount + 2;
+        boneBounds.assign(entryCount * 6, 0.0f);
+        boneHasBounds.assign(entryCount, 0);
+
+        const Real * positionsPtr = positions.GetConstDataPtr();
+        for (UInt32 f = 0; f < firstInstances.size(); f++) {
+            if (firstInstances[f] >= positions.GetCount())continue;
+            const Real * point = positionsPtr + (firstInstances[f] * 4);
+
+            for (UInt32 b = 0; b < 4; b++) {
+                if (packedBoneWeights[f * 4 + b] <= 0)continue;
+
+                UInt32 boneIndex = packedBoneIndices[f * 4 + b];
+                Real * bounds = &boneBounds[boneIndex * 6];
+                for (UInt32 c = 0; c < 3; c++) {
+                    if (point[c] < bounds[c] || !boneHasBounds[boneIndex])bounds[c] = point[c];
+                    if (point[c] > bounds[c + 3] || !boneHasBounds[boneIndex])bounds[c + 3] = point[c];
+                }
+                boneHasBounds[boneIndex] = 1;
+            }
+        }
+
+        boneBoundsDirty = false;
+    }
+
+    /*
+     * Calculate the bounding box of the mesh as it will be skinned by the vertex shader, and store it in [shaderSkinnedCenter]
+     * and [shaderSkinnedExtents]. The bind-pose bounding box of each bone in [boneBounds] is transformed by the bone's current
+     * matrix in [boneMatrices] (the transformed box is the axis-aligned box that contains the transformed original) and
+     * all the transformed boxes are merged.
+     */
+    void SkinnedMesh3DAttributeTransformer::CalculateShaderSkinnedBounds() {
+        Real min[3] = { 0, 0, 0 };
+        Real max[3] = { 0, 0, 0 };
+        Bool found = false;
+
+        UInt32 entryCount = (UInt32)boneHasBounds.size();
+        for (UInt32 i = 0; i < entryCount; i++) {
+            if (!boneHasBounds[i])continue;
+            // only the bones that were transformed during the current frame have valid matrices
+            if (i < (UInt32)boneCount && !boneTransformed[i])continue;
+
+            const Real * bounds = &boneBounds[i * 6];
+            const Real * matrix = boneMatrices + i * AffineMatrixSize;
+
+            for (UInt32 r = 0; r < 3; r++) {
+                const Real * row = matrix + r * 4;
+                Real center = row[3];
+                Real extent = 0;
+                for (UInt32 c = 0; c < 3; c++) {
+                    center += row[c] * (bounds[c] + bounds[c + 3]) * 0.5f;
+                    extent += GTEMath::Abs(row[c]) * (bounds[c + 3] - bounds[c]) * 0.5f;
+                }
+
+                if (center - extent < min[r] || !found)min[r] = center - extent;
+                if (center + extent > max[r] || !found)max[r] = center + extent;
+            }
+            found = true;
+        }
+
+        shaderSkinnedExtents.Set((max[0] - min[0]) / 2.0f, (max[1] - min[1]) / 2.0f, (max[2] - min[2]) / 2.0f);
+        shaderSkinnedCenter.Set(min[0] + shaderSkinnedExtents.x, min[1] + shaderSkinnedExtents.y, min[2] + shaderSkinnedExtents.z);
+    }
+
+    /*
+     * Store the top three rows of the affine matrix [source] in [dest] (row-major, four values per row).
+     */
+    void SkinnedMesh3DAttributeTransformer::StoreAffineMatrix(const Matrix4x4& source, Real * dest) {
+        const Real * m = source.GetConstDataPtr();
+        for (UInt32 r = 0; r < 3; r++) {
+            for (UInt32 c = 0; c < 4; c++) {
+                dest[r * 4 + c] = m[r + c * 4];
+            }
+        }
+    }
+
+    /*
+     * Calculate the weighted sum of the four 3x4 bone matrices in [boneMatrices] specified by [boneIndices] and [weights],
+     * and store the result in [out].
+     */
+    void SkinnedMesh3DAttributeTransformer::BlendBoneMatrices(const Real * boneMatrices, const UInt32 * boneIndices, const Real * weights, Real * out) {
+        const Real * b0 = boneMatrices + boneIndices[0] * AffineMatrixSize;
+        const Real * b1 = boneMatrices + boneIndices[1] * AffineMatrixSize;
+        const Real * b2 = boneMatrices + boneIndices[2] * AffineMatrixSize;
+        const Real * b3 = boneMatrices + boneIndices[3] * AffineMatrixSize;
+
+#if defined(_GTE_SIMD_SSE)
+        __m128 w0 = _mm_set1_ps(weights[0]);
+        __m128 w1 = _mm_set1_ps(weights[1]);
+        __m128 w2 = _mm_set1_ps(weights[2]);
+        __m128 w3 = _mm_set1_ps(weights[3]);
+
+        for (UInt32 r = 0; r < 12; r += 4) {
+            __m128 row = _mm_mul_ps(_mm_loadu_ps(b0 + r), w0);
+            row = _mm_add_ps(row, _mm_mul_ps(_mm_loadu_ps(b1 + r), w1));
+            row = _mm_add_ps(row, _mm_mul_ps(_mm_loadu_ps(b2 + r), w2));
+            row = _mm_add_ps(row, _mm_mul_ps(_mm_loadu_ps(b3 + r), w3));
+            _mm_storeu_ps(out + r, row);
+        }
+#else
+        for (UInt32 i = 0; i < AffineMatrixSize; i++) {
+            out[i] = b0[i] * weights[0] + b1[i] * weights[1] + b2[i] * weights[2] + b3[i] * weights[3];
+        }
+#endif
+    }
+
+    /*
+     * Convert the bone transformation [source], which is assumed to be composed of a rotation, a uniform scale
+     * and a translation, into a unit dual quaternion (stored in [dest] as the real part followed by the dual part)
+     * and a scale factor (stored in [scale]).
+     */
+    void SkinnedMesh3DAttributeTransformer::StoreDualQuaternion(const Matrix4x4& source, Real * dest, Real& scale) {
+        const Real * m = source.GetConstDataPtr();
+
+        // remove the scale from the basis vectors to get a pure rotation
+        Matrix4x4 rotation;
+        Real * r = rotation.GetDataPtr();
+        Real scaleSum = 0;
+        for (UInt32 c = 0; c < 3; c++) {
+            const Real * column = m + c * 4;
+            Real length = GTEMath::SquareRoot(column[0] * column[0] + column[1] * column[1] + column[2] * column[2]);
+            Real invLength = length > 0 ? 1 / length : 0;
+            r[c * 4] = column[0] * invLength;
+            r[c * 4 + 1] = column[1] * invLength;
+            r[c * 4 + 2] = column[2] * invLength;
+            scaleSum += length;
+        }
+        scale = scaleSum / 3;
+
+        Quaternion q(rotation);
+        q.normalize();
+
+        Real qx = q.x(), qy = q.y(), qz = q.z(), qw = q.w();
+        Real tx = m[12], ty = m[13], tz = m[14];
+
+        dest[0] = qx;
+        dest[1] = qy;
+        dest[2] = qz;
+        dest[3] = qw;
+
+        // dual part = 0.5 * (translation as a pure quaternion) * rotation
+        dest[4] = 0.5f * (qw * tx + ty * qz - tz * qy);
+        dest[5] = 0.5f * (qw * ty + tz * qx - tx * qz);
+        dest[6] = 0.5f * (qw * tz + tx * qy - ty * qx);
+        dest[7] = -0.5f * (tx * qx + ty * qy + tz * qz);
+    }
+
+    /*
+     * Calculate the weighted sum of the four bone dual quaternions in [boneDualQuaternions] specified by [boneIndices] and [weights],
+     * normalize it, and store the resulting rigid transformation (scaled by the weighted sum of the corresponding entries in [boneScales])
+     * in [out] as a 3x4 affine matrix.
+     */
+    void SkinnedMesh3DAttributeTransformer::BlendDualQuaternions(const Real * boneDualQuaternions, const Real * boneScales, const UInt32 * boneIndices, const Real * weights, Real * out) {
+        const Real * pivot = boneDualQuaternions + boneIndices[0] * DualQuaternionSize;
+
+        // q and -q represent the same rotation, so each dual quaternion is flipped (if necessary) to lie in the
+        // same hemisphere as the first one; otherwise the blend could take the long way around.
+        Real signedWeights[4];
+        Real scale = 0;
+        for (UInt32 b = 0; b < 4; b++) {
+            const Real * dq = boneDualQuaternions + boneIndices[b] * DualQuaternionSize;
+            Real dot = dq[0] * pivot[0] + dq[1] * pivot[1] + dq[2] * pivot[2] + dq[3] * pivot[3];
+            signedWeights[b] = dot < 0 ? -weights[b] : weights[b];
+            scale += boneScales[boneIndices[b]] * weights[b];
+        }
 
-        memset(cacheFlags, value, sizeof(UChar) * count);
+        Real blended[8];
+#if defined(_GTE_SIMD_SSE)
+        __m128 real = _mm_setzero_ps();
+        __m128 dual = _mm_setzero_ps();
+        for (UInt32 b = 0; b < 4; b++) {
+            const Real * dq = boneDualQuaternions + boneIndices[b] * DualQuaternionSize;
+            __m128 w = _mm_set1_ps(signedWeights[b]);
+            real = _mm_add_ps(real, _mm_mul_ps(_mm_loadu_ps(dq), w));
+            dual = _mm_add_ps(dual, _mm_mul_ps(_mm_loadu_ps(dq + 4), w));
+        }
+        _mm_storeu_ps(blended, real);
+        _mm_storeu_ps(blended + 4, dual);
+#else
+        for (UInt32 i = 0; i < DualQuaternionSize; i++) {
+            blended[i] = 0;
+            for (UInt32 b = 0; b < 4; b++) {
+                blended[i] += boneDualQuaternions[boneIndices[b] * DualQuaternionSize + i] * signedWeights[b];
+            }
+        }
+#endif
+
+        Real x = blended[0], y = blended[1], z = blended[2], w = blended[3];
+        Real lengthSquared = x * x + y * y + z * z + w * w;
+        if (lengthSquared <= 0) {
+            // degenerate blend (e.g. all weights are zero), leave the vertex untransformed
+            Matrix4x4 identity;
+            StoreAffineMatrix(identity, out);
+            return;
+        }
+
+        Real invLength = 1 / GTEMath::SquareRoot(lengthSquared);
+        x *= invLength; y *= invLength; z *= invLength; w *= invLength;
+        Real dx = blended[4] * invLength, dy = blended[5] * invLength, dz = blended[6] * invLength, dw = blended[7] * invLength;
+
+        // translation = 2 * dual * conjugate(real)
+        Real tx = 2 * (w * dx - dw * x + y * dz - z * dy);
+        Real ty = 2 * (w * dy - dw * y + z * dx - x * dz);
+        Real tz = 2 * (w * dz - dw * z + x * dy - y * dx);
+
+        out[0] = scale * (1 - 2 * (y * y + z * z));
+        out[1] = scale * 2 * (x * y - w * z);
+        out[2] = scale * 2 * (x * z + w * y);
+        out[3] = tx;
+
+        out[4] = scale * 2 * (x * y + w * z);
+        out[5] = scale * (1 - 2 * (x * x + z * z));
+        out[6] = scale * 2 * (y * z - w * x);
+        out[7] = ty;
+
+        out[8] = scale * 2 * (x * z - w * y);
+        out[9] = scale * 2 * (y * z + w * x);
+        out[10] = scale * (1 - 2 * (x * x + y * y));
+        out[11] = tz;
+    }
+
+    /*
+     * Transform each of [position], [vertexNormal], [faceNormal] and [vertexTangent] (each of which is a 4-component
+     * vector and may be null) by the 3x4 affine matrix [matrix]. The w component of each vector is left unchanged.
+     */
+    void SkinnedMesh3DAttributeTransformer::TransformByAffineMatrix(const Real * matrix, Real * position, Real * vertexNormal, Real * faceNormal, Real * vertexTangent) {
+#if defined(_GTE_SIMD_SSE)
+        // transpose the rows into columns once, then re-use them for every attribute
+        __m128 c0 = _mm_loadu_ps(matrix);
+        __m128 c1 = _mm_loadu_ps(matrix + 4);
+        __m128 c2 = _mm_loadu_ps(matrix + 8);
+        __m128 c3 = _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f);
+        _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+
+        Real * targets[] = { position, vertexNormal, faceNormal, vertexTangent };
+        for (UInt32 t = 0; t < 4; t++) {
+            Real * target = targets[t];
+            if (target == nullptr)continue;
+
+            __m128 v = _mm_loadu_ps(target);
+            __m128 result = _mm_mul_ps(c0, _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0)));
+            result = _mm_add_ps(result, _mm_mul_ps(c1, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1))));
+            result = _mm_add_ps(result, _mm_mul_ps(c2, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2))));
+            result = _mm_add_ps(result, _mm_mul_ps(c3, _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3))));
+            _mm_storeu_ps(target, result);
+        }
+#else
+        Real * targets[] = { position, vertexNormal, faceNormal, vertexTangent };
+        for (UInt32 t = 0; t < 4; t++) {
+            Real * target = targets[t];
+            if (target == nullptr)continue;
+
+            Real x = target[0], y = target[1], z = target[2], w = target[3];
+            target[0] = matrix[0] * x + matrix[1] * y + matrix[2] * z + matrix[3] * w;
+            target[1] = matrix[4] * x + matrix[5] * y + matrix[6] * z + matrix[7] * w;
+            target[2] = matrix[8] * x + matrix[9] * y + matrix[10] * z + matrix[11] * w;
+        }
+#endif
     }
 
     /*
@@ -259,7 +615,7 @@ namespace GTE {
      * where angles between faces are too sharp for smoothing and therefore the transformation
      * for each instance must be calculated individually).
      */
-    Bool SkinnedMesh3DAttributeTransformer::FindIdenticalNormalsOrTangents(Vector3Array& fullList, Bool forNormals) {
+    Bool SkinnedMesh3DAttributeTransformer::FindIdenticalNormalsOrTangents(const Vector3Array& fullList, Bool forNormals) {
         ASSERT(renderer != nullptr, "SkinnedMesh3DAttributeTransformer::FindIdenticalNormals -> renderer is null.");
 
         // retrieve this instance's vertex bone map
@@ -289,12 +645,12 @@ namespace GTE {
             if (desc == nullptr)continue;
 
             if (!seenVectors[desc->UniqueVertexIndex]) {
-                Vector3* vec = fullList.GetElement(i);
+                const Vector3* vec = fullList.GetElementConst(i);
                 seenVectorValues.GetElement(desc->UniqueVertexIndex)->SetTo(*vec);
                 seenVectors[desc->UniqueVertexIndex] = true;
             }
             else {
-                if (!Vector3::AreStrictlyEqual(seenVectorValues.GetElement(desc->UniqueVertexIndex), fullList.GetElement(i))) {
+                if (!Vector3::AreStrictlyEqual(seenVectorValues.GetElement(desc->UniqueVertexIndex), fullList.GetElementConst(i))) {
                     if (forNormals)identicalNormalFlags[desc->UniqueVertexIndex] = 0;
                     else identicalTangentFlags[desc->UniqueVertexIndex] = 0;
                 }
@@ -314,7 +670,7 @@ namespace GTE {
      *   5. Transformed vertex tangents
      *   6. Per-vertex Transforms
      *
-     *  This method also initializes the [cacheFlags] array, which is used to flag which entries in all the other caches are valid.
+     *  This method also finds the first instance of each unique vertex.
      */
     Bool SkinnedMesh3DAttributeTransformer::CreateCaches() {
         ASSERT(renderer != nullptr, "SkinnedMesh3DAttributeTransformer::CreateCaches -> 'renderer' is null.");
@@ -323,10 +679,8 @@ namespace GTE {
         VertexBoneMap * vertexBoneMap = renderer->GetVertexBoneMap(vertexBoneMapIndex);
         ASSERT(vertexBoneMap != nullptr, "SkinnedMesh3DAttributeTransformer::CreateCaches -> No valid vertex bone map found for sub mesh.");
 
-        UInt32 uniqueVertexCount = vertexBoneMap->GetUniqueVertexCount();
-
-        cacheFlags = new(std::nothrow) UChar[uniqueVertexCount];
-        ASSERT(cacheFlags != nullptr, "SkinnedMesh3DAttributeTransformer::CreateCaches -> Unable to allocate cacheFlags flags array.");
+        FindFirstInstances();
+        packedBoneStreamDirty = true;
 
         DestroyCache(CacheType::Position);
         Bool createSuccess = CreateCache(CacheType::Position);
@@ -356,7 +710,8 @@ namespace GTE {
      * Deallocate & destroy all of the transformation caches.
      */
     void SkinnedMesh3DAttributeTransformer::DestroyCaches() {
-        SAFE_DELETE_ARRAY(cacheFlags);
+        uniqueVertexFirstInstances.clear();
+        firstInstances.clear();
         DestroyCache(CacheType::Position);
         DestroyCache(CacheType::VertexNormal);
         DestroyCache(CacheType::FaceNormal);
@@ -378,6 +733,94 @@ namespace GTE {
         vertexBoneMapIndex = index;
     }
 
+    /*
+     * Set the index of the sub-mesh (in the target mesh of [renderer]) that is skinned by this instance.
+     */
+    void SkinnedMesh3DAttributeTransformer::SetSubMeshIndex(Int32 index) {
+        subMeshIndex = index;
+    }
+
+    /*
+     * @Override AttributeTransformer::UsesShaderTransform()
+     *
+     * Was the last skinning operation left to the vertex shader?
+     */
+    Bool SkinnedMesh3DAttributeTransformer::UsesShaderTransform() const {
+        return gpuSkinningActive;
+    }
+
+    /*
+     * @Override AttributeTransformer::GetShaderTransformAttributes()
+     *
+     * Skinning in the vertex shader requires the bone indices and bone weights of each vertex.
+     */
+    StandardAttributeSet SkinnedMesh3DAttributeTransformer::GetShaderTransformAttributes() const {
+        StandardAttributeSet attributes = StandardAttributes::CreateAttributeSet();
+        StandardAttributes::AddAttribute(&attributes, StandardAttribute::BoneIndices);
+        StandardAttributes::AddAttribute(&attributes, StandardAttribute::BoneWeights);
+        return attributes;
+    }
+
+    /*
+     * @Override AttributeTransformer::GetShaderTransformAttributeData()
+     *
+     * Fill [data] with the four bone indices (stored as Real values) or the four bone weights of each of the [vertexCount]
+     * vertices, depending on [attribute]. The indices refer to the bone transformations in the palette sent by
+     * SendShaderTransformUniforms(), which has the same layout as [boneMatrices]. This data does not change
+     * from frame to frame, so it only needs to be uploaded once.
+     */
+    Bool SkinnedMesh3DAttributeTransformer::GetShaderTransformAttributeData(StandardAttribute attribute, Real * data, UInt32 vertexCount) {
+        NONFATAL_ASSERT_RTRN(data != nullptr, "SkinnedMesh3DAttributeTransformer::GetShaderTransformAttributeData -> 'data' is null.", false, true);
+        if (attribute != StandardAttribute::BoneIndices && attribute != StandardAttribute::BoneWeights)return false;
+        if (renderer == nullptr || vertexBoneMapIndex < 0 || packedBoneStreamDirty)return false;
+
+        VertexBoneMap * vertexBoneMap = renderer->GetVertexBoneMap(vertexBoneMapIndex);
+        NONFATAL_ASSERT_RTRN(vertexBoneMap != nullptr, "SkinnedMesh3DAttributeTransformer::GetShaderTransformAttributeData -> No valid vertex bone map found for sub mesh.", false, true);
+        NONFATAL_ASSERT_RTRN(vertexCount == vertexBoneMap->GetVertexCount(), "SkinnedMesh3DAttributeTransformer::GetShaderTransformAttributeData -> Mismatched vertex count.", false, true);
+
+        // index in [firstInstances] of the first instance of each unique vertex
+        std::vector<UInt32> packedIndices(vertexBoneMap->GetUniqueVertexCount(), 0);
+        for (UInt32 f = 0; f < firstInstances.size(); f++) {
+            packedIndices[vertexBoneMap->GetDescriptor(firstInstances[f])->UniqueVertexIndex] = f;
+        }
+
+        for (UInt32 i = 0; i < vertexCount; i++) {
+            UInt32 f = packedIndices[vertexBoneMap->GetDescriptor(i)->UniqueVertexIndex];
+            for (UInt32 b = 0; b < 4; b++) {
+                if (attribute == StandardAttribute::BoneIndices)data[i * 4 + b] = (Real)packedBoneIndices[f * 4 + b];
+                else data[i * 4 + b] = packedBoneWeights[f * 4 + b];
+            }
+        }
+
+        return true;
+    }
+
+    /*
+     * @Override AttributeTransformer::SendShaderTransformUniforms()
+     *
+     * Send the bone transformations calculated by the last call to TransformAttributes() to the shader of [material].
+     * Only the bones that are referenced by a vertex (plus the all-zero and identity transformations at the end of
+     * [boneMatrices]) are valid, but those are the only ones the shader will read.
+     */
+    void SkinnedMesh3DAttributeTransformer::SendShaderTransformUniforms(MaterialRef material) {
+        if (!gpuSkinningActive || boneMatrices == nullptr)return;
+        material->SendSkinningPaletteToShader(boneMatrices, (UInt32)boneCount + 2);
+    }
+
+    /*
+     * @Override AttributeTransformer::GetShaderTransformBounds()
+     *
+     * Get the bounding box of the mesh as skinned by the vertex shader during the current frame. This box is
+     * calculated from the per-bone bind-pose bounds, so it is conservative rather than tight.
+     */
+    Bool SkinnedMesh3DAttributeTransformer::GetShaderTransformBounds(Point3& center, Vector3& extents) const {
+        if (!gpuSkinningActive)return false;
+
+        center.Set(shaderSkinnedCenter.x, shaderSkinnedCenter.y, shaderSkinnedCenter.z);
+        extents.Set(shaderSkinnedExtents.x, shaderSkinnedExtents.y, shaderSkinnedExtents.z);
+        return true;
+    }
+
     /*
      * Perform transformation (skinning) for both vertex positions and normals in a single function.
      *
@@ -392,20 +835,31 @@ namespace GTE {
                                                                 const Vector3Array& vertexTangentsIn, Vector3Array& vertexTangentsOut,
                                                                 const Point3& centerIn, Point3& centerOut,
                                                                 Bool transformPositions, Bool transformNormals, Bool transformTangents) {
+        gpuSkinningActive = false;
+
         // make sure the target skeleton is valid and has a VertexBoneMap object for this instance
         if (renderer != nullptr && vertexBoneMapIndex >= 0) {
-            // copy existing positions to output array and the perform transformations
-            // directly on output array
-            if (transformPositions)positionsIn.CopyTo(&positionsOut);
-            // copy existing vertex normals to output array and the perform transformations
-            // directly on output array
-            if (transformNormals)vertexNormalsIn.CopyTo(&vertexNormalsOut);
-            // copy existing face normals to output array and the perform transformations
-            // directly on output array
-            if (transformNormals)faceNormalsIn.CopyTo(&faceNormalsOut);
-            // copy existing vertex tangents to output array and the perform transformations
-            // directly on output array
-            if (transformTangents)vertexTangentsIn.CopyTo(&vertexTangentsOut);
+            SkeletonRef skeleton = renderer->GetSkeleton();
+            ASSERT(skeleton.IsValid(), "SkinnedMesh3DAttributeTransformer::TransformAttributes -> renderer's skeleton is not valid.");
+
+            // when skinning in the vertex shader, only the bone transformations (and the center) are calculated here,
+            // so the (large) output arrays are not touched at all
+            gpuSkinningActive = skeleton->GetBoneCount() <= MaxGPUSkinningBones && renderer->ShouldSkinOnGPU(subMeshIndex);
+
+            if (!gpuSkinningActive) {
+                // copy existing positions to output array and the perform transformations
+                // directly on output array
+                if (transformPositions)positionsIn.CopyTo(&positionsOut);
+                // copy existing vertex normals to output array and the perform transformations
+                // directly on output array
+                if (transformNormals)vertexNormalsIn.CopyTo(&vertexNormalsOut);
+                // copy existing face normals to output array and the perform transformations
+                // directly on output array
+                if (transformNormals)faceNormalsIn.CopyTo(&faceNormalsOut);
+                // copy existing vertex tangents to output array and the perform transformations
+                // directly on output array
+                if (transformTangents)vertexTangentsIn.CopyTo(&vertexTangentsOut);
+            }
             // copy existing center to output center and perform transformation
             // directly on output center
             centerOut.Set(centerIn.x, centerIn.y, centerIn.z);
@@ -416,8 +870,6 @@ namespace GTE {
             Matrix4x4 averageBoneOffset;
 
             Matrix4x4 temp;
-            // used to store full transformation for a vertex
-            Matrix4x4 full;
 
             // retrieve this instance's vertex bone map
             VertexBoneMap * vertexBoneMap = renderer->GetVertexBoneMap(vertexBoneMapIndex);
@@ -428,10 +880,10 @@ namespace GTE {
             // get total number of vertices (including multiple instances of a unique vertex)
             UInt32 fullVertexCount = vertexBoneMap->GetVertexCount();
 
-            if (transformPositions)ASSERT(positionsOut.GetCount() == fullVertexCount, "SkinnedMesh3DAttributeTransformer::TransformAttributes -> Mismatched position count.");
-            if (transformNormals)ASSERT(vertexNormalsOut.GetCount() == fullVertexCount, "SkinnedMesh3DAttributeTransformer::TransformAttributes -> Mismatched vertex normal count.");
-            if (transformNormals)ASSERT(faceNormalsOut.GetCount() == fullVertexCount, "SkinnedMesh3DAttributeTransformer::TransformAttributes -> Mismatched face normal count.")
-                if (transformTangents)ASSERT(vertexTangentsOut.GetCount() == fullVertexCount, "SkinnedMesh3DAttributeTransformer::TransformAttributes -> Mismatched vertex tangent count.")
+            if (transformPositions && !gpuSkinningActive)ASSERT(positionsOut.GetCount() == fullVertexCount, "SkinnedMesh3DAttributeTransformer::TransformAttributes -> Mismatched position count.");
+            if (transformNormals && !gpuSkinningActive)ASSERT(vertexNormalsOut.GetCount() == fullVertexCount, "SkinnedMesh3DAttributeTransformer::TransformAttributes -> Mismatched vertex normal count.");
+            if (transformNormals && !gpuSkinningActive)ASSERT(faceNormalsOut.GetCount() == fullVertexCount, "SkinnedMesh3DAttributeTransformer::TransformAttributes -> Mismatched face normal count.")
+                if (transformTangents && !gpuSkinningActive)ASSERT(vertexTangentsOut.GetCount() == fullVertexCount, "SkinnedMesh3DAttributeTransformer::TransformAttributes -> Mismatched vertex tangent count.")
 
                     // initialize the position transformation flags array, saved transformed position array,
                     // normal transformation flags array, and saved transformed normal array
@@ -444,157 +896,169 @@ namespace GTE {
                         createSuccess = CreateIdenticalNormalsTangentsFlags();
                         ASSERT(createSuccess == true, "SkinnedMesh3DAttributeTransformer::TransformAttributes -> Unable to create identical normal caches.");
 
-                        if (transformNormals)FindIdenticalNormalsOrTangents(vertexNormalsOut, true);
-                        if (transformTangents)FindIdenticalNormalsOrTangents(vertexTangentsOut, false);
+                        if (transformNormals)FindIdenticalNormalsOrTangents(vertexNormalsIn, true);
+                        if (transformTangents)FindIdenticalNormalsOrTangents(vertexTangentsIn, false);
 
                         currentCacheSize = uniqueVertexCount;
                     }
 
-            SkeletonRef skeleton = renderer->GetSkeleton();
-            ASSERT(skeleton.IsValid(), "SkinnedMesh3DAttributeTransformer::TransformAttributes -> renderer's skeleton is not valid.");
-
             if (boneCount < 0 || (UInt32)boneCount != skeleton->GetBoneCount()) {
                 UpdateTransformedBoneCacheSize();
             }
 
             ClearTransformedBoneFlagsArray();
-            // clear the flags for all caches
-            ClearCacheFlags();
+            if (packedBoneStreamDirty)BuildPackedBoneStream();
+
+            // the vertex shader only supports linear blending, so ShouldSkinOnGPU() never allows dual quaternion skinning
+            Bool useDualQuaternions = !gpuSkinningActive && renderer->GetSkinningMode() == SkinningMode::DualQuaternion;
+
+            // final transformation of a single bone
+            Matrix4x4 boneMatrix;
+
+            // Calculate the final transformation for each bone to which at least one vertex is attached. This transformation
+            // is formed by the combination of the bone's offset matrix, and the full transformation of the corresponding node
+            // in [skeleton]. The bones are visited in the order in which they are first encountered by the vertices, so
+            // [averageBoneOffset] is always accumulated in the same order.
+            for (UInt32 f = 0; f < firstInstances.size(); f++) {
+                VertexBoneMap::VertexMappingDescriptor *desc = vertexBoneMap->GetDescriptor(firstInstances[f]);
+
+                for (UInt32 b = 0; b < desc->BoneCount; b++) {
+                    UInt32 boneIndex = desc->BoneIndex[b];
+                    if (boneTransformed[boneIndex] != 0)continue;
+
+                    const Bone * bone = skeleton.GetConstPtr()->GetBone(boneIndex);
+                    SkeletonNode * boneNode = skeleton->GetBoneNode(boneIndex);
+                    boneMatrix.SetTo(bone->OffsetMatrix);
+
+                    if (boneNode != nullptr && boneNode->HasTarget()) {
+                        const Transform * targetFull = boneNode->GetFullTransform();
+                        targetFull->CopyMatrix(temp);
+
+                        // calculate final transformation for this bone
+                        boneMatrix.PreMultiply(temp);
+                        boneMatrix.PreMultiply(modelInverse);
+                    }
+
+                    if (useDualQuaternions)StoreDualQuaternion(boneMatrix, boneDualQuaternions + boneIndex * DualQuaternionSize, boneScales[boneIndex]);
+                    else StoreAffineMatrix(boneMatrix, boneMatrices + boneIndex * AffineMatrixSize);
+
+                    // factor into average bone offset
+                    averageBoneOffset.Add(bone->OffsetMatrix);
+
+                    boneTransformed[boneIndex] = 1;
+                    uniqueBonesEncountered++;
+                }
+            }
+
+            // calculate average bone offset
+            if (uniqueBonesEncountered == 0)uniqueBonesEncountered = 1;
+            averageBoneOffset.MultiplyByScalar(1 / (Real)uniqueBonesEncountered);
+            // apply average bone offset to center point
+            averageBoneOffset.Transform(centerOut);
+
+            // the bone transformations are all the vertex shader needs, but the bounds of the skinned mesh are still needed on the CPU
+            if (gpuSkinningActive) {
+                if (boneBoundsDirty)BuildBoneBounds(positionsIn);
+                CalculateShaderSkinnedBounds();
+                return;
+            }
 
             Real* transformedPositionsPtrBase = transformedPositions.GetDataPtr();
             Real* transformedVertexNormalsPtrBase = transformedVertexNormals.GetDataPtr();
             Real* transformedFaceNormalsPtrBase = transformedFaceNormals.GetDataPtr();
             Real* transformedVertexTangentsPtrBase = transformedVertexTangents.GetDataPtr();
-            Real* transformedPositionsPtr = nullptr;
-            Real* transformedVertexNormalsPtr = nullptr;
-            Real* transformedFaceNormalsPtr = nullptr;
-            Real* transformedVertexTangentsPtr = nullptr;
 
             Real * positionsOutBase = positionsOut.GetDataPtr();
             Real * vertexNormalsOutBase = vertexNormalsOut.GetDataPtr();
             Real * faceNormalsOutBase = faceNormalsOut.GetDataPtr();
             Real * vertexTangentsOutBase = vertexTangentsOut.GetDataPtr();
 
-            UInt32 fullPositionCount = vertexBoneMap->GetVertexCount();
-            // loop through each vertex
-            for (UInt32 i = 0; i < fullPositionCount; i++) {
-                Real * currentPositionPtr = positionsOutBase + (i * 4);
-                Real * currentVertexNormalPtr = vertexNormalsOutBase + (i * 4);
-                Real * currentFaceNormalPtr = faceNormalsOutBase + (i * 4);
-                Real * currentVertexTangentPtr = vertexTangentsOutBase + (i * 4);
-
-                // get the mapping information for the current vertex
-                VertexBoneMap::VertexMappingDescriptor *desc = vertexBoneMap->GetDescriptor(i);
+            // Skin the first instance of each unique vertex, and save the results so they can be applied to the other
+            // instances of the same unique vertex. The value of desc->UniqueVertexIndex indicates the current vertex's unique
+            // vertex value (multiple vertices in multiple triangles may actually be the same vertex, just duplicated for each triangle).
+            auto skinFirstInstances = [&](UInt32 start, UInt32 end) {
+                for (UInt32 f = start; f < end; f++) {
+                    UInt32 i = firstInstances[f];
+                    UInt32 uniqueIndex = vertexBoneMap->GetDescriptor(i)->UniqueVertexIndex;
+                    Real * full = savedTransforms + (uniqueIndex * AffineMatrixSize);
+
+                    // calculate the final transformation for this vertex by applying the respective weight
+                    // for each bone transformation and adding them up.
+                    if (useDualQuaternions) {
+                        BlendDualQuaternions(boneDualQuaternions, boneScales, &packedBoneIndices[f * 4], &packedBoneWeights[f * 4], full);
+                    }
+                    else {
+                        BlendBoneMatrices(boneMatrices, &packedBoneIndices[f * 4], &packedBoneWeights[f * 4], full);
+                    }
 
-                // If this vertex has already been visited, simply apply the saved transformations to the
-                // current instance. The value of desc->UVertexIndex indicates the current vertex's unique
-                // vertex value (multiple vertices in multiple triangles may actually be the same vertex, just
-                // duplicated for each triangle)
+                    Real * currentPositionPtr = transformPositions ? positionsOutBase + (i * 4) : nullptr;
+                    Real * currentVertexNormalPtr = transformNormals ? vertexNormalsOutBase + (i * 4) : nullptr;
+                    Real * currentFaceNormalPtr = transformNormals ? faceNormalsOutBase + (i * 4) : nullptr;
+                    Real * currentVertexTangentPtr = transformTangents ? vertexTangentsOutBase + (i * 4) : nullptr;
+                    TransformByAffineMatrix(full, currentPositionPtr, currentVertexNormalPtr, currentFaceNormalPtr, currentVertexTangentPtr);
 
-                if (cacheFlags[desc->UniqueVertexIndex] == 1) {
                     if (transformPositions) {
-                        transformedPositionsPtr = transformedPositionsPtrBase + (desc->UniqueVertexIndex * 4);
-                        BaseVector4_QuickCopy(transformedPositionsPtr, currentPositionPtr);
-                        //savedTransforms[desc->UniqueVertexIndex].Transform(currentPositionPtr);
+                        BaseVector4_QuickCopy(currentPositionPtr, transformedPositionsPtrBase + (uniqueIndex * 4));
                     }
 
                     if (transformNormals) {
-                        transformedVertexNormalsPtr = transformedVertexNormalsPtrBase + (desc->UniqueVertexIndex * 4);
-                        if (identicalNormalFlags[desc->UniqueVertexIndex]) {
-                            BaseVector4_QuickCopy(transformedVertexNormalsPtr, currentVertexNormalPtr);
-                        }
-                        else savedTransforms[desc->UniqueVertexIndex].Transform(currentVertexNormalPtr);
-
-                        transformedFaceNormalsPtr = transformedFaceNormalsPtrBase + (desc->UniqueVertexIndex * 4);
+                        BaseVector4_QuickCopy(currentVertexNormalPtr, transformedVertexNormalsPtrBase + (uniqueIndex * 4));
+                        BaseVector4_QuickCopy(currentFaceNormalPtr, transformedFaceNormalsPtrBase + (uniqueIndex * 4));
                     }
 
                     if (transformTangents) {
-                        transformedVertexTangentsPtr = transformedVertexTangentsPtrBase + (desc->UniqueVertexIndex * 4);
-                        if (identicalTangentFlags[desc->UniqueVertexIndex]) {
-                            BaseVector4_QuickCopy(transformedVertexTangentsPtr, currentVertexTangentPtr);
-                        }
-                        else savedTransforms[desc->UniqueVertexIndex].Transform(currentVertexTangentPtr);
+                        BaseVector4_QuickCopy(currentVertexTangentPtr, transformedVertexTangentsPtrBase + (uniqueIndex * 4));
                     }
-
-                    if (i % 3 == 0)savedTransforms[desc->UniqueVertexIndex].Transform(currentFaceNormalPtr);
                 }
-                else {
-                    // if not attached to any bones, then the transformation
-                    // matrix will be the identity matrix
-                    if (desc->BoneCount == 0)full.SetIdentity();
-
-                    // loop through each bone to which this vertex is attached and calculate the final
-                    // transformation for this vertex by applying the respective weight for each bone
-                    // transformation and adding them up.
-                    for (UInt32 b = 0; b < desc->BoneCount; b++) {
-                        Bone * bone = skeleton->GetBone(desc->BoneIndex[b]);
-
-                        // We need to calculate the transformation that is formed by the combination
-                        // of the current bone's offset matrix, and the full transformation of
-                        // the corresponding node in [skeleton]. If it has already been calculated,
-                        // which is indicated by the bone transformation flag array in [boneTransformed],
-                        // then we skip this step. A value of zero means it is not yet calculated.
-                        if (boneTransformed[desc->BoneIndex[b]] == 0) {
-                            bone->TempFullMatrix.SetTo(bone->OffsetMatrix);
-
-                            if (bone->Node->HasTarget()) {
-                                const Transform * targetFull = bone->Node->GetFullTransform();
-                                targetFull->CopyMatrix(temp);
-
-                                // store final transformation for this bone in bone->TempFullMatrix
-                                bone->TempFullMatrix.PreMultiply(temp);
-                                bone->TempFullMatrix.PreMultiply(modelInverse);
-                            }
-
-                            // factor into average bone offset
-                            averageBoneOffset.Add(bone->OffsetMatrix);
-
-                            boneTransformed[desc->BoneIndex[b]] = 1;
-                            uniqueBonesEncountered++;
-                        }
+            };
 
-                        temp.SetTo(bone->TempFullMatrix);
-                        // apply weight for this vertex & bone
-                        temp.MultiplyByScalar(desc->Weight[b]);
+            // apply the saved transformations to every vertex that is not the first instance of its unique vertex
+            auto skinOtherInstances = [&](UInt32 start, UInt32 end) {
+                for (UInt32 i = start; i < end; i++) {
+                    UInt32 uniqueIndex = vertexBoneMap->GetDescriptor(i)->UniqueVertexIndex;
+                    if (uniqueVertexFirstInstances[uniqueIndex] == i)continue;
 
-                        if (b == 0)full.SetTo(temp);
-                        else full.Add(temp);
-                    }
+                    const Real * full = savedTransforms + (uniqueIndex * AffineMatrixSize);
+                    // attributes that cannot simply be copied from the first instance are transformed by [full]
+                    Real * currentVertexNormalPtr = nullptr;
+                    Real * currentFaceNormalPtr = nullptr;
+                    Real * currentVertexTangentPtr = nullptr;
 
                     if (transformPositions) {
-                        full.Transform(currentPositionPtr);
-                        transformedPositionsPtr = transformedPositionsPtrBase + (desc->UniqueVertexIndex * 4);
-                        BaseVector4_QuickCopy(currentPositionPtr, transformedPositionsPtr);
+                        BaseVector4_QuickCopy(transformedPositionsPtrBase + (uniqueIndex * 4), positionsOutBase + (i * 4));
                     }
 
                     if (transformNormals) {
-                        full.Transform(currentVertexNormalPtr);
-                        full.Transform(currentFaceNormalPtr);
-                        transformedVertexNormalsPtr = transformedVertexNormalsPtrBase + (desc->UniqueVertexIndex * 4);
-                        transformedFaceNormalsPtr = transformedFaceNormalsPtrBase + (desc->UniqueVertexIndex * 4);
-                        BaseVector4_QuickCopy(currentVertexNormalPtr, transformedVertexNormalsPtr);
-                        BaseVector4_QuickCopy(currentFaceNormalPtr, transformedFaceNormalsPtr);
+                        if (identicalNormalFlags[uniqueIndex]) {
+                            BaseVector4_QuickCopy(transformedVertexNormalsPtrBase + (uniqueIndex * 4), vertexNormalsOutBase + (i * 4));
+                        }
+                        else currentVertexNormalPtr = vertexNormalsOutBase + (i * 4);
                     }
 
                     if (transformTangents) {
-                        full.Transform(currentVertexTangentPtr);
-                        transformedVertexTangentsPtr = transformedVertexTangentsPtrBase + (desc->UniqueVertexIndex * 4);
-                        BaseVector4_QuickCopy(currentVertexTangentPtr, transformedVertexTangentsPtr);
+                        if (identicalTangentFlags[uniqueIndex]) {
+                            BaseVector4_QuickCopy(transformedVertexTangentsPtrBase + (uniqueIndex * 4), vertexTangentsOutBase + (i * 4));
+                        }
+                        else currentVertexTangentPtr = vertexTangentsOutBase + (i * 4);
                     }
 
-                    savedTransforms[desc->UniqueVertexIndex] = full;
+                    if (i % 3 == 0)currentFaceNormalPtr = faceNormalsOutBase + (i * 4);
 
-                    // set position transformation flag to 1 so we don't repeat the work for this vertex if we
-                    // encounter it again
-                    cacheFlags[desc->UniqueVertexIndex] = 1;
+                    TransformByAffineMatrix(full, nullptr, currentVertexNormalPtr, currentFaceNormalPtr, currentVertexTangentPtr);
                 }
+            };
+
+            // all instances of a unique vertex depend on its first instance, so the first instances must
+            // be completely skinned before the remaining instances are processed
+            WorkerPool * workerPool = Engine::Instance()->GetWorkerPool();
+            if (workerPool != nullptr) {
+                workerPool->ParallelFor((UInt32)firstInstances.size(), VerticesPerSkinningJob, skinFirstInstances);
+                workerPool->ParallelFor(fullVertexCount, VerticesPerSkinningJob, skinOtherInstances);
+            }
+            else {
+                skinFirstInstances(0, (UInt32)firstInstances.size());
+                skinOtherInstances(0, fullVertexCount);
             }
-
-            // calculate average bone offset
-            if (uniqueBonesEncountered == 0)uniqueBonesEncountered = 1;
-            averageBoneOffset.MultiplyByScalar(1 / (Real)uniqueBonesEncountered);
-            // apply average bone offset to center point
-            averageBoneOffset.Transform(centerOut);
         }
     }
 }
@@ -7,11 +7,37 @@
  * functions that take the normal and position arrays from a mesh as
  * input and transform them according a bone structure specified by
  * [skeleton].
+ *
+ * The per-vertex work is split across the engine's WorkerPool in chunks of vertices. Each chunk only
+ * writes the output for its own vertices, so the results do not depend on the number of threads used.
+ *
+ * Bone and per-vertex transformations are stored as 3x4 affine matrices (three rows of four values, the
+ * implicit fourth row is always [0, 0, 0, 1]). The bone attachments of each vertex are packed into a stream of
+ * four bone indices and four weights per vertex, so that the skinning kernel can blend the bone matrices and
+ * transform all of a vertex's attributes in SIMD registers without any per-bone branching.
+ *
+ * When the renderer's skinning mode is SkinningMode::DualQuaternion, each bone transformation is instead
+ * converted to a unit dual quaternion (plus a uniform scale factor) once per frame, and the bones affecting
+ * a vertex are blended as dual quaternions. Blending rigid transformations this way does not collapse volume
+ * around joints with large rotations the way blending matrices does. The blended dual quaternion is converted
+ * back to a 3x4 affine matrix so that the attributes are transformed by the same kernel in both modes.
+ *
+ * If the renderer allows it (see SkinnedMesh3DRenderer::ShouldSkinOnGPU()), linear blend skinning is
+ * instead performed by the vertex shader: only the bone matrices are calculated on the CPU, and they are
+ * sent to the shader as a palette of 3x4 matrices along with a static stream of bone indices and weights
+ * for each vertex. Skeletons with more than [MaxGPUSkinningBones] bones always use the CPU path.
+ *
+ * Since the skinned positions never reach the CPU in that case, the mesh is bounded by transforming the
+ * bind-pose bounding box of the vertices attached to each bone by that bone's matrix and merging the results.
+ * Because linear blend skinning moves each vertex to a weighted average of its bones' transformations of it,
+ * the merged box always contains the skinned mesh (assuming the bone weights of each vertex add up to one).
  */
 
 #ifndef _GTE_SKINNEDMESH_ATTRIBUTE_TRANSFORMER_H
 #define _GTE_SKINNEDMESH_ATTRIBUTE_TRANSFORMER_H
 
+#include <vector>
+
 #include "engine.h"
 #include "attributetransformer.h"
 #include "skinnedmesh3Dattrtransformer.h"
@@ -26,6 +52,11 @@ namespace GTE {
     class Matrix4x4;
     class VertexBoneMap;
 
+    enum class SkinningMode {
+        LinearBlend = 0,
+        DualQuaternion = 1
+    };
+
     class SkinnedMesh3DAttributeTransformer : public AttributeTransformer {
         enum class CacheType {
             Position = 0,
@@ -35,27 +66,64 @@ namespace GTE {
             Transform = 4
         };
 
+        // number of vertices processed by a single job when the skinning work is split across worker threads
+        static const UInt32 VerticesPerSkinningJob = 512;
+        // number of Real values in a 3x4 affine matrix
+        static const UInt32 AffineMatrixSize = 12;
+        // number of Real values in a dual quaternion (real part followed by dual part)
+        static const UInt32 DualQuaternionSize = 8;
         // the renderer for which this transformer acts
         SkinnedMesh3DRenderer* renderer;
         // [renderer] has an array of VertexBoneMap objects. [vertexBoneMapIndex] is the
         // index in that array that contains the VertexBoneMap for this instance of
         // SkinnedMesh3DAttributeTransformer.
         Int32 vertexBoneMapIndex;
+        // index of the sub-mesh that is skinned by this instance
+        Int32 subMeshIndex;
+        // was the last skinning operation left to the vertex shader?
+        Bool gpuSkinningActive;
 
         Int32 boneCount;
         // flag for each Bone object in the list of bones held by the skeleton in [renderer]. the flag indicates
         // whether the transformation for that bone has been calculated already (bones are often visited
         // multiple times during a single vertex skinning operation).
         UChar * boneTransformed;
-
+        // final transformation for each bone in the skeleton as a 3x4 affine matrix, valid only for bones flagged in [boneTransformed].
+        // two extra matrices follow the skeleton's bones: an all-zero matrix that is referenced by unused bone slots in
+        // [packedBoneIndices], and an identity matrix that is used for vertices that are not attached to any bone.
+        Real * boneMatrices;
+        // final transformation for each bone as a unit dual quaternion, used instead of [boneMatrices] when skinning with
+        // dual quaternions. followed by the same two extra entries as [boneMatrices] (all-zero and identity).
+        Real * boneDualQuaternions;
+        // uniform scale factor of each bone's final transformation (which cannot be represented by a unit dual quaternion)
+        Real * boneScales;
 
         // existing size of each cache
         Int32 currentCacheSize;
-        // flags that indicate that an entry in any cache at a specified index is valid
-        UChar * cacheFlags;
 
-        // once the full transformation has been calculated for a vertex, save it for later reuse
-        Matrix4x4 * savedTransforms;
+        // for each unique vertex, the index of the first vertex that is an instance of it
+        std::vector<UInt32> uniqueVertexFirstInstances;
+        // the indices of all vertices that are the first instance of their unique vertex, in ascending order
+        std::vector<UInt32> firstInstances;
+        // four bone indices (into [boneMatrices]) for each entry in [firstInstances]
+        std::vector<UInt32> packedBoneIndices;
+        // four bone weights for each entry in [firstInstances]
+        std::vector<Real> packedBoneWeights;
+        // must [packedBoneIndices] and [packedBoneWeights] be rebuilt?
+        Bool packedBoneStreamDirty;
+        // bind-pose bounding box (minimum x, y & z followed by maximum x, y & z) of the vertices attached with a non-zero
+        // weight to each entry in [boneMatrices], valid only for entries flagged in [boneHasBounds]
+        std::vector<Real> boneBounds;
+        // flag for each entry in [boneMatrices] that indicates whether any vertex contributes to its entry in [boneBounds]
+        std::vector<UChar> boneHasBounds;
+        // must [boneBounds] be rebuilt?
+        Bool boneBoundsDirty;
+        // bounding box of the mesh as skinned by the vertex shader, calculated by the last call to TransformAttributes()
+        Point3 shaderSkinnedCenter;
+        Vector3 shaderSkinnedExtents;
+
+        // once the full transformation (3x4 affine) has been calculated for a vertex, save it for later reuse
+        Real * savedTransforms;
 
         // saved values of vertices that have been transformed
         Point3Array transformedPositions;
@@ -84,25 +152,47 @@ namespace GTE {
 
         void DestroyCache(CacheType target);
         Bool CreateCache(CacheType target);
-        void ClearCacheFlags();
-        void SetAllTransformCacheFlags(UChar value);
+        void FindFirstInstances();
+        void BuildPackedBoneStream();
+        void BuildBoneBounds(const Point3Array& positions);
+        void CalculateShaderSkinnedBounds();
+
+        static void StoreDualQuaternion(const Matrix4x4& source, Real * dest, Real& scale);
+        static void BlendDualQuaternions(const Real * boneDualQuaternions, const Real * boneScales, const UInt32 * boneIndices, const Real * weights, Real * out);
 
         void DestroyIdenticalNormalsTangentsFlags();
         Bool CreateIdenticalNormalsTangentsFlags();
         void ClearIdenticalNormalsTangentsFlags();
-        Bool FindIdenticalNormalsOrTangents(Vector3Array& fullNormalLists, Bool forNormals);
+        Bool FindIdenticalNormalsOrTangents(const Vector3Array& fullNormalLists, Bool forNormals);
 
         Bool CreateCaches();
         void DestroyCaches();
 
     public:
 
+        // maximum number of bones for which skinning can be done in the vertex shader; the palette
+        // holds three vec4 values for each bone plus the extra all-zero and identity matrices, and
+        // must fit in MAX_SKINNING_PALETTE_SIZE in skinning.inc
+        static const UInt32 MaxGPUSkinningBones = 62;
+
+        // the linear blend skinning kernels, which must match the vertex shader code in skinning.inc
+        static void StoreAffineMatrix(const Matrix4x4& source, Real * dest);
+        static void BlendBoneMatrices(const Real * boneMatrices, const UInt32 * boneIndices, const Real * weights, Real * out);
+        static void TransformByAffineMatrix(const Real * matrix, Real * position, Real * vertexNormal, Real * faceNormal, Real * vertexTangent);
+
         SkinnedMesh3DAttributeTransformer(StandardAttributeSet attributes);
         SkinnedMesh3DAttributeTransformer();
         ~SkinnedMesh3DAttributeTransformer();
 
         void SetRenderer(SkinnedMesh3DRenderer* renderer);
         void SetVertexBoneMapIndex(Int32 index);
+        void SetSubMeshIndex(Int32 index);
+
+        Bool UsesShaderTransform() const;
+        StandardAttributeSet GetShaderTransformAttributes() const;
+        Bool GetShaderTransformAttributeData(StandardAttribute attribute, Real * data, UInt32 vertexCount);
+        void SendShaderTransformUniforms(MaterialRef material);
+        Bool GetShaderTransformBounds(Point3& center, Vector3& extents) const;
 
         void TransformAttributes(const Point3Array& positionsIn, Point3Array& positionsOut,
                                  const Vector3Array& vertexNormalsIn, Vector3Array& vertexNormalsOut,
@@ -8,6 +8,9 @@
 #include "graphics/animation/skeleton.h"
 #include "graphics/object/mesh3D.h"
 #include "graphics/object/submesh3D.h"
+#include "graphics/object/mesh3Dfilter.h"
+#include "graphics/render/material.h"
+#include "graphics/render/multimaterial.h"
 #include "graphics/render/skinnedmesh3Dattrtransformer.h"
 #include "global/global.h"
 #include "global/assert.h"
@@ -18,7 +21,8 @@ namespace GTE {
     * Default constructor.
     */
     SkinnedMesh3DRenderer::SkinnedMesh3DRenderer() {
-
+        skinningMode = SkinningMode::LinearBlend;
+        gpuSkinningEnabled = false;
     }
 
     /*
@@ -48,6 +52,74 @@ namespace GTE {
         return skeleton;
     }
 
+    /*
+     * Select how the bone transformations that affect each vertex are blended: linear blending of
+     * bone matrices (the default), or dual quaternion blending, which preserves volume around joints
+     * with large rotations.
+     */
+    void SkinnedMesh3DRenderer::SetSkinningMode(SkinningMode mode) {
+        skinningMode = mode;
+    }
+
+    /*
+     * Get the method used to blend the bone transformations that affect each vertex.
+     */
+    SkinningMode SkinnedMesh3DRenderer::GetSkinningMode() const {
+        return skinningMode;
+    }
+
+    /*
+     * Allow (or disallow) vertex skinning to be performed by the vertex shader. The bone transformations are
+     * still calculated on the CPU, but the (far more expensive) transformation of each vertex is not.
+     */
+    void SkinnedMesh3DRenderer::SetGPUSkinningEnabled(Bool enabled) {
+        gpuSkinningEnabled = enabled;
+    }
+
+    /*
+     * Is vertex skinning allowed to be performed by the vertex shader?
+     */
+    Bool SkinnedMesh3DRenderer::IsGPUSkinningEnabled() const {
+        return gpuSkinningEnabled;
+    }
+
+    /*
+     * Should the sub-mesh at [subMeshIndex] be skinned by the vertex shader for the current frame? This requires that:
+     *
+     *   - GPU skinning is enabled and the skinning mode is SkinningMode::LinearBlend.
+     *   - Every material used to render the sub-mesh supports GPU skinning (see Material::SupportsGPUSkinning()).
+     *   - The scene object is not static and does not cast shadows, since override materials for screen-space
+     *     ambient occlusion (static objects only) and the shadow volume geometry (built from the
+     *     transformed positions) both rely on skinning having been performed on the CPU.
+     *
+     * In all other cases the sub-mesh is skinned on the CPU.
+     */
+    Bool SkinnedMesh3DRenderer::ShouldSkinOnGPU(Int32 subMeshIndex) {
+        if (!gpuSkinningEnabled || skinningMode != SkinningMode::LinearBlend || subMeshIndex < 0)return false;
+
+        SceneObjectRef sceneObject = GetSceneObject();
+        if (!sceneObject.IsValid() || sceneObject->IsStatic())return false;
+
+        // Shadow casters are not supported by GPU skinning. Shadow volumes are extruded on the CPU (see
+        // SubMesh3DRenderer::BuildShadowVolume()) from the skinned positions, so a shadow caster needs those
+        // positions every frame anyway, and skinning it on the CPU is cheaper than skinning it twice.
+        Mesh3DFilterRef filter = sceneObject->GetMesh3DFilter();
+        if (!filter.IsValid() || filter->GetCastShadows())return false;
+
+        UInt32 multiMaterialCount = GetMultiMaterialCount();
+        if (multiMaterialCount == 0)return false;
+
+        MultiMaterialRef multiMaterial = GetMultiMaterial((UInt32)subMeshIndex % multiMaterialCount);
+        if (!multiMaterial.IsValid() || multiMaterial->GetMaterialCount() == 0)return false;
+
+        for (UInt32 m = 0; m < multiMaterial->GetMaterialCount(); m++) {
+            MaterialRef material = multiMaterial->GetMaterial(m);
+            if (!material.IsValid() || !material->SupportsGPUSkinning())return false;
+        }
+
+        return true;
+    }
+
     /*
      * @Override Mesh3DRenderer::UpdateFromMesh()
      *
@@ -99,6 +171,7 @@ namespace GTE {
                     if (attrTransformer != nullptr) {
                         attrTransformer->SetRenderer(this);
                         attrTransformer->SetVertexBoneMapIndex(vertexBoneMapIndex);
+                        attrTransformer->SetSubMeshIndex(i);
                     }
                 }
             }
@@ -131,4 +204,14 @@ namespace GTE {
     void SkinnedMesh3DRenderer::MapSubMeshToVertexBoneMap(UInt32 subMeshIndex, Int32 vertexBoneMapIndex) {
         subMeshIndexMap[subMeshIndex] = vertexBoneMapIndex;
     }
+
+    /*
+     * Get the index of the VertexBoneMap structure in [vertexBoneMaps] that the sub-mesh at [subMeshIndex] in the
+     * target mesh of this renderer is mapped to, or -1 if it is not mapped to one.
+     */
+    Int32 SkinnedMesh3DRenderer::GetVertexBoneMapIndex(UInt32 subMeshIndex) const {
+        std::unordered_map<UInt32, int>::const_iterator result = subMeshIndexMap.find(subMeshIndex);
+        if (result == subMeshIndexMap.end())return -1;
+        return result->second;
+    }
 }
@@ -10,6 +10,24 @@
  * does its rendering. SkinnedMesh3DRenderer supplies a special kind of AttributeTransformer
  * that performs vertex skinning.
  *
+ * Vertex skinning can optionally be moved to the vertex shader (see SetGPUSkinningEnabled()). Whenever
+ * a sub-mesh cannot be skinned on the GPU, it silently falls back to skinning on the CPU. Note that
+ * the fallback only applies to the skinning itself: materials whose shaders perform skinning (such
+ * as the built-in "_skinned" shaders) cannot be used to render the CPU-skinned result.
+ *
+ * For that reason GPU skinning is strictly opt-in, and neither the model importer nor this class will
+ * ever switch a material to a skinning shader. To skin a model in the vertex shader, the caller must:
+ *
+ *   - Replace the materials of the skinned meshes with materials that use a skinning shader, e.g. the
+ *     built-in shader returned by EngineObjectManager::GetLoadedShader() for the characteristics
+ *     DiffuseTextured | VertexNormals | GPUSkinned (or DiffuseColored | VertexNormals | GPUSkinned).
+ *   - Call SetGPUSkinningEnabled(true) and keep the skinning mode at SkinningMode::LinearBlend.
+ *   - Make sure the scene object is not static and its Mesh3DFilter does not cast shadows. Shadow casters
+ *     are always skinned on the CPU, since their shadow volumes are built from the CPU-skinned positions.
+ *
+ * If any of these conditions stops being met later on, the skinning shader will render the mesh
+ * incorrectly, so the materials must be switched back at the same time.
+ *
  */
 
 
@@ -52,6 +70,11 @@ namespace GTE {
         // the bones in [skeleton]
         std::unordered_map<UInt32, int>subMeshIndexMap;
 
+        // method used to blend the bone transformations that affect each vertex
+        SkinningMode skinningMode;
+        // may skinning be performed by the vertex shader (see ShouldSkinOnGPU())?
+        Bool gpuSkinningEnabled;
+
         SkinnedMesh3DRenderer();
         ~SkinnedMesh3DRenderer();
 
@@ -59,8 +82,14 @@ namespace GTE {
 
         void SetSkeleton(SkeletonRef skeleton);
         SkeletonRef GetSkeleton();
+        void SetSkinningMode(SkinningMode mode);
+        SkinningMode GetSkinningMode() const;
+        void SetGPUSkinningEnabled(Bool enabled);
+        Bool IsGPUSkinningEnabled() const;
+        Bool ShouldSkinOnGPU(Int32 subMeshIndex);
         void InitializeForMesh();
         void MapSubMeshToVertexBoneMap(UInt32 subMeshIndex, Int32 vertexBoneMapIndex);
+        Int32 GetVertexBoneMapIndex(UInt32 subMeshIndex) const;
 
         void AddVertexBoneMap(VertexBoneMap * map);
         VertexBoneMap * GetVertexBoneMap(UInt32 index);
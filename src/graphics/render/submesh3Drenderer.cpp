@@ -6,9 +6,12 @@
 #include "graphics/object/submesh3Dface.h"
 #include "graphics/object/submesh3Dfaces.h"
 #include "material.h"
+#include "multimaterial.h"
 #include "graphics/graphics.h"
 #include "graphics/stdattributes.h"
 #include "graphics/render/vertexattrbuffer.h"
+#include "graphics/render/indexbuffer.h"
+#include "graphics/render/vertexarray.h"
 #include "graphics/object/customfloatattributebuffer.h"
 #include "mesh3Drenderer.h"
 #include "graphics/object/submesh3D.h"
@@ -47,9 +50,19 @@ namespace GTE {
         }
 
         totalVertexCount = 0;
+        bufferVertexCount = 0;
+        useIndices = false;
+        indexBuffer = nullptr;
+        vertexArray = nullptr;
         storedAttributes = StandardAttributes::CreateAttributeSet();
 
         this->buffersOnGPU = buffersOnGPU;
+        meshDataUpdateCount = 0;
+        streamMeshData = false;
+
+        useInterleavedLayout = false;
+        interleavedBuffer = nullptr;
+        ResetInterleavedLayout();
         this->attributeTransformer = attributeTransformer;
 
         doAttributeTransform = attributeTransformer == nullptr ? false : true;
@@ -57,6 +70,9 @@ namespace GTE {
         doNormalTransform = false;
         doTangentTransform = false;
         useBadGeometryShadowFix = false;
+        shaderTransformBuffersCreated = false;
+        transformedDataUploaded = false;
+        transformedBoundsValid = false;
 
         updateCount = 0;
     }
@@ -89,6 +105,7 @@ namespace GTE {
      */
     void SubMesh3DRenderer::Destroy() {
         DestroyBuffers();
+        DestroyVertexArray();
         SAFE_DELETE(attributeTransformer);
     }
 
@@ -101,6 +118,133 @@ namespace GTE {
                 DestroyBuffer(&attributeBuffers[i]);
             }
         }
+
+        DestroyBuffer(&interleavedBuffer);
+        ResetInterleavedLayout();
+        DestroyIndexBuffer();
+    }
+
+    /*
+     * Destroy the index buffer (if it exists) and set its pointer to nullptr.
+     */
+    void SubMesh3DRenderer::DestroyIndexBuffer() {
+        if (indexBuffer != nullptr) {
+            Engine::Instance()->GetGraphicsSystem()->DestroyIndexBuffer(indexBuffer);
+        }
+        indexBuffer = nullptr;
+        indexedAttributeData.clear();
+        InvalidateVertexArray();
+    }
+
+    /*
+     * Destroy the vertex array (if it exists) and set its pointer to nullptr.
+     */
+    void SubMesh3DRenderer::DestroyVertexArray() {
+        if (vertexArray != nullptr) {
+            Engine::Instance()->GetGraphicsSystem()->DestroyVertexArray(vertexArray);
+        }
+        vertexArray = nullptr;
+    }
+
+    /*
+     * Discard the layouts cached in [vertexArray]. This must happen whenever the attribute buffers (or
+     * the index buffer) are destroyed or re-created, or when [boundAttributeBuffers] changes.
+     */
+    void SubMesh3DRenderer::InvalidateVertexArray() {
+        if (vertexArray != nullptr)vertexArray->Invalidate();
+    }
+
+    /*
+     * Create [indexBuffer] and fill it with the index list of the target sub-mesh.
+     */
+    Bool SubMesh3DRenderer::InitIndexBuffer() {
+        SubMesh3DRef mesh = containerRenderer->GetSubMesh(targetSubMeshIndex);
+        ASSERT(mesh.IsValid(), "SubMesh3DRenderer::InitIndexBuffer -> Could not find matching sub mesh for sub renderer.");
+
+        DestroyIndexBuffer();
+
+        const std::vector<UInt32>& indices = mesh->GetIndices();
+
+        indexBuffer = Engine::Instance()->GetGraphicsSystem()->CreateIndexBuffer();
+        ASSERT(indexBuffer != nullptr, "SubMesh3DRenderer::InitIndexBuffer -> Graphics::CreateIndexBuffer() returned null.");
+        return indexBuffer->Init((UInt32)indices.size(), buffersOnGPU, indices.data());
+    }
+
+    /*
+     * Can the target sub-mesh be rendered from its unique vertices? This requires an index list, and
+     * every custom attribute to have exactly one entry per vertex so that it can be gathered. The index
+     * list does not distinguish between the face normals of the triangles that share a vertex (see
+     * SubMesh3D::BuildIndices()), so it is not used if any of the materials of the target sub-mesh read them.
+     */
+    Bool SubMesh3DRenderer::CanUseIndices() const {
+        SubMesh3DRef mesh = containerRenderer->GetSubMesh(targetSubMeshIndex);
+        ASSERT(mesh.IsValid(), "SubMesh3DRenderer::CanUseIndices -> Could not find matching sub mesh for sub renderer.");
+
+        if (!mesh->HasIndices())return false;
+
+        if (StandardAttributes::HasAttribute(mesh->GetStandardAttributeSet(), StandardAttribute::FaceNormal) &&
+            AnyMaterialUsesAttribute(AttributeDirectory::GetStandardVarID(StandardAttribute::FaceNormal)))return false;
+
+        for (UInt32 i = 0; i < mesh->GetCustomFloatAttributeBufferCount(); i++) {
+            CustomFloatAttributeBuffer * attrBuffer = mesh->GetCustomFloatAttributeBufferByOrder(i);
+            if (attrBuffer == nullptr || attrBuffer->GetSize() != mesh->GetTotalVertexCount())return false;
+        }
+
+        return true;
+    }
+
+    /*
+     * Does any of the materials that render the target sub-mesh use the attribute with the registered ID [attributeID]?
+     */
+    Bool SubMesh3DRenderer::AnyMaterialUsesAttribute(AttributeID attributeID) const {
+        UInt32 multiMaterialCount = containerRenderer->GetMultiMaterialCount();
+        if (multiMaterialCount == 0)return false;
+
+        MultiMaterialRef multiMaterial = containerRenderer->GetMultiMaterial(targetSubMeshIndex % multiMaterialCount);
+        if (!multiMaterial.IsValid())return false;
+
+        for (UInt32 m = 0; m < multiMaterial->GetMaterialCount(); m++) {
+            MaterialRef material = multiMaterial->GetMaterial(m);
+            if (material.IsValid() && material->UsesAttribute(attributeID))return true;
+        }
+
+        return false;
+    }
+
+    /*
+     * Copy the data of each unique vertex of the target sub-mesh from [data], which holds [componentCount]
+     * values for every (non-indexed) vertex, into [indexedAttributeData] and return a pointer to it.
+     */
+    const Real * SubMesh3DRenderer::GatherUniqueVertexData(const Real * data, UInt32 componentCount) {
+        SubMesh3DRef mesh = containerRenderer->GetSubMesh(targetSubMeshIndex);
+        ASSERT(mesh.IsValid(), "SubMesh3DRenderer::GatherUniqueVertexData -> Could not find matching sub mesh for sub renderer.");
+
+        const std::vector<UInt32>& sources = mesh->GetUniqueVertexSources();
+        UInt32 vertexCount = bufferVertexCount;
+        if (vertexCount > sources.size())vertexCount = (UInt32)sources.size();
+
+        if (indexedAttributeData.size() < bufferVertexCount * componentCount)indexedAttributeData.resize(bufferVertexCount * componentCount);
+
+        Real * dest = indexedAttributeData.data();
+        for (UInt32 v = 0; v < vertexCount; v++) {
+            memcpy(dest, data + sources[v] * componentCount, componentCount * sizeof(Real));
+            dest += componentCount;
+        }
+
+        return indexedAttributeData.data();
+    }
+
+    /*
+     * Mark every attribute as being stored in its own buffer.
+     */
+    void SubMesh3DRenderer::ResetInterleavedLayout() {
+        for (UInt32 i = 0; i < MAX_ATTRIBUTE_BUFFERS; i++) {
+            interleavedOffsets[i] = -1;
+            interleavedComponentCounts[i] = 0;
+        }
+        interleavedVertexSize = 0;
+        interleavedData.clear();
+        interleavedDataDirty = false;
     }
 
     /*
@@ -111,19 +255,22 @@ namespace GTE {
             Engine::Instance()->GetGraphicsSystem()->DestroyVertexAttributeBuffer(*buffer);
         }
         *buffer = nullptr;
+
+        // the buffer is either gone or about to be replaced
+        InvalidateVertexArray();
     }
 
     /*
      * Create and initialize an instance of VertexAttrBuffer.
      */
-    Bool SubMesh3DRenderer::InitBuffer(VertexAttrBuffer ** buffer, Int32 vertexCount, Int32 componentCount, Int32 stride, const Real * srcData) {
+    Bool SubMesh3DRenderer::InitBuffer(VertexAttrBuffer ** buffer, VertexAttrBufferUsage usage, Int32 vertexCount, Int32 componentCount, Int32 stride, const Real * srcData) {
         NONFATAL_ASSERT_RTRN(buffer != nullptr, "SubMesh3DRenderer::InitBuffer -> Attempted to initialize vertex attribute buffer from null pointer.", false, true);
 
         // if the buffer has already been created, destroy it first.
         DestroyBuffer(buffer);
 
         // create the vertex attribute buffer
-        *buffer = Engine::Instance()->GetGraphicsSystem()->CreateVertexAttributeBuffer();
+        *buffer = Engine::Instance()->GetGraphicsSystem()->CreateVertexAttributeBuffer(usage);
         ASSERT(*buffer != nullptr, "SubMesh3DRenderer::InitBuffer -> Graphics::CreateVertexAttrBuffer() returned null.");
         // initialize the vertex attribute buffer
         (*buffer)->Init(vertexCount, componentCount, stride, buffersOnGPU, srcData);
@@ -138,11 +285,27 @@ namespace GTE {
         // if the buffer already exists, destroy it first
         DestroyBuffer(&attributeBuffers[attr]);
         // create and initialize buffer
-        Bool initSuccess = InitBuffer(&attributeBuffers[attr], length, componentCount, stride, srcData);
+        Bool initSuccess = InitBuffer(&attributeBuffers[attr], GetAttributeBufferUsage(attr), length, componentCount, stride, srcData);
 
         return initSuccess;
     }
 
+    /*
+     * Determine how the vertex attribute buffer in [attributeBuffers] that corresponds to [attr] will be updated. Buffers
+     * that receive new data every frame are streamed, all others are updated by replacing their storage.
+     */
+    VertexAttrBufferUsage SubMesh3DRenderer::GetAttributeBufferUsage(UInt32 attr) const {
+        if (streamMeshData)return VertexAttrBufferUsage::Stream;
+        if (attr == (UInt32)StandardAttribute::ShadowPosition)return VertexAttrBufferUsage::Stream;
+
+        if (doAttributeTransform && attr < (UInt32)StandardAttribute::_Last) {
+            StandardAttributeSet attributesToTransform = attributeTransformer->GetActiveAttributes();
+            if (StandardAttributes::HasAttribute(attributesToTransform, (StandardAttribute)attr))return VertexAttrBufferUsage::Stream;
+        }
+
+        return VertexAttrBufferUsage::Dynamic;
+    }
+
     /*
      * Get the number of times this renderer has been updated with its target sub-mesh.
      */
@@ -157,6 +320,28 @@ namespace GTE {
         useBadGeometryShadowFix = useFix;
     }
 
+    /*
+     * Specify whether or not the attributes used by the materials of the target sub-mesh are packed into a single
+     * interleaved vertex attribute buffer. Attributes that are updated every frame are never interleaved.
+     */
+    void SubMesh3DRenderer::SetUseInterleavedLayout(Bool useInterleaved) {
+        if (useInterleavedLayout == useInterleaved)return;
+        useInterleavedLayout = useInterleaved;
+
+        // rebuild existing vertex attribute buffers with the new layout
+        if (totalVertexCount > 0) {
+            UpdateMeshAttributeBuffers();
+            CopyMeshData();
+        }
+    }
+
+    /*
+     * Are the attributes used by the materials of the target sub-mesh packed into a single interleaved buffer?
+     */
+    Bool SubMesh3DRenderer::GetUseInterleavedLayout() const {
+        return useInterleavedLayout;
+    }
+
     /*
      * Build a shadow volume for this mesh. For point lights, the position of the light is in
      * [lightPosDir], for directional lights the direction is also in [lightPosDir]. The
@@ -192,7 +377,7 @@ namespace GTE {
         // from that transformation to build the shadow volume. otherwise we want to use the original positions
         // from the target sub-mesh.
         Point3Array& positions = mesh->GetPositions();
-        Point3Array& positionsSource = doPositionTransform == true ? transformedPositions : positions;
+        Point3Array& positionsSource = UsesTransformedPositions() ? transformedPositions : positions;
         Real * positionsSrcPtr = positionsSource.GetDataPtr();
 
         // if this sub-renderer is utilizing an attribute transformer, we want to use the normals that result
@@ -449,6 +634,8 @@ namespace GTE {
      * Set the vertex attribute buffer data for the mesh face normals.
      */
     void SubMesh3DRenderer::SetFaceNormalData(Vector3Array& faceNormals) {
+        // face normals are not uploaded when rendering from the unique vertices (see UpdateMeshAttributeBuffers())
+        if (useIndices)return;
         SetAttributeData((Int32)StandardAttribute::FaceNormal, faceNormals.GetConstDataPtr());
     }
 
@@ -487,10 +674,67 @@ namespace GTE {
         SubMesh3DRef mesh = containerRenderer->GetSubMesh(targetSubMeshIndex);
         ASSERT(mesh.IsValid(), "SubMesh3DRenderer::SetAttributeData -> Could not find matching sub mesh for sub renderer.");
 
-        attributeBuffers[index]->SetRenderVertexCount(mesh->GetRenderVertexCount());
+        UInt32 renderVertexCount = useIndices ? bufferVertexCount : mesh->GetRenderVertexCount();
+
+        if (interleavedOffsets[index] >= 0) {
+            // copy the attribute into its slot in each interleaved vertex, the upload happens just before rendering
+            UInt32 componentCount = interleavedComponentCounts[index];
+            if (useIndices)data = GatherUniqueVertexData(data, componentCount);
+
+            UInt32 vertexCount = renderVertexCount;
+            if (vertexCount > bufferVertexCount)vertexCount = bufferVertexCount;
+
+            Real * dest = interleavedData.data() + interleavedOffsets[index];
+            for (UInt32 v = 0; v < vertexCount; v++) {
+                memcpy(dest, data + v * componentCount, componentCount * sizeof(Real));
+                dest += interleavedVertexSize;
+            }
+
+            interleavedDataDirty = true;
+            return;
+        }
+
+        if (useIndices)data = GatherUniqueVertexData(data, attributeBuffers[index]->GetComponentCount());
+
+        attributeBuffers[index]->SetRenderVertexCount(renderVertexCount);
         attributeBuffers[index]->SetData(data);
     }
 
+    /*
+     * Copy the contents of [interleavedData] to [interleavedBuffer].
+     */
+    void SubMesh3DRenderer::UploadInterleavedData() {
+        SubMesh3DRef mesh = containerRenderer->GetSubMesh(targetSubMeshIndex);
+        ASSERT(mesh.IsValid(), "SubMesh3DRenderer::UploadInterleavedData -> Could not find matching sub mesh for sub renderer.");
+
+        interleavedBuffer->SetRenderVertexCount(useIndices ? bufferVertexCount : mesh->GetRenderVertexCount());
+        interleavedBuffer->SetData(interleavedData.data());
+        interleavedDataDirty = false;
+    }
+
+    /*
+     * Should the attribute at [attr] in [attributeBuffers], with the registered ID [attributeID], be stored
+     * in the interleaved buffer? This is the case for attributes that are not updated every frame and that
+     * are used by at least one of the materials that render the target sub-mesh. If no materials have been
+     * assigned yet, every attribute that is not updated every frame is interleaved.
+     */
+    Bool SubMesh3DRenderer::ShouldInterleaveAttribute(UInt32 attr, AttributeID attributeID) {
+        if (!useInterleavedLayout || GetAttributeBufferUsage(attr) != VertexAttrBufferUsage::Dynamic)return false;
+
+        UInt32 multiMaterialCount = containerRenderer->GetMultiMaterialCount();
+        if (multiMaterialCount == 0)return true;
+
+        MultiMaterialRef multiMaterial = containerRenderer->GetMultiMaterial(targetSubMeshIndex % multiMaterialCount);
+        if (!multiMaterial.IsValid() || multiMaterial->GetMaterialCount() == 0)return true;
+
+        for (UInt32 m = 0; m < multiMaterial->GetMaterialCount(); m++) {
+            MaterialRef material = multiMaterial->GetMaterial(m);
+            if (material.IsValid() && material->UsesAttribute(attributeID))return true;
+        }
+
+        return false;
+    }
+
     /*
      * Update the vertex attribute buffers of this sub-renderer to reflect type & size of the attribute
      * data in the target sub-mesh.
@@ -505,17 +749,33 @@ namespace GTE {
 
         StandardAttributeSet meshAttributes = mesh->GetStandardAttributeSet();
 
+        // update the local vertex counts, when indexed only the unique vertices are stored
+        totalVertexCount = mesh->GetTotalVertexCount();
+        useIndices = CanUseIndices();
+        bufferVertexCount = useIndices ? mesh->GetUniqueVertexCount() : totalVertexCount;
+
         boundAttributeBuffers.clear();
         // loop through each standard attribute and create/initialize vertex attribute buffer for each
         for (UInt32 i = 0; i < (UInt32)StandardAttribute::_Last; i++) {
             StandardAttribute attr = (StandardAttribute)i;
             if (StandardAttributes::HasAttribute(meshAttributes, attr)) {
+                // no material reads the face normals when the unique vertices are rendered (see CanUseIndices())
+                if (attr == StandardAttribute::FaceNormal && useIndices)continue;
+
                 Int32 componentCount = 4;
                 if (attr == StandardAttribute::UVTexture0 || attr == StandardAttribute::UVTexture1)componentCount = 2;
 
+                // reserve a slot in the interleaved vertex instead of creating a separate buffer
+                if (ShouldInterleaveAttribute((UInt32)attr, AttributeDirectory::GetStandardVarID(attr))) {
+                    interleavedOffsets[(UInt32)attr] = interleavedVertexSize;
+                    interleavedComponentCounts[(UInt32)attr] = componentCount;
+                    interleavedVertexSize += componentCount;
+                    continue;
+                }
+
                 Int32 stride = 0;
 
-                Bool initSuccess = InitAttributeData((UInt32)attr, mesh->GetTotalVertexCount(), componentCount, stride, nullptr);
+                Bool initSuccess = InitAttributeData((UInt32)attr, bufferVertexCount, componentCount, stride, nullptr);
                 ASSERT(initSuccess, "SubMesh3DRenderer::UpdateMeshAttributeBuffers -> Could not initialize attribute data.");
 
                 VertexAttrBufferBinding binding(attributeBuffers[(UInt32)attr], AttributeDirectory::GetStandardVarID(attr));
@@ -529,15 +789,72 @@ namespace GTE {
             ASSERT(attrBuffer != nullptr, "SubMesh3DRenderer::UpdateMeshAttributeBuffers -> Null custom attribute found.");
 
             UInt32 attributeBufferIndex = firstCustomAttributeIndex + i;
-            Bool initSuccess = InitAttributeData(attributeBufferIndex, attrBuffer->GetSize(), attrBuffer->GetComponentCount(), 0, attrBuffer->GetDataPtr());
+
+            if (attrBuffer->GetSize() == mesh->GetTotalVertexCount() && ShouldInterleaveAttribute(attributeBufferIndex, attrBuffer->GetAttributeID())) {
+                interleavedOffsets[attributeBufferIndex] = interleavedVertexSize;
+                interleavedComponentCounts[attributeBufferIndex] = attrBuffer->GetComponentCount();
+                interleavedVertexSize += attrBuffer->GetComponentCount();
+                continue;
+            }
+
+            const Real * srcData = attrBuffer->GetDataPtr();
+            UInt32 size = attrBuffer->GetSize();
+            if (useIndices) {
+                srcData = GatherUniqueVertexData(srcData, attrBuffer->GetComponentCount());
+                size = bufferVertexCount;
+            }
+
+            Bool initSuccess = InitAttributeData(attributeBufferIndex, size, attrBuffer->GetComponentCount(), 0, srcData);
             ASSERT(initSuccess, "SubMesh3DRenderer::UpdateMeshAttributeBuffers -> Could not initialize attribute data.");
 
             VertexAttrBufferBinding binding(attributeBuffers[attributeBufferIndex], attrBuffer->GetAttributeID());
             boundAttributeBuffers.push_back(binding);
         }
 
-        // update the local vertex count
-        totalVertexCount = mesh->GetTotalVertexCount();
+        // create the interleaved buffer and bind each of the attributes it contains at its offset
+        if (interleavedVertexSize > 0) {
+            Bool initSuccess = InitBuffer(&interleavedBuffer, VertexAttrBufferUsage::Dynamic, bufferVertexCount, interleavedVertexSize, 0, nullptr);
+            ASSERT(initSuccess, "SubMesh3DRenderer::UpdateMeshAttributeBuffers -> Could not initialize interleaved attribute data.");
+            interleavedData.assign(bufferVertexCount * interleavedVertexSize, 0);
+
+            for (UInt32 i = 0; i < (UInt32)StandardAttribute::_Last; i++) {
+                if (interleavedOffsets[i] < 0)continue;
+                VertexAttrBufferBinding binding(interleavedBuffer, AttributeDirectory::GetStandardVarID((StandardAttribute)i), interleavedComponentCounts[i], interleavedOffsets[i]);
+                boundAttributeBuffers.push_back(binding);
+            }
+
+            for (UInt32 i = 0; i < mesh->GetCustomFloatAttributeBufferCount(); i++) {
+                UInt32 attributeBufferIndex = firstCustomAttributeIndex + i;
+                if (interleavedOffsets[attributeBufferIndex] < 0)continue;
+
+                CustomFloatAttributeBuffer * attrBuffer = mesh->GetCustomFloatAttributeBufferByOrder(i);
+                VertexAttrBufferBinding binding(interleavedBuffer, attrBuffer->GetAttributeID(), interleavedComponentCounts[attributeBufferIndex], interleavedOffsets[attributeBufferIndex]);
+                boundAttributeBuffers.push_back(binding);
+
+                SetAttributeData(attributeBufferIndex, attrBuffer->GetDataPtr());
+            }
+        }
+
+        // override materials may still read the face normals (e.g. the SSAO outline material), so when they are
+        // not uploaded the vertex normals are bound in their place
+        if (useIndices && StandardAttributes::HasAttribute(meshAttributes, StandardAttribute::FaceNormal) &&
+            StandardAttributes::HasAttribute(meshAttributes, StandardAttribute::Normal)) {
+            UInt32 normalIndex = (UInt32)StandardAttribute::Normal;
+            AttributeID faceNormalID = AttributeDirectory::GetStandardVarID(StandardAttribute::FaceNormal);
+            if (interleavedOffsets[normalIndex] >= 0) {
+                VertexAttrBufferBinding binding(interleavedBuffer, faceNormalID, interleavedComponentCounts[normalIndex], interleavedOffsets[normalIndex]);
+                boundAttributeBuffers.push_back(binding);
+            }
+            else {
+                VertexAttrBufferBinding binding(attributeBuffers[normalIndex], faceNormalID);
+                boundAttributeBuffers.push_back(binding);
+            }
+        }
+
+        if (useIndices) {
+            Bool indexInitSuccess = InitIndexBuffer();
+            ASSERT(indexInitSuccess, "SubMesh3DRenderer::UpdateMeshAttributeBuffers -> Could not initialize index buffer.");
+        }
 
         // TODO: current shadow volume data memory is allocated for all mesh renderers, regardless if they cast a
         // shadow or not. This could be quite wasteful, so implement a way to avoid this excess memory usage.
@@ -552,6 +869,47 @@ namespace GTE {
 
         storedAttributes = meshAttributes;
 
+        // any buffers for a shader-side transform were destroyed along with the others
+        shaderTransformBuffersCreated = false;
+        transformedDataUploaded = false;
+
+        return true;
+    }
+
+    /*
+     * Create the vertex attribute buffers for the extra attributes required by the attribute transformer when it
+     * leaves the transformation to the vertex shader, and fill them with data supplied by the transformer. This data
+     * is static, so this only needs to happen once for a given set of vertex attribute buffers.
+     */
+    Bool SubMesh3DRenderer::InitShaderTransformAttributeData() {
+        NONFATAL_ASSERT_RTRN(attributeTransformer != nullptr, "SubMesh3DRenderer::InitShaderTransformAttributeData -> Attribute transformer is null.", false, true);
+
+        std::vector<Real> data(totalVertexCount * 4);
+        StandardAttributeSet transformAttributes = attributeTransformer->GetShaderTransformAttributes();
+
+        for (UInt32 i = 0; i < (UInt32)StandardAttribute::_Last; i++) {
+            StandardAttribute attr = (StandardAttribute)i;
+            if (!StandardAttributes::HasAttribute(transformAttributes, attr))continue;
+
+            if (!attributeTransformer->GetShaderTransformAttributeData(attr, data.data(), totalVertexCount))return false;
+
+            const Real * srcData = useIndices ? GatherUniqueVertexData(data.data(), 4) : data.data();
+            Bool initSuccess = InitAttributeData((UInt32)attr, bufferVertexCount, 4, 0, srcData);
+            NONFATAL_ASSERT_RTRN(initSuccess, "SubMesh3DRenderer::InitShaderTransformAttributeData -> Could not initialize attribute data.", false, true);
+
+            // replace the binding for a buffer that was created for a previous attribute transformer
+            AttributeID varID = AttributeDirectory::GetStandardVarID(attr);
+            for (UInt32 b = 0; b < boundAttributeBuffers.size(); b++) {
+                if (boundAttributeBuffers[b].RegisteredAttributeID == varID) {
+                    boundAttributeBuffers.erase(boundAttributeBuffers.begin() + b);
+                    break;
+                }
+            }
+
+            VertexAttrBufferBinding binding(attributeBuffers[(UInt32)attr], varID);
+            boundAttributeBuffers.push_back(binding);
+        }
+
         return true;
     }
 
@@ -695,9 +1053,23 @@ namespace GTE {
 
         // if the vertex count of this sub-renderer does not match that of the target sub-mesh, call
         // the UpdateMeshAttributeBuffers() method to resize
-        if (mesh->GetTotalVertexCount() != totalVertexCount || mesh->GetStandardAttributeSet() != storedAttributes) {
+        if (mesh->GetTotalVertexCount() != totalVertexCount || mesh->GetStandardAttributeSet() != storedAttributes ||
+            CanUseIndices() != useIndices || (useIndices && mesh->GetUniqueVertexCount() != bufferVertexCount)) {
             updateSuccess = updateSuccess && UpdateMeshAttributeBuffers();
         }
+        else {
+            if (!streamMeshData && updateCount > 0) {
+                // the target sub-mesh keeps changing, so switch to streaming buffers for all of its attributes
+                meshDataUpdateCount++;
+                if (meshDataUpdateCount >= StreamMeshDataUpdateThreshold) {
+                    streamMeshData = true;
+                    updateSuccess = updateSuccess && UpdateMeshAttributeBuffers();
+                }
+            }
+
+            // the index list may have been rebuilt for the same number of unique vertices
+            if (useIndices)indexBuffer->SetData(mesh->GetIndices().data());
+        }
 
         // update this sub-renderer's attribute transformer so that its storage space for transformed vertex attributes
         // is large enough for the target sub-mesh
@@ -729,12 +1101,16 @@ namespace GTE {
         StandardAttributeSet materialAttributes = material->GetStandardAttributes();
         StandardAttributeSet meshAttributes = mesh->GetStandardAttributeSet();
 
+        // attributes supplied by the attribute transformer for a shader-side transform are not expected from the mesh
+        StandardAttributeSet transformAttributes = StandardAttributes::CreateAttributeSet();
+        if (doAttributeTransform)transformAttributes = attributeTransformer->GetShaderTransformAttributes();
+
         // look for mismatched shader attributes and mesh attributes
         for (Int32 i = 0; i < (Int32)StandardAttribute::_Last; i++) {
             StandardAttribute attr = (StandardAttribute)i;
 
             if (StandardAttributes::HasAttribute(materialAttributes, attr)) {
-                if (!StandardAttributes::HasAttribute(meshAttributes, attr)) {
+                if (!StandardAttributes::HasAttribute(meshAttributes, attr) && !StandardAttributes::HasAttribute(transformAttributes, attr)) {
                     std::string msg = std::string("Shader was expecting attribute ") + StandardAttributes::GetAttributeName(attr) + std::string(" but mesh does not have it.");
                     Debug::PrintWarning(msg);
                 }
@@ -754,9 +1130,14 @@ namespace GTE {
         }
         else {
             this->doAttributeTransform = true;
+            // re-create existing vertex attribute buffers so that the transformed attributes are streamed
+            if (totalVertexCount > 0)UpdateMeshAttributeBuffers();
             UpdateAttributeTransformerData();
             CopyMeshData();
         }
+
+        shaderTransformBuffersCreated = false;
+        transformedDataUploaded = false;
     }
 
     /*
@@ -773,6 +1154,21 @@ namespace GTE {
         return doAttributeTransform;
     }
 
+    /*
+     * Did the attribute transformer leave its transformation to the vertex shader for the current frame?
+     */
+    Bool SubMesh3DRenderer::UsesShaderTransform() const {
+        return doAttributeTransform && attributeTransformer->UsesShaderTransform();
+    }
+
+    /*
+     * Send the uniforms required by a shader-side transform (if one is active) to the shader of [material].
+     * Must be called after [material] has been activated and before Render().
+     */
+    void SubMesh3DRenderer::SendShaderTransformUniforms(MaterialRef material) {
+        if (UsesShaderTransform())attributeTransformer->SendShaderTransformUniforms(material);
+    }
+
     /*
      * Perform all processing & transformations that need to occur before the target sub-mesh is
      * actually rendered. This includes invoking the attribute transformer, if one exists.
@@ -781,10 +1177,24 @@ namespace GTE {
      * [modelInverse] - The inverse of [model].
      */
     void SubMesh3DRenderer::PreRender(const Matrix4x4& model, const Matrix4x4& modelInverse) {
-        ASSERT(containerRenderer != nullptr, "SubMesh3DRenderer::PreRender -> Container renderer is null.");
+        TransformAttributes(model, modelInverse);
+        UpdateTransformedAttributeData();
+    }
+
+    /*
+     * Invoke the attribute transformer, if one exists, and calculate the bounding box of the transformed
+     * positions. This only touches CPU-side data that belongs to this sub-renderer, so it is safe to call
+     * concurrently for different sub-renderers. UpdateTransformedAttributeData() must be called afterwards
+     * (on the main thread) to upload the results.
+     *
+     * [model] - The model matrix for the target sub-mesh. This matrix contains the local->world-space transformation.
+     * [modelInverse] - The inverse of [model].
+     */
+    void SubMesh3DRenderer::TransformAttributes(const Matrix4x4& model, const Matrix4x4& modelInverse) {
+        ASSERT(containerRenderer != nullptr, "SubMesh3DRenderer::TransformAttributes -> Container renderer is null.");
 
         SubMesh3DRef mesh = containerRenderer->GetSubMesh(targetSubMeshIndex);
-        ASSERT(mesh.IsValid(), "SubMesh3DRenderer::PreRender -> Could not find matching sub mesh for sub renderer.");
+        ASSERT(mesh.IsValid(), "SubMesh3DRenderer::TransformAttributes -> Could not find matching sub mesh for sub renderer.");
 
         if (doAttributeTransform) {
             // pass the local->world-space transformation matrix and its inverse to the attribute transformer
@@ -803,6 +1213,35 @@ namespace GTE {
                                                       mesh->GetCenter(), transformedCenter,
                                                       doPositionTransform, doNormalTransform, doTangentTransform);
 
+            transformedBoundsValid = false;
+            if (UsesTransformedPositions()) {
+                CalculateTransformedBoundingBox(mesh->GetRenderVertexCount());
+                transformedBoundsValid = true;
+            }
+            else if (doPositionTransform && attributeTransformer->UsesShaderTransform()) {
+                // the transformed positions only exist in the vertex shader, so the transformer has to bound them
+                transformedBoundsValid = attributeTransformer->GetShaderTransformBounds(transformedBoundingBoxCenter, transformedBoundingBox);
+            }
+        }
+        else transformedBoundsValid = false;
+    }
+
+    /*
+     * Upload the output of the attribute transformer (produced by TransformAttributes()) to the vertex attribute buffers.
+     */
+    void SubMesh3DRenderer::UpdateTransformedAttributeData() {
+        if (doAttributeTransform) {
+            if (attributeTransformer->UsesShaderTransform()) {
+                if (!shaderTransformBuffersCreated)shaderTransformBuffersCreated = InitShaderTransformAttributeData();
+
+                // the vertex shader needs the untransformed attributes of the target sub-mesh
+                if (transformedDataUploaded) {
+                    CopyMeshData();
+                    transformedDataUploaded = false;
+                }
+                return;
+            }
+
             // update the positions vertex attribute buffer with transformed positions
             if (doPositionTransform)SetPositionData(transformedPositions);
 
@@ -811,47 +1250,118 @@ namespace GTE {
 
             // update the tangents vertex attribute buffer with transformed tangents
             if (doTangentTransform)SetTangentData(transformedVertexTangents);
+
+            transformedDataUploaded = doPositionTransform || doNormalTransform || doTangentTransform;
         }
     }
 
     /*
-     * Get the position of the center of the target sub-mesh after attribute transformation. If the
-     * attribute transformer is not being used, then this value will be the same as the target
-     * sub-mesh's existing center.
+     * Calculate the bounding box of the first [vertexCount] transformed vertex positions and store
+     * it in [transformedBoundingBoxCenter] and [transformedBoundingBox].
+     */
+    void SubMesh3DRenderer::CalculateTransformedBoundingBox(UInt32 vertexCount) {
+        Real maxX, maxY, maxZ, minX, minY, minZ;
+        maxX = maxY = maxZ = minX = minY = minZ = 0;
+
+        if (vertexCount > transformedPositions.GetCount())vertexCount = transformedPositions.GetCount();
+
+        const Real * positionsPtr = transformedPositions.GetConstDataPtr();
+        for (UInt32 v = 0; v < vertexCount; v++) {
+            const Real * point = positionsPtr + (v * 4);
+            if (point[0] > maxX || v == 0)maxX = point[0];
+            if (point[0] < minX || v == 0)minX = point[0];
+            if (point[1] > maxY || v == 0)maxY = point[1];
+            if (point[1] < minY || v == 0)minY = point[1];
+            if (point[2] > maxZ || v == 0)maxZ = point[2];
+            if (point[2] < minZ || v == 0)minZ = point[2];
+        }
+
+        transformedBoundingBox.Set((maxX - minX) / 2.0f, (maxY - minY) / 2.0f, (maxZ - minZ) / 2.0f);
+        transformedBoundingBoxCenter.Set(minX + transformedBoundingBox.x, minY + transformedBoundingBox.y, minZ + transformedBoundingBox.z);
+    }
+
+    /*
+     * Are the vertex positions of the target sub-mesh replaced by the output of the attribute transformer?
+     */
+    Bool SubMesh3DRenderer::UsesTransformedPositions() const {
+        return doAttributeTransform && doPositionTransform && !attributeTransformer->UsesShaderTransform();
+    }
+
+    /*
+     * Get the position of the center of the target sub-mesh after attribute transformation (including a
+     * transformation performed by the vertex shader). If the attribute transformer is not being used, then
+     * this value will be the same as the target sub-mesh's existing center.
      */
     const Point3* SubMesh3DRenderer::GetFinalCenter() const {
+        if (doAttributeTransform && transformedBoundsValid) return &transformedCenter;
+
         SubMesh3DRef mesh = containerRenderer->GetSubMesh(targetSubMeshIndex);
-        ASSERT(mesh.IsValid(), "SubMesh3DRenderer::Render -> Could not find matching sub mesh for sub renderer.");
+        ASSERT(mesh.IsValid(), "SubMesh3DRenderer::GetFinalCenter -> Could not find matching sub mesh for sub renderer.");
+        return &(mesh->GetCenter());
+    }
 
-        StandardAttributeSet meshAttributes = mesh->GetStandardAttributeSet();
+    /*
+     * Get the center of the bounding box of the target sub-mesh after attribute transformation. If the
+     * attribute transformer is not being used, then this value will be the same as the target
+     * sub-mesh's existing center.
+     */
+    const Point3* SubMesh3DRenderer::GetFinalBoundingBoxCenter() const {
+        if (doAttributeTransform && transformedBoundsValid) return &transformedBoundingBoxCenter;
 
-        if (doAttributeTransform) {
-            StandardAttributeSet attributesToTransform = attributeTransformer->GetActiveAttributes();
+        SubMesh3DRef mesh = containerRenderer->GetSubMesh(targetSubMeshIndex);
+        ASSERT(mesh.IsValid(), "SubMesh3DRenderer::GetFinalBoundingBoxCenter -> Could not find matching sub mesh for sub renderer.");
+        return &(mesh->GetCenter());
+    }
 
-            if (StandardAttributes::HasAttribute(attributesToTransform, StandardAttribute::Position) &&
-                StandardAttributes::HasAttribute(meshAttributes, StandardAttribute::Position)) {
-                return &transformedCenter;
-            }
-        }
+    /*
+     * Get the extents of the bounding box of the target sub-mesh after attribute transformation. If the
+     * attribute transformer is not being used, then this value will be the same as the target
+     * sub-mesh's existing bounding box.
+     */
+    const Vector3* SubMesh3DRenderer::GetFinalBoundingBox() const {
+        if (doAttributeTransform && transformedBoundsValid) return &transformedBoundingBox;
 
-        return &(mesh->GetCenter());
+        SubMesh3DRef mesh = containerRenderer->GetSubMesh(targetSubMeshIndex);
+        ASSERT(mesh.IsValid(), "SubMesh3DRenderer::GetFinalBoundingBox -> Could not find matching sub mesh for sub renderer.");
+        return &(mesh->GetBoundingBox());
     }
 
     /*
      * Render the target sub-mesh.
      */
     void SubMesh3DRenderer::Render() {
-        ASSERT(containerRenderer != nullptr, "SubMesh3DRendererGL::Render -> Container renderer is null.");
+        RenderInstances(1);
+    }
+
+    /*
+     * Render [instanceCount] copies of the target sub-mesh with a single draw call. The active
+     * material's shader is expected to position each copy using the standard uniform InstanceTransforms.
+     */
+    void SubMesh3DRenderer::RenderInstances(UInt32 instanceCount) {
+        ASSERT(containerRenderer != nullptr, "SubMesh3DRendererGL::RenderInstances -> Container renderer is null.");
 
         SubMesh3DRef mesh = containerRenderer->GetSubMesh(targetSubMeshIndex);
-        ASSERT(mesh.IsValid(), "SubMesh3DRendererGL::Render -> Could not find matching sub mesh for sub renderer.");
+        ASSERT(mesh.IsValid(), "SubMesh3DRendererGL::RenderInstances -> Could not find matching sub mesh for sub renderer.");
 
         if (ShouldUpdateFromMesh())this->UpdateFromMesh();
+        if (interleavedDataDirty)UploadInterleavedData();
 
         MaterialRef currentMaterial = Engine::Instance()->GetGraphicsSystem()->GetActiveMaterial();
-        ASSERT(ValidateMaterialForMesh(currentMaterial), "SubMesh3DRendererGL::Render -> Invalid material for the current mesh.");
+        ASSERT(ValidateMaterialForMesh(currentMaterial), "SubMesh3DRendererGL::RenderInstances -> Invalid material for the current mesh.");
+
+        if (vertexArray == nullptr) {
+            vertexArray = Engine::Instance()->GetGraphicsSystem()->CreateVertexArray();
+            ASSERT(vertexArray != nullptr, "SubMesh3DRendererGL::RenderInstances -> Graphics::CreateVertexArray() returned null.");
+        }
 
-        Engine::Instance()->GetGraphicsSystem()->RenderTriangles(boundAttributeBuffers, mesh->GetRenderVertexCount(), true);
+        if (useIndices) {
+            Engine::Instance()->GetGraphicsSystem()->RenderTrianglesInstanced(boundAttributeBuffers, vertexArray, indexBuffer, bufferVertexCount,
+                                                                              mesh->GetRenderVertexCount(), instanceCount, true);
+        }
+        else {
+            Engine::Instance()->GetGraphicsSystem()->RenderTrianglesInstanced(boundAttributeBuffers, vertexArray, mesh->GetRenderVertexCount(),
+                                                                              instanceCount, true);
+        }
     }
 
     /*
@@ -15,6 +15,26 @@
  * does its rendering. An example would be SkinnedMesh3DRenderer, which supplies a special
  * kind of AttributeTransformer that performs vertex skinning.
  *
+ * An attribute transformer may also leave the transformation to the vertex shader, in which case
+ * the untransformed attributes of the target sub-mesh are rendered along with the extra attributes
+ * and uniforms supplied by the transformer. The transformed bounds are not available in that case,
+ * so the bounds of the untransformed sub-mesh are used instead.
+ *
+ * Vertex attribute buffers that are updated every frame (the output of the attribute transformer,
+ * shadow volumes, and the attributes of target sub-meshes that keep changing, such as particle
+ * systems) are created as streaming buffers (see VertexAttrBufferUsage::Stream).
+ *
+ * Optionally (see SetUseInterleavedLayout()), the remaining attributes that are used by the materials
+ * of the target sub-mesh are packed into a single interleaved buffer, which is bound once per
+ * attribute with the appropriate offset and stride. Attributes that are not used by any material
+ * keep their own buffers, so override materials still find every attribute of the target sub-mesh.
+ *
+ * If the target sub-mesh has an index list of unique vertices (see SubMesh3D::SetBuildIndices()), the
+ * vertex attribute buffers hold only the unique vertices and the sub-mesh is drawn with an index buffer.
+ * The index list ignores face normals, so it is only used if none of the materials of the target sub-mesh
+ * read them; the face normals are then not uploaded, and the vertex normals are bound in their place.
+ * Shadow volumes are built from the full (non-indexed) attribute arrays and are always drawn without one.
+ *
  * Certain functionality for performing rendering, such as making the call into the chosen
  * API to actually draw the target sub-mesh's triangles, will vary from platform to
  * platform (e.g. from OpenGL to DirectX). SubMesh3DRenderer is designed so that this
@@ -31,6 +51,7 @@
 #include "scene/sceneobjectcomponent.h"
 #include "graphics/stdattributes.h"
 #include "graphics/render/material.h"
+#include "graphics/render/vertexattrbuffer.h"
 #include "graphics/color/color4.h"
 #include "graphics/uv/uv2.h"
 #include "attributetransformer.h"
@@ -43,6 +64,8 @@ namespace GTE {
     class Graphics;
     class VertexAttrBufferGL;
     class VertexAttrBuffer;
+    class IndexBuffer;
+    class VertexArray;
     class SubMesh3D;
     class Material;
     class Matrix4x4;
@@ -70,13 +93,44 @@ namespace GTE {
         VertexAttrBuffer * attributeBuffers[MAX_ATTRIBUTE_BUFFERS];
         std::vector<VertexAttrBufferBinding> boundAttributeBuffers;
         std::vector<VertexAttrBufferBinding> boundShadowVolumeAttributeBuffers;
+        // caches the layout of [boundAttributeBuffers] (and [indexBuffer]) for each shader program the target sub-mesh is rendered with
+        VertexArray * vertexArray;
+
+        // should the attributes used by the materials of the target sub-mesh be packed into a single interleaved buffer?
+        Bool useInterleavedLayout;
+        // buffer that holds the interleaved attributes, or nullptr if no attributes are interleaved
+        VertexAttrBuffer * interleavedBuffer;
+        // offset (in Real values) of each attribute in [attributeBuffers] within an interleaved vertex, or -1 if the attribute has its own buffer
+        Int32 interleavedOffsets[MAX_ATTRIBUTE_BUFFERS];
+        // number of components of each attribute in [attributeBuffers] that is stored in [interleavedBuffer]
+        UInt32 interleavedComponentCounts[MAX_ATTRIBUTE_BUFFERS];
+        // number of Real values in a single interleaved vertex
+        UInt32 interleavedVertexSize;
+        // CPU-side copy of the contents of [interleavedBuffer]
+        std::vector<Real> interleavedData;
+        // has [interleavedData] changed since it was last copied to [interleavedBuffer]?
+        Bool interleavedDataDirty;
 
-        // number of vertices for which storage vertex attributes in [attributeBuffers] is allocated
+        // number of vertices in the target sub-mesh when the vertex attribute buffers were last created
         UInt32 totalVertexCount;
+        // number of vertices for which storage in each buffer in [attributeBuffers] is allocated
+        UInt32 bufferVertexCount;
+        // is the target sub-mesh rendered from its unique vertices with [indexBuffer]?
+        Bool useIndices;
+        // indices of the unique vertices that make up each triangle of the target sub-mesh
+        IndexBuffer * indexBuffer;
+        // staging area used to gather the data of the unique vertices from the attribute arrays of the target sub-mesh
+        std::vector<Real> indexedAttributeData;
         // mask that describes the different types of attributes stored in [storedAttributes]
         StandardAttributeSet storedAttributes;
         // are the vertex attributes stored in GPU-based buffers?
         Bool buffersOnGPU;
+        // number of times the data of the target sub-mesh has changed without a change to its structure
+        UInt32 meshDataUpdateCount;
+        // is the target sub-mesh treated as dynamic geometry, so that all of its attributes are streamed?
+        Bool streamMeshData;
+        // number of data-only updates of the target sub-mesh after which it is treated as dynamic geometry
+        const static UInt32 StreamMeshDataUpdateThreshold = 2;
 
         // number of times this renderer has been updated from its mesh
         UInt32 updateCount;
@@ -93,10 +147,21 @@ namespace GTE {
 
         // pointer to this sub-renderer's attribute transformer
         AttributeTransformer * attributeTransformer;
+        // have the vertex attribute buffers required by a shader-side transform (see AttributeTransformer::UsesShaderTransform()) been created?
+        Bool shaderTransformBuffersCreated;
+        // do the vertex attribute buffers hold the output of the attribute transformer rather than the data of the target sub-mesh?
+        Bool transformedDataUploaded;
         // if vertex positions are transformed, the transformed positions are stored here
         Point3Array transformedPositions;
         // if vertex positions are transformed, the transformed center position is stored here
         Point3 transformedCenter;
+        // if vertex positions are transformed, the center of the bounding box that encloses them is stored here
+        Point3 transformedBoundingBoxCenter;
+        // if vertex positions are transformed, the extents of the bounding box that encloses them are stored here
+        Vector3 transformedBoundingBox;
+        // do [transformedCenter], [transformedBoundingBoxCenter] and [transformedBoundingBox] describe the transformed positions? this is
+        // also the case when the positions are transformed by the vertex shader, if the attribute transformer can bound them
+        Bool transformedBoundsValid;
         // if normals are transformed, the transformed vertex normals are stored here
         Vector3Array transformedVertexNormals;
         // if normals are transformed, the transformed face normals are stored here
@@ -114,11 +179,22 @@ namespace GTE {
         void SetContainerRenderer(Mesh3DRenderer * renderer);
         void SetTargetSubMeshIndex(UInt32 index);
 
-        Bool InitBuffer(VertexAttrBuffer ** buffer, Int32 vertexCount, Int32 componentCount, Int32 stride, const Real * srcData);
+        Bool InitBuffer(VertexAttrBuffer ** buffer, VertexAttrBufferUsage usage, Int32 vertexCount, Int32 componentCount, Int32 stride, const Real * srcData);
         void Destroy();
         void DestroyBuffers();
         void DestroyBuffer(VertexAttrBuffer ** buffer);
+        void DestroyIndexBuffer();
+        void DestroyVertexArray();
+        void InvalidateVertexArray();
+        Bool InitIndexBuffer();
+        const Real * GatherUniqueVertexData(const Real * data, UInt32 componentCount);
+        Bool CanUseIndices() const;
+        Bool AnyMaterialUsesAttribute(AttributeID attributeID) const;
         Bool InitAttributeData(UInt32 attr, Int32 length, Int32 componentCount, Int32 stride, const Real * srcData);
+        VertexAttrBufferUsage GetAttributeBufferUsage(UInt32 attr) const;
+        Bool ShouldInterleaveAttribute(UInt32 attr, AttributeID attributeID);
+        void ResetInterleavedLayout();
+        void UploadInterleavedData();
 
         const Point3Array * GetShadowVolumePositions();
         void SetShadowVolumePositionData(const Point3Array * points);
@@ -134,6 +210,7 @@ namespace GTE {
         Bool ValidateMaterialForMesh(MaterialRef material);
         Bool UpdateMeshAttributeBuffers();
         Bool UpdateAttributeTransformerData();
+        Bool InitShaderTransformAttributeData();
 
         SubMesh3DRenderer(AttributeTransformer * attributeTransformer);
         SubMesh3DRenderer(Bool buffersOnGPU, AttributeTransformer * attributeTransformer);
@@ -144,12 +221,16 @@ namespace GTE {
         void UpdateUpdateCount();
 
         UInt32 GetFirstCustomAttributeBufferIndex();
+        Bool UsesTransformedPositions() const;
+        void CalculateTransformedBoundingBox(UInt32 vertexCount);
 
     public:
 
         UInt32 GetUpdateCount() const;
 
         void SetUseBadGeometryShadowFix(Bool useFix);
+        void SetUseInterleavedLayout(Bool useInterleaved);
+        Bool GetUseInterleavedLayout() const;
 
         void BuildShadowVolume(const Vector3& lightPosDir, Bool directional, Bool backFacesFrontCap);
         void UpdateFromMesh();
@@ -157,12 +238,19 @@ namespace GTE {
         void SetAttributeTransformer(AttributeTransformer * attributeTransformer);
         AttributeTransformer * GetAttributeTransformer();
         Bool DoesAttributeTransform() const;
+        Bool UsesShaderTransform() const;
+        void SendShaderTransformUniforms(MaterialRef material);
 
         const Point3* GetFinalCenter() const;
+        const Point3* GetFinalBoundingBoxCenter() const;
+        const Vector3* GetFinalBoundingBox() const;
 
         void PreRender(const Matrix4x4& modelView, const Matrix4x4& modelViewInverse);
+        void TransformAttributes(const Matrix4x4& model, const Matrix4x4& modelInverse);
+        void UpdateTransformedAttributeData();
 
         void Render();
+        void RenderInstances(UInt32 instanceCount);
         void RenderShadowVolume();
         void RenderShadowVolume(const Point3Array * shadowVolumePositions);
     };
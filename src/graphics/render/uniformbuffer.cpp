@@ -0,0 +1,31 @@
+#include "uniformbuffer.h"
+
+namespace GTE {
+    /*
+     * Single constructor.
+     */
+    UniformBuffer::UniformBuffer(UniformBufferUsage usage) : size(0), usage(usage) {
+
+    }
+
+    /*
+     * Clean-up.
+     */
+    UniformBuffer::~UniformBuffer() {
+
+    }
+
+    /*
+     * Get the size of this buffer in bytes.
+     */
+    UInt32 UniformBuffer::GetSize() const {
+        return size;
+    }
+
+    /*
+     * Get the way this buffer's data is updated.
+     */
+    UniformBufferUsage UniformBuffer::GetUsage() const {
+        return usage;
+    }
+}
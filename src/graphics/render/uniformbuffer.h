@@ -0,0 +1,59 @@
+/*
+ * class: UniformBuffer
+ *
+ * author: Mark Kellogg
+ *
+ * Base class for uniform buffers, which hold the values of all members of a uniform
+ * block (see StandardUniformBlock). A uniform buffer is bound to a single binding point
+ * when it is initialized, so its contents are shared by every shader program that declares
+ * the corresponding block. Filling it once per frame or pass replaces sending the same
+ * values to each material's shader separately.
+ *
+ * The data passed to SetData() must already be in the memory layout of the block
+ * (e.g. std140).
+ *
+ * The way a buffer's data is updated is chosen when the buffer is created (see
+ * UniformBufferUsage). Buffers that are updated for every draw call, such as the
+ * buffer for the per-object block, should use UniformBufferUsage::Stream.
+ *
+ * As with VertexAttrBuffer, the platform specific implementation of UniformBuffer is
+ * in a deriving class.
+ *
+ */
+
+#ifndef _GTE_UNIFORM_BUFFER_H_
+#define _GTE_UNIFORM_BUFFER_H_
+
+#include "engine.h"
+
+namespace GTE {
+    enum class UniformBufferUsage {
+        // data is updated at most a few times per frame, each update replaces the buffer's storage
+        Dynamic = 0,
+        // data is updated for each draw call, updates are written to successive blocks of a ring and
+        // the binding point is re-attached to the block that was written, so an update never has to wait
+        // for draw calls that read earlier data
+        Stream = 1
+    };
+
+    class UniformBuffer {
+    protected:
+
+        // size of the buffer in bytes
+        UInt32 size;
+        // how the buffer's data is updated
+        UniformBufferUsage usage;
+
+    public:
+
+        UniformBuffer(UniformBufferUsage usage);
+        virtual ~UniformBuffer();
+
+        virtual Bool Init(UInt32 size, UInt32 bindingIndex) = 0;
+        virtual void SetData(const void * srcData) = 0;
+        UInt32 GetSize() const;
+        UniformBufferUsage GetUsage() const;
+    };
+}
+
+#endif
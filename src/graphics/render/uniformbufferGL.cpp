@@ -0,0 +1,191 @@
+#include "graphics/gl_include.h"
+#include "uniformbufferGL.h"
+#include "global/global.h"
+#include "global/assert.h"
+#include "debug/gtedebug.h"
+
+#include <string.h>
+
+namespace GTE {
+    /*
+     * Single constructor.
+     */
+    UniformBufferGL::UniformBufferGL(UniformBufferUsage usage) : UniformBuffer(usage), gpuBufferID(0), bindingIndex(0),
+        streamBlockStride(0), currentStreamBlock(0), streamBlockWritten(false) {
+        for (UInt32 i = 0; i < StreamSegmentCount; i++) {
+            streamSegmentFences[i] = 0;
+        }
+    }
+
+    /*
+     * Clean-up.
+     */
+    UniformBufferGL::~UniformBufferGL() {
+        Destroy();
+    }
+
+    /*
+     * Initialize the buffer.
+     *
+     * [size] - The size of the buffer in bytes.
+     * [bindingIndex] - The uniform buffer binding point to which the buffer is attached.
+     */
+    Bool UniformBufferGL::Init(UInt32 size, UInt32 bindingIndex) {
+        // if this buffer has already be initialized we need to destroy it and start fresh
+        Destroy();
+
+        this->size = size;
+        this->bindingIndex = bindingIndex;
+
+        glGenBuffers(1, &gpuBufferID);
+        NONFATAL_ASSERT_RTRN(gpuBufferID > 0, "UniformBufferGL::Init -> Unable to create uniform buffer object.", false, true);
+
+        // a streaming buffer allocates the storage for all of its blocks up front, and is attached
+        // to its binding point one block at a time
+        if (usage == UniformBufferUsage::Stream) {
+            GLint offsetAlignment = 0;
+            glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &offsetAlignment);
+            if (offsetAlignment <= 0)offsetAlignment = 256;
+
+            streamBlockStride = ((size + offsetAlignment - 1) / offsetAlignment) * offsetAlignment;
+            currentStreamBlock = 0;
+            streamBlockWritten = false;
+
+            glBindBuffer(GL_UNIFORM_BUFFER, gpuBufferID);
+            glBufferData(GL_UNIFORM_BUFFER, streamBlockStride * StreamBlockCount, nullptr, GL_STREAM_DRAW);
+            glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+            glBindBufferRange(GL_UNIFORM_BUFFER, bindingIndex, gpuBufferID, 0, size);
+            return true;
+        }
+
+        glBindBuffer(GL_UNIFORM_BUFFER, gpuBufferID);
+        glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+        // the indexed binding refers to the buffer object, not its storage, so it survives SetData()
+        glBindBufferBase(GL_UNIFORM_BUFFER, bindingIndex, gpuBufferID);
+
+        return true;
+    }
+
+    /*
+     * Replace the entire contents of the buffer with the first [size] bytes of [srcData]. The
+     * storage is orphaned first, so that draw calls still reading the previous contents do not
+     * cause the update to wait for them.
+     */
+    void UniformBufferGL::SetData(const void * srcData) {
+        NONFATAL_ASSERT(srcData != nullptr, "UniformBufferGL::SetData -> 'srcData' is null.", true);
+        if (gpuBufferID == 0)return;
+
+        if (usage == UniformBufferUsage::Stream) {
+            StreamData(srcData);
+            return;
+        }
+
+        glBindBuffer(GL_UNIFORM_BUFFER, gpuBufferID);
+        glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, size, srcData);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    /*
+     * Write the first [size] bytes of [srcData] to the next block of a streaming buffer, and attach
+     * the binding point of the buffer to that block.
+     *
+     * All draw calls that read the blocks of the current segment have already been issued when the
+     * first block of the next segment is written, so a fence placed then marks the end of the current
+     * segment's use. The next segment can be written without synchronization once the GPU has passed
+     * its fence. If it has not, the storage is orphaned: the driver hands out fresh memory and releases
+     * the old storage when the GPU is done with it, so neither case waits.
+     */
+    void UniformBufferGL::StreamData(const void * srcData) {
+        const UInt32 blocksPerSegment = StreamBlockCount / StreamSegmentCount;
+
+        glBindBuffer(GL_UNIFORM_BUFFER, gpuBufferID);
+
+        UInt32 nextBlock = currentStreamBlock;
+        if (streamBlockWritten) {
+            nextBlock = (currentStreamBlock + 1) % StreamBlockCount;
+
+            UInt32 currentSegment = currentStreamBlock / blocksPerSegment;
+            UInt32 nextSegment = nextBlock / blocksPerSegment;
+            if (nextSegment != currentSegment) {
+                if (streamSegmentFences[currentSegment] != 0)glDeleteSync(streamSegmentFences[currentSegment]);
+                streamSegmentFences[currentSegment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+                Bool segmentAvailable = true;
+                if (streamSegmentFences[nextSegment] != 0) {
+                    GLenum waitResult = glClientWaitSync(streamSegmentFences[nextSegment], 0, 0);
+                    segmentAvailable = waitResult == GL_ALREADY_SIGNALED || waitResult == GL_CONDITION_SATISFIED;
+                }
+
+                if (segmentAvailable) {
+                    if (streamSegmentFences[nextSegment] != 0)glDeleteSync(streamSegmentFences[nextSegment]);
+                    streamSegmentFences[nextSegment] = 0;
+                }
+                else {
+                    glBufferData(GL_UNIFORM_BUFFER, streamBlockStride * StreamBlockCount, nullptr, GL_STREAM_DRAW);
+                    DestroyStreamFences();
+                    nextBlock = 0;
+                }
+            }
+        }
+
+        UInt32 offset = nextBlock * streamBlockStride;
+        GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+        void * target = glMapBufferRange(GL_UNIFORM_BUFFER, offset, size, access);
+        if (target != nullptr) {
+            memcpy(target, srcData, size);
+            glUnmapBuffer(GL_UNIFORM_BUFFER);
+        }
+        else {
+            glBufferSubData(GL_UNIFORM_BUFFER, offset, size, srcData);
+        }
+
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+        glBindBufferRange(GL_UNIFORM_BUFFER, bindingIndex, gpuBufferID, offset, size);
+
+        currentStreamBlock = nextBlock;
+        streamBlockWritten = true;
+    }
+
+    /*
+     * Delete the fences for all segments of a streaming buffer.
+     */
+    void UniformBufferGL::DestroyStreamFences() {
+        for (UInt32 i = 0; i < StreamSegmentCount; i++) {
+            if (streamSegmentFences[i] != 0)glDeleteSync(streamSegmentFences[i]);
+            streamSegmentFences[i] = 0;
+        }
+    }
+
+    /*
+     * Deallocate & destroy the buffer.
+     */
+    void UniformBufferGL::Destroy() {
+        DestroyStreamFences();
+        streamBlockWritten = false;
+        currentStreamBlock = 0;
+
+        if (gpuBufferID) {
+            glDeleteBuffers(1, &gpuBufferID);
+            gpuBufferID = 0;
+        }
+    }
+
+    /*
+     *  Get the OpenGL id of the uniform buffer object.
+     */
+    GLuint UniformBufferGL::GetGPUBufferID() const {
+        return gpuBufferID;
+    }
+
+    /*
+     * Get the index of the uniform buffer binding point to which the buffer is attached.
+     */
+    UInt32 UniformBufferGL::GetBindingIndex() const {
+        return bindingIndex;
+    }
+}
@@ -0,0 +1,69 @@
+/*
+ * class: UniformBufferGL
+ *
+ * author: Mark Kellogg
+ *
+ * OpenGL-specific implementation of UniformBuffer. The buffer object is attached to its
+ * indexed GL_UNIFORM_BUFFER binding point once, so it never has to be bound again
+ * for drawing.
+ *
+ * A buffer with UniformBufferUsage::Stream usage allocates storage for [StreamBlockCount]
+ * copies of its data, each aligned to GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT. Each update is
+ * written to the next block of the ring through an unsynchronized mapping, and the binding
+ * point is re-attached to that block with glBindBufferRange(). The ring is divided into
+ * [StreamSegmentCount] segments; a fence is placed after the last use of each segment, and if
+ * the GPU has not yet passed the fence of the segment that is about to be reused, the whole
+ * storage is orphaned instead of waiting on it.
+ *
+ */
+
+#ifndef _GTE_UNIFORM_BUFFER_GL_H_
+#define _GTE_UNIFORM_BUFFER_GL_H_
+
+#include "engine.h"
+#include "graphics/gl_include.h"
+#include "uniformbuffer.h"
+
+namespace GTE {
+    class UniformBufferGL : public GTE::UniformBuffer {
+        // necessary during rendering
+        friend class GraphicsGL;
+
+        // number of copies of the buffer data held by a streaming buffer
+        static const UInt32 StreamBlockCount = 4096;
+        // number of fenced segments the blocks of a streaming buffer are divided into
+        static const UInt32 StreamSegmentCount = 4;
+
+        // OpenGL id for the buffer
+        GLuint gpuBufferID;
+        // index of the uniform buffer binding point to which the buffer is attached
+        UInt32 bindingIndex;
+
+        // distance (in bytes) between successive blocks of a streaming buffer
+        UInt32 streamBlockStride;
+        // index of the block of a streaming buffer that holds the current data
+        UInt32 currentStreamBlock;
+        // has any data been written to the current block of a streaming buffer?
+        Bool streamBlockWritten;
+        // fence that follows the last use of each segment of a streaming buffer (or 0)
+        GLsync streamSegmentFences[StreamSegmentCount];
+
+    protected:
+
+        UniformBufferGL(UniformBufferUsage usage);
+        virtual ~UniformBufferGL();
+
+        void Destroy();
+        void DestroyStreamFences();
+        void StreamData(const void * srcData);
+
+    public:
+
+        Bool Init(UInt32 size, UInt32 bindingIndex);
+        void SetData(const void * srcData);
+        GLuint GetGPUBufferID() const;
+        UInt32 GetBindingIndex() const;
+    };
+}
+
+#endif
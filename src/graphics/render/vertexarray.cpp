@@ -0,0 +1,17 @@
+#include "vertexarray.h"
+
+namespace GTE {
+    /*
+     * Single constructor.
+     */
+    VertexArray::VertexArray() {
+
+    }
+
+    /*
+     * Clean-up.
+     */
+    VertexArray::~VertexArray() {
+
+    }
+}
@@ -0,0 +1,36 @@
+/*
+ * class: VertexArray
+ *
+ * author: Mark Kellogg
+ *
+ * Base class for vertex arrays, which capture the layout of a set of vertex attribute
+ * buffers (and optionally an index buffer) as it is seen by a shader program, so that
+ * the layout only has to be specified once instead of on every draw call.
+ *
+ * A single VertexArray belongs to one set of buffers (e.g. those of a SubMesh3DRenderer)
+ * and holds a separate layout for each shader program with which those buffers are drawn.
+ * The layouts are built lazily by the graphics system. Invalidate() must be called whenever
+ * the set of buffers changes.
+ *
+ * As with VertexAttrBuffer, the platform specific implementation of VertexArray is
+ * in a deriving class.
+ *
+ */
+
+#ifndef _GTE_VERTEX_ARRAY_H_
+#define _GTE_VERTEX_ARRAY_H_
+
+#include "engine.h"
+
+namespace GTE {
+    class VertexArray {
+    public:
+
+        VertexArray();
+        virtual ~VertexArray();
+
+        virtual void Invalidate() = 0;
+    };
+}
+
+#endif
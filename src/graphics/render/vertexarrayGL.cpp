@@ -0,0 +1,60 @@
+#include "graphics/gl_include.h"
+#include "vertexarrayGL.h"
+#include "graphics/graphicsGL.h"
+#include "global/global.h"
+#include "global/assert.h"
+#include "debug/gtedebug.h"
+
+namespace GTE {
+    /*
+     * Single constructor.
+     */
+    VertexArrayGL::VertexArrayGL() : VertexArray() {
+
+    }
+
+    /*
+     * Clean-up.
+     */
+    VertexArrayGL::~VertexArrayGL() {
+        Destroy();
+    }
+
+    /*
+     * Delete the VAO of every shader program.
+     */
+    void VertexArrayGL::Destroy() {
+        GraphicsGL * graphicsGL = dynamic_cast<GraphicsGL*>(Engine::Instance()->GetGraphicsSystem());
+
+        for (std::unordered_map<GLuint, ProgramVertexArray>::iterator itr = programVertexArrays.begin(); itr != programVertexArrays.end(); ++itr) {
+            GLuint vertexArrayID = itr->second.VertexArrayID;
+            if (vertexArrayID == 0)continue;
+
+            // deleting a bound VAO reverts the binding to zero, which the graphics system needs to know about
+            if (graphicsGL != nullptr)graphicsGL->ResetVertexArrayBinding(vertexArrayID);
+            glDeleteVertexArrays(1, &vertexArrayID);
+        }
+
+        programVertexArrays.clear();
+    }
+
+    /*
+     * Get the VAO for the shader program with OpenGL id [programID], creating it if it does not exist yet.
+     * A newly created VAO has no attribute sources, so it will be specified the first time it is used.
+     */
+    VertexArrayGL::ProgramVertexArray& VertexArrayGL::GetProgramVertexArray(GLuint programID) {
+        ProgramVertexArray& programVertexArray = programVertexArrays[programID];
+        if (programVertexArray.VertexArrayID == 0) {
+            glGenVertexArrays(1, &programVertexArray.VertexArrayID);
+        }
+
+        return programVertexArray;
+    }
+
+    /*
+     * Delete the VAOs of all shader programs so that they are rebuilt the next time they are used.
+     */
+    void VertexArrayGL::Invalidate() {
+        Destroy();
+    }
+}
@@ -0,0 +1,88 @@
+/*
+ * class: VertexArrayGL
+ *
+ * author: Mark Kellogg
+ *
+ * OpenGL-specific implementation of VertexArray. Each shader program gets its own
+ * vertex array object (VAO), since the attribute locations differ from one program
+ * to the next.
+ *
+ * Along with each VAO the buffer & offset that each attribute pointer was specified with
+ * are recorded. The offset of a streaming VertexAttrBufferGL moves to a different segment
+ * of its storage with each update, so when a recorded offset no longer matches, the attribute
+ * pointers of that VAO are specified again.
+ *
+ */
+
+#ifndef _GTE_VERTEX_ARRAY_GL_H_
+#define _GTE_VERTEX_ARRAY_GL_H_
+
+#include <vector>
+#include <unordered_map>
+
+#include "engine.h"
+#include "graphics/gl_include.h"
+#include "vertexarray.h"
+
+namespace GTE {
+    class VertexArrayGL : public GTE::VertexArray {
+        // necessary during rendering
+        friend class GraphicsGL;
+
+        class AttributeSource {
+        public:
+
+            // OpenGL id of the VBO that holds the attribute, or 0 if the attribute data is stored on the CPU
+            GLuint BufferID;
+            // offset into the VBO or pointer to the CPU-side data with which the attribute pointer was specified
+            const void * Pointer;
+
+            AttributeSource() {
+                BufferID = 0;
+                Pointer = nullptr;
+            }
+
+            AttributeSource(GLuint bufferID, const void * pointer) {
+                BufferID = bufferID;
+                Pointer = pointer;
+            }
+
+            Bool operator==(const AttributeSource& other) const {
+                return BufferID == other.BufferID && Pointer == other.Pointer;
+            }
+        };
+
+        class ProgramVertexArray {
+        public:
+
+            // OpenGL id of the vertex array object
+            GLuint VertexArrayID;
+            // source of each attribute pointer, in the same order as the bindings the VAO was specified with
+            std::vector<AttributeSource> AttributeSources;
+            // OpenGL id of the element array buffer bound to the VAO (or 0)
+            GLuint ElementBufferID;
+
+            ProgramVertexArray() {
+                VertexArrayID = 0;
+                ElementBufferID = 0;
+            }
+        };
+
+        // VAO for each shader program, keyed by the OpenGL id of the program
+        std::unordered_map<GLuint, ProgramVertexArray> programVertexArrays;
+
+    protected:
+
+        VertexArrayGL();
+        virtual ~VertexArrayGL();
+
+        void Destroy();
+        ProgramVertexArray& GetProgramVertexArray(GLuint programID);
+
+    public:
+
+        void Invalidate() override;
+    };
+}
+
+#endif
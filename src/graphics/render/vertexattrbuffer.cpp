@@ -4,7 +4,7 @@ namespace GTE {
     /*
      * Single constructor.
      */
-    VertexAttrBuffer::VertexAttrBuffer() : componentCount(0), totalVertexCount(0), renderVertexCount(0), stride(0) {
+    VertexAttrBuffer::VertexAttrBuffer(VertexAttrBufferUsage usage) : componentCount(0), totalVertexCount(0), renderVertexCount(0), stride(0), usage(usage) {
 
     }
 
@@ -49,4 +49,11 @@ namespace GTE {
     Int32 VertexAttrBuffer::GetStride() const {
         return stride;
     }
+
+    /*
+     * Get the method by which this buffer's data is updated.
+     */
+    VertexAttrBufferUsage VertexAttrBuffer::GetUsage() const {
+        return usage;
+    }
 }
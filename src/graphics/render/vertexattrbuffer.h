@@ -11,6 +11,10 @@
  * platform to platform (e.g. from OpenGL to DirectX), VertexAttrBuffer is designed to
  * have its platform specific implementation in a deriving class.
  *
+ * The way a buffer's data is updated is chosen when the buffer is created (see
+ * VertexAttrBufferUsage). Buffers whose contents change every frame, such as skinned
+ * vertex positions or shadow volumes, should use VertexAttrBufferUsage::Stream.
+ *
  */
 
 #ifndef _GTE_VERTEX_ATTR_BUFFER_H_
@@ -19,6 +23,14 @@
 #include "engine.h"
 
 namespace GTE {
+    enum class VertexAttrBufferUsage {
+        // data is updated occasionally, each update replaces the buffer's storage
+        Dynamic = 0,
+        // data is updated one or more times per frame, updates are written to a ring of
+        // buffer segments so they do not have to wait for the GPU to finish reading earlier data
+        Stream = 1
+    };
+
     class VertexAttrBuffer {
     protected:
 
@@ -31,10 +43,12 @@ namespace GTE {
         UInt32 renderVertexCount;
         // padding space between attributes, can be used to achieve optimal memory alignment
         UInt32 stride;
+        // how the buffer's data is updated
+        VertexAttrBufferUsage usage;
 
     public:
 
-        VertexAttrBuffer();
+        VertexAttrBuffer(VertexAttrBufferUsage usage);
         virtual ~VertexAttrBuffer();
 
         virtual Bool Init(UInt32 totalVertexCount, UInt32 componentCount, UInt32 stride, Bool dataOnGPU, const Real *srcData) = 0;
@@ -44,6 +58,7 @@ namespace GTE {
         Int32 GetRenderVertexCount() const;
         Int32 GetComponentCount() const;
         Int32 GetStride() const;
+        VertexAttrBufferUsage GetUsage() const;
     };
 }
 
@@ -10,8 +10,13 @@ namespace GTE {
     /*
      * Single constructor.
      */
-    VertexAttrBufferGL::VertexAttrBufferGL() : VertexAttrBuffer(), data(nullptr), dataOnGPU(false), gpuBufferID(0) {
-
+    VertexAttrBufferGL::VertexAttrBufferGL(VertexAttrBufferUsage usage) : VertexAttrBuffer(usage), data(nullptr), dataOnGPU(false), gpuBufferID(0) {
+        streamSegmentSize = 0;
+        currentStreamSegment = 0;
+        streamSegmentWritten = false;
+        for (UInt32 i = 0; i < StreamSegmentCount; i++) {
+            streamSegmentFences[i] = 0;
+        }
     }
 
     /*
@@ -89,6 +94,17 @@ namespace GTE {
             else this->dataOnGPU = false;
         }
 
+        // a streaming VBO allocates the storage for all of its segments up front
+        if (this->dataOnGPU && usage == VertexAttrBufferUsage::Stream) {
+            streamSegmentSize = ((fullDataSize + StreamSegmentAlignment - 1) / StreamSegmentAlignment) * StreamSegmentAlignment;
+            currentStreamSegment = 0;
+            streamSegmentWritten = false;
+
+            glBindBuffer(GL_ARRAY_BUFFER, gpuBufferID);
+            glBufferData(GL_ARRAY_BUFFER, streamSegmentSize * StreamSegmentCount, nullptr, GL_STREAM_DRAW);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        }
+
         if (srcData != nullptr)InitData(srcData);
 
         return true;
@@ -97,7 +113,10 @@ namespace GTE {
     void VertexAttrBufferGL::InitData(const Real * srcData) {
         Int32 fullDataSize = CalcTotalFullSize();
 
-        if (dataOnGPU) {
+        if (dataOnGPU && usage == VertexAttrBufferUsage::Stream) {
+            StreamData(srcData, fullDataSize);
+        }
+        else if (dataOnGPU) {
             glBindBuffer(GL_ARRAY_BUFFER, gpuBufferID);
             glBufferData(GL_ARRAY_BUFFER, fullDataSize, nullptr, GL_DYNAMIC_DRAW);
             glBufferSubData(GL_ARRAY_BUFFER, 0, fullDataSize, srcData);
@@ -112,7 +131,10 @@ namespace GTE {
     void VertexAttrBufferGL::SetData(const Real * srcData) {
         Int32 fullDataSize = CalcRenderFullSize();
 
-        if (dataOnGPU) {
+        if (dataOnGPU && usage == VertexAttrBufferUsage::Stream) {
+            StreamData(srcData, fullDataSize);
+        }
+        else if (dataOnGPU) {
             glBindBuffer(GL_ARRAY_BUFFER, gpuBufferID);
             glBufferData(GL_ARRAY_BUFFER, fullDataSize, nullptr, GL_DYNAMIC_DRAW);
             glBufferSubData(GL_ARRAY_BUFFER, 0, fullDataSize, srcData);
@@ -133,10 +155,74 @@ namespace GTE {
         else memcpy(data, srcData, fullDataSize);
     }
 
+    /*
+     * Write the first [size] bytes of [srcData] to the next segment of a streaming VBO.
+     *
+     * All draw calls that read the current segment have already been issued, so a fence placed now
+     * marks the end of its use. The next segment can be written without synchronization once the GPU
+     * has passed that segment's fence. If it has not, the storage is orphaned: the driver hands out
+     * fresh memory and releases the old storage when the GPU is done with it, so neither case waits.
+     */
+    void VertexAttrBufferGL::StreamData(const Real * srcData, UInt32 size) {
+        glBindBuffer(GL_ARRAY_BUFFER, gpuBufferID);
+
+        UInt32 nextSegment = currentStreamSegment;
+        if (streamSegmentWritten) {
+            if (streamSegmentFences[currentStreamSegment] != 0)glDeleteSync(streamSegmentFences[currentStreamSegment]);
+            streamSegmentFences[currentStreamSegment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            nextSegment = (currentStreamSegment + 1) % StreamSegmentCount;
+        }
+
+        Bool segmentAvailable = true;
+        if (streamSegmentFences[nextSegment] != 0) {
+            GLenum waitResult = glClientWaitSync(streamSegmentFences[nextSegment], 0, 0);
+            segmentAvailable = waitResult == GL_ALREADY_SIGNALED || waitResult == GL_CONDITION_SATISFIED;
+        }
+
+        if (segmentAvailable) {
+            if (streamSegmentFences[nextSegment] != 0)glDeleteSync(streamSegmentFences[nextSegment]);
+            streamSegmentFences[nextSegment] = 0;
+        }
+        else {
+            glBufferData(GL_ARRAY_BUFFER, streamSegmentSize * StreamSegmentCount, nullptr, GL_STREAM_DRAW);
+            DestroyStreamFences();
+            nextSegment = 0;
+        }
+
+        GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+        void * target = glMapBufferRange(GL_ARRAY_BUFFER, nextSegment * streamSegmentSize, size, access);
+        if (target != nullptr) {
+            memcpy(target, srcData, size);
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+        }
+        else {
+            glBufferSubData(GL_ARRAY_BUFFER, nextSegment * streamSegmentSize, size, srcData);
+        }
+
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        currentStreamSegment = nextSegment;
+        streamSegmentWritten = true;
+    }
+
+    /*
+     * Delete the fences for all segments of a streaming VBO.
+     */
+    void VertexAttrBufferGL::DestroyStreamFences() {
+        for (UInt32 i = 0; i < StreamSegmentCount; i++) {
+            if (streamSegmentFences[i] != 0)glDeleteSync(streamSegmentFences[i]);
+            streamSegmentFences[i] = 0;
+        }
+    }
+
     /*
      * Deallocate & destroy the buffer.
      */
     void VertexAttrBufferGL::Destroy() {
+        DestroyStreamFences();
+        streamSegmentWritten = false;
+        currentStreamSegment = 0;
+
         if (dataOnGPU && gpuBufferID) {
             glDeleteBuffers(1, &gpuBufferID);
             dataOnGPU = false;
@@ -175,4 +261,12 @@ namespace GTE {
     GLuint VertexAttrBufferGL::GetGPUBufferID() const {
         return gpuBufferID;
     }
+
+    /*
+     * Get the offset (in bytes) of the current data in the VBO. This is only non-zero for
+     * streaming VBOs.
+     */
+    UInt32 VertexAttrBufferGL::GetGPUBufferOffset() const {
+        return currentStreamSegment * streamSegmentSize;
+    }
 }
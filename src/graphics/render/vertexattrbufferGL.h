@@ -5,6 +5,13 @@
  *
  * OpenGL-specific implementation of VertexAttrBuffer.
  *
+ * A VBO with VertexAttrBufferUsage::Stream usage allocates storage for [StreamSegmentCount]
+ * copies of its data. Each update is written to the next segment in the ring through an
+ * unsynchronized mapping, so the driver never has to wait for draw calls that are still reading
+ * the previous data. A fence is placed after the last use of each segment; if the GPU has not
+ * yet passed the fence of the segment that is about to be reused, the whole storage is orphaned
+ * instead of waiting on it.
+ *
  */
 
 #ifndef _GTE_VERTEX_ATTR_BUFFER_GL_H_
@@ -20,6 +27,11 @@ namespace GTE {
         // necessary during rendering
         friend class GraphicsGL;
 
+        // number of copies of the buffer data held by a streaming VBO
+        static const UInt32 StreamSegmentCount = 4;
+        // alignment (in bytes) of each segment of a streaming VBO
+        static const UInt32 StreamSegmentAlignment = 256;
+
         // raw pointer to the buffer data
         Real * data;
         // is this a VBO?
@@ -27,17 +39,28 @@ namespace GTE {
         // OpenGL id for the buffer
         GLuint gpuBufferID;
 
+        // size (in bytes) of a single segment of a streaming VBO
+        UInt32 streamSegmentSize;
+        // index of the segment of a streaming VBO that holds the current data
+        UInt32 currentStreamSegment;
+        // has any data been written to the current segment of a streaming VBO?
+        Bool streamSegmentWritten;
+        // fence that follows the last use of each segment of a streaming VBO (or 0)
+        GLsync streamSegmentFences[StreamSegmentCount];
+
     protected:
 
-        VertexAttrBufferGL();
+        VertexAttrBufferGL(VertexAttrBufferUsage usage);
         virtual ~VertexAttrBufferGL();
 
         void Destroy();
+        void DestroyStreamFences();
         UInt32 CalcTotalFullSize() const;
         UInt32 CalcTotalFloatCount() const;
         UInt32 CalcRenderFullSize() const;
         UInt32 CalcRenderFloatCount() const;
         void InitData(const Real * srcData);
+        void StreamData(const Real * srcData, UInt32 size);
 
     public:
 
@@ -47,6 +70,7 @@ namespace GTE {
         const Real * GetConstDataPtr() const;
         Bool IsGPUBuffer() const;
         GLuint GetGPUBufferID() const;
+        UInt32 GetGPUBufferOffset() const;
     };
 }
 
@@ -13,6 +13,8 @@ namespace GTE {
         LightingEnabled = true;
         DepthPassEnabled = true;
 
+        FrustumCullingEnabled = true;
+
         SSAOEnabled = true;
         SSAOMode = SSAORenderMode::Standard;
 
@@ -16,6 +16,7 @@
 #include "geometry/transform.h"
 #include "geometry/point/point3.h"
 #include "geometry/vector/vector3.h"
+#include "graphics/view/frustum.h"
 #include "base/bitmask.h"
 
 namespace GTE {
@@ -40,6 +41,9 @@ namespace GTE {
         Bool LightingEnabled;
         Bool DepthPassEnabled;
 
+        Bool FrustumCullingEnabled;
+        Frustum ViewFrustum;
+
         Bool SSAOEnabled;
         SSAORenderMode SSAOMode;
 
@@ -18,6 +18,7 @@
 #include "engine.h"
 #include "object/engineobject.h"
 #include "shadersource.h"
+#include "graphics/stduniforms.h"
 
 #include <string>
 
@@ -51,6 +52,7 @@ namespace GTE {
         virtual Int32 GetAttributeVarID(const std::string& varName) const = 0;
         virtual Int32 GetUniformVarID(const std::string& varName) const = 0;
         virtual void SendBufferToShader(Int32 varID, const VertexAttrBuffer * buffer) = 0;
+        virtual void SendBufferToShader(Int32 varID, const VertexAttrBuffer * buffer, UInt32 componentCount, UInt32 offset) = 0;
 
         virtual void SendUniformToShader(Int32 varID, UInt32 samplerUnitIndex, const TextureSharedPtr texture) = 0;
         virtual void SendUniformToShader(Int32 varID, const Matrix4x4& mat) = 0;
@@ -76,6 +78,8 @@ namespace GTE {
 
         virtual UInt32 GetAttributeCount() const = 0;
         virtual const AttributeDescriptor * GetAttributeDescriptor(UInt32 index) const = 0;
+
+        virtual Bool UsesUniformBlock(StandardUniformBlock block) const = 0;
     };
 }
 
@@ -1,5 +1,7 @@
 #include <memory.h>
+#include <stdint.h>
 
+#include "engine.h"
 #include "shader.h"
 #include "graphics/gl_include.h"
 #include "shaderGL.h"
@@ -11,6 +13,7 @@
 #include "geometry/vector/vector3.h"
 #include "graphics/texture/texture.h"
 #include "graphics/texture/textureGL.h"
+#include "graphics/graphicsGL.h"
 #include "graphics/color/color4.h"
 #include "debug/gtedebug.h"
 #include "global/global.h"
@@ -36,6 +39,8 @@ namespace GTE {
 
         attributes = nullptr;
         uniforms = nullptr;
+
+        uniformBlockMask = 0;
     }
 
     /*
@@ -68,6 +73,8 @@ namespace GTE {
             glDeleteProgram(programID);
             programID = 0;
         }
+        uniformShadowValues.clear();
+        uniformBlockMask = 0;
     }
 
     /*
@@ -170,6 +177,7 @@ namespace GTE {
         glAttachShader(programID, vertexShaderID);
         glAttachShader(programID, fragmentShaderID);
         glLinkProgram(programID);
+        uniformShadowValues.clear();
 
         GLint programLinked;
         glGetProgramiv(programID, GL_LINK_STATUS, &programLinked);
@@ -181,6 +189,9 @@ namespace GTE {
             return false;
         }
 
+        // connect the standard uniform blocks to their binding points
+        BindUniformBlocks();
+
         // get information about all uniforms and attributes in the shaders
         if (!StoreUniformAndAttributeInfo()) {
             return false;
@@ -283,6 +294,7 @@ namespace GTE {
             memset(uniforms, 0, sizeof(UniformDescriptor*)*totalUniforms);
 
             UInt32 samplerUnitIndex = 0;
+            UInt32 storedUniforms = 0;
             // loop through each uniform and query OpenGL for information
             // about that uniform
             for (Int32 i = 0; i < totalUniforms; i++) {
@@ -291,11 +303,18 @@ namespace GTE {
                 GLenum type = GL_ZERO;
                 Char name[126];
 
+                // members of uniform blocks have no location and are set through uniform buffers
+                GLuint uniformIndex = GLuint(i);
+                GLint blockIndex = -1;
+                glGetActiveUniformsiv(programID, 1, &uniformIndex, GL_UNIFORM_BLOCK_INDEX, &blockIndex);
+                if (blockIndex >= 0)continue;
+
                 glGetActiveUniform(programID, GLuint(i), 125, &nameLen, &size, &type, name);
                 GLuint loc = glGetUniformLocation(programID, name);
 
                 UniformDescriptor * desc = new(std::nothrow)  UniformDescriptor();
-                uniforms[i] = desc;
+                uniforms[storedUniforms] = desc;
+                storedUniforms++;
 
                 desc->ShaderVarID = loc;
                 desc->Size = size;
@@ -344,7 +363,7 @@ namespace GTE {
 
             }
 
-            uniformCount = totalUniforms;
+            uniformCount = storedUniforms;
         }
 
         Int32 totalAttributes = -1;
@@ -409,6 +428,22 @@ namespace GTE {
         return true;
     }
 
+    /*
+     * Bind each standard uniform block declared by the program to the uniform buffer binding point
+     * with the same index, and record which of the blocks are declared in [uniformBlockMask].
+     */
+    void ShaderGL::BindUniformBlocks() {
+        uniformBlockMask = 0;
+        for (UInt32 i = 0; i < (UInt32)StandardUniformBlock::_Last; i++) {
+            const std::string& blockName = StandardUniforms::GetUniformBlockName((StandardUniformBlock)i);
+            GLuint blockIndex = glGetUniformBlockIndex(programID, blockName.c_str());
+            if (blockIndex == GL_INVALID_INDEX)continue;
+
+            glUniformBlockBinding(programID, blockIndex, i);
+            uniformBlockMask |= 1 << i;
+        }
+    }
+
     /*
      * Get the shader var ID/location of attribute corresponding to [varName]
      */
@@ -453,7 +488,7 @@ namespace GTE {
 
         if (bufferGL->IsGPUBuffer()) {
             glBindBuffer(GL_ARRAY_BUFFER, bufferGL->GetGPUBufferID());
-            glVertexAttribPointer(varID, componentCount, GL_FLOAT, 0, stride, 0);
+            glVertexAttribPointer(varID, componentCount, GL_FLOAT, 0, stride, (const GLvoid *)(uintptr_t)bufferGL->GetGPUBufferOffset());
         }
         else {
             glVertexAttribPointer(varID, componentCount, GL_FLOAT, GL_FALSE, stride, data);
@@ -461,6 +496,36 @@ namespace GTE {
         glEnableVertexAttribArray(0);
     }
 
+    /*
+     * Set the value for a shader attribute that is stored in an interleaved buffer, in which each vertex is made up
+     * of all the components in [buffer] (see VertexAttrBuffer::GetComponentCount()).
+     *
+     * [varID] - shader var ID/location of the attribute for which the value is to be set.
+     * [buffer] - interleaved attribute data
+     * [componentCount] - number of components of the attribute
+     * [offset] - offset (in Real values) of the attribute within each vertex
+     */
+    void ShaderGL::SendBufferToShader(Int32 varID, const VertexAttrBuffer * buffer, UInt32 componentCount, UInt32 offset) {
+        if (varID < 0)return;
+
+        const VertexAttrBufferGL * bufferGL = dynamic_cast<const VertexAttrBufferGL *>(buffer);
+        ASSERT(bufferGL != nullptr, "ShaderGL::SendBufferToShader -> buffer is not VertexAttrBufferGL !!");
+
+        const Real * data = bufferGL->GetConstDataPtr();
+        GLsizei vertexSize = (GLsizei)((bufferGL->GetComponentCount() + bufferGL->GetStride()) * sizeof(Real));
+
+        glEnableVertexAttribArray((GLuint)varID);
+
+        if (bufferGL->IsGPUBuffer()) {
+            glBindBuffer(GL_ARRAY_BUFFER, bufferGL->GetGPUBufferID());
+            glVertexAttribPointer(varID, componentCount, GL_FLOAT, GL_FALSE, vertexSize, (const GLvoid *)(uintptr_t)(bufferGL->GetGPUBufferOffset() + offset * sizeof(Real)));
+        }
+        else {
+            glVertexAttribPointer(varID, componentCount, GL_FLOAT, GL_FALSE, vertexSize, data + offset);
+        }
+        glEnableVertexAttribArray(0);
+    }
+
     /*
      * Set the value for a sampler uniform.
      *
@@ -475,23 +540,14 @@ namespace GTE {
 
         ASSERT(texGL != nullptr, "ShaderGL::SendUniformToShader(UInt32, Texture *) -> texture is not TextureGL !!");
 
-        GLenum textureUnit;
+        GraphicsGL * graphicsGL = dynamic_cast<GraphicsGL *>(Engine::Instance()->GetGraphicsSystem());
+        ASSERT(graphicsGL != nullptr, "ShaderGL::SendUniformToShader(UInt32, Texture *) -> graphics system is not GraphicsGL !!");
 
-        if (samplerUnitIndex == 0)textureUnit = GL_TEXTURE0;
-        else if (samplerUnitIndex == 1)textureUnit = GL_TEXTURE1;
-        else if (samplerUnitIndex == 2)textureUnit = GL_TEXTURE2;
-        else if (samplerUnitIndex == 3)textureUnit = GL_TEXTURE3;
-
-        if (samplerUnitIndex <= 3) {
-            glActiveTexture(textureUnit);
-            if (texGL->GetAttributes().IsCube)
-                glBindTexture(GL_TEXTURE_CUBE_MAP, texGL->GetTextureID());
-            else
-                glBindTexture(GL_TEXTURE_2D, texGL->GetTextureID());
+        if (samplerUnitIndex < GraphicsGL::MaxTextureUnits) {
+            // the texture is only bound if it isn't already bound to the sampler unit
+            graphicsGL->BindTexture(samplerUnitIndex, texGL);
             SendUniformToShader(varID, (Int32)samplerUnitIndex);
         }
-
-        glActiveTexture(GL_TEXTURE0);
     }
 
     /*
@@ -501,6 +557,8 @@ namespace GTE {
      * [mat] - Holds 4x4 matrix data to be sent.
      */
     void ShaderGL::SendUniformToShader(Int32 varID, const Matrix4x4& mat) {
+        if (!UpdateUniformShadowValue(varID, mat.GetConstDataPtr(), 16 * sizeof(Real)))return;
+
 #ifdef _GTE_Real_DoublePrecision
         glUniformMatrix4dv(varID, 1, GL_FALSE, mat.GetConstDataPtr());
 #else
@@ -516,6 +574,7 @@ namespace GTE {
      * [count] - Length of the array.
      */
     void ShaderGL::SendUniformToShader4FV(Int32 varID, const Real * data, UInt32 count) {
+        if (!UpdateUniformShadowValue(varID, data, count * 4 * sizeof(Real)))return;
 
 #ifdef _GTE_Real_DoublePrecision
         glUniform4dv(varID, 1, data);
@@ -532,6 +591,8 @@ namespace GTE {
      * [count] - Length of the array.
      */
     void ShaderGL::SendUniformToShader3FV(Int32 varID, const Real * data, UInt32 count) {
+        if (!UpdateUniformShadowValue(varID, data, count * 3 * sizeof(Real)))return;
+
 #ifdef _GTE_Real_DoublePrecision
         glUniform3dv(varID, 1, data);
 #else
@@ -547,6 +608,8 @@ namespace GTE {
      * [count] - Length of the array.
      */
     void ShaderGL::SendUniformToShader2FV(Int32 varID, const Real * data, UInt32 count) {
+        if (!UpdateUniformShadowValue(varID, data, count * 2 * sizeof(Real)))return;
+
 #ifdef _GTE_Real_DoublePrecision
         glUniform2dv(varID, 1, data);
 #else
@@ -562,6 +625,8 @@ namespace GTE {
      * [count] - Length of the array.
      */
     void ShaderGL::SendUniformToShader1FV(Int32 varID, const Real * data, UInt32 count) {
+        if (!UpdateUniformShadowValue(varID, data, count * sizeof(Real)))return;
+
 #ifdef _GTE_Real_DoublePrecision
         glUniform2dv(varID, 1, data);
 #else
@@ -577,6 +642,7 @@ namespace GTE {
      * [count] - Length of the array.
      */
     void ShaderGL::SendUniformToShader4IV(Int32 varID, const Int32 * data, UInt32 count) {
+        if (!UpdateUniformShadowValue(varID, data, count * 4 * sizeof(Int32)))return;
         glUniform4iv(varID, count, data);
     }
 
@@ -588,6 +654,7 @@ namespace GTE {
      * [count] - Length of the array.
      */
     void ShaderGL::SendUniformToShader3IV(Int32 varID, const Int32 * data, UInt32 count) {
+        if (!UpdateUniformShadowValue(varID, data, count * 3 * sizeof(Int32)))return;
         glUniform3iv(varID, count, data);
     }
 
@@ -599,6 +666,7 @@ namespace GTE {
      * [count] - Length of the array.
      */
     void ShaderGL::SendUniformToShader2IV(Int32 varID, const Int32 * data, UInt32 count) {
+        if (!UpdateUniformShadowValue(varID, data, count * 2 * sizeof(Int32)))return;
         glUniform2iv(varID, count, data);
     }
 
@@ -610,6 +678,7 @@ namespace GTE {
      * [count] - Length of the array.
      */
     void ShaderGL::SendUniformToShader1IV(Int32 varID, const Int32 * data, UInt32 count) {
+        if (!UpdateUniformShadowValue(varID, data, count * sizeof(Int32)))return;
         glUniform1iv(varID, count, data);
     }
 
@@ -621,6 +690,8 @@ namespace GTE {
      * [count] - Length of the array.
      */
     void ShaderGL::SendUniformToShaderM4x4V(Int32 varID, const Matrix4x4 * mat, UInt32 count) {
+        if (!UpdateUniformShadowValue(varID, mat->GetConstDataPtr(), count * 16 * sizeof(Real)))return;
+
 #ifdef _GTE_Real_DoublePrecision
         glUniformMatrix4dv(varID, count, false, mat->GetConstDataPtr());
 #else
@@ -635,6 +706,8 @@ namespace GTE {
      * [data] - Holds vector data to be sent.
      */
     void ShaderGL::SendUniformToShader(Int32 varID, Real x, Real y, Real z, Real w) {
+        Real values[] = { x, y, z, w };
+        if (!UpdateUniformShadowValue(varID, values, sizeof(values)))return;
         glUniform4f(varID, x, y, z, w);
     }
 
@@ -645,6 +718,8 @@ namespace GTE {
      * [data] - Holds vector data to be sent.
      */
     void ShaderGL::SendUniformToShader(Int32 varID, Real x, Real y, Real z) {
+        Real values[] = { x, y, z };
+        if (!UpdateUniformShadowValue(varID, values, sizeof(values)))return;
         glUniform3f(varID, x, y, z);
     }
 
@@ -655,6 +730,8 @@ namespace GTE {
      * [data] - Holds vector data to be sent.
      */
     void ShaderGL::SendUniformToShader(Int32 varID, Real x, Real y) {
+        Real values[] = { x, y };
+        if (!UpdateUniformShadowValue(varID, values, sizeof(values)))return;
         glUniform2f(varID, x, y);
     }
 
@@ -665,6 +742,7 @@ namespace GTE {
      * [data] - Uniform data to be sent.
      */
     void ShaderGL::SendUniformToShader(Int32 varID, Real  data) {
+        if (!UpdateUniformShadowValue(varID, &data, sizeof(Real)))return;
         glUniform1f(varID, data);
     }
 
@@ -675,9 +753,38 @@ namespace GTE {
      * [data] - Uniform data to be sent.
      */
     void ShaderGL::SendUniformToShader(Int32 varID, Int32  data) {
+        if (!UpdateUniformShadowValue(varID, &data, sizeof(Int32)))return;
         glUniform1i(varID, data);
     }
 
+    /*
+     * Compare the [size] bytes of uniform data in [data] with the shadow copy of the value last sent to the uniform
+     * at location [varID], and make [data] the new shadow copy. Returns false if the value does not need to be sent,
+     * either because it matches the shadow copy or because [varID] is not a valid location.
+     *
+     * The program must be the active program, which is always the case for uniforms sent through the material
+     * that is currently active in the graphics system.
+     */
+    Bool ShaderGL::UpdateUniformShadowValue(Int32 varID, const void * data, UInt32 size) {
+        if (varID < 0)return false;
+        if ((UInt32)varID >= MaxShadowedUniformLocation)return true;
+
+        if ((UInt32)varID >= uniformShadowValues.size())uniformShadowValues.resize(varID + 1);
+        UniformShadowValue& shadow = uniformShadowValues[varID];
+
+        if (size > MaxShadowedUniformSize) {
+            shadow.IsSet = false;
+            return true;
+        }
+
+        if (shadow.IsSet && shadow.Size == size && memcmp(shadow.Data, data, size) == 0)return false;
+
+        memcpy(shadow.Data, data, size);
+        shadow.Size = size;
+        shadow.IsSet = true;
+        return true;
+    }
+
     /*
      * Get number of uniforms exposed by this shader
      */
@@ -723,4 +830,12 @@ namespace GTE {
         }
         return nullptr;
     }
+
+    /*
+     * Does the program declare the standard uniform block [block]?
+     */
+    Bool ShaderGL::UsesUniformBlock(StandardUniformBlock block) const {
+        if (block >= StandardUniformBlock::_Last)return false;
+        return (uniformBlockMask & (1 << (UInt32)block)) != 0;
+    }
 }
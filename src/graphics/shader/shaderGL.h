@@ -17,6 +17,15 @@
  * or uniform is its index in [attributes] or [uniforms] respectively. These are the arrays of
  * AttributeDescriptor and UniformDescriptor objects. The 'shader var ID/location' of an attribute
  * or uniform is the unique identifier assigned by OpenGL.
+ *
+ * The last value sent to each uniform location is kept in a shadow copy. Uniform values are part
+ * of the state of an OpenGL program object, so a value that matches the shadow copy is already in
+ * place and does not need to be sent again. This matters because the same material (or several
+ * materials that share a shader) are drawn many times per frame with mostly unchanged values.
+ *
+ * Each of the standard uniform blocks (see StandardUniformBlock) that the program declares is bound to
+ * the uniform buffer binding point of the same index after linking. The members of those blocks are
+ * sourced from uniform buffers, so they are not exposed as UniformDescriptor objects.
  */
 
 #ifndef _GTE_SHADER_GL_H_
@@ -27,6 +36,7 @@
 #include "shader.h"
 
 #include <string>
+#include <vector>
 
 namespace GTE {
     //forward declarations
@@ -39,6 +49,28 @@ namespace GTE {
     class ShaderGL : public Shader {
         friend class GraphicsGL;
 
+        // largest uniform value (in bytes) for which a shadow copy is kept; larger values (such as skinning palettes
+        // and instance transforms) almost always differ from one send to the next, so comparing them is wasted work
+        static const UInt32 MaxShadowedUniformSize = 256;
+        // uniforms at locations beyond this one are always sent
+        static const UInt32 MaxShadowedUniformLocation = 1024;
+
+        class UniformShadowValue {
+        public:
+
+            // does [Data] hold the current value of the uniform?
+            Bool IsSet;
+            // size of the value in [Data] in bytes
+            UInt32 Size;
+            // copy of the value last sent to the uniform
+            Byte Data[MaxShadowedUniformSize];
+
+            UniformShadowValue() {
+                IsSet = false;
+                Size = 0;
+            }
+        };
+
         // is this shader loaded, compiled and linked?
         Bool ready;
 
@@ -65,6 +97,12 @@ namespace GTE {
         // descriptors for this shader's uniforms
         UniformDescriptor ** uniforms;
 
+        // shadow copy of the value last sent to each uniform location of the program
+        std::vector<UniformShadowValue> uniformShadowValues;
+
+        // bit mask of the standard uniform blocks declared by the program (indexed by StandardUniformBlock)
+        UInt32 uniformBlockMask;
+
         void DestroyShaders();
         void DestroyProgram();
         void DestroyComponents();
@@ -75,6 +113,8 @@ namespace GTE {
         Bool CheckCompilation(Int32 shaderID, ShaderType shaderType);
 
         Bool StoreUniformAndAttributeInfo();
+        void BindUniformBlocks();
+        Bool UpdateUniformShadowValue(Int32 varID, const void * data, UInt32 size);
 
     protected:
 
@@ -90,6 +130,7 @@ namespace GTE {
         GLuint GetProgramID() const;
 
         void SendBufferToShader(Int32 varID, const VertexAttrBuffer * buffer)  override;
+        void SendBufferToShader(Int32 varID, const VertexAttrBuffer * buffer, UInt32 componentCount, UInt32 offset)  override;
 
         void SendUniformToShader(Int32 varID, UInt32 samplerUnitIndex, const TextureSharedPtr texture) override;
         void SendUniformToShader(Int32 varID, const Matrix4x4& mat) override;
@@ -114,6 +155,8 @@ namespace GTE {
 
         UInt32 GetAttributeCount() const;
         const AttributeDescriptor * GetAttributeDescriptor(UInt32 index) const;
+
+        Bool UsesUniformBlock(StandardUniformBlock block) const override;
     };
 }
 
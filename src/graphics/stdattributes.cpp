@@ -14,7 +14,9 @@ namespace GTE {
         "COLOR",
         "UVTEXTURE0",
         "UVTEXTURE1",
-        "UVNORMALMAP"
+        "UVNORMALMAP",
+        "BONE_INDICES",
+        "BONE_WEIGHTS"
     };
 
     std::unordered_map<std::string, StandardAttribute> StandardAttributes::nameToAttribute
@@ -27,7 +29,9 @@ namespace GTE {
         {attributeNames[(UInt16)StandardAttribute::VertexColor],StandardAttribute::VertexColor},
         {attributeNames[(UInt16)StandardAttribute::UVTexture0],StandardAttribute::UVTexture0},
         {attributeNames[(UInt16)StandardAttribute::UVTexture1],StandardAttribute::UVTexture1},
-        {attributeNames[(UInt16)StandardAttribute::UVNormalMap],StandardAttribute::UVNormalMap}
+        {attributeNames[(UInt16)StandardAttribute::UVNormalMap],StandardAttribute::UVNormalMap},
+        {attributeNames[(UInt16)StandardAttribute::BoneIndices],StandardAttribute::BoneIndices},
+        {attributeNames[(UInt16)StandardAttribute::BoneWeights],StandardAttribute::BoneWeights}
     };
 
     void StandardAttributes::RegisterAll() {
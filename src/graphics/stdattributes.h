@@ -18,8 +18,10 @@ namespace GTE {
         UVTexture0 = 6,
         UVTexture1 = 7,
         UVNormalMap = 8,
-        _Last = 9, // always keep as second to last entry
-        _None = 10 // always keep as last entry
+        BoneIndices = 9,
+        BoneWeights = 10,
+        _Last = 11, // always keep as second to last entry
+        _None = 12 // always keep as last entry
     };
 
     enum class StandardAttributeMaskComponent {
@@ -31,7 +33,9 @@ namespace GTE {
         VertexColor = (UInt32)StandardAttribute::VertexColor << 1,
         UVTexture0 = (UInt32)StandardAttribute::UVTexture0 << 1,
         UVTexture1 = (UInt32)StandardAttribute::UVTexture1 << 1,
-        UVNormalMap = (UInt32)StandardAttribute::UVNormalMap << 1
+        UVNormalMap = (UInt32)StandardAttribute::UVNormalMap << 1,
+        BoneIndices = (UInt32)StandardAttribute::BoneIndices << 1,
+        BoneWeights = (UInt32)StandardAttribute::BoneWeights << 1
     };
 
     typedef IntMask StandardAttributeSet;
@@ -29,7 +29,19 @@ namespace GTE {
         "NORMALMAP",
         "DO_SHADOW_VOLUME_RENDER",
         "CLIP_PLANE_COUNT",
-        "CLIP_PLANE0"
+        "CLIP_PLANE0",
+        "SKINNING_PALETTE",
+        "INSTANCE_TRANSFORMS"
+    };
+
+    const std::string StandardUniforms::uniformBlockNames[] =
+    {
+        "ViewData",
+        "LightData",
+        "ObjectData",
+        "ClusterLightData",
+        "ClusterGridData",
+        "ClusterLightIndexData"
     };
 
     std::unordered_map<std::string, StandardUniform> StandardUniforms::nameToUniform
@@ -58,7 +70,9 @@ namespace GTE {
         {uniformNames[(UInt16)StandardUniform::NormalMap],StandardUniform::NormalMap},
         {uniformNames[(UInt16)StandardUniform::DoShadowVolumeRender],StandardUniform::DoShadowVolumeRender},
         {uniformNames[(UInt16)StandardUniform::ClipPlaneCount],StandardUniform::ClipPlaneCount},
-        {uniformNames[(UInt16)StandardUniform::ClipPlane0],StandardUniform::ClipPlane0}
+        {uniformNames[(UInt16)StandardUniform::ClipPlane0],StandardUniform::ClipPlane0},
+        {uniformNames[(UInt16)StandardUniform::SkinningPalette],StandardUniform::SkinningPalette},
+        {uniformNames[(UInt16)StandardUniform::InstanceTransforms],StandardUniform::InstanceTransforms}
     };
 
     void StandardUniforms::RegisterAll() {
@@ -80,6 +94,10 @@ namespace GTE {
         return (*result).second;
     }
 
+    const std::string& StandardUniforms::GetUniformBlockName(StandardUniformBlock block) {
+        return uniformBlockNames[(UInt16)block];
+    }
+
     StandardUniform StandardUniforms::ForName(const std::string& name) {
         return GetUniformForName(name);
     }
@@ -33,8 +33,10 @@ namespace GTE {
         DoShadowVolumeRender = 21,
         ClipPlaneCount = 22,
         ClipPlane0 = 23,
-        _Last = 24, // always keep as last entry (before _None)
-        _None = 25
+        SkinningPalette = 24,
+        InstanceTransforms = 25,
+        _Last = 26, // always keep as last entry (before _None)
+        _None = 27
     };
 
     enum class StandardUniformMaskComponent {
@@ -61,13 +63,29 @@ namespace GTE {
         NormalMap = (UInt32)StandardUniform::NormalMap << 1,
         DoShadowVolumeRender = (UInt32)StandardUniform::DoShadowVolumeRender << 1,
         ClipPlaneCount = (UInt32)StandardUniform::ClipPlaneCount << 1,
-        ClipPlane0 = (UInt32)StandardUniform::ClipPlane0 << 1
+        ClipPlane0 = (UInt32)StandardUniform::ClipPlane0 << 1,
+        SkinningPalette = (UInt32)StandardUniform::SkinningPalette << 1,
+        InstanceTransforms = (UInt32)StandardUniform::InstanceTransforms << 1
+    };
+
+    // uniform blocks declared by the built-in shaders (see viewdata.inc, lightdata.inc, objectdata.inc and clusterdata.inc). the
+    // value of each entry is also the index of the uniform buffer binding point to which the block is bound.
+    enum class StandardUniformBlock {
+        View = 0,
+        Light = 1,
+        Object = 2,
+        ClusterLights = 3,
+        ClusterGrid = 4,
+        ClusterLightIndices = 5,
+        _Last = 6, // always keep as last entry (before _None)
+        _None = 7
     };
 
     typedef IntMask StandardUniformSet;
 
     class StandardUniforms {
         static const std::string uniformNames[];
+        static const std::string uniformBlockNames[];
         static std::unordered_map<std::string, StandardUniform> nameToUniform;
 
     public:
@@ -76,6 +94,7 @@ namespace GTE {
 
         static const std::string& GetUniformName(StandardUniform uniform);
         static StandardUniform GetUniformForName(const std::string& name);
+        static const std::string& GetUniformBlockName(StandardUniformBlock block);
         static StandardUniform ForName(const std::string& name);
         static StandardUniform UniformMaskComponentToUniform(StandardUniformMaskComponent component);
         static StandardUniformMaskComponent UniformToUniformMaskComponent(StandardUniform uniform);
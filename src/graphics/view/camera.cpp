@@ -33,6 +33,7 @@ namespace GTE {
         ssaoEnabled = false;
         lightingEnabled = true;
         depthPassEnabled = true;
+        frustumCullingEnabled = true;
 
         renderOrderIndex = 0;
 
@@ -163,6 +164,14 @@ namespace GTE {
         return depthPassEnabled;
     }
 
+    void Camera::SetFrustumCullingEnabled(Bool enabled) {
+        frustumCullingEnabled = enabled;
+    }
+
+    Bool Camera::IsFrustumCullingEnabled() const {
+        return frustumCullingEnabled;
+    }
+
     void Camera::SetRenderOrderIndex(UInt32 index) {
         renderOrderIndex = index;
     }
@@ -53,6 +53,7 @@ namespace GTE {
         Bool ssaoEnabled;
         Bool lightingEnabled;
         Bool depthPassEnabled;
+        Bool frustumCullingEnabled;
 
         UInt32 renderOrderIndex;
 
@@ -98,6 +99,9 @@ namespace GTE {
         void SetDepthPassEnabled(Bool enabled);
         Bool IsDepthPassEnabled() const;
 
+        void SetFrustumCullingEnabled(Bool enabled);
+        Bool IsFrustumCullingEnabled() const;
+
         void SetRenderOrderIndex(UInt32 index);
         UInt32 GetRenderOrderIndex() const;
 
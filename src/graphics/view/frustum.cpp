@@ -0,0 +1,120 @@
+#include "frustum.h"
+#include "geometry/matrix4x4.h"
+#include "geometry/point/point3.h"
+#include "geometry/vector/vector3.h"
+#include "gtemath/gtemath.h"
+#include "global/global.h"
+#include "global/assert.h"
+
+namespace GTE {
+    /*
+    * Default constructor. The default frustum contains all of space.
+    */
+    Frustum::Frustum() {
+        for (UInt32 i = 0; i < PlaneCount; i++) {
+            planes[i][0] = planes[i][1] = planes[i][2] = 0.0f;
+            planes[i][3] = 1.0f;
+        }
+    }
+
+    /*
+    * Clean up.
+    */
+    Frustum::~Frustum() {
+
+    }
+
+    /*
+    * Extract the six frustum planes from [viewProjection], which must be the product of the
+    * projection matrix and the inverse view matrix (in that order). The resulting planes are in the
+    * same space as the points that [viewProjection] transforms into clip space.
+    *
+    * Planes are normalized when possible. A projection with an infinite far plane produces a
+    * degenerate far plane with a zero-length normal; such a plane is left un-normalized and will
+    * never cull anything.
+    */
+    void Frustum::Build(const Matrix4x4& viewProjection) {
+        const Real * m = viewProjection.GetConstDataPtr();
+
+        // matrix is column-major, so row [r] is formed by (m[r], m[r + 4], m[r + 8], m[r + 12])
+        for (UInt32 i = 0; i < PlaneCount; i++) {
+            // row 0 -> left/right, row 1 -> bottom/top, row 2 -> near/far
+            UInt32 row = i / 2;
+            Real sign = (i % 2 == 0) ? 1.0f : -1.0f;
+
+            for (UInt32 c = 0; c < 4; c++) {
+                planes[i][c] = m[3 + c * 4] + sign * m[row + c * 4];
+            }
+
+            Real lengthSquared = planes[i][0] * planes[i][0] + planes[i][1] * planes[i][1] + planes[i][2] * planes[i][2];
+            if (lengthSquared > 0.0000001f) {
+                Real inverseLength = GTEMath::InverseSquareRoot(lengthSquared);
+                for (UInt32 c = 0; c < 4; c++) {
+                    planes[i][c] *= inverseLength;
+                }
+            }
+        }
+    }
+
+    /*
+    * Get the coefficients (a, b, c, d) of the plane specified by [plane].
+    */
+    const Real * Frustum::GetPlane(FrustumPlane plane) const {
+        return planes[(UInt32)plane];
+    }
+
+    /*
+    * Determine if the axis-aligned box described by [center] and the half-widths in [extents]
+    * is at least partially inside this frustum. This test is conservative: it may report an intersection
+    * for some boxes that lie just outside the corners of the frustum, but it will never reject a
+    * visible box.
+    */
+    Bool Frustum::IntersectsBox(const Point3& center, const Vector3& extents) const {
+        for (UInt32 i = 0; i < PlaneCount; i++) {
+            const Real * plane = planes[i];
+
+            Real distance = plane[0] * center.x + plane[1] * center.y + plane[2] * center.z + plane[3];
+            Real radius = GTEMath::Abs(plane[0]) * extents.x + GTEMath::Abs(plane[1]) * extents.y + GTEMath::Abs(plane[2]) * extents.z;
+
+            // the entire box lies on the outside of this plane
+            if (distance < -radius) return false;
+        }
+
+        return true;
+    }
+
+    /*
+    * Determine if the box described by [localCenter] and [localExtents] is at least partially inside
+    * this frustum after it has been transformed by [transform]. The transformed box is enclosed in
+    * an axis-aligned box before it is tested.
+    */
+    Bool Frustum::IntersectsBox(const Matrix4x4& transform, const Point3& localCenter, const Vector3& localExtents) const {
+        const Real * m = transform.GetConstDataPtr();
+
+        Point3 center = localCenter;
+        transform.Transform(center);
+
+        // the extents of the axis-aligned box enclosing the transformed box are formed by summing
+        // the absolute values of the transformed local axes
+        Vector3 extents;
+        extents.x = GTEMath::Abs(m[0]) * localExtents.x + GTEMath::Abs(m[4]) * localExtents.y + GTEMath::Abs(m[8]) * localExtents.z;
+        extents.y = GTEMath::Abs(m[1]) * localExtents.x + GTEMath::Abs(m[5]) * localExtents.y + GTEMath::Abs(m[9]) * localExtents.z;
+        extents.z = GTEMath::Abs(m[2]) * localExtents.x + GTEMath::Abs(m[6]) * localExtents.y + GTEMath::Abs(m[10]) * localExtents.z;
+
+        return IntersectsBox(center, extents);
+    }
+
+    /*
+    * Determine if the sphere described by [center] and [radius] is at least partially inside this frustum.
+    */
+    Bool Frustum::IntersectsSphere(const Point3& center, Real radius) const {
+        for (UInt32 i = 0; i < PlaneCount; i++) {
+            const Real * plane = planes[i];
+
+            Real distance = plane[0] * center.x + plane[1] * center.y + plane[2] * center.z + plane[3];
+            if (distance < -radius) return false;
+        }
+
+        return true;
+    }
+}
@@ -0,0 +1,57 @@
+/*
+ * class: Frustum
+ *
+ * author: Mark Kellogg
+ *
+ * Describes a view volume as a set of six planes that are extracted from a
+ * combined view-projection matrix. It is used by render managers to determine
+ * whether or not a mesh's bounding box is at least partially visible from a given view.
+ *
+ * Each plane is stored as (a, b, c, d) such that a point p is on the inside of the
+ * plane if: a * p.x + b * p.y + c * p.z + d >= 0.
+ */
+
+#ifndef _GTE_FRUSTUM_H_
+#define _GTE_FRUSTUM_H_
+
+#include "engine.h"
+#include "global/global.h"
+
+namespace GTE {
+    //forward declarations
+    class Matrix4x4;
+    class Point3;
+    class Vector3;
+
+    enum class FrustumPlane {
+        Left = 0,
+        Right = 1,
+        Bottom = 2,
+        Top = 3,
+        Near = 4,
+        Far = 5,
+        _Count = 6
+    };
+
+    class Frustum {
+
+        static const UInt32 PlaneCount = (UInt32)FrustumPlane::_Count;
+
+        // plane coefficients (a, b, c, d) for each of the frustum's six planes
+        Real planes[PlaneCount][4];
+
+    public:
+
+        Frustum();
+        ~Frustum();
+
+        void Build(const Matrix4x4& viewProjection);
+        const Real * GetPlane(FrustumPlane plane) const;
+
+        Bool IntersectsBox(const Point3& center, const Vector3& extents) const;
+        Bool IntersectsBox(const Matrix4x4& transform, const Point3& localCenter, const Vector3& localExtents) const;
+        Bool IntersectsSphere(const Point3& center, Real radius) const;
+    };
+}
+
+#endif
@@ -70,6 +70,9 @@ GTE::Bool LavaField::InitMeshAndMaterial() {
     lavaMaterial->SetTexture(lavaTextureB, "TEXTUREB");
     lavaMaterial->SetUseLighting(false);
 
+    textureAOffsetUniform = lavaMaterial->GetUniformHandle("UVTEXTURE0_OFFSET");
+    textureBOffsetUniform = lavaMaterial->GetUniformHandle("UVTEXTURE1_OFFSET");
+
     return true;
 }
 
@@ -253,8 +256,8 @@ void LavaField::Update() {
     DisplaceField();
 
     textAOffset -= GTE::Time::GetDeltaTime() * textureASpeed;
-    lavaMaterial->SetUniform2f(0, textAOffset, "UVTEXTURE0_OFFSET");
+    lavaMaterial->SetUniform2f(0, textAOffset, textureAOffsetUniform);
 
     textBOffset -= GTE::Time::GetDeltaTime() * textureBSpeed;
-    lavaMaterial->SetUniform2f(0, textBOffset, "UVTEXTURE1_OFFSET");
+    lavaMaterial->SetUniform2f(0, textBOffset, textureBOffsetUniform);
 }
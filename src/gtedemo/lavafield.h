@@ -13,6 +13,7 @@
 #include "engine.h"
 #include "graphics/image/rawimage.h"
 #include "graphics/image/imageloader.h"
+#include "graphics/render/material.h"
 
 class LavaField {
     // the lava field mesh is divided into subDivisions x subDivisions sub-sections
@@ -48,6 +49,9 @@ class LavaField {
 
     // material used to render the lava field mesh
     GTE::MaterialSharedPtr lavaMaterial;
+    // handles to the texture offset uniforms of [lavaMaterial], which are updated every frame
+    GTE::UniformHandle textureAOffsetUniform;
+    GTE::UniformHandle textureBOffsetUniform;
     // the lava field mesh
     GTE::Mesh3DSharedPtr fieldMesh;
     // both textures are combined in the shader for the lava field mesh
@@ -0,0 +1,37 @@
+/*
+ * author: Mark Kellogg
+ *
+ * Compile-time selection of the SIMD instruction set used by the engine's math kernels.
+ *
+ * Exactly one of the following will be defined (unless SIMD is unavailable or disabled):
+ *
+ *   _GTE_SIMD_SSE   -> x86/x64 with SSE (always available on x64). If the compiler also targets
+ *                      AVX (e.g. -mavx or /arch:AVX), _GTE_SIMD_AVX will be defined as well.
+ *   _GTE_SIMD_NEON  -> ARM with NEON.
+ *
+ * SIMD kernels are only used when Real is single precision. Define _GTE_SIMD_Disabled to force
+ * the scalar code paths everywhere.
+ */
+
+#ifndef _GTE_SIMD_H_
+#define _GTE_SIMD_H_
+
+#include "engine.h"
+
+#if !defined(_GTE_Real_DoublePrecision) && !defined(_GTE_SIMD_Disabled)
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define _GTE_SIMD_SSE
+#include <xmmintrin.h>
+#if defined(__AVX__)
+#define _GTE_SIMD_AVX
+#include <immintrin.h>
+#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define _GTE_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+#endif
+
+#endif
@@ -96,6 +96,60 @@ namespace GTE {
         LongMaskUtil::SetBit(&shaderProperties, (Int16)ShaderMaterialCharacteristic::VertexNormals);
         loadedShaders.AddShader(shaderProperties, shader);
 
+        assetImporter.LoadBuiltInShaderSource("diffuse_skinned", shaderSource);
+        shader = CreateShader(shaderSource);
+        ASSERT(shader.IsValid(), "EngineObjectManager::InitBuiltinShaders -> could not create builtin shader: DiffuseColored & GPUSkinned");
+        shaderProperties = LongMaskUtil::CreateMask();
+        LongMaskUtil::SetBit(&shaderProperties, (Int16)ShaderMaterialCharacteristic::DiffuseColored);
+        LongMaskUtil::SetBit(&shaderProperties, (Int16)ShaderMaterialCharacteristic::VertexNormals);
+        LongMaskUtil::SetBit(&shaderProperties, (Int16)ShaderMaterialCharacteristic::GPUSkinned);
+        loadedShaders.AddShader(shaderProperties, shader);
+
+        assetImporter.LoadBuiltInShaderSource("diffuse_texture_skinned", shaderSource);
+        shader = CreateShader(shaderSource);
+        ASSERT(shader.IsValid(), "EngineObjectManager::InitBuiltinShaders -> could not create builtin shader: DiffuseTextured & GPUSkinned");
+        shaderProperties = LongMaskUtil::CreateMask();
+        LongMaskUtil::SetBit(&shaderProperties, (Int16)ShaderMaterialCharacteristic::DiffuseTextured);
+        LongMaskUtil::SetBit(&shaderProperties, (Int16)ShaderMaterialCharacteristic::VertexNormals);
+        LongMaskUtil::SetBit(&shaderProperties, (Int16)ShaderMaterialCharacteristic::GPUSkinned);
+        loadedShaders.AddShader(shaderProperties, shader);
+
+        assetImporter.LoadBuiltInShaderSource("diffuse_instanced", shaderSource);
+        shader = CreateShader(shaderSource);
+        ASSERT(shader.IsValid(), "EngineObjectManager::InitBuiltinShaders -> could not create builtin shader: DiffuseColored & Instanced");
+        shaderProperties = LongMaskUtil::CreateMask();
+        LongMaskUtil::SetBit(&shaderProperties, (Int16)ShaderMaterialCharacteristic::DiffuseColored);
+        LongMaskUtil::SetBit(&shaderProperties, (Int16)ShaderMaterialCharacteristic::VertexNormals);
+        LongMaskUtil::SetBit(&shaderProperties, (Int16)ShaderMaterialCharacteristic::Instanced);
+        loadedShaders.AddShader(shaderProperties, shader);
+
+        assetImporter.LoadBuiltInShaderSource("diffuse_texture_instanced", shaderSource);
+        shader = CreateShader(shaderSource);
+        ASSERT(shader.IsValid(), "EngineObjectManager::InitBuiltinShaders -> could not create builtin shader: DiffuseTextured & Instanced");
+        shaderProperties = LongMaskUtil::CreateMask();
+        LongMaskUtil::SetBit(&shaderProperties, (Int16)ShaderMaterialCharacteristic::DiffuseTextured);
+        LongMaskUtil::SetBit(&shaderProperties, (Int16)ShaderMaterialCharacteristic::VertexNormals);
+        LongMaskUtil::SetBit(&shaderProperties, (Int16)ShaderMaterialCharacteristic::Instanced);
+        loadedShaders.AddShader(shaderProperties, shader);
+
+        assetImporter.LoadBuiltInShaderSource("diffuse_clustered", shaderSource);
+        shader = CreateShader(shaderSource);
+        ASSERT(shader.IsValid(), "EngineObjectManager::InitBuiltinShaders -> could not create builtin shader: DiffuseColored & ClusteredLighting");
+        shaderProperties = LongMaskUtil::CreateMask();
+        LongMaskUtil::SetBit(&shaderProperties, (Int16)ShaderMaterialCharacteristic::DiffuseColored);
+        LongMaskUtil::SetBit(&shaderProperties, (Int16)ShaderMaterialCharacteristic::VertexNormals);
+        LongMaskUtil::SetBit(&shaderProperties, (Int16)ShaderMaterialCharacteristic::ClusteredLighting);
+        loadedShaders.AddShader(shaderProperties, shader);
+
+        assetImporter.LoadBuiltInShaderSource("diffuse_texture_clustered", shaderSource);
+        shader = CreateShader(shaderSource);
+        ASSERT(shader.IsValid(), "EngineObjectManager::InitBuiltinShaders -> could not create builtin shader: DiffuseTextured & ClusteredLighting");
+        shaderProperties = LongMaskUtil::CreateMask();
+        LongMaskUtil::SetBit(&shaderProperties, (Int16)ShaderMaterialCharacteristic::DiffuseTextured);
+        LongMaskUtil::SetBit(&shaderProperties, (Int16)ShaderMaterialCharacteristic::VertexNormals);
+        LongMaskUtil::SetBit(&shaderProperties, (Int16)ShaderMaterialCharacteristic::ClusteredLighting);
+        loadedShaders.AddShader(shaderProperties, shader);
+
         return true;
     }
 
@@ -290,7 +344,7 @@ namespace GTE {
     SkeletonSharedPtr EngineObjectManager::CloneSkeleton(SkeletonSharedPtr source) {
         NONFATAL_ASSERT_RTRN(source.IsValid(), "EngineObjectManager::CloneSkeleton -> 'source' is invalid.", SkeletonSharedPtr::Null(), true);
 
-        Skeleton * skeleton = source->FullClone();
+        Skeleton * skeleton = source->CreateInstance();
         NONFATAL_ASSERT_RTRN(skeleton != nullptr, "EngineObjectManager::CloneSkeleton -> Could not clone source.", SkeletonSharedPtr::Null(), true);
 
         return SkeletonSharedPtr(skeleton, [=](Skeleton * skeleton) {
@@ -28,7 +28,10 @@ namespace GTE {
         EmissiveColored = 5,
         EmissiveTextured = 6,
         VertexColors = 7,
-        VertexNormals = 8
+        VertexNormals = 8,
+        GPUSkinned = 9,
+        Instanced = 10,
+        ClusteredLighting = 11
     };
 
     class ShaderOrganizer {
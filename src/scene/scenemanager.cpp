@@ -24,13 +24,14 @@ namespace GTE {
     SceneManager::SceneManager() {
         sceneObjectCount = 0;
         maxPhaseReached = -1;
+        transformPoolEnabled = false;
     }
 
     /*
      * Destructor
      */
     SceneManager::~SceneManager() {
-
+        transformPool.Clear();
     }
 
 
@@ -75,34 +76,41 @@ namespace GTE {
 
         sceneObjectCount = 0;
 
-        Transform baseTransform;
+        // bring the world transforms stored in the transform pool up to date in a single pass
+        if (transformPoolEnabled) {
+            if (transformPool.IsStructureDirty()) {
+                transformPool.Build(sceneRoot.GetRef());
+            }
+            transformPool.UpdateWorldMatrices();
+        }
+
         // form list of scene objects
-        ProcessScene(sceneRoot.GetRef(), baseTransform);
+        ProcessScene(sceneRoot.GetRef());
         // process resulting list of scene objects
         ProcessSceneObjectList(phase);
     }
 
     /*
     *
-    * Recursively visits each object in the scene that is reachable from [parent]. The transforms of each
-    * scene object are concatenated as progress moves down the scene object tree and passed to the current
-    * invocation via [aggregateTransform]. These aggregate transforms are saved to each SceneObject via
-    * SceneObject::SetAggregateTransform().
+    * Recursively visits each object in the scene that is reachable from [obj]. The aggregate (world)
+    * transform of each scene object, and its inverse, are saved to its processing descriptor. These are
+    * taken from [transformPool] if it is enabled, otherwise from the world matrices cached by each scene
+    * object's transform. Either way they are only recalculated for the parts of the scene hierarchy that have changed.
     *
     */
-    void SceneManager::ProcessScene(SceneObject& obj, Transform& aggregateTransform) {
-        Transform nextTransform = aggregateTransform;
-        Transform& localTransform = obj.GetTransform();
-        if (!obj.InheritsTransform()) {
-            nextTransform.SetIdentity();
-        }
-        nextTransform.TransformBy(localTransform);
-
+    void SceneManager::ProcessScene(SceneObject& obj) {
         // save the aggregate/global/world transform
         SceneObjectProcessingDescriptor& processingDesc = obj.GetProcessingDescriptor();
-        processingDesc.AggregateTransform = nextTransform;
-        processingDesc.AggregateTransformInverse = nextTransform;
-        processingDesc.AggregateTransformInverse.Invert();
+        Int32 poolHandle = obj.GetTransformPoolHandle();
+        if (transformPoolEnabled && poolHandle != SceneTransformPool::InvalidHandle) {
+            processingDesc.AggregateTransform.SetTo(transformPool.GetWorldMatrix(poolHandle));
+            processingDesc.AggregateTransformInverse.SetTo(transformPool.GetWorldMatrixInverse(poolHandle));
+        }
+        else {
+            const SceneObjectTransform& localTransform = obj.GetConstTransform();
+            processingDesc.AggregateTransform.SetTo(localTransform.GetWorldMatrix());
+            processingDesc.AggregateTransformInverse.SetTo(localTransform.GetWorldMatrixInverse());
+        }
 
         sceneObjectList[sceneObjectCount] = &obj;
         sceneObjectCount++;
@@ -119,7 +127,7 @@ namespace GTE {
             if (child->IsActive()) {
                 if (sceneObjectCount >= Constants::MaxSceneObjects)return;
                 // continue recursion through child object
-                ProcessScene(child.GetRef(), nextTransform);
+                ProcessScene(child.GetRef());
             }
         }
     }
@@ -160,20 +168,48 @@ namespace GTE {
         }
     }
 
+    /*
+    * Enable or disable the use of [transformPool] for calculating the world transforms of all scene objects. When
+    * enabled, the local and world matrices of every scene object are kept in contiguous arrays and the world
+    * matrices are updated in a single linear pass at the beginning of each scene update.
+    */
+    void SceneManager::SetTransformPoolEnabled(Bool enabled) {
+        if (transformPoolEnabled == enabled)return;
+
+        transformPoolEnabled = enabled;
+        if (!transformPoolEnabled) {
+            transformPool.Clear();
+        }
+        else {
+            transformPool.MarkStructureDirty();
+        }
+    }
+
+    /*
+    * Is [transformPool] used for calculating the world transforms of scene objects?
+    */
+    Bool SceneManager::IsTransformPoolEnabled() const {
+        return transformPoolEnabled;
+    }
+
+    /*
+    * Access the transform pool.
+    */
+    SceneTransformPool& SceneManager::GetTransformPool() {
+        return transformPool;
+    }
+
     /*
     * Fully process a SceneObject instance as if it were newly added.
     */
     void SceneManager::ProcessSceneObjectAsNew(SceneObject& object) {
         // only process active scene objects
         if (object.IsActive()) {
-            Transform aggregateTransform;
-            SceneObjectTransform::GetWorldTransform(aggregateTransform, object, true, false);
-
             // save the aggregate/global/world transform
+            const SceneObjectTransform& localTransform = object.GetConstTransform();
             SceneObjectProcessingDescriptor& processingDesc = object.GetProcessingDescriptor();
-            processingDesc.AggregateTransform = aggregateTransform;
-            processingDesc.AggregateTransformInverse = aggregateTransform;
-            processingDesc.AggregateTransformInverse.Invert();
+            processingDesc.AggregateTransform.SetTo(localTransform.GetWorldMatrix());
+            processingDesc.AggregateTransformInverse.SetTo(localTransform.GetWorldMatrixInverse());
 
             if (maxPhaseReached >= (Int32)UpdatePhase::Awake) {
                 ProcessSceneObjectUpdatePhase(UpdatePhase::Awake, object);
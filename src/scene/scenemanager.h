@@ -16,6 +16,7 @@
 #include "object/engineobject.h"
 #include "global/constants.h"
 #include "geometry/transform.h"
+#include "scenetransformpool.h"
 
 namespace GTE {
     // forward declaration
@@ -43,8 +44,13 @@ namespace GTE {
         UInt32 sceneObjectCount;
         SceneObject* sceneObjectList[Constants::MaxSceneObjects];
 
+        // contiguous storage for the transforms of all scene objects (opt-in)
+        SceneTransformPool transformPool;
+        // is [transformPool] used to calculate world transforms?
+        Bool transformPoolEnabled;
+
         void Update(UpdatePhase phase);
-        void ProcessScene(SceneObject& parent, Transform& aggregateTransform);
+        void ProcessScene(SceneObject& obj);
         void ProcessSceneObjectList(UpdatePhase phase);
 
         void ProcessSceneObjectUpdatePhase(UpdatePhase phase, SceneObject& object);
@@ -60,6 +66,9 @@ namespace GTE {
         void Start();
         void Awake();
 
+        void SetTransformPoolEnabled(Bool enabled);
+        Bool IsTransformPoolEnabled() const;
+        SceneTransformPool& GetTransformPool();
     };
 }
 
@@ -2,6 +2,7 @@
 #include "object/engineobject.h"
 #include "object/engineobjectmanager.h"
 #include "scenemanager.h"
+#include "scenetransformpool.h"
 #include "graphics/graphics.h"
 #include "graphics/view/camera.h"
 #include "graphics/light/light.h"
@@ -23,6 +24,7 @@ namespace GTE {
         isActive = true;
         isStatic = false;
         inheritTransform = true;
+        transformPoolHandle = SceneTransformPool::InvalidHandle;
 
         transform.SetIdentity();
         transform.SetSceneObject(this);
@@ -31,7 +33,21 @@ namespace GTE {
     }
 
     SceneObject::~SceneObject() {
+        // make sure the transform pool no longer references this scene object
+        SceneManager * sceneManager = Engine::Instance()->GetSceneManager();
+        if (transformPoolHandle != SceneTransformPool::InvalidHandle && sceneManager != nullptr) {
+            sceneManager->GetTransformPool().RemoveOwner(transformPoolHandle);
+        }
+    }
 
+    /*
+     * Notify the scene manager's transform pool that the structure of the scene hierarchy has changed.
+     */
+    void SceneObject::MarkTransformPoolStructureDirty() {
+        SceneManager * sceneManager = Engine::Instance()->GetSceneManager();
+        if (sceneManager != nullptr) {
+            sceneManager->GetTransformPool().MarkStructureDirty();
+        }
     }
 
     Bool SceneObject::IsActive() {
@@ -58,7 +74,12 @@ namespace GTE {
     }
 
     void SceneObject::SetInheritsTransform(Bool inherit) {
+        if (this->inheritTransform == inherit)return;
         this->inheritTransform = inherit;
+        // the world transforms of this scene object and its descendants depend on whether or not
+        // this scene object inherits the transforms of its ancestors
+        transform.InvalidateWorldMatrix();
+        MarkTransformPoolStructureDirty();
     }
 
     void SceneObject::SetName(const std::string& name) {
@@ -85,6 +106,14 @@ namespace GTE {
         return transform;
     }
 
+    /*
+     * Get the slot of this scene object in the scene manager's transform pool, or
+     * SceneTransformPool::InvalidHandle if it is not stored in the pool.
+     */
+    Int32 SceneObject::GetTransformPoolHandle() const {
+        return transformPoolHandle;
+    }
+
     SceneObjectProcessingDescriptor& SceneObject::GetProcessingDescriptor() {
         return processingDescriptor;
     }
@@ -277,6 +306,8 @@ namespace GTE {
 
         child->parent = sceneObjectRef;
         children.push_back(child);
+        child->transform.InvalidateWorldMatrix();
+        MarkTransformPoolStructureDirty();
     }
 
     void SceneObject::RemoveChild(SceneObjectRef child) {
@@ -302,6 +333,8 @@ namespace GTE {
             SceneObjectTransform::GetWorldTransform(newChildTransform, child, true, false);
             child->GetTransform().SetTo(newChildTransform);
             child->parent = SceneObjectSharedPtr::Null();
+            child->transform.InvalidateWorldMatrix();
+            MarkTransformPoolStructureDirty();
         }
     }
 
@@ -49,6 +49,9 @@ namespace GTE {
         // SceneObjectSkeletonNode needs access to the aggregate transform
         friend class SceneObjectSkeletonNode;
 
+        // SceneTransformPool assigns transform pool handles
+        friend class SceneTransformPool;
+
         // Mesh3DFilter needs to be a friend so that it can update
         // any attached renderer when its mesh is updated
         friend class Mesh3DFilter;
@@ -62,6 +65,8 @@ namespace GTE {
         Bool isStatic;
         Bool inheritTransform;
         SceneObjectTransform transform;
+        // slot in the scene manager's transform pool, if the pool is enabled
+        Int32 transformPoolHandle;
         std::vector<SceneObjectSharedPtr> children;
         SceneObjectSharedPtr parent;
         IntMask layerMask;
@@ -76,6 +81,7 @@ namespace GTE {
 
         SceneObjectProcessingDescriptor& GetProcessingDescriptor();
         void NotifyNewMesh3D();
+        static void MarkTransformPoolStructureDirty();
 
     public:
 
@@ -93,6 +99,7 @@ namespace GTE {
 
         SceneObjectTransform& GetTransform();
         const SceneObjectTransform& GetConstTransform() const;
+        Int32 GetTransformPoolHandle() const;
 
         Bool SetRenderer(RendererRef renderer);
         Bool SetMesh3DFilter(Mesh3DFilterRef filter);
@@ -0,0 +1,191 @@
+#include <memory.h>
+
+#include "scenetransformpool.h"
+#include "scene/sceneobject.h"
+#include "geometry/sceneobjecttransform.h"
+#include "geometry/matrix4x4.h"
+#include "global/global.h"
+#include "global/assert.h"
+#include "debug/gtedebug.h"
+
+namespace GTE {
+    /*
+    * Default constructor
+    */
+    SceneTransformPool::SceneTransformPool() {
+        structureDirty = true;
+    }
+
+    /*
+     * Destructor
+     */
+    SceneTransformPool::~SceneTransformPool() {
+        Clear();
+    }
+
+    /*
+     * Reset the transform pool handle of each scene object that is currently stored in the pool.
+     */
+    void SceneTransformPool::ReleaseOwners() {
+        for (UInt32 i = 0; i < owners.size(); i++) {
+            if (owners[i] != nullptr) {
+                owners[i]->transformPoolHandle = InvalidHandle;
+            }
+        }
+        owners.clear();
+    }
+
+    /*
+     * Remove all slots from the pool.
+     */
+    void SceneTransformPool::Clear() {
+        ReleaseOwners();
+
+        localMatrices.clear();
+        worldMatrices.clear();
+        worldMatricesInverse.clear();
+        parentSlots.clear();
+        localDirty.clear();
+        worldUpdated.clear();
+
+        structureDirty = true;
+    }
+
+    /*
+     * Assign a slot to every scene object in the hierarchy rooted at [root]. The hierarchy is visited in
+     * breadth-first order so that the slot of each scene object's parent precedes its own slot.
+     */
+    void SceneTransformPool::Build(SceneObject& root) {
+        Clear();
+
+        owners.push_back(&root);
+        for (UInt32 i = 0; i < owners.size(); i++) {
+            SceneObject* sceneObject = owners[i];
+            for (UInt32 c = 0; c < sceneObject->GetChildrenCount(); c++) {
+                SceneObjectRef child = sceneObject->GetChildAt(c);
+                if (child.IsValid()) {
+                    owners.push_back(child.GetPtr());
+                }
+            }
+        }
+
+        UInt32 slotCount = (UInt32)owners.size();
+        localMatrices.resize(slotCount * MatrixSize);
+        worldMatrices.resize(slotCount * MatrixSize);
+        worldMatricesInverse.resize(slotCount * MatrixSize);
+        parentSlots.resize(slotCount);
+        localDirty.resize(slotCount);
+        worldUpdated.resize(slotCount);
+
+        for (UInt32 i = 0; i < slotCount; i++) {
+            SceneObject* sceneObject = owners[i];
+            sceneObject->transformPoolHandle = (Int32)i;
+
+            // parents are always assigned slots before their children
+            SceneObjectRef parent = sceneObject->GetParent();
+            if (parent.IsValid() && sceneObject->InheritsTransform()) {
+                parentSlots[i] = parent->transformPoolHandle;
+            }
+            else {
+                parentSlots[i] = InvalidHandle;
+            }
+
+            memcpy(&localMatrices[i * MatrixSize], sceneObject->GetConstTransform().GetConstMatrix().GetConstDataPtr(), sizeof(Real) * MatrixSize);
+            localDirty[i] = 1;
+            worldUpdated[i] = 0;
+        }
+
+        structureDirty = false;
+    }
+
+    /*
+     * Recalculate the world matrix (and its inverse) of each slot whose local matrix has changed, or whose
+     * parent's world matrix was recalculated. Since parents precede their children, this is a single
+     * linear pass over the pool's arrays.
+     */
+    void SceneTransformPool::UpdateWorldMatrices() {
+        UInt32 slotCount = (UInt32)owners.size();
+
+        for (UInt32 i = 0; i < slotCount; i++) {
+            Int32 parentSlot = parentSlots[i];
+            Bool parentUpdated = parentSlot != InvalidHandle && worldUpdated[parentSlot] != 0;
+
+            if (localDirty[i] || parentUpdated) {
+                Real * world = &worldMatrices[i * MatrixSize];
+                const Real * local = &localMatrices[i * MatrixSize];
+
+                if (parentSlot != InvalidHandle) {
+                    Matrix4x4::MultiplyMM(&worldMatrices[parentSlot * MatrixSize], local, world);
+                }
+                else {
+                    memcpy(world, local, sizeof(Real) * MatrixSize);
+                }
+
+                Matrix4x4::Invert(world, &worldMatricesInverse[i * MatrixSize]);
+
+                localDirty[i] = 0;
+                worldUpdated[i] = 1;
+            }
+            else {
+                worldUpdated[i] = 0;
+            }
+        }
+    }
+
+    /*
+     * Indicate that the structure of the scene hierarchy has changed and the pool must be rebuilt.
+     */
+    void SceneTransformPool::MarkStructureDirty() {
+        structureDirty = true;
+    }
+
+    /*
+     * Has the structure of the scene hierarchy changed since the pool was last built?
+     */
+    Bool SceneTransformPool::IsStructureDirty() const {
+        return structureDirty;
+    }
+
+    /*
+     * Remove the scene object stored in the slot specified by [handle] (e.g. because it is being destroyed).
+     */
+    void SceneTransformPool::RemoveOwner(Int32 handle) {
+        NONFATAL_ASSERT(handle >= 0 && (UInt32)handle < owners.size(), "SceneTransformPool::RemoveOwner -> 'handle' is out of range.", true);
+
+        owners[handle] = nullptr;
+        structureDirty = true;
+    }
+
+    /*
+     * Update the local matrix stored in the slot specified by [handle].
+     */
+    void SceneTransformPool::SetLocalMatrix(Int32 handle, const Matrix4x4& matrix) {
+        NONFATAL_ASSERT(handle >= 0 && (UInt32)handle < owners.size(), "SceneTransformPool::SetLocalMatrix -> 'handle' is out of range.", true);
+
+        memcpy(&localMatrices[handle * MatrixSize], matrix.GetConstDataPtr(), sizeof(Real) * MatrixSize);
+        localDirty[handle] = 1;
+    }
+
+    /*
+     * Get the world matrix stored in the slot specified by [handle], as of the last call to UpdateWorldMatrices().
+     */
+    const Real * SceneTransformPool::GetWorldMatrix(Int32 handle) const {
+        NONFATAL_ASSERT_RTRN(handle >= 0 && (UInt32)handle < owners.size(), "SceneTransformPool::GetWorldMatrix -> 'handle' is out of range.", nullptr, true);
+        return &worldMatrices[handle * MatrixSize];
+    }
+
+    /*
+     * Get the inverse of the world matrix stored in the slot specified by [handle], as of the last call to UpdateWorldMatrices().
+     */
+    const Real * SceneTransformPool::GetWorldMatrixInverse(Int32 handle) const {
+        NONFATAL_ASSERT_RTRN(handle >= 0 && (UInt32)handle < owners.size(), "SceneTransformPool::GetWorldMatrixInverse -> 'handle' is out of range.", nullptr, true);
+        return &worldMatricesInverse[handle * MatrixSize];
+    }
+
+    /*
+     * Get the number of scene objects stored in the pool.
+     */
+    UInt32 SceneTransformPool::GetSlotCount() const {
+        return (UInt32)owners.size();
+    }
+}
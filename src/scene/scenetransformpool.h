@@ -0,0 +1,82 @@
+/*
+ * class: SceneTransformPool
+ *
+ * author: Mark Kellogg
+ *
+ * Stores the local and world matrices of every scene object in the scene hierarchy in
+ * contiguous arrays (one array per kind of data, rather than one object per scene object).
+ *
+ * Scene objects are assigned slots in breadth-first order, so the slot of a scene object's parent
+ * always comes before its own slot. This allows the world matrices of the entire scene to be
+ * updated in a single linear pass over the arrays, rather than by walking the scene hierarchy.
+ *
+ * Each pooled scene object holds a handle (its slot index). The local matrix that is stored in
+ * the pool is kept in sync with the scene object's SceneObjectTransform, and the pool is rebuilt
+ * whenever the structure of the scene hierarchy changes.
+ */
+
+#ifndef _GTE_SCENE_TRANSFORM_POOL_H_
+#define _GTE_SCENE_TRANSFORM_POOL_H_
+
+#include "engine.h"
+#include "global/global.h"
+
+#include <vector>
+
+namespace GTE {
+    // forward declarations
+    class SceneObject;
+    class Matrix4x4;
+
+    class SceneTransformPool {
+    public:
+
+        // handle value for scene objects that are not stored in the pool
+        static const Int32 InvalidHandle = -1;
+
+    private:
+
+        // number of Real values in each matrix
+        static const UInt32 MatrixSize = 16;
+
+        // local matrix of each slot
+        std::vector<Real> localMatrices;
+        // world matrix of each slot
+        std::vector<Real> worldMatrices;
+        // inverse of the world matrix of each slot
+        std::vector<Real> worldMatricesInverse;
+        // slot of the parent from which each slot inherits its transform, or InvalidHandle if it does not inherit one
+        std::vector<Int32> parentSlots;
+        // has the local matrix of each slot changed since the last world matrix update?
+        std::vector<UChar> localDirty;
+        // was the world matrix of each slot recalculated during the last world matrix update?
+        std::vector<UChar> worldUpdated;
+        // the scene object that is stored in each slot
+        std::vector<SceneObject*> owners;
+
+        // has the structure of the scene hierarchy changed since the pool was last built?
+        Bool structureDirty;
+
+        void ReleaseOwners();
+
+    public:
+
+        SceneTransformPool();
+        ~SceneTransformPool();
+
+        void Build(SceneObject& root);
+        void Clear();
+        void UpdateWorldMatrices();
+
+        void MarkStructureDirty();
+        Bool IsStructureDirty() const;
+        void RemoveOwner(Int32 handle);
+
+        void SetLocalMatrix(Int32 handle, const Matrix4x4& matrix);
+        const Real * GetWorldMatrix(Int32 handle) const;
+        const Real * GetWorldMatrixInverse(Int32 handle) const;
+        UInt32 GetSlotCount() const;
+    };
+}
+
+#endif
@@ -0,0 +1,359 @@
+/*
+ * class: BoundingVolumeHierarchy
+ *
+ * author: Mark Kellogg
+ *
+ * A binary tree of axis-aligned bounding boxes that is used to quickly find all items
+ * whose bounds pass some spatial test (e.g. intersection with a view frustum or a light's range).
+ *
+ * Each item (leaf) is identified by a unique key of type K and carries a piece of user data
+ * of type T. The hierarchy is meant to be updated once per frame in the following manner:
+ *
+ *   BeginUpdate();
+ *   UpdateLeaf(...);   <- once for every item that currently exists
+ *   EndUpdate();
+ *
+ * Leaves that are not updated between BeginUpdate() and EndUpdate() are removed. If the set of
+ * leaves has not changed, the existing tree is incrementally refit to the new bounds. The tree is
+ * only rebuilt from scratch when leaves are added or removed, or when refitting has caused
+ * the quality of the tree to degrade too far.
+ */
+
+#ifndef _GTE_BOUNDING_VOLUME_HIERARCHY_H_
+#define _GTE_BOUNDING_VOLUME_HIERARCHY_H_
+
+#include "engine.h"
+#include "global/global.h"
+#include "global/assert.h"
+
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <functional>
+
+namespace GTE {
+    template <typename K, typename T, typename KHasher = std::hash<K>, typename KEq = std::equal_to<K>> class BoundingVolumeHierarchy {
+    public:
+
+        class Bounds {
+        public:
+
+            Real Min[3];
+            Real Max[3];
+
+            void Set(const Real * center, const Real * extents) {
+                for (UInt32 i = 0; i < 3; i++) {
+                    Min[i] = center[i] - extents[i];
+                    Max[i] = center[i] + extents[i];
+                }
+            }
+
+            void SetTo(const Bounds& other) {
+                for (UInt32 i = 0; i < 3; i++) {
+                    Min[i] = other.Min[i];
+                    Max[i] = other.Max[i];
+                }
+            }
+
+            void Merge(const Bounds& other) {
+                for (UInt32 i = 0; i < 3; i++) {
+                    if (other.Min[i] < Min[i])Min[i] = other.Min[i];
+                    if (other.Max[i] > Max[i])Max[i] = other.Max[i];
+                }
+            }
+
+            Real GetSurfaceArea() const {
+                Real x = Max[0] - Min[0];
+                Real y = Max[1] - Min[1];
+                Real z = Max[2] - Min[2];
+                return 2.0f * (x * y + y * z + z * x);
+            }
+
+            Real GetCenter(UInt32 axis) const {
+                return (Min[axis] + Max[axis]) * 0.5f;
+            }
+        };
+
+    private:
+
+        // maximum number of leaves that will be stored in a single node
+        static const UInt32 MaxLeavesPerNode = 4;
+        // maximum depth of the tree that can be traversed by Query()
+        static const UInt32 MaxTraversalDepth = 64;
+
+        class Leaf {
+        public:
+
+            K Key;
+            T Data;
+            Bounds LeafBounds;
+            UInt32 UpdateStamp;
+        };
+
+        class Node {
+        public:
+
+            Bounds NodeBounds;
+            // indices of the child nodes, -1 for nodes that directly contain leaves
+            Int32 LeftChild;
+            Int32 RightChild;
+            // range of [leafOrder] that is covered by this node
+            UInt32 FirstLeaf;
+            UInt32 LeafCount;
+        };
+
+        // all leaves in the hierarchy, in no particular order
+        std::vector<Leaf> leaves;
+        // map leaf keys to their index in [leaves]
+        std::unordered_map<K, UInt32, KHasher, KEq> leafIndices;
+        // indices into [leaves], ordered such that every node covers a contiguous range
+        std::vector<UInt32> leafOrder;
+        // nodes of the tree; children are always stored after their parents
+        std::vector<Node> nodes;
+
+        // incremented on every call to BeginUpdate()
+        UInt32 currentStamp;
+        // has a leaf been added or removed since the last build
+        Bool structureChanged;
+        // total surface area of all nodes immediately after the last build
+        Real builtSurfaceArea;
+
+        /*
+         * Build the sub-tree covering the range [first, first + count) of [leafOrder] and return
+         * the index of its root node.
+         */
+        Int32 BuildNode(UInt32 first, UInt32 count) {
+            Int32 nodeIndex = (Int32)nodes.size();
+            nodes.push_back(Node());
+
+            Node node;
+            node.FirstLeaf = first;
+            node.LeafCount = count;
+            node.LeftChild = -1;
+            node.RightChild = -1;
+            node.NodeBounds.SetTo(leaves[leafOrder[first]].LeafBounds);
+
+            // find the bounds of the leaves' centers so we can pick the longest axis along which to split
+            Bounds centerBounds;
+            for (UInt32 i = 0; i < 3; i++) {
+                centerBounds.Min[i] = centerBounds.Max[i] = node.NodeBounds.GetCenter(i);
+            }
+
+            for (UInt32 i = first; i < first + count; i++) {
+                const Bounds& leafBounds = leaves[leafOrder[i]].LeafBounds;
+                node.NodeBounds.Merge(leafBounds);
+                for (UInt32 a = 0; a < 3; a++) {
+                    Real center = leafBounds.GetCenter(a);
+                    if (center < centerBounds.Min[a])centerBounds.Min[a] = center;
+                    if (center > centerBounds.Max[a])centerBounds.Max[a] = center;
+                }
+            }
+
+            if (count > MaxLeavesPerNode) {
+                UInt32 axis = 0;
+                for (UInt32 a = 1; a < 3; a++) {
+                    if (centerBounds.Max[a] - centerBounds.Min[a] > centerBounds.Max[axis] - centerBounds.Min[axis])axis = a;
+                }
+
+                // split at the median leaf along [axis]
+                UInt32 half = count / 2;
+                std::nth_element(leafOrder.begin() + first, leafOrder.begin() + first + half, leafOrder.begin() + first + count, [this, axis](UInt32 a, UInt32 b) {
+                    return leaves[a].LeafBounds.GetCenter(axis) < leaves[b].LeafBounds.GetCenter(axis);
+                });
+
+                node.LeftChild = BuildNode(first, half);
+                node.RightChild = BuildNode(first + half, count - half);
+            }
+
+            nodes[nodeIndex] = node;
+            return nodeIndex;
+        }
+
+        /*
+         * Rebuild the entire tree from the current set of leaves.
+         */
+        void Rebuild() {
+            nodes.clear();
+            leafOrder.resize(leaves.size());
+            for (UInt32 i = 0; i < leaves.size(); i++) {
+                leafOrder[i] = i;
+            }
+
+            if (leaves.size() > 0) {
+                BuildNode(0, (UInt32)leaves.size());
+            }
+
+            builtSurfaceArea = GetTotalSurfaceArea();
+            structureChanged = false;
+        }
+
+        /*
+         * Recalculate the bounds of every node from the current bounds of the leaves, without
+         * changing the structure of the tree.
+         */
+        void Refit() {
+            // children are always stored after their parents, so iterating in reverse
+            // guarantees child nodes are refit before the nodes that contain them
+            for (Int32 n = (Int32)nodes.size() - 1; n >= 0; n--) {
+                Node& node = nodes[n];
+                if (node.LeftChild >= 0) {
+                    node.NodeBounds.SetTo(nodes[node.LeftChild].NodeBounds);
+                    node.NodeBounds.Merge(nodes[node.RightChild].NodeBounds);
+                }
+                else {
+                    node.NodeBounds.SetTo(leaves[leafOrder[node.FirstLeaf]].LeafBounds);
+                    for (UInt32 i = node.FirstLeaf + 1; i < node.FirstLeaf + node.LeafCount; i++) {
+                        node.NodeBounds.Merge(leaves[leafOrder[i]].LeafBounds);
+                    }
+                }
+            }
+        }
+
+        /*
+         * Remove all leaves that were not updated since the last call to BeginUpdate().
+         */
+        void RemoveStaleLeaves() {
+            UInt32 i = 0;
+            while (i < leaves.size()) {
+                if (leaves[i].UpdateStamp != currentStamp) {
+                    leafIndices.erase(leaves[i].Key);
+
+                    // move the last leaf into the vacated slot
+                    UInt32 last = (UInt32)leaves.size() - 1;
+                    if (i != last) {
+                        leaves[i] = leaves[last];
+                        leafIndices[leaves[i].Key] = i;
+                    }
+                    leaves.pop_back();
+                    structureChanged = true;
+                }
+                else i++;
+            }
+        }
+
+        Real GetTotalSurfaceArea() const {
+            Real area = 0.0f;
+            for (UInt32 n = 0; n < nodes.size(); n++) {
+                area += nodes[n].NodeBounds.GetSurfaceArea();
+            }
+            return area;
+        }
+
+    public:
+
+        BoundingVolumeHierarchy() {
+            currentStamp = 0;
+            structureChanged = false;
+            builtSurfaceArea = 0.0f;
+        }
+
+        ~BoundingVolumeHierarchy() {
+
+        }
+
+        /*
+         * Start a new round of leaf updates.
+         */
+        void BeginUpdate() {
+            currentStamp++;
+        }
+
+        /*
+         * Add or update the leaf identified by [key]. Its bounds are described by the center point
+         * [center] and the half-widths in [extents] (both are arrays of three Real values).
+         */
+        void UpdateLeaf(const K& key, const T& data, const Real * center, const Real * extents) {
+            UInt32 index;
+            auto itr = leafIndices.find(key);
+            if (itr == leafIndices.end()) {
+                index = (UInt32)leaves.size();
+                leaves.push_back(Leaf());
+                leaves[index].Key = key;
+                leafIndices[key] = index;
+                structureChanged = true;
+            }
+            else {
+                index = itr->second;
+            }
+
+            Leaf& leaf = leaves[index];
+            leaf.Data = data;
+            leaf.LeafBounds.Set(center, extents);
+            leaf.UpdateStamp = currentStamp;
+        }
+
+        /*
+         * Finish the current round of leaf updates. Stale leaves are removed and the tree
+         * is either refit or rebuilt.
+         */
+        void EndUpdate() {
+            RemoveStaleLeaves();
+
+            if (structureChanged) {
+                Rebuild();
+                return;
+            }
+
+            // rebuild if refitting has grown the total surface area of the tree by more than 50%
+            Refit();
+            if (GetTotalSurfaceArea() > builtSurfaceArea * 1.5f) {
+                Rebuild();
+            }
+        }
+
+        /*
+         * Remove all leaves and nodes.
+         */
+        void Clear() {
+            leaves.clear();
+            leafIndices.clear();
+            leafOrder.clear();
+            nodes.clear();
+            structureChanged = false;
+            builtSurfaceArea = 0.0f;
+        }
+
+        UInt32 GetLeafCount() const {
+            return (UInt32)leaves.size();
+        }
+
+        UInt32 GetNodeCount() const {
+            return (UInt32)nodes.size();
+        }
+
+        /*
+         * Invoke [visitor] with the data of every leaf whose bounds pass [boundsTest]. [boundsTest] is invoked with the
+         * bounds of each node visited during traversal and must return true if the bounds pass the test. It is also invoked
+         * for the bounds of each candidate leaf, so [visitor] is only called for leaves that pass the test themselves.
+         */
+        void Query(const std::function<Bool(const Bounds&)>& boundsTest, const std::function<void(const T&)>& visitor) const {
+            if (nodes.size() == 0)return;
+
+            UInt32 stack[MaxTraversalDepth];
+            UInt32 stackSize = 0;
+            stack[stackSize++] = 0;
+
+            while (stackSize > 0) {
+                const Node& node = nodes[stack[--stackSize]];
+
+                if (!boundsTest(node.NodeBounds))continue;
+
+                if (node.LeftChild >= 0) {
+                    NONFATAL_ASSERT(stackSize + 2 <= MaxTraversalDepth, "BoundingVolumeHierarchy::Query -> Maximum traversal depth exceeded.", true);
+                    stack[stackSize++] = (UInt32)node.RightChild;
+                    stack[stackSize++] = (UInt32)node.LeftChild;
+                }
+                else {
+                    for (UInt32 i = node.FirstLeaf; i < node.FirstLeaf + node.LeafCount; i++) {
+                        const Leaf& leaf = leaves[leafOrder[i]];
+                        if (node.LeafCount == 1 || boundsTest(leaf.LeafBounds)) {
+                            visitor(leaf.Data);
+                        }
+                    }
+                }
+            }
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,159 @@
+#include <algorithm>
+
+#include "workerpool.h"
+#include "global/global.h"
+#include "global/assert.h"
+#include "debug/gtedebug.h"
+
+namespace GTE {
+    // set on every worker thread, and on a thread that submitted a job while it processes chunks of that job. a
+    // nested ParallelFor() must not wait on the pool (the calling thread would re-lock [dispatchMutex], or wait for
+    // workers that are blocked on it), so it is run serially instead.
+    static thread_local Bool insideJob = false;
+
+    /*
+    * Default constructor
+    */
+    WorkerPool::WorkerPool() {
+        currentJob = nullptr;
+        currentCount = 0;
+        currentChunkSize = 0;
+        currentChunkCount = 0;
+        nextChunk = 0;
+        jobGeneration = 0;
+        activeWorkers = 0;
+        shuttingDown = false;
+    }
+
+    /*
+    * Destructor
+    */
+    WorkerPool::~WorkerPool() {
+        ShutDown();
+    }
+
+    /*
+    * Start [threadCount] worker threads. A [threadCount] of 0 is valid, in which case all work
+    * submitted to the pool is executed on the calling thread.
+    */
+    Bool WorkerPool::Init(UInt32 threadCount) {
+        ShutDown();
+
+        shuttingDown = false;
+        for (UInt32 i = 0; i < threadCount; i++) {
+            workers.push_back(std::thread(&WorkerPool::WorkerLoop, this));
+        }
+
+        return true;
+    }
+
+    /*
+    * Stop and join all worker threads.
+    */
+    void WorkerPool::ShutDown() {
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            shuttingDown = true;
+        }
+        workAvailable.notify_all();
+
+        for (UInt32 i = 0; i < workers.size(); i++) {
+            if (workers[i].joinable())workers[i].join();
+        }
+
+        workers.clear();
+    }
+
+    /*
+    * Get the number of worker threads (not including the thread that calls ParallelFor()).
+    */
+    UInt32 WorkerPool::GetThreadCount() const {
+        return (UInt32)workers.size();
+    }
+
+    /*
+    * Main loop for each worker thread: wait for a job, help process its chunks, repeat.
+    */
+    void WorkerPool::WorkerLoop() {
+        UInt64 lastGeneration = 0;
+        insideJob = true;
+
+        while (true) {
+            std::unique_lock<std::mutex> lock(stateMutex);
+            workAvailable.wait(lock, [this, &lastGeneration] { return shuttingDown || jobGeneration != lastGeneration; });
+            if (shuttingDown)return;
+
+            lastGeneration = jobGeneration;
+            // the job may have already been completed by the other threads
+            if (currentJob == nullptr)continue;
+
+            const RangeJob * job = currentJob;
+            UInt32 count = currentCount;
+            UInt32 chunkSize = currentChunkSize;
+            UInt32 chunkCount = currentChunkCount;
+            activeWorkers++;
+            lock.unlock();
+
+            ProcessChunks(*job, count, chunkSize, chunkCount);
+
+            lock.lock();
+            activeWorkers--;
+            if (activeWorkers == 0)workFinished.notify_all();
+        }
+    }
+
+    /*
+    * Claim and process chunks of the current job until none remain.
+    */
+    void WorkerPool::ProcessChunks(const RangeJob& job, UInt32 count, UInt32 chunkSize, UInt32 chunkCount) {
+        UInt32 chunk = nextChunk.fetch_add(1);
+        while (chunk < chunkCount) {
+            UInt32 start = chunk * chunkSize;
+            UInt32 end = std::min(start + chunkSize, count);
+            job(start, end);
+            chunk = nextChunk.fetch_add(1);
+        }
+    }
+
+    /*
+    * Invoke [job] for each chunk of [chunkSize] consecutive indices in the range [0, count). Chunks
+    * are processed concurrently by the worker threads and the calling thread. This method does not
+    * return until all chunks have been processed.
+    */
+    void WorkerPool::ParallelFor(UInt32 count, UInt32 chunkSize, const RangeJob& job) {
+        if (count == 0)return;
+        if (chunkSize == 0)chunkSize = 1;
+
+        UInt32 chunkCount = (count + chunkSize - 1) / chunkSize;
+
+        // nothing to gain from (or no way to) distribute the work
+        if (chunkCount == 1 || workers.size() == 0 || insideJob) {
+            for (UInt32 start = 0; start < count; start += chunkSize) {
+                job(start, std::min(start + chunkSize, count));
+            }
+            return;
+        }
+
+        std::lock_guard<std::mutex> dispatchLock(dispatchMutex);
+
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            currentJob = &job;
+            currentCount = count;
+            currentChunkSize = chunkSize;
+            currentChunkCount = chunkCount;
+            nextChunk = 0;
+            jobGeneration++;
+        }
+        workAvailable.notify_all();
+
+        insideJob = true;
+        ProcessChunks(job, count, chunkSize, chunkCount);
+        insideJob = false;
+
+        // wait for any workers that are still processing chunks, after which [job] is no longer referenced
+        std::unique_lock<std::mutex> lock(stateMutex);
+        workFinished.wait(lock, [this] { return activeWorkers == 0; });
+        currentJob = nullptr;
+    }
+}
@@ -0,0 +1,79 @@
+/*
+ * class: WorkerPool
+ *
+ * author: Mark Kellogg
+ *
+ * A fixed set of worker threads that is used to split data-parallel work (e.g. vertex skinning)
+ * across all available CPU cores.
+ *
+ * Work is submitted via ParallelFor(), which divides a range of indices into chunks of a
+ * fixed size and invokes a job function for each chunk. The calling thread participates in the
+ * work and ParallelFor() does not return until every chunk has been processed. Since the
+ * chunk boundaries depend only on the range and chunk size, jobs that write only to the elements
+ * in their own chunk produce the same output regardless of how many threads are used.
+ *
+ * Calls to ParallelFor() made from inside a job (on a worker thread, or on the thread that submitted
+ * the job while it is processing chunks) are executed serially on the calling thread, so jobs may
+ * safely invoke code that itself uses the pool.
+ */
+
+#ifndef _GTE_WORKER_POOL_H_
+#define _GTE_WORKER_POOL_H_
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+
+#include "engine.h"
+#include "global/global.h"
+
+namespace GTE {
+    class WorkerPool {
+    public:
+
+        typedef std::function<void(UInt32 start, UInt32 end)> RangeJob;
+
+    private:
+
+        std::vector<std::thread> workers;
+
+        // guards all state related to the current job
+        std::mutex stateMutex;
+        // serializes calls to ParallelFor() from different (non-worker) threads
+        std::mutex dispatchMutex;
+        std::condition_variable workAvailable;
+        std::condition_variable workFinished;
+
+        // the job that is currently being processed, or nullptr if there is none
+        const RangeJob * currentJob;
+        UInt32 currentCount;
+        UInt32 currentChunkSize;
+        UInt32 currentChunkCount;
+        // index of the next chunk of the current job that has not yet been claimed by a thread
+        std::atomic<UInt32> nextChunk;
+        // incremented every time a new job is submitted
+        UInt64 jobGeneration;
+        // number of worker threads currently processing chunks of the current job
+        UInt32 activeWorkers;
+        Bool shuttingDown;
+
+        void WorkerLoop();
+        void ProcessChunks(const RangeJob& job, UInt32 count, UInt32 chunkSize, UInt32 chunkCount);
+
+    public:
+
+        WorkerPool();
+        ~WorkerPool();
+
+        Bool Init(UInt32 threadCount);
+        void ShutDown();
+
+        UInt32 GetThreadCount() const;
+        void ParallelFor(UInt32 count, UInt32 chunkSize, const RangeJob& job);
+    };
+}
+
+#endif
@@ -0,0 +1,526 @@
+/*
+ * Standalone check of the layered pose blending of AnimationPlayer (animation layers, node masks, additive layers and
+ * the weight threshold). It does not need a graphics context, so it can be run on a build machine without a GPU.
+ *
+ * A small skeleton (root -> spine -> arm -> hand, and root -> leg) is animated by three layers:
+ *
+ *   - the base layer blends two clips with weights of 0.7 and 0.3 (one of them with rotations in the opposite
+ *     hemisphere, which must be flipped before they are summed), plus a third clip whose weight is below the
+ *     weight threshold and which therefore must not be sampled,
+ *   - an override layer with a weight of 0.8 that is masked to the arm and its descendants,
+ *   - an additive layer with a weight of 0.5 whose clip only has a channel for the spine.
+ *
+ * Every clip holds a constant pose, so the pose that AnimationPlayer::Evaluate() samples for each node can be compared
+ * against one calculated independently (in double precision) from the rules described in AnimationPlayer. The pose is
+ * checked again after lowering the weight threshold, at which point the third clip must contribute.
+ *
+ * Build & run from the repository root:
+ *
+ *   g++ -std=c++11 -O2 -Isrc -o animationlayerstest tests/animationlayerstest.cpp \
+ *       src/graphics/animation/animationplayer.cpp src/graphics/animation/animationinstance.cpp \
+ *       src/graphics/animation/animation.cpp src/graphics/animation/compressedanimation.cpp \
+ *       src/graphics/animation/keyframeset.cpp src/graphics/animation/keyframe.cpp \
+ *       src/graphics/animation/translationkeyframe.cpp src/graphics/animation/rotationkeyframe.cpp \
+ *       src/graphics/animation/scalekeyframe.cpp src/graphics/animation/blendop.cpp \
+ *       src/graphics/animation/crossfadeblendop.cpp src/graphics/animation/skeleton.cpp \
+ *       src/graphics/animation/skeletondefinition.cpp src/graphics/animation/skeletonnode.cpp \
+ *       src/graphics/animation/bone.cpp src/graphics/animation/vertexbonemap.cpp src/object/engineobject.cpp \
+ *       src/geometry/transform.cpp src/geometry/matrix4x4.cpp src/geometry/quaternion.cpp src/geometry/point/point3.cpp \
+ *       src/geometry/vector/vector3.cpp src/gtemath/gtemath.cpp src/global/constants.cpp src/debug/gtedebug.cpp \
+ *       src/error/errormanager.cpp
+ *   ./animationlayerstest
+ *
+ * The program exits with a non-zero status if any check fails.
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include <string>
+#include <vector>
+
+#include "engine.h"
+#include "graphics/animation/animationplayer.h"
+#include "graphics/animation/animationinstance.h"
+#include "graphics/animation/animationmanager.h"
+#include "graphics/animation/animation.h"
+#include "graphics/animation/skeleton.h"
+#include "graphics/animation/skeletonnode.h"
+#include "graphics/animation/keyframeset.h"
+#include "graphics/animation/translationkeyframe.h"
+#include "graphics/animation/rotationkeyframe.h"
+#include "graphics/animation/scalekeyframe.h"
+#include "geometry/transform.h"
+#include "util/time.h"
+
+namespace GTE {
+    // Skeletons, animations and players are normally created by the real EngineObjectManager, which needs the whole
+    // engine. This stand-in (which all of those classes already befriend) only does the allocation, and gives access
+    // to the animation weights and the sampled pose of a player.
+    class EngineObjectManager {
+    public:
+
+        static SkeletonSharedPtr CreateSkeleton() {
+            return SkeletonSharedPtr(new(std::nothrow) Skeleton(0), [](Skeleton * skeleton) {
+                delete skeleton;
+            });
+        }
+
+        static AnimationSharedPtr CreateAnimation(Real duration, UInt32 channelCount, ObjectID id) {
+            Animation * animation = new(std::nothrow) Animation(duration, 1);
+            animation->Init(channelCount);
+            animation->SetObjectID(id);
+            return AnimationSharedPtr(animation, [](Animation * animation) {
+                delete animation;
+            });
+        }
+
+        static AnimationPlayer * CreateAnimationPlayer(SkeletonRef target) {
+            return new(std::nothrow) AnimationPlayer(target);
+        }
+
+        static void DestroyAnimationPlayer(AnimationPlayer * player) {
+            delete player;
+        }
+
+        /*
+         * Register [animation] with [player] the way AnimationPlayer::AddAnimation() does. AddAnimation() itself
+         * looks up the animation manager and this object manager through the engine, which this program does not have.
+         */
+        static void AddAnimation(AnimationPlayer * player, AnimationConstRef animation) {
+            AnimationInstanceSharedPtr instance(new(std::nothrow) AnimationInstance(player->target, animation), [](AnimationInstance * instance) {
+                delete instance;
+            });
+            instance->Init();
+
+            player->registeredAnimations.push_back(instance);
+            player->animationLayers.push_back(0);
+            for (UInt32 l = 0; l < player->layers.size(); l++) {
+                player->layers[l].AnimationWeights.push_back(0);
+            }
+            player->crossFadeTargets.push_back(false);
+            player->animationIndexMap[animation->GetObjectID()] = player->animationCount;
+            player->animationCount++;
+        }
+
+        // start [animation] with a blending weight of [weight] within its layer, without stopping the other animations
+        static void PlayWithWeight(AnimationPlayer * player, AnimationConstRef animation, Real weight) {
+            UInt32 index = player->animationIndexMap[animation->GetObjectID()];
+            player->SetAnimationWeight(index, weight);
+            player->registeredAnimations[index]->Play();
+            player->CountPlayingAnimations();
+        }
+
+        static void Evaluate(AnimationPlayer * player) {
+            player->Evaluate();
+        }
+
+        static Bool GetSampledPose(AnimationPlayer * player, UInt32 node, Vector3& translation, Quaternion& rotation, Vector3& scale) {
+            if (node >= player->sampledPose.size() || !player->sampledPose[node].Valid)return false;
+            translation = player->sampledPose[node].Translation;
+            rotation = player->sampledPose[node].Rotation;
+            scale = player->sampledPose[node].Scale;
+            return true;
+        }
+
+        // referenced by AnimationPlayer::AddAnimation(), which this program does not call
+        AnimationInstanceSharedPtr CreateAnimationInstance(SkeletonSharedPtr target, AnimationSharedConstPtr animation);
+    };
+
+    AnimationInstanceSharedPtr EngineObjectManager::CreateAnimationInstance(SkeletonSharedPtr target, AnimationSharedConstPtr animation) {
+        return AnimationInstanceSharedPtr::Null();
+    }
+
+    // AnimationPlayer only uses the engine (and the animation manager) when animations are added through AddAnimation(),
+    // which this program does not call, so the engine itself is not needed.
+    Engine * Engine::Instance() {
+        return nullptr;
+    }
+
+    ErrorManager * Engine::GetErrorManager() {
+        return nullptr;
+    }
+
+    EngineObjectManager * Engine::GetEngineObjectManager() {
+        return nullptr;
+    }
+
+    AnimationManager * Engine::GetAnimationManager() {
+        return nullptr;
+    }
+
+    Bool AnimationManager::IsCompatible(SkeletonConstRef skeleton, AnimationConstRef animation) const {
+        return true;
+    }
+
+    // the clips hold constant poses, so it does not matter how far they advance
+    Real Time::GetDeltaTime() {
+        return 0;
+    }
+}
+
+using namespace GTE;
+
+namespace {
+    // nodes of the test skeleton; the parent of each node is given by NodeParents
+    const char * NodeNames[] = { "root", "spine", "arm", "hand", "leg" };
+    const Int32 NodeParents[] = { -1, 0, 1, 2, 0 };
+    const UInt32 NodeCount = 5;
+    const UInt32 Spine = 1, Arm = 2, Hand = 3;
+
+    const Real ClipDuration = 2.0f;
+    const Real BaseWeightA = 0.7f, BaseWeightB = 0.3f;
+    // below the default weight threshold of AnimationPlayer
+    const Real IgnoredWeight = 0.0005f;
+    const Real OverrideLayerWeight = 0.8f;
+    const Real AdditiveLayerWeight = 0.5f;
+    const double Tolerance = 1e-4;
+
+    // small deterministic random number generator, so that the results are the same on every platform
+    UInt32 randomState = 12345;
+
+    double Random(double min, double max) {
+        randomState = randomState * 1664525u + 1013904223u;
+        return min + (max - min) * ((randomState >> 8) / (double)(1 << 24));
+    }
+
+    /*
+     * The simplest possible SkeletonNode: it holds its target transformation itself, rather than pointing
+     * to a scene object like SceneObjectSkeletonNode.
+     */
+    class TestSkeletonNode : public SkeletonNode {
+        Transform transform;
+
+    protected:
+
+        TestSkeletonNode(const TestSkeletonNode& source) : SkeletonNode(source) {
+            transform.SetTo(source.transform);
+        }
+
+    public:
+
+        TestSkeletonNode(Int32 boneIndex, const std::string& name) : SkeletonNode(boneIndex, name) {
+        }
+
+        const Transform * GetFullTransform() const override {
+            return &transform;
+        }
+
+        Transform * GetLocalTransform() override {
+            return &transform;
+        }
+
+        Bool HasTarget() const override {
+            return true;
+        }
+
+        SkeletonNode * FullClone() const override {
+            return new(std::nothrow) TestSkeletonNode(*this);
+        }
+    };
+
+    // double precision pose and quaternion operations for the expected results
+    class Quat {
+    public:
+
+        double X, Y, Z, W;
+
+        Quat() : X(0), Y(0), Z(0), W(1) {}
+        Quat(double x, double y, double z, double w) : X(x), Y(y), Z(z), W(w) {}
+        Quat(const Quaternion& q) : X(q.x()), Y(q.y()), Z(q.z()), W(q.w()) {}
+
+        double Dot(const Quat& q) const {
+            return X * q.X + Y * q.Y + Z * q.Z + W * q.W;
+        }
+
+        Quat Scaled(double s) const {
+            return Quat(X * s, Y * s, Z * s, W * s);
+        }
+
+        Quat Plus(const Quat& q) const {
+            return Quat(X + q.X, Y + q.Y, Z + q.Z, W + q.W);
+        }
+
+        Quat Normalized() const {
+            return Scaled(1.0 / sqrt(Dot(*this)));
+        }
+
+        Quat Conjugate() const {
+            return Quat(-X, -Y, -Z, W);
+        }
+
+        Quat Times(const Quat& q) const {
+            return Quat(W * q.X + X * q.W + Y * q.Z - Z * q.Y,
+                        W * q.Y - X * q.Z + Y * q.W + Z * q.X,
+                        W * q.Z + X * q.Y - Y * q.X + Z * q.W,
+                        W * q.W - X * q.X - Y * q.Y - Z * q.Z);
+        }
+
+        // spherical interpolation along the shorter arc
+        static Quat Slerp(const Quat& a, Quat b, double t) {
+            double cosine = a.Dot(b);
+            if (cosine < 0) {
+                b = b.Scaled(-1);
+                cosine = -cosine;
+            }
+            if (cosine > 0.9999999)return a.Scaled(1 - t).Plus(b.Scaled(t)).Normalized();
+            double angle = acos(cosine);
+            return a.Scaled(sin((1 - t) * angle) / sin(angle)).Plus(b.Scaled(sin(t * angle) / sin(angle)));
+        }
+    };
+
+    class Pose {
+    public:
+
+        double Translation[3];
+        Quat Rotation;
+        double Scale[3];
+    };
+
+    Pose RandomPose() {
+        Pose pose;
+        for (UInt32 i = 0; i < 3; i++) {
+            pose.Translation[i] = Random(-3, 3);
+            pose.Scale[i] = Random(0.5, 1.5);
+        }
+        pose.Rotation = Quat(Random(-1, 1), Random(-1, 1), Random(-1, 1), Random(-1, 1)).Normalized();
+        return pose;
+    }
+
+    Pose ToPose(const Vector3& translation, const Quaternion& rotation, const Vector3& scale) {
+        Pose pose;
+        pose.Translation[0] = translation.x; pose.Translation[1] = translation.y; pose.Translation[2] = translation.z;
+        pose.Rotation = Quat(rotation);
+        pose.Scale[0] = scale.x; pose.Scale[1] = scale.y; pose.Scale[2] = scale.z;
+        return pose;
+    }
+
+    // angle between two rotations
+    double RotationAngle(const Quat& a, const Quat& b) {
+        double dot = fabs(a.Normalized().Dot(b.Normalized()));
+        return dot >= 1 ? 0 : 2 * acos(dot);
+    }
+
+    double PoseError(const Pose& a, const Pose& b) {
+        double error = RotationAngle(a.Rotation, b.Rotation);
+        for (UInt32 i = 0; i < 3; i++) {
+            error = fmax(error, fabs(a.Translation[i] - b.Translation[i]));
+            error = fmax(error, fabs(a.Scale[i] - b.Scale[i]));
+        }
+        return error;
+    }
+
+    /*
+     * Create a clip that holds [poses] (one per node, or nullptr for nodes the clip does not animate) for its
+     * whole duration.
+     */
+    AnimationSharedPtr CreateConstantClip(const std::vector<const Pose *>& poses, ObjectID id) {
+        UInt32 channelCount = 0;
+        for (UInt32 n = 0; n < NodeCount; n++) {
+            if (poses[n] != nullptr)channelCount++;
+        }
+
+        AnimationSharedPtr clip = EngineObjectManager::CreateAnimation(ClipDuration, channelCount, id);
+        UInt32 channel = 0;
+        for (UInt32 n = 0; n < NodeCount; n++) {
+            const Pose * pose = poses[n];
+            if (pose == nullptr)continue;
+
+            clip->SetChannelName(channel, NodeNames[n]);
+            KeyFrameSet * keyFrameSet = clip->GetKeyFrameSet(channel);
+            keyFrameSet->Used = true;
+
+            Vector3 translation((Real)pose->Translation[0], (Real)pose->Translation[1], (Real)pose->Translation[2]);
+            Vector3 scale((Real)pose->Scale[0], (Real)pose->Scale[1], (Real)pose->Scale[2]);
+            Quaternion rotation((Real)pose->Rotation.X, (Real)pose->Rotation.Y, (Real)pose->Rotation.Z, (Real)pose->Rotation.W);
+            for (UInt32 k = 0; k < 2; k++) {
+                Real time = k * ClipDuration;
+                keyFrameSet->TranslationKeyFrames.push_back(TranslationKeyFrame((Real)k, time, time, translation));
+                keyFrameSet->RotationKeyFrames.push_back(RotationKeyFrame((Real)k, time, time, rotation));
+                keyFrameSet->ScaleKeyFrames.push_back(ScaleKeyFrame((Real)k, time, time, scale));
+            }
+            channel++;
+        }
+
+        return clip;
+    }
+
+    // the pose the player uses for a node that a clip does not animate, and the identity for additive layers
+    Pose GetInitialPose(SkeletonRef skeleton, UInt32 node) {
+        SkeletonNode * skeletonNode = skeleton->GetNodeFromList(node);
+        return ToPose(skeletonNode->GetInitialTranslation(), skeletonNode->GetInitialRotation(), skeletonNode->GetInitialScale());
+    }
+
+    /*
+     * Calculate the expected pose of every node from the rules of AnimationPlayer, for the base layer clips in [baseClips]
+     * (with [baseWeights]), the override clip and the additive clip.
+     */
+    std::vector<Pose> CalculateExpectedPose(SkeletonRef skeleton, const std::vector<std::vector<Pose>>& baseClips, const std::vector<Real>& baseWeights,
+                                            const std::vector<Pose>& overrideClip, const std::vector<const Pose *>& additiveClip) {
+        std::vector<Pose> expected(NodeCount);
+        for (UInt32 n = 0; n < NodeCount; n++) {
+            Pose& pose = expected[n];
+
+            // base layer: weighted sum of the clips, with each rotation flipped into the hemisphere of the sum so far
+            Quat rotationSum(0, 0, 0, 0);
+            for (UInt32 i = 0; i < 3; i++)pose.Translation[i] = pose.Scale[i] = 0;
+            for (UInt32 c = 0; c < baseClips.size(); c++) {
+                const Pose& clip = baseClips[c][n];
+                double weight = baseWeights[c];
+                for (UInt32 i = 0; i < 3; i++) {
+                    pose.Translation[i] += clip.Translation[i] * weight;
+                    pose.Scale[i] += clip.Scale[i] * weight;
+                }
+                double rotationWeight = rotationSum.Dot(clip.Rotation) < 0 ? -weight : weight;
+                rotationSum = rotationSum.Plus(clip.Rotation.Scaled(rotationWeight));
+            }
+            pose.Rotation = rotationSum.Normalized();
+
+            // override layer, masked to the arm and its descendants
+            if (n == Arm || n == Hand) {
+                double influence = OverrideLayerWeight;
+                for (UInt32 i = 0; i < 3; i++) {
+                    pose.Translation[i] += (overrideClip[n].Translation[i] - pose.Translation[i]) * influence;
+                    pose.Scale[i] += (overrideClip[n].Scale[i] - pose.Scale[i]) * influence;
+                }
+                pose.Rotation = Quat::Slerp(pose.Rotation, overrideClip[n].Rotation, influence);
+            }
+
+            // additive layer: the difference of the clip from the initial pose; nodes without a channel in the clip
+            // sample the initial pose, so their difference is zero
+            if (additiveClip[n] != nullptr) {
+                const Pose& clip = *additiveClip[n];
+                Pose initial = GetInitialPose(skeleton, n);
+                double influence = AdditiveLayerWeight;
+                for (UInt32 i = 0; i < 3; i++) {
+                    pose.Translation[i] += (clip.Translation[i] - initial.Translation[i]) * influence;
+                    pose.Scale[i] *= 1 + (clip.Scale[i] / initial.Scale[i] - 1) * influence;
+                }
+                Quat delta = initial.Rotation.Conjugate().Times(clip.Rotation);
+                pose.Rotation = pose.Rotation.Times(Quat::Slerp(Quat(), delta, influence)).Normalized();
+            }
+        }
+        return expected;
+    }
+
+    /*
+     * Evaluate [player] and compare the sampled pose of every node with [expected]. Returns the largest error.
+     */
+    double CompareSampledPose(AnimationPlayer * player, const std::vector<Pose>& expected, const char * description, UInt32& errors) {
+        EngineObjectManager::Evaluate(player);
+
+        double maxError = 0;
+        for (UInt32 n = 0; n < NodeCount; n++) {
+            Vector3 translation, scale;
+            Quaternion rotation;
+            if (!EngineObjectManager::GetSampledPose(player, n, translation, rotation, scale)) {
+                printf("%s: no pose was sampled for node '%s'\n", description, NodeNames[n]);
+                errors++;
+                continue;
+            }
+
+            double error = PoseError(ToPose(translation, rotation, scale), expected[n]);
+            maxError = fmax(maxError, error);
+            if (error > Tolerance) {
+                printf("%s: the pose of node '%s' is off by %g\n", description, NodeNames[n], error);
+                errors++;
+            }
+        }
+        return maxError;
+    }
+}
+
+int main(int argc, char ** argv) {
+    UInt32 errors = 0;
+
+    // build the skeleton, with a random initial (bind) pose for each node
+    SkeletonSharedPtr skeleton = EngineObjectManager::CreateSkeleton();
+    skeleton->Init();
+    std::vector<Tree<SkeletonNode*>::TreeNode *> treeNodes(NodeCount);
+    for (UInt32 n = 0; n < NodeCount; n++) {
+        std::string name = NodeNames[n];
+        TestSkeletonNode * node = new(std::nothrow) TestSkeletonNode(-1, name);
+
+        Pose initialPose = RandomPose();
+        Matrix4x4 initialTransform;
+        initialTransform.Scale((Real)initialPose.Scale[0], (Real)initialPose.Scale[1], (Real)initialPose.Scale[2]);
+        Quaternion initialRotation((Real)initialPose.Rotation.X, (Real)initialPose.Rotation.Y, (Real)initialPose.Rotation.Z, (Real)initialPose.Rotation.W);
+        initialTransform.PreMultiply(initialRotation.rotationMatrix());
+        initialTransform.PreTranslate((Real)initialPose.Translation[0], (Real)initialPose.Translation[1], (Real)initialPose.Translation[2]);
+        node->SetInitialTransform(initialTransform);
+
+        treeNodes[n] = NodeParents[n] < 0 ? skeleton->CreateRoot(node) : skeleton->AddChild(treeNodes[NodeParents[n]], node);
+        skeleton->MapNode(name, n);
+        skeleton->AddNodeToList(node);
+    }
+
+    // the poses of the clips
+    std::vector<std::vector<Pose>> basePoses(3, std::vector<Pose>(NodeCount));
+    std::vector<Pose> overridePoses(NodeCount);
+    Pose additivePose = RandomPose();
+    for (UInt32 n = 0; n < NodeCount; n++) {
+        basePoses[0][n] = RandomPose();
+        // close to the first clip, but in the opposite hemisphere for some nodes
+        basePoses[1][n] = RandomPose();
+        basePoses[1][n].Rotation = basePoses[0][n].Rotation.Plus(Quat(Random(-.3, .3), Random(-.3, .3), Random(-.3, .3), 0)).Normalized();
+        if (n % 2 == 0)basePoses[1][n].Rotation = basePoses[1][n].Rotation.Scaled(-1);
+        // far away from the others, so that it shows if it is sampled
+        basePoses[2][n] = RandomPose();
+        for (UInt32 i = 0; i < 3; i++)basePoses[2][n].Translation[i] = 1000;
+        overridePoses[n] = RandomPose();
+    }
+
+    std::vector<AnimationSharedPtr> baseClips;
+    for (UInt32 c = 0; c < 3; c++) {
+        std::vector<const Pose *> poses;
+        for (UInt32 n = 0; n < NodeCount; n++)poses.push_back(&basePoses[c][n]);
+        baseClips.push_back(CreateConstantClip(poses, c + 1));
+    }
+
+    std::vector<const Pose *> overrideClipPoses, additiveClipPoses;
+    for (UInt32 n = 0; n < NodeCount; n++) {
+        overrideClipPoses.push_back(&overridePoses[n]);
+        additiveClipPoses.push_back(n == Spine ? &additivePose : nullptr);
+    }
+    AnimationSharedPtr overrideClip = CreateConstantClip(overrideClipPoses, 4);
+    AnimationSharedPtr additiveClip = CreateConstantClip(additiveClipPoses, 5);
+
+    // set up the player: base layer, override layer masked to the arm, additive layer
+    AnimationPlayer * player = EngineObjectManager::CreateAnimationPlayer(skeleton);
+    for (UInt32 c = 0; c < 3; c++)EngineObjectManager::AddAnimation(player, baseClips[c]);
+    EngineObjectManager::AddAnimation(player, overrideClip);
+    EngineObjectManager::AddAnimation(player, additiveClip);
+
+    UInt32 overrideLayer = player->AddLayer(AnimationBlendMode::Override, OverrideLayerWeight);
+    player->SetLayerNodeMask(overrideLayer, "arm", 1, true);
+    player->SetAnimationLayer(overrideClip, overrideLayer);
+
+    UInt32 additiveLayer = player->AddLayer(AnimationBlendMode::Additive, AdditiveLayerWeight);
+    player->SetAnimationLayer(additiveClip, additiveLayer);
+
+    EngineObjectManager::PlayWithWeight(player, baseClips[0], BaseWeightA);
+    EngineObjectManager::PlayWithWeight(player, baseClips[1], BaseWeightB);
+    EngineObjectManager::PlayWithWeight(player, baseClips[2], IgnoredWeight);
+    EngineObjectManager::PlayWithWeight(player, overrideClip, 1);
+    EngineObjectManager::PlayWithWeight(player, additiveClip, 1);
+
+    // the third base clip is below the default weight threshold, so it must not contribute
+    std::vector<std::vector<Pose>> sampledBasePoses(basePoses.begin(), basePoses.begin() + 2);
+    std::vector<Real> sampledBaseWeights = { BaseWeightA, BaseWeightB };
+    std::vector<Pose> expected = CalculateExpectedPose(skeleton, sampledBasePoses, sampledBaseWeights, overridePoses, additiveClipPoses);
+    double defaultThresholdError = CompareSampledPose(player, expected, "default weight threshold", errors);
+
+    // without a threshold, the third base clip contributes as well
+    player->SetWeightThreshold(0);
+    std::vector<Real> allBaseWeights = { BaseWeightA, BaseWeightB, IgnoredWeight };
+    expected = CalculateExpectedPose(skeleton, basePoses, allBaseWeights, overridePoses, additiveClipPoses);
+    double noThresholdError = CompareSampledPose(player, expected, "no weight threshold", errors);
+
+    EngineObjectManager::DestroyAnimationPlayer(player);
+
+    printf("%u nodes, 3 layers\n", NodeCount);
+    printf("  maximum pose error with the default weight threshold: %.2g\n", defaultThresholdError);
+    printf("  maximum pose error without a weight threshold:        %.2g\n", noThresholdError);
+
+    printf(errors == 0 ? "PASSED\n" : "FAILED\n");
+    return errors == 0 ? 0 : 1;
+}
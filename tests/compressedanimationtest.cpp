@@ -0,0 +1,368 @@
+/*
+ * Standalone check of CompressedAnimation (key frame reduction and quantization of animation clips).
+ *
+ * A long synthetic clip is compressed, and both the original and the compressed clip are sampled at 60Hz the way
+ * AnimationPlayer samples them (linear interpolation of translations and scales, slerp of rotations, between the
+ * two key frames that bracket the sample time). Three things are verified:
+ *
+ *   - The round-trip error of every sample stays within the error bound of the compression: the reduction tolerance
+ *     in AnimationCompressionSettings plus the worst case quantization error of the track (half a 16-bit step of
+ *     the track's range per component for translations and scales, and the angle that corresponds to half a 15-bit
+ *     step per "smallest three" component for rotations).
+ *
+ *   - Key times survive the round trip exactly, and the first and last key frames of every animated track are kept.
+ *
+ *   - Constant tracks collapse to a single key frame, and the clip as a whole gets smaller.
+ *
+ * Build & run from the repository root:
+ *
+ *   g++ -std=c++11 -O2 -Isrc -o compressedanimationtest tests/compressedanimationtest.cpp \
+ *       src/graphics/animation/compressedanimation.cpp src/graphics/animation/keyframeset.cpp \
+ *       src/graphics/animation/keyframe.cpp src/graphics/animation/translationkeyframe.cpp \
+ *       src/graphics/animation/rotationkeyframe.cpp src/graphics/animation/scalekeyframe.cpp \
+ *       src/geometry/point/point3.cpp src/geometry/vector/vector3.cpp src/geometry/matrix4x4.cpp src/geometry/quaternion.cpp \
+ *       src/gtemath/gtemath.cpp src/global/constants.cpp src/debug/gtedebug.cpp src/error/errormanager.cpp
+ *   ./compressedanimationtest
+ *
+ * The program exits with a non-zero status if any check fails.
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+
+#include "engine.h"
+#include "graphics/animation/compressedanimation.h"
+#include "graphics/animation/keyframeset.h"
+#include "geometry/vector/vector3.h"
+#include "geometry/quaternion.h"
+#include "global/global.h"
+
+namespace GTE {
+    // CompressedAnimation only reports errors through the engine when it is used incorrectly, which this program
+    // never does, so the engine itself is not needed.
+    Engine * Engine::Instance() {
+        return nullptr;
+    }
+
+    ErrorManager * Engine::GetErrorManager() {
+        return nullptr;
+    }
+}
+
+using namespace GTE;
+
+namespace {
+    // number of channels (nodes) in the clip
+    const UInt32 ChannelCount = 24;
+    // key frame rate and length of the clip
+    const Real KeyFrameRate = 30.0f;
+    const UInt32 KeyFrameCount = 3000;
+    // rate at which the clips are sampled
+    const Real SampleRate = 60.0f;
+    // slack for single precision rounding in the interpolation itself
+    const double RoundingTolerance = 2e-5;
+
+    // small deterministic random number generator, so that the results are the same on every platform
+    UInt32 randomState = 12345;
+
+    double Random(double min, double max) {
+        randomState = randomState * 1664525u + 1013904223u;
+        return min + (max - min) * ((randomState >> 8) / (double)(1 << 24));
+    }
+
+    // parameters of the smooth curve of one channel: a sum of two sine waves per component
+    class ChannelCurve {
+    public:
+
+        double Amplitude[2][3];
+        double Frequency[2][3];
+        double Phase[2][3];
+        double Offset[3];
+        // animate the translation, the rotation or the scale of the channel?
+        Bool AnimateTranslation;
+        Bool AnimateRotation;
+        Bool AnimateScale;
+        // amplitude of per-key jitter, which defeats key reduction
+        double Jitter;
+    };
+
+    double EvaluateCurve(const ChannelCurve& curve, UInt32 component, double time) {
+        double value = curve.Offset[component];
+        for (UInt32 w = 0; w < 2; w++) {
+            value += curve.Amplitude[w][component] * sin(curve.Frequency[w][component] * time + curve.Phase[w][component]);
+        }
+        return value;
+    }
+
+    // unit quaternion for the rotation of [angle] radians around the (not necessarily unit) axis [x, y, z]
+    Quaternion AxisAngle(double x, double y, double z, double angle) {
+        double length = sqrt(x * x + y * y + z * z);
+        double s = sin(angle * 0.5) / length;
+        return Quaternion((Real)(x * s), (Real)(y * s), (Real)(z * s), (Real)cos(angle * 0.5));
+    }
+
+    // angle between two rotations, calculated in the same well-conditioned way as CompressedAnimation
+    double RotationAngle(const Quaternion& a, const Quaternion& b) {
+        double qa[4] = { a.x(), a.y(), a.z(), a.w() };
+        double qb[4] = { b.x(), b.y(), b.z(), b.w() };
+        double dot = qa[0] * qb[0] + qa[1] * qb[1] + qa[2] * qb[2] + qa[3] * qb[3];
+        double sign = dot < 0 ? -1.0 : 1.0;
+        double differenceSquared = 0, sumSquared = 0;
+        for (UInt32 i = 0; i < 4; i++) {
+            differenceSquared += (qa[i] - qb[i] * sign) * (qa[i] - qb[i] * sign);
+            sumSquared += (qa[i] + qb[i] * sign) * (qa[i] + qb[i] * sign);
+        }
+        return 4 * atan2(sqrt(differenceSquared), sqrt(sumSquared));
+    }
+
+    double Distance(const Vector3& a, const Vector3& b) {
+        double dx = (double)a.x - b.x, dy = (double)a.y - b.y, dz = (double)a.z - b.z;
+        return sqrt(dx * dx + dy * dy + dz * dz);
+    }
+
+    /*
+     * Find the key frame at or before [time] in a track with [count] key frames whose times are returned
+     * by [getTime], and the interpolation factor towards the next key frame.
+     */
+    template <typename T> UInt32 FindKeyFrame(UInt32 count, T getTime, Real time, Real& t) {
+        UInt32 lo = 0, hi = count - 1;
+        while (hi - lo > 1) {
+            UInt32 mid = (lo + hi) / 2;
+            if (getTime(mid) <= time)lo = mid;
+            else hi = mid;
+        }
+        if (count == 1 || time <= getTime(lo)) {
+            t = 0;
+            return lo;
+        }
+        if (time >= getTime(hi)) {
+            t = 0;
+            return hi;
+        }
+        Real span = getTime(hi) - getTime(lo);
+        t = span > 0 ? (time - getTime(lo)) / span : 0;
+        return lo;
+    }
+
+    void SampleVector(const std::vector<Vector3>& values, const std::vector<Real>& times, Real time, Vector3& out) {
+        Real t;
+        UInt32 k = FindKeyFrame((UInt32)times.size(), [&times](UInt32 i) { return times[i]; }, time, t);
+        UInt32 next = k + 1 < times.size() ? k + 1 : k;
+        Vector3::Lerp(values[k], values[next], out, t);
+    }
+
+    Quaternion SampleRotation(const std::vector<Quaternion>& values, const std::vector<Real>& times, Real time) {
+        Real t;
+        UInt32 k = FindKeyFrame((UInt32)times.size(), [&times](UInt32 i) { return times[i]; }, time, t);
+        UInt32 next = k + 1 < times.size() ? k + 1 : k;
+        return Quaternion::slerp(values[k], values[next], t);
+    }
+
+    // decompress every key frame of one track of [compressed]
+    void DecompressTrack(const CompressedAnimation& compressed, UInt32 channel, TransformationCompnent component,
+                         std::vector<Real>& times, std::vector<Vector3>& vectors, std::vector<Quaternion>& rotations) {
+        UInt32 count = compressed.GetKeyFrameCount(channel, component);
+        times.resize(count);
+        vectors.resize(count);
+        rotations.resize(count);
+        for (UInt32 k = 0; k < count; k++) {
+            times[k] = compressed.GetKeyFrameTime(channel, component, k);
+            if (component == TransformationCompnent::Rotation)compressed.GetRotation(channel, k, rotations[k]);
+            else compressed.GetVector(channel, component, k, vectors[k]);
+        }
+    }
+
+    // largest distance between a quantized vector and its original: half a 16-bit step of the range of each component
+    double VectorQuantizationBound(const std::vector<Vector3>& values) {
+        double extentSquared = 0;
+        for (UInt32 c = 0; c < 3; c++) {
+            double minValue = values[0].GetConstDataPtr()[c], maxValue = minValue;
+            for (UInt32 k = 1; k < values.size(); k++) {
+                minValue = fmin(minValue, values[k].GetConstDataPtr()[c]);
+                maxValue = fmax(maxValue, values[k].GetConstDataPtr()[c]);
+            }
+            double error = (maxValue - minValue) / 65535.0 * 0.5;
+            extentSquared += error * error;
+        }
+        return sqrt(extentSquared);
+    }
+
+    // largest angle between a quantized rotation and its original: each of the three stored components is off by at most
+    // half a 15-bit step of the range -1/sqrt(2) - 1/sqrt(2). The reconstructed (largest) component is at least 1/2, so its
+    // error is at most (sum of |stored component| * error) / (1/2), which is below 3 * (1/sqrt(2)) * error * 2. The angle is
+    // twice the distance between the quaternions.
+    double RotationQuantizationBound() {
+        double componentError = sqrt(2.0) / 32767.0 * 0.5;
+        double largestError = 3 * sqrt(0.5) * componentError * 2;
+        return 2 * sqrt(3 * componentError * componentError + largestError * largestError);
+    }
+}
+
+int main(int argc, char ** argv) {
+    std::vector<ChannelCurve> curves(ChannelCount);
+    for (UInt32 c = 0; c < ChannelCount; c++) {
+        ChannelCurve& curve = curves[c];
+        for (UInt32 i = 0; i < 3; i++) {
+            for (UInt32 w = 0; w < 2; w++) {
+                curve.Amplitude[w][i] = Random(0.05, 2.0) / (w + 1);
+                curve.Frequency[w][i] = Random(0.2, 3.0) * (w + 1);
+                curve.Phase[w][i] = Random(0, 6.28);
+            }
+            curve.Offset[i] = Random(-5, 5);
+        }
+
+        // a mix of typical channels: most rotate, some also translate, a few scale, one is
+        // completely static and a couple carry per-key noise (e.g. motion capture data)
+        curve.AnimateRotation = c != 0;
+        curve.AnimateTranslation = c % 3 == 1 || c == 2;
+        curve.AnimateScale = c % 8 == 5;
+        curve.Jitter = c % 11 == 7 ? 0.002 : 0.0;
+    }
+
+    std::vector<KeyFrameSet> keyFrameSets(ChannelCount);
+    Real duration = (KeyFrameCount - 1) / KeyFrameRate;
+    for (UInt32 c = 0; c < ChannelCount; c++) {
+        const ChannelCurve& curve = curves[c];
+        KeyFrameSet& keyFrameSet = keyFrameSets[c];
+        keyFrameSet.Used = true;
+
+        for (UInt32 k = 0; k < KeyFrameCount; k++) {
+            Real time = k / KeyFrameRate;
+            double jitter[3];
+            for (UInt32 i = 0; i < 3; i++)jitter[i] = curve.Jitter > 0 ? Random(-curve.Jitter, curve.Jitter) : 0;
+
+            double animatedTime = curve.AnimateTranslation ? time : 0.0;
+            Vector3 translation((Real)(EvaluateCurve(curve, 0, animatedTime) + jitter[0]),
+                                (Real)(EvaluateCurve(curve, 1, animatedTime) + jitter[1]),
+                                (Real)(EvaluateCurve(curve, 2, animatedTime) + jitter[2]));
+
+            double rotationTime = curve.AnimateRotation ? time : 0.0;
+            Quaternion rotation = AxisAngle(1 + 0.3 * sin(rotationTime * curve.Frequency[0][0]),
+                                            0.5 * cos(rotationTime * curve.Frequency[0][1]),
+                                            0.2 + jitter[1],
+                                            3 * sin(rotationTime * curve.Frequency[1][2] * 0.5 + curve.Phase[0][2]) + jitter[2] * 10);
+
+            double scaleTime = curve.AnimateScale ? time : 0.0;
+            Real scale = (Real)(1.0 + 0.25 * sin(scaleTime * curve.Frequency[0][2]));
+            Vector3 scales(scale, scale, scale);
+
+            keyFrameSet.TranslationKeyFrames.push_back(TranslationKeyFrame(time / duration, time, time, translation));
+            keyFrameSet.RotationKeyFrames.push_back(RotationKeyFrame(time / duration, time, time, rotation));
+            keyFrameSet.ScaleKeyFrames.push_back(ScaleKeyFrame(time / duration, time, time, scales));
+        }
+    }
+
+    AnimationCompressionSettings settings;
+    CompressedAnimation compressed;
+    if (!compressed.Init(&keyFrameSets[0], ChannelCount, settings)) {
+        printf("CompressedAnimation::Init() failed\n");
+        printf("FAILED\n");
+        return 1;
+    }
+
+    UInt32 errors = 0;
+    UInt32 originalKeyFrames = 0, keptKeyFrames = 0;
+    double maxTranslationError = 0, maxRotationError = 0, maxScaleError = 0;
+    double translationBound = 0, rotationBound = settings.RotationTolerance + RotationQuantizationBound(), scaleBound = 0;
+
+    std::vector<Real> originalTimes, times;
+    std::vector<Vector3> originalVectors, vectors;
+    std::vector<Quaternion> originalRotations, rotations;
+
+    for (UInt32 c = 0; c < ChannelCount; c++) {
+        const KeyFrameSet& keyFrameSet = keyFrameSets[c];
+        const ChannelCurve& curve = curves[c];
+
+        for (UInt32 component = 0; component < 3; component++) {
+            TransformationCompnent trackComponent = (TransformationCompnent)component;
+            DecompressTrack(compressed, c, trackComponent, times, vectors, rotations);
+
+            originalTimes.clear();
+            originalVectors.clear();
+            originalRotations.clear();
+            for (UInt32 k = 0; k < KeyFrameCount; k++) {
+                originalTimes.push_back(keyFrameSet.TranslationKeyFrames[k].RealTime);
+                if (trackComponent == TransformationCompnent::Translation)originalVectors.push_back(keyFrameSet.TranslationKeyFrames[k].Translation);
+                else if (trackComponent == TransformationCompnent::Scale)originalVectors.push_back(keyFrameSet.ScaleKeyFrames[k].Scale);
+                else originalRotations.push_back(keyFrameSet.RotationKeyFrames[k].Rotation);
+            }
+
+            originalKeyFrames += KeyFrameCount;
+            keptKeyFrames += (UInt32)times.size();
+
+            // key frame times must be exact, and animated tracks must keep both end points
+            Bool animated = trackComponent == TransformationCompnent::Translation ? curve.AnimateTranslation || curve.Jitter > 0 :
+                trackComponent == TransformationCompnent::Rotation ? curve.AnimateRotation || curve.Jitter > 0 : curve.AnimateScale;
+            if (animated) {
+                if (times.size() < 2 || times.front() != originalTimes.front() || times.back() != originalTimes.back()) {
+                    printf("channel %u, track %u: the end points of the track were not kept\n", c, component);
+                    errors++;
+                }
+            }
+            else if (times.size() != 1) {
+                printf("channel %u, track %u: constant track kept %u key frames\n", c, component, (UInt32)times.size());
+                errors++;
+            }
+            for (UInt32 k = 0; k < times.size(); k++) {
+                UInt32 index = (UInt32)(times[k] * KeyFrameRate + 0.5f);
+                if (index >= KeyFrameCount || originalTimes[index] != times[k]) {
+                    printf("channel %u, track %u: key frame time %f does not match an original key frame\n", c, component, times[k]);
+                    errors++;
+                    break;
+                }
+            }
+
+            // sample both versions of the track at 60Hz and compare against the bound of the track
+            double bound = trackComponent == TransformationCompnent::Rotation ? rotationBound :
+                (trackComponent == TransformationCompnent::Translation ? settings.TranslationTolerance : settings.ScaleTolerance) + VectorQuantizationBound(originalVectors);
+            bound += RoundingTolerance;
+
+            double maxError = 0;
+            for (Real time = 0; time <= duration; time += 1.0f / SampleRate) {
+                double error;
+                if (trackComponent == TransformationCompnent::Rotation) {
+                    error = RotationAngle(SampleRotation(originalRotations, originalTimes, time), SampleRotation(rotations, times, time));
+                }
+                else {
+                    Vector3 original, decompressed;
+                    SampleVector(originalVectors, originalTimes, time, original);
+                    SampleVector(vectors, times, time, decompressed);
+                    error = Distance(original, decompressed);
+                }
+                maxError = fmax(maxError, error);
+            }
+
+            if (maxError > bound) {
+                printf("channel %u, track %u: round-trip error %g exceeds the bound %g\n", c, component, maxError, bound);
+                errors++;
+            }
+
+            if (trackComponent == TransformationCompnent::Translation) {
+                maxTranslationError = fmax(maxTranslationError, maxError);
+                translationBound = fmax(translationBound, bound);
+            }
+            else if (trackComponent == TransformationCompnent::Rotation)maxRotationError = fmax(maxRotationError, maxError);
+            else {
+                maxScaleError = fmax(maxScaleError, maxError);
+                scaleBound = fmax(scaleBound, bound);
+            }
+        }
+    }
+
+    UInt32 originalBytes = ChannelCount * KeyFrameCount * (sizeof(TranslationKeyFrame) + sizeof(RotationKeyFrame) + sizeof(ScaleKeyFrame));
+    if (compressed.GetSizeInBytes() >= originalBytes) {
+        printf("the compressed clip (%u bytes) is not smaller than the original (%u bytes)\n", compressed.GetSizeInBytes(), originalBytes);
+        errors++;
+    }
+
+    printf("%u channels, %u key frames per track, sampled at %.0fHz\n", ChannelCount, KeyFrameCount, SampleRate);
+    printf("  key frames kept: %u of %u\n", keptKeyFrames, originalKeyFrames);
+    printf("  size: %u bytes -> %u bytes\n", originalBytes, compressed.GetSizeInBytes());
+    printf("  maximum translation error: %.3g (bound %.3g)\n", maxTranslationError, translationBound);
+    printf("  maximum rotation error:    %.3g radians (bound %.3g)\n", maxRotationError, rotationBound + RoundingTolerance);
+    printf("  maximum scale error:       %.3g (bound %.3g)\n", maxScaleError, scaleBound);
+
+    printf(errors == 0 ? "PASSED\n" : "FAILED\n");
+    return errors == 0 ? 0 : 1;
+}
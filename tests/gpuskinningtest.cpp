@@ -0,0 +1,343 @@
+/*
+ * Standalone check that vertex skinning in the vertex shader (skinning.inc) produces the same results as the CPU
+ * skinning path of SkinnedMesh3DAttributeTransformer. It does not need a graphics context, so it can be run on a
+ * build machine without a GPU.
+ *
+ * The vertex shader is emulated the way a software rasterizer such as llvmpipe executes it: the GLSL of
+ * getSkinningTransform(), skinPosition() and skinVector() is transcribed statement by statement in single precision,
+ * and it reads the same data the GPU would receive:
+ *
+ *   - the skinning palette exactly as SendShaderTransformUniforms() uploads it: the 3x4 bone matrices stored by
+ *     StoreAffineMatrix(), followed by the all-zero and identity matrices, read as an array of vec4 values;
+ *   - BONE_INDICES and BONE_WEIGHTS exactly as GetShaderTransformAttributeData() fills them: four bone indices
+ *     (stored as floating point values and converted with int() by the shader) and four weights per vertex, with
+ *     unused slots referring to the all-zero matrix and vertices without bones referring to the identity matrix.
+ *
+ * The skinned positions and normals of random vertices (attached to zero to four bones of a skeleton with the
+ * maximum number of bones for GPU skinning) are compared against BlendBoneMatrices() and TransformByAffineMatrix(),
+ * the kernels used by the CPU path, and against a double precision reference. The program also checks that the
+ * palette for MaxGPUSkinningBones bones fits in MAX_SKINNING_PALETTE_SIZE as declared in skinning.inc.
+ *
+ * Build & run from the repository root:
+ *
+ *   g++ -std=c++11 -O2 -Isrc -o gpuskinningtest tests/gpuskinningtest.cpp \
+ *       src/graphics/render/skinnedmesh3Dattrtransformer.cpp src/graphics/render/attributetransformer.cpp \
+ *       src/graphics/animation/vertexbonemap.cpp src/graphics/animation/skeleton.cpp src/graphics/animation/bone.cpp \
+ *       src/graphics/animation/skeletonnode.cpp src/graphics/animation/skeletondefinition.cpp src/object/engineobject.cpp \
+ *       src/graphics/stdattributes.cpp src/geometry/transform.cpp src/geometry/matrix4x4.cpp src/geometry/quaternion.cpp \
+ *       src/geometry/point/point3.cpp src/geometry/vector/vector3.cpp src/gtemath/gtemath.cpp src/global/constants.cpp \
+ *       src/debug/gtedebug.cpp src/error/errormanager.cpp
+ *   ./gpuskinningtest
+ *
+ * The program exits with a non-zero status if any check fails.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+#include <string>
+#include <fstream>
+
+#include "engine.h"
+#include "graphics/render/skinnedmesh3Dattrtransformer.h"
+#include "graphics/render/skinnedmesh3Drenderer.h"
+#include "graphics/render/material.h"
+#include "geometry/matrix4x4.h"
+#include "util/workerpool.h"
+
+namespace GTE {
+    // SkinnedMesh3DAttributeTransformer only reports errors through the engine when it is used incorrectly, which
+    // this program never does, so the engine itself is not needed.
+    Engine * Engine::Instance() {
+        return nullptr;
+    }
+
+    ErrorManager * Engine::GetErrorManager() {
+        return nullptr;
+    }
+
+    // the remaining functions are referenced by SkinnedMesh3DAttributeTransformer::TransformAttributes() and
+    // SendShaderTransformUniforms(), which need a renderer and a graphics context and are never called here
+    WorkerPool * Engine::GetWorkerPool() {
+        return nullptr;
+    }
+
+    void WorkerPool::ParallelFor(UInt32 count, UInt32 chunkSize, const std::function<void(UInt32, UInt32)>& job) {
+        job(0, count);
+    }
+
+    void Material::SendSkinningPaletteToShader(const Real * palette, UInt32 boneCount) {
+    }
+
+    SkeletonRef SkinnedMesh3DRenderer::GetSkeleton() {
+        static SkeletonSharedPtr skeleton;
+        return skeleton;
+    }
+
+    SkinningMode SkinnedMesh3DRenderer::GetSkinningMode() const {
+        return SkinningMode::LinearBlend;
+    }
+
+    VertexBoneMap * SkinnedMesh3DRenderer::GetVertexBoneMap(UInt32 index) {
+        return nullptr;
+    }
+
+    Bool SkinnedMesh3DRenderer::ShouldSkinOnGPU(Int32 subMeshIndex) {
+        return false;
+    }
+}
+
+using namespace GTE;
+
+namespace {
+    // number of random vertices to skin
+    const UInt32 VertexCount = 20000;
+    // number of Real values in a 3x4 affine matrix
+    const UInt32 AffineMatrixSize = 12;
+    // maximum difference between the results, relative to the magnitude of the skinned position
+    const double Tolerance = 1e-5;
+
+    // small deterministic random number generator, so that the results are the same on every platform
+    UInt32 randomState = 12345;
+
+    double Random(double min, double max) {
+        randomState = randomState * 1664525u + 1013904223u;
+        return min + (max - min) * ((randomState >> 8) / (double)(1 << 24));
+    }
+
+    UInt32 RandomIndex(UInt32 count) {
+        randomState = randomState * 1664525u + 1013904223u;
+        return (randomState >> 8) % count;
+    }
+
+    struct vec4 {
+        float x, y, z, w;
+
+        vec4() : x(0), y(0), z(0), w(0) {}
+        vec4(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+
+        float operator[](int i) const {
+            return i == 0 ? x : (i == 1 ? y : (i == 2 ? z : w));
+        }
+    };
+
+    vec4 operator*(const vec4& v, float s) {
+        return vec4(v.x * s, v.y * s, v.z * s, v.w * s);
+    }
+
+    vec4& operator+=(vec4& a, const vec4& b) {
+        a.x += b.x; a.y += b.y; a.z += b.z; a.w += b.w;
+        return a;
+    }
+
+    float dot(const vec4& a, const vec4& b) {
+        return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+    }
+
+    float dot3(const vec4& a, const vec4& b) {
+        return a.x * b.x + a.y * b.y + a.z * b.z;
+    }
+
+    /*
+     * Emulation of the vertex shader code in skinning.inc, reading the uniform [SKINNING_PALETTE] and the vertex
+     * attributes [BONE_INDICES] and [BONE_WEIGHTS].
+     */
+    struct SkinningShader {
+        const vec4 * SKINNING_PALETTE;
+        vec4 BONE_INDICES;
+        vec4 BONE_WEIGHTS;
+
+        void getSkinningTransform(vec4& row0, vec4& row1, vec4& row2) const {
+            row0 = vec4(0, 0, 0, 0);
+            row1 = vec4(0, 0, 0, 0);
+            row2 = vec4(0, 0, 0, 0);
+
+            for (int i = 0; i < 4; i++) {
+                int base = int(BONE_INDICES[i]) * 3;
+                float weight = BONE_WEIGHTS[i];
+                row0 += SKINNING_PALETTE[base] * weight;
+                row1 += SKINNING_PALETTE[base + 1] * weight;
+                row2 += SKINNING_PALETTE[base + 2] * weight;
+            }
+        }
+
+        vec4 skinPosition(const vec4& row0, const vec4& row1, const vec4& row2, const vec4& position) const {
+            return vec4(dot(row0, position), dot(row1, position), dot(row2, position), position.w);
+        }
+
+        vec4 skinVector(const vec4& row0, const vec4& row1, const vec4& row2, const vec4& vector) const {
+            return vec4(dot3(row0, vector), dot3(row1, vector), dot3(row2, vector), vector.w);
+        }
+    };
+
+    // the value of MAX_SKINNING_PALETTE_SIZE in skinning.inc, or -1 if it cannot be read
+    Int32 ReadMaxPaletteSize(const char * path) {
+        std::ifstream file(path);
+        if (!file.is_open())return -1;
+
+        std::string line;
+        while (std::getline(file, line)) {
+            size_t pos = line.find("MAX_SKINNING_PALETTE_SIZE =");
+            if (pos != std::string::npos) {
+                return atoi(line.c_str() + pos + strlen("MAX_SKINNING_PALETTE_SIZE ="));
+            }
+        }
+
+        return -1;
+    }
+
+    double Difference(const Real * a, const Real * b) {
+        return fmax(fabs(a[0] - b[0]), fmax(fabs(a[1] - b[1]), fabs(a[2] - b[2])));
+    }
+
+    double Difference(const Real * a, const double * b) {
+        return fmax(fabs(a[0] - b[0]), fmax(fabs(a[1] - b[1]), fabs(a[2] - b[2])));
+    }
+}
+
+int main(int argc, char ** argv) {
+    UInt32 errors = 0;
+    const UInt32 boneCount = SkinnedMesh3DAttributeTransformer::MaxGPUSkinningBones;
+
+    // the palette must hold three vec4 values for each bone, plus the all-zero and identity matrices
+    Int32 maxPaletteSize = ReadMaxPaletteSize("resources/shaders/builtin/glsl/skinning.inc");
+    if (maxPaletteSize < 0) {
+        printf("could not read MAX_SKINNING_PALETTE_SIZE from resources/shaders/builtin/glsl/skinning.inc (run from the repository root)\n");
+        errors++;
+    }
+    else if ((UInt32)maxPaletteSize < (boneCount + 2) * 3) {
+        printf("MAX_SKINNING_PALETTE_SIZE (%d) is too small for %u bones (%u vec4 values needed)\n", maxPaletteSize, boneCount, (boneCount + 2) * 3);
+        errors++;
+    }
+
+    // random bone transformations (rotation, non-uniform scale, translation) stored the way TransformAttributes() does
+    std::vector<Real> boneMatrices((boneCount + 2) * AffineMatrixSize, 0.0f);
+    std::vector<Matrix4x4> bones(boneCount);
+    for (UInt32 b = 0; b < boneCount; b++) {
+        bones[b].SetRotateEuler((Real)Random(-180, 180), (Real)Random(-180, 180), (Real)Random(-180, 180));
+        bones[b].Scale((Real)Random(0.8, 1.2), (Real)Random(0.8, 1.2), (Real)Random(0.8, 1.2));
+        bones[b].PreTranslate((Real)Random(-2, 2), (Real)Random(-2, 2), (Real)Random(-2, 2));
+        SkinnedMesh3DAttributeTransformer::StoreAffineMatrix(bones[b], &boneMatrices[b * AffineMatrixSize]);
+    }
+    Matrix4x4 identity;
+    SkinnedMesh3DAttributeTransformer::StoreAffineMatrix(identity, &boneMatrices[(boneCount + 1) * AffineMatrixSize]);
+
+    // the uniform array as the shader sees it
+    std::vector<vec4> palette((boneCount + 2) * 3);
+    for (UInt32 i = 0; i < palette.size(); i++) {
+        palette[i] = vec4(boneMatrices[i * 4], boneMatrices[i * 4 + 1], boneMatrices[i * 4 + 2], boneMatrices[i * 4 + 3]);
+    }
+
+    UInt32 boneCountHistogram[5] = { 0, 0, 0, 0, 0 };
+    double maxShaderDifference = 0, maxReferenceDifference = 0;
+    UInt32 mismatches = 0;
+
+    for (UInt32 v = 0; v < VertexCount; v++) {
+        // zero to four distinct bones with weights that add up to one
+        UInt32 attachedCount = RandomIndex(5);
+        boneCountHistogram[attachedCount]++;
+
+        UInt32 attached[4];
+        Real attachedWeights[4];
+        Real weightSum = 0;
+        for (UInt32 b = 0; b < attachedCount; b++) {
+            Bool unique;
+            do {
+                attached[b] = RandomIndex(boneCount);
+                unique = true;
+                for (UInt32 o = 0; o < b; o++)unique = unique && attached[o] != attached[b];
+            } while (!unique);
+
+            attachedWeights[b] = (Real)Random(0.05, 1);
+            weightSum += attachedWeights[b];
+        }
+        for (UInt32 b = 0; b < attachedCount; b++)attachedWeights[b] /= weightSum;
+
+        // packed the way BuildPackedBoneStream() packs them
+        UInt32 indices[4];
+        Real weights[4];
+        for (UInt32 b = 0; b < 4; b++) {
+            indices[b] = b < attachedCount ? attached[b] : boneCount;
+            weights[b] = b < attachedCount ? attachedWeights[b] : 0.0f;
+        }
+        if (attachedCount == 0) {
+            indices[0] = boneCount + 1;
+            weights[0] = 1.0f;
+        }
+
+        Real position[4] = { (Real)Random(-1, 1), (Real)Random(-1, 1), (Real)Random(-1, 1), 1.0f };
+        Real normal[4] = { (Real)Random(-1, 1), (Real)Random(-1, 1), (Real)Random(-1, 1), 0.0f };
+
+        // CPU path
+        Real full[AffineMatrixSize];
+        Real cpuPosition[4], cpuNormal[4];
+        memcpy(cpuPosition, position, sizeof(position));
+        memcpy(cpuNormal, normal, sizeof(normal));
+        SkinnedMesh3DAttributeTransformer::BlendBoneMatrices(&boneMatrices[0], indices, weights, full);
+        SkinnedMesh3DAttributeTransformer::TransformByAffineMatrix(full, cpuPosition, cpuNormal, nullptr, nullptr);
+
+        // vertex shader, with the attributes as GetShaderTransformAttributeData() stores them
+        SkinningShader shader;
+        shader.SKINNING_PALETTE = &palette[0];
+        shader.BONE_INDICES = vec4((Real)indices[0], (Real)indices[1], (Real)indices[2], (Real)indices[3]);
+        shader.BONE_WEIGHTS = vec4(weights[0], weights[1], weights[2], weights[3]);
+
+        vec4 row0, row1, row2;
+        shader.getSkinningTransform(row0, row1, row2);
+        vec4 skinnedPosition = shader.skinPosition(row0, row1, row2, vec4(position[0], position[1], position[2], position[3]));
+        vec4 skinnedNormal = shader.skinVector(row0, row1, row2, vec4(normal[0], normal[1], normal[2], normal[3]));
+        Real gpuPosition[4] = { skinnedPosition.x, skinnedPosition.y, skinnedPosition.z, skinnedPosition.w };
+        Real gpuNormal[4] = { skinnedNormal.x, skinnedNormal.y, skinnedNormal.z, skinnedNormal.w };
+
+        // double precision reference: the weighted sum of each bone's transformation of the vertex
+        double referencePosition[3] = { 0, 0, 0 }, referenceNormal[3] = { 0, 0, 0 };
+        if (attachedCount == 0) {
+            for (UInt32 c = 0; c < 3; c++) {
+                referencePosition[c] = position[c];
+                referenceNormal[c] = normal[c];
+            }
+        }
+        for (UInt32 b = 0; b < attachedCount; b++) {
+            const Real * m = bones[attached[b]].GetConstDataPtr();
+            for (UInt32 r = 0; r < 3; r++) {
+                double p = 0, n = 0;
+                for (UInt32 c = 0; c < 4; c++) {
+                    p += (double)m[c * 4 + r] * position[c];
+                    n += (double)m[c * 4 + r] * normal[c];
+                }
+                referencePosition[r] += attachedWeights[b] * p;
+                referenceNormal[r] += attachedWeights[b] * n;
+            }
+        }
+
+        double scale = fmax(1.0, fmax(fabs(referencePosition[0]), fmax(fabs(referencePosition[1]), fabs(referencePosition[2]))));
+        double shaderDifference = fmax(Difference(cpuPosition, gpuPosition), Difference(cpuNormal, gpuNormal)) / scale;
+        double referenceDifference = fmax(Difference(cpuPosition, referencePosition), Difference(cpuNormal, referenceNormal)) / scale;
+        maxShaderDifference = fmax(maxShaderDifference, shaderDifference);
+        maxReferenceDifference = fmax(maxReferenceDifference, referenceDifference);
+
+        if (shaderDifference > Tolerance || referenceDifference > Tolerance || cpuPosition[3] != gpuPosition[3] || cpuNormal[3] != gpuNormal[3]) {
+            if (mismatches < 10) {
+                printf("  vertex %u (%u bones): CPU (%f, %f, %f), shader (%f, %f, %f), reference (%f, %f, %f)\n", v, attachedCount,
+                       cpuPosition[0], cpuPosition[1], cpuPosition[2], gpuPosition[0], gpuPosition[1], gpuPosition[2],
+                       referencePosition[0], referencePosition[1], referencePosition[2]);
+            }
+            mismatches++;
+        }
+    }
+
+    printf("%u vertices skinned by %u bones (%u/%u/%u/%u/%u with 0/1/2/3/4 bones), palette of %u vec4 values (limit %d)\n",
+           VertexCount, boneCount, boneCountHistogram[0], boneCountHistogram[1], boneCountHistogram[2], boneCountHistogram[3],
+           boneCountHistogram[4], (boneCount + 2) * 3, maxPaletteSize);
+    printf("  maximum relative difference, CPU vs shader:    %.3g\n", maxShaderDifference);
+    printf("  maximum relative difference, CPU vs reference: %.3g\n", maxReferenceDifference);
+    if (mismatches > 0) {
+        printf("  %u vertices are out of tolerance\n", mismatches);
+    }
+    errors += mismatches;
+
+    printf(errors == 0 ? "PASSED\n" : "FAILED\n");
+    return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,275 @@
+/*
+ * Standalone microbenchmark of the key frame lookup that AnimationPlayer performs for every node of every playing
+ * animation, each frame (AnimationPlayer::FindKeyFrameIndex()). It does not need a graphics context, so it can be
+ * run on a build machine without a GPU.
+ *
+ * A long clip (two minutes, with key frames at irregular intervals averaging 30 per second, as left by key frame
+ * reduction) is played back at 60Hz, and the key frames of every node's translation, rotation and scale tracks
+ * are looked up on every frame in three ways:
+ *
+ *   - cursor:        FindKeyFrameIndex() is passed the result of the previous lookup for the same track, as
+ *                    AnimationPlayer does with the key indices of AnimationInstance::FrameState.
+ *   - binary search: FindKeyFrameIndex() is passed an invalid cursor, so that it always falls back to its
+ *                    binary search.
+ *   - linear scan:   the scan from the first key frame that AnimationPlayer used before the cursors were added
+ *                    (timed on every tenth frame only, as it is much slower).
+ *
+ * All three must find the same key frame for every lookup. The average time per lookup is reported for each.
+ *
+ * Build & run from the repository root:
+ *
+ *   g++ -std=c++11 -O2 -Isrc -o keyframesearchbenchmark tests/keyframesearchbenchmark.cpp \
+ *       src/graphics/animation/animationplayer.cpp src/graphics/animation/animationinstance.cpp \
+ *       src/graphics/animation/animation.cpp src/graphics/animation/compressedanimation.cpp \
+ *       src/graphics/animation/keyframeset.cpp src/graphics/animation/keyframe.cpp \
+ *       src/graphics/animation/translationkeyframe.cpp src/graphics/animation/rotationkeyframe.cpp \
+ *       src/graphics/animation/scalekeyframe.cpp src/graphics/animation/blendop.cpp \
+ *       src/graphics/animation/crossfadeblendop.cpp src/graphics/animation/skeleton.cpp \
+ *       src/graphics/animation/skeletondefinition.cpp src/graphics/animation/skeletonnode.cpp \
+ *       src/graphics/animation/bone.cpp src/graphics/animation/vertexbonemap.cpp src/object/engineobject.cpp \
+ *       src/geometry/transform.cpp src/geometry/matrix4x4.cpp src/geometry/quaternion.cpp src/geometry/point/point3.cpp \
+ *       src/geometry/vector/vector3.cpp src/gtemath/gtemath.cpp src/global/constants.cpp src/debug/gtedebug.cpp \
+ *       src/error/errormanager.cpp
+ *   ./keyframesearchbenchmark
+ *
+ * The program exits with a non-zero status if the lookups disagree.
+ */
+
+#include <stdio.h>
+#include <chrono>
+#include <vector>
+
+#include "engine.h"
+#include "graphics/animation/animationplayer.h"
+#include "graphics/animation/animationmanager.h"
+#include "graphics/animation/skeleton.h"
+#include "graphics/animation/keyframeset.h"
+#include "graphics/animation/translationkeyframe.h"
+#include "graphics/animation/rotationkeyframe.h"
+#include "graphics/animation/scalekeyframe.h"
+#include "util/time.h"
+
+namespace GTE {
+    // AnimationPlayer and Skeleton instances are normally created by the real EngineObjectManager, which needs
+    // the whole engine. This stand-in (which both classes already befriend) only does the allocation, and gives
+    // access to the key frame lookup.
+    class EngineObjectManager {
+    public:
+
+        static SkeletonSharedPtr CreateSkeleton(UInt32 boneCount) {
+            return SkeletonSharedPtr(new(std::nothrow) Skeleton(boneCount), [](Skeleton * skeleton) {
+                delete skeleton;
+            });
+        }
+
+        static AnimationPlayer * CreateAnimationPlayer(SkeletonRef target) {
+            return new(std::nothrow) AnimationPlayer(target);
+        }
+
+        static void DestroyAnimationPlayer(AnimationPlayer * player) {
+            delete player;
+        }
+
+        static UInt32 FindKeyFrameIndex(const AnimationPlayer& player, const KeyFrameSet& keyFrames, TransformationCompnent component, Real progress, UInt32 cursor) {
+            AnimationPlayer::KeyFrameTrack track(keyFrames, nullptr, 0, component);
+            return player.FindKeyFrameIndex(track, progress, cursor);
+        }
+
+        static Real GetKeyFrameTime(const KeyFrameSet& keyFrames, TransformationCompnent component, UInt32 frameIndex) {
+            AnimationPlayer::KeyFrameTrack track(keyFrames, nullptr, 0, component);
+            return track.GetKeyFrameTime(frameIndex);
+        }
+
+        // referenced by AnimationPlayer, but never called by this program
+        AnimationInstanceSharedPtr CreateAnimationInstance(SkeletonSharedPtr target, AnimationSharedConstPtr animation);
+    };
+
+    AnimationInstanceSharedPtr EngineObjectManager::CreateAnimationInstance(SkeletonSharedPtr target, AnimationSharedConstPtr animation) {
+        return AnimationInstanceSharedPtr::Null();
+    }
+
+    // AnimationPlayer only uses the engine (and the animation manager and the frame time) when animations are
+    // added or played, which this program never does, so the engine itself is not needed.
+    Engine * Engine::Instance() {
+        return nullptr;
+    }
+
+    ErrorManager * Engine::GetErrorManager() {
+        return nullptr;
+    }
+
+    EngineObjectManager * Engine::GetEngineObjectManager() {
+        return nullptr;
+    }
+
+    AnimationManager * Engine::GetAnimationManager() {
+        return nullptr;
+    }
+
+    Bool AnimationManager::IsCompatible(SkeletonConstRef skeleton, AnimationConstRef animation) const {
+        return false;
+    }
+
+    Real Time::GetDeltaTime() {
+        return 0;
+    }
+}
+
+using namespace GTE;
+
+namespace {
+    // number of animated nodes
+    const UInt32 NodeCount = 60;
+    // length of the clip in seconds, and the average number of key frames per second of each track
+    const Real ClipDuration = 120.0f;
+    const Real KeyFramesPerSecond = 30.0f;
+    // rate at which the clip is sampled
+    const Real SampleRate = 60.0f;
+    // the linear scan is only timed on every n-th frame
+    const UInt32 LinearScanFrameInterval = 10;
+    const UInt32 InvalidCursor = 0xFFFFFFFF;
+
+    const TransformationCompnent Components[] = { TransformationCompnent::Translation, TransformationCompnent::Rotation, TransformationCompnent::Scale };
+
+    // small deterministic random number generator, so that the results are the same on every platform
+    UInt32 randomState = 12345;
+
+    double Random(double min, double max) {
+        randomState = randomState * 1664525u + 1013904223u;
+        return min + (max - min) * ((randomState >> 8) / (double)(1 << 24));
+    }
+
+    // key frame times from 0 to [ClipDuration], with intervals that vary between a fifth and twice the average
+    void BuildKeyFrameTimes(std::vector<Real>& times) {
+        times.clear();
+        Real averageInterval = 1.0f / KeyFramesPerSecond;
+        for (Real time = 0; time < ClipDuration; time += (Real)Random(averageInterval * 0.2, averageInterval * 1.8)) {
+            times.push_back(time);
+        }
+    }
+
+    void BuildKeyFrameSet(KeyFrameSet& keyFrames) {
+        std::vector<Real> times;
+
+        BuildKeyFrameTimes(times);
+        for (UInt32 i = 0; i < times.size(); i++) {
+            keyFrames.TranslationKeyFrames.push_back(TranslationKeyFrame(times[i] / ClipDuration, times[i], times[i], Vector3(0, 0, 0)));
+        }
+
+        BuildKeyFrameTimes(times);
+        for (UInt32 i = 0; i < times.size(); i++) {
+            keyFrames.RotationKeyFrames.push_back(RotationKeyFrame(times[i] / ClipDuration, times[i], times[i], Quaternion(0, 0, 0, 1)));
+        }
+
+        BuildKeyFrameTimes(times);
+        for (UInt32 i = 0; i < times.size(); i++) {
+            keyFrames.ScaleKeyFrames.push_back(ScaleKeyFrame(times[i] / ClipDuration, times[i], times[i], Vector3(1, 1, 1)));
+        }
+
+        keyFrames.Used = true;
+    }
+
+    UInt32 GetFrameCount(const KeyFrameSet& keyFrames, TransformationCompnent component) {
+        if (component == TransformationCompnent::Translation)return (UInt32)keyFrames.TranslationKeyFrames.size();
+        else if (component == TransformationCompnent::Rotation)return (UInt32)keyFrames.RotationKeyFrames.size();
+        else return (UInt32)keyFrames.ScaleKeyFrames.size();
+    }
+
+    // the lookup that AnimationPlayer used before the cursors were added
+    UInt32 FindKeyFrameIndexLinear(const KeyFrameSet& keyFrames, TransformationCompnent component, Real progress) {
+        UInt32 frameCount = GetFrameCount(keyFrames, component);
+        UInt32 f = 0;
+        for (; f < frameCount; f++) {
+            if (EngineObjectManager::GetKeyFrameTime(keyFrames, component, f) > progress || f == frameCount - 1)break;
+        }
+        return f;
+    }
+
+    double MicrosecondsSince(std::chrono::high_resolution_clock::time_point start) {
+        return std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+}
+
+int main(int argc, char ** argv) {
+    SkeletonSharedPtr skeleton = EngineObjectManager::CreateSkeleton(NodeCount);
+    AnimationPlayer * player = EngineObjectManager::CreateAnimationPlayer(skeleton);
+
+    std::vector<KeyFrameSet> keyFrameSets(NodeCount);
+    UInt32 totalKeyFrames = 0;
+    for (UInt32 n = 0; n < NodeCount; n++) {
+        BuildKeyFrameSet(keyFrameSets[n]);
+        for (UInt32 c = 0; c < 3; c++)totalKeyFrames += GetFrameCount(keyFrameSets[n], Components[c]);
+    }
+
+    // one cursor per track, as in AnimationInstance::FrameState
+    std::vector<UInt32> cursors(NodeCount * 3, 0);
+    std::vector<UInt32> cursorResults(NodeCount * 3);
+    std::vector<UInt32> binaryResults(NodeCount * 3);
+
+    UInt32 frameCount = (UInt32)(ClipDuration * SampleRate);
+    // play the clip a little more than once, so that playback wraps around to the beginning once
+    UInt32 sampleFrames = frameCount + frameCount / 10;
+
+    double cursorTime = 0, binaryTime = 0, linearTime = 0;
+    UInt64 lookups = 0, linearLookups = 0;
+    UInt32 mismatches = 0;
+    volatile UInt32 sink = 0;
+
+    for (UInt32 frame = 0; frame < sampleFrames; frame++) {
+        Real progress = (Real)(frame % frameCount) / SampleRate;
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (UInt32 n = 0; n < NodeCount; n++) {
+            for (UInt32 c = 0; c < 3; c++) {
+                UInt32& cursor = cursors[n * 3 + c];
+                cursor = EngineObjectManager::FindKeyFrameIndex(*player, keyFrameSets[n], Components[c], progress, cursor);
+                cursorResults[n * 3 + c] = cursor;
+            }
+        }
+        cursorTime += MicrosecondsSince(start);
+
+        start = std::chrono::high_resolution_clock::now();
+        for (UInt32 n = 0; n < NodeCount; n++) {
+            for (UInt32 c = 0; c < 3; c++) {
+                binaryResults[n * 3 + c] = EngineObjectManager::FindKeyFrameIndex(*player, keyFrameSets[n], Components[c], progress, InvalidCursor);
+            }
+        }
+        binaryTime += MicrosecondsSince(start);
+        lookups += NodeCount * 3;
+
+        for (UInt32 t = 0; t < NodeCount * 3; t++) {
+            if (cursorResults[t] != binaryResults[t])mismatches++;
+        }
+
+        if (frame % LinearScanFrameInterval == 0) {
+            start = std::chrono::high_resolution_clock::now();
+            for (UInt32 n = 0; n < NodeCount; n++) {
+                for (UInt32 c = 0; c < 3; c++) {
+                    UInt32 f = FindKeyFrameIndexLinear(keyFrameSets[n], Components[c], progress);
+                    if (f != cursorResults[n * 3 + c])mismatches++;
+                    sink = sink + f;
+                }
+            }
+            linearTime += MicrosecondsSince(start);
+            linearLookups += NodeCount * 3;
+        }
+    }
+
+    printf("%u nodes, %.0f second clip, %u key frames per track on average, sampled at %.0fHz (%u frames)\n",
+           NodeCount, ClipDuration, totalKeyFrames / (NodeCount * 3), SampleRate, sampleFrames);
+    printf("  cursor:        %7.1f ns per lookup, %7.3f ms per second of playback\n",
+           cursorTime * 1000.0 / lookups, cursorTime / 1000.0 / (sampleFrames / SampleRate));
+    printf("  binary search: %7.1f ns per lookup, %7.3f ms per second of playback\n",
+           binaryTime * 1000.0 / lookups, binaryTime / 1000.0 / (sampleFrames / SampleRate));
+    printf("  linear scan:   %7.1f ns per lookup, %7.3f ms per second of playback\n",
+           linearTime * 1000.0 / linearLookups, linearTime * 1000.0 / linearLookups * lookups / 1e6 / (sampleFrames / SampleRate));
+
+    if (mismatches > 0) {
+        printf("  %u lookups found different key frames\n", mismatches);
+    }
+
+    EngineObjectManager::DestroyAnimationPlayer(player);
+
+    printf(mismatches == 0 ? "PASSED\n" : "FAILED\n");
+    return mismatches == 0 ? 0 : 1;
+}
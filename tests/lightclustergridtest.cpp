@@ -0,0 +1,280 @@
+/*
+ * Standalone check of LightClusterGrid (the CPU light binning used by clustered forward lighting).
+ * It does not need a graphics context, so it can be run on a build machine without a GPU.
+ *
+ * Two things are verified:
+ *
+ *   - For randomly generated views and lights, the clusters that each light is binned into are compared
+ *     against a brute-force test of the light's sphere against every cluster of the grid. A light must not
+ *     be binned into a cluster whose view space bounding box it does not intersect, and it must be binned
+ *     into every cluster that contains a point (of a dense sampling of the cluster) that lies inside the light.
+ *
+ *   - At maximum capacity (the grid dimensions and index count in Constants, with every light touching every
+ *     cluster), the offset and count of each cluster still fit in the 16 bits each that ForwardRenderManager
+ *     packs them into (offset | count << 16), and every light index fits in the single byte it is stored in.
+ *
+ * Build & run from the repository root:
+ *
+ *   g++ -std=c++11 -Isrc -o lightclustergridtest tests/lightclustergridtest.cpp src/graphics/render/lightclustergrid.cpp \
+ *       src/geometry/point/point3.cpp src/geometry/vector/vector3.cpp src/geometry/matrix4x4.cpp src/geometry/quaternion.cpp \
+ *       src/gtemath/gtemath.cpp src/global/constants.cpp src/debug/gtedebug.cpp src/error/errormanager.cpp
+ *   ./lightclustergridtest
+ *
+ * The program exits with a non-zero status if any check fails.
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+
+#include "engine.h"
+#include "graphics/render/lightclustergrid.h"
+#include "geometry/point/point3.h"
+#include "global/constants.h"
+#include "gtemath/gtemath.h"
+
+namespace GTE {
+    // LightClusterGrid only reports errors through the engine when it is used incorrectly, which this program
+    // never does, so the engine itself is not needed.
+    Engine * Engine::Instance() {
+        return nullptr;
+    }
+
+    ErrorManager * Engine::GetErrorManager() {
+        return nullptr;
+    }
+}
+
+using namespace GTE;
+
+namespace {
+    // number of sample points along each axis of a cluster for the brute-force test
+    const UInt32 SamplesPerAxis = 4;
+    // relative tolerance for distances that are (nearly) equal to a light's radius, where the
+    // single precision results of the grid can legitimately differ from the brute-force test
+    const double RadiusTolerance = 1e-4;
+
+    // small deterministic random number generator, so that the results are the same on every platform
+    UInt32 randomState = 12345;
+
+    double Random(double min, double max) {
+        randomState = randomState * 1664525u + 1013904223u;
+        return min + (max - min) * ((randomState >> 8) / (double)(1 << 24));
+    }
+
+    struct View {
+        Real ScaleX;
+        Real ScaleY;
+        Real OffsetX;
+        Real OffsetY;
+        Real NearDepth;
+        Real FarDepth;
+    };
+
+    // view space coordinate at view depth [depth] of NDC coordinate [ndc] (mirrors the projection used by LightClusterGrid)
+    double NDCToViewCoord(double ndc, double scale, double offset, double depth) {
+        return (ndc - offset) * depth / scale;
+    }
+
+    double TileEdgeNDC(UInt32 edge, UInt32 tileCount) {
+        return ((double)edge / (double)tileCount) * 2.0 - 1.0;
+    }
+
+    // distance from [center] to the view space bounding box of cluster ([tileX], [tileY], [slice])
+    double DistanceToClusterBox(const LightClusterGrid& grid, const View& view, const Point3& center, UInt32 tileX, UInt32 tileY, UInt32 slice) {
+        double nearDepth = grid.GetSliceNearDepth(slice);
+        double farDepth = grid.GetSliceNearDepth(slice + 1);
+
+        double minNDCX = TileEdgeNDC(tileX, grid.GetTileCountX()), maxNDCX = TileEdgeNDC(tileX + 1, grid.GetTileCountX());
+        double minNDCY = TileEdgeNDC(tileY, grid.GetTileCountY()), maxNDCY = TileEdgeNDC(tileY + 1, grid.GetTileCountY());
+
+        double minX = fmin(NDCToViewCoord(minNDCX, view.ScaleX, view.OffsetX, nearDepth), NDCToViewCoord(minNDCX, view.ScaleX, view.OffsetX, farDepth));
+        double maxX = fmax(NDCToViewCoord(maxNDCX, view.ScaleX, view.OffsetX, nearDepth), NDCToViewCoord(maxNDCX, view.ScaleX, view.OffsetX, farDepth));
+        double minY = fmin(NDCToViewCoord(minNDCY, view.ScaleY, view.OffsetY, nearDepth), NDCToViewCoord(minNDCY, view.ScaleY, view.OffsetY, farDepth));
+        double maxY = fmax(NDCToViewCoord(maxNDCY, view.ScaleY, view.OffsetY, nearDepth), NDCToViewCoord(maxNDCY, view.ScaleY, view.OffsetY, farDepth));
+        double minZ = -farDepth, maxZ = -nearDepth;
+
+        double dx = center.x < minX ? minX - center.x : (center.x > maxX ? center.x - maxX : 0);
+        double dy = center.y < minY ? minY - center.y : (center.y > maxY ? center.y - maxY : 0);
+        double dz = center.z < minZ ? minZ - center.z : (center.z > maxZ ? center.z - maxZ : 0);
+
+        return sqrt(dx * dx + dy * dy + dz * dz);
+    }
+
+    // does any point of a regular sampling of cluster ([tileX], [tileY], [slice]) (including its corners) lie inside the light?
+    Bool ClusterSampleInsideLight(const LightClusterGrid& grid, const View& view, const Point3& center, double radius, UInt32 tileX, UInt32 tileY, UInt32 slice) {
+        double nearDepth = grid.GetSliceNearDepth(slice);
+        double farDepth = grid.GetSliceNearDepth(slice + 1);
+
+        double minNDCX = TileEdgeNDC(tileX, grid.GetTileCountX()), maxNDCX = TileEdgeNDC(tileX + 1, grid.GetTileCountX());
+        double minNDCY = TileEdgeNDC(tileY, grid.GetTileCountY()), maxNDCY = TileEdgeNDC(tileY + 1, grid.GetTileCountY());
+        double limit = radius * (1.0 - RadiusTolerance);
+
+        for (UInt32 sz = 0; sz < SamplesPerAxis; sz++) {
+            double depth = nearDepth + (farDepth - nearDepth) * sz / (SamplesPerAxis - 1);
+            for (UInt32 sy = 0; sy < SamplesPerAxis; sy++) {
+                double y = NDCToViewCoord(minNDCY + (maxNDCY - minNDCY) * sy / (SamplesPerAxis - 1), view.ScaleY, view.OffsetY, depth);
+                for (UInt32 sx = 0; sx < SamplesPerAxis; sx++) {
+                    double x = NDCToViewCoord(minNDCX + (maxNDCX - minNDCX) * sx / (SamplesPerAxis - 1), view.ScaleX, view.OffsetX, depth);
+
+                    double dx = x - center.x, dy = y - center.y, dz = -depth - center.z;
+                    if (dx * dx + dy * dy + dz * dz < limit * limit)return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
+    /*
+     * Bin [lightCount] random lights into a grid for [view], and compare the clusters of each light against
+     * the brute-force tests. Returns the number of mismatches.
+     */
+    UInt32 CheckAgainstBruteForce(const View& view, UInt32 lightCount) {
+        LightClusterGrid grid;
+        grid.Init(Constants::ClusterTileCountX, Constants::ClusterTileCountY, Constants::ClusterSliceCount, Constants::MaxClusterLightIndices);
+        grid.SetProjection(view.ScaleX, view.ScaleY, view.OffsetX, view.OffsetY, view.NearDepth, view.FarDepth);
+
+        std::vector<Point3> positions(lightCount);
+        std::vector<Real> radii(lightCount);
+
+        // lights are scattered around (and partly outside) the view frustum, including behind the camera
+        Real maxDepth = view.FarDepth * 1.1f;
+        for (UInt32 l = 0; l < lightCount; l++) {
+            Real depth = (Real)Random(-view.FarDepth * 0.05, maxDepth);
+            Real halfWidth = GTEMath::Max(depth, view.NearDepth) / view.ScaleX * 1.2f;
+            Real halfHeight = GTEMath::Max(depth, view.NearDepth) / view.ScaleY * 1.2f;
+            positions[l].Set((Real)Random(-halfWidth, halfWidth), (Real)Random(-halfHeight, halfHeight), -depth);
+            radii[l] = (Real)Random(view.FarDepth * 0.002, view.FarDepth * 0.03);
+        }
+
+        grid.Build(&positions[0], &radii[0], lightCount);
+        if (grid.HasOverflowed()) {
+            printf("  grid overflowed, the results cannot be compared\n");
+            return 1;
+        }
+
+        // clusters into which each light was binned
+        UInt32 clusterCount = grid.GetClusterCount();
+        std::vector<std::vector<UChar>> binned(lightCount, std::vector<UChar>(clusterCount, 0));
+        const UInt32 * lightIndices = grid.GetLightIndices();
+        for (UInt32 c = 0; c < clusterCount; c++) {
+            for (UInt32 i = 0; i < grid.GetClusterLightCount(c); i++) {
+                binned[lightIndices[grid.GetClusterLightOffset(c) + i]][c] = 1;
+            }
+        }
+
+        UInt32 errors = 0;
+        for (UInt32 l = 0; l < lightCount; l++) {
+            for (UInt32 s = 0; s < grid.GetSliceCount(); s++) {
+                for (UInt32 y = 0; y < grid.GetTileCountY(); y++) {
+                    for (UInt32 x = 0; x < grid.GetTileCountX(); x++) {
+                        UInt32 cluster = grid.GetClusterIndex(x, y, s);
+                        double distance = DistanceToClusterBox(grid, view, positions[l], x, y, s);
+
+                        if (binned[l][cluster]) {
+                            if (distance > radii[l] * (1.0 + RadiusTolerance)) {
+                                printf("  light %u is binned into cluster (%u, %u, %u), but does not touch its bounding box\n", l, x, y, s);
+                                errors++;
+                            }
+                        }
+                        else if (distance < radii[l] && ClusterSampleInsideLight(grid, view, positions[l], radii[l], x, y, s)) {
+                            printf("  light %u reaches cluster (%u, %u, %u), but is not binned into it\n", l, x, y, s);
+                            errors++;
+                        }
+                    }
+                }
+            }
+        }
+
+        return errors;
+    }
+
+    /*
+     * Fill a grid of the maximum size with the maximum number of lights, each of which touches every
+     * cluster, and check that the packed light lists and light indices fit. Returns the number of failures.
+     */
+    UInt32 CheckPackingAtCapacity() {
+        UInt32 errors = 0;
+
+        if (Constants::MaxClusterLightIndices > 0xFFFF) {
+            printf("  MaxClusterLightIndices (%u) does not fit in 16 bits\n", Constants::MaxClusterLightIndices);
+            errors++;
+        }
+
+        if (Constants::MaxClusteredLights > 256) {
+            printf("  MaxClusteredLights (%u) does not fit in a byte\n", Constants::MaxClusteredLights);
+            errors++;
+        }
+
+        LightClusterGrid grid;
+        grid.Init(Constants::ClusterTileCountX, Constants::ClusterTileCountY, Constants::ClusterSliceCount, Constants::MaxClusterLightIndices);
+        grid.SetProjection(1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 100.0f);
+
+        std::vector<Point3> positions(Constants::MaxClusteredLights);
+        std::vector<Real> radii(Constants::MaxClusteredLights, 1000.0f);
+        for (UInt32 l = 0; l < Constants::MaxClusteredLights; l++) {
+            positions[l].Set(0, 0, -50.0f);
+        }
+
+        grid.Build(&positions[0], &radii[0], Constants::MaxClusteredLights);
+
+        UInt32 clusterCount = grid.GetClusterCount();
+        if (Constants::MaxClusteredLights * clusterCount > Constants::MaxClusterLightIndices && !grid.HasOverflowed()) {
+            printf("  grid did not report an overflow\n");
+            errors++;
+        }
+
+        if (grid.GetLightIndexCount() > Constants::MaxClusterLightIndices) {
+            printf("  %u light indices exceed the maximum of %u\n", grid.GetLightIndexCount(), Constants::MaxClusterLightIndices);
+            errors++;
+        }
+
+        for (UInt32 c = 0; c < clusterCount; c++) {
+            UInt32 offset = grid.GetClusterLightOffset(c);
+            UInt32 count = grid.GetClusterLightCount(c);
+            UInt32 packed = offset | (count << 16);
+
+            if ((packed & 0xFFFF) != offset || (packed >> 16) != count || offset + count > grid.GetLightIndexCount()) {
+                printf("  cluster %u: offset %u and count %u do not survive packing\n", c, offset, count);
+                errors++;
+            }
+        }
+
+        const UInt32 * lightIndices = grid.GetLightIndices();
+        for (UInt32 i = 0; i < grid.GetLightIndexCount(); i++) {
+            if (lightIndices[i] >= Constants::MaxClusteredLights) {
+                printf("  light index %u at position %u is out of range\n", lightIndices[i], i);
+                errors++;
+                break;
+            }
+        }
+
+        return errors;
+    }
+}
+
+int main(int argc, char ** argv) {
+    UInt32 failures = 0;
+    Real scale = 1.0f / GTEMath::Tan(30.0f * Constants::DegreesToRads);
+
+    // a centered view, an off-center (e.g. jittered or split-screen) view, and a wide view with a long depth range
+    View views[] = {
+        { scale / (16.0f / 9.0f), scale, 0.0f, 0.0f, 0.1f, 100.0f },
+        { scale / (4.0f / 3.0f), scale, 0.3f, -0.2f, 0.5f, 200.0f },
+        { 0.5f, 0.9f, 0.0f, 0.05f, 1.0f, 5000.0f }
+    };
+
+    for (UInt32 v = 0; v < sizeof(views) / sizeof(views[0]); v++) {
+        UInt32 errors = CheckAgainstBruteForce(views[v], Constants::MaxClusteredLights);
+        printf("view %u: %u mismatches against brute force\n", v, errors);
+        failures += errors;
+    }
+
+    UInt32 packingErrors = CheckPackingAtCapacity();
+    printf("packing at capacity: %u failures\n", packingErrors);
+    failures += packingErrors;
+
+    printf(failures == 0 ? "PASSED\n" : "FAILED\n");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,261 @@
+/*
+ * Standalone microbenchmark of the Matrix4x4 kernels that have SIMD implementations (see gtemath/gtesimd.h):
+ * MultiplyMM(), MultiplyMV(), MultiplyMVBatch() and Invert().
+ *
+ * The instruction set is selected at compile time, so the scalar and SIMD kernels cannot be linked into the same
+ * program. Instead the benchmark is built once for each variant, and each build reports the throughput of every
+ * kernel (millions of calls per second, or millions of vectors per second for the batch transform) along with the
+ * variant it was built for. Compare the numbers of the builds against each other:
+ *
+ *   g++ -std=c++11 -O2 -Isrc -D_GTE_SIMD_Disabled -o matrix4x4benchmark_scalar tests/matrix4x4benchmark.cpp \
+ *       src/geometry/matrix4x4.cpp src/geometry/point/point3.cpp src/geometry/vector/vector3.cpp src/geometry/quaternion.cpp \
+ *       src/gtemath/gtemath.cpp src/global/constants.cpp src/debug/gtedebug.cpp src/error/errormanager.cpp
+ *   g++ -std=c++11 -O2 -Isrc -o matrix4x4benchmark_sse tests/matrix4x4benchmark.cpp (same sources)
+ *   g++ -std=c++11 -O2 -mavx -Isrc -o matrix4x4benchmark_avx tests/matrix4x4benchmark.cpp (same sources)
+ *   ./matrix4x4benchmark_scalar && ./matrix4x4benchmark_sse && ./matrix4x4benchmark_avx
+ *
+ * Every build also checks the results of its kernels against a double precision reference, so that a faster
+ * kernel cannot hide a wrong one. The program exits with a non-zero status if any result is out of tolerance.
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include <chrono>
+#include <vector>
+
+#include "engine.h"
+#include "geometry/matrix4x4.h"
+#include "gtemath/gtesimd.h"
+#include "global/global.h"
+
+namespace GTE {
+    // Matrix4x4 only reports errors through the engine when it is used incorrectly, which this program
+    // never does, so the engine itself is not needed.
+    Engine * Engine::Instance() {
+        return nullptr;
+    }
+
+    ErrorManager * Engine::GetErrorManager() {
+        return nullptr;
+    }
+}
+
+using namespace GTE;
+
+namespace {
+    // number of distinct matrices (and vectors) the kernels cycle through; small enough to stay in the L1/L2 cache
+    const UInt32 MatrixCount = 1024;
+    // number of vectors transformed by each call to MultiplyMVBatch()
+    const UInt32 BatchSize = 256;
+    // minimum duration of each timing
+    const double MinimumMilliseconds = 200.0;
+    // maximum relative differences from the double precision reference
+    const double ProductTolerance = 1e-5;
+    const double InverseTolerance = 1e-3;
+
+    // small deterministic random number generator, so that the results are the same on every platform
+    UInt32 randomState = 12345;
+
+    double Random(double min, double max) {
+        randomState = randomState * 1664525u + 1013904223u;
+        return min + (max - min) * ((randomState >> 8) / (double)(1 << 24));
+    }
+
+    // volatile sink that keeps the compiler from discarding the results of the timed loops
+    volatile Real sink;
+
+    const char * GetVariantName() {
+#if defined(_GTE_SIMD_AVX)
+        return "SSE + AVX";
+#elif defined(_GTE_SIMD_SSE)
+        return "SSE";
+#elif defined(_GTE_SIMD_NEON)
+        return "NEON";
+#else
+        return "scalar";
+#endif
+    }
+
+    // column-major product lhs * rhs in double precision
+    void ReferenceMultiplyMM(const Real * lhs, const Real * rhs, double * out) {
+        for (UInt32 c = 0; c < 4; c++) {
+            for (UInt32 r = 0; r < 4; r++) {
+                double sum = 0;
+                for (UInt32 k = 0; k < 4; k++)sum += (double)lhs[k * 4 + r] * rhs[c * 4 + k];
+                out[c * 4 + r] = sum;
+            }
+        }
+    }
+
+    // Gauss-Jordan inverse with partial pivoting in double precision
+    void ReferenceInvert(const Real * source, double * out) {
+        double m[4][8];
+        for (UInt32 r = 0; r < 4; r++) {
+            for (UInt32 c = 0; c < 4; c++) {
+                m[r][c] = source[c * 4 + r];
+                m[r][c + 4] = r == c ? 1.0 : 0.0;
+            }
+        }
+
+        for (UInt32 c = 0; c < 4; c++) {
+            UInt32 pivot = c;
+            for (UInt32 r = c + 1; r < 4; r++) {
+                if (fabs(m[r][c]) > fabs(m[pivot][c]))pivot = r;
+            }
+            for (UInt32 k = 0; k < 8; k++) {
+                double t = m[c][k]; m[c][k] = m[pivot][k]; m[pivot][k] = t;
+            }
+
+            double scale = 1.0 / m[c][c];
+            for (UInt32 k = 0; k < 8; k++)m[c][k] *= scale;
+            for (UInt32 r = 0; r < 4; r++) {
+                if (r == c)continue;
+                double factor = m[r][c];
+                for (UInt32 k = 0; k < 8; k++)m[r][k] -= factor * m[c][k];
+            }
+        }
+
+        for (UInt32 r = 0; r < 4; r++) {
+            for (UInt32 c = 0; c < 4; c++)out[c * 4 + r] = m[r][c + 4];
+        }
+    }
+
+    // largest difference between [values] and [reference], relative to the largest magnitude in [reference]
+    double RelativeError(const Real * values, const double * reference, UInt32 count) {
+        double maxMagnitude = 1e-30, maxDifference = 0;
+        for (UInt32 i = 0; i < count; i++) {
+            maxMagnitude = fmax(maxMagnitude, fabs(reference[i]));
+            maxDifference = fmax(maxDifference, fabs(values[i] - reference[i]));
+        }
+        return maxDifference / maxMagnitude;
+    }
+
+    /*
+     * Call [kernel] with a call index until at least MinimumMilliseconds have passed, and return the
+     * number of calls per second.
+     */
+    template <typename T> double MeasureThroughput(T kernel) {
+        UInt64 calls = 0;
+        auto start = std::chrono::high_resolution_clock::now();
+        double elapsed = 0;
+        while (elapsed < MinimumMilliseconds) {
+            for (UInt32 i = 0; i < 100000; i++) {
+                kernel((UInt32)(calls + i));
+            }
+            calls += 100000;
+            elapsed = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        }
+        return calls / (elapsed / 1000.0);
+    }
+}
+
+int main(int argc, char ** argv) {
+    // random affine transforms (rotation, scale, translation), as used for scene objects and bones, and a
+    // quarter of general (projective) matrices
+    std::vector<Real> matrices(MatrixCount * 16);
+    for (UInt32 m = 0; m < MatrixCount; m++) {
+        Real * data = &matrices[m * 16];
+        Matrix4x4::SetRotateEuler(data, (Real)Random(-180, 180), (Real)Random(-180, 180), (Real)Random(-180, 180));
+        Matrix4x4::Scale(data, data, (Real)Random(0.5, 2), (Real)Random(0.5, 2), (Real)Random(0.5, 2));
+        Matrix4x4::PreTranslate(data, data, (Real)Random(-10, 10), (Real)Random(-10, 10), (Real)Random(-10, 10));
+        if (m % 4 == 3) {
+            for (UInt32 r = 0; r < 3; r++)data[r * 4 + 3] = (Real)Random(-0.2, 0.2);
+        }
+    }
+
+    std::vector<Real> vectors((MatrixCount + BatchSize) * 4);
+    for (UInt32 i = 0; i < vectors.size(); i++) {
+        vectors[i] = (i % 4 == 3) ? 1.0f : (Real)Random(-10, 10);
+    }
+
+    std::vector<Real> results(MatrixCount * 16);
+    std::vector<Real> batchResults(BatchSize * 4);
+
+    // correctness against the double precision reference
+    UInt32 errors = 0;
+    double maxProductError = 0, maxVectorError = 0, maxBatchError = 0, maxInverseError = 0;
+    for (UInt32 m = 0; m < MatrixCount; m++) {
+        const Real * lhs = &matrices[m * 16];
+        const Real * rhs = &matrices[((m + 1) % MatrixCount) * 16];
+        double reference[16];
+
+        Real product[16];
+        Matrix4x4::MultiplyMM(lhs, rhs, product);
+        ReferenceMultiplyMM(lhs, rhs, reference);
+        maxProductError = fmax(maxProductError, RelativeError(product, reference, 16));
+
+        Real inverse[16];
+        Matrix4x4::Invert(lhs, inverse);
+        ReferenceInvert(lhs, reference);
+        maxInverseError = fmax(maxInverseError, RelativeError(inverse, reference, 16));
+
+        const Real * vector = &vectors[m * 4];
+        Real transformed[4];
+        double referenceVector[4];
+        Matrix4x4::MultiplyMV(lhs, vector, transformed);
+        for (UInt32 r = 0; r < 4; r++) {
+            referenceVector[r] = 0;
+            for (UInt32 k = 0; k < 4; k++)referenceVector[r] += (double)lhs[k * 4 + r] * vector[k];
+        }
+        maxVectorError = fmax(maxVectorError, RelativeError(transformed, referenceVector, 4));
+    }
+
+    Matrix4x4::MultiplyMVBatch(&matrices[0], &vectors[0], &batchResults[0], BatchSize);
+    for (UInt32 i = 0; i < BatchSize; i++) {
+        Real single[4];
+        Matrix4x4::MultiplyMV(&matrices[0], &vectors[i * 4], single);
+        double reference[4];
+        for (UInt32 r = 0; r < 4; r++)reference[r] = single[r];
+        maxBatchError = fmax(maxBatchError, RelativeError(&batchResults[i * 4], reference, 4));
+    }
+
+    if (maxProductError > ProductTolerance || maxVectorError > ProductTolerance || maxBatchError > ProductTolerance) {
+        printf("products are out of tolerance (MM %g, MV %g, batch %g)\n", maxProductError, maxVectorError, maxBatchError);
+        errors++;
+    }
+    if (maxInverseError > InverseTolerance) {
+        printf("inverses are out of tolerance (%g)\n", maxInverseError);
+        errors++;
+    }
+
+    printf("Matrix4x4 kernels (%s)\n", GetVariantName());
+    printf("  maximum relative error: MultiplyMM %.2g, MultiplyMV %.2g, MultiplyMVBatch %.2g, Invert %.2g\n",
+           maxProductError, maxVectorError, maxBatchError, maxInverseError);
+
+    const Real * matrixData = &matrices[0];
+    Real * resultData = &results[0];
+    const Real * vectorData = &vectors[0];
+
+    double multiplyMM = MeasureThroughput([=](UInt32 i) {
+        UInt32 m = i % MatrixCount;
+        Matrix4x4::MultiplyMM(matrixData + m * 16, matrixData + ((m + 1) % MatrixCount) * 16, resultData + m * 16);
+    });
+    sink = results[7];
+
+    double multiplyMV = MeasureThroughput([=](UInt32 i) {
+        UInt32 m = i % MatrixCount;
+        Matrix4x4::MultiplyMV(matrixData + m * 16, vectorData + m * 4, resultData + m * 4);
+    });
+    sink = results[3];
+
+    Real * batchData = &batchResults[0];
+    double multiplyMVBatch = MeasureThroughput([=](UInt32 i) {
+        UInt32 m = i % MatrixCount;
+        Matrix4x4::MultiplyMVBatch(matrixData + m * 16, vectorData + m * 4, batchData, BatchSize);
+    }) * BatchSize;
+    sink = batchResults[5];
+
+    double invert = MeasureThroughput([=](UInt32 i) {
+        UInt32 m = i % MatrixCount;
+        Matrix4x4::Invert(matrixData + m * 16, resultData + m * 16);
+    });
+    sink = results[11];
+
+    printf("  MultiplyMM:      %8.1f M calls/s\n", multiplyMM / 1e6);
+    printf("  MultiplyMV:      %8.1f M calls/s\n", multiplyMV / 1e6);
+    printf("  MultiplyMVBatch: %8.1f M vectors/s (batches of %u)\n", multiplyMVBatch / 1e6, BatchSize);
+    printf("  Invert:          %8.1f M calls/s\n", invert / 1e6);
+
+    printf(errors == 0 ? "PASSED\n" : "FAILED\n");
+    return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,189 @@
+/*
+ * Standalone check of RenderQueue::Sort() (the LSD radix sort of render queue entries by their packed sort keys).
+ *
+ * For a range of queue sizes and key distributions, the order in which GetObject() returns the entries after
+ * Sort() is compared against std::stable_sort of the same keys. This verifies that:
+ *
+ *   - the entries come out in ascending key order,
+ *   - entries with equal keys keep the order in which they were added (the sort is stable, so entries that share
+ *     all state and depth are still drawn in submission order),
+ *   - passes that are skipped because every key has the same digit (e.g. the bits that hold the queue ID) do not
+ *     change the result, including when every pass is skipped or the number of performed passes is odd,
+ *   - the order survives the queue growing past its initial capacity, and the queue can be cleared, refilled
+ *     and sorted again.
+ *
+ * Build & run from the repository root:
+ *
+ *   g++ -std=c++11 -O2 -Isrc -o renderqueuesorttest tests/renderqueuesorttest.cpp src/graphics/render/renderqueue.cpp \
+ *       src/gtemath/gtemath.cpp src/global/constants.cpp src/debug/gtedebug.cpp src/error/errormanager.cpp
+ *   ./renderqueuesorttest
+ *
+ * The program exits with a non-zero status if any check fails.
+ */
+
+#include <stdio.h>
+#include <algorithm>
+#include <vector>
+
+#include "engine.h"
+#include "graphics/render/renderqueue.h"
+#include "global/global.h"
+
+namespace GTE {
+    // RenderQueue only reports errors through the engine when it is used incorrectly, which this program
+    // never does, so the engine itself is not needed.
+    Engine * Engine::Instance() {
+        return nullptr;
+    }
+
+    ErrorManager * Engine::GetErrorManager() {
+        return nullptr;
+    }
+}
+
+using namespace GTE;
+
+namespace {
+    // small deterministic random number generator, so that the results are the same on every platform
+    UInt32 randomState = 12345;
+
+    UInt32 Random() {
+        randomState = randomState * 1664525u + 1013904223u;
+        return randomState >> 8;
+    }
+
+    UInt64 Random64() {
+        return ((UInt64)Random() << 48) ^ ((UInt64)Random() << 24) ^ (UInt64)Random();
+    }
+
+    /*
+     * Fill [queue] with [keys] (in order), sort it, and compare the resulting order with std::stable_sort.
+     * The material index of each entry is set to its insertion index so the entries can be identified
+     * after sorting. Returns the number of mismatches, after reporting the first one.
+     */
+    UInt32 CheckSort(RenderQueue& queue, const std::vector<UInt64>& keys, const char * description) {
+        queue.Clear();
+        for (UInt32 i = 0; i < keys.size(); i++) {
+            queue.Add(nullptr, nullptr, nullptr, nullptr, i, nullptr, nullptr);
+        }
+        for (UInt32 i = 0; i < keys.size(); i++) {
+            // before sorting GetObject() returns the entries in insertion order
+            queue.GetObject(i)->SortKey = keys[i];
+        }
+
+        queue.Sort();
+
+        std::vector<UInt32> expected(keys.size());
+        for (UInt32 i = 0; i < expected.size(); i++)expected[i] = i;
+        std::stable_sort(expected.begin(), expected.end(), [&keys](UInt32 a, UInt32 b) {
+            return keys[a] < keys[b];
+        });
+
+        if (queue.GetObjectCount() != keys.size()) {
+            printf("%s: queue holds %u entries, expected %u\n", description, queue.GetObjectCount(), (UInt32)keys.size());
+            return 1;
+        }
+
+        UInt32 mismatches = 0;
+        for (UInt32 i = 0; i < expected.size(); i++) {
+            UInt32 actual = queue.GetObject(i)->MaterialIndex;
+            if (actual != expected[i]) {
+                if (mismatches == 0) {
+                    printf("%s: position %u holds entry %u (key %016llx), expected entry %u (key %016llx)\n", description, i,
+                           actual, (unsigned long long)keys[actual], expected[i], (unsigned long long)keys[expected[i]]);
+                }
+                mismatches++;
+            }
+        }
+
+        return mismatches;
+    }
+}
+
+int main(int argc, char ** argv) {
+    UInt32 errors = 0;
+    UInt32 checks = 0;
+
+    // a small initial capacity, so that the larger cases grow the queue while it is being filled
+    RenderQueue queue(0, 16, 16);
+    std::vector<UInt64> keys;
+
+    const UInt32 sizes[] = { 0, 1, 2, 3, 17, 255, 256, 1000, 5000 };
+    for (UInt32 s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        UInt32 size = sizes[s];
+        char description[128];
+
+        // keys that differ in every digit
+        keys.resize(size);
+        for (UInt32 i = 0; i < size; i++)keys[i] = Random64();
+        snprintf(description, sizeof(description), "%u random keys", size);
+        errors += CheckSort(queue, keys, description) > 0 ? 1 : 0;
+        checks++;
+
+        // every key the same: all passes are skipped and the insertion order must be kept
+        for (UInt32 i = 0; i < size; i++)keys[i] = 0x0123456789abcdefull;
+        snprintf(description, sizeof(description), "%u identical keys", size);
+        errors += CheckSort(queue, keys, description) > 0 ? 1 : 0;
+        checks++;
+
+        // keys laid out like ForwardRenderManager::BuildSortKey() opaque keys: one queue, a handful of programs,
+        // texture sets and materials, so most entries share state and differ only in depth. Many keys repeat,
+        // which exercises stability.
+        for (UInt32 i = 0; i < size; i++) {
+            UInt64 queueID = 2000;
+            UInt64 program = Random() % 4;
+            UInt64 textureSet = Random() % 6;
+            UInt64 material = Random() % 9;
+            UInt64 depth = Random() % 64;
+            keys[i] = (queueID << 50) | (program << 40) | (textureSet << 28) | (material << 16) | depth;
+        }
+        snprintf(description, sizeof(description), "%u state/depth keys", size);
+        errors += CheckSort(queue, keys, description) > 0 ? 1 : 0;
+        checks++;
+
+        // keys that differ only in a single digit (one performed pass, so the result ends up in the scratch array),
+        // and in three digits (an odd number of performed passes spread across the key)
+        for (UInt32 i = 0; i < size; i++)keys[i] = 0xff00000000000000ull | ((UInt64)(Random() & 0xff) << 24);
+        snprintf(description, sizeof(description), "%u keys with one varying digit", size);
+        errors += CheckSort(queue, keys, description) > 0 ? 1 : 0;
+        checks++;
+
+        for (UInt32 i = 0; i < size; i++) {
+            keys[i] = ((UInt64)(Random() & 0x3) << 60) | ((UInt64)(Random() & 0xff) << 32) | (UInt64)(Random() & 0x7);
+        }
+        snprintf(description, sizeof(description), "%u keys with three varying digits", size);
+        errors += CheckSort(queue, keys, description) > 0 ? 1 : 0;
+        checks++;
+
+        // already sorted and reverse sorted keys
+        for (UInt32 i = 0; i < size; i++)keys[i] = (UInt64)i * 0x0001000100010001ull;
+        snprintf(description, sizeof(description), "%u ascending keys", size);
+        errors += CheckSort(queue, keys, description) > 0 ? 1 : 0;
+        checks++;
+
+        std::reverse(keys.begin(), keys.end());
+        snprintf(description, sizeof(description), "%u descending keys", size);
+        errors += CheckSort(queue, keys, description) > 0 ? 1 : 0;
+        checks++;
+    }
+
+    // sorting an already sorted queue again (without refilling it) must not change the order
+    keys.resize(300);
+    for (UInt32 i = 0; i < keys.size(); i++)keys[i] = Random() % 20;
+    errors += CheckSort(queue, keys, "re-sort, first pass") > 0 ? 1 : 0;
+    std::vector<RenderQueueEntry*> firstOrder;
+    for (UInt32 i = 0; i < queue.GetObjectCount(); i++)firstOrder.push_back(queue.GetObject(i));
+    queue.Sort();
+    for (UInt32 i = 0; i < queue.GetObjectCount(); i++) {
+        if (queue.GetObject(i) != firstOrder[i]) {
+            printf("re-sort: sorting a sorted queue changed the entry at position %u\n", i);
+            errors++;
+            break;
+        }
+    }
+    checks += 2;
+
+    printf("%u render queue sort checks\n", checks);
+    printf(errors == 0 ? "PASSED\n" : "FAILED\n");
+    return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,450 @@
+/*
+ * Standalone microbenchmark of the world matrix update performed by SceneTransformPool, compared against the
+ * pointer-chasing update that SceneObjectTransform performs when the pool is disabled.
+ *
+ * SceneObject cannot be linked into a standalone program (it pulls in the renderers, the scene manager and the
+ * engine object manager), so both update paths are reproduced here on top of the engine's own Matrix4x4 kernels:
+ *
+ *   - LinkedNode mirrors a SceneObject and its SceneObjectTransform: each node is a separate heap allocation of
+ *     the same size as a SceneObject, it caches its world matrix and inverse world matrix, changing its local
+ *     matrix invalidates the cached world matrices of the node and all its descendants (InvalidateWorldMatrix()),
+ *     and the world matrices are recalculated lazily by walking up the parent pointers (GetWorldMatrix()).
+ *
+ *   - TransformPool mirrors SceneTransformPool: the local, world and inverse world matrices of every node are
+ *     stored in contiguous arrays in breadth-first order, and UpdateWorldMatrices() is the same single linear pass.
+ *
+ * Each frame of the benchmark does what SceneManager does at the beginning of a scene update: the local matrices
+ * of the animated nodes are changed, then the hierarchy is walked (ProcessScene()) and the world matrix and
+ * inverse world matrix of every node are copied into its processing descriptor. The nodes are allocated in a
+ * shuffled order, so that (as in a scene that is built up over time) the memory order of the nodes does not
+ * match the order in which the hierarchy is walked. Timings are reported for a frame in which every node is
+ * animated and for a frame in which one node in ten is animated, along with the time of the pool's linear pass
+ * on its own. Both paths must produce the same world matrices.
+ *
+ * Build & run from the repository root:
+ *
+ *   g++ -std=c++11 -O2 -Isrc -o scenetransformpoolbenchmark tests/scenetransformpoolbenchmark.cpp \
+ *       src/geometry/matrix4x4.cpp src/geometry/point/point3.cpp src/geometry/vector/vector3.cpp src/geometry/quaternion.cpp \
+ *       src/gtemath/gtemath.cpp src/global/constants.cpp src/debug/gtedebug.cpp src/error/errormanager.cpp
+ *   ./scenetransformpoolbenchmark
+ *
+ * The program exits with a non-zero status if the two paths produce different world matrices.
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include <memory.h>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+
+#include "engine.h"
+#include "geometry/matrix4x4.h"
+#include "scene/sceneobject.h"
+#include "global/global.h"
+#include "gtemath/gtemath.h"
+
+namespace GTE {
+    // Matrix4x4 only reports errors through the engine when it is used incorrectly, which this program
+    // never does, so the engine itself is not needed.
+    Engine * Engine::Instance() {
+        return nullptr;
+    }
+
+    ErrorManager * Engine::GetErrorManager() {
+        return nullptr;
+    }
+}
+
+using namespace GTE;
+
+namespace {
+    // number of nodes in the benchmark hierarchy
+    const UInt32 NodeCount = 50000;
+    // number of frames over which each timing is averaged
+    const UInt32 FrameCount = 50;
+    // maximum relative difference between the world matrices calculated by the two paths
+    const double MatrixTolerance = 1e-4;
+    const Int32 InvalidHandle = -1;
+
+    // small deterministic random number generator, so that the results are the same on every platform
+    UInt32 randomState = 12345;
+
+    double Random(double min, double max) {
+        randomState = randomState * 1664525u + 1013904223u;
+        return min + (max - min) * ((randomState >> 8) / (double)(1 << 24));
+    }
+
+    UInt32 RandomIndex(UInt32 count) {
+        randomState = randomState * 1664525u + 1013904223u;
+        return (UInt32)(((UInt64)(randomState >> 8) * count) >> 24);
+    }
+
+    // the matrices that a scene object copies out of its transform in SceneManager::ProcessScene()
+    struct ProcessingDescriptor {
+        Matrix4x4 AggregateTransform;
+        Matrix4x4 AggregateTransformInverse;
+    };
+
+    /*
+     * Stand-in for a SceneObject and its SceneObjectTransform, with the same update logic as SceneObjectTransform.
+     */
+    class LinkedNode {
+    public:
+
+        ProcessingDescriptor processingDescriptor;
+        LinkedNode * parent;
+        std::vector<LinkedNode *> children;
+        Matrix4x4 matrix;
+        mutable Matrix4x4 worldMatrix;
+        mutable Matrix4x4 worldMatrixInverse;
+        mutable Bool worldMatrixDirty;
+        mutable Bool worldMatrixInverseDirty;
+
+        LinkedNode() {
+            parent = nullptr;
+            worldMatrixDirty = true;
+            worldMatrixInverseDirty = true;
+        }
+
+        void SetLocalMatrix(const Real * data) {
+            matrix.SetTo(data);
+            InvalidateWorldMatrix();
+        }
+
+        void InvalidateWorldMatrix() {
+            if (worldMatrixDirty)return;
+
+            worldMatrixDirty = true;
+            worldMatrixInverseDirty = true;
+
+            for (UInt32 i = 0; i < children.size(); i++) {
+                children[i]->InvalidateWorldMatrix();
+            }
+        }
+
+        const Matrix4x4& GetWorldMatrix() const {
+            if (worldMatrixDirty) {
+                if (parent != nullptr) {
+                    Matrix4x4::Multiply(parent->GetWorldMatrix(), matrix, worldMatrix);
+                }
+                else {
+                    worldMatrix.SetTo(matrix);
+                }
+
+                worldMatrixDirty = false;
+                worldMatrixInverseDirty = true;
+            }
+
+            return worldMatrix;
+        }
+
+        const Matrix4x4& GetWorldMatrixInverse() const {
+            const Matrix4x4& world = GetWorldMatrix();
+
+            if (worldMatrixInverseDirty) {
+                worldMatrixInverse.SetTo(world);
+                worldMatrixInverse.Invert();
+                worldMatrixInverseDirty = false;
+            }
+
+            return worldMatrixInverse;
+        }
+    };
+
+    // LinkedNode is padded to the size of a SceneObject, so that the same number of nodes occupies the same
+    // amount of memory (and is spread over as many cache lines) as the scene objects of a real scene
+    const UInt32 LinkedNodePadding = sizeof(SceneObject) > sizeof(LinkedNode) ? (UInt32)(sizeof(SceneObject) - sizeof(LinkedNode)) : 1;
+
+    class PaddedLinkedNode : public LinkedNode {
+    public:
+
+        UChar padding[LinkedNodePadding];
+    };
+
+    /*
+     * Stand-in for SceneTransformPool, with the same arrays and the same UpdateWorldMatrices() pass.
+     */
+    class TransformPool {
+    public:
+
+        static const UInt32 MatrixSize = 16;
+
+        std::vector<Real> localMatrices;
+        std::vector<Real> worldMatrices;
+        std::vector<Real> worldMatricesInverse;
+        std::vector<Int32> parentSlots;
+        std::vector<UChar> localDirty;
+        std::vector<UChar> worldUpdated;
+
+        void Build(const std::vector<Int32>& parents, const std::vector<Real>& locals) {
+            UInt32 slotCount = (UInt32)parents.size();
+            localMatrices = locals;
+            worldMatrices.resize(slotCount * MatrixSize);
+            worldMatricesInverse.resize(slotCount * MatrixSize);
+            parentSlots = parents;
+            localDirty.assign(slotCount, 1);
+            worldUpdated.assign(slotCount, 0);
+        }
+
+        void SetLocalMatrix(Int32 handle, const Real * data) {
+            memcpy(&localMatrices[handle * MatrixSize], data, sizeof(Real) * MatrixSize);
+            localDirty[handle] = 1;
+        }
+
+        void UpdateWorldMatrices() {
+            UInt32 slotCount = (UInt32)parentSlots.size();
+
+            for (UInt32 i = 0; i < slotCount; i++) {
+                Int32 parentSlot = parentSlots[i];
+                Bool parentUpdated = parentSlot != InvalidHandle && worldUpdated[parentSlot] != 0;
+
+                if (localDirty[i] || parentUpdated) {
+                    Real * world = &worldMatrices[i * MatrixSize];
+                    const Real * local = &localMatrices[i * MatrixSize];
+
+                    if (parentSlot != InvalidHandle) {
+                        Matrix4x4::MultiplyMM(&worldMatrices[parentSlot * MatrixSize], local, world);
+                    }
+                    else {
+                        memcpy(world, local, sizeof(Real) * MatrixSize);
+                    }
+
+                    Matrix4x4::Invert(world, &worldMatricesInverse[i * MatrixSize]);
+
+                    localDirty[i] = 0;
+                    worldUpdated[i] = 1;
+                }
+                else {
+                    worldUpdated[i] = 0;
+                }
+            }
+        }
+    };
+
+    // node of the pooled hierarchy, which is walked the same way as the linked hierarchy
+    struct PooledNode {
+        ProcessingDescriptor processingDescriptor;
+        Int32 handle;
+        std::vector<PooledNode *> children;
+    };
+
+    /*
+     * The benchmark hierarchy, in breadth-first order: [parents] holds the index of the parent of each node
+     * (which always precedes the node), or InvalidHandle for the root.
+     */
+    struct Hierarchy {
+        std::vector<Int32> parents;
+        std::vector<std::vector<UInt32>> children;
+        // local matrix of each node for even frames, odd frames, and the initial state
+        std::vector<Real> locals[3];
+    };
+
+    void BuildRandomLocal(Real * out, double jitter) {
+        Matrix4x4 m;
+        m.SetRotateEuler((Real)Random(-180, 180) * (Real)jitter, (Real)Random(-180, 180) * (Real)jitter, (Real)Random(-180, 180) * (Real)jitter);
+        m.PreTranslate((Real)Random(-2, 2), (Real)Random(-2, 2), (Real)Random(-2, 2));
+        m.Scale((Real)Random(0.95, 1.05), (Real)Random(0.95, 1.05), (Real)Random(0.95, 1.05));
+        memcpy(out, m.GetConstDataPtr(), sizeof(Real) * 16);
+    }
+
+    /*
+     * Generate a hierarchy resembling a game scene: a flat set of top level objects, each of which is the
+     * root of a subtree (props, characters with skeletons) of varying depth.
+     */
+    void BuildHierarchy(Hierarchy& hierarchy) {
+        std::vector<UInt32> depths(NodeCount, 0);
+        hierarchy.parents.resize(NodeCount);
+        hierarchy.children.resize(NodeCount);
+
+        hierarchy.parents[0] = InvalidHandle;
+        UInt32 subtreeRoot = 0;
+        for (UInt32 i = 1; i < NodeCount; i++) {
+            // start a new top level object roughly every 100 nodes
+            if (RandomIndex(100) == 0 || subtreeRoot == 0) {
+                subtreeRoot = i;
+                hierarchy.parents[i] = 0;
+            }
+            else {
+                // attach to a recent node of the current subtree, favouring the most recent ones to form chains
+                UInt32 range = i - subtreeRoot;
+                UInt32 back = GTEMath::Min(RandomIndex(4), range - 1);
+                hierarchy.parents[i] = (Int32)(i - 1 - back);
+            }
+
+            depths[i] = depths[hierarchy.parents[i]] + 1;
+            hierarchy.children[hierarchy.parents[i]].push_back(i);
+        }
+
+        for (UInt32 f = 0; f < 3; f++) {
+            hierarchy.locals[f].resize(NodeCount * 16);
+            for (UInt32 i = 0; i < NodeCount; i++) {
+                BuildRandomLocal(&hierarchy.locals[f][i * 16], 0.1);
+            }
+        }
+    }
+
+    /*
+     * Order the nodes of [hierarchy] breadth-first, as SceneTransformPool::Build() does. Since parents always
+     * precede their children in [hierarchy] and children are visited in order, slots are assigned so that the
+     * slot of each parent precedes the slots of its children.
+     */
+    void BuildBreadthFirstOrder(const Hierarchy& hierarchy, std::vector<UInt32>& order) {
+        order.clear();
+        order.push_back(0);
+        for (UInt32 i = 0; i < order.size(); i++) {
+            const std::vector<UInt32>& children = hierarchy.children[order[i]];
+            for (UInt32 c = 0; c < children.size(); c++) {
+                order.push_back(children[c]);
+            }
+        }
+    }
+
+    void ProcessLinked(LinkedNode& node) {
+        node.processingDescriptor.AggregateTransform.SetTo(node.GetWorldMatrix());
+        node.processingDescriptor.AggregateTransformInverse.SetTo(node.GetWorldMatrixInverse());
+
+        for (UInt32 i = 0; i < node.children.size(); i++) {
+            ProcessLinked(*node.children[i]);
+        }
+    }
+
+    void ProcessPooled(const TransformPool& pool, PooledNode& node) {
+        node.processingDescriptor.AggregateTransform.SetTo(&pool.worldMatrices[node.handle * TransformPool::MatrixSize]);
+        node.processingDescriptor.AggregateTransformInverse.SetTo(&pool.worldMatricesInverse[node.handle * TransformPool::MatrixSize]);
+
+        for (UInt32 i = 0; i < node.children.size(); i++) {
+            ProcessPooled(pool, *node.children[i]);
+        }
+    }
+
+    Bool MatricesMatch(const Real * a, const Real * b) {
+        for (UInt32 i = 0; i < 16; i++) {
+            double scale = fmax(1.0, fmax(fabs(a[i]), fabs(b[i])));
+            if (fabs(a[i] - b[i]) > MatrixTolerance * scale)return false;
+        }
+        return true;
+    }
+
+    double MillisecondsSince(std::chrono::high_resolution_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+}
+
+int main(int argc, char ** argv) {
+    Hierarchy hierarchy;
+    BuildHierarchy(hierarchy);
+
+    UInt32 maxDepth = 0;
+    for (UInt32 i = 1; i < NodeCount; i++) {
+        UInt32 depth = 0;
+        for (Int32 p = hierarchy.parents[i]; p != InvalidHandle; p = hierarchy.parents[p])depth++;
+        maxDepth = GTEMath::Max(maxDepth, depth);
+    }
+
+    // allocate the linked nodes in a shuffled order, with other allocations in between them
+    std::vector<UInt32> allocationOrder(NodeCount);
+    for (UInt32 i = 0; i < NodeCount; i++)allocationOrder[i] = i;
+    for (UInt32 i = NodeCount - 1; i > 0; i--)std::swap(allocationOrder[i], allocationOrder[RandomIndex(i + 1)]);
+
+    std::vector<PaddedLinkedNode *> linkedNodes(NodeCount, nullptr);
+    std::vector<UChar *> otherAllocations;
+    for (UInt32 i = 0; i < NodeCount; i++) {
+        linkedNodes[allocationOrder[i]] = new PaddedLinkedNode();
+        otherAllocations.push_back(new UChar[16 + RandomIndex(512)]);
+    }
+    for (UInt32 i = 0; i < NodeCount; i++) {
+        if (hierarchy.parents[i] != InvalidHandle)linkedNodes[i]->parent = linkedNodes[hierarchy.parents[i]];
+        for (UInt32 c = 0; c < hierarchy.children[i].size(); c++)linkedNodes[i]->children.push_back(linkedNodes[hierarchy.children[i][c]]);
+        linkedNodes[i]->matrix.SetTo(&hierarchy.locals[2][i * 16]);
+    }
+
+    // build the pool, and the scene objects that hold a handle into it
+    std::vector<UInt32> slotOrder;
+    BuildBreadthFirstOrder(hierarchy, slotOrder);
+    std::vector<Int32> slotOfNode(NodeCount);
+    for (UInt32 s = 0; s < NodeCount; s++)slotOfNode[slotOrder[s]] = (Int32)s;
+
+    std::vector<Int32> slotParents(NodeCount);
+    std::vector<Real> slotLocals(NodeCount * 16);
+    for (UInt32 s = 0; s < NodeCount; s++) {
+        Int32 parent = hierarchy.parents[slotOrder[s]];
+        slotParents[s] = parent == InvalidHandle ? InvalidHandle : slotOfNode[parent];
+        memcpy(&slotLocals[s * 16], &hierarchy.locals[2][slotOrder[s] * 16], sizeof(Real) * 16);
+    }
+
+    TransformPool pool;
+    pool.Build(slotParents, slotLocals);
+
+    std::vector<PooledNode *> pooledNodes(NodeCount, nullptr);
+    for (UInt32 i = 0; i < NodeCount; i++) {
+        pooledNodes[allocationOrder[i]] = new PooledNode();
+    }
+    for (UInt32 i = 0; i < NodeCount; i++) {
+        pooledNodes[i]->handle = slotOfNode[i];
+        for (UInt32 c = 0; c < hierarchy.children[i].size(); c++)pooledNodes[i]->children.push_back(pooledNodes[hierarchy.children[i][c]]);
+    }
+
+    // initial update of both paths
+    ProcessLinked(*linkedNodes[0]);
+    pool.UpdateWorldMatrices();
+    ProcessPooled(pool, *pooledNodes[0]);
+
+    printf("%u nodes, maximum depth %u, node size %u bytes\n", NodeCount, maxDepth, (UInt32)sizeof(PaddedLinkedNode));
+
+    const UInt32 animatedFractions[] = { 1, 10 };
+    UInt32 errors = 0;
+    for (UInt32 a = 0; a < 2; a++) {
+        UInt32 stride = animatedFractions[a];
+
+        double linkedTime = 0, pooledTime = 0, passTime = 0;
+        for (UInt32 frame = 0; frame < FrameCount; frame++) {
+            const std::vector<Real>& locals = hierarchy.locals[frame & 1];
+
+            auto start = std::chrono::high_resolution_clock::now();
+            for (UInt32 i = frame % stride; i < NodeCount; i += stride) {
+                linkedNodes[i]->SetLocalMatrix(&locals[i * 16]);
+            }
+            ProcessLinked(*linkedNodes[0]);
+            linkedTime += MillisecondsSince(start);
+
+            start = std::chrono::high_resolution_clock::now();
+            for (UInt32 i = frame % stride; i < NodeCount; i += stride) {
+                pool.SetLocalMatrix(pooledNodes[i]->handle, &locals[i * 16]);
+            }
+            auto passStart = std::chrono::high_resolution_clock::now();
+            pool.UpdateWorldMatrices();
+            passTime += MillisecondsSince(passStart);
+            ProcessPooled(pool, *pooledNodes[0]);
+            pooledTime += MillisecondsSince(start);
+        }
+
+        UInt32 mismatches = 0;
+        for (UInt32 i = 0; i < NodeCount; i++) {
+            const ProcessingDescriptor& linked = linkedNodes[i]->processingDescriptor;
+            const ProcessingDescriptor& pooled = pooledNodes[i]->processingDescriptor;
+            if (!MatricesMatch(linked.AggregateTransform.GetConstDataPtr(), pooled.AggregateTransform.GetConstDataPtr()) ||
+                !MatricesMatch(linked.AggregateTransformInverse.GetConstDataPtr(), pooled.AggregateTransformInverse.GetConstDataPtr())) {
+                mismatches++;
+            }
+        }
+
+        printf("1 in %u nodes animated:\n", stride);
+        printf("  pointer-chasing update + walk: %8.3f ms/frame\n", linkedTime / FrameCount);
+        printf("  transform pool update + walk:  %8.3f ms/frame (%.2fx)\n", pooledTime / FrameCount, linkedTime / pooledTime);
+        printf("  transform pool linear pass:    %8.3f ms/frame\n", passTime / FrameCount);
+        if (mismatches > 0) {
+            printf("  %u nodes have different world matrices\n", mismatches);
+        }
+        errors += mismatches;
+    }
+
+    for (UInt32 i = 0; i < NodeCount; i++) {
+        delete linkedNodes[i];
+        delete pooledNodes[i];
+        delete[] otherAllocations[i];
+    }
+
+    printf(errors == 0 ? "PASSED\n" : "FAILED\n");
+    return errors == 0 ? 0 : 1;
+}
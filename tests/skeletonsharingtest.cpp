@@ -0,0 +1,296 @@
+/*
+ * Standalone check of the copy-on-write sharing of skeleton data between a Skeleton and the instances created from
+ * it with Skeleton::CreateInstance() (SkeletonDefinition and SkeletonNodeDefinition).
+ *
+ * The following is verified:
+ *
+ *   - Instances share the skeleton's definition (bones, name mappings, hierarchy) and the definition of each node
+ *     (name and initial transformation), and only own their node objects, whose bone mapping points to the
+ *     instance's own nodes.
+ *
+ *   - Modifying an instance (a bone, or the initial transformation of a node) detaches only that instance (or node)
+ *     from the shared data; the source skeleton and all other instances keep the original values and keep sharing.
+ *
+ *   - Modifying the source skeleton after instances have been created (e.g. mapping another bone name) detaches the
+ *     source, and the instances keep the values they were created with.
+ *
+ *   - The shared data outlives the skeleton it was created for, so instances remain valid after it is destroyed.
+ *
+ * Build & run from the repository root:
+ *
+ *   g++ -std=c++11 -O2 -Isrc -o skeletonsharingtest tests/skeletonsharingtest.cpp \
+ *       src/graphics/animation/skeleton.cpp src/graphics/animation/skeletondefinition.cpp \
+ *       src/graphics/animation/skeletonnode.cpp src/graphics/animation/bone.cpp src/object/engineobject.cpp \
+ *       src/geometry/transform.cpp src/geometry/matrix4x4.cpp src/geometry/quaternion.cpp src/geometry/point/point3.cpp \
+ *       src/geometry/vector/vector3.cpp src/gtemath/gtemath.cpp src/global/constants.cpp src/debug/gtedebug.cpp \
+ *       src/error/errormanager.cpp
+ *   ./skeletonsharingtest
+ *
+ * The program exits with a non-zero status if any check fails.
+ */
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "engine.h"
+#include "graphics/animation/skeleton.h"
+#include "graphics/animation/skeletonnode.h"
+#include "graphics/animation/bone.h"
+#include "geometry/transform.h"
+#include "geometry/matrix4x4.h"
+#include "global/global.h"
+
+namespace GTE {
+    // Skeleton instances are normally created by the real EngineObjectManager, which needs the whole engine.
+    // This stand-in (which Skeleton already befriends) only does the allocation, and gives access to the
+    // definition that is shared between a skeleton and its instances.
+    class EngineObjectManager {
+    public:
+
+        static Skeleton * CreateSkeleton(UInt32 boneCount) {
+            return new(std::nothrow) Skeleton(boneCount);
+        }
+
+        static Skeleton * CreateInstance(Skeleton * skeleton) {
+            return skeleton->CreateInstance();
+        }
+
+        static void DestroySkeleton(Skeleton * skeleton) {
+            delete skeleton;
+        }
+
+        static const void * GetDefinition(const Skeleton * skeleton) {
+            return skeleton->definition.get();
+        }
+
+        static long GetDefinitionUseCount(const Skeleton * skeleton) {
+            return skeleton->definition.use_count();
+        }
+    };
+
+    // Skeleton only reports errors through the engine when it is used incorrectly, which this program
+    // never does, so the engine itself is not needed.
+    Engine * Engine::Instance() {
+        return nullptr;
+    }
+
+    ErrorManager * Engine::GetErrorManager() {
+        return nullptr;
+    }
+}
+
+using namespace GTE;
+
+namespace {
+    // number of nodes in the test skeleton; every node except the root has a bone
+    const UInt32 NodeCount = 24;
+    const UInt32 BoneCount = NodeCount - 1;
+    // number of instances created from the test skeleton
+    const UInt32 InstanceCount = 4;
+
+    /*
+     * The simplest possible SkeletonNode: it holds its target transformation itself, rather than pointing
+     * to a scene object like SceneObjectSkeletonNode.
+     */
+    class TestSkeletonNode : public SkeletonNode {
+        Transform transform;
+
+    protected:
+
+        TestSkeletonNode(const TestSkeletonNode& source) : SkeletonNode(source) {
+            transform.SetTo(source.transform);
+        }
+
+    public:
+
+        TestSkeletonNode(Int32 boneIndex, const std::string& name) : SkeletonNode(boneIndex, name) {
+        }
+
+        const Transform * GetFullTransform() const override {
+            return &transform;
+        }
+
+        Transform * GetLocalTransform() override {
+            return &transform;
+        }
+
+        Bool HasTarget() const override {
+            return true;
+        }
+
+        SkeletonNode * FullClone() const override {
+            return new(std::nothrow) TestSkeletonNode(*this);
+        }
+    };
+
+    UInt32 errors = 0;
+
+    void Check(Bool condition, const char * description) {
+        if (!condition) {
+            printf("check failed: %s\n", description);
+            errors++;
+        }
+    }
+
+    Bool MatricesEqual(const Matrix4x4& a, const Matrix4x4& b) {
+        for (UInt32 i = 0; i < 16; i++) {
+            if (a.GetConstDataPtr()[i] != b.GetConstDataPtr()[i])return false;
+        }
+        return true;
+    }
+
+    std::string GetNodeName(UInt32 node) {
+        return "node" + std::to_string(node);
+    }
+
+    std::string GetBoneName(UInt32 bone) {
+        return "bone" + std::to_string(bone);
+    }
+
+    /*
+     * Build a skeleton with a root node and a chain of [NodeCount] - 1 nodes, each with a bone, an initial
+     * transformation and an offset matrix.
+     */
+    Skeleton * BuildSkeleton() {
+        Skeleton * skeleton = EngineObjectManager::CreateSkeleton(BoneCount);
+        if (skeleton == nullptr || !skeleton->Init())return nullptr;
+
+        Tree<SkeletonNode*>::TreeNode * parent = nullptr;
+        for (UInt32 n = 0; n < NodeCount; n++) {
+            Int32 boneIndex = (Int32)n - 1;
+            std::string name = GetNodeName(n);
+            TestSkeletonNode * node = new(std::nothrow) TestSkeletonNode(boneIndex, name);
+
+            Matrix4x4 initialTransform;
+            initialTransform.Translate((Real)n, 1, 0);
+            node->SetInitialTransform(initialTransform);
+            node->GetLocalTransform()->SetTo(initialTransform);
+
+            parent = n == 0 ? skeleton->CreateRoot(node) : skeleton->AddChild(parent, node);
+            skeleton->MapNode(name, n);
+            skeleton->AddNodeToList(node);
+
+            if (boneIndex >= 0) {
+                Bone * bone = skeleton->GetBone(boneIndex);
+                bone->Name = GetBoneName(boneIndex);
+                bone->ID = boneIndex;
+                bone->OffsetMatrix.SetIdentity();
+                bone->OffsetMatrix.Translate(0, (Real)-boneIndex, 0);
+                bone->Node = node;
+                skeleton->MapBone(bone->Name, boneIndex);
+            }
+        }
+
+        return skeleton;
+    }
+}
+
+int main(int argc, char ** argv) {
+    Skeleton * source = BuildSkeleton();
+    if (source == nullptr) {
+        printf("could not build the test skeleton\n");
+        printf("FAILED\n");
+        return 1;
+    }
+
+    std::vector<Skeleton *> instances;
+    for (UInt32 i = 0; i < InstanceCount; i++) {
+        instances.push_back(EngineObjectManager::CreateInstance(source));
+        Check(instances[i] != nullptr, "CreateInstance() returns an instance");
+        if (instances[i] == nullptr) {
+            printf("FAILED\n");
+            return 1;
+        }
+    }
+
+    const Skeleton * constSource = source;
+    std::vector<Int32> sourceParents, instanceParents;
+    std::vector<UInt32> sourceDepths, instanceDepths;
+    source->GetNodeHierarchy(sourceParents, sourceDepths);
+
+    // instances share all immutable data with the source, and only own their nodes
+    Check(EngineObjectManager::GetDefinitionUseCount(source) == InstanceCount + 1, "the source and every instance share one definition");
+    for (UInt32 i = 0; i < InstanceCount; i++) {
+        Skeleton * instance = instances[i];
+        const Skeleton * constInstance = instance;
+
+        Check(EngineObjectManager::GetDefinition(instance) == EngineObjectManager::GetDefinition(source), "an instance uses the source's definition");
+        Check(instance->GetNodeCount() == NodeCount && instance->GetBoneCount() == BoneCount, "an instance has the source's node and bone counts");
+        Check(instance->GetBoneMapping(GetBoneName(3)) == 3 && instance->GetNodeMapping(GetNodeName(5)) == 5, "an instance has the source's name mappings");
+
+        instance->GetNodeHierarchy(instanceParents, instanceDepths);
+        Check(instanceParents == sourceParents && instanceDepths == sourceDepths, "an instance has the source's node hierarchy");
+
+        for (UInt32 n = 0; n < NodeCount; n++) {
+            SkeletonNode * sourceNode = source->GetNodeFromList(n);
+            SkeletonNode * instanceNode = instance->GetNodeFromList(n);
+            Check(instanceNode != sourceNode, "an instance owns its nodes");
+            Check(&instanceNode->GetName() == &sourceNode->GetName(), "an instance's node shares the name of the source node");
+            Check(&instanceNode->GetInitialTransform() == &sourceNode->GetInitialTransform(), "an instance's node shares the initial transformation of the source node");
+        }
+
+        for (UInt32 b = 0; b < BoneCount; b++) {
+            Check(constInstance->GetBone(b) == constSource->GetBone(b), "an instance shares the source's bones");
+            Check(instance->GetBoneNode(b) == instance->GetNodeFromList(b + 1), "an instance's bones map to the instance's own nodes");
+        }
+    }
+    Check(EngineObjectManager::GetDefinitionUseCount(source) == InstanceCount + 1, "read-only access does not copy the definition");
+
+    // modifying a bone of an instance detaches only that instance
+    Skeleton * modified = instances[0];
+    Bone * modifiedBone = modified->GetBone(2);
+    modifiedBone->OffsetMatrix.Translate(10, 0, 0);
+    Check(EngineObjectManager::GetDefinition(modified) != EngineObjectManager::GetDefinition(source), "modifying an instance's bone gives it its own definition");
+    Check(EngineObjectManager::GetDefinitionUseCount(source) == InstanceCount, "the other instances still share the source's definition");
+    Check(!MatricesEqual(constSource->GetBone(2)->OffsetMatrix, modifiedBone->OffsetMatrix), "modifying an instance's bone does not change the source's bone");
+    for (UInt32 i = 1; i < InstanceCount; i++) {
+        const Skeleton * other = instances[i];
+        Check(MatricesEqual(other->GetBone(2)->OffsetMatrix, constSource->GetBone(2)->OffsetMatrix), "modifying an instance's bone does not change other instances");
+    }
+    Check(modified->GetBoneMapping(GetBoneName(7)) == 7, "a detached instance keeps its name mappings");
+    Check(modified->GetBoneNode(2) == modified->GetNodeFromList(3), "a detached instance's bones still map to its own nodes");
+
+    // modifying the initial transformation of one node of an instance detaches only that node
+    SkeletonNode * modifiedNode = instances[1]->GetNodeFromList(4);
+    SkeletonNode * sourceNode = source->GetNodeFromList(4);
+    Matrix4x4 newInitialTransform;
+    newInitialTransform.Translate(0, 0, 42);
+    modifiedNode->SetInitialTransform(newInitialTransform);
+    Check(&modifiedNode->GetInitialTransform() != &sourceNode->GetInitialTransform(), "modifying an instance's node gives it its own node definition");
+    Check(MatricesEqual(modifiedNode->GetInitialTransform(), newInitialTransform), "the modified node has the new initial transformation");
+    Check(!MatricesEqual(sourceNode->GetInitialTransform(), newInitialTransform), "modifying an instance's node does not change the source node");
+    Check(modifiedNode->GetName() == sourceNode->GetName(), "a detached node keeps its name");
+    Check(&instances[2]->GetNodeFromList(4)->GetInitialTransform() == &sourceNode->GetInitialTransform(), "other instances' nodes still share the source node's definition");
+    Check(&instances[1]->GetNodeFromList(5)->GetInitialTransform() == &source->GetNodeFromList(5)->GetInitialTransform(), "the other nodes of the instance still share their definitions");
+    Check(EngineObjectManager::GetDefinition(instances[1]) == EngineObjectManager::GetDefinition(source), "modifying a node does not detach the skeleton definition");
+
+    // modifying the source after instances have been created detaches the source
+    source->MapBone("extra", 0);
+    Check(source->GetBoneMapping("extra") == 0, "the source sees its new mapping");
+    for (UInt32 i = 1; i < InstanceCount; i++) {
+        Check(instances[i]->GetBoneMapping("extra") == -1, "instances do not see mappings added to the source after they were created");
+        Check(EngineObjectManager::GetDefinition(instances[i]) == EngineObjectManager::GetDefinition(instances[1]), "the remaining instances still share one definition");
+    }
+    Check(EngineObjectManager::GetDefinitionUseCount(instances[1]) == InstanceCount - 1, "the source no longer shares the instances' definition");
+
+    // the shared data outlives the source skeleton
+    std::string expectedBoneName = GetBoneName(6);
+    std::string expectedNodeName = GetNodeName(6);
+    EngineObjectManager::DestroySkeleton(source);
+    source = nullptr;
+    for (UInt32 i = 1; i < InstanceCount; i++) {
+        const Skeleton * instance = instances[i];
+        Check(instance->GetBone(6)->Name == expectedBoneName, "an instance's bones survive the destruction of the source");
+        Check(instances[i]->GetNodeFromList(6)->GetName() == expectedNodeName, "an instance's node names survive the destruction of the source");
+        Check(instances[i]->GetNodeMapping(expectedNodeName) == 6, "an instance's name mappings survive the destruction of the source");
+    }
+
+    for (UInt32 i = 0; i < InstanceCount; i++) {
+        EngineObjectManager::DestroySkeleton(instances[i]);
+    }
+
+    printf("%u instances of a skeleton with %u nodes and %u bones\n", InstanceCount, NodeCount, BoneCount);
+    printf(errors == 0 ? "PASSED\n" : "FAILED\n");
+    return errors == 0 ? 0 : 1;
+}
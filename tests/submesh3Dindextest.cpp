@@ -0,0 +1,305 @@
+/*
+ * Standalone check of the index list of unique vertices that SubMesh3D builds (vertex welding). It does
+ * not need a graphics context, so it can be run on a build machine without a GPU.
+ *
+ * Random meshes are built from a small pool of vertex prototypes, so that many corners are identical and
+ * many others differ in exactly one attribute (position, vertex normal, tangent, color, either UV set, a
+ * custom attribute or the bone attachments). Every corner also gets a random face normal. The index list
+ * is then compared against a brute-force grouping of the corners: two corners must map to the same unique
+ * vertex if and only if all of their attributes except the face normal are bitwise identical. This is
+ * checked with the triangles in their original order, and again after they were reordered for the
+ * post-transform vertex cache.
+ *
+ * Build & run from the repository root:
+ *
+ *   g++ -std=c++11 -O2 -Isrc -o submesh3Dindextest tests/submesh3Dindextest.cpp \
+ *       src/graphics/object/submesh3D.cpp src/graphics/object/submesh3Dfaces.cpp src/graphics/object/submesh3Dface.cpp \
+ *       src/graphics/object/customfloatattributebuffer.cpp src/graphics/object/vertexcacheoptimizer.cpp \
+ *       src/object/engineobject.cpp src/geometry/point/point3.cpp src/geometry/vector/vector3.cpp \
+ *       src/graphics/color/color4.cpp src/graphics/uv/uv2.cpp src/graphics/stdattributes.cpp src/geometry/matrix4x4.cpp \
+ *       src/geometry/quaternion.cpp src/gtemath/gtemath.cpp src/global/constants.cpp src/debug/gtedebug.cpp src/error/errormanager.cpp
+ *   ./submesh3Dindextest
+ *
+ * The program exits with a non-zero status if any check fails.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "engine.h"
+#include "graphics/object/submesh3D.h"
+#include "graphics/object/customfloatattributebuffer.h"
+#include "graphics/stdattributes.h"
+#include "global/constants.h"
+
+namespace GTE {
+    // SubMesh3D instances are normally created and destroyed by the real EngineObjectManager, which needs
+    // the whole engine. This stand-in (which SubMesh3D already befriends) only does the allocation.
+    class EngineObjectManager {
+    public:
+
+        static SubMesh3D * CreateSubMesh3D(StandardAttributeSet attributes) {
+            return new(std::nothrow) SubMesh3D(attributes);
+        }
+
+        static void DestroySubMesh3D(SubMesh3D * mesh) {
+            delete mesh;
+        }
+    };
+
+    // SubMesh3D only reports errors through the engine when it is used incorrectly, which this program
+    // never does, so the engine itself is not needed.
+    Engine * Engine::Instance() {
+        return nullptr;
+    }
+
+    ErrorManager * Engine::GetErrorManager() {
+        return nullptr;
+    }
+}
+
+using namespace GTE;
+
+namespace {
+    // number of distinct base vertices, and the number of triangles built from them
+    const UInt32 BaseVertexCount = 60;
+    const UInt32 TriangleCount = 2000;
+    // components of the custom attribute, and the ID it is registered with
+    const UInt32 CustomComponentCount = 3;
+    const AttributeID CustomAttributeID = 1000;
+    // number of values of the bone attachments of each vertex (bone numbers, then weights)
+    const UInt32 BoneKeySize = Constants::MaxBonesPerVertex * 2;
+
+    // small deterministic random number generator, so that the results are the same on every platform
+    UInt32 randomState = 12345;
+
+    UInt32 RandomIndex(UInt32 count) {
+        randomState = randomState * 1664525u + 1013904223u;
+        return (randomState >> 8) % count;
+    }
+
+    Real Random() {
+        randomState = randomState * 1664525u + 1013904223u;
+        return (Real)((randomState >> 8) / (double)(1 << 24));
+    }
+
+    // the attributes of a single corner; the face normal is not part of it, since it is not compared
+    struct Corner {
+        Real Position[4];
+        Real Normal[4];
+        Real Tangent[4];
+        Real Color[4];
+        Real UV0[2];
+        Real UV1[2];
+        Real Custom[CustomComponentCount];
+        Real BoneKey[BoneKeySize];
+    };
+
+    void RandomValues(Real * values, UInt32 count) {
+        for (UInt32 i = 0; i < count; i++)values[i] = Random();
+    }
+
+    /*
+     * Build a random corner from the base vertices: usually an exact copy of one of them, otherwise a copy
+     * that differs in a single attribute.
+     */
+    Corner BuildCorner(const std::vector<Corner>& baseVertices, Bool skinned) {
+        Corner corner = baseVertices[RandomIndex((UInt32)baseVertices.size())];
+
+        UInt32 variation = RandomIndex(16);
+        if (variation == 0)RandomValues(corner.Position, 3);
+        else if (variation == 1)RandomValues(corner.Normal, 3);
+        else if (variation == 2)RandomValues(corner.Tangent, 3);
+        else if (variation == 3)RandomValues(corner.Color, 4);
+        else if (variation == 4)RandomValues(corner.UV0, 2);
+        else if (variation == 5)RandomValues(corner.UV1, 2);
+        else if (variation == 6)RandomValues(corner.Custom, CustomComponentCount);
+        else if (variation == 7 && skinned) {
+            // another bone with another weight, like a vertex on either side of a split in the skin
+            corner.BoneKey[1] = (Real)(RandomIndex(8) + 1);
+            corner.BoneKey[Constants::MaxBonesPerVertex + 1] = Random();
+        }
+
+        return corner;
+    }
+
+    void SetValues(Real * dest, const Real * src, UInt32 count) {
+        memcpy(dest, src, count * sizeof(Real));
+    }
+
+    /*
+     * Check that [mesh] maps two corners to the same unique vertex if and only if they are equal in [corners],
+     * where [cornerOrder] gives the index in [corners] of each corner of [mesh]. Returns the number of failures.
+     */
+    UInt32 CheckIndices(const char * name, SubMesh3D& mesh, const std::vector<Corner>& corners, const std::vector<UInt32>& cornerOrder) {
+        if (!mesh.HasIndices()) {
+            printf("  %s: no index list was built\n", name);
+            return 1;
+        }
+
+        const std::vector<UInt32>& indices = mesh.GetIndices();
+        const std::vector<UInt32>& sources = mesh.GetUniqueVertexSources();
+        UInt32 vertexCount = (UInt32)indices.size();
+
+        // brute-force grouping: the first corner that is equal to each corner
+        std::vector<UInt32> firstEqual(vertexCount);
+        UInt32 groupCount = 0;
+        for (UInt32 v = 0; v < vertexCount; v++) {
+            firstEqual[v] = v;
+            for (UInt32 w = 0; w < v; w++) {
+                if (memcmp(&corners[cornerOrder[v]], &corners[cornerOrder[w]], sizeof(Corner)) == 0) {
+                    firstEqual[v] = w;
+                    break;
+                }
+            }
+            if (firstEqual[v] == v)groupCount++;
+        }
+
+        UInt32 errors = 0;
+        if (sources.size() != groupCount) {
+            printf("  %s: %u unique vertices, but the corners form %u groups of equal vertices\n", name, (UInt32)sources.size(), groupCount);
+            errors++;
+        }
+
+        UInt32 mismatches = 0;
+        for (UInt32 v = 0; v < vertexCount; v++) {
+            // equal corners share a unique vertex, different corners do not
+            if (indices[v] != indices[firstEqual[v]])mismatches++;
+            else if (firstEqual[v] == v) {
+                for (UInt32 w = 0; w < v; w++) {
+                    if (firstEqual[w] == w && indices[w] == indices[v]) {
+                        mismatches++;
+                        break;
+                    }
+                }
+            }
+
+            // the source of each unique vertex must be one of its corners
+            if (indices[v] >= sources.size() || indices[sources[indices[v]]] != indices[v])mismatches++;
+        }
+
+        if (mismatches > 0) {
+            printf("  %s: %u corners are not mapped to the unique vertex of the corners they are equal to\n", name, mismatches);
+            errors++;
+        }
+
+        printf("  %s: %u corners -> %u unique vertices\n", name, vertexCount, (UInt32)sources.size());
+        return errors;
+    }
+
+    /*
+     * Build a random mesh, and check its index list before and after the triangles were reordered for
+     * the post-transform vertex cache. Returns the number of failures.
+     */
+    UInt32 CheckRandomMesh(const char * name, Bool skinned) {
+        std::vector<Corner> baseVertices(BaseVertexCount);
+        for (UInt32 i = 0; i < BaseVertexCount; i++) {
+            Corner& vertex = baseVertices[i];
+            memset(&vertex, 0, sizeof(Corner));
+            RandomValues(vertex.Position, 3);
+            RandomValues(vertex.Normal, 3);
+            RandomValues(vertex.Tangent, 3);
+            RandomValues(vertex.Color, 4);
+            RandomValues(vertex.UV0, 2);
+            RandomValues(vertex.UV1, 2);
+            RandomValues(vertex.Custom, CustomComponentCount);
+            if (skinned) {
+                vertex.BoneKey[0] = (Real)(RandomIndex(8) + 1);
+                vertex.BoneKey[Constants::MaxBonesPerVertex] = 1.0f;
+            }
+        }
+
+        UInt32 vertexCount = TriangleCount * 3;
+        std::vector<Corner> corners(vertexCount);
+        for (UInt32 v = 0; v < vertexCount; v++)corners[v] = BuildCorner(baseVertices, skinned);
+
+        StandardAttributeSet attributes = StandardAttributes::CreateAttributeSet();
+        StandardAttributes::AddAttribute(&attributes, StandardAttribute::Position);
+        StandardAttributes::AddAttribute(&attributes, StandardAttribute::Normal);
+        StandardAttributes::AddAttribute(&attributes, StandardAttribute::FaceNormal);
+        StandardAttributes::AddAttribute(&attributes, StandardAttribute::Tangent);
+        StandardAttributes::AddAttribute(&attributes, StandardAttribute::VertexColor);
+        StandardAttributes::AddAttribute(&attributes, StandardAttribute::UVTexture0);
+        StandardAttributes::AddAttribute(&attributes, StandardAttribute::UVTexture1);
+
+        SubMesh3D * mesh = EngineObjectManager::CreateSubMesh3D(attributes);
+        if (mesh == nullptr || !mesh->Init(vertexCount) || !mesh->AddCustomFloatAttributeBuffer(CustomComponentCount, CustomAttributeID)) {
+            printf("  %s: could not create the mesh\n", name);
+            return 1;
+        }
+
+        // the attributes are given, so nothing may be recalculated
+        mesh->SetCalculateNormals(false);
+        mesh->SetCalculateTangents(false);
+        mesh->SetBuildFaces(false);
+
+        CustomFloatAttributeBuffer * custom = mesh->GetCustomFloatAttributeBufferByID(CustomAttributeID);
+        std::vector<Real> boneKeys(vertexCount * BoneKeySize);
+        for (UInt32 v = 0; v < vertexCount; v++) {
+            const Corner& corner = corners[v];
+            SetValues(mesh->GetPositions().GetDataPtr() + v * 4, corner.Position, 4);
+            SetValues(mesh->GetVertexNormals().GetDataPtr() + v * 4, corner.Normal, 4);
+            SetValues(mesh->GetVertexTangents().GetDataPtr() + v * 4, corner.Tangent, 4);
+            SetValues(mesh->GetColors().GetDataPtr() + v * 4, corner.Color, 4);
+            SetValues(mesh->GetUVs0().GetDataPtr() + v * 2, corner.UV0, 2);
+            SetValues(mesh->GetUVs1().GetDataPtr() + v * 2, corner.UV1, 2);
+            SetValues(custom->GetDataPtr() + v * CustomComponentCount, corner.Custom, CustomComponentCount);
+            SetValues(boneKeys.data() + v * BoneKeySize, corner.BoneKey, BoneKeySize);
+
+            // face normals differ between all corners and must not prevent any of them from being merged
+            mesh->GetFaceNormals().GetElement(v)->Set(Random(), Random(), Random());
+        }
+        if (skinned)mesh->SetBoneAttachmentKeys(boneKeys, BoneKeySize);
+
+        UInt32 errors = 0;
+        std::vector<UInt32> cornerOrder(vertexCount);
+        for (UInt32 v = 0; v < vertexCount; v++)cornerOrder[v] = v;
+
+        mesh->SetBuildIndices(true);
+        mesh->Update();
+        std::string originalName = std::string(name) + ", original order";
+        errors += CheckIndices(originalName.c_str(), *mesh, corners, cornerOrder);
+
+        // rebuild the index list once more, this time with the triangles reordered
+        mesh->SetOptimizeVertexCache(true);
+        mesh->Update();
+        if (!mesh->IsVertexCacheOptimized()) {
+            printf("  %s: the triangles were not reordered\n", name);
+            errors++;
+        }
+        else {
+            const std::vector<UInt32>& triangleOrder = mesh->GetVertexCacheTriangleOrder();
+            for (UInt32 v = 0; v < vertexCount; v++)cornerOrder[v] = triangleOrder[v / 3] * 3 + v % 3;
+
+            // the reordered attribute arrays must hold the corners of the reordered triangles
+            UInt32 misplaced = 0;
+            for (UInt32 v = 0; v < vertexCount; v++) {
+                const Corner& corner = corners[cornerOrder[v]];
+                if (memcmp(mesh->GetPositions().GetConstDataPtr() + v * 4, corner.Position, 4 * sizeof(Real)) != 0 ||
+                    memcmp(mesh->GetUVs1().GetConstDataPtr() + v * 2, corner.UV1, 2 * sizeof(Real)) != 0 ||
+                    memcmp(custom->GetDataPtr() + v * CustomComponentCount, corner.Custom, CustomComponentCount * sizeof(Real)) != 0)misplaced++;
+            }
+            if (misplaced > 0) {
+                printf("  %s: %u corners were not moved along with their triangle\n", name, misplaced);
+                errors++;
+            }
+
+            std::string reorderedName = std::string(name) + ", reordered";
+            errors += CheckIndices(reorderedName.c_str(), *mesh, corners, cornerOrder);
+        }
+
+        EngineObjectManager::DestroySubMesh3D(mesh);
+        return errors;
+    }
+}
+
+int main(int argc, char ** argv) {
+    UInt32 failures = 0;
+
+    failures += CheckRandomMesh("static", false);
+    failures += CheckRandomMesh("skinned", true);
+
+    printf(failures == 0 ? "PASSED\n" : "FAILED\n");
+    return failures == 0 ? 0 : 1;
+}
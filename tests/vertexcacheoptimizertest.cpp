@@ -0,0 +1,284 @@
+/*
+ * Standalone check of the index building and post-transform vertex cache optimization that imported
+ * meshes go through (SubMesh3D::BuildIndices() and VertexCacheOptimizer). It does not need a graphics
+ * context, so it can be run on a build machine without a GPU.
+ *
+ * The test meshes are built the way ModelImporter builds them: a triangle soup with one entry per corner
+ * of each triangle, vertex normals and tangents calculated by SubMesh3D, and per-corner face normals.
+ * They are curved everywhere, so the corners of adjacent triangles share vertex normals but never face
+ * normals, like most real assets. Each mesh is checked with its triangles in scanline order (as written
+ * by a typical exporter) and in a random order (the worst case), and as a skinned mesh with bone
+ * attachments that change along one direction.
+ *
+ * For each case the program prints the unique vertex count and the ACMR/ATVR before and after the
+ * triangles were reordered, and verifies that:
+ *
+ *   - every grid vertex became exactly one unique vertex (the weld key does not include face normals),
+ *     and skinned vertices were only merged with vertices that have the same bone attachments,
+ *   - the reordered index list still describes the original triangles, with every attribute of
+ *     every corner equal to that of the unique vertex it maps to,
+ *   - the ACMR after the reordering is lower than before, and close to the ~0.6-0.7 that a regular mesh
+ *     can reach with a 16 entry FIFO cache.
+ *
+ * Build & run from the repository root:
+ *
+ *   g++ -std=c++11 -O2 -Isrc -o vertexcacheoptimizertest tests/vertexcacheoptimizertest.cpp \
+ *       src/graphics/object/submesh3D.cpp src/graphics/object/submesh3Dfaces.cpp src/graphics/object/submesh3Dface.cpp \
+ *       src/graphics/object/customfloatattributebuffer.cpp src/graphics/object/vertexcacheoptimizer.cpp \
+ *       src/object/engineobject.cpp src/geometry/point/point3.cpp src/geometry/vector/vector3.cpp \
+ *       src/graphics/color/color4.cpp src/graphics/uv/uv2.cpp src/graphics/stdattributes.cpp src/geometry/matrix4x4.cpp \
+ *       src/geometry/quaternion.cpp src/gtemath/gtemath.cpp src/global/constants.cpp src/debug/gtedebug.cpp src/error/errormanager.cpp
+ *   ./vertexcacheoptimizertest
+ *
+ * The program exits with a non-zero status if any check fails.
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include <string.h>
+#include <vector>
+#include <algorithm>
+
+#include "engine.h"
+#include "graphics/object/submesh3D.h"
+#include "graphics/object/vertexcacheoptimizer.h"
+#include "graphics/stdattributes.h"
+#include "geometry/point/point3.h"
+#include "geometry/vector/vector3.h"
+#include "graphics/uv/uv2.h"
+#include "global/constants.h"
+
+namespace GTE {
+    // SubMesh3D instances are normally created and destroyed by the real EngineObjectManager, which needs
+    // the whole engine. This stand-in (which SubMesh3D already befriends) only does the allocation.
+    class EngineObjectManager {
+    public:
+
+        static SubMesh3D * CreateSubMesh3D(StandardAttributeSet attributes) {
+            return new(std::nothrow) SubMesh3D(attributes);
+        }
+
+        static void DestroySubMesh3D(SubMesh3D * mesh) {
+            delete mesh;
+        }
+    };
+
+    // SubMesh3D only reports errors through the engine when it is used incorrectly, which this program
+    // never does, so the engine itself is not needed.
+    Engine * Engine::Instance() {
+        return nullptr;
+    }
+
+    ErrorManager * Engine::GetErrorManager() {
+        return nullptr;
+    }
+}
+
+using namespace GTE;
+
+namespace {
+    // tessellation of the torus: segments around the ring and around the tube
+    const UInt32 RingSegments = 96;
+    const UInt32 TubeSegments = 48;
+    const Real RingRadius = 2.0f;
+    const Real TubeRadius = 0.6f;
+    // number of rings of segments that are attached to the same bones in the skinned case
+    const UInt32 SegmentsPerBone = 8;
+    // highest ACMR that the reordered triangles of the regular test mesh may have
+    const Real MaxOptimizedACMR = 0.75f;
+
+    // small deterministic random number generator, so that the results are the same on every platform
+    UInt32 randomState = 12345;
+
+    UInt32 RandomIndex(UInt32 count) {
+        randomState = randomState * 1664525u + 1013904223u;
+        return (randomState >> 8) % count;
+    }
+
+    // grid vertex ([u], [v]) of the torus; the seam columns and rows are separate vertices with the same position
+    struct GridVertex {
+        UInt32 U;
+        UInt32 V;
+    };
+
+    void GetGridPosition(const GridVertex& vertex, Real& x, Real& y, Real& z) {
+        // positions of the seam vertices are calculated from the wrapped coordinates, so they are bitwise identical
+        Real ringAngle = (Real)(vertex.U % RingSegments) / (Real)RingSegments * 2.0f * Constants::PI;
+        Real tubeAngle = (Real)(vertex.V % TubeSegments) / (Real)TubeSegments * 2.0f * Constants::PI;
+        Real distance = RingRadius + TubeRadius * cosf(tubeAngle);
+
+        x = distance * cosf(ringAngle);
+        y = TubeRadius * sinf(tubeAngle);
+        z = distance * sinf(ringAngle);
+    }
+
+    // the bone attachments of the grid vertex, as ModelImporter stores them (bone numbers, then weights)
+    void GetBoneKey(const GridVertex& vertex, Real * key) {
+        UInt32 segment = vertex.U % RingSegments;
+        UInt32 bone = segment / SegmentsPerBone;
+        UInt32 boneCount = RingSegments / SegmentsPerBone;
+        Real blend = (Real)(segment % SegmentsPerBone) / (Real)SegmentsPerBone;
+
+        for (UInt32 i = 0; i < Constants::MaxBonesPerVertex * 2; i++)key[i] = 0;
+        key[0] = (Real)(bone + 1);
+        key[1] = (Real)((bone + 1) % boneCount + 1);
+        key[Constants::MaxBonesPerVertex] = 1.0f - blend;
+        key[Constants::MaxBonesPerVertex + 1] = blend;
+    }
+
+    /*
+     * Get the corners of the triangles of the torus, in scanline order or in a random order.
+     */
+    std::vector<GridVertex> BuildTriangles(Bool shuffle) {
+        std::vector<GridVertex> corners;
+        for (UInt32 v = 0; v < TubeSegments; v++) {
+            for (UInt32 u = 0; u < RingSegments; u++) {
+                GridVertex a = { u, v }, b = { u + 1, v }, c = { u + 1, v + 1 }, d = { u, v + 1 };
+                GridVertex quad[] = { a, c, b, a, d, c };
+                corners.insert(corners.end(), quad, quad + 6);
+            }
+        }
+
+        if (shuffle) {
+            UInt32 triangleCount = (UInt32)corners.size() / 3;
+            for (UInt32 t = triangleCount - 1; t > 0; t--) {
+                UInt32 other = RandomIndex(t + 1);
+                for (UInt32 c = 0; c < 3; c++)std::swap(corners[t * 3 + c], corners[other * 3 + c]);
+            }
+        }
+
+        return corners;
+    }
+
+    Bool AreEqual(const Real * a, const Real * b, UInt32 count) {
+        return memcmp(a, b, count * sizeof(Real)) == 0;
+    }
+
+    /*
+     * Build a sub-mesh from [corners] the way ModelImporter does, then check its index list and the
+     * triangle reordering. Returns the number of failures.
+     */
+    UInt32 CheckMesh(const char * name, const std::vector<GridVertex>& corners, Bool skinned) {
+        UInt32 errors = 0;
+        UInt32 vertexCount = (UInt32)corners.size();
+        const UInt32 keySize = Constants::MaxBonesPerVertex * 2;
+
+        StandardAttributeSet attributes = StandardAttributes::CreateAttributeSet();
+        StandardAttributes::AddAttribute(&attributes, StandardAttribute::Position);
+        StandardAttributes::AddAttribute(&attributes, StandardAttribute::UVTexture0);
+        StandardAttributes::AddAttribute(&attributes, StandardAttribute::Normal);
+        StandardAttributes::AddAttribute(&attributes, StandardAttribute::Tangent);
+        StandardAttributes::AddAttribute(&attributes, StandardAttribute::FaceNormal);
+
+        SubMesh3D * mesh = EngineObjectManager::CreateSubMesh3D(attributes);
+        if (mesh == nullptr || !mesh->Init(vertexCount)) {
+            printf("  %s: could not create the mesh\n", name);
+            return 1;
+        }
+
+        std::vector<Real> boneKeys;
+        if (skinned)boneKeys.resize(vertexCount * keySize);
+
+        for (UInt32 i = 0; i < vertexCount; i++) {
+            Real x, y, z;
+            GetGridPosition(corners[i], x, y, z);
+            mesh->GetPositions().GetElement(i)->Set(x, y, z);
+            mesh->GetUVs0().GetElement(i)->Set((Real)corners[i].U / (Real)RingSegments, (Real)corners[i].V / (Real)TubeSegments);
+            if (skinned)GetBoneKey(corners[i], boneKeys.data() + i * keySize);
+        }
+
+        // keep copies of the original corners, the arrays of the mesh are reordered
+        std::vector<Real> originalPositions(mesh->GetPositions().GetConstDataPtr(), mesh->GetPositions().GetConstDataPtr() + vertexCount * 4);
+
+        mesh->SetNormalsSmoothingThreshold(80);
+        if (skinned)mesh->SetBoneAttachmentKeys(boneKeys, keySize);
+        mesh->SetBuildIndices(true);
+        mesh->SetOptimizeVertexCache(true);
+        mesh->Update();
+
+        if (!mesh->HasIndices() || !mesh->IsVertexCacheOptimized()) {
+            printf("  %s: no index list was built, or it was not optimized\n", name);
+            EngineObjectManager::DestroySubMesh3D(mesh);
+            return 1;
+        }
+
+        const std::vector<UInt32>& indices = mesh->GetIndices();
+        const std::vector<UInt32>& sources = mesh->GetUniqueVertexSources();
+        const std::vector<UInt32>& triangleOrder = mesh->GetVertexCacheTriangleOrder();
+        const VertexCacheStatistics& original = mesh->GetOriginalVertexCacheStatistics();
+        const VertexCacheStatistics& optimized = mesh->GetOptimizedVertexCacheStatistics();
+
+        // every grid vertex (including the separate seam vertices) must be a single unique vertex. in the skinned
+        // case the bone attachments follow the grid vertices, so they must not split them any further.
+        UInt32 expectedUniqueVertexCount = (RingSegments + 1) * (TubeSegments + 1);
+        printf("  %s: %u corners -> %u unique vertices, ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n", name, vertexCount, mesh->GetUniqueVertexCount(),
+               original.ACMR, optimized.ACMR, original.ATVR, optimized.ATVR);
+
+        if (mesh->GetUniqueVertexCount() != expectedUniqueVertexCount) {
+            printf("  %s: expected %u unique vertices\n", name, expectedUniqueVertexCount);
+            errors++;
+        }
+
+        // the reordered triangles must be a permutation of the original ones
+        std::vector<UChar> used(vertexCount / 3, 0);
+        Bool validOrder = triangleOrder.size() == vertexCount / 3;
+        for (UInt32 t = 0; validOrder && t < triangleOrder.size(); t++) {
+            if (triangleOrder[t] >= used.size() || used[triangleOrder[t]])validOrder = false;
+            else used[triangleOrder[t]] = 1;
+        }
+        if (!validOrder) {
+            printf("  %s: the triangle order is not a permutation of the original triangles\n", name);
+            EngineObjectManager::DestroySubMesh3D(mesh);
+            return errors + 1;
+        }
+
+        const Real * positions = mesh->GetPositions().GetConstDataPtr();
+        const Real * normals = mesh->GetVertexNormals().GetConstDataPtr();
+        const Real * tangents = mesh->GetVertexTangents().GetConstDataPtr();
+        const Real * uvs = mesh->GetUVs0().GetConstDataPtr();
+        UInt32 mismatches = 0;
+        for (UInt32 v = 0; v < vertexCount; v++) {
+            UInt32 originalCorner = triangleOrder[v / 3] * 3 + v % 3;
+            UInt32 source = sources[indices[v]];
+
+            if (!AreEqual(positions + v * 4, originalPositions.data() + originalCorner * 4, 3))mismatches++;
+            else if (!AreEqual(positions + v * 4, positions + source * 4, 4) || !AreEqual(normals + v * 4, normals + source * 4, 4) ||
+                     !AreEqual(tangents + v * 4, tangents + source * 4, 4) || !AreEqual(uvs + v * 2, uvs + source * 2, 2))mismatches++;
+            else if (skinned) {
+                Real key[Constants::MaxBonesPerVertex * 2], sourceKey[Constants::MaxBonesPerVertex * 2];
+                GetBoneKey(corners[originalCorner], key);
+                GetBoneKey(corners[triangleOrder[source / 3] * 3 + source % 3], sourceKey);
+                if (!AreEqual(key, sourceKey, keySize))mismatches++;
+            }
+        }
+        if (mismatches > 0) {
+            printf("  %s: %u corners do not match the original triangles or their unique vertex\n", name, mismatches);
+            errors++;
+        }
+
+        VertexCacheStatistics check = VertexCacheOptimizer::CalculateStatistics(indices, mesh->GetUniqueVertexCount());
+        if (check.ACMR != optimized.ACMR) {
+            printf("  %s: the reported ACMR does not match the index list\n", name);
+            errors++;
+        }
+
+        if (!(optimized.ACMR < original.ACMR) || optimized.ACMR > MaxOptimizedACMR) {
+            printf("  %s: the ACMR after the reordering should be lower than before and at most %.2f\n", name, MaxOptimizedACMR);
+            errors++;
+        }
+
+        EngineObjectManager::DestroySubMesh3D(mesh);
+        return errors;
+    }
+}
+
+int main(int argc, char ** argv) {
+    UInt32 failures = 0;
+
+    failures += CheckMesh("scanline order", BuildTriangles(false), false);
+    failures += CheckMesh("random order", BuildTriangles(true), false);
+    failures += CheckMesh("skinned, random order", BuildTriangles(true), true);
+
+    printf(failures == 0 ? "PASSED\n" : "FAILED\n");
+    return failures == 0 ? 0 : 1;
+}